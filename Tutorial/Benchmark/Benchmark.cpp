@@ -0,0 +1,1395 @@
+/**-----------------------------------------------------------------------------
+ * 파일: Benchmark.cpp
+ *
+ * 설명: 소프트웨어 디바이스의 성능 측정.
+ *       FVF별로 인스턴스화한 정점 커널(SwProcessVerticesT)과 FVF를 실행 중에 해석하는
+ *       정점 단계(SwDecodeFVF + SwProcessVertices)를 예제들이 쓰는 FVF마다 비교한다.
+ *       두 경로의 출력이 같은지도 확인한다.
+ *       BMP 디코더(SwDecodeBitmapInMemory)의 스칼라 구현과 SIMD 구현도 큰 아틀라스로 비교한다.
+ *       4K 텍스처 한 장의 밉 체인 생성(SwGenerateMipmapChain) 시간을 필터와 구현, 스레드 수별로 잰다.
+ *       BC1/BC3 압축은 예제 BMP(없으면 합성 이미지)의 PSNR과 텍스처 메모리, 블록 디코더 속도,
+ *       32비트 텍스처와 비교한 샘플링 처리량을 잰다.
+ *       텍스처 스테이지 조합기(SwCombiner)가 고른 셰이딩 함수와 스테이지 상태를 해석하는 SwShadePixel()을
+ *       예제들의 스테이지 연결마다 비교하고, 드로우마다 조합기를 고를 때의 캐시 적중률을 보인다.
+ *       라이트맵 굽기(SwBakeLightmap)는 절차적으로 만든 방 장면으로 광선 검사 구현별 광선 처리량을 잰다.
+ *       디바이스의 상태 설정은 Tut08처럼 드로우마다 같은 상태를 다시 설정하는 프레임을
+ *       Set*() 호출과 상태 블록 두 가지로 그리면서 버려진 호출 수와 제출 시간을 본다.
+ *       Tut06처럼 부분 집합마다 재질과 텍스처를 바꾸는 프레임을 직접 호출, 한 번 기록한 명령 목록,
+ *       작업자 스레드가 나누어 기록한 명령 목록으로 그려 제출 시간을 비교한다.
+ *       변 함수 커널(SwEdgeKernel.h)은 Tut02의 삼각형과 화면을 여러 번 덮는 채우기 장면을 구현마다 그려
+ *       스칼라 구현과 화면이 비트 단위로 같은지 보고 프레임 시간을 비교한다.
+ *       구간 추적(SwTrace.h)은 같은 프레임을 추적을 끄고 켜서 그려 기록 비용을 보고 구간별 요약을 보인다.
+ *
+ *       사용법: Benchmark [정점 수] [반복 횟수]
+ *------------------------------------------------------------------------------
+ */
+
+#include "SwBinner.h"
+#include "SwBitmap.h"
+#include "SwBlockCompress.h"
+#include "SwBvh.h"
+#include "SwCombiner.h"
+#include "SwDevice.h"
+#include "SwEdgeKernel.h"
+#include "SwFVFVertex.h"
+#include "SwLightmap.h"
+#include "SwMath.h"
+#include "SwMipmap.h"
+#include "SwPixelStage.h"
+#include "SwResource.h"
+#include "SwThreadPool.h"
+#include "SwTrace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+
+ /**-----------------------------------------------------------------------------
+  *  측정 설정
+  *------------------------------------------------------------------------------
+  */
+#define BENCH_BATCH		256		/// 디바이스의 정점 묶음(SW_VERTEX_BATCH)과 같은 크기로 나누어 처리한다
+#define BENCH_ATLAS		4096	/// BMP 디코더를 측정할 아틀라스의 한 변 크기
+#define BENCH_MIPSIZE	4096	/// 밉 체인을 만들 텍스처의 한 변 크기
+#define BENCH_MIPREPEAT	5		/// 밉 체인 측정의 최대 반복 횟수(스칼라 Kaiser는 한 번에 1초 가까이 걸린다)
+#define BENCH_BCSIZE	1024	/// 예제 BMP가 없을 때 압축할 합성 이미지의 한 변 크기
+#define BENCH_SAMPLES	(1 << 20)	/// 샘플링 처리량을 잴 샘플 수
+#define BENCH_COMBREPEAT	5		/// 조합기 측정의 최대 반복 횟수
+#define BENCH_COMBDRAWS	1000	/// 캐시 적중률을 볼 드로우 수
+#define BENCH_BAKESIZE	256		/// 라이트맵 한 변 크기
+#define BENCH_BAKETESS	16		/// 방 장면의 면 하나를 나누는 격자 수(면마다 삼각형 2 * 16 * 16개)
+#define BENCH_BAKEREPEAT	3		/// 라이트맵 굽기 측정의 최대 반복 횟수
+#define BENCH_STATEDRAWS	2000	/// 상태 설정 측정에서 한 프레임의 드로우 수
+#define BENCH_STATEREPEAT	10		/// 상태 설정 측정의 최대 반복 횟수
+#define BENCH_LISTMATERIALS	8		/// 명령 목록 측정에서 번갈아 쓰는 재질 수
+#define BENCH_LISTTEXTURES	4		/// 명령 목록 측정에서 번갈아 쓰는 텍스처 수
+#define BENCH_EDGESIZE		512	/// 변 함수 커널 측정의 화면 크기
+#define BENCH_EDGELAYERS	16		/// 채우기 장면에서 화면을 겹쳐 덮는 삼각형 수
+#define BENCH_EDGEREPEAT	10		/// 변 함수 커널 측정의 최대 반복 횟수
+#define BENCH_TRACEDRAWS	4		/// 구간 추적 측정에서 예제 크기 장면의 화면을 덮는 드로우 수
+#define BENCH_TRACEREPEAT	30		/// 구간 추적 측정의 최대 반복 횟수(차이가 1% 안쪽이라 상태 설정보다 많이 잰다)
+
+struct BENCHFVF
+{
+	const char*	szName;
+	DWORD		dwFVF;
+};
+
+static const BENCHFVF g_BenchFVFs[] =
+{
+	{ "XYZRHW|DIFFUSE (Tut02)",			D3DFVF_XYZRHW | D3DFVF_DIFFUSE },
+	{ "XYZ|DIFFUSE (Tut03, Tut07)",		D3DFVF_XYZ | D3DFVF_DIFFUSE },
+	{ "XYZ|NORMAL (Tut04)",				D3DFVF_XYZ | D3DFVF_NORMAL },
+	{ "XYZ|DIFFUSE|TEX1 (Tut05, Tut08)",	D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1 },
+	{ "XYZ|NORMAL|TEX1 (Tut06)",		D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1 },
+};
+
+
+
+/**-----------------------------------------------------------------------------
+ * 시간 측정
+ *------------------------------------------------------------------------------
+ */
+static double GetTimeMs()
+{
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+/// 함수를 한 번 실행한 시간(ms)으로 *pBest를 줄인다.
+template<typename FUNC>
+static VOID MeasureOnce(FUNC func, double* pBest)
+{
+	const double fStart = GetTimeMs();
+	func();
+	const double fTime = GetTimeMs() - fStart;
+	if (fTime < *pBest)
+		*pBest = fTime;
+}
+
+/// 두 함수를 번갈아 nRepeat번씩 실행해 각각 가장 짧은 시간(ms)을 구한다.
+/// 번갈아 실행하므로 다른 작업의 간섭이나 클럭 변화가 두 쪽에 고르게 들어가고, 최소값은 그 간섭을 더 줄인다.
+template<typename FUNCA, typename FUNCB>
+static VOID MeasureMinPair(UINT nRepeat, FUNCA funcA, FUNCB funcB, double* pTimeA, double* pTimeB)
+{
+	*pTimeA = *pTimeB = 1e30;
+	for (UINT i = 0; i < nRepeat; ++i)
+	{
+		MeasureOnce(funcA, pTimeA);
+		MeasureOnce(funcB, pTimeB);
+	}
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 측정용 정점과 상태
+ *------------------------------------------------------------------------------
+ */
+static VOID FillVertices(DWORD dwFVF, UINT nNumVertices, std::vector<BYTE>* pVertices)
+{
+	SW_FVFLAYOUT layout;
+	SwDecodeFVF(dwFVF, &layout);
+	pVertices->assign((size_t)nNumVertices * layout.nSize, 0);
+
+	srand(1);
+	for (UINT i = 0; i < nNumVertices; ++i)
+	{
+		BYTE* pVertex = pVertices->data() + (size_t)i * layout.nSize;
+		float* pPos = (float*)pVertex;
+		for (UINT c = 0; c < 3; ++c)
+			pPos[c] = rand() * (4.0f / RAND_MAX) - 2.0f;
+		if (layout.bTransformed)
+			pPos[3] = 0.5f;
+
+		if (layout.nNormal >= 0)
+		{
+			D3DVECTOR n = SwVec3(pPos[0], pPos[1], pPos[2]);
+			SwVec3Normalize(&n, &n);
+			memcpy(pVertex + layout.nNormal, &n, sizeof(n));
+		}
+		if (layout.nDiffuse >= 0)
+			*(DWORD*)(pVertex + layout.nDiffuse) = (DWORD)rand() * 2654435761u;
+		for (UINT t = 0; t < layout.nNumTexCoords; ++t)
+		{
+			float* pTex = (float*)(pVertex + layout.nTexCoord[t]);
+			pTex[0] = rand() / (float)RAND_MAX;
+			pTex[1] = rand() / (float)RAND_MAX;
+		}
+	}
+}
+
+/// Tut04처럼 방향성 광원 하나와 재질 하나를 쓰는 상태
+static VOID SetupVertexState(SW_VERTEXSTATE* pState)
+{
+	ZeroMemory(pState, sizeof(SW_VERTEXSTATE));
+
+	D3DMATRIX matView, matProj, matWorldView;
+	D3DVECTOR vEye = SwVec3(0.0f, 3.0f, -5.0f);
+	D3DVECTOR vAt = SwVec3(0.0f, 0.0f, 0.0f);
+	D3DVECTOR vUp = SwVec3(0.0f, 1.0f, 0.0f);
+	SwMatrixRotationY(&pState->matWorld, 0.3f);
+	SwMatrixLookAtLH(&matView, &vEye, &vAt, &vUp);
+	SwMatrixPerspectiveFovLH(&matProj, SW_PI / 4, 1.0f, 1.0f, 100.0f);
+	SwMatrixMultiply(&matWorldView, &pState->matWorld, &matView);
+	SwMatrixMultiply(&pState->matWorldViewProj, &matWorldView, &matProj);
+
+	pState->bLighting = TRUE;
+	pState->dwDiffuseSource = D3DMCS_MATERIAL;
+	pState->dwAmbientSource = D3DMCS_MATERIAL;
+	pState->dwEmissiveSource = D3DMCS_MATERIAL;
+	pState->Ambient.r = pState->Ambient.g = pState->Ambient.b = 0.1f;
+	pState->Material.Diffuse.r = pState->Material.Diffuse.g = pState->Material.Diffuse.b = pState->Material.Diffuse.a = 1.0f;
+	pState->Material.Ambient = pState->Material.Diffuse;
+
+	pState->nNumLights = 1;
+	D3DLIGHT9& light = pState->Lights[0];
+	light.Type = D3DLIGHT_DIRECTIONAL;
+	light.Diffuse.r = light.Diffuse.g = light.Diffuse.b = 1.0f;
+	light.Direction = SwVec3(0.3f, -1.0f, 0.5f);
+	light.Range = 1000.0f;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 정점 커널 비교
+ *------------------------------------------------------------------------------
+ */
+static bool BenchVertexKernels(UINT nNumVertices, UINT nRepeat)
+{
+	SW_VERTEXSTATE vs;
+	SetupVertexState(&vs);
+
+	std::vector<BYTE> vertices;
+	std::vector<SW_VERTEX> generic(nNumVertices), specialized(nNumVertices);
+	bool bAllMatch = true;
+
+	printf("정점 %u개, %u회 중 최소 시간\n", nNumVertices, nRepeat);
+	printf("%-32s %12s %12s %8s\n", "FVF", "실행 중 해석", "FVF별 커널", "배율");
+
+	for (const BENCHFVF& bench : g_BenchFVFs)
+	{
+		FillVertices(bench.dwFVF, nNumVertices, &vertices);
+		const SW_PROCESSVERTICESFUNC pfnKernel = SwGetVertexKernel(bench.dwFVF);
+		if (!pfnKernel)
+		{
+			printf("%-32s 커널 없음\n", bench.szName);
+			bAllMatch = false;
+			continue;
+		}
+
+		// 실행 중 해석 경로는 디바이스처럼 드로우 호출(측정 한 번)마다 FVF를 해석한다.
+		const UINT nStride = SwGetFVFVertexSize(bench.dwFVF);
+		double fGeneric, fSpecialized;
+		MeasureMinPair(nRepeat, [&]()
+		{
+			SW_FVFLAYOUT layout;
+			SwDecodeFVF(bench.dwFVF, &layout);
+			for (UINT i = 0; i < nNumVertices; i += BENCH_BATCH)
+			{
+				const UINT nCount = std::min<UINT>(BENCH_BATCH, nNumVertices - i);
+				SwProcessVertices(&vs, &layout, vertices.data() + (size_t)i * layout.nSize, layout.nSize,
+					nCount, &generic[i]);
+			}
+		},
+		[&]()
+		{
+			for (UINT i = 0; i < nNumVertices; i += BENCH_BATCH)
+			{
+				const UINT nCount = std::min<UINT>(BENCH_BATCH, nNumVertices - i);
+				pfnKernel(&vs, vertices.data() + (size_t)i * nStride, nStride, nCount, &specialized[i]);
+			}
+		}, &fGeneric, &fSpecialized);
+
+		const bool bMatch = memcmp(generic.data(), specialized.data(), sizeof(SW_VERTEX) * nNumVertices) == 0;
+		bAllMatch = bAllMatch && bMatch;
+		printf("%-32s %9.3f ms %9.3f ms %7.2fx%s\n", bench.szName, fGeneric, fSpecialized,
+			fGeneric / fSpecialized, bMatch ? "" : "  (출력이 다르다)");
+	}
+	return bAllMatch;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * BMP 디코더 비교
+ *------------------------------------------------------------------------------
+ */
+static VOID WriteU32(BYTE* p, DWORD dw)
+{
+	memcpy(p, &dw, sizeof(dw));
+}
+
+/// 임의의 픽셀과 팔레트로 채운 bottom-up BI_RGB 파일 내용을 만든다.
+static VOID MakeBitmap(UINT nSize, UINT nBitCount, std::vector<BYTE>* pFile)
+{
+	const UINT nPitch = (nSize * nBitCount + 31) / 32 * 4;
+	const UINT nPaletteSize = (nBitCount <= 8) ? (1u << nBitCount) * 4 : 0;
+	const UINT nOffset = 14 + 40 + nPaletteSize;
+	pFile->assign(nOffset + (size_t)nPitch * nSize, 0);
+
+	BYTE* p = pFile->data();
+	srand(1);
+	for (size_t i = 14 + 40; i < pFile->size(); ++i)
+		p[i] = (BYTE)rand();
+
+	p[0] = 'B';
+	p[1] = 'M';
+	WriteU32(p + 2, (DWORD)pFile->size());
+	WriteU32(p + 10, nOffset);
+	WriteU32(p + 14, 40);
+	WriteU32(p + 18, nSize);
+	WriteU32(p + 22, nSize);
+	p[26] = 1;
+	p[28] = (BYTE)nBitCount;
+}
+
+static bool BenchBitmapDecoders(UINT nRepeat)
+{
+	const SW_BMPDECODER eBest = SwSetBitmapDecoder(SW_BMPDECODER_AUTO);
+	std::vector<BYTE> file;
+	std::vector<DWORD> scalar((size_t)BENCH_ATLAS * BENCH_ATLAS), simd(scalar.size());
+	bool bAllMatch = true;
+
+	printf("\nBMP %ux%u, %u회 중 최소 시간(파일 크기 기준 MB/s)\n", BENCH_ATLAS, BENCH_ATLAS, nRepeat);
+	printf("%-32s %17s %17s %8s\n", "형식", "scalar", SwGetBitmapDecoderName(eBest), "배율");
+
+	static const UINT s_BitCounts[] = { 8, 24, 32 };
+	for (UINT nBitCount : s_BitCounts)
+	{
+		MakeBitmap(BENCH_ATLAS, nBitCount, &file);
+
+		double fScalar, fSimd;
+		MeasureMinPair(nRepeat, [&]()
+		{
+			SwSetBitmapDecoder(SW_BMPDECODER_SCALAR);
+			SwDecodeBitmapInMemory(file.data(), file.size(), scalar.data(), BENCH_ATLAS * 4);
+		},
+		[&]()
+		{
+			SwSetBitmapDecoder(eBest);
+			SwDecodeBitmapInMemory(file.data(), file.size(), simd.data(), BENCH_ATLAS * 4);
+		}, &fScalar, &fSimd);
+
+		char szName[32];
+		snprintf(szName, sizeof(szName), "%u비트 BI_RGB", nBitCount);
+		const double fMB = file.size() / 1e6;
+		const bool bMatch = scalar == simd;
+		bAllMatch = bAllMatch && bMatch;
+		printf("%-32s %7.2f ms %5.0f MB/s %7.2f ms %5.0f MB/s %7.2fx%s\n", szName,
+			fScalar, fMB / fScalar * 1000.0, fSimd, fMB / fSimd * 1000.0, fScalar / fSimd,
+			bMatch ? "" : "  (출력이 다르다)");
+	}
+
+	SwSetBitmapDecoder(SW_BMPDECODER_AUTO);
+	return bAllMatch;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 밉 체인 생성 비교
+ *------------------------------------------------------------------------------
+ */
+/// 한 변이 nSize인 정사각형 텍스처의 전체 밉 체인을 담을 메모리와 레벨 설명을 만든다.
+/// 레벨 0은 임의의 색으로 채운다.
+static VOID MakeMipChain(UINT nSize, std::vector<DWORD>* pBits, std::vector<SW_MIPSURFACE>* pLevels)
+{
+	size_t nTotal = 0;
+	for (UINT n = nSize; ; n /= 2)
+	{
+		nTotal += (size_t)n * n;
+		if (n == 1)
+			break;
+	}
+	pBits->assign(nTotal, 0);
+
+	srand(2);
+	for (size_t i = 0; i < (size_t)nSize * nSize; ++i)
+		(*pBits)[i] = ((DWORD)rand() << 16) ^ (DWORD)rand();
+
+	pLevels->clear();
+	size_t nOffset = 0;
+	for (UINT n = nSize; ; n /= 2)
+	{
+		SW_MIPSURFACE level = { pBits->data() + nOffset, (INT)(n * 4), n, n };
+		pLevels->push_back(level);
+		nOffset += (size_t)n * n;
+		if (n == 1)
+			break;
+	}
+}
+
+static bool BenchMipmaps(UINT nRepeat)
+{
+	const SW_MIPKERNEL eBest = SwSetMipmapKernel(SW_MIPKERNEL_AUTO);
+	CSwThreadPool singlePool(1);
+	CSwThreadPool pool;
+	std::vector<DWORD> scalar, simd, parallel;
+	std::vector<SW_MIPSURFACE> scalarLevels, simdLevels, parallelLevels;
+	MakeMipChain(BENCH_MIPSIZE, &scalar, &scalarLevels);
+	MakeMipChain(BENCH_MIPSIZE, &simd, &simdLevels);
+	MakeMipChain(BENCH_MIPSIZE, &parallel, &parallelLevels);
+	const UINT nLevels = (UINT)scalarLevels.size();
+	nRepeat = std::min(nRepeat, (UINT)BENCH_MIPREPEAT);
+	bool bAllMatch = true;
+
+	printf("\n밉 체인 %ux%u(%u레벨), %u회 중 최소 시간(4K 텍스처 한 장당 ms)\n",
+		BENCH_MIPSIZE, BENCH_MIPSIZE, nLevels, nRepeat);
+	char szThreads[32];
+	snprintf(szThreads, sizeof(szThreads), "%s x%u", SwGetMipmapKernelName(eBest), pool.GetNumThreads());
+	printf("%-24s %12s %12s %12s %8s\n", "필터", "scalar x1", SwGetMipmapKernelName(eBest), szThreads, "배율");
+
+	static const struct { const char* szName; SW_MIPFILTER eFilter; } s_Filters[] =
+	{
+		{ "박스",	SW_MIPFILTER_BOX },
+		{ "Kaiser",	SW_MIPFILTER_KAISER },
+	};
+	for (const auto& filter : s_Filters)
+	{
+		double fScalar, fSimd, fParallel = 1e30;
+		MeasureMinPair(nRepeat, [&]()
+		{
+			SwSetMipmapKernel(SW_MIPKERNEL_SCALAR);
+			SwGenerateMipmapChain(scalarLevels.data(), nLevels, filter.eFilter, SW_MIPMAP_WRAP, &singlePool);
+		},
+		[&]()
+		{
+			SwSetMipmapKernel(eBest);
+			SwGenerateMipmapChain(simdLevels.data(), nLevels, filter.eFilter, SW_MIPMAP_WRAP, &singlePool);
+		}, &fScalar, &fSimd);
+		for (UINT i = 0; i < nRepeat; ++i)
+		{
+			MeasureOnce([&]()
+			{
+				SwGenerateMipmapChain(parallelLevels.data(), nLevels, filter.eFilter, SW_MIPMAP_WRAP, &pool);
+			}, &fParallel);
+		}
+
+		const bool bMatch = scalar == simd && scalar == parallel;
+		bAllMatch = bAllMatch && bMatch;
+		printf("%-24s %9.1f ms %9.1f ms %9.1f ms %7.2fx%s\n", filter.szName,
+			fScalar, fSimd, fParallel, fScalar / fParallel, bMatch ? "" : "  (출력이 다르다)");
+	}
+
+	SwSetMipmapKernel(SW_MIPKERNEL_AUTO);
+	return bAllMatch;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * BC1/BC3 압축 비교
+ *------------------------------------------------------------------------------
+ */
+/// 부드러운 색 변화와 가장자리, 약한 잡음이 섞인 합성 이미지(알파는 가로 기울기)
+static CSwTexture* MakeTestTexture(UINT nSize)
+{
+	CSwTexture* pTexture = new CSwTexture(nSize, nSize, 0, D3DFMT_A8R8G8B8);
+	D3DLOCKED_RECT rect;
+	pTexture->LockRect(0, &rect, NULL, 0);
+	srand(3);
+	for (UINT y = 0; y < nSize; ++y)
+	{
+		DWORD* pRow = (DWORD*)((BYTE*)rect.pBits + (size_t)y * rect.Pitch);
+		for (UINT x = 0; x < nSize; ++x)
+		{
+			const float fx = (float)x / nSize, fy = (float)y / nSize;
+			const UINT r = (UINT)(127.5f + 127.5f * sinf(fx * 12.0f + fy * 3.0f));
+			const UINT g = (UINT)(255.0f * fy);
+			const UINT b = ((x / 64 + y / 64) & 1) ? 200 : 40;
+			const UINT n = (UINT)(rand() & 7);
+			pRow[x] = ((x * 255 / nSize) << 24) | (std::min(r + n, 255u) << 16) | (std::min(g + n, 255u) << 8) | (b + n);
+		}
+	}
+	pTexture->UnlockRect(0);
+	SwGenerateMipmaps(pTexture, SW_MIPFILTER_BOX, SW_MIPMAP_WRAP);
+	return pTexture;
+}
+
+/// 레벨 0을 비교한 PSNR(dB). bAlpha가 거짓이면 RGB만 비교한다.
+static double ComputePsnr(const CSwTexture* pSource, const CSwTexture* pCompressed, bool bAlpha)
+{
+	const UINT nWidth = pSource->GetWidth(), nHeight = pSource->GetHeight();
+	std::vector<DWORD> decoded((size_t)nWidth * nHeight);
+	SwDecompressSurface(pCompressed->GetFormat(), pCompressed->GetBits(), pCompressed->GetPitch(),
+		nWidth, nHeight, decoded.data(), nWidth * 4);
+
+	double fSum = 0.0;
+	const UINT nChannels = bAlpha ? 4 : 3;
+	for (size_t i = 0; i < decoded.size(); ++i)
+	{
+		for (UINT c = 0; c < nChannels; ++c)
+		{
+			const int d = (int)((pSource->GetBits()[i] >> (c * 8)) & 0xff) - (int)((decoded[i] >> (c * 8)) & 0xff);
+			fSum += d * d;
+		}
+	}
+	const double fMse = fSum / ((double)decoded.size() * nChannels);
+	return (fMse > 0.0) ? 10.0 * log10(255.0 * 255.0 / fMse) : 99.0;
+}
+
+/// 화면에서 조금 돌아간 면처럼 픽셀마다 텍셀 하나쯤 움직이는 좌표로 이중 선형 샘플링을 한다.
+/// 디바이스처럼 1024x1024 화면을 타일(SW_TILE_SIZE) 단위로 훑는다.
+static float SampleTexture(const CSwTexture* pTexture, UINT nSamples)
+{
+	SW_STAGESTATE stage;
+	ZeroMemory(&stage, sizeof(stage));
+	stage.pTexture = const_cast<CSwTexture*>(pTexture);
+	stage.dwMagFilter = D3DTEXF_LINEAR;
+	stage.dwMinFilter = D3DTEXF_LINEAR;
+	stage.dwAddressU = D3DTADDRESS_WRAP;
+	stage.dwAddressV = D3DTADDRESS_WRAP;
+
+	const UINT nTilePixels = SW_TILE_SIZE * SW_TILE_SIZE;
+	float fSum = 0.0f, color[4];
+	for (UINT i = 0; i < nSamples; ++i)
+	{
+		const UINT nTile = i / nTilePixels, nPixel = i % nTilePixels;
+		const UINT px = (nTile % (1024 / SW_TILE_SIZE)) * SW_TILE_SIZE + nPixel % SW_TILE_SIZE;
+		const UINT py = (nTile / (1024 / SW_TILE_SIZE)) * SW_TILE_SIZE + nPixel / SW_TILE_SIZE;
+		const float x = (float)px / 1024.0f, y = (float)py / 1024.0f;
+		SwSampleTexture(&stage, x * 0.9f + y * 0.2f, y * 0.8f - x * 0.1f, NULL, color);
+		fSum += color[0];
+	}
+	return fSum;
+}
+
+static bool BenchBlockCompression(UINT nRepeat)
+{
+	// 예제 BMP를 찾는다. 실행 폴더가 Benchmark이거나 Tutorial일 때 모두 찾을 수 있게 한다.
+	static const char* s_Files[] = { "..\\tiger.bmp", "..\\banana.bmp", "../tiger.bmp", "../banana.bmp",
+		"tiger.bmp", "banana.bmp" };
+	std::vector<std::pair<std::string, CSwTexture*>> images;
+	for (const char* pFilename : s_Files)
+	{
+		CSwTexture* pTexture;
+		if (images.size() < 2 && SUCCEEDED(SwCreateTextureFromBitmap(pFilename, 0, &pTexture)))
+			images.push_back(std::make_pair(std::string(pFilename), pTexture));
+	}
+	images.push_back(std::make_pair(std::string("합성 이미지"), MakeTestTexture(BENCH_BCSIZE)));
+
+	printf("\nBC1/BC3 압축(전체 밉 체인, 메모리는 32비트 대비)\n");
+	printf("%-24s %10s %10s %10s %10s %10s %10s\n", "이미지", "BC1 PSNR", "BC3 PSNR", "BC1 압축", "BC3 압축",
+		"32비트", "BC1/BC3");
+
+	bool bAllMatch = true;
+	CSwTexture* pSample[3] = {};
+	for (const auto& image : images)
+	{
+		CSwTexture* pSource = image.second;
+		CSwTexture* pBC1 = NULL;
+		CSwTexture* pBC3 = NULL;
+		double fTimeBC1 = 1e30, fTimeBC3 = 1e30;
+		MeasureOnce([&]() { SwCompressTexture(pSource, D3DFMT_DXT1, &pBC1); }, &fTimeBC1);
+		MeasureOnce([&]() { SwCompressTexture(pSource, D3DFMT_DXT5, &pBC3); }, &fTimeBC3);
+
+		// 알파가 있는 합성 이미지만 BC3의 알파까지 비교한다.
+		const bool bAlpha = (pSource->GetFormat() == D3DFMT_A8R8G8B8);
+		char szName[32], szMemory[32];
+		snprintf(szName, sizeof(szName), "%s %ux%u", image.first.c_str(), pSource->GetWidth(), pSource->GetHeight());
+		snprintf(szMemory, sizeof(szMemory), "%.0fx/%.0fx", (double)pSource->GetSizeInBytes() / pBC1->GetSizeInBytes(),
+			(double)pSource->GetSizeInBytes() / pBC3->GetSizeInBytes());
+		printf("%-24s %7.2f dB %7.2f dB %7.2f ms %7.2f ms %7.0f KB %10s\n", szName,
+			ComputePsnr(pSource, pBC1, false), ComputePsnr(pSource, pBC3, bAlpha), fTimeBC1, fTimeBC3,
+			pSource->GetSizeInBytes() / 1024.0, szMemory);
+
+		if (&image == &images.back())
+		{
+			pSample[0] = pSource;
+			pSample[1] = pBC1;
+			pSample[2] = pBC3;
+		}
+		else
+		{
+			pSource->Release();
+			pBC1->Release();
+			pBC3->Release();
+		}
+	}
+
+	// 블록 디코더: 합성 이미지의 레벨 0 전체를 푼다.
+	const SW_BCDECODER eBest = SwSetBlockDecoder(SW_BCDECODER_AUTO);
+	const UINT nWidth = pSample[0]->GetWidth(), nHeight = pSample[0]->GetHeight();
+	const double fTexels = (double)nWidth * nHeight;
+	std::vector<DWORD> scalar((size_t)nWidth * nHeight), simd(scalar.size());
+
+	printf("\n블록 디코더 %ux%u, %u회 중 최소 시간(Mtexel/s)\n", nWidth, nHeight, nRepeat);
+	printf("%-32s %17s %17s %8s\n", "형식", "scalar", SwGetBlockDecoderName(eBest), "배율");
+	for (UINT i = 1; i <= 2; ++i)
+	{
+		const CSwTexture* pTexture = pSample[i];
+		double fScalar, fSimd;
+		MeasureMinPair(nRepeat, [&]()
+		{
+			SwSetBlockDecoder(SW_BCDECODER_SCALAR);
+			SwDecompressSurface(pTexture->GetFormat(), pTexture->GetBits(), pTexture->GetPitch(), nWidth, nHeight,
+				scalar.data(), nWidth * 4);
+		},
+		[&]()
+		{
+			SwSetBlockDecoder(eBest);
+			SwDecompressSurface(pTexture->GetFormat(), pTexture->GetBits(), pTexture->GetPitch(), nWidth, nHeight,
+				simd.data(), nWidth * 4);
+		}, &fScalar, &fSimd);
+
+		const bool bMatch = scalar == simd;
+		bAllMatch = bAllMatch && bMatch;
+		printf("%-32s %7.2f ms %5.0f Mt/s %7.2f ms %5.0f Mt/s %7.2fx%s\n", (i == 1) ? "BC1" : "BC3",
+			fScalar, fTexels / fScalar / 1000.0, fSimd, fTexels / fSimd / 1000.0, fScalar / fSimd,
+			bMatch ? "" : "  (출력이 다르다)");
+	}
+	SwSetBlockDecoder(SW_BCDECODER_AUTO);
+
+	// 샘플링: 블록 압축 텍스처는 풀어 둔 블록 캐시를 거친다.
+	printf("\n이중 선형 샘플링 %u회, %u회 중 최소 시간(Msample/s)\n", BENCH_SAMPLES, nRepeat);
+	static const char* s_SampleNames[3] = { "A8R8G8B8", "BC1", "BC3" };
+	for (UINT i = 0; i < 3; ++i)
+	{
+		double fTime = 1e30;
+		for (UINT r = 0; r < nRepeat; ++r)
+			MeasureOnce([&]() { SampleTexture(pSample[i], BENCH_SAMPLES); }, &fTime);
+		printf("%-32s %7.2f ms %7.1f Ms/s\n", s_SampleNames[i], fTime, BENCH_SAMPLES / fTime / 1000.0);
+		pSample[i]->Release();
+	}
+	return bAllMatch;
+}
+
+
+/**-----------------------------------------------------------------------------
+ * 텍스처 스테이지 조합기
+ *------------------------------------------------------------------------------
+ */
+struct BENCHCHAIN
+{
+	const char*	szName;
+	UINT		nNumStages;
+	DWORD		dwColorOp[2], dwColorArg1[2], dwColorArg2[2];
+	DWORD		dwAlphaOp[2], dwAlphaArg1[2], dwAlphaArg2[2];
+	bool		bTexture;
+};
+
+static const BENCHCHAIN g_BenchChains[] =
+{
+	{ "기본, 텍스처 없음 (Tut02-04)", 1, { D3DTOP_MODULATE }, { D3DTA_TEXTURE }, { D3DTA_CURRENT },
+		{ D3DTOP_SELECTARG1 }, { D3DTA_TEXTURE }, { D3DTA_CURRENT }, false },
+	{ "MODULATE(TEX, DIFFUSE) (Tut05)", 1, { D3DTOP_MODULATE }, { D3DTA_TEXTURE }, { D3DTA_DIFFUSE },
+		{ D3DTOP_DISABLE }, { D3DTA_TEXTURE }, { D3DTA_CURRENT }, true },
+	{ "기본, 텍스처 (Tut06)", 1, { D3DTOP_MODULATE }, { D3DTA_TEXTURE }, { D3DTA_CURRENT },
+		{ D3DTOP_SELECTARG1 }, { D3DTA_TEXTURE }, { D3DTA_CURRENT }, true },
+	{ "SELECTARG1 + MODULATE (Tut08)", 2, { D3DTOP_SELECTARG1, D3DTOP_MODULATE }, { D3DTA_TEXTURE, D3DTA_TEXTURE },
+		{ D3DTA_CURRENT, D3DTA_CURRENT }, { D3DTOP_SELECTARG1, D3DTOP_DISABLE }, { D3DTA_TEXTURE, D3DTA_TEXTURE },
+		{ D3DTA_CURRENT, D3DTA_CURRENT }, true },
+	{ "ADD(TEX, TFACTOR) + MODULATE2X", 2, { D3DTOP_ADD, D3DTOP_MODULATE2X }, { D3DTA_TEXTURE, D3DTA_TEXTURE },
+		{ D3DTA_TFACTOR, D3DTA_CURRENT }, { D3DTOP_MODULATE, D3DTOP_DISABLE }, { D3DTA_TEXTURE, D3DTA_TEXTURE },
+		{ D3DTA_DIFFUSE, D3DTA_CURRENT }, true },
+	{ "MODULATE(1-TEX, DIFFUSE)", 1, { D3DTOP_MODULATE }, { D3DTA_TEXTURE | D3DTA_COMPLEMENT }, { D3DTA_DIFFUSE },
+		{ D3DTOP_DISABLE }, { D3DTA_TEXTURE }, { D3DTA_CURRENT }, true },
+};
+
+static VOID SetupBenchChain(const BENCHCHAIN& chain, CSwTexture* pTexture, SW_DRAWSTATE* pState)
+{
+	ZeroMemory(pState, sizeof(SW_DRAWSTATE));
+	pState->dwTextureFactor = D3DCOLOR_XRGB(40, 20, 10);
+	pState->nNumTexCoords = 1;
+	for (UINT i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+	{
+		SW_STAGESTATE& stage = pState->Stages[i];
+		stage.dwColorOp = (i < chain.nNumStages) ? chain.dwColorOp[i] : (DWORD)D3DTOP_DISABLE;
+		stage.dwAlphaOp = D3DTOP_DISABLE;
+		if (i >= chain.nNumStages)
+			continue;
+		stage.dwColorArg1 = chain.dwColorArg1[i];
+		stage.dwColorArg2 = chain.dwColorArg2[i];
+		stage.dwAlphaOp = chain.dwAlphaOp[i];
+		stage.dwAlphaArg1 = chain.dwAlphaArg1[i];
+		stage.dwAlphaArg2 = chain.dwAlphaArg2[i];
+		stage.pTexture = chain.bTexture ? pTexture : NULL;
+		stage.dwAddressU = stage.dwAddressV = D3DTADDRESS_WRAP;
+		stage.dwMagFilter = stage.dwMinFilter = D3DTEXF_LINEAR;
+		stage.dwMipFilter = D3DTEXF_NONE;
+	}
+	SwPrepareDrawState(pState);
+}
+
+/// 1024x1024 화면을 훑으며 픽셀 색을 계산하고 결과를 pOut에 남긴다.
+template<typename SHADEFUNC>
+static VOID ShadeScreen(const SW_DRAWSTATE* pState, SHADEFUNC shade, UINT nPixels, DWORD* pOut)
+{
+	for (UINT i = 0; i < nPixels; ++i)
+	{
+		const float x = (float)(i % 1024) / 1024.0f, y = (float)(i / 1024) / 1024.0f;
+		const float diffuse[4] = { x, y, 0.5f, 1.0f };
+		const float tex[SW_MAX_TEXCOORDS][2] = { { x * 1.3f + y * 0.2f, y * 1.3f - x * 0.2f }, { 0.0f, 0.0f } };
+		pOut[i] = shade(pState, diffuse, tex, NULL);
+	}
+}
+
+static bool BenchCombiner(UINT nRepeat)
+{
+	CSwTexture* pTexture = MakeTestTexture(256);
+	const UINT nCombRepeat = std::min(nRepeat, (UINT)BENCH_COMBREPEAT);
+	std::vector<DWORD> interpreted(BENCH_SAMPLES), combined(BENCH_SAMPLES);
+
+	printf("\n텍스처 스테이지 조합기, 픽셀 %u개, %u회 중 최소 시간(Mpixel/s)\n", BENCH_SAMPLES, nCombRepeat);
+	printf("%-34s %-12s %17s %17s %8s\n", "스테이지 연결", "종류", "SwShadePixel", "조합기", "배율");
+
+	bool bAllMatch = true;
+	for (const BENCHCHAIN& chain : g_BenchChains)
+	{
+		SW_DRAWSTATE state;
+		SetupBenchChain(chain, pTexture, &state);
+		const SW_COMBINERKIND eKind = SwSelectCombiner(&state);
+
+		double fInterpreted, fCombined;
+		MeasureMinPair(nCombRepeat,
+			[&]() { ShadeScreen(&state, &SwShadePixel, BENCH_SAMPLES, interpreted.data()); },
+			[&]() { ShadeScreen(&state, state.Combiner.pfnShade, BENCH_SAMPLES, combined.data()); },
+			&fInterpreted, &fCombined);
+
+		const bool bMatch = interpreted == combined;
+		bAllMatch = bAllMatch && bMatch;
+		printf("%-34s %-12s %7.2f ms %5.0f Mp/s %7.2f ms %5.0f Mp/s %7.2fx%s\n", chain.szName,
+			SwGetCombinerKindName(eKind), fInterpreted, BENCH_SAMPLES / fInterpreted / 1000.0,
+			fCombined, BENCH_SAMPLES / fCombined / 1000.0, fInterpreted / fCombined, bMatch ? "" : "  (출력이 다르다)");
+	}
+
+	// 드로우마다 상태를 다시 고르는 상황: 연결 몇 개가 번갈아 나온다.
+	SwResetCombinerStats();
+	const UINT nNumChains = sizeof(g_BenchChains) / sizeof(g_BenchChains[0]);
+	for (UINT i = 0; i < BENCH_COMBDRAWS; ++i)
+	{
+		SW_DRAWSTATE state;
+		SetupBenchChain(g_BenchChains[(i / 4) % nNumChains], pTexture, &state);
+	}
+	SW_COMBINERSTATS stats;
+	SwGetCombinerStats(&stats);
+	printf("드로우 %u번: 조회 %llu, 적중 %llu (%.1f%%), 캐시 항목 specialized %u, composed %u, interpreted %u\n",
+		BENCH_COMBDRAWS, (unsigned long long)stats.nLookups, (unsigned long long)stats.nHits,
+		stats.nLookups ? 100.0 * stats.nHits / stats.nLookups : 0.0,
+		stats.nEntries[SW_COMBINER_SPECIALIZED], stats.nEntries[SW_COMBINER_COMPOSED], stats.nEntries[SW_COMBINER_INTERPRETED]);
+
+	pTexture->Release();
+	return bAllMatch;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 라이트맵 굽기
+ *------------------------------------------------------------------------------
+ */
+struct BAKEROOM
+{
+	std::vector<SW_BAKEVERTEX>	Vertices;
+	std::vector<DWORD>			Indices;
+	std::vector<D3DCOLOR>		Albedo;
+	UINT						nNumFaces;
+};
+
+/// Origin에서 AxisU, AxisV로 펼친 사각형 면을 격자로 나누어 넣는다.
+/// 라이트맵은 면마다 5x5 아틀라스의 칸 하나를 쓰고, 칸 둘레에 한 텍셀씩 여백을 둔다.
+static VOID AddBakeFace(BAKEROOM* pRoom, D3DVECTOR Origin, D3DVECTOR AxisU, D3DVECTOR AxisV, D3DCOLOR Albedo)
+{
+	D3DVECTOR Normal;
+	SwVec3Cross(&Normal, &AxisU, &AxisV);
+	SwVec3Normalize(&Normal, &Normal);
+
+	const UINT nCell = pRoom->nNumFaces++;
+	const float fCell = 1.0f / 5.0f;
+	const float fPad = 1.0f / BENCH_BAKESIZE;
+	const float u0 = (nCell % 5) * fCell + fPad, v0 = (nCell / 5) * fCell + fPad;
+	const float fSize = fCell - fPad * 2;
+
+	const DWORD nBase = (DWORD)pRoom->Vertices.size();
+	for (UINT y = 0; y <= BENCH_BAKETESS; ++y)
+	{
+		for (UINT x = 0; x <= BENCH_BAKETESS; ++x)
+		{
+			const float s = (float)x / BENCH_BAKETESS, t = (float)y / BENCH_BAKETESS;
+			SW_BAKEVERTEX v;
+			v.Position = SwVec3(Origin.x + AxisU.x * s + AxisV.x * t, Origin.y + AxisU.y * s + AxisV.y * t,
+				Origin.z + AxisU.z * s + AxisV.z * t);
+			v.Normal = Normal;
+			v.u = u0 + fSize * s;
+			v.v = v0 + fSize * t;
+			pRoom->Vertices.push_back(v);
+		}
+	}
+	for (UINT y = 0; y < BENCH_BAKETESS; ++y)
+	{
+		for (UINT x = 0; x < BENCH_BAKETESS; ++x)
+		{
+			const DWORD i = nBase + y * (BENCH_BAKETESS + 1) + x;
+			const DWORD quad[6] = { i, i + 1, i + BENCH_BAKETESS + 1, i + 1, i + BENCH_BAKETESS + 2, i + BENCH_BAKETESS + 1 };
+			pRoom->Indices.insert(pRoom->Indices.end(), quad, quad + 6);
+			pRoom->Albedo.push_back(Albedo);
+			pRoom->Albedo.push_back(Albedo);
+		}
+	}
+}
+
+/// 바깥을 향하는 상자(면 6개)
+static VOID AddBakeBox(BAKEROOM* pRoom, D3DVECTOR Min, D3DVECTOR Size, D3DCOLOR Albedo)
+{
+	const D3DVECTOR Max = SwVec3(Min.x + Size.x, Min.y + Size.y, Min.z + Size.z);
+	AddBakeFace(pRoom, SwVec3(Min.x, Min.y, Min.z), SwVec3(0, Size.y, 0), SwVec3(Size.x, 0, 0), Albedo);	// -z
+	AddBakeFace(pRoom, SwVec3(Max.x, Min.y, Max.z), SwVec3(0, Size.y, 0), SwVec3(-Size.x, 0, 0), Albedo);	// +z
+	AddBakeFace(pRoom, SwVec3(Min.x, Min.y, Max.z), SwVec3(0, Size.y, 0), SwVec3(0, 0, -Size.z), Albedo);	// -x
+	AddBakeFace(pRoom, SwVec3(Max.x, Min.y, Min.z), SwVec3(0, Size.y, 0), SwVec3(0, 0, Size.z), Albedo);	// +x
+	AddBakeFace(pRoom, SwVec3(Min.x, Max.y, Min.z), SwVec3(0, 0, Size.z), SwVec3(Size.x, 0, 0), Albedo);	// +y
+	AddBakeFace(pRoom, SwVec3(Min.x, Min.y, Min.z), SwVec3(Size.x, 0, 0), SwVec3(0, 0, Size.z), Albedo);	// -y
+}
+
+/// 4 x 3 x 4 크기의 닫힌 방(빨간 왼쪽 벽, 초록 오른쪽 벽)에 기둥과 낮은 상자를 둔다.
+static VOID MakeBakeRoom(BAKEROOM* pRoom)
+{
+	pRoom->nNumFaces = 0;
+	const D3DCOLOR White = D3DCOLOR_XRGB(190, 190, 190);
+	AddBakeFace(pRoom, SwVec3(-2, 0, -2), SwVec3(0, 0, 4), SwVec3(4, 0, 0), White);						// 바닥
+	AddBakeFace(pRoom, SwVec3(-2, 3, -2), SwVec3(4, 0, 0), SwVec3(0, 0, 4), White);						// 천장
+	AddBakeFace(pRoom, SwVec3(-2, 0, 2), SwVec3(0, 3, 0), SwVec3(4, 0, 0), White);						// 뒤
+	AddBakeFace(pRoom, SwVec3(-2, 0, -2), SwVec3(4, 0, 0), SwVec3(0, 3, 0), White);						// 앞
+	AddBakeFace(pRoom, SwVec3(-2, 0, -2), SwVec3(0, 3, 0), SwVec3(0, 0, 4), D3DCOLOR_XRGB(190, 40, 40));	// 왼쪽
+	AddBakeFace(pRoom, SwVec3(2, 0, 2), SwVec3(0, 3, 0), SwVec3(0, 0, -4), D3DCOLOR_XRGB(40, 190, 40));	// 오른쪽
+	AddBakeBox(pRoom, SwVec3(-1.2f, 0, 0.2f), SwVec3(0.8f, 2.2f, 0.8f), White);
+	AddBakeBox(pRoom, SwVec3(0.3f, 0, -0.9f), SwVec3(1.0f, 0.7f, 1.0f), D3DCOLOR_XRGB(80, 80, 190));
+}
+
+static bool BenchLightmapBake(UINT nRepeat)
+{
+	BAKEROOM room;
+	MakeBakeRoom(&room);
+
+	D3DLIGHT9 lights[2] = {};
+	lights[0].Type = D3DLIGHT_POINT;
+	lights[0].Diffuse.r = lights[0].Diffuse.g = lights[0].Diffuse.b = 1.0f;
+	lights[0].Position = SwVec3(0.0f, 2.8f, 0.0f);
+	lights[0].Range = 100.0f;
+	lights[0].Attenuation0 = 0.3f;
+	lights[0].Attenuation2 = 0.15f;
+	lights[1].Type = D3DLIGHT_SPOT;
+	lights[1].Diffuse.r = lights[1].Diffuse.g = 1.0f;
+	lights[1].Diffuse.b = 0.8f;
+	lights[1].Position = SwVec3(1.8f, 2.8f, 1.8f);
+	lights[1].Direction = SwVec3(-1.0f, -1.2f, -1.0f);
+	lights[1].Range = 100.0f;
+	lights[1].Attenuation0 = 1.0f;
+	lights[1].Theta = 0.5f;
+	lights[1].Phi = 0.9f;
+	lights[1].Falloff = 1.0f;
+
+	SW_BAKESCENE scene = {};
+	scene.pVertices = room.Vertices.data();
+	scene.nNumVertices = (UINT)room.Vertices.size();
+	scene.pIndices = room.Indices.data();
+	scene.nNumTriangles = (UINT)room.Indices.size() / 3;
+	scene.pAlbedo = room.Albedo.data();
+	scene.pLights = lights;
+	scene.nNumLights = 2;
+
+	SW_BAKEPARAMS params = {};
+	params.nWidth = params.nHeight = BENCH_BAKESIZE;
+	params.nLevels = 1;
+	params.nSamples = 16;
+	params.nBounces = 2;
+
+	CSwThreadPool pool;
+	const UINT nBakeRepeat = std::min(nRepeat, (UINT)BENCH_BAKEREPEAT);
+	printf("\n라이트맵 굽기 %ux%u, 삼각형 %u개, 텍셀마다 경로 %u개 x 튕김 %u번, 스레드 %u개, %u회 중 최소 시간\n",
+		params.nWidth, params.nHeight, scene.nNumTriangles, params.nSamples, params.nBounces,
+		pool.GetNumThreads(), nBakeRepeat);
+	printf("%-10s %10s %10s %10s %12s %10s\n", "구현", "BVH", "추적", "전체", "광선", "Mray/s");
+
+	const SW_RAYKERNEL eBest = SwSetRayKernel(SW_RAYKERNEL_AUTO);
+	const SW_RAYKERNEL eKernels[2] = { SW_RAYKERNEL_SCALAR, eBest };
+	std::vector<DWORD> results[2];
+	for (UINT k = 0; k < 2; ++k)
+	{
+		SwSetRayKernel(eKernels[k]);
+		SW_BAKESTATS best = {};
+		best.fTotalMs = 1e30;
+		for (UINT r = 0; r < nBakeRepeat; ++r)
+		{
+			CSwTexture* pLightmap;
+			SW_BAKESTATS stats;
+			if (FAILED(SwBakeLightmap(&scene, &params, &pLightmap, &stats, &pool)))
+			{
+				printf("%-10s 굽기 실패\n", SwGetRayKernelName(eKernels[k]));
+				SwSetRayKernel(SW_RAYKERNEL_AUTO);
+				return false;
+			}
+			if (stats.fTotalMs < best.fTotalMs)
+				best = stats;
+			results[k].assign(pLightmap->GetBits(), pLightmap->GetBits() + (size_t)params.nWidth * params.nHeight);
+			pLightmap->Release();
+		}
+		printf("%-10s %7.2f ms %7.1f ms %7.1f ms %12llu %10.2f\n", SwGetRayKernelName(eKernels[k]),
+			best.fBuildMs, best.fTraceMs, best.fTotalMs, (unsigned long long)best.nRays, best.fMRaysPerSec);
+	}
+	SwSetRayKernel(SW_RAYKERNEL_AUTO);
+
+	// 광선 검사 구현은 같은 교점을 내야 하고, 난수는 텍셀 위치로 정하므로 라이트맵이 비트 단위로 같아야 한다.
+	const bool bMatch = results[0] == results[1];
+	if (!bMatch)
+		printf("광선 검사 구현의 라이트맵이 다르다\n");
+	return bMatch;
+}
+
+/**-----------------------------------------------------------------------------
+ * 디바이스 상태 설정
+ *------------------------------------------------------------------------------
+ */
+struct BENCHQUAD
+{
+	float	x, y, z;
+	DWORD	color;
+	float	u, v;
+};
+
+#define BENCH_QUADFVF	(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+
+/// Tut08의 Render()가 프레임마다 설정하던 텍스처, 스테이지, 샘플러 상태
+static VOID SetTut08States(CSwDevice* pDevice, CSwTexture* pTex0, CSwTexture* pTex1)
+{
+	pDevice->SetTexture(0, pTex0);
+	pDevice->SetTexture(1, pTex1);
+	pDevice->SetTextureStageState(0, D3DTSS_TEXCOORDINDEX, 0);
+	pDevice->SetTextureStageState(1, D3DTSS_TEXCOORDINDEX, 0);
+	pDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(1, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	pDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+	pDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
+	pDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(1, D3DTSS_COLOROP, D3DTOP_MODULATE);
+	pDevice->SetTextureStageState(1, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(1, D3DTSS_COLORARG2, D3DTA_CURRENT);
+	pDevice->SetTextureStageState(1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+	pDevice->SetTextureStageState(2, D3DTSS_COLOROP, D3DTOP_DISABLE);
+	pDevice->SetTextureStageState(2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+}
+
+/// 측정용 nSize x nSize 디바이스
+static CSwDevice* CreateBenchDevice(UINT nSize)
+{
+	SW_PRESENT_PARAMETERS pp;
+	ZeroMemory(&pp, sizeof(pp));
+	pp.BackBufferWidth = nSize;
+	pp.BackBufferHeight = nSize;
+	pp.EnableAutoDepthStencil = TRUE;
+	pp.AutoDepthStencilFormat = D3DFMT_D16;
+	CSwDevice* pDevice = NULL;
+	SwCreateDevice(&pp, &pDevice);
+	return pDevice;
+}
+
+/// 드로우마다 작은 사각형 하나(정점 4개). 제출 비용이 래스터화 비용보다 크도록 화면에서 몇 픽셀만 덮는다.
+static CSwVertexBuffer* CreateBenchQuads(CSwDevice* pDevice, UINT nNumQuads)
+{
+	CSwVertexBuffer* pVB;
+	pDevice->CreateVertexBuffer(nNumQuads * 4 * sizeof(BENCHQUAD), 0, BENCH_QUADFVF, D3DPOOL_MANAGED, &pVB, NULL);
+	BENCHQUAD* pQuads;
+	pVB->Lock(0, 0, (void**)&pQuads, 0);
+	for (UINT i = 0; i < nNumQuads; ++i)
+	{
+		const float x = -0.95f + 1.9f * (float)(i % 50) / 50.0f;
+		const float y = -0.95f + 1.9f * (float)(i / 50 % 40) / 40.0f;
+		const BENCHQUAD quad[4] =
+		{
+			{ x, y + 0.03f, 0.5f, 0xffffffff, 0.0f, 0.0f }, { x + 0.03f, y + 0.03f, 0.5f, 0xffffffff, 1.0f, 0.0f },
+			{ x, y, 0.5f, 0xffffffff, 0.0f, 1.0f }, { x + 0.03f, y, 0.5f, 0xffffffff, 1.0f, 1.0f },
+		};
+		memcpy(pQuads + i * 4, quad, sizeof(quad));
+	}
+	pVB->Unlock();
+	return pVB;
+}
+
+/// 앞에서 Present()된 화면과 같은지 비교한다. pReference가 비어 있으면 지금 화면을 기준으로 삼는다.
+static bool MatchFrontBuffer(CSwDevice* pDevice, std::vector<DWORD>* pReference)
+{
+	const DWORD* pFront = pDevice->GetFrontBuffer();
+	const size_t nPixels = (size_t)pDevice->GetWidth() * pDevice->GetHeight();
+	if (pReference->empty())
+	{
+		pReference->assign(pFront, pFront + nPixels);
+		return true;
+	}
+	return std::equal(pReference->begin(), pReference->end(), pFront);
+}
+
+static bool BenchStateFiltering(UINT nRepeat)
+{
+	CSwDevice* pDevice = CreateBenchDevice(256);
+	if (pDevice == NULL)
+		return false;
+
+	CSwTexture* pTex0 = MakeTestTexture(64);
+	CSwTexture* pTex1 = MakeTestTexture(32);
+	CSwVertexBuffer* pVB = CreateBenchQuads(pDevice, BENCH_STATEDRAWS);
+
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetStreamSource(0, pVB, 0, sizeof(BENCHQUAD));
+	pDevice->SetFVF(BENCH_QUADFVF);
+
+	CSwStateBlock* pBlock;
+	pDevice->BeginStateBlock();
+	SetTut08States(pDevice, pTex0, pTex1);
+	pDevice->EndStateBlock(&pBlock);
+
+	// 0: Set*() 호출로 드로우마다 같은 상태를 다시 설정한다. 1: 같은 상태를 상태 블록으로 설정한다.
+	// 2: 드로우마다 두 텍스처를 맞바꾸어 상태가 실제로 바뀌게 한다. 걸러 낼 것이 없을 때의 기준선이다.
+	auto RenderFrame = [&](int nMode)
+	{
+		pDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+		pDevice->BeginScene();
+		for (UINT i = 0; i < BENCH_STATEDRAWS; ++i)
+		{
+			if (nMode == 1)
+				pBlock->Apply();
+			else if (nMode == 2 && (i & 1))
+				SetTut08States(pDevice, pTex1, pTex0);
+			else
+				SetTut08States(pDevice, pTex0, pTex1);
+			pDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, i * 4, 2);
+		}
+		pDevice->EndScene();
+		pDevice->Present(NULL, NULL, NULL, NULL);
+	};
+
+	const UINT nStateRepeat = std::min(nRepeat, (UINT)BENCH_STATEREPEAT);
+	printf("\n디바이스 상태 설정, 프레임마다 드로우 %u번, 드로우마다 상태 %u개, %u회 중 최소 시간\n",
+		BENCH_STATEDRAWS, pBlock->GetNumChanges(), nStateRepeat);
+	printf("%-10s %10s %11s %10s %10s %10s %10s\n", "방식", "프레임", "드로우당", "설정 호출", "버린 호출",
+		"상태 생성", "재사용");
+
+	bool bMatch = true;
+	std::vector<DWORD> reference;
+	static const char* const s_pszModes[] = { "Set*()", "상태 블록", "바뀌는 상태" };
+	for (int nMode = 0; nMode < 3; ++nMode)
+	{
+		double fTime = 1e30;
+		for (UINT r = 0; r < nStateRepeat; ++r)
+			MeasureOnce([&]() { RenderFrame(nMode); }, &fTime);
+
+		const SW_FRAMESTATS& stats = pDevice->GetFrameStats();
+		printf("%-10s %7.2f ms %8.2f us %10llu %10llu %10llu %10llu\n", s_pszModes[nMode],
+			fTime, fTime * 1000.0 / BENCH_STATEDRAWS, (unsigned long long)stats.nStateCalls,
+			(unsigned long long)stats.nStateCallsFiltered, (unsigned long long)stats.nDrawStatesBuilt,
+			(unsigned long long)stats.nDrawStatesReused);
+		// 기준선은 다른 텍스처로 그리므로 화면 비교에서 뺀다.
+		if (nMode < 2)
+			bMatch = MatchFrontBuffer(pDevice, &reference) && bMatch;
+	}
+	if (!bMatch)
+		printf("상태 블록으로 그린 화면이 다르다\n");
+
+	pBlock->Release();
+	pVB->Release();
+	pTex0->Release();
+	pTex1->Release();
+	pDevice->Release();
+	return bMatch;
+}
+
+/// Tut06의 Render()처럼 부분 집합마다 재질과 텍스처를 바꾸어 그린다. DEVICE는 CSwDevice 또는 CSwCommandList.
+template<typename DEVICE>
+static VOID EmitBenchSubsets(DEVICE* pTarget, CSwVertexBuffer* pVB, CSwTexture* const* ppTextures,
+	const D3DMATERIAL9* pMaterials, UINT nBegin, UINT nEnd)
+{
+	pTarget->SetStreamSource(0, pVB, 0, sizeof(BENCHQUAD));
+	pTarget->SetFVF(BENCH_QUADFVF);
+	for (UINT i = nBegin; i < nEnd; ++i)
+	{
+		pTarget->SetMaterial(&pMaterials[i % BENCH_LISTMATERIALS]);
+		pTarget->SetTexture(0, ppTextures[i % BENCH_LISTTEXTURES]);
+		pTarget->DrawPrimitive(D3DPT_TRIANGLESTRIP, i * 4, 2);
+	}
+}
+
+static bool BenchCommandLists(UINT nRepeat)
+{
+	CSwDevice* pDevice = CreateBenchDevice(256);
+	if (pDevice == NULL)
+		return false;
+
+	CSwVertexBuffer* pVB = CreateBenchQuads(pDevice, BENCH_STATEDRAWS);
+	CSwTexture* pTextures[BENCH_LISTTEXTURES];
+	for (UINT i = 0; i < BENCH_LISTTEXTURES; ++i)
+		pTextures[i] = MakeTestTexture(16 << i);
+	D3DMATERIAL9 materials[BENCH_LISTMATERIALS];
+	ZeroMemory(materials, sizeof(materials));
+	for (UINT i = 0; i < BENCH_LISTMATERIALS; ++i)
+	{
+		materials[i].Diffuse.r = materials[i].Ambient.r = (float)i / BENCH_LISTMATERIALS;
+		materials[i].Diffuse.g = materials[i].Ambient.g = 1.0f;
+		materials[i].Diffuse.b = materials[i].Ambient.b = 1.0f;
+		materials[i].Diffuse.a = materials[i].Ambient.a = 1.0f;
+	}
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+
+	// 정적인 장면은 한 번 기록해 두고, 바뀌는 장면은 매 프레임 작업자마다 한 조각씩 기록한다.
+	CSwCommandList* pStatic;
+	pDevice->CreateCommandList(&pStatic);
+	EmitBenchSubsets(pStatic, pVB, pTextures, materials, 0, BENCH_STATEDRAWS);
+	pStatic->Close();
+
+	CSwThreadPool pool(0);
+	const UINT nNumParts = pool.GetNumThreads();
+	std::vector<CSwCommandList*> parts(nNumParts);
+	for (CSwCommandList*& pPart : parts)
+		pDevice->CreateCommandList(&pPart);
+
+	const char* szNames[3] = { "Set*()", "명령 목록", "작업자 기록" };
+	auto RenderFrame = [&](int nMethod)
+	{
+		pDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+		pDevice->BeginScene();
+		if (nMethod == 0)
+		{
+			EmitBenchSubsets(pDevice, pVB, pTextures, materials, 0, BENCH_STATEDRAWS);
+		}
+		else if (nMethod == 1)
+		{
+			pDevice->ExecuteCommandList(pStatic);
+		}
+		else
+		{
+			pool.ParallelFor(nNumParts, [&](UINT nPart, UINT)
+			{
+				parts[nPart]->Reset();
+				EmitBenchSubsets(parts[nPart], pVB, pTextures, materials, nPart * BENCH_STATEDRAWS / nNumParts,
+					(nPart + 1) * BENCH_STATEDRAWS / nNumParts);
+				parts[nPart]->Close();
+			});
+			for (CSwCommandList* pPart : parts)
+				pDevice->ExecuteCommandList(pPart);
+		}
+		pDevice->EndScene();
+		pDevice->Present(NULL, NULL, NULL, NULL);
+	};
+
+	const UINT nListRepeat = std::min(nRepeat, (UINT)BENCH_STATEREPEAT);
+	printf("\n명령 목록, 프레임마다 부분 집합 %u개(재질, 텍스처, 그리기), %u회 중 최소 시간\n",
+		BENCH_STATEDRAWS, nListRepeat);
+	printf("기록된 목록: 명령 %u개, %u바이트(드로우당 %u바이트), 작업자 %u명\n", pStatic->GetNumCommands(),
+		pStatic->GetSize(), pStatic->GetSize() / BENCH_STATEDRAWS, nNumParts);
+	printf("%-12s %10s %11s\n", "방식", "프레임", "드로우당");
+
+	bool bMatch = true;
+	std::vector<DWORD> reference;
+	for (int m = 0; m < 3; ++m)
+	{
+		double fTime = 1e30;
+		for (UINT r = 0; r < nListRepeat; ++r)
+			MeasureOnce([&]() { RenderFrame(m); }, &fTime);
+		printf("%-12s %7.2f ms %8.2f us\n", szNames[m], fTime, fTime * 1000.0 / BENCH_STATEDRAWS);
+		bMatch = MatchFrontBuffer(pDevice, &reference) && bMatch;
+	}
+	if (!bMatch)
+		printf("명령 목록으로 그린 화면이 다르다\n");
+
+	for (CSwCommandList* pPart : parts)
+		pPart->Release();
+	pStatic->Release();
+	for (CSwTexture* pTexture : pTextures)
+		pTexture->Release();
+	pVB->Release();
+	pDevice->Release();
+	return bMatch;
+}
+
+
+
+
+/**-----------------------------------------------------------------------------
+ * 변 함수 커널
+ *------------------------------------------------------------------------------
+ */
+struct BENCHTLVERTEX
+{
+	float	x, y, z, rhw;
+	DWORD	color;
+};
+
+#define BENCH_TLFVF		(D3DFVF_XYZRHW | D3DFVF_DIFFUSE)
+
+static bool BenchEdgeKernels(UINT nRepeat)
+{
+	CSwDevice* pDevice = CreateBenchDevice(BENCH_EDGESIZE);
+	if (pDevice == NULL)
+		return false;
+
+	// 0번 삼각형은 Tut02의 삼각형(300x300 창 기준)을 화면 크기에 맞춘 것이다.
+	// 나머지는 화면 가운데를 중심으로 조금씩 돌린 큰 삼각형으로, 변이 여러 방향으로 블록을 가로지른다.
+	std::vector<BENCHTLVERTEX> vertices;
+	const float fScale = BENCH_EDGESIZE / 300.0f;
+	const BENCHTLVERTEX tut02[3] =
+	{
+		{ 150.0f * fScale,  50.0f * fScale, 0.5f, 1.0f, 0xffff0000 },
+		{ 250.0f * fScale, 250.0f * fScale, 0.5f, 1.0f, 0xff00ff00 },
+		{  50.0f * fScale, 250.0f * fScale, 0.5f, 1.0f, 0xff00ffff },
+	};
+	vertices.assign(tut02, tut02 + 3);
+	const float fCenter = BENCH_EDGESIZE * 0.5f;
+	for (UINT i = 0; i < BENCH_EDGELAYERS; ++i)
+	{
+		const float fAngle = 0.37f * i;
+		const float fRadius = BENCH_EDGESIZE * (0.6f + 0.1f * (float)(i % 4));
+		for (UINT k = 0; k < 3; ++k)
+		{
+			const float a = fAngle + 2.0943951f * k;
+			const BENCHTLVERTEX v = { fCenter + fRadius * cosf(a), fCenter + fRadius * sinf(a), 0.5f, 1.0f,
+				0xff000000 | (i * 0x050309u + k * 0x402010u) };
+			vertices.push_back(v);
+		}
+	}
+
+	CSwVertexBuffer* pVB;
+	pDevice->CreateVertexBuffer((UINT)(vertices.size() * sizeof(BENCHTLVERTEX)), 0, BENCH_TLFVF, D3DPOOL_MANAGED,
+		&pVB, NULL);
+	BENCHTLVERTEX* pDest;
+	pVB->Lock(0, 0, (void**)&pDest, 0);
+	memcpy(pDest, vertices.data(), vertices.size() * sizeof(BENCHTLVERTEX));
+	pVB->Unlock();
+
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetRenderState(D3DRS_ZFUNC, D3DCMP_ALWAYS);
+	pDevice->SetStreamSource(0, pVB, 0, sizeof(BENCHTLVERTEX));
+	pDevice->SetFVF(BENCH_TLFVF);
+
+	auto RenderFrame = [&](bool bFill)
+	{
+		pDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+		pDevice->BeginScene();
+		if (bFill)
+			pDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 3, BENCH_EDGELAYERS);
+		else
+			pDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+		pDevice->EndScene();
+		pDevice->Present(NULL, NULL, NULL, NULL);
+	};
+
+	static const SW_EDGEKERNEL s_eKernels[] = { SW_EDGEKERNEL_SCALAR, SW_EDGEKERNEL_SSE41, SW_EDGEKERNEL_AVX2 };
+	const SW_EDGEKERNEL eInitial = SwGetEdgeKernel();
+	const UINT nEdgeRepeat = std::min(nRepeat, (UINT)BENCH_EDGEREPEAT);
+	printf("\n변 함수 커널, %ux%u 화면, %u회 중 최소 시간\n", BENCH_EDGESIZE, BENCH_EDGESIZE, nEdgeRepeat);
+	printf("%-10s %12s %8s %14s %8s %6s\n", "커널", "Tut02", "배율", "채우기", "배율", "일치");
+
+	bool bMatch = true;
+	std::vector<DWORD> references[2];
+	double fScalarTimes[2] = { 0.0, 0.0 };
+	for (SW_EDGEKERNEL eKernel : s_eKernels)
+	{
+		if (SwSetEdgeKernel(eKernel) != eKernel)
+		{
+			printf("%-10s 이 CPU에서 지원하지 않음\n", SwGetEdgeKernelName(eKernel));
+			continue;
+		}
+
+		// 스칼라 구현이 먼저 그려 기준 화면이 된다.
+		double fTimes[2];
+		bool bKernelMatch = true;
+		for (int b = 0; b < 2; ++b)
+		{
+			fTimes[b] = 1e30;
+			for (UINT r = 0; r < nEdgeRepeat; ++r)
+				MeasureOnce([&]() { RenderFrame(b != 0); }, &fTimes[b]);
+			bKernelMatch = MatchFrontBuffer(pDevice, &references[b]) && bKernelMatch;
+			if (eKernel == SW_EDGEKERNEL_SCALAR)
+				fScalarTimes[b] = fTimes[b];
+		}
+		printf("%-10s %9.3f ms %7.2fx %11.3f ms %7.2fx %6s\n", SwGetEdgeKernelName(eKernel), fTimes[0],
+			fScalarTimes[0] / fTimes[0], fTimes[1], fScalarTimes[1] / fTimes[1], bKernelMatch ? "예" : "아니오");
+		bMatch = bKernelMatch && bMatch;
+	}
+	SwSetEdgeKernel(eInitial);
+	if (!bMatch)
+		printf("스칼라 구현과 화면이 다른 커널이 있다\n");
+
+	pVB->Release();
+	pDevice->Release();
+	return bMatch;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 구간 추적 비용
+ *------------------------------------------------------------------------------
+ */
+static bool BenchTrace(UINT nRepeat)
+{
+	CSwDevice* pDevice = CreateBenchDevice(256);
+	if (pDevice == NULL)
+		return false;
+
+	CSwTexture* pTexture = MakeTestTexture(64);
+	CSwVertexBuffer* pSmallVB = CreateBenchQuads(pDevice, BENCH_STATEDRAWS);
+	CSwVertexBuffer* pLargeVB;
+	pDevice->CreateVertexBuffer(4 * sizeof(BENCHQUAD), 0, BENCH_QUADFVF, D3DPOOL_MANAGED, &pLargeVB, NULL);
+	BENCHQUAD* pQuad;
+	pLargeVB->Lock(0, 0, (void**)&pQuad, 0);
+	const BENCHQUAD screen[4] =
+	{
+		{ -1.0f, 1.0f, 0.5f, 0xffffffff, 0.0f, 0.0f }, { 1.0f, 1.0f, 0.5f, 0xffffffff, 4.0f, 0.0f },
+		{ -1.0f, -1.0f, 0.5f, 0xffffffff, 0.0f, 4.0f }, { 1.0f, -1.0f, 0.5f, 0xffffffff, 4.0f, 4.0f },
+	};
+	memcpy(pQuad, screen, sizeof(screen));
+	pLargeVB->Unlock();
+
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetRenderState(D3DRS_ZFUNC, D3DCMP_ALWAYS);
+	pDevice->SetFVF(BENCH_QUADFVF);
+	pDevice->SetTexture(0, pTexture);
+
+	// 예제들의 Render()처럼 단계마다 구간을 둔다. 예제 크기의 장면은 드로우마다 구간을 두고,
+	// 작은 드로우 장면은 디바이스처럼 드로우를 모은 패스에 구간 하나를 둔다.
+	auto RenderFrame = [&](bool bSmall)
+	{
+		SW_TRACE_SCOPE("Frame");
+		SW_TRACE_CALL("Clear", pDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
+			D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
+		pDevice->BeginScene();
+		pDevice->SetStreamSource(0, bSmall ? pSmallVB : pLargeVB, 0, sizeof(BENCHQUAD));
+		if (bSmall)
+		{
+			SW_TRACE_SCOPE("Draws");
+			for (UINT i = 0; i < BENCH_STATEDRAWS; ++i)
+				pDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, i * 4, 2);
+		}
+		else
+		{
+			for (UINT i = 0; i < BENCH_TRACEDRAWS; ++i)
+				SW_TRACE_CALL("Draw", pDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2));
+		}
+		SW_TRACE_CALL("EndScene", pDevice->EndScene());
+		SW_TRACE_CALL("Present", pDevice->Present(NULL, NULL, NULL, NULL));
+	};
+
+	const UINT nTraceRepeat = std::min(nRepeat, (UINT)BENCH_TRACEREPEAT);
+	printf("\n구간 추적, 추적을 끈 것과 켠 것을 번갈아 %u회 그린 중 최소 시간\n", nTraceRepeat);
+	printf("%-16s %10s %10s %8s %10s %10s\n", "장면", "끔", "켬", "비용", "구간 수", "구간당");
+
+	bool bRecorded = true;
+	std::string strSummary;
+	for (int b = 0; b < 2; ++b)
+	{
+		// 번갈아 재서 시간에 따른 변동이 한쪽에만 실리지 않게 한다.
+		double fTimeOff = 1e30, fTimeOn = 1e30;
+		for (UINT r = 0; r < nTraceRepeat; ++r)
+		{
+			SwTraceEnable(FALSE);
+			MeasureOnce([&]() { RenderFrame(b != 0); }, &fTimeOff);
+			SwTraceReset();
+			SwTraceEnable(TRUE);
+			MeasureOnce([&]() { RenderFrame(b != 0); }, &fTimeOn);
+		}
+		SwTraceEnable(FALSE);
+
+		std::vector<SW_TRACEEVENT> events;
+		SwTraceCollect(&events, NULL);
+		printf("%-16s %7.2f ms %7.2f ms %+7.2f%% %10zu %7.0f ns\n", b ? "작은 드로우" : "예제 크기", fTimeOff,
+			fTimeOn, (fTimeOn - fTimeOff) * 100.0 / fTimeOff, events.size(),
+			events.empty() ? 0.0 : (fTimeOn - fTimeOff) * 1e6 / events.size());
+		if (b == 0)
+			strSummary = SwTraceFormatSummary();
+		bRecorded = !events.empty() && bRecorded;
+		SwTraceReset();
+	}
+	printf("\n예제 크기 장면의 구간별 시간\n%s", strSummary.c_str());
+
+	pLargeVB->Release();
+	pSmallVB->Release();
+	pTexture->Release();
+	pDevice->Release();
+	return bRecorded;
+}
+
+
+
+
+/**-----------------------------------------------------------------------------
+ * 프로그램 시작점
+ *------------------------------------------------------------------------------
+ */
+int main(int argc, char* argv[])
+{
+	const UINT nNumVertices = (argc > 1) ? (UINT)atoi(argv[1]) : 65536;
+	const UINT nRepeat = (argc > 2) ? (UINT)atoi(argv[2]) : 50;
+	if (nNumVertices == 0 || nRepeat == 0)
+	{
+		printf("사용법: Benchmark [정점 수] [반복 횟수]\n");
+		return 1;
+	}
+
+	const bool bVertexMatch = BenchVertexKernels(nNumVertices, nRepeat);
+	const bool bBitmapMatch = BenchBitmapDecoders(nRepeat);
+	const bool bMipmapMatch = BenchMipmaps(nRepeat);
+	const bool bBlockMatch = BenchBlockCompression(nRepeat);
+	const bool bCombinerMatch = BenchCombiner(nRepeat);
+	const bool bBakeMatch = BenchLightmapBake(nRepeat);
+	const bool bStateMatch = BenchStateFiltering(nRepeat);
+	const bool bListMatch = BenchCommandLists(nRepeat);
+	const bool bEdgeMatch = BenchEdgeKernels(nRepeat);
+	const bool bTraceMatch = BenchTrace(nRepeat);
+	return (bVertexMatch && bBitmapMatch && bMipmapMatch && bBlockMatch && bCombinerMatch && bBakeMatch &&
+		bStateMatch && bListMatch && bEdgeMatch && bTraceMatch) ? 0 : 1;
+}
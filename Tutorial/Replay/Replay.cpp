@@ -0,0 +1,216 @@
+/**-----------------------------------------------------------------------------
+ * 파일: Replay.cpp
+ *
+ * 설명: 캡처 파일(SwCapture.h)을 창 없이 소프트웨어 디바이스에서 다시 실행한다.
+ *       디바이스 호출 종류마다 호출 수와 전체, 평균, 최대 시간을 재고 Present()로 나뉜 프레임마다
+ *       실행 시간과 그리기 수를 보인다. 파일을 읽고 압축을 푸는 시간은 재지 않는다.
+ *       반복 실행하면 호출과 프레임마다 가장 짧은 시간을 쓰고, 마지막 전면 버퍼의 해시를 보여
+ *       다른 빌드나 다른 스레드 수로 재생한 결과가 같은지 비교할 수 있게 한다.
+ *       추적 파일을 주면 마지막 실행의 디바이스 내부 구간(SwTrace.h)을 chrome://tracing 형식으로 쓴다.
+ *
+ *       사용법: Replay <캡처 파일> [반복 횟수] [스레드 수] [추적 파일]
+ *------------------------------------------------------------------------------
+ */
+
+#include "SwCapture.h"
+#include "SwHash.h"
+#include "SwTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+
+
+ /**-----------------------------------------------------------------------------
+  *  측정 결과
+  *------------------------------------------------------------------------------
+  */
+struct REPLAYCALLSTATS
+{
+	UINT	nCount;
+	double	fTotal;		/// ms
+	double	fMax;		/// ms
+};
+
+struct REPLAYFRAME
+{
+	double	fTime;		/// ms
+	UINT	nDraws;
+};
+
+
+
+
+/**-----------------------------------------------------------------------------
+ * 시간 측정
+ *------------------------------------------------------------------------------
+ */
+static double GetTimeMs()
+{
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+
+
+
+/**-----------------------------------------------------------------------------
+ * 캡처 파일을 처음부터 끝까지 한 번 실행한다.
+ * 실패하면 그 기록을 알리고 false를 돌려준다.
+ *------------------------------------------------------------------------------
+ */
+static bool ReplayOnce(const char* pFilename, UINT nNumThreads, std::vector<REPLAYCALLSTATS>* pCalls,
+	std::vector<REPLAYFRAME>* pFrames, UINT64* pHash)
+{
+	CSwCaptureReader reader;
+	if (FAILED(reader.Open(pFilename)))
+	{
+		printf("캡처 파일을 열 수 없습니다: %s\n", pFilename);
+		return false;
+	}
+
+	CSwCapturePlayer player(nNumThreads);
+	pCalls->assign(SW_CAP_NUMCALLS, REPLAYCALLSTATS());
+	pFrames->clear();
+
+	REPLAYFRAME frame = { 0.0, 0 };
+	UINT64 nRecord = 0;
+	SW_CAPRECORD record;
+	const BYTE* pArgs;
+	HRESULT hr;
+	while ((hr = reader.Next(&record, &pArgs)) == S_OK)
+	{
+		const double fStart = GetTimeMs();
+		const HRESULT hrCall = player.Execute(record, pArgs);
+		const double fTime = GetTimeMs() - fStart;
+
+		if (FAILED(hrCall))
+		{
+			printf("기록 %llu(%s)을 실행하지 못했습니다: 0x%08x\n", (unsigned long long)nRecord,
+				SwGetCaptureCallName((SW_CAPCALL)record.wCall), (unsigned)hrCall);
+			return false;
+		}
+
+		REPLAYCALLSTATS& call = (*pCalls)[record.wCall];
+		++call.nCount;
+		call.fTotal += fTime;
+		call.fMax = std::max(call.fMax, fTime);
+
+		frame.fTime += fTime;
+		if (record.wCall == SW_CAP_DRAWPRIMITIVE || record.wCall == SW_CAP_DRAWINDEXEDPRIMITIVE)
+			++frame.nDraws;
+		if (record.wCall == SW_CAP_PRESENT)
+		{
+			pFrames->push_back(frame);
+			frame.fTime = 0.0;
+			frame.nDraws = 0;
+		}
+		++nRecord;
+	}
+	if (FAILED(hr))
+	{
+		printf("캡처 파일이 손상되었습니다(기록 %llu)\n", (unsigned long long)nRecord);
+		return false;
+	}
+
+	CSwDevice* pDevice = player.GetDevice();
+	*pHash = pDevice ? SwHash64(pDevice->GetFrontBuffer(),
+		(size_t)pDevice->GetWidth() * pDevice->GetHeight() * sizeof(DWORD)) : 0;
+	return true;
+}
+
+
+
+
+/**-----------------------------------------------------------------------------
+ * 프로그램 시작점
+ *------------------------------------------------------------------------------
+ */
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		printf("사용법: Replay <캡처 파일> [반복 횟수] [스레드 수] [추적 파일]\n");
+		return 1;
+	}
+	const char* pFilename = argv[1];
+	const UINT nRepeat = std::max((argc > 2) ? atoi(argv[2]) : 1, 1);
+	const UINT nNumThreads = (argc > 3) ? (UINT)atoi(argv[3]) : 0;
+	const char* pTraceFilename = (argc > 4) ? argv[4] : NULL;
+	SwTraceEnable(pTraceFilename != NULL);
+
+	// 반복마다 호출 종류와 프레임별로 가장 짧은 시간을 남긴다.
+	std::vector<REPLAYCALLSTATS> calls, best;
+	std::vector<REPLAYFRAME> frames, bestFrames;
+	UINT64 nHash = 0;
+	for (UINT r = 0; r < nRepeat; ++r)
+	{
+		UINT64 nPassHash;
+		SwTraceReset();
+		if (!ReplayOnce(pFilename, nNumThreads, &calls, &frames, &nPassHash))
+			return 1;
+
+		if (r == 0)
+		{
+			best = calls;
+			bestFrames = frames;
+			nHash = nPassHash;
+			continue;
+		}
+		for (UINT i = 0; i < SW_CAP_NUMCALLS; ++i)
+		{
+			if (calls[i].fTotal < best[i].fTotal)
+				best[i] = calls[i];
+		}
+		for (size_t i = 0; i < frames.size() && i < bestFrames.size(); ++i)
+			bestFrames[i].fTime = std::min(bestFrames[i].fTime, frames[i].fTime);
+		if (nPassHash != nHash)
+			printf("경고: 반복 %u의 결과 이미지가 첫 실행과 다릅니다\n", r + 1);
+	}
+
+	double fTotal = 0.0;
+	for (const REPLAYCALLSTATS& call : best)
+		fTotal += call.fTotal;
+
+	printf("%s, %u회 실행 중 최소 시간\n\n", pFilename, nRepeat);
+	printf("%-22s %9s %11s %10s %10s %6s\n", "호출", "횟수", "전체", "평균", "최대", "비율");
+	for (UINT i = 0; i < SW_CAP_NUMCALLS; ++i)
+	{
+		const REPLAYCALLSTATS& call = best[i];
+		if (call.nCount == 0)
+			continue;
+		printf("%-22s %9u %8.2f ms %7.2f us %7.2f us %5.1f%%\n", SwGetCaptureCallName((SW_CAPCALL)i),
+			call.nCount, call.fTotal, call.fTotal * 1000.0 / call.nCount, call.fMax * 1000.0,
+			fTotal > 0.0 ? call.fTotal * 100.0 / fTotal : 0.0);
+	}
+	printf("%-22s %9s %8.2f ms\n", "합계", "", fTotal);
+
+	if (!bestFrames.empty())
+	{
+		printf("\n%-8s %10s %8s\n", "프레임", "시간", "그리기");
+		double fFrameTotal = 0.0, fFrameMax = 0.0;
+		for (size_t i = 0; i < bestFrames.size(); ++i)
+		{
+			printf("%-8u %7.2f ms %8u\n", (UINT)i, bestFrames[i].fTime, bestFrames[i].nDraws);
+			fFrameTotal += bestFrames[i].fTime;
+			fFrameMax = std::max(fFrameMax, bestFrames[i].fTime);
+		}
+		printf("평균 %.2f ms, 최대 %.2f ms\n", fFrameTotal / bestFrames.size(), fFrameMax);
+	}
+
+	printf("\n전면 버퍼 해시: %016llx\n", (unsigned long long)nHash);
+
+	if (pTraceFilename)
+	{
+		if (FAILED(SwTraceWriteJson(pTraceFilename)))
+		{
+			printf("추적 파일을 쓸 수 없습니다: %s\n", pTraceFilename);
+			return 1;
+		}
+		printf("\n마지막 실행의 구간별 시간\n%s", SwTraceFormatSummary().c_str());
+	}
+	return 0;
+}
@@ -0,0 +1,1219 @@
+/**-----------------------------------------------------------------------------
+ * 파일: SceneBench.cpp
+ *
+ * 설명: 여덟 예제(Tut01 ~ Tut08)의 장면을 창 없이 소프트웨어 디바이스로 그려 성능을 잰다.
+ *       예제들은 D3D9로 그리므로 여기서는 같은 정점, 상태, 애니메이션을 CSwDevice와 SwMath로 옮겨 그린다.
+ *       애니메이션은 고정 간격 시계(SwClock.h)로 움직이므로 같은 설정이면 어느 컴퓨터에서나 같은 프레임들이
+ *       그려지고, 마지막 전면 버퍼의 해시로 빌드나 스레드 수가 달라도 결과가 같은지 비교할 수 있다.
+ *       해상도와 스레드 수의 조합마다 장면을 정한 프레임 수만큼 그려 프레임률, 프레임 시간 백분위,
+ *       초당 삼각형 수와 픽셀 수를 표로 보이고 JSON 파일로 쓴다.
+ *       프레임 시간은 Clear()부터 Present()까지다. 텍스처 읽기와 라이트맵 굽기는 재지 않는다.
+ *       LightsQuant, MeshesQuant는 Tut04의 원통과 Tut06의 메시를 양자화한 정점(SwVertexQuant.h)으로 그린다.
+ *       양자화 오차와 정점 크기를 보이고, 같은 해상도와 스레드 수의 float 장면과 마지막 화면, 프레임 시간을 비교한다.
+ *       -trace를 주면 프레임마다 예제들처럼 구간 추적(SwTrace.h)을 끄고 켠 두 번을 번갈아 그려
+ *       추적을 켰을 때 늘어난 시간을 함께 보인다. 튀는 프레임에 흔들리지 않도록 프레임마다의 차이의 중앙값을
+ *       끈 쪽 프레임 시간의 중앙값으로 나누어 구한다. 이때도 다른 값들은 추적을 끈 쪽으로 계산한다.
+ *
+ *       -capture를 주면 장면을 만들 때부터 마지막 프레임까지의 디바이스 호출을 해상도, 스레드 수, 장면마다
+ *       캡처 파일(SwCapture.h)로 기록하고, 그 파일을 같은 스레드 수로 재생한 마지막 화면의 해시가 그린 결과와
+ *       같은지 확인한다. 파일 이름은 "<접두어>_<장면>_<W>x<H>_t<스레드 수>.swcap"이다.
+ *       이때 프레임 시간에는 기록 비용이 들어간다.
+ *
+ *       사용법: SceneBench [-frames:N] [-res:WxH[,WxH...]] [-threads:N[,N...]] [-scenes:이름[,이름...]]
+ *                          [-out:파일] [-data:폴더] [-trace] [-capture:접두어]
+ *       스레드 수 0은 하드웨어 스레드 수다. 예제 파일(banana.bmp, tiger.x 등)은 -data 폴더, 실행 폴더,
+ *       상위 폴더 순서로 찾는다. env2.bmp처럼 없는 텍스처는 합성 이미지로 대신하고, tiger.x가 없으면
+ *       Meshes, MeshesQuant 장면을 건너뛴다.
+ *------------------------------------------------------------------------------
+ */
+
+#include "SwBitmap.h"
+#include "SwCapture.h"
+#include "SwClock.h"
+#include "SwDevice.h"
+#include "SwHash.h"
+#include "SwLightmap.h"
+#include "SwMath.h"
+#include "SwMesh.h"
+#include "SwMipmap.h"
+#include "SwResource.h"
+#include "SwTrace.h"
+#include "SwVertexQuant.h"
+#include "SwXFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+
+
+ /**-----------------------------------------------------------------------------
+  *  측정 설정
+  *------------------------------------------------------------------------------
+  */
+#define SCENE_FRAMES		300		/// 장면마다 재는 프레임 수(기본값)
+#define SCENE_WARMUP		5		/// 재기 전에 그려 캐시와 작업자 스레드를 데우는 프레임 수
+#define SCENE_LIGHTMAPSIZE	128		/// Tut08의 LIGHTMAP_SIZE
+#define SCENE_LIGHTMAPSAMPLES	64		/// Tut08의 LIGHTMAP_SAMPLES
+#define SCENE_SYNTHSIZE		256		/// 없는 텍스처를 대신할 합성 이미지의 한 변 크기
+#define SCENE_QUANTPSNR		30.0	/// 양자화한 장면이 float 장면과 이만큼(dB) 가까워야 한다
+
+/// 장면마다 디바이스에 만든 자원
+struct SCENEDATA
+{
+	CSwVertexBuffer*	pVB;
+	CSwIndexBuffer*		pIB;
+	float				fAspect;	/// 후면 버퍼의 폭 / 높이
+};
+
+/// 양자화한 정점. 원래의 float 정점과 순서가 같다.
+struct SCENEQUANT
+{
+	SW_VERTEXQUANT		Quant;
+	UINT				nVertexSize;
+	std::vector<BYTE>	Vertices;
+};
+
+/// 모든 해상도와 스레드 수에서 함께 쓰는, 디바이스와 무관한 자원
+struct SCENEASSETS
+{
+	CSwTexture*					pBanana;		/// Tut05
+	CSwTexture*					pEnv;			/// Tut08 0번 스테이지
+	CSwTexture*					pLightmap;		/// Tut08 1번 스테이지
+	SW_MESHDATA					Mesh;			/// Tut06
+	std::vector<D3DMATERIAL9>	MeshMaterials;
+	std::vector<CSwTexture*>	MeshTextures;	/// 재질마다 하나. 텍스처가 없는 재질은 NULL
+	bool						bMesh;
+	SCENEQUANT					CylinderQuant;	/// Tut04
+	SCENEQUANT					MeshQuant;		/// Tut06
+};
+
+/// 장면 하나. pfnCreate가 false를 돌려주면 그 장면은 건너뛴다.
+struct BENCHSCENE
+{
+	const char*	szName;
+	DWORD		dwClearFlags;
+	D3DCOLOR	ClearColor;
+	bool		(*pfnCreate)(CSwDevice* pDevice, SCENEDATA* pData);
+	VOID		(*pfnRender)(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock& clock);
+	const char*	szReference;	/// 마지막 화면과 프레임 시간을 비교할 장면. 없으면 NULL
+};
+
+/// 해상도, 스레드 수, 장면 한 조합의 결과
+struct SCENERESULT
+{
+	std::string	strScene;
+	std::string	strReference;	/// BENCHSCENE::szReference
+	UINT		nWidth;
+	UINT		nHeight;
+	UINT		nThreads;		/// 요청한 스레드 수(0이면 하드웨어 스레드 수)
+	UINT		nDeviceThreads;	/// 디바이스가 실제로 쓴 스레드 수
+	UINT		nFrames;
+	double		fTotalMs;
+	double		fMeanMs;
+	double		fP50Ms;
+	double		fP95Ms;
+	double		fP99Ms;
+	double		fMaxMs;
+	UINT64		nTriangles;		/// 드로우 호출로 들어온 삼각형 수의 합
+	UINT64		nPixels;		/// 깊이 테스트를 통과하여 기록된 픽셀 수의 합
+	UINT64		nHash;			/// 마지막 전면 버퍼
+	double		fTraceMs;		/// 추적을 켜고 그린 시간의 합. -trace가 없으면 0
+	double		fTraceOverhead;	/// 추적을 켰을 때 늘어난 시간(%)
+	std::vector<DWORD>	Frame;	/// 마지막 전면 버퍼
+	std::string	strCapture;		/// -capture로 쓴 캡처 파일. 없으면 빈 문자열
+	UINT64		nCaptureRecords;
+	UINT64		nCaptureBytes;	/// 압축한 크기
+	UINT64		nReplayHash;	/// 캡처를 재생한 마지막 전면 버퍼. 재생하지 못했으면 0
+};
+
+static SCENEASSETS					g_Assets;
+static std::vector<std::string>		g_DataDirs;		/// 예제 파일을 찾을 폴더
+static bool							g_bTrace;		/// -trace
+static const char*					g_pCapturePrefix;	/// -capture. 없으면 NULL
+
+
+
+/**-----------------------------------------------------------------------------
+ * 시간 측정
+ *------------------------------------------------------------------------------
+ */
+static double GetTimeMs()
+{
+	using namespace std::chrono;
+	return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+/// 정렬된 값에서 가장 가까운 순위의 백분위 값(SwTraceSummarize()와 같은 방식)
+static double Percentile(const std::vector<double>& sorted, double fPercent)
+{
+	size_t nRank = (size_t)std::ceil(fPercent / 100.0 * sorted.size());
+	return sorted[(nRank > 0 ? nRank : 1) - 1];
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 예제 파일
+ *------------------------------------------------------------------------------
+ */
+/// g_DataDirs에서 처음 찾은 경로. 없으면 빈 문자열
+static std::string FindDataFile(const char* pFilename)
+{
+	for (const std::string& strDir : g_DataDirs)
+	{
+		const std::string strPath = strDir.empty() ? pFilename : strDir + "/" + pFilename;
+		FILE* pFile = fopen(strPath.c_str(), "rb");
+		if (pFile)
+		{
+			fclose(pFile);
+			return strPath;
+		}
+	}
+	return std::string();
+}
+
+/// 밝기가 다른 체크 무늬 위에 색 기울기를 얹은 합성 이미지(전체 밉 체인)
+static CSwTexture* MakeSyntheticTexture(UINT nSize)
+{
+	CSwTexture* pTexture = new CSwTexture(nSize, nSize, 0, D3DFMT_A8R8G8B8);
+	D3DLOCKED_RECT rect;
+	pTexture->LockRect(0, &rect, NULL, 0);
+	for (UINT y = 0; y < nSize; ++y)
+	{
+		DWORD* pRow = (DWORD*)((BYTE*)rect.pBits + (size_t)y * rect.Pitch);
+		for (UINT x = 0; x < nSize; ++x)
+		{
+			const UINT nCheck = ((x / 32 + y / 32) & 1) ? 255 : 160;
+			const UINT r = nCheck * x / nSize, g = nCheck * y / nSize, b = nCheck / 2;
+			pRow[x] = 0xff000000 | (r << 16) | (g << 8) | b;
+		}
+	}
+	pTexture->UnlockRect(0);
+	SwGenerateMipmaps(pTexture, SW_MIPFILTER_BOX, SW_MIPMAP_WRAP);
+	return pTexture;
+}
+
+/// 예제 BMP를 읽는다. 없으면 합성 이미지로 대신하고 그렇게 했다고 알린다.
+static CSwTexture* LoadTexture(const char* pFilename)
+{
+	CSwTexture* pTexture;
+	const std::string strPath = FindDataFile(pFilename);
+	if (!strPath.empty() && SUCCEEDED(SwCreateTextureFromBitmap(strPath.c_str(), 0, &pTexture)))
+		return pTexture;
+
+	printf("%s를 찾을 수 없어 합성 이미지로 대신합니다\n", pFilename);
+	return MakeSyntheticTexture(SCENE_SYNTHSIZE);
+}
+
+/// Tut08의 BakeLightmap()과 같은 벽면과 스폿라이트로 라이트맵을 굽는다.
+static CSwTexture* BakeTut08Lightmap()
+{
+	static const float s_Corners[4][4] =	/// x, y, u, v(삼각형 띠 순서)
+	{
+		{ -1.0f, 1.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f, 0.0f },
+		{ -1.0f, -1.0f, 0.0f, 1.0f }, { 1.0f, -1.0f, 1.0f, 1.0f },
+	};
+	SW_BAKEVERTEX vertices[4];
+	for (UINT i = 0; i < 4; ++i)
+	{
+		vertices[i].Position = SwVec3(s_Corners[i][0], s_Corners[i][1], 0.0f);
+		vertices[i].Normal = SwVec3(0.0f, 0.0f, -1.0f);
+		vertices[i].u = s_Corners[i][2];
+		vertices[i].v = s_Corners[i][3];
+	}
+	static const DWORD indices[] = { 0, 1, 2, 2, 1, 3 };
+
+	D3DLIGHT9 light;
+	ZeroMemory(&light, sizeof(light));
+	light.Type = D3DLIGHT_SPOT;
+	light.Diffuse.r = light.Diffuse.g = light.Diffuse.b = 1.0f;
+	light.Position.z = -1.5f;
+	light.Direction.z = 1.0f;
+	light.Range = 100.0f;
+	light.Attenuation0 = 0.2f;
+	light.Attenuation2 = 0.35f;
+	light.Theta = 0.6f;
+	light.Phi = 1.4f;
+	light.Falloff = 1.0f;
+
+	SW_BAKESCENE scene;
+	ZeroMemory(&scene, sizeof(scene));
+	scene.pVertices = vertices;
+	scene.nNumVertices = 4;
+	scene.pIndices = indices;
+	scene.nNumTriangles = 2;
+	scene.pLights = &light;
+	scene.nNumLights = 1;
+	scene.Sky.r = scene.Sky.g = 0.15f;
+	scene.Sky.b = 0.2f;
+
+	SW_BAKEPARAMS params;
+	params.nWidth = params.nHeight = SCENE_LIGHTMAPSIZE;
+	params.nLevels = 0;
+	params.nSamples = SCENE_LIGHTMAPSAMPLES;
+	params.nBounces = 1;
+
+	CSwTexture* pLightmap;
+	if (FAILED(SwBakeLightmap(&scene, &params, &pLightmap)))
+	{
+		printf("라이트맵을 굽지 못해 합성 이미지로 대신합니다\n");
+		return MakeSyntheticTexture(SCENE_LIGHTMAPSIZE);
+	}
+	return pLightmap;
+}
+
+/// Tut06의 InitGeometry()처럼 tiger.x와 재질 텍스처를 읽는다.
+static bool LoadTut06Mesh()
+{
+	const std::string strPath = FindDataFile("tiger.x");
+	if (strPath.empty() || FAILED(SwLoadMeshFromX(strPath.c_str(), &g_Assets.Mesh)))
+	{
+		printf("tiger.x를 찾을 수 없어 Meshes 장면을 건너뜁니다\n");
+		return false;
+	}
+
+	for (const SW_MATERIAL& material : g_Assets.Mesh.Materials)
+	{
+		// 재질에 주변광 색이 없으므로 확산광 색을 쓴다(Tut06과 같다).
+		D3DMATERIAL9 mat = material.MatD3D;
+		mat.Ambient = mat.Diffuse;
+		g_Assets.MeshMaterials.push_back(mat);
+		g_Assets.MeshTextures.push_back(material.strTextureFilename.empty() ? NULL :
+			LoadTexture(material.strTextureFilename.c_str()));
+	}
+	return true;
+}
+
+static VOID LoadAssets()
+{
+	g_Assets.pBanana = LoadTexture("banana.bmp");
+	g_Assets.pEnv = LoadTexture("env2.bmp");
+	g_Assets.pLightmap = BakeTut08Lightmap();
+	g_Assets.bMesh = LoadTut06Mesh();
+}
+
+static VOID ReleaseAssets()
+{
+	g_Assets.pBanana->Release();
+	g_Assets.pEnv->Release();
+	g_Assets.pLightmap->Release();
+	for (CSwTexture* pTexture : g_Assets.MeshTextures)
+	{
+		if (pTexture)
+			pTexture->Release();
+	}
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 장면들
+ * 정점, 렌더 상태, 애니메이션은 각 예제의 InitD3D(), InitGeometry(), SetupMatrices(), Render()를 따른다.
+ * 예제의 창은 정사각형이므로 투영 행렬의 종횡비만 후면 버퍼에 맞춘다.
+ *------------------------------------------------------------------------------
+ */
+struct XYZRHWDIFFUSE { float x, y, z, rhw; DWORD color; };
+struct XYZDIFFUSE { float x, y, z; DWORD color; };
+struct XYZNORMAL { D3DVECTOR position, normal; };
+struct XYZDIFFUSETEX1 { float x, y, z; DWORD color; float tu, tv; };
+
+#define FVF_XYZRHWDIFFUSE	(D3DFVF_XYZRHW | D3DFVF_DIFFUSE)
+#define FVF_XYZDIFFUSE		(D3DFVF_XYZ | D3DFVF_DIFFUSE)
+#define FVF_XYZNORMAL		(D3DFVF_XYZ | D3DFVF_NORMAL)
+#define FVF_XYZDIFFUSETEX1	(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+
+/// 정점 배열을 담은 정점 버퍼를 만든다.
+static bool CreateVB(CSwDevice* pDevice, const void* pVertices, UINT nSize, DWORD dwFVF, SCENEDATA* pData)
+{
+	if (FAILED(pDevice->CreateVertexBuffer(nSize, 0, dwFVF, D3DPOOL_DEFAULT, &pData->pVB, NULL)))
+		return false;
+	void* pDest;
+	pData->pVB->Lock(0, nSize, &pDest, 0);
+	memcpy(pDest, pVertices, nSize);
+	pData->pVB->Unlock();
+	return true;
+}
+
+/// 예제 공통의 뷰, 프로젝션 행렬(눈 (0, fEyeY, fEyeZ)에서 원점을 본다)
+static VOID SetupViewProj(CSwDevice* pDevice, const SCENEDATA* pData, float fEyeY, float fEyeZ)
+{
+	D3DVECTOR vEyePt = SwVec3(0.0f, fEyeY, fEyeZ);
+	D3DVECTOR vLookatPt = SwVec3(0.0f, 0.0f, 0.0f);
+	D3DVECTOR vUpVec = SwVec3(0.0f, 1.0f, 0.0f);
+	D3DMATRIX matView, matProj;
+	SwMatrixLookAtLH(&matView, &vEyePt, &vLookatPt, &vUpVec);
+	SwMatrixPerspectiveFovLH(&matProj, SW_PI / 4, pData->fAspect, 1.0f, 100.0f);
+	pDevice->SetTransform(D3DTS_VIEW, &matView);
+	pDevice->SetTransform(D3DTS_PROJECTION, &matProj);
+}
+
+/// Tut04, Tut05의 원통(삼각형 띠, 정점 2 * 50개)에서 i번째 각도
+static float CylinderAngle(UINT i)
+{
+	return (2 * SW_PI * i) / (50 - 1);
+}
+
+/// Tut01: 화면 지우기만
+static bool CreateClear(CSwDevice*, SCENEDATA*)
+{
+	return true;
+}
+
+static VOID RenderClear(CSwDevice*, const SCENEDATA*, const CSwClock&)
+{
+}
+
+/// Tut02: 변환된 정점(XYZRHW)으로 그린 삼각형. 좌표는 300x300 창 기준이므로 후면 버퍼 크기에 맞춘다.
+static bool CreateVertices(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	const float sx = pDevice->GetWidth() / 300.0f, sy = pDevice->GetHeight() / 300.0f;
+	const XYZRHWDIFFUSE vertices[] =
+	{
+		{ 150.0f * sx,  50.0f * sy, 0.5f, 1.0f, 0xffff0000 },
+		{ 250.0f * sx, 250.0f * sy, 0.5f, 1.0f, 0xff00ff00 },
+		{  50.0f * sx, 250.0f * sy, 0.5f, 1.0f, 0xff00ffff },
+	};
+	if (!CreateVB(pDevice, vertices, sizeof(vertices), FVF_XYZRHWDIFFUSE, pData))
+		return false;
+	pDevice->SetStreamSource(0, pData->pVB, 0, sizeof(XYZRHWDIFFUSE));
+	pDevice->SetFVF(FVF_XYZRHWDIFFUSE);
+	return true;
+}
+
+static VOID RenderVertices(CSwDevice* pDevice, const SCENEDATA*, const CSwClock&)
+{
+	pDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+}
+
+/// Tut03: Y축으로 1초에 한 바퀴 도는 삼각형
+static bool CreateMatrices(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	const XYZDIFFUSE vertices[] =
+	{
+		{ -1.0f, -1.0f, 0.0f, 0xffff0000 },
+		{  1.0f, -1.0f, 0.0f, 0xff0000ff },
+		{  0.0f,  1.0f, 0.0f, 0xffffffff },
+	};
+	if (!CreateVB(pDevice, vertices, sizeof(vertices), FVF_XYZDIFFUSE, pData))
+		return false;
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetStreamSource(0, pData->pVB, 0, sizeof(XYZDIFFUSE));
+	pDevice->SetFVF(FVF_XYZDIFFUSE);
+	return true;
+}
+
+static VOID RenderMatrices(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock& clock)
+{
+	const UINT iTime = clock.GetTimeMs() % 1000;
+	D3DMATRIX matWorld;
+	SwMatrixRotationY(&matWorld, iTime * (2.0f * SW_PI) / 1000.0f);
+	pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+	SetupViewProj(pDevice, pData, 3.0f, -5.0f);
+	pDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+}
+
+/// Tut04의 원통 정점(삼각형 띠)
+static VOID MakeTut04Cylinder(XYZNORMAL* pVertices)
+{
+	for (UINT i = 0; i < 50; ++i)
+	{
+		const float theta = CylinderAngle(i);
+		pVertices[2 * i + 0].position = SwVec3(sinf(theta), -1.0f, cosf(theta));
+		pVertices[2 * i + 0].normal = SwVec3(sinf(theta), 0.0f, cosf(theta));
+		pVertices[2 * i + 1].position = SwVec3(sinf(theta), 1.0f, cosf(theta));
+		pVertices[2 * i + 1].normal = SwVec3(sinf(theta), 0.0f, cosf(theta));
+	}
+}
+
+/// 위치, 법선, 텍스처 좌표를 모두 16비트로 양자화하고 오차와 정점 크기를 보인다.
+static VOID QuantizeSceneVertices(const char* pName, DWORD dwFVF, const BYTE* pVertices, UINT nNumVertices,
+	SCENEQUANT* pOut)
+{
+	ZeroMemory(&pOut->Quant, sizeof(pOut->Quant));
+	pOut->Quant.dwPosition = SW_VQ_UNORM16;
+	pOut->Quant.dwNormal = SW_VQ_OCT16;
+	pOut->Quant.dwTexCoord = SW_VQ_UNORM16;
+	SwComputeVertexQuant(dwFVF, pVertices, nNumVertices, &pOut->Quant);
+	pOut->nVertexSize = SwGetFVFVertexSize(dwFVF, &pOut->Quant);
+	pOut->Vertices.resize((size_t)pOut->nVertexSize * nNumVertices);
+
+	SW_QUANTSTATS stats;
+	SwQuantizeVertices(dwFVF, &pOut->Quant, pVertices, nNumVertices, pOut->Vertices.data(), &stats);
+	printf("%s 정점 %u개 양자화: %u -> %u바이트/정점, 최대 오차 위치 %.6f, 법선 %.4f도, 텍스처 좌표 %.6f\n", pName,
+		nNumVertices, stats.nSrcVertexSize, stats.nDstVertexSize, stats.fPositionError, stats.fNormalError,
+		stats.fTexCoordError);
+}
+
+/// LightsQuant, MeshesQuant 장면이 쓸 정점을 만든다. LoadAssets() 뒤에 부른다.
+static VOID QuantizeAssets()
+{
+	XYZNORMAL cylinder[50 * 2];
+	MakeTut04Cylinder(cylinder);
+	QuantizeSceneVertices("Tut04 원통", FVF_XYZNORMAL, (const BYTE*)cylinder, 50 * 2, &g_Assets.CylinderQuant);
+	if (g_Assets.bMesh)
+	{
+		const SW_MESHDATA& mesh = g_Assets.Mesh;
+		QuantizeSceneVertices("Tut06 메시", mesh.dwFVF, mesh.Vertices.data(), mesh.nNumVertices, &g_Assets.MeshQuant);
+	}
+}
+
+/// Tut04: 방향이 도는 방향성 광원으로 비춘 노란 원통. pQuant가 있으면 양자화한 정점으로 그린다.
+static bool CreateLightsWith(CSwDevice* pDevice, SCENEDATA* pData, const SCENEQUANT* pQuant)
+{
+	XYZNORMAL vertices[50 * 2];
+	MakeTut04Cylinder(vertices);
+	if (pQuant ? !CreateVB(pDevice, pQuant->Vertices.data(), (UINT)pQuant->Vertices.size(), FVF_XYZNORMAL, pData) :
+		!CreateVB(pDevice, vertices, sizeof(vertices), FVF_XYZNORMAL, pData))
+		return false;
+
+	D3DMATERIAL9 mtrl;
+	ZeroMemory(&mtrl, sizeof(mtrl));
+	mtrl.Diffuse.r = mtrl.Ambient.r = 1.0f;
+	mtrl.Diffuse.g = mtrl.Ambient.g = 1.0f;
+	mtrl.Diffuse.b = mtrl.Ambient.b = 0.0f;
+	mtrl.Diffuse.a = mtrl.Ambient.a = 1.0f;
+	pDevice->SetMaterial(&mtrl);
+
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetRenderState(D3DRS_ZENABLE, TRUE);
+	pDevice->SetRenderState(D3DRS_LIGHTING, TRUE);
+	pDevice->SetRenderState(D3DRS_AMBIENT, 0x00202020);
+	pDevice->SetStreamSource(0, pData->pVB, 0, pQuant ? pQuant->nVertexSize : sizeof(XYZNORMAL));
+	pDevice->SetFVF(FVF_XYZNORMAL);
+	pDevice->SetVertexQuant(pQuant ? &pQuant->Quant : NULL);
+	return true;
+}
+
+static bool CreateLights(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	return CreateLightsWith(pDevice, pData, NULL);
+}
+
+static bool CreateLightsQuant(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	return CreateLightsWith(pDevice, pData, &g_Assets.CylinderQuant);
+}
+
+static VOID RenderLights(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock& clock)
+{
+	const DWORD dwTime = clock.GetTimeMs();
+	D3DMATRIX matWorld;
+	SwMatrixRotationX(&matWorld, dwTime / 500.0f);
+	pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+	SetupViewProj(pDevice, pData, 3.0f, -5.0f);
+
+	D3DLIGHT9 light;
+	ZeroMemory(&light, sizeof(light));
+	light.Type = D3DLIGHT_DIRECTIONAL;
+	light.Diffuse.r = light.Diffuse.g = light.Diffuse.b = 1.0f;
+	const D3DVECTOR vecDir = SwVec3(cosf(dwTime / 350.0f), 1.0f, sinf(dwTime / 350.0f));
+	SwVec3Normalize(&light.Direction, &vecDir);
+	light.Range = 1000.0f;
+	pDevice->SetLight(0, &light);
+	pDevice->LightEnable(0, TRUE);
+
+	pDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2 * 50 - 2);
+}
+
+/// Tut05: 정점 색과 MODULATE한 banana.bmp를 입힌 원통
+static bool CreateTextures(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	XYZDIFFUSETEX1 vertices[50 * 2];
+	for (UINT i = 0; i < 50; ++i)
+	{
+		const float theta = CylinderAngle(i);
+		const XYZDIFFUSETEX1 bottom = { sinf(theta), -1.0f, cosf(theta), 0xffffffff, (float)i / (50 - 1), 1.0f };
+		const XYZDIFFUSETEX1 top = { sinf(theta), 1.0f, cosf(theta), 0xff808080, (float)i / (50 - 1), 0.0f };
+		vertices[2 * i + 0] = bottom;
+		vertices[2 * i + 1] = top;
+	}
+	if (!CreateVB(pDevice, vertices, sizeof(vertices), FVF_XYZDIFFUSETEX1, pData))
+		return false;
+
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_ZENABLE, TRUE);
+	pDevice->SetStreamSource(0, pData->pVB, 0, sizeof(XYZDIFFUSETEX1));
+	pDevice->SetFVF(FVF_XYZDIFFUSETEX1);
+	return true;
+}
+
+static VOID RenderTextures(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock& clock)
+{
+	D3DMATRIX matWorld;
+	SwMatrixRotationX(&matWorld, clock.GetTimeMs() / 1000.0f);
+	pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+	SetupViewProj(pDevice, pData, 3.0f, -5.0f);
+
+	pDevice->SetTexture(0, g_Assets.pBanana);
+	pDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	pDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);
+	pDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);
+	pDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+	pDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2 * 50 - 2);
+}
+
+/// Tut06: 부분 집합마다 재질과 텍스처를 바꾸어 그리는 tiger.x. pQuant가 있으면 양자화한 정점으로 그린다.
+static bool CreateMeshesWith(CSwDevice* pDevice, SCENEDATA* pData, const SCENEQUANT* pQuant)
+{
+	const SW_MESHDATA& mesh = g_Assets.Mesh;
+	const std::vector<BYTE>& vertices = pQuant ? pQuant->Vertices : mesh.Vertices;
+	if (!g_Assets.bMesh || !CreateVB(pDevice, vertices.data(), (UINT)vertices.size(), mesh.dwFVF, pData))
+		return false;
+
+	const UINT nIndexSize = (UINT)(mesh.Indices.size() * sizeof(DWORD));
+	if (FAILED(pDevice->CreateIndexBuffer(nIndexSize, 0, D3DFMT_INDEX32, D3DPOOL_DEFAULT, &pData->pIB, NULL)))
+		return false;
+	void* pDest;
+	pData->pIB->Lock(0, nIndexSize, &pDest, 0);
+	memcpy(pDest, mesh.Indices.data(), nIndexSize);
+	pData->pIB->Unlock();
+
+	pDevice->SetRenderState(D3DRS_ZENABLE, TRUE);
+	pDevice->SetRenderState(D3DRS_AMBIENT, 0xffffffff);
+	pDevice->SetStreamSource(0, pData->pVB, 0, pQuant ? pQuant->nVertexSize : mesh.nVertexSize);
+	pDevice->SetFVF(mesh.dwFVF);
+	pDevice->SetVertexQuant(pQuant ? &pQuant->Quant : NULL);
+	pDevice->SetIndices(pData->pIB);
+	return true;
+}
+
+static bool CreateMeshes(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	return CreateMeshesWith(pDevice, pData, NULL);
+}
+
+static bool CreateMeshesQuant(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	return CreateMeshesWith(pDevice, pData, &g_Assets.MeshQuant);
+}
+
+static VOID RenderMeshes(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock& clock)
+{
+	D3DMATRIX matWorld;
+	SwMatrixRotationY(&matWorld, clock.GetTimeMs() / 1000.0f);
+	pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+	SetupViewProj(pDevice, pData, 3.0f, -5.0f);
+
+	for (const SW_MESHSUBSET& subset : g_Assets.Mesh.Subsets)
+	{
+		pDevice->SetMaterial(&g_Assets.MeshMaterials[subset.AttribId]);
+		pDevice->SetTexture(0, g_Assets.MeshTextures[subset.AttribId]);
+		pDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, subset.VertexStart, subset.VertexCount,
+			subset.FaceStart * 3, subset.FaceCount);
+	}
+}
+
+/// Tut07: 인덱스 버퍼로 그린 정육면체
+static bool CreateIndexBuffer(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	const XYZDIFFUSE vertices[] =
+	{
+		{ -1.0f,  1.0f,  1.0f, 0xffff0000 }, {  1.0f,  1.0f,  1.0f, 0xff00ff00 },
+		{  1.0f,  1.0f, -1.0f, 0xff0000ff }, { -1.0f,  1.0f, -1.0f, 0xffffff00 },
+		{ -1.0f, -1.0f,  1.0f, 0xff00ffff }, {  1.0f, -1.0f,  1.0f, 0xffff00ff },
+		{  1.0f, -1.0f, -1.0f, 0xff000000 }, { -1.0f, -1.0f, -1.0f, 0xffffffff },
+	};
+	static const WORD indices[] =
+	{
+		0, 1, 2, 0, 2, 3,	/// 윗면
+		4, 6, 5, 4, 7, 6,	/// 아랫면
+		0, 3, 7, 0, 7, 4,	/// 왼면
+		1, 5, 6, 1, 6, 2,	/// 오른면
+		3, 2, 6, 3, 6, 7,	/// 앞면
+		0, 4, 5, 0, 5, 1,	/// 뒷면
+	};
+	if (!CreateVB(pDevice, vertices, sizeof(vertices), FVF_XYZDIFFUSE, pData) ||
+		FAILED(pDevice->CreateIndexBuffer(sizeof(indices), 0, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &pData->pIB, NULL)))
+		return false;
+	void* pDest;
+	pData->pIB->Lock(0, sizeof(indices), &pDest, 0);
+	memcpy(pDest, indices, sizeof(indices));
+	pData->pIB->Unlock();
+
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_CCW);
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_ZENABLE, TRUE);
+	pDevice->SetStreamSource(0, pData->pVB, 0, sizeof(XYZDIFFUSE));
+	pDevice->SetFVF(FVF_XYZDIFFUSE);
+	pDevice->SetIndices(pData->pIB);
+	return true;
+}
+
+static VOID RenderIndexBuffer(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock& clock)
+{
+	D3DMATRIX matWorld;
+	SwMatrixRotationY(&matWorld, clock.GetTimeMs() / 500.0f);
+	pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+	SetupViewProj(pDevice, pData, 3.0f, -5.0f);
+	pDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 8, 0, 12);
+}
+
+/// Tut08: 텍스처에 구운 라이트맵을 곱한 벽면
+static bool CreateLightMap(CSwDevice* pDevice, SCENEDATA* pData)
+{
+	const XYZDIFFUSETEX1 vertices[] =
+	{
+		{ -1.0f,  1.0f, 0.0f, 0xffffffff, 0.0f, 0.0f },
+		{  1.0f,  1.0f, 0.0f, 0xffffffff, 1.0f, 0.0f },
+		{ -1.0f, -1.0f, 0.0f, 0xffffffff, 0.0f, 1.0f },
+		{  1.0f, -1.0f, 0.0f, 0xffffffff, 1.0f, 1.0f },
+	};
+	if (!CreateVB(pDevice, vertices, sizeof(vertices), FVF_XYZDIFFUSETEX1, pData))
+		return false;
+
+	pDevice->SetRenderState(D3DRS_CULLMODE, D3DCULL_NONE);
+	pDevice->SetRenderState(D3DRS_LIGHTING, FALSE);
+	pDevice->SetRenderState(D3DRS_ZENABLE, TRUE);
+	pDevice->SetStreamSource(0, pData->pVB, 0, sizeof(XYZDIFFUSETEX1));
+	pDevice->SetFVF(FVF_XYZDIFFUSETEX1);
+	return true;
+}
+
+static VOID RenderLightMap(CSwDevice* pDevice, const SCENEDATA* pData, const CSwClock&)
+{
+	D3DMATRIX matWorld;
+	SwMatrixIdentity(&matWorld);
+	pDevice->SetTransform(D3DTS_WORLD, &matWorld);
+	SetupViewProj(pDevice, pData, 0.0f, -3.0f);
+
+	pDevice->SetTexture(0, g_Assets.pEnv);
+	pDevice->SetTexture(1, g_Assets.pLightmap);
+	pDevice->SetTextureStageState(0, D3DTSS_TEXCOORDINDEX, 0);
+	pDevice->SetTextureStageState(1, D3DTSS_TEXCOORDINDEX, 0);
+	pDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(1, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	pDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	pDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+	pDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
+	pDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(1, D3DTSS_COLOROP, D3DTOP_MODULATE);
+	pDevice->SetTextureStageState(1, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	pDevice->SetTextureStageState(1, D3DTSS_COLORARG2, D3DTA_CURRENT);
+	pDevice->SetTextureStageState(1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+	pDevice->SetTextureStageState(2, D3DTSS_COLOROP, D3DTOP_DISABLE);
+	pDevice->SetTextureStageState(2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+	pDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2);
+}
+
+static const BENCHSCENE g_Scenes[] =
+{
+	{ "CreateDevice", D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 255), CreateClear, RenderClear, NULL },
+	{ "Vertices", D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 255), CreateVertices, RenderVertices, NULL },
+	{ "Matrices", D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 0), CreateMatrices, RenderMatrices, NULL },
+	{ "Lights", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateLights, RenderLights, NULL },
+	{ "Textures", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateTextures, RenderTextures,
+		NULL },
+	{ "Meshes", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateMeshes, RenderMeshes, NULL },
+	{ "IndexBuffer", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateIndexBuffer,
+		RenderIndexBuffer, NULL },
+	{ "LightMap", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateLightMap, RenderLightMap,
+		NULL },
+	{ "LightsQuant", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateLightsQuant, RenderLights,
+		"Lights" },
+	{ "MeshesQuant", D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), CreateMeshesQuant, RenderMeshes,
+		"Meshes" },
+};
+
+#define NUM_SCENES	(sizeof(g_Scenes) / sizeof(g_Scenes[0]))
+
+
+
+/**-----------------------------------------------------------------------------
+ * 캡처 파일을 재생하여 마지막 전면 버퍼의 해시를 구한다.
+ * 파일을 읽거나 기록을 실행하지 못하면 그 까닭을 알리고 0을 돌려준다.
+ *------------------------------------------------------------------------------
+ */
+static UINT64 ReplayCapture(const char* pFilename, UINT nThreads)
+{
+	CSwCaptureReader reader;
+	if (FAILED(reader.Open(pFilename)))
+	{
+		printf("캡처 파일을 열 수 없습니다: %s\n", pFilename);
+		return 0;
+	}
+
+	CSwCapturePlayer player(nThreads);
+	SW_CAPRECORD record;
+	const BYTE* pArgs;
+	HRESULT hr;
+	while ((hr = reader.Next(&record, &pArgs)) == S_OK)
+	{
+		if (FAILED(player.Execute(record, pArgs)))
+		{
+			printf("%s의 %s 기록을 실행하지 못했습니다\n", pFilename, SwGetCaptureCallName((SW_CAPCALL)record.wCall));
+			return 0;
+		}
+	}
+	CSwDevice* pDevice = player.GetDevice();
+	if (FAILED(hr) || pDevice == NULL)
+	{
+		printf("캡처 파일이 손상되었습니다: %s\n", pFilename);
+		return 0;
+	}
+	return SwHash64(pDevice->GetFrontBuffer(), (size_t)pDevice->GetWidth() * pDevice->GetHeight() * sizeof(DWORD));
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 장면 하나를 새 디바이스에서 nFrames만큼 그려 잰다.
+ * 장면을 만들 수 없으면 false를 돌려준다.
+ *------------------------------------------------------------------------------
+ */
+static bool RunScene(const BENCHSCENE& scene, UINT nWidth, UINT nHeight, UINT nThreads, UINT nFrames,
+	SCENERESULT* pResult)
+{
+	SW_PRESENT_PARAMETERS pp;
+	ZeroMemory(&pp, sizeof(pp));
+	pp.BackBufferWidth = nWidth;
+	pp.BackBufferHeight = nHeight;
+	pp.EnableAutoDepthStencil = TRUE;
+	pp.AutoDepthStencilFormat = D3DFMT_D16;
+	pp.NumThreads = nThreads;
+	CSwDevice* pDevice = NULL;
+	if (FAILED(SwCreateDevice(&pp, &pDevice)))
+	{
+		printf("%ux%u 디바이스를 만들 수 없습니다\n", nWidth, nHeight);
+		return false;
+	}
+
+	// 기록은 예제의 InitGeometry()에 해당하는 장면 만들기부터 시작한다.
+	CSwCaptureWriter capture;
+	pResult->strCapture.clear();
+	if (g_pCapturePrefix)
+	{
+		char szSuffix[64];
+		snprintf(szSuffix, sizeof(szSuffix), "_%ux%u_t%u.swcap", nWidth, nHeight, nThreads);
+		const std::string strCapture = std::string(g_pCapturePrefix) + "_" + scene.szName + szSuffix;
+		if (FAILED(capture.Open(strCapture.c_str())))
+		{
+			printf("캡처 파일을 만들 수 없습니다: %s\n", strCapture.c_str());
+		}
+		else
+		{
+			pResult->strCapture = strCapture;
+			pDevice->SetCapture(&capture);
+		}
+	}
+
+	SCENEDATA data = { NULL, NULL, (float)nWidth / nHeight };
+	const bool bCreated = scene.pfnCreate(pDevice, &data);
+	if (bCreated)
+	{
+		CSwClock clock;
+		clock.SetFixedStep(SW_CLOCK_DEFAULTSTEP);
+		// 구간은 예제들의 Render()와 같은 곳에 둔다.
+		auto RenderFrame = [&]()
+		{
+			SW_TRACE_SCOPE("Frame");
+			SW_TRACE_CALL("Clear", pDevice->Clear(0, NULL, scene.dwClearFlags, scene.ClearColor, 1.0f, 0));
+			if (SUCCEEDED(pDevice->BeginScene()))
+			{
+				SW_TRACE_SCOPE("Scene");
+				scene.pfnRender(pDevice, &data, clock);
+				SW_TRACE_CALL("EndScene", pDevice->EndScene());
+			}
+			SW_TRACE_CALL("Present", pDevice->Present(NULL, NULL, NULL, NULL));
+		};
+		auto MeasureFrame = [&](bool bTrace)
+		{
+			SwTraceEnable(bTrace);
+			const double fStart = GetTimeMs();
+			RenderFrame();
+			const double fTime = GetTimeMs() - fStart;
+			SwTraceEnable(FALSE);
+			return fTime;
+		};
+
+		// 데우는 프레임을 그린 뒤 시계를 처음으로 돌려, 잰 프레임들이 스레드 수와 관계없이 같은 시각으로 그려지게 한다.
+		for (UINT i = 0; i < SCENE_WARMUP; ++i)
+		{
+			clock.Tick();
+			RenderFrame();
+		}
+		clock.Reset();
+		SwTraceReset();
+
+		std::vector<double> times(nFrames), traceDiffs;
+		pResult->nTriangles = 0;
+		pResult->nPixels = 0;
+		pResult->fTraceMs = 0.0;
+		for (UINT i = 0; i < nFrames; ++i)
+		{
+			clock.Tick();
+			if (g_bTrace)
+			{
+				// 같은 프레임을 두 번 그린다. 두 번째가 캐시 덕을 보므로 순서를 프레임마다 바꾼다.
+				double fTraceTime;
+				if (i & 1)
+				{
+					fTraceTime = MeasureFrame(true);
+					times[i] = MeasureFrame(false);
+				}
+				else
+				{
+					times[i] = MeasureFrame(false);
+					fTraceTime = MeasureFrame(true);
+				}
+				pResult->fTraceMs += fTraceTime;
+				traceDiffs.push_back(fTraceTime - times[i]);
+			}
+			else
+			{
+				times[i] = MeasureFrame(false);
+			}
+
+			const SW_FRAMESTATS& stats = pDevice->GetFrameStats();
+			pResult->nTriangles += stats.nTriangles;
+			pResult->nPixels += stats.nPixelsShaded;
+		}
+
+		pResult->strScene = scene.szName;
+		pResult->strReference = scene.szReference ? scene.szReference : "";
+		pResult->nWidth = nWidth;
+		pResult->nHeight = nHeight;
+		pResult->nThreads = nThreads;
+		pResult->nDeviceThreads = pDevice->GetNumThreads();
+		pResult->nFrames = nFrames;
+		pResult->fTotalMs = 0.0;
+		for (double fTime : times)
+			pResult->fTotalMs += fTime;
+		std::sort(times.begin(), times.end());
+		pResult->fMeanMs = pResult->fTotalMs / nFrames;
+		pResult->fP50Ms = Percentile(times, 50.0);
+		pResult->fP95Ms = Percentile(times, 95.0);
+		pResult->fP99Ms = Percentile(times, 99.0);
+		pResult->fMaxMs = times.back();
+		pResult->fTraceOverhead = 0.0;
+		if (!traceDiffs.empty())
+		{
+			std::sort(traceDiffs.begin(), traceDiffs.end());
+			pResult->fTraceOverhead = Percentile(traceDiffs, 50.0) * 100.0 / pResult->fP50Ms;
+		}
+		pResult->nHash = SwHash64(pDevice->GetFrontBuffer(), (size_t)nWidth * nHeight * sizeof(DWORD));
+		pResult->Frame.assign(pDevice->GetFrontBuffer(), pDevice->GetFrontBuffer() + (size_t)nWidth * nHeight);
+	}
+
+	if (!pResult->strCapture.empty())
+	{
+		pDevice->SetCapture(NULL);
+		const bool bClosed = SUCCEEDED(capture.Close());
+		pResult->nCaptureRecords = capture.GetNumRecords();
+		pResult->nCaptureBytes = capture.GetCompressedSize();
+		pResult->nReplayHash = 0;
+		if (!bClosed)
+			printf("캡처 파일을 쓰지 못했습니다: %s\n", pResult->strCapture.c_str());
+		else if (bCreated)
+			pResult->nReplayHash = ReplayCapture(pResult->strCapture.c_str(), nThreads);
+	}
+
+	if (data.pIB)
+		data.pIB->Release();
+	if (data.pVB)
+		data.pVB->Release();
+	pDevice->Release();
+	return bCreated;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 결과 출력
+ *------------------------------------------------------------------------------
+ */
+static double PerSecond(UINT64 nCount, double fMs)
+{
+	return (fMs > 0.0) ? nCount * 1000.0 / fMs : 0.0;
+}
+
+static VOID PrintResult(const SCENERESULT& r)
+{
+	printf("%-12s %5ux%-5u %3u %9.1f %8.3f %8.3f %8.3f %8.3f %10.2f %10.2f  %016llx", r.strScene.c_str(),
+		r.nWidth, r.nHeight, r.nDeviceThreads, PerSecond(r.nFrames, r.fTotalMs), r.fP50Ms, r.fP95Ms, r.fP99Ms,
+		r.fMaxMs, PerSecond(r.nTriangles, r.fTotalMs) / 1e6, PerSecond(r.nPixels, r.fTotalMs) / 1e6,
+		(unsigned long long)r.nHash);
+	if (g_bTrace)
+		printf(" %+7.2f%%", r.fTraceOverhead);
+	printf("\n");
+}
+
+/// 두 화면의 RGB 채널 PSNR(dB)과 가장 큰 채널 차이. 같으면 PSNR은 무한대다.
+static double ComparePsnr(const std::vector<DWORD>& a, const std::vector<DWORD>& b, UINT* pMaxDiff)
+{
+	double fSquared = 0.0;
+	*pMaxDiff = 0;
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		for (UINT nShift = 0; nShift < 24; nShift += 8)
+		{
+			const int nDiff = (int)((a[i] >> nShift) & 0xff) - (int)((b[i] >> nShift) & 0xff);
+			fSquared += nDiff * nDiff;
+			*pMaxDiff = std::max(*pMaxDiff, (UINT)std::abs(nDiff));
+		}
+	}
+	const double fMse = fSquared / (a.size() * 3.0);
+	return (fMse > 0.0) ? 10.0 * std::log10(255.0 * 255.0 / fMse) : HUGE_VAL;
+}
+
+static HRESULT WriteJson(const char* pFilename, UINT nFrames, const std::vector<SCENERESULT>& results)
+{
+	FILE* pFile = fopen(pFilename, "w");
+	if (pFile == NULL)
+		return E_FAIL;
+
+	// 장면 이름은 영문 상수이므로 따로 이스케이프하지 않는다.
+	fprintf(pFile, "{\n\"frames\":%u,\"warmup\":%u,\"step_ms\":%.6f,\n\"results\":[\n", nFrames, SCENE_WARMUP,
+		SW_CLOCK_DEFAULTSTEP);
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		const SCENERESULT& r = results[i];
+		fprintf(pFile, "{\"scene\":\"%s\",\"width\":%u,\"height\":%u,\"threads\":%u,\"device_threads\":%u,"
+			"\"frames\":%u,\"total_ms\":%.3f,\"fps\":%.3f,"
+			"\"frame_ms\":{\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f},"
+			"\"triangles\":%llu,\"triangles_per_sec\":%.1f,\"pixels\":%llu,\"pixels_per_sec\":%.1f,"
+			"\"hash\":\"%016llx\"",
+			r.strScene.c_str(), r.nWidth, r.nHeight, r.nThreads, r.nDeviceThreads, r.nFrames, r.fTotalMs,
+			PerSecond(r.nFrames, r.fTotalMs), r.fMeanMs, r.fP50Ms, r.fP95Ms, r.fP99Ms, r.fMaxMs,
+			(unsigned long long)r.nTriangles, PerSecond(r.nTriangles, r.fTotalMs), (unsigned long long)r.nPixels,
+			PerSecond(r.nPixels, r.fTotalMs), (unsigned long long)r.nHash);
+		if (g_bTrace)
+			fprintf(pFile, ",\"trace_ms\":%.3f,\"trace_overhead_pct\":%.3f", r.fTraceMs, r.fTraceOverhead);
+		fprintf(pFile, "}%s\n", (i + 1 < results.size()) ? "," : "");
+	}
+	fprintf(pFile, "]}\n");
+
+	const bool bFailed = ferror(pFile) != 0;
+	if (fclose(pFile) != 0 || bFailed)
+		return E_FAIL;
+	return S_OK;
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 명령줄
+ *------------------------------------------------------------------------------
+ */
+/// pArg가 "pOption:값"이면 값을 돌려준다(SwConfigureClock()과 같은 형식).
+static const char* GetOptionValue(const char* pArg, const char* pOption)
+{
+	const size_t nLength = strlen(pOption);
+	return (strncmp(pArg, pOption, nLength) == 0 && pArg[nLength] == ':') ? pArg + nLength + 1 : NULL;
+}
+
+/// 쉼표로 나눈 목록
+static std::vector<std::string> SplitList(const char* pValue)
+{
+	std::vector<std::string> items(1);
+	for (; *pValue; ++pValue)
+	{
+		if (*pValue == ',')
+			items.push_back(std::string());
+		else
+			items.back().push_back(*pValue);
+	}
+	return items;
+}
+
+static VOID PrintUsage()
+{
+	printf("사용법: SceneBench [-frames:N] [-res:WxH[,WxH...]] [-threads:N[,N...]] [-scenes:이름[,이름...]]\n"
+		"                  [-out:파일] [-data:폴더] [-trace] [-capture:접두어]\n장면:");
+	for (const BENCHSCENE& scene : g_Scenes)
+		printf(" %s", scene.szName);
+	printf("\n");
+}
+
+
+
+/**-----------------------------------------------------------------------------
+ * 프로그램 시작점
+ *------------------------------------------------------------------------------
+ */
+int main(int argc, char* argv[])
+{
+	UINT nFrames = SCENE_FRAMES;
+	std::vector<std::pair<UINT, UINT>> resolutions;
+	std::vector<UINT> threads;
+	std::vector<const BENCHSCENE*> scenes;
+	const char* pOutFilename = "SceneBench.json";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const char* pValue;
+		if ((pValue = GetOptionValue(argv[i], "-frames")) != NULL)
+		{
+			nFrames = (UINT)atoi(pValue);
+		}
+		else if ((pValue = GetOptionValue(argv[i], "-res")) != NULL)
+		{
+			for (const std::string& strRes : SplitList(pValue))
+			{
+				UINT nWidth = 0, nHeight = 0;
+				if (sscanf(strRes.c_str(), "%ux%u", &nWidth, &nHeight) != 2 || nWidth == 0 || nHeight == 0)
+				{
+					printf("해상도가 잘못되었습니다: %s\n", strRes.c_str());
+					return 1;
+				}
+				resolutions.push_back(std::make_pair(nWidth, nHeight));
+			}
+		}
+		else if ((pValue = GetOptionValue(argv[i], "-threads")) != NULL)
+		{
+			for (const std::string& strThreads : SplitList(pValue))
+				threads.push_back((UINT)atoi(strThreads.c_str()));
+		}
+		else if ((pValue = GetOptionValue(argv[i], "-scenes")) != NULL)
+		{
+			for (const std::string& strName : SplitList(pValue))
+			{
+				const BENCHSCENE* pScene = std::find_if(g_Scenes, g_Scenes + NUM_SCENES,
+					[&](const BENCHSCENE& scene) { return strName == scene.szName; });
+				if (pScene == g_Scenes + NUM_SCENES)
+				{
+					printf("알 수 없는 장면입니다: %s\n", strName.c_str());
+					PrintUsage();
+					return 1;
+				}
+				scenes.push_back(pScene);
+			}
+		}
+		else if ((pValue = GetOptionValue(argv[i], "-out")) != NULL)
+		{
+			pOutFilename = pValue;
+		}
+		else if ((pValue = GetOptionValue(argv[i], "-data")) != NULL)
+		{
+			g_DataDirs.push_back(pValue);
+		}
+		else if (strcmp(argv[i], "-trace") == 0)
+		{
+			g_bTrace = true;
+		}
+		else if ((pValue = GetOptionValue(argv[i], "-capture")) != NULL)
+		{
+			g_pCapturePrefix = pValue;
+		}
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if (nFrames == 0)
+	{
+		PrintUsage();
+		return 1;
+	}
+	if (resolutions.empty())
+		resolutions.push_back(std::make_pair(640u, 480u));
+	if (threads.empty())
+		threads.push_back(0);
+	if (scenes.empty())
+	{
+		for (const BENCHSCENE& scene : g_Scenes)
+			scenes.push_back(&scene);
+	}
+	// 실행 폴더가 SceneBench이거나 Tutorial일 때 모두 예제 파일을 찾을 수 있게 한다.
+	g_DataDirs.push_back("");
+	g_DataDirs.push_back("..");
+
+	LoadAssets();
+	QuantizeAssets();
+
+	printf("\n장면마다 %u프레임(데우기 %u프레임), 시계 간격 %.3f ms\n", nFrames, SCENE_WARMUP, SW_CLOCK_DEFAULTSTEP);
+	printf("%-12s %11s %3s %9s %8s %8s %8s %8s %10s %10s  %s\n", "장면", "해상도", "스레드", "fps", "p50 ms",
+		"p95 ms", "p99 ms", "최대 ms", "Mtri/s", "Mpix/s", g_bTrace ? "해시              추적" : "해시");
+
+	std::vector<SCENERESULT> results;
+	for (const std::pair<UINT, UINT>& res : resolutions)
+	{
+		for (UINT nThreads : threads)
+		{
+			for (const BENCHSCENE* pScene : scenes)
+			{
+				SCENERESULT result;
+				if (!RunScene(*pScene, res.first, res.second, nThreads, nFrames, &result))
+					continue;
+				PrintResult(result);
+				results.push_back(result);
+			}
+		}
+	}
+
+	// 같은 장면, 같은 해상도는 스레드 수와 관계없이 같은 이미지여야 한다.
+	bool bAllMatch = true;
+	for (const SCENERESULT& r : results)
+	{
+		for (const SCENERESULT& other : results)
+		{
+			if (&other < &r && other.strScene == r.strScene && other.nWidth == r.nWidth &&
+				other.nHeight == r.nHeight && other.nHash != r.nHash)
+			{
+				printf("경고: %s %ux%u의 결과 이미지가 스레드 %u개와 %u개에서 다릅니다\n", r.strScene.c_str(),
+					r.nWidth, r.nHeight, other.nDeviceThreads, r.nDeviceThreads);
+				bAllMatch = false;
+			}
+		}
+	}
+
+	// 캡처를 재생한 화면은 그린 화면과 같아야 한다.
+	for (const SCENERESULT& r : results)
+	{
+		if (r.strCapture.empty())
+			continue;
+		const bool bReplayMatch = (r.nReplayHash == r.nHash);
+		printf("%s: 기록 %llu개, %.1f KB, 재생 해시 %016llx %s\n", r.strCapture.c_str(),
+			(unsigned long long)r.nCaptureRecords, r.nCaptureBytes / 1024.0, (unsigned long long)r.nReplayHash,
+			bReplayMatch ? "일치" : "불일치");
+		bAllMatch = bReplayMatch && bAllMatch;
+	}
+
+	// 비교할 장면이 있는 장면(양자화한 정점)은 같은 해상도, 같은 스레드 수의 결과와 화면과 시간을 비교한다.
+	for (const SCENERESULT& r : results)
+	{
+		for (const SCENERESULT& other : results)
+		{
+			if (r.strReference.empty() || other.strScene != r.strReference || other.nWidth != r.nWidth ||
+				other.nHeight != r.nHeight || other.nThreads != r.nThreads)
+			{
+				continue;
+			}
+			UINT nMaxDiff;
+			const double fPsnr = ComparePsnr(r.Frame, other.Frame, &nMaxDiff);
+			printf("%s / %s %ux%u 스레드 %u: PSNR %.2f dB, 최대 채널 차이 %u, p50 %.3f / %.3f ms (%.2fx)\n",
+				r.strScene.c_str(), other.strScene.c_str(), r.nWidth, r.nHeight, r.nDeviceThreads, fPsnr, nMaxDiff,
+				r.fP50Ms, other.fP50Ms, other.fP50Ms / r.fP50Ms);
+			if (fPsnr < SCENE_QUANTPSNR)
+			{
+				printf("경고: %s의 화면이 %s와 너무 다릅니다\n", r.strScene.c_str(), other.strScene.c_str());
+				bAllMatch = false;
+			}
+		}
+	}
+
+	ReleaseAssets();
+
+	if (FAILED(WriteJson(pOutFilename, nFrames, results)))
+	{
+		printf("결과 파일을 쓸 수 없습니다: %s\n", pOutFilename);
+		return 1;
+	}
+	printf("\n결과를 %s에 썼습니다\n", pOutFilename);
+	return bAllMatch ? 0 : 1;
+}
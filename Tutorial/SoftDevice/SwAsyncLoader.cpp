@@ -0,0 +1,138 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwAsyncLoader.cpp
+//
+// 설명:	CSwAsyncLoader 구현.
+//-----------------------------------------------------------------------------
+#include "SwAsyncLoader.h"
+#include "SwThreadPool.h"
+
+CSwAsyncLoader::CSwAsyncLoader(UINT nThreads)
+	: m_bQuit(false)
+	, m_pCompleted(NULL)
+	, m_nPending(0)
+{
+	if (nThreads == 0)
+	{
+		const UINT nHardware = std::thread::hardware_concurrency();
+		nThreads = (nHardware > 1) ? nHardware - 1 : 1;
+	}
+
+	for (UINT i = 0; i < nThreads; ++i)
+		m_Workers.emplace_back(&CSwAsyncLoader::WorkerMain, this);
+}
+
+CSwAsyncLoader::~CSwAsyncLoader()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bQuit = true;
+		for (JOB* pJob : m_Queue)
+			delete pJob;
+		m_Queue.clear();
+	}
+	m_WakeCond.notify_all();
+
+	for (size_t i = 0; i < m_Workers.size(); ++i)
+		m_Workers[i].join();
+
+	JOB* pJob = m_pCompleted.exchange(NULL, std::memory_order_acquire);
+	while (pJob)
+	{
+		JOB* pNext = pJob->pNext;
+		delete pJob;
+		pJob = pNext;
+	}
+}
+
+VOID CSwAsyncLoader::Submit(const WORKFUNC& work, const COMPLETEFUNC& complete)
+{
+	JOB* pJob = new JOB;
+	pJob->Work = work;
+	pJob->Complete = complete;
+	pJob->hr = S_OK;
+	pJob->pNext = NULL;
+
+	m_nPending.fetch_add(1, std::memory_order_relaxed);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Queue.push_back(pJob);
+	}
+	m_WakeCond.notify_one();
+}
+
+VOID CSwAsyncLoader::WorkerMain()
+{
+	// 작업 안에서 부르는 밉 생성, 압축 등은 기본 풀 대신 직렬로 실행한다(SwGetDefaultThreadPool()).
+	CSwWorkerThreadScope worker;
+	for (;;)
+	{
+		JOB* pJob;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCond.wait(lock, [this] { return m_bQuit || !m_Queue.empty(); });
+			if (m_bQuit)
+				return;
+			pJob = m_Queue.front();
+			m_Queue.pop_front();
+		}
+
+		pJob->hr = pJob->Work ? pJob->Work() : S_OK;
+
+		// 완료 스택에 넣는다. 렌더 스레드는 Poll()에서 잠금 없이 스택을 통째로 가져간다.
+		JOB* pHead = m_pCompleted.load(std::memory_order_relaxed);
+		do
+		{
+			pJob->pNext = pHead;
+		} while (!m_pCompleted.compare_exchange_weak(pHead, pJob,
+			std::memory_order_release, std::memory_order_relaxed));
+
+		// Flush()가 잠금 안에서 스택을 확인하고 잠들기 때문에, 잠금을 한 번 거친 다음 깨워야 알림을 놓치지 않는다.
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+		}
+		m_DoneCond.notify_all();
+	}
+}
+
+UINT CSwAsyncLoader::Poll()
+{
+	JOB* pJob = m_pCompleted.exchange(NULL, std::memory_order_acquire);
+	if (pJob == NULL)
+		return 0;
+
+	// 스택은 최근 것이 위이므로 뒤집어 끝난 순서대로 마무리한다.
+	JOB* pOrdered = NULL;
+	while (pJob)
+	{
+		JOB* pNext = pJob->pNext;
+		pJob->pNext = pOrdered;
+		pOrdered = pJob;
+		pJob = pNext;
+	}
+
+	UINT nCompleted = 0;
+	while (pOrdered)
+	{
+		JOB* pNext = pOrdered->pNext;
+		if (pOrdered->Complete)
+			pOrdered->Complete(pOrdered->hr);
+		delete pOrdered;
+		m_nPending.fetch_sub(1, std::memory_order_release);
+		++nCompleted;
+		pOrdered = pNext;
+	}
+	return nCompleted;
+}
+
+VOID CSwAsyncLoader::Flush()
+{
+	for (;;)
+	{
+		Poll();
+		if (GetPendingCount() == 0)
+			return;
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_DoneCond.wait(lock, [this] { return m_pCompleted.load(std::memory_order_acquire) != NULL; });
+	}
+}
@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwAsyncLoader.h
+//
+// 설명:	파일 읽기를 렌더 스레드 밖에서 하는 비동기 로더.
+//		작업 하나는 작업 스레드에서 실행할 부분(파일 파싱, BMP 디코딩, 밉 생성, 압축)과
+//		렌더 스레드에서 실행할 마무리(D3D 리소스 생성과 교체)로 나뉜다.
+//		작업 스레드는 끝난 작업을 잠금 없는 스택에 넣고, 렌더 스레드는 프레임마다 Poll()로
+//		스택을 통째로 가져와 넣은 순서대로 마무리를 실행한다. 렌더 스레드는 잠금을 기다리지 않는다.
+//
+//		CSwThreadPool::ParallelFor()는 호출한 스레드가 끝날 때까지 기다리므로 여기에 쓰지 않고
+//		작업자 스레드를 따로 둔다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CSwAsyncLoader
+{
+public:
+	// 작업 스레드에서 실행한다. 결과는 마무리 함수로 넘어간다.
+	typedef std::function<HRESULT()> WORKFUNC;
+	// Poll()을 호출한 스레드에서 작업 결과를 받아 실행한다. 여기서 새 작업을 넣어도 된다.
+	typedef std::function<void(HRESULT)> COMPLETEFUNC;
+
+	// nThreads가 0이면 (하드웨어 스레드 수 - 1)개를 만들어 렌더 스레드 몫의 코어를 남긴다.
+	explicit CSwAsyncLoader(UINT nThreads = 0);
+	// 아직 시작하지 않은 작업은 버리고, 실행 중인 작업이 끝날 때까지 기다린다.
+	// 마무리 함수는 실행하지 않으므로 결과를 받아야 하면 먼저 Flush()를 부른다.
+	~CSwAsyncLoader();
+
+	CSwAsyncLoader(const CSwAsyncLoader&) = delete;
+	CSwAsyncLoader& operator=(const CSwAsyncLoader&) = delete;
+
+	UINT	GetNumThreads() const { return (UINT)m_Workers.size(); }
+
+	// 작업을 넣는다. 어느 스레드에서 불러도 된다.
+	VOID	Submit(const WORKFUNC& work, const COMPLETEFUNC& complete);
+
+	// 끝난 작업의 마무리 함수를 넣은 순서대로 실행하고 그 수를 돌려준다. 기다리지 않는다.
+	UINT	Poll();
+
+	// 넣은 작업이 모두 끝나고 마무리 함수가 모두 실행될 때까지 Poll()을 반복한다.
+	// 마무리 함수가 넣은 작업도 기다린다.
+	VOID	Flush();
+
+	// 넣었지만 아직 마무리 함수가 실행되지 않은 작업 수
+	UINT	GetPendingCount() const { return m_nPending.load(std::memory_order_acquire); }
+
+private:
+	struct JOB
+	{
+		WORKFUNC		Work;
+		COMPLETEFUNC	Complete;
+		HRESULT			hr;
+		JOB*			pNext;		// 완료 스택 연결
+	};
+
+	VOID	WorkerMain();
+
+	std::vector<std::thread>	m_Workers;
+
+	std::mutex					m_Mutex;
+	std::condition_variable		m_WakeCond;			// 작업자를 깨운다
+	std::condition_variable		m_DoneCond;			// Flush()에게 완료를 알린다
+	std::deque<JOB*>			m_Queue;			// 아직 시작하지 않은 작업
+	bool						m_bQuit;
+
+	std::atomic<JOB*>			m_pCompleted;		// 끝난 작업(잠금 없는 스택, 최근 것이 위)
+	std::atomic<UINT>			m_nPending;
+};
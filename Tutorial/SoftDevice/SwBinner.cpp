@@ -0,0 +1,76 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBinner.cpp
+//
+// 설명:	타일 분류 구현.
+//		타일별 개수를 센 다음 누적 합으로 시작 위치를 구하고 다시 채우는 계수 정렬이다.
+//-----------------------------------------------------------------------------
+#include "SwBinner.h"
+
+#include <algorithm>
+
+VOID SwInitTileGrid(UINT nWidth, UINT nHeight, SW_TILEGRID* pGrid)
+{
+	pGrid->nTilesX = (nWidth + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+	pGrid->nTilesY = (nHeight + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+	pGrid->nWidth = nWidth;
+	pGrid->nHeight = nHeight;
+}
+
+VOID SwGetTileRect(const SW_TILEGRID* pGrid, UINT nTile, INT* pX0, INT* pY0, INT* pX1, INT* pY1)
+{
+	UINT tx = nTile % pGrid->nTilesX;
+	UINT ty = nTile / pGrid->nTilesX;
+	*pX0 = (INT)(tx * SW_TILE_SIZE);
+	*pY0 = (INT)(ty * SW_TILE_SIZE);
+	*pX1 = std::min<INT>(*pX0 + SW_TILE_SIZE, (INT)pGrid->nWidth);
+	*pY1 = std::min<INT>(*pY0 + SW_TILE_SIZE, (INT)pGrid->nHeight);
+}
+
+// 경계 사각형 [Min, Max)가 걸치는 타일 범위 [tx0, tx1] x [ty0, ty1]
+static inline VOID GetTileRange(const SW_TRIANGLE& tri, UINT* tx0, UINT* ty0, UINT* tx1, UINT* ty1)
+{
+	*tx0 = (UINT)tri.nMinX / SW_TILE_SIZE;
+	*ty0 = (UINT)tri.nMinY / SW_TILE_SIZE;
+	*tx1 = (UINT)(tri.nMaxX - 1) / SW_TILE_SIZE;
+	*ty1 = (UINT)(tri.nMaxY - 1) / SW_TILE_SIZE;
+}
+
+VOID SwBinTriangles(const SW_TILEGRID* pGrid, SW_BINCHUNK* pChunk)
+{
+	const UINT nTiles = pGrid->nTilesX * pGrid->nTilesY;
+	std::vector<UINT>& start = pChunk->TileStart;
+	start.assign(nTiles + 1, 0);
+
+	// 1. 타일별 개수(start[t + 1]에 센다)
+	const UINT nTriangles = (UINT)pChunk->Triangles.size();
+	for (UINT i = 0; i < nTriangles; ++i)
+	{
+		UINT tx0, ty0, tx1, ty1;
+		GetTileRange(pChunk->Triangles[i], &tx0, &ty0, &tx1, &ty1);
+		for (UINT ty = ty0; ty <= ty1; ++ty)
+		{
+			for (UINT tx = tx0; tx <= tx1; ++tx)
+				++start[ty * pGrid->nTilesX + tx + 1];
+		}
+	}
+
+	// 2. 누적 합
+	for (UINT t = 0; t < nTiles; ++t)
+		start[t + 1] += start[t];
+
+	// 3. 채우기. 삼각형 번호 순서대로 넣으므로 타일 안의 순서가 보존된다.
+	pChunk->TileTriangles.resize(start[nTiles]);
+	for (UINT t = nTiles; t > 0; --t)
+		start[t] = start[t - 1];
+
+	for (UINT i = 0; i < nTriangles; ++i)
+	{
+		UINT tx0, ty0, tx1, ty1;
+		GetTileRange(pChunk->Triangles[i], &tx0, &ty0, &tx1, &ty1);
+		for (UINT ty = ty0; ty <= ty1; ++ty)
+		{
+			for (UINT tx = tx0; tx <= tx1; ++tx)
+				pChunk->TileTriangles[start[ty * pGrid->nTilesX + tx + 1]++] = i;
+		}
+	}
+}
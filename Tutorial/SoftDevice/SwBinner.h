@@ -0,0 +1,47 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBinner.h
+//
+// 설명:	화면 타일(SW_TILE_SIZE x SW_TILE_SIZE)별 삼각형 분류(binning).
+//		삼각형 설정 작업 하나가 만든 삼각형들을 묶음(SW_BINCHUNK) 하나에 담고,
+//		그 묶음 안에서 타일마다 겹치는 삼각형 번호를 모은다.
+//		묶음마다 따로 분류하므로 설정 스레드들이 공유하는 자료가 없어 잠금이 필요 없고,
+//		래스터화 단계에서 묶음을 순서대로 훑으면 타일 안에서도 API 순서가 보존된다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwRasterizer.h"
+
+#include <vector>
+
+#define SW_TILE_SIZE		64		// 타일 하나의 폭과 높이(픽셀)
+
+//-----------------------------------------------------------------------------
+// 타일 격자
+//-----------------------------------------------------------------------------
+struct SW_TILEGRID
+{
+	UINT	nTilesX;
+	UINT	nTilesY;
+	UINT	nWidth;						// 화면 크기
+	UINT	nHeight;
+};
+
+//-----------------------------------------------------------------------------
+// 삼각형 설정 작업 하나의 출력과 그 분류 결과
+// 타일 t에 속한 삼각형은
+// Triangles[TileTriangles[TileStart[t]]] ~ Triangles[TileTriangles[TileStart[t + 1] - 1]]이다.
+//-----------------------------------------------------------------------------
+struct SW_BINCHUNK
+{
+	std::vector<SW_TRIANGLE>	Triangles;
+	std::vector<UINT>			TileStart;		// 타일 수 + 1개
+	std::vector<UINT>			TileTriangles;
+};
+
+VOID	SwInitTileGrid(UINT nWidth, UINT nHeight, SW_TILEGRID* pGrid);
+
+// 타일 t의 화면 사각형 [x0, x1) x [y0, y1)
+VOID	SwGetTileRect(const SW_TILEGRID* pGrid, UINT nTile, INT* pX0, INT* pY0, INT* pX1, INT* pY1);
+
+// pChunk->Triangles를 타일별로 분류하여 TileStart와 TileTriangles를 채운다.
+VOID	SwBinTriangles(const SW_TILEGRID* pGrid, SW_BINCHUNK* pChunk);
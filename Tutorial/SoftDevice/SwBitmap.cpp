@@ -0,0 +1,453 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBitmap.cpp
+//
+// 설명:	BMP 헤더 해석과 행 단위 디코딩(스칼라, SSSE3, AVX2 구현과 실행 중 선택).
+//		SIMD 구현은 SwEdgeKernel.cpp와 같이 함수 단위로 명령어 집합을 지정한다.
+//-----------------------------------------------------------------------------
+#include "SwBitmap.h"
+#include "SwFile.h"
+#include "SwMipmap.h"
+#include "SwResource.h"
+
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SW_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_SSSE3		__attribute__((target("ssse3")))
+#define SW_TARGET_AVX2		__attribute__((target("avx2")))
+#else
+#define SW_TARGET_SSSE3
+#define SW_TARGET_AVX2
+#endif
+
+#define SW_BITMAP_FILEHEADER_SIZE	14
+#define SW_BITMAP_INFOHEADER_SIZE	40
+#define SW_BITMAP_MAX_SIZE			32768		// 한 변의 최대 크기
+#define SW_BI_RGB					0
+#define SW_BI_BITFIELDS				3
+
+static const DWORD	s_dwOpaque = 0xff000000;
+
+//-----------------------------------------------------------------------------
+// 헤더
+//-----------------------------------------------------------------------------
+static inline WORD ReadU16(const BYTE* p)
+{
+	return (WORD)(p[0] | (p[1] << 8));
+}
+
+static inline DWORD ReadU32(const BYTE* p)
+{
+	return (DWORD)p[0] | ((DWORD)p[1] << 8) | ((DWORD)p[2] << 16) | ((DWORD)p[3] << 24);
+}
+
+struct BMPHEADER
+{
+	SW_BITMAPINFO	info;
+	size_t			nBitsOffset;		// 첫 번째로 저장된 행의 위치
+	size_t			nSrcPitch;			// 파일 안의 행 간격(4바이트 정렬)
+	size_t			nPaletteOffset;
+	UINT			nNumColors;			// 팔레트 항목 수. 팔레트가 없으면 0
+};
+
+static HRESULT ParseHeader(const BYTE* p, size_t nSize, BMPHEADER* pHeader)
+{
+	if (nSize < 2 || p[0] != 'B' || p[1] != 'M')
+		return D3DERR_NOTAVAILABLE;
+	if (nSize < SW_BITMAP_FILEHEADER_SIZE + 4)
+		return E_FAIL;
+
+	// BITMAPCOREHEADER(OS/2)는 지원하지 않는다. V4, V5 헤더는 앞부분이 BITMAPINFOHEADER와 같다.
+	const DWORD dwHeaderSize = ReadU32(p + 14);
+	if (dwHeaderSize < SW_BITMAP_INFOHEADER_SIZE)
+		return D3DERR_NOTAVAILABLE;
+	if (nSize < SW_BITMAP_FILEHEADER_SIZE + (size_t)dwHeaderSize)
+		return E_FAIL;
+
+	const INT nWidth = (INT)ReadU32(p + 18);
+	const INT nHeight = (INT)ReadU32(p + 22);
+	const UINT nBitCount = ReadU16(p + 28);
+	const DWORD dwCompression = ReadU32(p + 30);
+	const DWORD dwColorsUsed = ReadU32(p + 46);
+
+	if (nWidth <= 0 || nWidth > SW_BITMAP_MAX_SIZE || nHeight == 0 ||
+		nHeight < -SW_BITMAP_MAX_SIZE || nHeight > SW_BITMAP_MAX_SIZE)
+	{
+		return E_FAIL;
+	}
+	if (nBitCount != 1 && nBitCount != 4 && nBitCount != 8 && nBitCount != 24 && nBitCount != 32)
+		return D3DERR_NOTAVAILABLE;
+
+	if (dwCompression == SW_BI_BITFIELDS)
+	{
+		// 마스크(R, G, B)는 헤더 크기와 관계없이 파일의 54바이트 위치에 있다. BGRX 배치만 받는다.
+		if (nBitCount != 32 || nSize < 66)
+			return D3DERR_NOTAVAILABLE;
+		if (ReadU32(p + 54) != 0x00ff0000 || ReadU32(p + 58) != 0x0000ff00 || ReadU32(p + 62) != 0x000000ff)
+			return D3DERR_NOTAVAILABLE;
+	}
+	else if (dwCompression != SW_BI_RGB)
+	{
+		return D3DERR_NOTAVAILABLE;
+	}
+
+	pHeader->info.nWidth = (UINT)nWidth;
+	pHeader->info.nHeight = (UINT)((nHeight < 0) ? -nHeight : nHeight);
+	pHeader->info.nBitCount = nBitCount;
+	pHeader->info.bTopDown = (nHeight < 0);
+
+	pHeader->nPaletteOffset = SW_BITMAP_FILEHEADER_SIZE + dwHeaderSize;
+	pHeader->nNumColors = 0;
+	if (nBitCount <= 8)
+	{
+		const UINT nMaxColors = 1u << nBitCount;
+		pHeader->nNumColors = (dwColorsUsed == 0 || dwColorsUsed > nMaxColors) ? nMaxColors : dwColorsUsed;
+		if (nSize < pHeader->nPaletteOffset + (size_t)pHeader->nNumColors * 4)
+			return E_FAIL;
+	}
+
+	// 마지막 행은 4바이트 정렬 여백이 없어도 받는다.
+	const UINT64 nRowBytes = ((UINT64)pHeader->info.nWidth * nBitCount + 7) / 8;
+	pHeader->nSrcPitch = (size_t)(((UINT64)pHeader->info.nWidth * nBitCount + 31) / 32 * 4);
+	pHeader->nBitsOffset = ReadU32(p + 10);
+	if (pHeader->nBitsOffset > nSize ||
+		(UINT64)pHeader->nSrcPitch * (pHeader->info.nHeight - 1) + nRowBytes > nSize - pHeader->nBitsOffset)
+	{
+		return E_FAIL;
+	}
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 스칼라(기준) 구현
+// 한 행의 nWidth 픽셀을 pDst에 쓴다. pSrc에서는 그 행의 픽셀 바이트만 읽는다.
+//-----------------------------------------------------------------------------
+typedef VOID (*ROWFUNC)(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst);
+
+static VOID DecodeRow1(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	for (UINT x = 0; x < nWidth; ++x)
+		pDst[x] = pPalette[(pSrc[x >> 3] >> (7 - (x & 7))) & 1];
+}
+
+static VOID DecodeRow4(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	for (UINT x = 0; x < nWidth; ++x)
+		pDst[x] = pPalette[(pSrc[x >> 1] >> ((x & 1) ? 0 : 4)) & 0xf];
+}
+
+static VOID DecodeRow8Scalar(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	for (UINT x = 0; x < nWidth; ++x)
+		pDst[x] = pPalette[pSrc[x]];
+}
+
+static VOID DecodeRow24Scalar(const BYTE* pSrc, UINT nWidth, const DWORD*, DWORD* pDst)
+{
+	for (UINT x = 0; x < nWidth; ++x, pSrc += 3)
+		pDst[x] = s_dwOpaque | ((DWORD)pSrc[2] << 16) | ((DWORD)pSrc[1] << 8) | pSrc[0];
+}
+
+static VOID DecodeRow32Scalar(const BYTE* pSrc, UINT nWidth, const DWORD*, DWORD* pDst)
+{
+	for (UINT x = 0; x < nWidth; ++x, pSrc += 4)
+		pDst[x] = s_dwOpaque | ReadU32(pSrc);
+}
+
+#ifdef SW_X86
+
+//-----------------------------------------------------------------------------
+// SSSE3 구현
+// 24비트는 16픽셀(48바이트)을 16바이트 세 번으로 읽고, palignr로 픽셀 4개(12바이트)씩 맞춘 다음
+// pshufb로 BGR 사이에 빈 바이트를 끼워 넣고 알파를 채운다. 행 밖은 읽지 않는다.
+//-----------------------------------------------------------------------------
+SW_TARGET_SSSE3
+static VOID DecodeRow24SSSE3(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m128i alpha = _mm_set1_epi32((int)s_dwOpaque);
+
+	UINT x = 0;
+	for (; x + 16 <= nWidth; x += 16, pSrc += 48)
+	{
+		const __m128i a = _mm_loadu_si128((const __m128i*)pSrc);
+		const __m128i b = _mm_loadu_si128((const __m128i*)(pSrc + 16));
+		const __m128i c = _mm_loadu_si128((const __m128i*)(pSrc + 32));
+
+		const __m128i p0 = _mm_shuffle_epi8(a, shuffle);
+		const __m128i p1 = _mm_shuffle_epi8(_mm_alignr_epi8(b, a, 12), shuffle);
+		const __m128i p2 = _mm_shuffle_epi8(_mm_alignr_epi8(c, b, 8), shuffle);
+		const __m128i p3 = _mm_shuffle_epi8(_mm_srli_si128(c, 4), shuffle);
+
+		_mm_storeu_si128((__m128i*)(pDst + x), _mm_or_si128(p0, alpha));
+		_mm_storeu_si128((__m128i*)(pDst + x + 4), _mm_or_si128(p1, alpha));
+		_mm_storeu_si128((__m128i*)(pDst + x + 8), _mm_or_si128(p2, alpha));
+		_mm_storeu_si128((__m128i*)(pDst + x + 12), _mm_or_si128(p3, alpha));
+	}
+	DecodeRow24Scalar(pSrc, nWidth - x, pPalette, pDst + x);
+}
+
+SW_TARGET_SSSE3
+static VOID DecodeRow32SSE2(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	const __m128i alpha = _mm_set1_epi32((int)s_dwOpaque);
+
+	UINT x = 0;
+	for (; x + 4 <= nWidth; x += 4, pSrc += 16)
+		_mm_storeu_si128((__m128i*)(pDst + x), _mm_or_si128(_mm_loadu_si128((const __m128i*)pSrc), alpha));
+	DecodeRow32Scalar(pSrc, nWidth - x, pPalette, pDst + x);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 구현
+// 24비트는 8픽셀마다 16바이트를 두 번(0, 12바이트 위치) 읽어 두 레인에 나누어 담는다.
+// pshufb는 레인 안에서만 섞으므로 두 레인에 SSSE3와 같은 마스크를 쓴다.
+// 8비트 팔레트는 인덱스 8개를 32비트로 넓혀 vpgatherdd로 한 번에 찾는다.
+//-----------------------------------------------------------------------------
+SW_TARGET_AVX2
+static VOID DecodeRow24AVX2(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	const __m256i shuffle = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)s_dwOpaque);
+
+	// 마지막 묶음은 24바이트 뒤로 4바이트를 더 읽으므로 그만큼 행에 남아 있어야 한다.
+	UINT x = 0;
+	for (; (x + 8) * 3 + 4 <= nWidth * 3; x += 8, pSrc += 24)
+	{
+		const __m128i lo = _mm_loadu_si128((const __m128i*)pSrc);
+		const __m128i hi = _mm_loadu_si128((const __m128i*)(pSrc + 12));
+		const __m256i v = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		_mm256_storeu_si256((__m256i*)(pDst + x), _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), alpha));
+	}
+	DecodeRow24Scalar(pSrc, nWidth - x, pPalette, pDst + x);
+}
+
+SW_TARGET_AVX2
+static VOID DecodeRow32AVX2(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	const __m256i alpha = _mm256_set1_epi32((int)s_dwOpaque);
+
+	UINT x = 0;
+	for (; x + 8 <= nWidth; x += 8, pSrc += 32)
+	{
+		const __m256i v = _mm256_loadu_si256((const __m256i*)pSrc);
+		_mm256_storeu_si256((__m256i*)(pDst + x), _mm256_or_si256(v, alpha));
+	}
+	DecodeRow32Scalar(pSrc, nWidth - x, pPalette, pDst + x);
+}
+
+SW_TARGET_AVX2
+static VOID DecodeRow8AVX2(const BYTE* pSrc, UINT nWidth, const DWORD* pPalette, DWORD* pDst)
+{
+	UINT x = 0;
+	for (; x + 8 <= nWidth; x += 8)
+	{
+		const __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pSrc + x)));
+		_mm256_storeu_si256((__m256i*)(pDst + x), _mm256_i32gather_epi32((const int*)pPalette, index, 4));
+	}
+	DecodeRow8Scalar(pSrc + x, nWidth - x, pPalette, pDst + x);
+}
+
+static bool HasSSSE3()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+
+static bool HasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// 운영체제가 YMM 레지스터를 저장해 주는가(OSXSAVE와 XCR0)
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif	// SW_X86
+
+//-----------------------------------------------------------------------------
+// 선택
+//-----------------------------------------------------------------------------
+struct ROWFUNCS
+{
+	ROWFUNC	pfnRow8;
+	ROWFUNC	pfnRow24;
+	ROWFUNC	pfnRow32;
+};
+
+static const ROWFUNCS s_ScalarRowFuncs = { DecodeRow8Scalar, DecodeRow24Scalar, DecodeRow32Scalar };
+#ifdef SW_X86
+static const ROWFUNCS s_SSSE3RowFuncs = { DecodeRow8Scalar, DecodeRow24SSSE3, DecodeRow32SSE2 };
+static const ROWFUNCS s_AVX2RowFuncs = { DecodeRow8AVX2, DecodeRow24AVX2, DecodeRow32AVX2 };
+#endif
+
+static SW_BMPDECODER GetBestBitmapDecoder()
+{
+#ifdef SW_X86
+	if (HasAVX2())
+		return SW_BMPDECODER_AVX2;
+	if (HasSSSE3())
+		return SW_BMPDECODER_SSSE3;
+#endif
+	return SW_BMPDECODER_SCALAR;
+}
+
+static SW_BMPDECODER		s_eDecoder = SW_BMPDECODER_SCALAR;
+static const ROWFUNCS*		s_pRowFuncs = &s_ScalarRowFuncs;
+
+// 정적 초기화 시점에 한 번 선택해 둔다.
+static const SW_BMPDECODER	s_eInitialDecoder = SwSetBitmapDecoder(SW_BMPDECODER_AUTO);
+
+SW_BMPDECODER SwSetBitmapDecoder(SW_BMPDECODER eDecoder)
+{
+	const SW_BMPDECODER eBest = GetBestBitmapDecoder();
+	if (eDecoder == SW_BMPDECODER_AUTO || eDecoder > eBest)
+		eDecoder = eBest;
+
+	switch (eDecoder)
+	{
+#ifdef SW_X86
+	case SW_BMPDECODER_AVX2:	s_pRowFuncs = &s_AVX2RowFuncs;		break;
+	case SW_BMPDECODER_SSSE3:	s_pRowFuncs = &s_SSSE3RowFuncs;	break;
+#endif
+	default:
+		eDecoder = SW_BMPDECODER_SCALAR;
+		s_pRowFuncs = &s_ScalarRowFuncs;
+		break;
+	}
+
+	s_eDecoder = eDecoder;
+	return eDecoder;
+}
+
+SW_BMPDECODER SwGetBitmapDecoder()
+{
+	return s_eDecoder;
+}
+
+const char* SwGetBitmapDecoderName(SW_BMPDECODER eDecoder)
+{
+	switch (eDecoder)
+	{
+	case SW_BMPDECODER_SCALAR:	return "scalar";
+	case SW_BMPDECODER_SSSE3:	return "ssse3";
+	case SW_BMPDECODER_AVX2:	return "avx2";
+	default:					return "auto";
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 디코딩
+//-----------------------------------------------------------------------------
+HRESULT SwGetBitmapInfoInMemory(const void* pData, size_t nSize, SW_BITMAPINFO* pInfo)
+{
+	if (pData == NULL || pInfo == NULL)
+		return D3DERR_INVALIDCALL;
+
+	BMPHEADER header;
+	const HRESULT hr = ParseHeader((const BYTE*)pData, nSize, &header);
+	if (SUCCEEDED(hr))
+		*pInfo = header.info;
+	return hr;
+}
+
+HRESULT SwDecodeBitmapInMemory(const void* pData, size_t nSize, void* pBits, INT nPitch)
+{
+	if (pData == NULL || pBits == NULL)
+		return D3DERR_INVALIDCALL;
+
+	const BYTE* p = (const BYTE*)pData;
+	BMPHEADER header;
+	const HRESULT hr = ParseHeader(p, nSize, &header);
+	if (FAILED(hr))
+		return hr;
+
+	// RGBQUAD(B, G, R, 0)는 그대로 X8R8G8B8과 같은 배치이므로 알파만 채운다.
+	// 범위를 벗어난 인덱스가 있어도 읽을 수 있도록 항상 256개를 채워 둔다.
+	DWORD palette[256];
+	for (UINT i = 0; i < 256; ++i)
+		palette[i] = s_dwOpaque | ((i < header.nNumColors) ? ReadU32(p + header.nPaletteOffset + i * 4) : 0);
+
+	ROWFUNC pfnRow;
+	switch (header.info.nBitCount)
+	{
+	case 1:		pfnRow = DecodeRow1;				break;
+	case 4:		pfnRow = DecodeRow4;				break;
+	case 8:		pfnRow = s_pRowFuncs->pfnRow8;		break;
+	case 24:	pfnRow = s_pRowFuncs->pfnRow24;		break;
+	default:	pfnRow = s_pRowFuncs->pfnRow32;		break;
+	}
+
+	// 원본은 파일 순서대로 읽어 나가고(메모리 맵의 미리 읽기가 잘 듣는다),
+	// bottom-up 파일이면 대상 행을 아래에서부터 골라 따로 뒤집지 않는다.
+	const UINT nWidth = header.info.nWidth;
+	const UINT nHeight = header.info.nHeight;
+	const BYTE* pSrc = p + header.nBitsOffset;
+	for (UINT i = 0; i < nHeight; ++i, pSrc += header.nSrcPitch)
+	{
+		const UINT y = header.info.bTopDown ? i : nHeight - 1 - i;
+		pfnRow(pSrc, nWidth, palette, (DWORD*)((BYTE*)pBits + (ptrdiff_t)y * nPitch));
+	}
+	return S_OK;
+}
+
+HRESULT SwCreateTextureFromBitmap(const char* pFilename, UINT Levels, CSwTexture** ppTexture,
+	CSwThreadPool* pThreadPool)
+{
+	if (pFilename == NULL || ppTexture == NULL)
+		return D3DERR_INVALIDCALL;
+
+	CSwMappedFile file;
+	HRESULT hr = file.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+
+	SW_BITMAPINFO info;
+	if (FAILED(hr = SwGetBitmapInfoInMemory(file.GetData(), file.GetSize(), &info)))
+		return hr;
+
+	CSwTexture* pTexture = new CSwTexture(info.nWidth, info.nHeight, Levels, D3DFMT_X8R8G8B8);
+	D3DLOCKED_RECT rect;
+	if (SUCCEEDED(hr = pTexture->LockRect(0, &rect, NULL, 0)))
+	{
+		hr = SwDecodeBitmapInMemory(file.GetData(), file.GetSize(), rect.pBits, rect.Pitch);
+		pTexture->UnlockRect(0);
+	}
+	if (SUCCEEDED(hr) && pTexture->GetLevelCount() > 1)
+		hr = SwGenerateMipmaps(pTexture, SW_MIPFILTER_BOX, SW_MIPMAP_WRAP, pThreadPool);
+	if (FAILED(hr))
+	{
+		pTexture->Release();
+		return hr;
+	}
+
+	*ppTexture = pTexture;
+	return S_OK;
+}
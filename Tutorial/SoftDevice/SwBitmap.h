@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBitmap.h
+//
+// 설명:	BMP 파일 디코더. D3DXCreateTextureFromFile()의 BMP 경로를 대신한다.
+//		메모리 맵으로 연결한 파일에서 행을 파일 순서대로 읽어 X8R8G8B8 텍스처 메모리에 바로 쓰므로
+//		중간 버퍼가 없다. 아래에서 위로 저장된(bottom-up) 파일은 대상 행을 거꾸로 골라 뒤집는다.
+//
+//		지원하는 형식: BI_RGB 1/4/8비트 팔레트, 24비트, 32비트와 BGRX 마스크의 BI_BITFIELDS 32비트.
+//		24비트 BGR을 ARGB로 바꾸는 일은 SSSE3/AVX2 pshufb로, 8비트 팔레트 확장은 AVX2 gather로 하며
+//		실행 중에 CPU를 확인하여 고른다. 모든 구현의 결과는 스칼라 구현과 같다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <cstddef>
+
+class CSwTexture;
+class CSwThreadPool;
+
+struct SW_BITMAPINFO
+{
+	UINT	nWidth;
+	UINT	nHeight;
+	UINT	nBitCount;		// 1, 4, 8, 24, 32
+	BOOL	bTopDown;		// 파일에 위쪽 행부터 저장되어 있는가
+};
+
+enum SW_BMPDECODER
+{
+	SW_BMPDECODER_AUTO = 0,			// CPU가 지원하는 가장 빠른 구현
+	SW_BMPDECODER_SCALAR,
+	SW_BMPDECODER_SSSE3,
+	SW_BMPDECODER_AVX2,
+};
+
+// 사용할 구현을 고른다. 지원하지 않는 구현을 요청하면 그보다 좁은 구현을 쓴다.
+// 실제로 선택된 구현을 돌려준다. 디코딩 중에는 호출하지 않는다.
+SW_BMPDECODER	SwSetBitmapDecoder(SW_BMPDECODER eDecoder);
+SW_BMPDECODER	SwGetBitmapDecoder();
+const char*		SwGetBitmapDecoderName(SW_BMPDECODER eDecoder);
+
+// 헤더만 읽는다. BMP가 아니거나 지원하지 않는 형식이면 D3DERR_NOTAVAILABLE, 잘린 파일이면 E_FAIL.
+HRESULT	SwGetBitmapInfoInMemory(const void* pData, size_t nSize, SW_BITMAPINFO* pInfo);
+
+// 이미지 전체를 X8R8G8B8(알파 0xff)로 풀어 pBits에 쓴다. pBits는 위쪽 행부터 nPitch바이트 간격이며
+// nWidth x nHeight 텍셀이 들어갈 수 있어야 한다.
+HRESULT	SwDecodeBitmapInMemory(const void* pData, size_t nSize, void* pBits, INT nPitch);
+
+// 파일을 읽어 X8R8G8B8 텍스처를 만든다. 파일이 없으면 D3DERR_NOTFOUND.
+// Levels가 0이면 전체 밉 체인을 만든다. 레벨 1부터는 레벨 0에서 박스 필터로 채운다(SwGenerateMipmaps).
+HRESULT	SwCreateTextureFromBitmap(const char* pFilename, UINT Levels, CSwTexture** ppTexture,
+			CSwThreadPool* pThreadPool = NULL);
@@ -0,0 +1,872 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBlockCompress.cpp
+//
+// 설명:	BC1/BC3 인코더와 디코더(스칼라, SSSE3, AVX2 구현과 실행 중 선택).
+//		팔레트는 모든 구현이 같은 스칼라 코드로 계산하고, SIMD 구현은 색인으로 팔레트를 찾는 부분만 맡는다.
+//		SSSE3은 색인 한 바이트(텍셀 4개)마다 미리 만든 pshufb 제어 바이트를 쓰고,
+//		AVX2는 가변 시프트로 색인을 꺼내 vpermd로 텍셀 8개를 한 번에 찾는다.
+//-----------------------------------------------------------------------------
+#include "SwBlockCompress.h"
+#include "SwResource.h"
+#include "SwThreadPool.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SW_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_SSSE3		__attribute__((target("ssse3")))
+#define SW_TARGET_AVX2		__attribute__((target("avx2")))
+#else
+#define SW_TARGET_SSSE3
+#define SW_TARGET_AVX2
+#endif
+
+#define SW_BC_BAND_ROWS				8				// 작업 하나가 압축하는 블록 행 수
+#define SW_BC_PARALLEL_MIN_TEXELS	(512 * 512)		// 스레드 풀이 없을 때 기본 풀을 쓰는 크기
+#define SW_BC_REFINE_STEPS			2				// 최소 제곱으로 끝점을 다시 구하는 최대 횟수
+
+static const DWORD	s_dwOpaque = 0xff000000;
+
+//-----------------------------------------------------------------------------
+// 보조 함수
+//-----------------------------------------------------------------------------
+static inline WORD ReadU16(const BYTE* p)
+{
+	return (WORD)(p[0] | (p[1] << 8));
+}
+
+static inline DWORD ReadU32(const BYTE* p)
+{
+	DWORD dw;
+	memcpy(&dw, p, sizeof(dw));
+	return dw;
+}
+
+static inline VOID WriteU16(BYTE* p, WORD w)
+{
+	p[0] = (BYTE)w;
+	p[1] = (BYTE)(w >> 8);
+}
+
+static inline VOID WriteU32(BYTE* p, DWORD dw)
+{
+	memcpy(p, &dw, sizeof(dw));
+}
+
+// BC3 알파 색인 48비트
+static inline UINT64 ReadU48(const BYTE* p)
+{
+	return (UINT64)ReadU32(p) | ((UINT64)ReadU16(p + 4) << 32);
+}
+
+// R5G6B5 끝점을 비트 복제로 8비트 채널(X8R8G8B8, 알파 0)로 늘린다.
+static inline DWORD Expand565(WORD c)
+{
+	const DWORD r = (c >> 11) & 31, g = (c >> 5) & 63, b = c & 31;
+	return (((r << 3) | (r >> 2)) << 16) | (((g << 2) | (g >> 4)) << 8) | ((b << 3) | (b >> 2));
+}
+
+// 채널마다 (wa * a + wb * b) / d를 반올림한다.
+static inline DWORD MixColor(DWORD a, DWORD b, UINT wa, UINT wb, UINT d)
+{
+	DWORD dwOut = 0;
+	for (UINT nShift = 0; nShift < 24; nShift += 8)
+		dwOut |= ((((a >> nShift) & 0xff) * wa + ((b >> nShift) & 0xff) * wb + d / 2) / d) << nShift;
+	return dwOut;
+}
+
+//-----------------------------------------------------------------------------
+// 팔레트(모든 구현이 같은 코드를 쓴다)
+//-----------------------------------------------------------------------------
+// 색 블록의 팔레트 4개. BC1은 c0 <= c1이면 3색 모드(세 번째 색은 중간, 네 번째는 투명한 검정)이고
+// BC3의 색 블록은 끝점 순서와 관계없이 4색 모드다. 색에는 dwAlpha를 더한다.
+static inline VOID MakeColorPalette(const BYTE* pBlock, bool bAlways4, DWORD dwAlpha, DWORD* pPalette)
+{
+	const WORD c0 = ReadU16(pBlock);
+	const WORD c1 = ReadU16(pBlock + 2);
+	const DWORD e0 = Expand565(c0);
+	const DWORD e1 = Expand565(c1);
+
+	pPalette[0] = e0 | dwAlpha;
+	pPalette[1] = e1 | dwAlpha;
+	if (c0 > c1 || bAlways4)
+	{
+		pPalette[2] = MixColor(e0, e1, 2, 1, 3) | dwAlpha;
+		pPalette[3] = MixColor(e0, e1, 1, 2, 3) | dwAlpha;
+	}
+	else
+	{
+		pPalette[2] = MixColor(e0, e1, 1, 1, 2) | dwAlpha;
+		pPalette[3] = 0;
+	}
+}
+
+// BC3 알파 팔레트 8개(0~255). a0 > a1이면 8단계 보간, 아니면 6단계 보간과 0, 255다.
+static inline VOID MakeAlphaValues(UINT a0, UINT a1, UINT* pValues)
+{
+	pValues[0] = a0;
+	pValues[1] = a1;
+	if (a0 > a1)
+	{
+		for (UINT i = 1; i <= 6; ++i)
+			pValues[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+	}
+	else
+	{
+		for (UINT i = 1; i <= 4; ++i)
+			pValues[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+		pValues[6] = 0;
+		pValues[7] = 255;
+	}
+}
+
+// 알파 팔레트를 A8R8G8B8의 알파 자리로 옮겨 둔다.
+static inline VOID MakeAlphaPalette(const BYTE* pBlock, DWORD* pPalette)
+{
+	UINT values[8];
+	MakeAlphaValues(pBlock[0], pBlock[1], values);
+	for (UINT i = 0; i < 8; ++i)
+		pPalette[i] = values[i] << 24;
+}
+
+//-----------------------------------------------------------------------------
+// 미리 계산한 표
+//-----------------------------------------------------------------------------
+struct BCTABLES
+{
+	BYTE	Match5[256][2];				// 단색 블록: (2 * e0 + e1) / 3이 값에 가장 가까운 5비트 끝점 쌍
+	BYTE	Match6[256][2];				// 같은 표의 6비트(녹색) 끝점 쌍
+	BYTE	ColorShuffle[256][16];		// 색인 한 바이트(텍셀 4개)로 팔레트 레지스터에서 텍셀을 고르는 pshufb 제어 바이트
+
+	BCTABLES()
+	{
+		BuildMatch(5, Match5);
+		BuildMatch(6, Match6);
+
+		for (UINT n = 0; n < 256; ++n)
+		{
+			for (UINT t = 0; t < 4; ++t)
+			{
+				const UINT k = (n >> (t * 2)) & 3;
+				for (UINT j = 0; j < 4; ++j)
+					ColorShuffle[n][t * 4 + j] = (BYTE)(k * 4 + j);
+			}
+		}
+	}
+
+	static VOID BuildMatch(UINT nBits, BYTE (*pMatch)[2])
+	{
+		const UINT nMax = (1u << nBits) - 1;
+		for (UINT v = 0; v < 256; ++v)
+		{
+			UINT nBestError = 256;
+			for (UINT a = 0; a <= nMax; ++a)
+			{
+				for (UINT b = 0; b <= nMax; ++b)
+				{
+					const UINT ea = (nBits == 5) ? (a << 3) | (a >> 2) : (a << 2) | (a >> 4);
+					const UINT eb = (nBits == 5) ? (b << 3) | (b >> 2) : (b << 2) | (b >> 4);
+					const UINT m = (2 * ea + eb + 1) / 3;
+					const UINT nError = (m > v) ? m - v : v - m;
+					if (nError < nBestError)
+					{
+						nBestError = nError;
+						pMatch[v][0] = (BYTE)a;
+						pMatch[v][1] = (BYTE)b;
+					}
+				}
+			}
+		}
+	}
+};
+
+static const BCTABLES s_Tables;
+
+//-----------------------------------------------------------------------------
+// 스칼라 디코더
+// 구현마다 다른 부분은 색인으로 팔레트를 찾는 함수뿐이다. 팔레트 계산을 SIMD 함수 밖에 두어야
+// AVX2 함수 안에서 SSE 코드를 부를 때 생기는 상태 전환 비용이 없다.
+//-----------------------------------------------------------------------------
+static VOID LookupColorsScalar(const DWORD* pPalette, DWORD dwIndices, DWORD* pTexels)
+{
+	for (UINT i = 0; i < 16; ++i)
+		pTexels[i] = pPalette[(dwIndices >> (i * 2)) & 3];
+}
+
+// pTexels의 색에 알파를 더한다.
+static VOID LookupAlphasScalar(const DWORD* pAlphas, UINT64 nIndices, DWORD* pTexels)
+{
+	for (UINT i = 0; i < 16; ++i)
+		pTexels[i] |= pAlphas[(nIndices >> (i * 3)) & 7];
+}
+
+#ifdef SW_X86
+
+//-----------------------------------------------------------------------------
+// SSSE3 디코더
+// 팔레트 4색이 레지스터 하나(16바이트)에 들어가므로 한 행(텍셀 4개)을 pshufb 한 번으로 찾는다.
+//-----------------------------------------------------------------------------
+SW_TARGET_SSSE3
+static VOID LookupColorsSSSE3(const DWORD* pPalette, DWORD dwIndices, DWORD* pTexels)
+{
+	const __m128i palette = _mm_loadu_si128((const __m128i*)pPalette);
+	for (UINT r = 0; r < 4; ++r)
+	{
+		const __m128i control = _mm_loadu_si128((const __m128i*)s_Tables.ColorShuffle[(dwIndices >> (r * 8)) & 0xff]);
+		_mm_storeu_si128((__m128i*)(pTexels + r * 4), _mm_shuffle_epi8(palette, control));
+	}
+}
+
+// 알파 8개를 바이트로 모으고, 텍셀마다 알파 자리(바이트 3)에만 색인을 넣은 제어 바이트로 찾는다.
+SW_TARGET_SSSE3
+static VOID LookupAlphasSSSE3(const DWORD* pAlphas, UINT64 nIndices, DWORD* pTexels)
+{
+	const __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)pAlphas),
+		_mm_setr_epi8(3, 7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1));
+	const __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(pAlphas + 4)),
+		_mm_setr_epi8(-1, -1, -1, -1, 3, 7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1));
+	const __m128i alphas = _mm_or_si128(lo, hi);
+
+	BYTE control[16];
+	memset(control, 0x80, sizeof(control));
+	for (UINT r = 0; r < 4; ++r)
+	{
+		for (UINT t = 0; t < 4; ++t)
+			control[t * 4 + 3] = (BYTE)((nIndices >> ((r * 4 + t) * 3)) & 7);
+		__m128i* pRow = (__m128i*)(pTexels + r * 4);
+		const __m128i alpha = _mm_shuffle_epi8(alphas, _mm_loadu_si128((const __m128i*)control));
+		_mm_storeu_si128(pRow, _mm_or_si128(_mm_loadu_si128(pRow), alpha));
+	}
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 디코더
+// 색인 비트를 모든 레인에 복사한 다음 레인마다 다른 양만큼 시프트하여 꺼내고 vpermd로 팔레트를 찾는다.
+//-----------------------------------------------------------------------------
+SW_TARGET_AVX2
+static VOID LookupColorsAVX2(const DWORD* pPalette, DWORD dwIndices, DWORD* pTexels)
+{
+	const __m256i palette = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)pPalette));
+	const __m256i indices = _mm256_set1_epi32((int)dwIndices);
+	const __m256i shift = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+	const __m256i mask = _mm256_set1_epi32(3);
+
+	const __m256i lo = _mm256_and_si256(_mm256_srlv_epi32(indices, shift), mask);
+	const __m256i hi = _mm256_and_si256(_mm256_srlv_epi32(indices, _mm256_add_epi32(shift, _mm256_set1_epi32(16))), mask);
+	_mm256_storeu_si256((__m256i*)pTexels, _mm256_permutevar8x32_epi32(palette, lo));
+	_mm256_storeu_si256((__m256i*)(pTexels + 8), _mm256_permutevar8x32_epi32(palette, hi));
+}
+
+// 알파 색인은 텍셀 8개가 24비트씩이다.
+SW_TARGET_AVX2
+static VOID LookupAlphasAVX2(const DWORD* pAlphas, UINT64 nIndices, DWORD* pTexels)
+{
+	const __m256i alphas = _mm256_loadu_si256((const __m256i*)pAlphas);
+	const __m256i shift = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+	const __m256i mask = _mm256_set1_epi32(7);
+
+	const __m256i lo = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(nIndices & 0xffffff)), shift), mask);
+	const __m256i hi = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(nIndices >> 24)), shift), mask);
+	__m256i* pLo = (__m256i*)pTexels;
+	__m256i* pHi = (__m256i*)(pTexels + 8);
+	_mm256_storeu_si256(pLo, _mm256_or_si256(_mm256_loadu_si256(pLo), _mm256_permutevar8x32_epi32(alphas, lo)));
+	_mm256_storeu_si256(pHi, _mm256_or_si256(_mm256_loadu_si256(pHi), _mm256_permutevar8x32_epi32(alphas, hi)));
+}
+
+static bool HasSSSE3()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+
+static bool HasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// 운영체제가 YMM 레지스터를 저장해 주는가(OSXSAVE와 XCR0)
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif	// SW_X86
+
+//-----------------------------------------------------------------------------
+// 디코더 선택
+//-----------------------------------------------------------------------------
+struct BCDECODER
+{
+	VOID	(*pfnLookupColors)(const DWORD* pPalette, DWORD dwIndices, DWORD* pTexels);
+	VOID	(*pfnLookupAlphas)(const DWORD* pAlphas, UINT64 nIndices, DWORD* pTexels);
+};
+
+static const BCDECODER s_ScalarDecoder = { LookupColorsScalar, LookupAlphasScalar };
+#ifdef SW_X86
+static const BCDECODER s_SSSE3Decoder = { LookupColorsSSSE3, LookupAlphasSSSE3 };
+static const BCDECODER s_AVX2Decoder = { LookupColorsAVX2, LookupAlphasAVX2 };
+#endif
+
+static SW_BCDECODER GetBestBlockDecoder()
+{
+#ifdef SW_X86
+	if (HasAVX2())
+		return SW_BCDECODER_AVX2;
+	if (HasSSSE3())
+		return SW_BCDECODER_SSSE3;
+#endif
+	return SW_BCDECODER_SCALAR;
+}
+
+static SW_BCDECODER			s_eBlockDecoder = SW_BCDECODER_SCALAR;
+static const BCDECODER*		s_pBlockDecoder = &s_ScalarDecoder;
+
+// 정적 초기화 시점에 한 번 선택해 둔다.
+static const SW_BCDECODER	s_eInitialDecoder = SwSetBlockDecoder(SW_BCDECODER_AUTO);
+
+SW_BCDECODER SwSetBlockDecoder(SW_BCDECODER eDecoder)
+{
+	const SW_BCDECODER eBest = GetBestBlockDecoder();
+	if (eDecoder == SW_BCDECODER_AUTO || eDecoder > eBest)
+		eDecoder = eBest;
+
+	switch (eDecoder)
+	{
+#ifdef SW_X86
+	case SW_BCDECODER_AVX2:		s_pBlockDecoder = &s_AVX2Decoder;	break;
+	case SW_BCDECODER_SSSE3:	s_pBlockDecoder = &s_SSSE3Decoder;	break;
+#endif
+	default:
+		eDecoder = SW_BCDECODER_SCALAR;
+		s_pBlockDecoder = &s_ScalarDecoder;
+		break;
+	}
+
+	s_eBlockDecoder = eDecoder;
+	return eDecoder;
+}
+
+SW_BCDECODER SwGetBlockDecoder()
+{
+	return s_eBlockDecoder;
+}
+
+const char* SwGetBlockDecoderName(SW_BCDECODER eDecoder)
+{
+	switch (eDecoder)
+	{
+	case SW_BCDECODER_SCALAR:	return "scalar";
+	case SW_BCDECODER_SSSE3:	return "ssse3";
+	case SW_BCDECODER_AVX2:		return "avx2";
+	default:					return "auto";
+	}
+}
+
+UINT SwGetBlockSize(D3DFORMAT Format)
+{
+	switch (Format)
+	{
+	case D3DFMT_DXT1:	return 8;
+	case D3DFMT_DXT5:	return 16;
+	default:			return 0;
+	}
+}
+
+static inline VOID DecodeBlock(const BCDECODER* pDecoder, D3DFORMAT Format, const BYTE* pBlock, DWORD* pTexels)
+{
+	DWORD palette[4];
+	if (Format == D3DFMT_DXT5)
+	{
+		DWORD alphas[8];
+		MakeAlphaPalette(pBlock, alphas);
+		MakeColorPalette(pBlock + 8, true, 0, palette);
+		pDecoder->pfnLookupColors(palette, ReadU32(pBlock + 12), pTexels);
+		pDecoder->pfnLookupAlphas(alphas, ReadU48(pBlock + 2), pTexels);
+	}
+	else
+	{
+		MakeColorPalette(pBlock, false, s_dwOpaque, palette);
+		pDecoder->pfnLookupColors(palette, ReadU32(pBlock + 4), pTexels);
+	}
+}
+
+VOID SwDecodeBlock(D3DFORMAT Format, const BYTE* pBlock, DWORD* pTexels)
+{
+	DecodeBlock(s_pBlockDecoder, Format, pBlock, pTexels);
+}
+
+//-----------------------------------------------------------------------------
+// 색 블록 인코더
+//-----------------------------------------------------------------------------
+// 4색 모드에서 색인 k가 끝점 0에 주는 가중치
+static const float	s_fEndpointWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+static inline INT ClampByte(float f)
+{
+	return (f <= 0.0f) ? 0 : ((f >= 255.0f) ? 255 : (INT)(f + 0.5f));
+}
+
+static inline WORD QuantizeColor(const float* pColor)
+{
+	const UINT r = (ClampByte(pColor[0]) * 31 + 127) / 255;
+	const UINT g = (ClampByte(pColor[1]) * 63 + 127) / 255;
+	const UINT b = (ClampByte(pColor[2]) * 31 + 127) / 255;
+	return (WORD)((r << 11) | (g << 5) | b);
+}
+
+// 4색 모드 팔레트에서 텍셀마다 가장 가까운 색을 골라 색인을 *pIndices에 채우고 제곱 오차 합을 돌려준다.
+static UINT MatchColors(const INT (*pColors)[3], WORD c0, WORD c1, DWORD* pIndices)
+{
+	const DWORD e0 = Expand565(c0);
+	const DWORD e1 = Expand565(c1);
+	const DWORD palette[4] = { e0, e1, MixColor(e0, e1, 2, 1, 3), MixColor(e0, e1, 1, 2, 3) };
+
+	INT rgb[4][3];
+	for (UINT k = 0; k < 4; ++k)
+	{
+		rgb[k][0] = (palette[k] >> 16) & 0xff;
+		rgb[k][1] = (palette[k] >> 8) & 0xff;
+		rgb[k][2] = palette[k] & 0xff;
+	}
+
+	UINT nTotal = 0;
+	DWORD dwIndices = 0;
+	for (UINT i = 0; i < 16; ++i)
+	{
+		UINT nBest = 0, nBestError = ~0u;
+		for (UINT k = 0; k < 4; ++k)
+		{
+			const INT dr = pColors[i][0] - rgb[k][0];
+			const INT dg = pColors[i][1] - rgb[k][1];
+			const INT db = pColors[i][2] - rgb[k][2];
+			const UINT nError = (UINT)(dr * dr + dg * dg + db * db);
+			if (nError < nBestError)
+			{
+				nBestError = nError;
+				nBest = k;
+			}
+		}
+		nTotal += nBestError;
+		dwIndices |= nBest << (i * 2);
+	}
+
+	*pIndices = dwIndices;
+	return nTotal;
+}
+
+// 색인을 고정하고 끝점을 최소 제곱으로 구한다. 모든 텍셀이 한 끝점에 몰려 있으면 false.
+static bool SolveEndpoints(const INT (*pColors)[3], DWORD dwIndices, float* pEnd0, float* pEnd1)
+{
+	float fAA = 0.0f, fAB = 0.0f, fBB = 0.0f;
+	float fAX[3] = {}, fBX[3] = {};
+	for (UINT i = 0; i < 16; ++i)
+	{
+		const float a = s_fEndpointWeights[(dwIndices >> (i * 2)) & 3];
+		const float b = 1.0f - a;
+		fAA += a * a;
+		fAB += a * b;
+		fBB += b * b;
+		for (UINT c = 0; c < 3; ++c)
+		{
+			fAX[c] += a * (float)pColors[i][c];
+			fBX[c] += b * (float)pColors[i][c];
+		}
+	}
+
+	const float fDet = fAA * fBB - fAB * fAB;
+	if (fabsf(fDet) < 1e-6f)
+		return false;
+
+	const float fInvDet = 1.0f / fDet;
+	for (UINT c = 0; c < 3; ++c)
+	{
+		pEnd0[c] = (fAX[c] * fBB - fBX[c] * fAB) * fInvDet;
+		pEnd1[c] = (fBX[c] * fAA - fAX[c] * fAB) * fInvDet;
+	}
+	return true;
+}
+
+// 끝점 순서를 c0 > c1(4색 모드)로 맞추어 쓴다. 같으면 모든 텍셀이 끝점 0을 쓴다.
+static VOID WriteColorBlock(WORD c0, WORD c1, DWORD dwIndices, BYTE* pBlock)
+{
+	if (c0 < c1)
+	{
+		const WORD t = c0;
+		c0 = c1;
+		c1 = t;
+		dwIndices ^= 0x55555555;	// 0 <-> 1, 2 <-> 3
+	}
+	else if (c0 == c1)
+	{
+		dwIndices = 0;
+	}
+
+	WriteU16(pBlock, c0);
+	WriteU16(pBlock + 2, c1);
+	WriteU32(pBlock + 4, dwIndices);
+}
+
+static VOID EncodeColorBlock(const DWORD* pTexels, BYTE* pBlock)
+{
+	INT colors[16][3];
+	INT nMin[3] = { 255, 255, 255 }, nMax[3] = { 0, 0, 0 };
+	for (UINT i = 0; i < 16; ++i)
+	{
+		colors[i][0] = (pTexels[i] >> 16) & 0xff;
+		colors[i][1] = (pTexels[i] >> 8) & 0xff;
+		colors[i][2] = pTexels[i] & 0xff;
+		for (UINT c = 0; c < 3; ++c)
+		{
+			nMin[c] = (colors[i][c] < nMin[c]) ? colors[i][c] : nMin[c];
+			nMax[c] = (colors[i][c] > nMax[c]) ? colors[i][c] : nMax[c];
+		}
+	}
+
+	// 단색 블록은 세 번째 팔레트 색이 그 색에 가장 가까운 끝점 쌍을 표에서 찾는다.
+	if (nMin[0] == nMax[0] && nMin[1] == nMax[1] && nMin[2] == nMax[2])
+	{
+		const WORD c0 = (WORD)((s_Tables.Match5[nMin[0]][0] << 11) | (s_Tables.Match6[nMin[1]][0] << 5) |
+			s_Tables.Match5[nMin[2]][0]);
+		const WORD c1 = (WORD)((s_Tables.Match5[nMin[0]][1] << 11) | (s_Tables.Match6[nMin[1]][1] << 5) |
+			s_Tables.Match5[nMin[2]][1]);
+		WriteColorBlock(c0, c1, 0xaaaaaaaa, pBlock);
+		return;
+	}
+
+	// 주성분 축: 공분산 행렬에 거듭제곱법을 적용한다.
+	float fMean[3] = {};
+	for (UINT i = 0; i < 16; ++i)
+	{
+		for (UINT c = 0; c < 3; ++c)
+			fMean[c] += (float)colors[i][c];
+	}
+	for (UINT c = 0; c < 3; ++c)
+		fMean[c] *= 1.0f / 16.0f;
+
+	float fCov[6] = {};		// rr, rg, rb, gg, gb, bb
+	for (UINT i = 0; i < 16; ++i)
+	{
+		const float r = colors[i][0] - fMean[0];
+		const float g = colors[i][1] - fMean[1];
+		const float b = colors[i][2] - fMean[2];
+		fCov[0] += r * r;
+		fCov[1] += r * g;
+		fCov[2] += r * b;
+		fCov[3] += g * g;
+		fCov[4] += g * b;
+		fCov[5] += b * b;
+	}
+
+	float fAxis[3] = { (float)(nMax[0] - nMin[0]), (float)(nMax[1] - nMin[1]), (float)(nMax[2] - nMin[2]) };
+	for (UINT nIter = 0; nIter < 8; ++nIter)
+	{
+		const float r = fAxis[0] * fCov[0] + fAxis[1] * fCov[1] + fAxis[2] * fCov[2];
+		const float g = fAxis[0] * fCov[1] + fAxis[1] * fCov[3] + fAxis[2] * fCov[4];
+		const float b = fAxis[0] * fCov[2] + fAxis[1] * fCov[4] + fAxis[2] * fCov[5];
+		const float fLength = fabsf(r) > fabsf(g) ? (fabsf(r) > fabsf(b) ? fabsf(r) : fabsf(b)) :
+			(fabsf(g) > fabsf(b) ? fabsf(g) : fabsf(b));
+		if (fLength < 1e-6f)
+			break;
+		fAxis[0] = r / fLength;
+		fAxis[1] = g / fLength;
+		fAxis[2] = b / fLength;
+	}
+
+	// 축 위에서 양 끝에 있는 텍셀을 끝점으로 잡고, 양쪽에서 범위의 1/16만큼 안으로 당긴다.
+	UINT nMinIndex = 0, nMaxIndex = 0;
+	float fMinDot = 1e30f, fMaxDot = -1e30f;
+	for (UINT i = 0; i < 16; ++i)
+	{
+		const float fDot = colors[i][0] * fAxis[0] + colors[i][1] * fAxis[1] + colors[i][2] * fAxis[2];
+		if (fDot < fMinDot)
+		{
+			fMinDot = fDot;
+			nMinIndex = i;
+		}
+		if (fDot > fMaxDot)
+		{
+			fMaxDot = fDot;
+			nMaxIndex = i;
+		}
+	}
+
+	float fEnd0[3], fEnd1[3];
+	for (UINT c = 0; c < 3; ++c)
+	{
+		const float fInset = (float)(colors[nMaxIndex][c] - colors[nMinIndex][c]) / 16.0f;
+		fEnd0[c] = colors[nMaxIndex][c] - fInset;
+		fEnd1[c] = colors[nMinIndex][c] + fInset;
+	}
+
+	WORD c0 = QuantizeColor(fEnd0);
+	WORD c1 = QuantizeColor(fEnd1);
+	DWORD dwIndices;
+	UINT nError = MatchColors(colors, c0, c1, &dwIndices);
+
+	// 색인을 고정하고 끝점을 다시 구한다. 오차가 줄지 않으면 멈춘다.
+	for (UINT nStep = 0; nStep < SW_BC_REFINE_STEPS && nError > 0; ++nStep)
+	{
+		if (!SolveEndpoints(colors, dwIndices, fEnd0, fEnd1))
+			break;
+
+		const WORD n0 = QuantizeColor(fEnd0);
+		const WORD n1 = QuantizeColor(fEnd1);
+		DWORD dwNewIndices;
+		const UINT nNewError = MatchColors(colors, n0, n1, &dwNewIndices);
+		if (nNewError >= nError)
+			break;
+
+		c0 = n0;
+		c1 = n1;
+		dwIndices = dwNewIndices;
+		nError = nNewError;
+	}
+
+	WriteColorBlock(c0, c1, dwIndices, pBlock);
+}
+
+//-----------------------------------------------------------------------------
+// 알파 블록 인코더
+//-----------------------------------------------------------------------------
+// 팔레트에서 텍셀마다 가장 가까운 알파를 골라 48비트 색인과 제곱 오차 합을 구한다.
+static UINT MatchAlphas(const UINT* pAlphas, UINT a0, UINT a1, UINT64* pIndices)
+{
+	UINT values[8];
+	MakeAlphaValues(a0, a1, values);
+
+	UINT nTotal = 0;
+	UINT64 nIndices = 0;
+	for (UINT i = 0; i < 16; ++i)
+	{
+		UINT nBest = 0, nBestError = ~0u;
+		for (UINT k = 0; k < 8; ++k)
+		{
+			const INT d = (INT)pAlphas[i] - (INT)values[k];
+			const UINT nError = (UINT)(d * d);
+			if (nError < nBestError)
+			{
+				nBestError = nError;
+				nBest = k;
+			}
+		}
+		nTotal += nBestError;
+		nIndices |= (UINT64)nBest << (i * 3);
+	}
+
+	*pIndices = nIndices;
+	return nTotal;
+}
+
+static VOID EncodeAlphaBlock(const DWORD* pTexels, BYTE* pBlock)
+{
+	UINT alphas[16];
+	UINT nMin = 255, nMax = 0;
+	UINT nInnerMin = 255, nInnerMax = 0;		// 0과 255를 뺀 범위
+	for (UINT i = 0; i < 16; ++i)
+	{
+		const UINT a = pTexels[i] >> 24;
+		alphas[i] = a;
+		nMin = (a < nMin) ? a : nMin;
+		nMax = (a > nMax) ? a : nMax;
+		if (a != 0 && a != 255)
+		{
+			nInnerMin = (a < nInnerMin) ? a : nInnerMin;
+			nInnerMax = (a > nInnerMax) ? a : nInnerMax;
+		}
+	}
+
+	UINT a0 = nMax, a1 = nMin;
+	UINT64 nIndices = 0;
+	if (nMin != nMax)
+	{
+		// 8단계 보간(a0 > a1)
+		UINT nError = MatchAlphas(alphas, nMax, nMin, &nIndices);
+
+		// 0이나 255가 섞여 있으면 나머지 값 범위만 보간하는 6단계 모드(a0 <= a1)도 해 본다.
+		if (nMin == 0 || nMax == 255)
+		{
+			const UINT n0 = (nInnerMin <= nInnerMax) ? nInnerMin : 0;
+			const UINT n1 = (nInnerMin <= nInnerMax) ? nInnerMax : 0;
+			UINT64 nNewIndices;
+			const UINT nNewError = MatchAlphas(alphas, n0, n1, &nNewIndices);
+			if (nNewError < nError)
+			{
+				a0 = n0;
+				a1 = n1;
+				nIndices = nNewIndices;
+			}
+		}
+	}
+
+	pBlock[0] = (BYTE)a0;
+	pBlock[1] = (BYTE)a1;
+	WriteU32(pBlock + 2, (DWORD)nIndices);
+	WriteU16(pBlock + 6, (WORD)(nIndices >> 32));
+}
+
+VOID SwEncodeBlock(D3DFORMAT Format, const DWORD* pTexels, BYTE* pBlock)
+{
+	if (Format == D3DFMT_DXT5)
+	{
+		EncodeAlphaBlock(pTexels, pBlock);
+		EncodeColorBlock(pTexels, pBlock + 8);
+	}
+	else
+	{
+		EncodeColorBlock(pTexels, pBlock);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 표면
+//-----------------------------------------------------------------------------
+static VOID CompressBlockRow(D3DFORMAT Format, const BYTE* pBits, INT nPitch, UINT nWidth, UINT nHeight,
+	UINT nBlockY, BYTE* pDst)
+{
+	const UINT nBlockSize = SwGetBlockSize(Format);
+	const UINT nBlocksX = (nWidth + 3) / 4;
+
+	const DWORD* pRows[4];
+	for (UINT y = 0; y < 4; ++y)
+	{
+		const UINT sy = (nBlockY * 4 + y < nHeight) ? nBlockY * 4 + y : nHeight - 1;
+		pRows[y] = (const DWORD*)(pBits + (ptrdiff_t)sy * nPitch);
+	}
+
+	DWORD texels[16];
+	for (UINT bx = 0; bx < nBlocksX; ++bx)
+	{
+		for (UINT y = 0; y < 4; ++y)
+		{
+			for (UINT x = 0; x < 4; ++x)
+			{
+				const UINT sx = (bx * 4 + x < nWidth) ? bx * 4 + x : nWidth - 1;
+				texels[y * 4 + x] = pRows[y][sx];
+			}
+		}
+		SwEncodeBlock(Format, texels, pDst + bx * nBlockSize);
+	}
+}
+
+HRESULT SwCompressSurface(D3DFORMAT Format, const void* pBits, INT nPitch, UINT nWidth, UINT nHeight,
+	void* pBlocks, INT nBlockPitch, CSwThreadPool* pThreadPool)
+{
+	if (SwGetBlockSize(Format) == 0 || pBits == NULL || pBlocks == NULL || nWidth == 0 || nHeight == 0)
+		return D3DERR_INVALIDCALL;
+
+	if (pThreadPool == NULL && (size_t)nWidth * nHeight >= SW_BC_PARALLEL_MIN_TEXELS)
+		pThreadPool = SwGetDefaultThreadPool();
+
+	const BYTE* pSrc = (const BYTE*)pBits;
+	BYTE* pDst = (BYTE*)pBlocks;
+	const UINT nBlocksY = (nHeight + 3) / 4;
+	const UINT nBands = (nBlocksY + SW_BC_BAND_ROWS - 1) / SW_BC_BAND_ROWS;
+	auto compressBand = [&](UINT nBand, UINT)
+	{
+		const UINT y0 = nBand * SW_BC_BAND_ROWS;
+		const UINT y1 = (y0 + SW_BC_BAND_ROWS < nBlocksY) ? y0 + SW_BC_BAND_ROWS : nBlocksY;
+		for (UINT by = y0; by < y1; ++by)
+			CompressBlockRow(Format, pSrc, nPitch, nWidth, nHeight, by, pDst + (ptrdiff_t)by * nBlockPitch);
+	};
+
+	if (pThreadPool == NULL || nBands == 1)
+	{
+		for (UINT i = 0; i < nBands; ++i)
+			compressBand(i, 0);
+	}
+	else
+	{
+		pThreadPool->ParallelFor(nBands, compressBand);
+	}
+	return S_OK;
+}
+
+HRESULT SwDecompressSurface(D3DFORMAT Format, const void* pBlocks, INT nBlockPitch, UINT nWidth, UINT nHeight,
+	void* pBits, INT nPitch)
+{
+	const UINT nBlockSize = SwGetBlockSize(Format);
+	if (nBlockSize == 0 || pBlocks == NULL || pBits == NULL)
+		return D3DERR_INVALIDCALL;
+
+	const BCDECODER* pDecoder = s_pBlockDecoder;
+
+	DWORD texels[16];
+	for (UINT by = 0; by * 4 < nHeight; ++by)
+	{
+		const BYTE* pSrc = (const BYTE*)pBlocks + (ptrdiff_t)by * nBlockPitch;
+		const UINT nRows = (nHeight - by * 4 < 4) ? nHeight - by * 4 : 4;
+		for (UINT bx = 0; bx * 4 < nWidth; ++bx)
+		{
+			DecodeBlock(pDecoder, Format, pSrc + bx * nBlockSize, texels);
+
+			// 가장자리 블록은 표면 안에 있는 텍셀만 옮긴다.
+			const UINT nCols = (nWidth - bx * 4 < 4) ? nWidth - bx * 4 : 4;
+			for (UINT y = 0; y < nRows; ++y)
+			{
+				DWORD* pDst = (DWORD*)((BYTE*)pBits + (ptrdiff_t)(by * 4 + y) * nPitch) + bx * 4;
+				memcpy(pDst, texels + y * 4, nCols * sizeof(DWORD));
+			}
+		}
+	}
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 텍스처
+//-----------------------------------------------------------------------------
+HRESULT SwCompressTexture(const CSwTexture* pSource, D3DFORMAT Format, CSwTexture** ppTexture,
+	CSwThreadPool* pThreadPool)
+{
+	if (pSource == NULL || ppTexture == NULL || SwGetBlockSize(Format) == 0 || pSource->GetBlockSize() != 0)
+		return D3DERR_INVALIDCALL;
+
+	// 작은 밉 레벨도 레벨 0의 크기로 판단하여 같은 풀을 쓴다.
+	if (pThreadPool == NULL && (size_t)pSource->GetWidth() * pSource->GetHeight() >= SW_BC_PARALLEL_MIN_TEXELS)
+		pThreadPool = SwGetDefaultThreadPool();
+
+	CSwTexture* pTexture = new CSwTexture(pSource->GetWidth(), pSource->GetHeight(),
+		pSource->GetLevelCount(), Format);
+	HRESULT hr = S_OK;
+	for (UINT i = 0; i < pSource->GetLevelCount() && SUCCEEDED(hr); ++i)
+	{
+		D3DLOCKED_RECT rect;
+		if (SUCCEEDED(hr = pTexture->LockRect(i, &rect, NULL, 0)))
+		{
+			hr = SwCompressSurface(Format, pSource->GetBits(i), pSource->GetPitch(i), pSource->GetWidth(i),
+				pSource->GetHeight(i), rect.pBits, rect.Pitch, pThreadPool);
+			pTexture->UnlockRect(i);
+		}
+	}
+	if (FAILED(hr))
+	{
+		pTexture->Release();
+		return hr;
+	}
+
+	*ppTexture = pTexture;
+	return S_OK;
+}
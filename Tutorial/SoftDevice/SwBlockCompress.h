@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBlockCompress.h
+//
+// 설명:	BC1(DXT1), BC3(DXT5) 블록 압축.
+//		4x4 텍셀 묶음을 BC1은 8바이트(끝점 색 2개와 2비트 색인 16개), BC3은 여기에 알파 블록 8바이트를
+//		더한 16바이트로 줄인다. 32비트 텍셀에 비해 BC1은 1/8, BC3은 1/4 크기다.
+//
+//		인코더는 블록 색의 주성분 축 양 끝을 끝점으로 잡고, 색인을 정한 다음 최소 제곱으로 끝점을 다시 구한다.
+//		단색 블록은 표를 써서 가장 가까운 끝점 쌍을 고른다. 처음 읽을 때나 오프라인에서 한 번만 실행하므로
+//		속도보다 화질을 우선한다. 디코더는 블록 하나를 16텍셀로 풀며 SSSE3/AVX2 구현을 실행 중에 고른다.
+//		모든 디코더 구현의 결과는 스칼라 구현과 같다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+class CSwTexture;
+class CSwThreadPool;
+
+enum SW_BCDECODER
+{
+	SW_BCDECODER_AUTO = 0,			// CPU가 지원하는 가장 빠른 구현
+	SW_BCDECODER_SCALAR,
+	SW_BCDECODER_SSSE3,
+	SW_BCDECODER_AVX2,
+};
+
+// 사용할 구현을 고른다. 지원하지 않는 구현을 요청하면 그보다 좁은 구현을 쓴다.
+// 실제로 선택된 구현을 돌려준다. 디코딩 중에는 호출하지 않는다.
+SW_BCDECODER	SwSetBlockDecoder(SW_BCDECODER eDecoder);
+SW_BCDECODER	SwGetBlockDecoder();
+const char*		SwGetBlockDecoderName(SW_BCDECODER eDecoder);
+
+// 블록 하나의 바이트 수. D3DFMT_DXT1은 8, D3DFMT_DXT5는 16, 그 밖의 형식은 0이다.
+UINT	SwGetBlockSize(D3DFORMAT Format);
+
+// 4x4 텍셀(A8R8G8B8, 위쪽 행부터) 하나를 압축한다. BC1은 알파를 무시하고 불투명 블록을 만든다.
+VOID	SwEncodeBlock(D3DFORMAT Format, const DWORD* pTexels, BYTE* pBlock);
+
+// 블록 하나를 16텍셀(A8R8G8B8, 위쪽 행부터)로 푼다.
+VOID	SwDecodeBlock(D3DFORMAT Format, const BYTE* pBlock, DWORD* pTexels);
+
+// 32비트 표면 전체를 압축한다. pBlocks는 블록 한 행마다 nBlockPitch바이트 간격이다.
+// 크기가 4의 배수가 아니면 마지막 블록은 가장자리 텍셀을 반복해 채운다.
+// pThreadPool이 NULL이면 큰 표면에서만 기본 풀(SwGetDefaultThreadPool())을 쓴다.
+HRESULT	SwCompressSurface(D3DFORMAT Format, const void* pBits, INT nPitch, UINT nWidth, UINT nHeight,
+			void* pBlocks, INT nBlockPitch, CSwThreadPool* pThreadPool = NULL);
+
+// 압축된 표면 전체를 32비트 텍셀로 푼다.
+HRESULT	SwDecompressSurface(D3DFORMAT Format, const void* pBlocks, INT nBlockPitch, UINT nWidth, UINT nHeight,
+			void* pBits, INT nPitch);
+
+// A8R8G8B8/X8R8G8B8 텍스처의 모든 레벨을 압축한 새 텍스처를 만든다.
+HRESULT	SwCompressTexture(const CSwTexture* pSource, D3DFORMAT Format, CSwTexture** ppTexture,
+			CSwThreadPool* pThreadPool = NULL);
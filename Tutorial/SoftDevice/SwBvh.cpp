@@ -0,0 +1,770 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBvh.cpp
+//
+// 설명:	4갈래 BVH 생성과 광선 검사(스칼라, SSE2 구현과 실행 중 선택).
+//		상자 검사는 광선 방향의 부호로 가까운 면과 먼 면을 미리 골라 두므로 min/max가 필요 없고,
+//		빈 자리의 뒤집힌 상자는 자연히 맞지 않는다. 삼각형 검사는 Möller-Trumbore 방식이다.
+//-----------------------------------------------------------------------------
+#include "SwBvh.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SW_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_SSE2		__attribute__((target("sse2")))
+#else
+#define SW_TARGET_SSE2
+#endif
+
+#define SW_BVH_BINS			12		// SAH 구간 수
+#define SW_BVH_LEAF_SIZE	4		// 이 수 이하면 항상 잎(삼각형 묶음 하나)
+#define SW_BVH_MAX_LEAF		16		// 이보다 많으면 SAH 비용과 상관없이 나눈다
+#define SW_BVH_MAX_DEPTH	48		// 이진 트리 깊이 제한(넘으면 남은 삼각형을 모두 잎으로)
+#define SW_BVH_STACK_SIZE	(SW_BVH_MAX_DEPTH * 3 + 4)
+
+//-----------------------------------------------------------------------------
+// 생성
+//-----------------------------------------------------------------------------
+namespace
+{
+	struct BOUNDS
+	{
+		FLOAT	Min[3];
+		FLOAT	Max[3];
+
+		VOID Reset()
+		{
+			Min[0] = Min[1] = Min[2] = FLT_MAX;
+			Max[0] = Max[1] = Max[2] = -FLT_MAX;
+		}
+
+		VOID Grow(const FLOAT* p)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				Min[i] = std::min(Min[i], p[i]);
+				Max[i] = std::max(Max[i], p[i]);
+			}
+		}
+
+		VOID Grow(const BOUNDS& b)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				Min[i] = std::min(Min[i], b.Min[i]);
+				Max[i] = std::max(Max[i], b.Max[i]);
+			}
+		}
+
+		FLOAT Area() const
+		{
+			if (Min[0] > Max[0])
+				return 0.0f;
+			const FLOAT dx = Max[0] - Min[0], dy = Max[1] - Min[1], dz = Max[2] - Min[2];
+			return 2.0f * (dx * dy + dy * dz + dz * dx);
+		}
+	};
+
+	struct PRIM
+	{
+		BOUNDS	Bounds;
+		FLOAT	Center[3];
+	};
+
+	struct BUILDNODE
+	{
+		BOUNDS	Bounds;
+		UINT	nLeft;
+		UINT	nRight;
+		UINT	nFirst;			// 잎이면 m_Order 안의 시작 위치
+		UINT	nCount;			// 잎이면 삼각형 수, 내부 노드는 0
+	};
+
+	inline UINT NumGroups(UINT nCount)
+	{
+		return (nCount + 3) / 4;
+	}
+
+	class CBuilder
+	{
+	public:
+		std::vector<PRIM>		m_Prims;
+		std::vector<UINT>		m_Order;
+		std::vector<BUILDNODE>	m_Nodes;
+
+		UINT	Build(UINT nFirst, UINT nCount, UINT nDepth);
+
+	private:
+		UINT	MakeLeaf(const BOUNDS& bounds, UINT nFirst, UINT nCount);
+	};
+
+	UINT CBuilder::MakeLeaf(const BOUNDS& bounds, UINT nFirst, UINT nCount)
+	{
+		BUILDNODE node;
+		node.Bounds = bounds;
+		node.nLeft = node.nRight = 0;
+		node.nFirst = nFirst;
+		node.nCount = nCount;
+		m_Nodes.push_back(node);
+		return (UINT)m_Nodes.size() - 1;
+	}
+
+	UINT CBuilder::Build(UINT nFirst, UINT nCount, UINT nDepth)
+	{
+		BOUNDS bounds, centers;
+		bounds.Reset();
+		centers.Reset();
+		for (UINT i = nFirst; i < nFirst + nCount; ++i)
+		{
+			const PRIM& prim = m_Prims[m_Order[i]];
+			bounds.Grow(prim.Bounds);
+			centers.Grow(prim.Center);
+		}
+
+		if (nCount <= SW_BVH_LEAF_SIZE || nDepth >= SW_BVH_MAX_DEPTH)
+			return MakeLeaf(bounds, nFirst, nCount);
+
+		// 세 축 모두 구간을 나누어 SAH 비용이 가장 작은 분할을 찾는다.
+		// 비용은 삼각형 수가 아니라 한 번에 검사하는 4개 묶음 수로 센다.
+		int nBestAxis = -1;
+		UINT nBestSplit = 0;
+		FLOAT fBestCost = FLT_MAX;
+		for (int nAxis = 0; nAxis < 3; ++nAxis)
+		{
+			const FLOAT fExtent = centers.Max[nAxis] - centers.Min[nAxis];
+			if (fExtent <= 0.0f)
+				continue;
+
+			BOUNDS binBounds[SW_BVH_BINS];
+			UINT binCount[SW_BVH_BINS] = {};
+			for (UINT b = 0; b < SW_BVH_BINS; ++b)
+				binBounds[b].Reset();
+
+			const FLOAT fScale = SW_BVH_BINS / fExtent;
+			for (UINT i = nFirst; i < nFirst + nCount; ++i)
+			{
+				const PRIM& prim = m_Prims[m_Order[i]];
+				const UINT b = std::min((UINT)((prim.Center[nAxis] - centers.Min[nAxis]) * fScale), (UINT)SW_BVH_BINS - 1);
+				binBounds[b].Grow(prim.Bounds);
+				++binCount[b];
+			}
+
+			// 오른쪽부터 누적한 넓이와 수
+			FLOAT rightArea[SW_BVH_BINS];
+			UINT rightCount[SW_BVH_BINS];
+			BOUNDS accum;
+			accum.Reset();
+			UINT nAccum = 0;
+			for (UINT b = SW_BVH_BINS - 1; b > 0; --b)
+			{
+				accum.Grow(binBounds[b]);
+				nAccum += binCount[b];
+				rightArea[b] = accum.Area();
+				rightCount[b] = nAccum;
+			}
+
+			accum.Reset();
+			nAccum = 0;
+			for (UINT b = 0; b < SW_BVH_BINS - 1; ++b)
+			{
+				accum.Grow(binBounds[b]);
+				nAccum += binCount[b];
+				if (nAccum == 0 || rightCount[b + 1] == 0)
+					continue;
+
+				const FLOAT fCost = accum.Area() * NumGroups(nAccum) + rightArea[b + 1] * NumGroups(rightCount[b + 1]);
+				if (fCost < fBestCost)
+				{
+					fBestCost = fCost;
+					nBestAxis = nAxis;
+					nBestSplit = b;
+				}
+			}
+		}
+
+		UINT nMid;
+		if (nBestAxis < 0)
+		{
+			// 중심이 모두 같은 점이면 순서대로 반씩 나눈다.
+			nMid = nFirst + nCount / 2;
+		}
+		else
+		{
+			// 나누는 비용(노드 하나 검사를 묶음 반 개로 본다)이 잎보다 비싸면 잎으로 둔다.
+			const FLOAT fArea = bounds.Area();
+			const FLOAT fSplitCost = 0.5f + ((fArea > 0.0f) ? fBestCost / fArea : 0.0f);
+			if (nCount <= SW_BVH_MAX_LEAF && fSplitCost >= (FLOAT)NumGroups(nCount))
+				return MakeLeaf(bounds, nFirst, nCount);
+
+			const FLOAT fScale = SW_BVH_BINS / (centers.Max[nBestAxis] - centers.Min[nBestAxis]);
+			const FLOAT fMinCenter = centers.Min[nBestAxis];
+			UINT* pMid = std::partition(m_Order.data() + nFirst, m_Order.data() + nFirst + nCount,
+				[&](UINT nPrim)
+				{
+					const UINT b = std::min((UINT)((m_Prims[nPrim].Center[nBestAxis] - fMinCenter) * fScale),
+						(UINT)SW_BVH_BINS - 1);
+					return b <= nBestSplit;
+				});
+			nMid = (UINT)(pMid - m_Order.data());
+			if (nMid == nFirst || nMid == nFirst + nCount)
+				nMid = nFirst + nCount / 2;
+		}
+
+		// 자식을 만드는 동안 m_Nodes가 다시 할당될 수 있으므로 번호로 채운다.
+		const UINT nNode = MakeLeaf(bounds, 0, 0);
+		const UINT nLeft = Build(nFirst, nMid - nFirst, nDepth + 1);
+		const UINT nRight = Build(nMid, nFirst + nCount - nMid, nDepth + 1);
+		m_Nodes[nNode].nLeft = nLeft;
+		m_Nodes[nNode].nRight = nRight;
+		return nNode;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+// 이진 트리를 4갈래 노드로 합친다.
+// 자식 자리가 남으면 표면적이 가장 큰 내부 자식을 그 두 자식으로 바꾸기를 되풀이한다.
+//-----------------------------------------------------------------------------
+namespace
+{
+	struct COLLAPSER
+	{
+		const CBuilder&						Builder;
+		const BYTE*							pPositions;
+		UINT								nStride;
+		const DWORD*						pIndices;
+		std::vector<CSwBvh::NODE>&			Nodes;
+		std::vector<CSwBvh::TRIGROUP>&		Groups;
+
+		const FLOAT* Position(DWORD nVertex) const
+		{
+			return (const FLOAT*)(pPositions + (size_t)nVertex * nStride);
+		}
+
+		// 잎의 삼각형을 4개씩 묶어 첫 묶음 번호를 돌려준다.
+		UINT EmitLeaf(const BUILDNODE& leaf)
+		{
+			const UINT nFirstGroup = (UINT)Groups.size();
+			for (UINT i = 0; i < leaf.nCount; i += 4)
+			{
+				CSwBvh::TRIGROUP group;
+				memset(&group, 0, sizeof(group));
+				for (UINT k = 0; k < 4 && i + k < leaf.nCount; ++k)
+				{
+					const UINT nTriangle = Builder.m_Order[leaf.nFirst + i + k];
+					const FLOAT* p0 = Position(pIndices[nTriangle * 3 + 0]);
+					const FLOAT* p1 = Position(pIndices[nTriangle * 3 + 1]);
+					const FLOAT* p2 = Position(pIndices[nTriangle * 3 + 2]);
+					group.V0X[k] = p0[0];			group.V0Y[k] = p0[1];			group.V0Z[k] = p0[2];
+					group.E1X[k] = p1[0] - p0[0];	group.E1Y[k] = p1[1] - p0[1];	group.E1Z[k] = p1[2] - p0[2];
+					group.E2X[k] = p2[0] - p0[0];	group.E2Y[k] = p2[1] - p0[1];	group.E2Z[k] = p2[2] - p0[2];
+					group.Id[k] = nTriangle;
+				}
+				Groups.push_back(group);
+			}
+			return nFirstGroup;
+		}
+
+		INT Collapse(UINT nBinary)
+		{
+			UINT children[4];
+			UINT nChildren = 0;
+			const BUILDNODE& root = Builder.m_Nodes[nBinary];
+			if (root.nCount > 0)
+			{
+				children[nChildren++] = nBinary;		// 트리 전체가 잎 하나
+			}
+			else
+			{
+				children[nChildren++] = root.nLeft;
+				children[nChildren++] = root.nRight;
+			}
+
+			while (nChildren < 4)
+			{
+				int nBest = -1;
+				FLOAT fBestArea = -1.0f;
+				for (UINT i = 0; i < nChildren; ++i)
+				{
+					const BUILDNODE& child = Builder.m_Nodes[children[i]];
+					if (child.nCount == 0 && child.Bounds.Area() > fBestArea)
+					{
+						fBestArea = child.Bounds.Area();
+						nBest = (int)i;
+					}
+				}
+				if (nBest < 0)
+					break;
+
+				const BUILDNODE& expand = Builder.m_Nodes[children[nBest]];
+				children[nBest] = expand.nLeft;
+				children[nChildren++] = expand.nRight;
+			}
+
+			// 자식을 만드는 동안 Nodes가 다시 할당될 수 있으므로 다 만든 다음 채운다.
+			const INT nNode = (INT)Nodes.size();
+			Nodes.emplace_back();
+
+			CSwBvh::NODE node;
+			for (UINT i = 0; i < 4; ++i)
+			{
+				node.MinX[i] = node.MinY[i] = node.MinZ[i] = FLT_MAX;
+				node.MaxX[i] = node.MaxY[i] = node.MaxZ[i] = -FLT_MAX;
+				node.Child[i] = -1;
+				node.Count[i] = 0;
+			}
+
+			for (UINT i = 0; i < nChildren; ++i)
+			{
+				const BUILDNODE& child = Builder.m_Nodes[children[i]];
+				node.MinX[i] = child.Bounds.Min[0];	node.MaxX[i] = child.Bounds.Max[0];
+				node.MinY[i] = child.Bounds.Min[1];	node.MaxY[i] = child.Bounds.Max[1];
+				node.MinZ[i] = child.Bounds.Min[2];	node.MaxZ[i] = child.Bounds.Max[2];
+				if (child.nCount > 0)
+				{
+					node.Child[i] = ~(INT)EmitLeaf(child);
+					node.Count[i] = NumGroups(child.nCount);
+				}
+				else
+				{
+					node.Child[i] = Collapse(children[i]);
+				}
+			}
+
+			Nodes[nNode] = node;
+			return nNode;
+		}
+	};
+}
+
+CSwBvh::CSwBvh()
+	: m_nNumTriangles(0)
+{
+}
+
+HRESULT CSwBvh::Build(const void* pPositions, UINT nStride, UINT nNumVertices,
+	const DWORD* pIndices, UINT nNumTriangles)
+{
+	m_Nodes.clear();
+	m_Groups.clear();
+	m_nNumTriangles = 0;
+
+	if (pPositions == NULL || pIndices == NULL || nStride < 3 * sizeof(FLOAT) || nNumTriangles == 0)
+		return D3DERR_INVALIDCALL;
+
+	const BYTE* pBytes = (const BYTE*)pPositions;
+	CBuilder builder;
+	builder.m_Prims.resize(nNumTriangles);
+	builder.m_Order.resize(nNumTriangles);
+	for (UINT t = 0; t < nNumTriangles; ++t)
+	{
+		PRIM& prim = builder.m_Prims[t];
+		prim.Bounds.Reset();
+		for (UINT k = 0; k < 3; ++k)
+		{
+			const DWORD nVertex = pIndices[t * 3 + k];
+			if (nVertex >= nNumVertices)
+				return D3DERR_INVALIDCALL;
+			prim.Bounds.Grow((const FLOAT*)(pBytes + (size_t)nVertex * nStride));
+		}
+		for (UINT k = 0; k < 3; ++k)
+			prim.Center[k] = 0.5f * (prim.Bounds.Min[k] + prim.Bounds.Max[k]);
+		builder.m_Order[t] = t;
+	}
+
+	builder.m_Nodes.reserve(nNumTriangles / 2 + 1);
+	const UINT nRoot = builder.Build(0, nNumTriangles, 0);
+
+	COLLAPSER collapser = { builder, pBytes, nStride, pIndices, m_Nodes, m_Groups };
+	m_Nodes.reserve(builder.m_Nodes.size() / 2 + 1);
+	m_Groups.reserve(nNumTriangles / 2 + 1);
+	collapser.Collapse(nRoot);
+
+	m_nNumTriangles = nNumTriangles;
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 광선 검사 공통
+//-----------------------------------------------------------------------------
+namespace
+{
+	struct RAYDATA
+	{
+		FLOAT	Origin[3];
+		FLOAT	Dir[3];
+		FLOAT	InvDir[3];
+		UINT	nNear[3];		// 가까운 면 배열 번호(NODE의 MinX..MaxZ를 0..5로 볼 때)
+		UINT	nFar[3];
+	};
+
+	inline VOID SetupRay(const SW_RAY& ray, RAYDATA* pData)
+	{
+		const FLOAT dir[3] = { ray.Direction.x, ray.Direction.y, ray.Direction.z };
+		pData->Origin[0] = ray.Origin.x;
+		pData->Origin[1] = ray.Origin.y;
+		pData->Origin[2] = ray.Origin.z;
+		for (UINT i = 0; i < 3; ++i)
+		{
+			// 0으로 나누지 않도록 아주 작은 값으로 바꾼다. 무한대와 0을 곱해 NaN이 되는 일이 없다.
+			const FLOAT d = (fabsf(dir[i]) > 1e-30f) ? dir[i] : ((dir[i] < 0.0f) ? -1e-30f : 1e-30f);
+			pData->Dir[i] = dir[i];
+			pData->InvDir[i] = 1.0f / d;
+			pData->nNear[i] = (d >= 0.0f) ? i : i + 3;
+			pData->nFar[i] = (d >= 0.0f) ? i + 3 : i;
+		}
+	}
+
+	struct STACKENTRY
+	{
+		INT		nChild;
+		UINT	nCount;
+		FLOAT	tNear;
+	};
+
+	// 맞은 자식을 가까운 것이 스택 위에 오도록 넣는다.
+	inline VOID PushSorted(const CSwBvh::NODE& node, int nMask, const FLOAT* tNear, STACKENTRY* pStack, UINT* pTop)
+	{
+		UINT order[4];
+		UINT nHits = 0;
+		for (UINT i = 0; i < 4; ++i)
+		{
+			if ((nMask >> i) & 1)
+			{
+				UINT k = nHits++;
+				while (k > 0 && tNear[order[k - 1]] < tNear[i])
+				{
+					order[k] = order[k - 1];
+					--k;
+				}
+				order[k] = i;
+			}
+		}
+		for (UINT k = 0; k < nHits; ++k)
+		{
+			const UINT i = order[k];
+			STACKENTRY& entry = pStack[(*pTop)++];
+			entry.nChild = node.Child[i];
+			entry.nCount = node.Count[i];
+			entry.tNear = tNear[i];
+		}
+	}
+
+	// 묶음의 네 삼각형 중 맞은 것에서 가장 가까운 교점을 고른다. 모든 구현이 같은 순서로 고른다.
+	inline bool SelectHit(const CSwBvh::TRIGROUP& group, int nMask, const FLOAT* t, const FLOAT* u, const FLOAT* v,
+		SW_RAYHIT* pHit)
+	{
+		bool bHit = false;
+		for (UINT k = 0; k < 4; ++k)
+		{
+			if (((nMask >> k) & 1) && t[k] < pHit->t)
+			{
+				pHit->t = t[k];
+				pHit->u = u[k];
+				pHit->v = v[k];
+				pHit->nTriangle = group.Id[k];
+				bHit = true;
+			}
+		}
+		return bHit;
+	}
+
+	typedef bool (*PFNINTERSECT)(const CSwBvh::NODE* pNodes, const CSwBvh::TRIGROUP* pGroups,
+		const RAYDATA& ray, bool bAnyHit, SW_RAYHIT* pHit);
+}
+
+//-----------------------------------------------------------------------------
+// 스칼라 구현
+//-----------------------------------------------------------------------------
+static inline int IntersectBoxesScalar(const CSwBvh::NODE& node, const RAYDATA& ray, FLOAT tMax, FLOAT* tNear)
+{
+	const FLOAT (*pBox)[4] = &node.MinX;
+	int nMask = 0;
+	for (UINT i = 0; i < 4; ++i)
+	{
+		const FLOAT tnx = (pBox[ray.nNear[0]][i] - ray.Origin[0]) * ray.InvDir[0];
+		const FLOAT tny = (pBox[ray.nNear[1]][i] - ray.Origin[1]) * ray.InvDir[1];
+		const FLOAT tnz = (pBox[ray.nNear[2]][i] - ray.Origin[2]) * ray.InvDir[2];
+		const FLOAT tfx = (pBox[ray.nFar[0]][i] - ray.Origin[0]) * ray.InvDir[0];
+		const FLOAT tfy = (pBox[ray.nFar[1]][i] - ray.Origin[1]) * ray.InvDir[1];
+		const FLOAT tfz = (pBox[ray.nFar[2]][i] - ray.Origin[2]) * ray.InvDir[2];
+		const FLOAT tn = std::max(std::max(tnx, tny), std::max(tnz, 0.0f));
+		const FLOAT tf = std::min(std::min(tfx, tfy), std::min(tfz, tMax));
+		tNear[i] = tn;
+		if (tn <= tf)
+			nMask |= 1 << i;
+	}
+	return nMask;
+}
+
+static inline int IntersectTrianglesScalar(const CSwBvh::TRIGROUP& g, const RAYDATA& ray, FLOAT tMax,
+	FLOAT* t, FLOAT* u, FLOAT* v)
+{
+	const FLOAT dx = ray.Dir[0], dy = ray.Dir[1], dz = ray.Dir[2];
+	int nMask = 0;
+	for (UINT k = 0; k < 4; ++k)
+	{
+		const FLOAT px = dy * g.E2Z[k] - dz * g.E2Y[k];
+		const FLOAT py = dz * g.E2X[k] - dx * g.E2Z[k];
+		const FLOAT pz = dx * g.E2Y[k] - dy * g.E2X[k];
+		const FLOAT det = (g.E1X[k] * px + g.E1Y[k] * py) + g.E1Z[k] * pz;
+		const FLOAT inv = 1.0f / det;
+		const FLOAT sx = ray.Origin[0] - g.V0X[k];
+		const FLOAT sy = ray.Origin[1] - g.V0Y[k];
+		const FLOAT sz = ray.Origin[2] - g.V0Z[k];
+		u[k] = ((sx * px + sy * py) + sz * pz) * inv;
+		const FLOAT qx = sy * g.E1Z[k] - sz * g.E1Y[k];
+		const FLOAT qy = sz * g.E1X[k] - sx * g.E1Z[k];
+		const FLOAT qz = sx * g.E1Y[k] - sy * g.E1X[k];
+		v[k] = ((dx * qx + dy * qy) + dz * qz) * inv;
+		t[k] = ((g.E2X[k] * qx + g.E2Y[k] * qy) + g.E2Z[k] * qz) * inv;
+		if (det != 0.0f && u[k] >= 0.0f && v[k] >= 0.0f && u[k] + v[k] <= 1.0f && t[k] > 0.0f && t[k] < tMax)
+			nMask |= 1 << k;
+	}
+	return nMask;
+}
+
+static bool IntersectScalar(const CSwBvh::NODE* pNodes, const CSwBvh::TRIGROUP* pGroups,
+	const RAYDATA& ray, bool bAnyHit, SW_RAYHIT* pHit)
+{
+	STACKENTRY stack[SW_BVH_STACK_SIZE];
+	UINT nTop = 0;
+	stack[nTop++] = { 0, 0, 0.0f };
+
+	bool bHit = false;
+	while (nTop > 0)
+	{
+		const STACKENTRY entry = stack[--nTop];
+		if (entry.tNear > pHit->t)
+			continue;
+
+		if (entry.nChild >= 0)
+		{
+			FLOAT tNear[4];
+			const int nMask = IntersectBoxesScalar(pNodes[entry.nChild], ray, pHit->t, tNear);
+			PushSorted(pNodes[entry.nChild], nMask, tNear, stack, &nTop);
+			continue;
+		}
+
+		const CSwBvh::TRIGROUP* pGroup = pGroups + ~entry.nChild;
+		for (UINT i = 0; i < entry.nCount; ++i, ++pGroup)
+		{
+			FLOAT t[4], u[4], v[4];
+			const int nMask = IntersectTrianglesScalar(*pGroup, ray, pHit->t, t, u, v);
+			if (nMask && SelectHit(*pGroup, nMask, t, u, v, pHit))
+			{
+				bHit = true;
+				if (bAnyHit)
+					return true;
+			}
+		}
+	}
+	return bHit;
+}
+
+#ifdef SW_X86
+//-----------------------------------------------------------------------------
+// SSE2 구현: 상자 4개, 삼각형 4개를 한 번에
+//-----------------------------------------------------------------------------
+SW_TARGET_SSE2
+static inline int IntersectBoxesSSE2(const CSwBvh::NODE& node, const RAYDATA& ray, const __m128* pOrigin,
+	const __m128* pInvDir, FLOAT tMax, FLOAT* tNear)
+{
+	const FLOAT (*pBox)[4] = &node.MinX;
+	const __m128 tnx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBox[ray.nNear[0]]), pOrigin[0]), pInvDir[0]);
+	const __m128 tny = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBox[ray.nNear[1]]), pOrigin[1]), pInvDir[1]);
+	const __m128 tnz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBox[ray.nNear[2]]), pOrigin[2]), pInvDir[2]);
+	const __m128 tfx = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBox[ray.nFar[0]]), pOrigin[0]), pInvDir[0]);
+	const __m128 tfy = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBox[ray.nFar[1]]), pOrigin[1]), pInvDir[1]);
+	const __m128 tfz = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(pBox[ray.nFar[2]]), pOrigin[2]), pInvDir[2]);
+	const __m128 tn = _mm_max_ps(_mm_max_ps(tnx, tny), _mm_max_ps(tnz, _mm_setzero_ps()));
+	const __m128 tf = _mm_min_ps(_mm_min_ps(tfx, tfy), _mm_min_ps(tfz, _mm_set1_ps(tMax)));
+	_mm_storeu_ps(tNear, tn);
+	return _mm_movemask_ps(_mm_cmple_ps(tn, tf));
+}
+
+SW_TARGET_SSE2
+static inline int IntersectTrianglesSSE2(const CSwBvh::TRIGROUP& g, const __m128* pOrigin, const __m128* pDir,
+	FLOAT tMax, FLOAT* t, FLOAT* u, FLOAT* v)
+{
+	const __m128 dx = pDir[0], dy = pDir[1], dz = pDir[2];
+	const __m128 e1x = _mm_loadu_ps(g.E1X), e1y = _mm_loadu_ps(g.E1Y), e1z = _mm_loadu_ps(g.E1Z);
+	const __m128 e2x = _mm_loadu_ps(g.E2X), e2y = _mm_loadu_ps(g.E2Y), e2z = _mm_loadu_ps(g.E2Z);
+
+	const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+	const __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+	const __m128 sx = _mm_sub_ps(pOrigin[0], _mm_loadu_ps(g.V0X));
+	const __m128 sy = _mm_sub_ps(pOrigin[1], _mm_loadu_ps(g.V0Y));
+	const __m128 sz = _mm_sub_ps(pOrigin[2], _mm_loadu_ps(g.V0Z));
+	const __m128 vu = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), inv);
+
+	const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+	const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+	const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+	const __m128 vv = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), inv);
+	const __m128 vt = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), inv);
+
+	const __m128 zero = _mm_setzero_ps();
+	__m128 mask = _mm_cmpneq_ps(det, zero);
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(vu, zero));
+	mask = _mm_and_ps(mask, _mm_cmpge_ps(vv, zero));
+	mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(vu, vv), _mm_set1_ps(1.0f)));
+	mask = _mm_and_ps(mask, _mm_cmpgt_ps(vt, zero));
+	mask = _mm_and_ps(mask, _mm_cmplt_ps(vt, _mm_set1_ps(tMax)));
+
+	_mm_storeu_ps(t, vt);
+	_mm_storeu_ps(u, vu);
+	_mm_storeu_ps(v, vv);
+	return _mm_movemask_ps(mask);
+}
+
+SW_TARGET_SSE2
+static bool IntersectSSE2(const CSwBvh::NODE* pNodes, const CSwBvh::TRIGROUP* pGroups,
+	const RAYDATA& ray, bool bAnyHit, SW_RAYHIT* pHit)
+{
+	const __m128 origin[3] = { _mm_set1_ps(ray.Origin[0]), _mm_set1_ps(ray.Origin[1]), _mm_set1_ps(ray.Origin[2]) };
+	const __m128 dir[3] = { _mm_set1_ps(ray.Dir[0]), _mm_set1_ps(ray.Dir[1]), _mm_set1_ps(ray.Dir[2]) };
+	const __m128 invDir[3] = { _mm_set1_ps(ray.InvDir[0]), _mm_set1_ps(ray.InvDir[1]), _mm_set1_ps(ray.InvDir[2]) };
+
+	STACKENTRY stack[SW_BVH_STACK_SIZE];
+	UINT nTop = 0;
+	stack[nTop++] = { 0, 0, 0.0f };
+
+	bool bHit = false;
+	while (nTop > 0)
+	{
+		const STACKENTRY entry = stack[--nTop];
+		if (entry.tNear > pHit->t)
+			continue;
+
+		if (entry.nChild >= 0)
+		{
+			FLOAT tNear[4];
+			const int nMask = IntersectBoxesSSE2(pNodes[entry.nChild], ray, origin, invDir, pHit->t, tNear);
+			PushSorted(pNodes[entry.nChild], nMask, tNear, stack, &nTop);
+			continue;
+		}
+
+		const CSwBvh::TRIGROUP* pGroup = pGroups + ~entry.nChild;
+		for (UINT i = 0; i < entry.nCount; ++i, ++pGroup)
+		{
+			FLOAT t[4], u[4], v[4];
+			const int nMask = IntersectTrianglesSSE2(*pGroup, origin, dir, pHit->t, t, u, v);
+			if (nMask && SelectHit(*pGroup, nMask, t, u, v, pHit))
+			{
+				bHit = true;
+				if (bAnyHit)
+					return true;
+			}
+		}
+	}
+	return bHit;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// 구현 선택
+//-----------------------------------------------------------------------------
+#ifdef SW_X86
+static bool HasSSE2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+#endif
+
+static SW_RAYKERNEL GetBestRayKernel()
+{
+#ifdef SW_X86
+	if (HasSSE2())
+		return SW_RAYKERNEL_SSE2;
+#endif
+	return SW_RAYKERNEL_SCALAR;
+}
+
+static SW_RAYKERNEL		s_eRayKernel = SW_RAYKERNEL_SCALAR;
+static PFNINTERSECT		s_pfnIntersect = IntersectScalar;
+
+// 정적 초기화 시점에 한 번 선택해 둔다.
+static const SW_RAYKERNEL	s_eInitialRayKernel = SwSetRayKernel(SW_RAYKERNEL_AUTO);
+
+SW_RAYKERNEL SwSetRayKernel(SW_RAYKERNEL eKernel)
+{
+	const SW_RAYKERNEL eBest = GetBestRayKernel();
+	if (eKernel == SW_RAYKERNEL_AUTO || eKernel > eBest)
+		eKernel = eBest;
+
+	switch (eKernel)
+	{
+#ifdef SW_X86
+	case SW_RAYKERNEL_SSE2:	s_pfnIntersect = IntersectSSE2;		break;
+#endif
+	default:
+		eKernel = SW_RAYKERNEL_SCALAR;
+		s_pfnIntersect = IntersectScalar;
+		break;
+	}
+
+	s_eRayKernel = eKernel;
+	return eKernel;
+}
+
+SW_RAYKERNEL SwGetRayKernel()
+{
+	return s_eRayKernel;
+}
+
+const char* SwGetRayKernelName(SW_RAYKERNEL eKernel)
+{
+	switch (eKernel)
+	{
+	case SW_RAYKERNEL_SCALAR:	return "scalar";
+	case SW_RAYKERNEL_SSE2:		return "sse2";
+	default:					return "auto";
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 광선 검사
+//-----------------------------------------------------------------------------
+bool CSwBvh::Intersect(const SW_RAY& ray, SW_RAYHIT* pHit) const
+{
+	if (m_Nodes.empty())
+		return false;
+
+	RAYDATA data;
+	SetupRay(ray, &data);
+	pHit->t = ray.tMax;
+	return s_pfnIntersect(m_Nodes.data(), m_Groups.data(), data, false, pHit);
+}
+
+bool CSwBvh::Occluded(const SW_RAY& ray) const
+{
+	if (m_Nodes.empty())
+		return false;
+
+	RAYDATA data;
+	SetupRay(ray, &data);
+	SW_RAYHIT hit;
+	hit.t = ray.tMax;
+	return s_pfnIntersect(m_Nodes.data(), m_Groups.data(), data, true, &hit);
+}
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwBvh.h
+//
+// 설명:	삼각형 장면의 광선 검사용 4갈래 BVH(bounding volume hierarchy).
+//		구간(bin) 12개의 SAH로 이진 트리를 만든 다음, 노드마다 표면적이 큰 자식부터 펼쳐
+//		자식 4개짜리 노드로 합친다. 노드는 자식 4개의 상자를 축별 배열(SoA)로 갖고, 잎은 삼각형을
+//		4개씩 같은 배치로 묶어 두므로 광선 하나로 상자 4개, 삼각형 4개를 한 번에 SSE2로 검사한다.
+//		반사광 광선처럼 방향이 제각각인 광선에도 효율이 떨어지지 않는 방식이다.
+//		모든 구현은 같은 순서로 계산하므로 가장 가까운 교점의 거리가 스칼라 구현과 같다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <vector>
+
+enum SW_RAYKERNEL
+{
+	SW_RAYKERNEL_AUTO = 0,			// CPU가 지원하는 가장 빠른 구현
+	SW_RAYKERNEL_SCALAR,
+	SW_RAYKERNEL_SSE2,
+};
+
+// 사용할 구현을 고른다. 지원하지 않는 구현을 요청하면 그보다 좁은 구현을 쓴다.
+// 실제로 선택된 구현을 돌려준다. 광선 검사 중에는 호출하지 않는다.
+SW_RAYKERNEL	SwSetRayKernel(SW_RAYKERNEL eKernel);
+SW_RAYKERNEL	SwGetRayKernel();
+const char*		SwGetRayKernelName(SW_RAYKERNEL eKernel);
+
+struct SW_RAY
+{
+	D3DVECTOR	Origin;
+	D3DVECTOR	Direction;		// 정규화하지 않아도 된다. 거리 t는 Direction의 배수다.
+	FLOAT		tMax;			// 이보다 먼 교점은 무시한다
+};
+
+struct SW_RAYHIT
+{
+	FLOAT		t;
+	UINT		nTriangle;
+	FLOAT		u, v;			// 교점의 무게중심 좌표(정점 1, 정점 2의 가중치)
+};
+
+class CSwBvh
+{
+public:
+	CSwBvh();
+
+	CSwBvh(const CSwBvh&) = delete;
+	CSwBvh& operator=(const CSwBvh&) = delete;
+
+	// 정점 위치(nStride 바이트 간격의 float 3개)와 삼각형마다 3개의 인덱스로 트리를 만든다.
+	// 삼각형은 잎의 묶음으로 옮겨 두므로 호출한 다음 버려도 된다.
+	HRESULT		Build(const void* pPositions, UINT nStride, UINT nNumVertices,
+					const DWORD* pIndices, UINT nNumTriangles);
+
+	// 가장 가까운 교점을 찾는다. 교점이 없으면 false.
+	bool		Intersect(const SW_RAY& ray, SW_RAYHIT* pHit) const;
+	// (0, tMax) 안에 교점이 하나라도 있으면 true. 그림자 광선에 쓴다.
+	bool		Occluded(const SW_RAY& ray) const;
+
+	UINT		GetNumNodes() const { return (UINT)m_Nodes.size(); }
+	UINT		GetNumTriangles() const { return m_nNumTriangles; }
+
+	// 내부 배치(구현 파일에서 쓴다)
+	struct NODE
+	{
+		FLOAT	MinX[4], MinY[4], MinZ[4];
+		FLOAT	MaxX[4], MaxY[4], MaxZ[4];
+		INT		Child[4];		// 0 이상은 노드 번호, 음수는 ~(첫 삼각형 묶음 번호)인 잎
+		UINT	Count[4];		// 잎의 삼각형 묶음 수. 빈 자리는 0이고 상자가 뒤집혀 있다.
+	};
+
+	struct TRIGROUP
+	{
+		FLOAT	V0X[4], V0Y[4], V0Z[4];
+		FLOAT	E1X[4], E1Y[4], E1Z[4];		// 정점 1 - 정점 0
+		FLOAT	E2X[4], E2Y[4], E2Z[4];		// 정점 2 - 정점 0
+		UINT	Id[4];						// 빈 자리는 변이 0인 퇴화 삼각형이라 맞지 않는다
+	};
+
+private:
+	std::vector<NODE>		m_Nodes;
+	std::vector<TRIGROUP>	m_Groups;
+	UINT					m_nNumTriangles;
+};
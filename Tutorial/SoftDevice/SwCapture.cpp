@@ -0,0 +1,631 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwCapture.cpp
+//
+// 설명:	디바이스 호출 캡처의 기록, 읽기, 재생.
+//-----------------------------------------------------------------------------
+#include "SwCapture.h"
+#include "SwLz.h"
+
+#include <cstring>
+
+#define SW_CAPTURE_CHUNKSIZE	(1 << 20)	// 기록이 이만큼 쌓이면 쓰기 스레드로 넘긴다
+#define SW_CAPTURE_MAXPENDING	8			// 쓰기 스레드가 밀리면 기록하는 쪽이 기다린다
+
+static const char* const s_CallNames[SW_CAP_NUMCALLS] =
+{
+	"Device",
+	"CreateVertexBuffer",
+	"CreateIndexBuffer",
+	"CreateTexture",
+	"UpdateResource",
+	"Clear",
+	"BeginScene",
+	"EndScene",
+	"Present",
+	"SetTransform",
+	"SetRenderState",
+	"SetTextureStageState",
+	"SetSamplerState",
+	"SetTexture",
+	"SetMaterial",
+	"SetLight",
+	"LightEnable",
+	"SetStreamSource",
+	"SetFVF",
+	"SetVertexQuant",
+	"SetIndices",
+	"DrawPrimitive",
+	"DrawIndexedPrimitive",
+};
+
+const char* SwGetCaptureCallName(SW_CAPCALL eCall)
+{
+	return ((UINT)eCall < SW_CAP_NUMCALLS) ? s_CallNames[eCall] : "Unknown";
+}
+
+//-----------------------------------------------------------------------------
+// CSwCaptureWriter
+//-----------------------------------------------------------------------------
+CSwCaptureWriter::CSwCaptureWriter()
+	: m_pFile(NULL)
+	, m_dwNextId(1)
+	, m_nNumRecords(0)
+	, m_nRawSize(0)
+	, m_nCompressedSize(0)
+	, m_bQuit(false)
+	, m_bFailed(false)
+{
+}
+
+CSwCaptureWriter::~CSwCaptureWriter()
+{
+	Close();
+}
+
+HRESULT CSwCaptureWriter::Open(const char* pFilename)
+{
+	if (pFilename == NULL || m_pFile)
+		return D3DERR_INVALIDCALL;
+
+	m_pFile = fopen(pFilename, "wb");
+	if (m_pFile == NULL)
+		return E_FAIL;
+
+	SW_CAPFILEHEADER header = { SW_CAPTURE_MAGIC, SW_CAPTURE_VERSION };
+	if (fwrite(&header, sizeof(header), 1, m_pFile) != 1)
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+		return E_FAIL;
+	}
+
+	m_Current.reserve(SW_CAPTURE_CHUNKSIZE + 4096);
+	m_Resources.clear();
+	m_dwNextId = 1;
+	m_nNumRecords = 0;
+	m_nRawSize = 0;
+	m_nCompressedSize.store(sizeof(header), std::memory_order_relaxed);
+	m_bQuit = false;
+	m_bFailed = false;
+	m_Thread = std::thread(&CSwCaptureWriter::WriterMain, this);
+	return S_OK;
+}
+
+HRESULT CSwCaptureWriter::Close()
+{
+	if (m_pFile == NULL)
+		return S_FALSE;
+
+	Submit();
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bQuit = true;
+	}
+	m_Cond.notify_all();
+	m_Thread.join();
+
+	if (fclose(m_pFile) != 0)
+		m_bFailed = true;
+	m_pFile = NULL;
+	return m_bFailed ? E_FAIL : S_OK;
+}
+
+VOID CSwCaptureWriter::Record(SW_CAPCALL eCall, const void* pArgs, UINT nArgSize, const void* pData,
+	size_t nDataSize)
+{
+	if (m_pFile == NULL)
+		return;
+
+	SW_CAPRECORD record = { (WORD)eCall, 0, (DWORD)(nArgSize + nDataSize) };
+	const size_t nOffset = m_Current.size();
+	m_Current.resize(nOffset + sizeof(record) + nArgSize + nDataSize);
+	BYTE* p = &m_Current[nOffset];
+	memcpy(p, &record, sizeof(record));
+	if (nArgSize)
+		memcpy(p + sizeof(record), pArgs, nArgSize);
+	if (nDataSize)
+		memcpy(p + sizeof(record) + nArgSize, pData, nDataSize);
+
+	++m_nNumRecords;
+	m_nRawSize += sizeof(record) + nArgSize + nDataSize;
+	if (m_Current.size() >= SW_CAPTURE_CHUNKSIZE)
+		Submit();
+}
+
+CSwCaptureWriter::RESOURCE* CSwCaptureWriter::FindResource(const void* pResource, const DWORD* pDesc,
+	bool* pbCreated)
+{
+	RESOURCE& res = m_Resources[pResource];
+	*pbCreated = (res.dwId == 0 || memcmp(res.dwDesc, pDesc, sizeof(res.dwDesc)) != 0);
+	if (*pbCreated)
+	{
+		// 처음 보는 자원이거나, 먼저 기록한 자원이 해제되고 같은 주소에 다른 자원이 만들어졌다.
+		res.dwId = m_dwNextId++;
+		res.nContentId = 0;
+		memcpy(res.dwDesc, pDesc, sizeof(res.dwDesc));
+	}
+	return &res;
+}
+
+DWORD CSwCaptureWriter::GetResourceId(CSwVertexBuffer* pVB)
+{
+	if (pVB == NULL)
+		return 0;
+
+	const DWORD desc[5] = { SW_CAP_CREATEVERTEXBUFFER, pVB->GetLength(), pVB->GetFVF(), 0, 0 };
+	bool bCreated;
+	RESOURCE* pRes = FindResource(pVB, desc, &bCreated);
+	if (bCreated)
+	{
+		SW_CAPARGS_CREATEVB args = { pRes->dwId, pVB->GetLength(), pVB->GetFVF() };
+		Record(SW_CAP_CREATEVERTEXBUFFER, args);
+	}
+	return pRes->dwId;
+}
+
+DWORD CSwCaptureWriter::GetResourceId(CSwIndexBuffer* pIB)
+{
+	if (pIB == NULL)
+		return 0;
+
+	const DWORD desc[5] = { SW_CAP_CREATEINDEXBUFFER, pIB->GetLength(), (DWORD)pIB->GetFormat(), 0, 0 };
+	bool bCreated;
+	RESOURCE* pRes = FindResource(pIB, desc, &bCreated);
+	if (bCreated)
+	{
+		SW_CAPARGS_CREATEIB args = { pRes->dwId, pIB->GetLength(), (DWORD)pIB->GetFormat() };
+		Record(SW_CAP_CREATEINDEXBUFFER, args);
+	}
+	return pRes->dwId;
+}
+
+DWORD CSwCaptureWriter::GetResourceId(CSwTexture* pTexture)
+{
+	if (pTexture == NULL)
+		return 0;
+
+	const DWORD desc[5] = { SW_CAP_CREATETEXTURE, pTexture->GetWidth(), pTexture->GetHeight(),
+		pTexture->GetLevelCount(), (DWORD)pTexture->GetFormat() };
+	bool bCreated;
+	RESOURCE* pRes = FindResource(pTexture, desc, &bCreated);
+	if (bCreated)
+	{
+		SW_CAPARGS_CREATETEXTURE args = { pRes->dwId, pTexture->GetWidth(), pTexture->GetHeight(),
+			pTexture->GetLevelCount(), (DWORD)pTexture->GetFormat() };
+		Record(SW_CAP_CREATETEXTURE, args);
+	}
+	return pRes->dwId;
+}
+
+VOID CSwCaptureWriter::SyncContent(const void* pResource, DWORD dwId, UINT64 nContentId, const void* pData,
+	size_t nSize)
+{
+	RESOURCE& res = m_Resources[pResource];
+	if (res.nContentId == nContentId)
+		return;
+
+	res.nContentId = nContentId;
+	Record(SW_CAP_UPDATERESOURCE, &dwId, sizeof(dwId), pData, nSize);
+}
+
+VOID CSwCaptureWriter::SyncResource(CSwVertexBuffer* pVB)
+{
+	if (pVB)
+		SyncContent(pVB, GetResourceId(pVB), pVB->GetContentId(), pVB->GetData(), pVB->GetLength());
+}
+
+VOID CSwCaptureWriter::SyncResource(CSwIndexBuffer* pIB)
+{
+	if (pIB)
+		SyncContent(pIB, GetResourceId(pIB), pIB->GetContentId(), pIB->GetData(), pIB->GetLength());
+}
+
+VOID CSwCaptureWriter::SyncResource(CSwTexture* pTexture)
+{
+	if (pTexture)
+	{
+		SyncContent(pTexture, GetResourceId(pTexture), pTexture->GetContentId(), pTexture->GetBits(0),
+			pTexture->GetSizeInBytes());
+	}
+}
+
+VOID CSwCaptureWriter::Submit()
+{
+	if (m_Current.empty())
+		return;
+
+	std::vector<BYTE> chunk;
+	chunk.reserve(SW_CAPTURE_CHUNKSIZE + 4096);
+	chunk.swap(m_Current);
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Cond.wait(lock, [this] { return m_Pending.size() < SW_CAPTURE_MAXPENDING; });
+		m_Pending.push_back(std::move(chunk));
+	}
+	m_Cond.notify_all();
+}
+
+VOID CSwCaptureWriter::WriterMain()
+{
+	std::vector<BYTE> compressed;
+	for (;;)
+	{
+		std::vector<BYTE> chunk;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_Cond.wait(lock, [this] { return !m_Pending.empty() || m_bQuit; });
+			if (m_Pending.empty())
+				return;
+			chunk = std::move(m_Pending.front());
+			m_Pending.pop_front();
+		}
+		m_Cond.notify_all();
+
+		compressed.clear();
+		SwLzCompress(chunk.data(), chunk.size(), &compressed);
+		SW_CAPCHUNKHEADER header = { (DWORD)chunk.size(), (DWORD)compressed.size() };
+		if (fwrite(&header, sizeof(header), 1, m_pFile) != 1 ||
+			fwrite(compressed.data(), 1, compressed.size(), m_pFile) != compressed.size())
+		{
+			m_bFailed = true;
+		}
+		m_nCompressedSize.fetch_add(sizeof(header) + compressed.size(), std::memory_order_relaxed);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// CSwCaptureReader
+//-----------------------------------------------------------------------------
+CSwCaptureReader::CSwCaptureReader()
+	: m_nFileOffset(0)
+	, m_nChunkOffset(0)
+{
+}
+
+HRESULT CSwCaptureReader::Open(const char* pFilename)
+{
+	HRESULT hr = m_File.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+
+	SW_CAPFILEHEADER header;
+	if (m_File.GetSize() < sizeof(header))
+		return E_FAIL;
+	memcpy(&header, m_File.GetData(), sizeof(header));
+	if (header.dwMagic != SW_CAPTURE_MAGIC || header.dwVersion != SW_CAPTURE_VERSION)
+		return E_FAIL;
+
+	m_nFileOffset = sizeof(header);
+	m_Chunk.clear();
+	m_nChunkOffset = 0;
+	return S_OK;
+}
+
+HRESULT CSwCaptureReader::Next(SW_CAPRECORD* pRecord, const BYTE** ppArgs)
+{
+	if (m_nChunkOffset >= m_Chunk.size())
+	{
+		// 다음 청크를 푼다.
+		const BYTE* pData = m_File.GetData();
+		const size_t nFileSize = m_File.GetSize();
+		if (m_nFileOffset == nFileSize)
+			return S_FALSE;
+
+		SW_CAPCHUNKHEADER header;
+		if (nFileSize - m_nFileOffset < sizeof(header))
+			return E_FAIL;
+		memcpy(&header, pData + m_nFileOffset, sizeof(header));
+		m_nFileOffset += sizeof(header);
+		if (nFileSize - m_nFileOffset < header.dwCompressedSize)
+			return E_FAIL;
+
+		m_Chunk.resize(header.dwRawSize);
+		if (FAILED(SwLzDecompress(pData + m_nFileOffset, header.dwCompressedSize, m_Chunk.data(), m_Chunk.size())))
+			return E_FAIL;
+		m_nFileOffset += header.dwCompressedSize;
+		m_nChunkOffset = 0;
+	}
+
+	if (m_Chunk.size() - m_nChunkOffset < sizeof(SW_CAPRECORD))
+		return E_FAIL;
+	memcpy(pRecord, &m_Chunk[m_nChunkOffset], sizeof(SW_CAPRECORD));
+	m_nChunkOffset += sizeof(SW_CAPRECORD);
+	if (m_Chunk.size() - m_nChunkOffset < pRecord->dwSize)
+		return E_FAIL;
+
+	*ppArgs = m_Chunk.data() + m_nChunkOffset;
+	m_nChunkOffset += pRecord->dwSize;
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// CSwCapturePlayer
+//-----------------------------------------------------------------------------
+CSwCapturePlayer::CSwCapturePlayer(UINT nNumThreads)
+	: m_nNumThreads(nNumThreads)
+	, m_pDevice(NULL)
+{
+}
+
+CSwCapturePlayer::~CSwCapturePlayer()
+{
+	for (CSwResource* pResource : m_Resources)
+	{
+		if (pResource)
+			pResource->Release();
+	}
+	if (m_pDevice)
+		m_pDevice->Release();
+}
+
+// 인자는 정렬되지 않은 위치에 있으므로 복사해서 읽는다. 크기가 모자라면 false.
+template<typename ARGS>
+bool CSwCapturePlayer::ReadArgs(const SW_CAPRECORD& record, const BYTE* pArgs, ARGS* pOut) const
+{
+	if (record.dwSize < sizeof(ARGS))
+		return false;
+	memcpy(pOut, pArgs, sizeof(ARGS));
+	return true;
+}
+
+CSwResource* CSwCapturePlayer::GetResource(DWORD dwId) const
+{
+	return (dwId != 0 && dwId <= m_Resources.size()) ? m_Resources[dwId - 1] : NULL;
+}
+
+HRESULT CSwCapturePlayer::Execute(const SW_CAPRECORD& record, const BYTE* pArgs)
+{
+	if (record.wCall == SW_CAP_DEVICE)
+	{
+		SW_CAPARGS_DEVICE args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+
+		SW_PRESENT_PARAMETERS pp;
+		ZeroMemory(&pp, sizeof(pp));
+		pp.BackBufferWidth = args.nWidth;
+		pp.BackBufferHeight = args.nHeight;
+		pp.EnableAutoDepthStencil = args.bDepth;
+		pp.AutoDepthStencilFormat = D3DFMT_D16;
+		pp.NumThreads = m_nNumThreads;
+		if (m_pDevice)
+			m_pDevice->Release();
+		m_pDevice = NULL;
+		return SwCreateDevice(&pp, &m_pDevice);
+	}
+	if (m_pDevice == NULL)
+		return E_FAIL;
+
+	// 자원 번호는 1부터 차례로 붙으므로 만들 때마다 배열 끝에 들어간다.
+	// 같은 번호가 다시 오는 일은 없지만 잘못된 파일에 대비해 자리를 맞춘다.
+	auto SetResource = [this](DWORD dwId, CSwResource* pResource, BYTE nKind)
+	{
+		if (dwId == 0)
+		{
+			pResource->Release();
+			return;
+		}
+		if (m_Resources.size() < dwId)
+		{
+			m_Resources.resize(dwId, NULL);
+			m_ResourceKinds.resize(dwId, 0);
+		}
+		if (m_Resources[dwId - 1])
+			m_Resources[dwId - 1]->Release();
+		m_Resources[dwId - 1] = pResource;
+		m_ResourceKinds[dwId - 1] = nKind;
+	};
+	auto FindResource = [this](DWORD dwId, BYTE nKind) -> CSwResource*
+	{
+		CSwResource* pResource = GetResource(dwId);
+		return (pResource && m_ResourceKinds[dwId - 1] == nKind) ? pResource : NULL;
+	};
+
+	switch (record.wCall)
+	{
+	case SW_CAP_CREATEVERTEXBUFFER:
+	{
+		SW_CAPARGS_CREATEVB args;
+		CSwVertexBuffer* pVB;
+		if (!ReadArgs(record, pArgs, &args) ||
+			FAILED(m_pDevice->CreateVertexBuffer(args.nLength, 0, args.dwFVF, D3DPOOL_MANAGED, &pVB, NULL)))
+		{
+			return E_FAIL;
+		}
+		SetResource(args.dwId, pVB, SW_CAP_CREATEVERTEXBUFFER);
+		return S_OK;
+	}
+	case SW_CAP_CREATEINDEXBUFFER:
+	{
+		SW_CAPARGS_CREATEIB args;
+		CSwIndexBuffer* pIB;
+		if (!ReadArgs(record, pArgs, &args) ||
+			FAILED(m_pDevice->CreateIndexBuffer(args.nLength, 0, (D3DFORMAT)args.dwFormat, D3DPOOL_MANAGED,
+				&pIB, NULL)))
+		{
+			return E_FAIL;
+		}
+		SetResource(args.dwId, pIB, SW_CAP_CREATEINDEXBUFFER);
+		return S_OK;
+	}
+	case SW_CAP_CREATETEXTURE:
+	{
+		SW_CAPARGS_CREATETEXTURE args;
+		CSwTexture* pTexture;
+		if (!ReadArgs(record, pArgs, &args) ||
+			FAILED(m_pDevice->CreateTexture(args.nWidth, args.nHeight, args.nLevels, 0, (D3DFORMAT)args.dwFormat,
+				D3DPOOL_MANAGED, &pTexture, NULL)))
+		{
+			return E_FAIL;
+		}
+		SetResource(args.dwId, pTexture, SW_CAP_CREATETEXTURE);
+		return S_OK;
+	}
+	case SW_CAP_UPDATERESOURCE:
+	{
+		DWORD dwId;
+		if (!ReadArgs(record, pArgs, &dwId) || GetResource(dwId) == NULL)
+			return E_FAIL;
+		const BYTE* pData = pArgs + sizeof(dwId);
+		const size_t nSize = record.dwSize - sizeof(dwId);
+
+		// 전체 내용을 잠그고 복사한다. Unlock()이 SoA 사본과 내용 식별 값을 갱신한다.
+		void* pDst;
+		switch (m_ResourceKinds[dwId - 1])
+		{
+		case SW_CAP_CREATEVERTEXBUFFER:
+		{
+			CSwVertexBuffer* pVB = (CSwVertexBuffer*)GetResource(dwId);
+			if (nSize != pVB->GetLength() || FAILED(pVB->Lock(0, 0, &pDst, 0)))
+				return E_FAIL;
+			memcpy(pDst, pData, nSize);
+			return pVB->Unlock();
+		}
+		case SW_CAP_CREATEINDEXBUFFER:
+		{
+			CSwIndexBuffer* pIB = (CSwIndexBuffer*)GetResource(dwId);
+			if (nSize != pIB->GetLength() || FAILED(pIB->Lock(0, 0, &pDst, 0)))
+				return E_FAIL;
+			memcpy(pDst, pData, nSize);
+			return pIB->Unlock();
+		}
+		case SW_CAP_CREATETEXTURE:
+		{
+			CSwTexture* pTexture = (CSwTexture*)GetResource(dwId);
+			D3DLOCKED_RECT lr;
+			if (nSize != pTexture->GetSizeInBytes() || FAILED(pTexture->LockRect(0, &lr, NULL, 0)))
+				return E_FAIL;
+			memcpy(lr.pBits, pData, nSize);		// 모든 레벨이 0번 레벨 뒤에 이어져 있다
+			return pTexture->UnlockRect(0);
+		}
+		}
+		return E_FAIL;
+	}
+	case SW_CAP_CLEAR:
+	{
+		SW_CAPARGS_CLEAR args;
+		if (!ReadArgs(record, pArgs, &args) || record.dwSize != sizeof(args) + args.dwCount * sizeof(D3DRECT))
+			return E_FAIL;
+		std::vector<D3DRECT> rects(args.dwCount);
+		if (args.dwCount)
+			memcpy(rects.data(), pArgs + sizeof(args), args.dwCount * sizeof(D3DRECT));
+		return m_pDevice->Clear(args.dwCount, args.dwCount ? rects.data() : NULL, args.dwFlags, args.Color,
+			args.fZ, args.dwStencil);
+	}
+	case SW_CAP_BEGINSCENE:
+		return m_pDevice->BeginScene();
+	case SW_CAP_ENDSCENE:
+		return m_pDevice->EndScene();
+	case SW_CAP_PRESENT:
+		return m_pDevice->Present(NULL, NULL, NULL, NULL);
+	case SW_CAP_SETTRANSFORM:
+	{
+		SW_CMDARGS_TRANSFORM args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->SetTransform((D3DTRANSFORMSTATETYPE)args.dwState, &args.Matrix);
+	}
+	case SW_CAP_SETRENDERSTATE:
+	{
+		SW_CMDARGS_STATE args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->SetRenderState((D3DRENDERSTATETYPE)args.dwType, args.dwValue);
+	}
+	case SW_CAP_SETTEXTURESTAGESTATE:
+	{
+		SW_CMDARGS_STATE args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->SetTextureStageState(args.dwStage, (D3DTEXTURESTAGESTATETYPE)args.dwType, args.dwValue);
+	}
+	case SW_CAP_SETSAMPLERSTATE:
+	{
+		SW_CMDARGS_STATE args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->SetSamplerState(args.dwStage, (D3DSAMPLERSTATETYPE)args.dwType, args.dwValue);
+	}
+	case SW_CAP_SETTEXTURE:
+	{
+		SW_CAPARGS_BIND args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		CSwResource* pTexture = FindResource(args.dwId, SW_CAP_CREATETEXTURE);
+		if (args.dwId != 0 && pTexture == NULL)
+			return E_FAIL;
+		return m_pDevice->SetTexture(args.dwStage, (CSwTexture*)pTexture);
+	}
+	case SW_CAP_SETMATERIAL:
+	{
+		D3DMATERIAL9 material;
+		if (!ReadArgs(record, pArgs, &material))
+			return E_FAIL;
+		return m_pDevice->SetMaterial(&material);
+	}
+	case SW_CAP_SETLIGHT:
+	{
+		SW_CMDARGS_LIGHT args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->SetLight(args.dwIndex, &args.Light);
+	}
+	case SW_CAP_LIGHTENABLE:
+	{
+		SW_CMDARGS_LIGHTENABLE args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->LightEnable(args.dwIndex, args.bEnable);
+	}
+	case SW_CAP_SETSTREAMSOURCE:
+	{
+		SW_CAPARGS_STREAMSOURCE args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		CSwResource* pVB = FindResource(args.dwId, SW_CAP_CREATEVERTEXBUFFER);
+		if (args.dwId != 0 && pVB == NULL)
+			return E_FAIL;
+		return m_pDevice->SetStreamSource(0, (CSwVertexBuffer*)pVB, args.nOffset, args.nStride);
+	}
+	case SW_CAP_SETFVF:
+	{
+		DWORD dwFVF;
+		if (!ReadArgs(record, pArgs, &dwFVF))
+			return E_FAIL;
+		return m_pDevice->SetFVF(dwFVF);
+	}
+	case SW_CAP_SETVERTEXQUANT:
+	{
+		SW_CMDARGS_VERTEXQUANT args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->SetVertexQuant(args.bEnable ? &args.Quant : NULL);
+	}
+	case SW_CAP_SETINDICES:
+	{
+		SW_CAPARGS_BIND args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		CSwResource* pIB = FindResource(args.dwId, SW_CAP_CREATEINDEXBUFFER);
+		if (args.dwId != 0 && pIB == NULL)
+			return E_FAIL;
+		return m_pDevice->SetIndices((CSwIndexBuffer*)pIB);
+	}
+	case SW_CAP_DRAWPRIMITIVE:
+	{
+		SW_CMDARGS_DRAW args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->DrawPrimitive((D3DPRIMITIVETYPE)args.dwType, args.nStartVertex, args.nPrimitiveCount);
+	}
+	case SW_CAP_DRAWINDEXEDPRIMITIVE:
+	{
+		SW_CMDARGS_DRAWINDEXED args;
+		if (!ReadArgs(record, pArgs, &args))
+			return E_FAIL;
+		return m_pDevice->DrawIndexedPrimitive((D3DPRIMITIVETYPE)args.dwType, args.nBaseVertex, args.nMinVertex,
+			args.nNumVertices, args.nStartIndex, args.nPrimitiveCount);
+	}
+	}
+	return E_FAIL;
+}
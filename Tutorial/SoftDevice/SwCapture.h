@@ -0,0 +1,222 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwCapture.h
+//
+// 설명:	디바이스 호출 캡처와 재생.
+//		CSwDevice::SetCapture()로 CSwCaptureWriter를 붙이면 그 뒤의 디바이스 호출이 모두 기록된다.
+//		자원은 처음 쓰일 때 번호를 받아 생성 기록이 남고, 그리기 직전에 묶여 있는 자원의 내용이
+//		앞서 기록한 뒤로 바뀌었으면(GetContentId()) 전체 내용을 다시 기록한다. 그래서 Lock()으로 채운
+//		정점, 인덱스, 텍셀과 디바이스 밖에서 만든 텍스처도 재생할 수 있다.
+//		기록은 호출한 스레드에서 메모리에 쌓고, 일정 크기가 되면 뒤쪽 쓰기 스레드가 압축(SwLz.h)하여
+//		파일에 쓰므로 렌더링 스레드는 디스크를 기다리지 않는다.
+//
+//		파일 형식(리틀 엔디언):
+//			SW_CAPFILEHEADER
+//			{ SW_CAPCHUNKHEADER, 압축된 바이트 } 반복
+//		청크의 압축을 풀면 { SW_CAPRECORD, 인자 } 의 나열이다. 기록은 청크 사이에 걸치지 않는다.
+//
+//		사용 예:
+//			CSwCaptureWriter capture;
+//			capture.Open("frame.swcap");
+//			pDevice->SetCapture(&capture);
+//			... InitGeometry(), Render() ...
+//			pDevice->SetCapture(NULL);
+//			capture.Close();
+//
+//			CSwCaptureReader reader;			// 재생
+//			reader.Open("frame.swcap");
+//			CSwCapturePlayer player;
+//			SW_CAPRECORD record;
+//			const BYTE* pArgs;
+//			while (reader.Next(&record, &pArgs) == S_OK)
+//				player.Execute(record, pArgs);
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwDevice.h"
+#include "SwFile.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#define SW_CAPTURE_MAGIC		0x50414353		// 'SCAP'
+#define SW_CAPTURE_VERSION		1
+
+enum SW_CAPCALL
+{
+	SW_CAP_DEVICE = 0,				// SW_CAPARGS_DEVICE. 재생할 디바이스를 만든다.
+	SW_CAP_CREATEVERTEXBUFFER,		// SW_CAPARGS_CREATEVB
+	SW_CAP_CREATEINDEXBUFFER,		// SW_CAPARGS_CREATEIB
+	SW_CAP_CREATETEXTURE,			// SW_CAPARGS_CREATETEXTURE
+	SW_CAP_UPDATERESOURCE,			// DWORD 자원 번호 + 전체 내용
+	SW_CAP_CLEAR,					// SW_CAPARGS_CLEAR + D3DRECT * Count
+	SW_CAP_BEGINSCENE,
+	SW_CAP_ENDSCENE,
+	SW_CAP_PRESENT,
+	SW_CAP_SETTRANSFORM,			// SW_CMDARGS_TRANSFORM
+	SW_CAP_SETRENDERSTATE,			// SW_CMDARGS_STATE
+	SW_CAP_SETTEXTURESTAGESTATE,	// SW_CMDARGS_STATE
+	SW_CAP_SETSAMPLERSTATE,			// SW_CMDARGS_STATE
+	SW_CAP_SETTEXTURE,				// SW_CAPARGS_BIND
+	SW_CAP_SETMATERIAL,				// D3DMATERIAL9
+	SW_CAP_SETLIGHT,				// SW_CMDARGS_LIGHT
+	SW_CAP_LIGHTENABLE,				// SW_CMDARGS_LIGHTENABLE
+	SW_CAP_SETSTREAMSOURCE,			// SW_CAPARGS_STREAMSOURCE
+	SW_CAP_SETFVF,					// DWORD
+	SW_CAP_SETVERTEXQUANT,			// SW_CMDARGS_VERTEXQUANT
+	SW_CAP_SETINDICES,				// SW_CAPARGS_BIND
+	SW_CAP_DRAWPRIMITIVE,			// SW_CMDARGS_DRAW
+	SW_CAP_DRAWINDEXEDPRIMITIVE,	// SW_CMDARGS_DRAWINDEXED
+	SW_CAP_NUMCALLS
+};
+
+struct SW_CAPFILEHEADER
+{
+	DWORD	dwMagic;
+	DWORD	dwVersion;
+};
+
+struct SW_CAPCHUNKHEADER
+{
+	DWORD	dwRawSize;			// 풀었을 때의 바이트 수
+	DWORD	dwCompressedSize;
+};
+
+struct SW_CAPRECORD
+{
+	WORD	wCall;				// SW_CAPCALL
+	WORD	wReserved;
+	DWORD	dwSize;				// 뒤따르는 인자의 바이트 수
+};
+
+// 자원은 포인터 대신 1부터 붙인 번호로 기록한다. 0은 NULL이다.
+struct SW_CAPARGS_DEVICE			{ UINT nWidth; UINT nHeight; BOOL bDepth; };
+struct SW_CAPARGS_CREATEVB			{ DWORD dwId; UINT nLength; DWORD dwFVF; };
+struct SW_CAPARGS_CREATEIB			{ DWORD dwId; UINT nLength; DWORD dwFormat; };
+struct SW_CAPARGS_CREATETEXTURE		{ DWORD dwId; UINT nWidth; UINT nHeight; UINT nLevels; DWORD dwFormat; };
+struct SW_CAPARGS_CLEAR				{ DWORD dwCount; DWORD dwFlags; D3DCOLOR Color; float fZ; DWORD dwStencil; };
+struct SW_CAPARGS_BIND				{ DWORD dwStage; DWORD dwId; };
+struct SW_CAPARGS_STREAMSOURCE		{ DWORD dwId; UINT nOffset; UINT nStride; };
+
+const char*	SwGetCaptureCallName(SW_CAPCALL eCall);
+
+//-----------------------------------------------------------------------------
+// 캡처 기록기
+// Record*()는 디바이스를 부르는 스레드 하나에서만 부른다.
+//-----------------------------------------------------------------------------
+class CSwCaptureWriter
+{
+public:
+	CSwCaptureWriter();
+	~CSwCaptureWriter();
+
+	CSwCaptureWriter(const CSwCaptureWriter&) = delete;
+	CSwCaptureWriter& operator=(const CSwCaptureWriter&) = delete;
+
+	HRESULT	Open(const char* pFilename);
+	// 남은 기록을 모두 쓰고 파일을 닫는다. 쓰기에 실패한 적이 있으면 E_FAIL.
+	HRESULT	Close();
+
+	VOID	Record(SW_CAPCALL eCall, const void* pArgs, UINT nArgSize, const void* pData = NULL, size_t nDataSize = 0);
+	template<typename ARGS>
+	VOID	Record(SW_CAPCALL eCall, const ARGS& args) { Record(eCall, &args, sizeof(ARGS)); }
+
+	// 자원의 번호. 처음 보는 자원이면 생성 기록을 남긴다. NULL이면 0.
+	DWORD	GetResourceId(CSwVertexBuffer* pVB);
+	DWORD	GetResourceId(CSwIndexBuffer* pIB);
+	DWORD	GetResourceId(CSwTexture* pTexture);
+
+	// 앞서 기록한 뒤로 내용이 바뀌었으면 전체 내용을 기록한다.
+	VOID	SyncResource(CSwVertexBuffer* pVB);
+	VOID	SyncResource(CSwIndexBuffer* pIB);
+	VOID	SyncResource(CSwTexture* pTexture);
+
+	UINT64	GetNumRecords() const { return m_nNumRecords; }
+	UINT64	GetRawSize() const { return m_nRawSize; }
+	// 쓰기 스레드가 파일에 쓴 크기. 기록 중에는 아직 쓰지 않은 조각이 빠지며 Close() 뒤에만 정확하다.
+	UINT64	GetCompressedSize() const { return m_nCompressedSize.load(std::memory_order_relaxed); }
+
+private:
+	struct RESOURCE
+	{
+		DWORD	dwId;
+		UINT64	nContentId;		// 마지막으로 기록한 내용. 0이면 아직 기록하지 않았다.
+		DWORD	dwDesc[5];		// 같은 주소에 새로 만든 자원을 구별하기 위한 생성 인자
+	};
+
+	RESOURCE*	FindResource(const void* pResource, const DWORD* pDesc, bool* pbCreated);
+	VOID		SyncContent(const void* pResource, DWORD dwId, UINT64 nContentId, const void* pData, size_t nSize);
+	VOID		Submit();
+	VOID		WriterMain();
+
+	FILE*						m_pFile;
+	std::vector<BYTE>			m_Current;		// 아직 넘기지 않은 기록
+	std::unordered_map<const void*, RESOURCE>	m_Resources;
+	DWORD						m_dwNextId;
+	UINT64						m_nNumRecords;
+	UINT64						m_nRawSize;
+	std::atomic<UINT64>			m_nCompressedSize;	// 쓰기 스레드가 늘린다
+
+	// 쓰기 스레드
+	std::thread						m_Thread;
+	std::mutex						m_Mutex;
+	std::condition_variable			m_Cond;
+	std::deque<std::vector<BYTE> >	m_Pending;
+	bool							m_bQuit;
+	bool							m_bFailed;
+};
+
+//-----------------------------------------------------------------------------
+// 캡처 파일 읽기
+//-----------------------------------------------------------------------------
+class CSwCaptureReader
+{
+public:
+	CSwCaptureReader();
+
+	HRESULT	Open(const char* pFilename);
+	// 다음 기록. 인자는 다음 Next() 호출까지 유효하다. 끝이면 S_FALSE, 파일이 잘못되었으면 E_FAIL.
+	HRESULT	Next(SW_CAPRECORD* pRecord, const BYTE** ppArgs);
+
+	size_t	GetFileSize() const { return m_File.GetSize(); }
+
+private:
+	CSwMappedFile		m_File;
+	size_t				m_nFileOffset;
+	std::vector<BYTE>	m_Chunk;
+	size_t				m_nChunkOffset;
+};
+
+//-----------------------------------------------------------------------------
+// 재생기
+// 기록 하나를 소프트웨어 디바이스에서 실행한다. 디바이스는 SW_CAP_DEVICE 기록이 만든다.
+//-----------------------------------------------------------------------------
+class CSwCapturePlayer
+{
+public:
+	// nNumThreads는 재생 디바이스의 스레드 수(0이면 하드웨어 스레드 수)
+	explicit CSwCapturePlayer(UINT nNumThreads = 0);
+	~CSwCapturePlayer();
+
+	CSwCapturePlayer(const CSwCapturePlayer&) = delete;
+	CSwCapturePlayer& operator=(const CSwCapturePlayer&) = delete;
+
+	HRESULT		Execute(const SW_CAPRECORD& record, const BYTE* pArgs);
+
+	CSwDevice*	GetDevice() const { return m_pDevice; }
+
+private:
+	template<typename ARGS>
+	bool		ReadArgs(const SW_CAPRECORD& record, const BYTE* pArgs, ARGS* pOut) const;
+	CSwResource*	GetResource(DWORD dwId) const;
+
+	UINT						m_nNumThreads;
+	CSwDevice*					m_pDevice;
+	std::vector<CSwResource*>	m_Resources;	// 번호 - 1로 찾는다
+	std::vector<BYTE>			m_ResourceKinds;	// SW_CAP_CREATE*
+};
@@ -0,0 +1,208 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwClock.cpp
+//
+// 설명:	애니메이션 시계 구현.
+//-----------------------------------------------------------------------------
+#include "SwClock.h"
+#include "SwFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static UINT64 GetRealTimeUs()
+{
+	using namespace std::chrono;
+	return (UINT64)duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+CSwClock::CSwClock()
+	: m_eMode(SW_CLOCK_REALTIME)
+	, m_fStepMs(SW_CLOCK_DEFAULTSTEP)
+	, m_nStartUs(0)
+	, m_nTimeUs(0)
+	, m_nFrame(0)
+	, m_bRecording(false)
+{
+}
+
+VOID CSwClock::SetRealTime()
+{
+	m_eMode = SW_CLOCK_REALTIME;
+	m_Timeline.clear();
+	Reset();
+}
+
+VOID CSwClock::SetFixedStep(double fStepMs)
+{
+	m_eMode = SW_CLOCK_FIXED;
+	m_fStepMs = (fStepMs > 0.0) ? fStepMs : SW_CLOCK_DEFAULTSTEP;
+	m_Timeline.clear();
+	Reset();
+}
+
+HRESULT CSwClock::SetReplay(const char* pFilename)
+{
+	std::vector<UINT64> timeline;
+	HRESULT hr = LoadTimeline(pFilename, &timeline);
+	if (FAILED(hr))
+		return hr;
+	return SetReplay(timeline);
+}
+
+HRESULT CSwClock::SetReplay(const std::vector<UINT64>& timeline)
+{
+	if (timeline.empty())
+		return D3DERR_INVALIDCALL;
+
+	m_eMode = SW_CLOCK_REPLAY;
+	m_Timeline = timeline;
+	Reset();
+	return S_OK;
+}
+
+VOID CSwClock::Reset()
+{
+	m_nStartUs = 0;
+	m_nTimeUs = 0;
+	m_nFrame = 0;
+	m_Recorded.clear();
+}
+
+VOID CSwClock::Tick()
+{
+	const UINT nFrame = m_nFrame++;
+	switch (m_eMode)
+	{
+	case SW_CLOCK_REALTIME:
+		if (nFrame == 0)
+			m_nStartUs = GetRealTimeUs();
+		m_nTimeUs = GetRealTimeUs() - m_nStartUs;
+		break;
+
+	case SW_CLOCK_FIXED:
+		// 간격을 더해 가지 않고 프레임 번호에서 바로 구하므로 오차가 쌓이지 않는다.
+		m_nTimeUs = (UINT64)std::llround(nFrame * m_fStepMs * 1000.0);
+		break;
+
+	case SW_CLOCK_REPLAY:
+		m_nTimeUs = m_Timeline[std::min<size_t>(nFrame, m_Timeline.size() - 1)];
+		break;
+	}
+
+	if (m_bRecording)
+		m_Recorded.push_back(m_nTimeUs);
+}
+
+BOOL CSwClock::IsTimelineEnd() const
+{
+	return m_eMode == SW_CLOCK_REPLAY && m_nFrame > m_Timeline.size();
+}
+
+VOID CSwClock::StartRecording(const char* pFilename)
+{
+	m_bRecording = true;
+	m_strRecordFile = pFilename ? pFilename : "";
+	m_Recorded.clear();
+}
+
+HRESULT CSwClock::StopRecording()
+{
+	if (!m_bRecording)
+		return S_FALSE;
+
+	m_bRecording = false;
+	if (m_strRecordFile.empty())
+		return S_OK;
+	return SaveTimeline(m_strRecordFile.c_str(), m_Recorded);
+}
+
+HRESULT CSwClock::LoadTimeline(const char* pFilename, std::vector<UINT64>* pTimeline)
+{
+	if (pFilename == NULL || pTimeline == NULL)
+		return D3DERR_INVALIDCALL;
+
+	CSwMappedFile file;
+	HRESULT hr = file.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+
+	SW_CLOCKFILEHEADER header;
+	if (file.GetSize() < sizeof(header))
+		return E_FAIL;
+	memcpy(&header, file.GetData(), sizeof(header));
+	if (header.dwMagic != SW_CLOCK_MAGIC || header.dwVersion != SW_CLOCK_VERSION ||
+		file.GetSize() != sizeof(header) + (size_t)header.dwNumFrames * sizeof(UINT64))
+		return E_FAIL;
+
+	pTimeline->resize(header.dwNumFrames);
+	if (header.dwNumFrames > 0)
+		memcpy(pTimeline->data(), file.GetData() + sizeof(header), header.dwNumFrames * sizeof(UINT64));
+	return S_OK;
+}
+
+HRESULT CSwClock::SaveTimeline(const char* pFilename, const std::vector<UINT64>& timeline)
+{
+	if (pFilename == NULL)
+		return D3DERR_INVALIDCALL;
+
+	FILE* pFile = fopen(pFilename, "wb");
+	if (pFile == NULL)
+		return E_FAIL;
+
+	SW_CLOCKFILEHEADER header = { SW_CLOCK_MAGIC, SW_CLOCK_VERSION, (DWORD)timeline.size() };
+	bool bFailed = fwrite(&header, sizeof(header), 1, pFile) != 1 ||
+		fwrite(timeline.data(), sizeof(UINT64), timeline.size(), pFile) != timeline.size();
+	if (fclose(pFile) != 0 || bFailed)
+		return E_FAIL;
+	return S_OK;
+}
+
+// pCmdLine에서 pOption으로 시작하는 인자를 찾아 그 뒤의 값(공백 전까지)을 돌려준다.
+// 값이 없으면 빈 문자열, 인자가 없으면 false.
+static bool FindOption(const char* pCmdLine, const char* pOption, std::string* pValue)
+{
+	const size_t nLength = strlen(pOption);
+	for (const char* p = strstr(pCmdLine, pOption); p; p = strstr(p + 1, pOption))
+	{
+		// 다른 인자의 일부가 아니어야 한다.
+		if (p != pCmdLine && p[-1] != ' ' && p[-1] != '\t')
+			continue;
+		const char* pEnd = p + nLength;
+		if (*pEnd != '\0' && *pEnd != ' ' && *pEnd != '\t' && *pEnd != ':')
+			continue;
+
+		pValue->clear();
+		if (*pEnd == ':')
+		{
+			for (++pEnd; *pEnd != '\0' && *pEnd != ' ' && *pEnd != '\t'; ++pEnd)
+				pValue->push_back(*pEnd);
+		}
+		return true;
+	}
+	return false;
+}
+
+HRESULT SwConfigureClock(CSwClock* pClock, const char* pCmdLine)
+{
+	if (pClock == NULL)
+		return D3DERR_INVALIDCALL;
+
+	pClock->SetRealTime();
+	if (pCmdLine == NULL)
+		return S_OK;
+
+	HRESULT hr = S_OK;
+	std::string strValue;
+	if (FindOption(pCmdLine, "-replay", &strValue))
+		hr = pClock->SetReplay(strValue.c_str());
+	else if (FindOption(pCmdLine, "-fixed", &strValue))
+		pClock->SetFixedStep(strValue.empty() ? SW_CLOCK_DEFAULTSTEP : atof(strValue.c_str()));
+
+	if (FindOption(pCmdLine, "-record", &strValue) && !strValue.empty())
+		pClock->StartRecording(strValue.c_str());
+	return hr;
+}
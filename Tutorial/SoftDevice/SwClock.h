@@ -0,0 +1,106 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwClock.h
+//
+// 설명:	애니메이션 시계.
+//		예제들이 timeGetTime()으로 바로 읽던 시각을 프레임마다 한 번 정해 두고 모든 애니메이션이
+//		같은 값을 읽게 한다. 시각은 세 가지 방식으로 정한다.
+//			SW_CLOCK_REALTIME	처음 Tick()한 때부터 흐른 실제 시간
+//			SW_CLOCK_FIXED		프레임 번호 * 고정 간격. 어느 컴퓨터에서나 같은 N 프레임이 그려진다.
+//			SW_CLOCK_REPLAY		기록해 둔 시각표(프레임마다의 시각)를 차례로 읽는다
+//		어느 방식이든 StartRecording()으로 각 프레임의 시각을 시각표 파일로 남길 수 있으므로
+//		실제 시간으로 돌린 실행을 그대로 다시 그릴 수 있다.
+//
+//		시각표 파일 형식(리틀 엔디언): SW_CLOCKFILEHEADER, UINT64 시각(us) * dwNumFrames
+//
+//		사용 예:
+//			CSwClock clock;
+//			SwConfigureClock(&clock, lpCmdLine);	// -fixed, -replay:<파일>, -record:<파일>
+//			...
+//			clock.Tick();							// 프레임 시작
+//			D3DXMatrixRotationY(&matWorld, clock.GetTimeMs() / 1000.0f);
+//			...
+//			clock.StopRecording();					// 끝낼 때
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <string>
+#include <vector>
+
+#define SW_CLOCK_MAGIC			0x4b4c4353		// 'SCLK'
+#define SW_CLOCK_VERSION		1
+#define SW_CLOCK_DEFAULTSTEP	(1000.0 / 60.0)	// -fixed의 프레임 간격(ms)
+
+enum SW_CLOCKMODE
+{
+	SW_CLOCK_REALTIME = 0,
+	SW_CLOCK_FIXED,
+	SW_CLOCK_REPLAY
+};
+
+struct SW_CLOCKFILEHEADER
+{
+	DWORD	dwMagic;
+	DWORD	dwVersion;
+	DWORD	dwNumFrames;
+};
+
+//-----------------------------------------------------------------------------
+// 애니메이션 시계
+// 방식을 바꾸면 프레임 번호와 시각이 처음으로 돌아간다. 첫 Tick() 전의 시각은 0이다.
+//-----------------------------------------------------------------------------
+class CSwClock
+{
+public:
+	CSwClock();
+
+	VOID		SetRealTime();
+	VOID		SetFixedStep(double fStepMs);
+	// 시각표 파일을 읽어 재생 방식으로 바꾼다. 실패하면 방식을 바꾸지 않는다.
+	HRESULT		SetReplay(const char* pFilename);
+	HRESULT		SetReplay(const std::vector<UINT64>& timeline);
+	// 프레임 번호와 시각을 처음으로 돌린다. 기록 중인 시각표도 비운다.
+	VOID		Reset();
+
+	// 다음 프레임으로 넘어가 그 프레임의 시각을 정한다. 프레임마다 한 번, 그리기 전에 부른다.
+	VOID		Tick();
+
+	SW_CLOCKMODE	GetMode() const { return m_eMode; }
+	// 지금 프레임의 시각. 같은 프레임 안에서는 몇 번 읽어도 같다.
+	UINT64		GetTimeUs() const { return m_nTimeUs; }
+	DWORD		GetTimeMs() const { return (DWORD)(m_nTimeUs / 1000); }
+	double		GetTimeSec() const { return m_nTimeUs / 1000000.0; }
+	// 지금까지 Tick()한 프레임 수
+	UINT		GetFrame() const { return m_nFrame; }
+	// 재생 방식에서 시각표의 마지막 프레임을 지났는지. 지난 뒤에는 마지막 시각에 머문다.
+	BOOL		IsTimelineEnd() const;
+
+	// 이후 Tick()의 시각을 모아 두었다가 StopRecording()에서 파일로 쓴다.
+	VOID		StartRecording(const char* pFilename);
+	// 기록 중이 아니면 아무것도 하지 않고 S_FALSE.
+	HRESULT		StopRecording();
+	const std::vector<UINT64>&	GetRecordedTimeline() const { return m_Recorded; }
+
+	static HRESULT	LoadTimeline(const char* pFilename, std::vector<UINT64>* pTimeline);
+	static HRESULT	SaveTimeline(const char* pFilename, const std::vector<UINT64>& timeline);
+
+private:
+	SW_CLOCKMODE			m_eMode;
+	double					m_fStepMs;
+	std::vector<UINT64>		m_Timeline;		// 재생할 시각표
+	UINT64					m_nStartUs;		// 실제 시간 방식에서 첫 Tick()의 시각
+	UINT64					m_nTimeUs;
+	UINT					m_nFrame;
+
+	bool					m_bRecording;
+	std::string				m_strRecordFile;
+	std::vector<UINT64>		m_Recorded;
+};
+
+// 명령줄로 시계를 설정한다. 인자가 없으면 실제 시간 방식이다.
+//		-fixed[:간격ms]		고정 간격(기본 60분의 1초)
+//		-replay:<파일>		시각표 재생
+//		-record:<파일>		시각표 기록. 다른 인자와 함께 쓸 수 있다.
+// 시각표를 읽지 못하면 실제 시간 방식으로 두고 실패를 돌려준다.
+HRESULT		SwConfigureClock(CSwClock* pClock, const char* pCmdLine);
@@ -0,0 +1,418 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwCombiner.cpp
+//
+// 설명:	텍스처 스테이지 조합기 구현.
+//		서술자는 연산이 쓰지 않는 인수를 0으로, 알 수 없는 연산을 SELECTARG1로, 알 수 없는 인수를
+//		DIFFUSE로 바꾸어 둔다(SwShadePixel()이 그렇게 해석한다). 그래서 결과가 같은 연결은 키도 같다.
+//-----------------------------------------------------------------------------
+#include "SwCombiner.h"
+#include "SwHash.h"
+#include "SwPixelStage.h"
+#include "SwVertexStage.h"
+
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+//-----------------------------------------------------------------------------
+// 스테이지 서술자
+// 비트 0-3 색 연산, 4-7 색 인수 1, 8-11 색 인수 2, 12-15 알파 연산, 16-19 알파 인수 1, 20-23 알파 인수 2,
+// 24 텍스처 샘플링. 인수는 선택(0-3) | COMPLEMENT(4) | ALPHAREPLICATE(8)이다.
+//-----------------------------------------------------------------------------
+#define SW_DESC_ARG_COMPLEMENT	0x4
+#define SW_DESC_ARG_REPLICATE	0x8
+#define SW_DESC_ARG_MODIFIERS	(SW_DESC_ARG_COMPLEMENT | SW_DESC_ARG_REPLICATE)
+#define SW_DESC_SAMPLE			0x01000000
+
+#define SW_DESC_COLOROP(d)		((d) & 0xf)
+#define SW_DESC_COLORARG1(d)	(((d) >> 4) & 0xf)
+#define SW_DESC_COLORARG2(d)	(((d) >> 8) & 0xf)
+#define SW_DESC_ALPHAOP(d)		(((d) >> 12) & 0xf)
+#define SW_DESC_ALPHAARG1(d)	(((d) >> 16) & 0xf)
+#define SW_DESC_ALPHAARG2(d)	(((d) >> 20) & 0xf)
+
+#define SW_COMBINER_NUM_OPS		(D3DTOP_BLENDTEXTUREALPHA - D3DTOP_SELECTARG1 + 1)
+
+static constexpr DWORD NormalizeOp(DWORD dwOp)
+{
+	return (dwOp >= D3DTOP_SELECTARG1 && dwOp <= D3DTOP_BLENDTEXTUREALPHA) ? dwOp : (DWORD)D3DTOP_SELECTARG1;
+}
+
+static constexpr DWORD PackArg(DWORD dwArg)
+{
+	return (((dwArg & D3DTA_SELECTMASK) <= D3DTA_TFACTOR) ? (dwArg & D3DTA_SELECTMASK) : (DWORD)D3DTA_DIFFUSE) |
+		((dwArg & D3DTA_COMPLEMENT) ? SW_DESC_ARG_COMPLEMENT : 0) |
+		((dwArg & D3DTA_ALPHAREPLICATE) ? SW_DESC_ARG_REPLICATE : 0);
+}
+
+static constexpr bool IsTextureArg(DWORD dwPacked)
+{
+	return (dwPacked & 3) == D3DTA_TEXTURE;
+}
+
+// bTexture는 스테이지에 텍스처가 연결되어 있는가이다. 없으면 샘플링 결과가 흰색이므로 읽지 않는다.
+static constexpr DWORD PackStage(DWORD dwColorOp, DWORD dwColorArg1, DWORD dwColorArg2,
+	DWORD dwAlphaOp, DWORD dwAlphaArg1, DWORD dwAlphaArg2, bool bTexture)
+{
+	const DWORD cop = NormalizeOp(dwColorOp);
+	const DWORD c1 = (cop != D3DTOP_SELECTARG2) ? PackArg(dwColorArg1) : 0;
+	const DWORD c2 = (cop != D3DTOP_SELECTARG1) ? PackArg(dwColorArg2) : 0;
+	const DWORD aop = (dwAlphaOp == D3DTOP_DISABLE) ? (DWORD)D3DTOP_DISABLE : NormalizeOp(dwAlphaOp);
+	const DWORD a1 = (aop != D3DTOP_DISABLE && aop != D3DTOP_SELECTARG2) ? PackArg(dwAlphaArg1) : 0;
+	const DWORD a2 = (aop != D3DTOP_DISABLE && aop != D3DTOP_SELECTARG1) ? PackArg(dwAlphaArg2) : 0;
+	const bool bSample = bTexture && (IsTextureArg(c1) || IsTextureArg(c2) || IsTextureArg(a1) || IsTextureArg(a2) ||
+		cop == D3DTOP_BLENDTEXTUREALPHA || aop == D3DTOP_BLENDTEXTUREALPHA);
+	return cop | (c1 << 4) | (c2 << 8) | (aop << 12) | (a1 << 16) | (a2 << 20) | (bSample ? SW_DESC_SAMPLE : 0);
+}
+
+static constexpr bool HasModifiers(DWORD dwDesc)
+{
+	return ((SW_DESC_COLORARG1(dwDesc) | SW_DESC_COLORARG2(dwDesc) |
+		SW_DESC_ALPHAARG1(dwDesc) | SW_DESC_ALPHAARG2(dwDesc)) & SW_DESC_ARG_MODIFIERS) != 0;
+}
+
+static constexpr bool UsesFactor(DWORD dwDesc)
+{
+	return SW_DESC_COLORARG1(dwDesc) == D3DTA_TFACTOR || SW_DESC_COLORARG2(dwDesc) == D3DTA_TFACTOR ||
+		SW_DESC_ALPHAARG1(dwDesc) == D3DTA_TFACTOR || SW_DESC_ALPHAARG2(dwDesc) == D3DTA_TFACTOR;
+}
+
+//-----------------------------------------------------------------------------
+// 스테이지 연산 템플릿
+//-----------------------------------------------------------------------------
+template<DWORD ARG>
+static inline const float* SelectSource(const SW_COMBINEARGS& args)
+{
+	switch (ARG & 3)
+	{
+	case D3DTA_CURRENT:	return args.pCurrent;
+	case D3DTA_TEXTURE:	return args.pTexture;
+	case D3DTA_TFACTOR:	return args.pFactor;
+	default:			return args.pDiffuse;
+	}
+}
+
+// 채널을 루프 없이 풀어 쓴다. 루프로 두면 컴파일러가 결과 배열을 메모리에 남겨 두고,
+// SwPackColor()가 이를 넓게 다시 읽을 때 저장-적재 전달이 실패하여 해석 경로보다 느려진다.
+template<DWORD OP, DWORD ARG1, DWORD ARG2>
+static inline VOID CombineColor(const SW_COMBINEARGS& args, float* pResult)
+{
+	const float* p1 = SelectSource<ARG1>(args);
+	const float* p2 = SelectSource<ARG2>(args);
+	const float fDiffuseAlpha = args.pDiffuse[3], fTextureAlpha = args.pTexture[3];
+	pResult[0] = SwApplyTextureOp(OP, p1[0], p2[0], fDiffuseAlpha, fTextureAlpha);
+	pResult[1] = SwApplyTextureOp(OP, p1[1], p2[1], fDiffuseAlpha, fTextureAlpha);
+	pResult[2] = SwApplyTextureOp(OP, p1[2], p2[2], fDiffuseAlpha, fTextureAlpha);
+}
+
+template<DWORD OP, DWORD ARG1, DWORD ARG2>
+static inline VOID CombineAlpha(const SW_COMBINEARGS& args, float* pResult)
+{
+	pResult[3] = SwApplyTextureOp(OP, SelectSource<ARG1>(args)[3], SelectSource<ARG2>(args)[3],
+		args.pDiffuse[3], args.pTexture[3]);
+}
+
+// 알파 연산이 꺼져 있으면 이전 단계의 알파를 그대로 넘긴다.
+static VOID CombineAlphaDisabled(const SW_COMBINEARGS& args, float* pResult)
+{
+	pResult[3] = args.pCurrent[3];
+}
+
+static inline VOID SampleStage(const SW_DRAWSTATE* pState, UINT nStage, const float (*pTexCoords)[2],
+	const float (*pTexDerivs)[4], float* pOut)
+{
+	const SW_STAGESTATE& stage = pState->Stages[nStage];
+	UINT nCoord = stage.dwTexCoordIndex & 0xffff;
+	if (nCoord >= SW_MAX_TEXCOORDS)
+		nCoord = SW_MAX_TEXCOORDS - 1;
+	SwSampleTexture(&stage, pTexCoords[nCoord][0], pTexCoords[nCoord][1],
+		pState->bUsesLod ? pTexDerivs[nCoord] : NULL, pOut);
+}
+
+//-----------------------------------------------------------------------------
+// 조합: 스테이지마다 (연산, 인수 1, 인수 2)로 인스턴스화한 함수를 잇는다.
+// 표의 순서는 ((연산 - SELECTARG1) * 4 + 인수 1) * 4 + 인수 2이다.
+//-----------------------------------------------------------------------------
+template<UINT INDEX>
+static VOID ComposedColor(const SW_COMBINEARGS& args, float* pResult)
+{
+	CombineColor<INDEX / 16 + D3DTOP_SELECTARG1, (INDEX / 4) % 4, INDEX % 4>(args, pResult);
+}
+
+template<UINT INDEX>
+static VOID ComposedAlpha(const SW_COMBINEARGS& args, float* pResult)
+{
+	CombineAlpha<INDEX / 16 + D3DTOP_SELECTARG1, (INDEX / 4) % 4, INDEX % 4>(args, pResult);
+}
+
+template<UINT... INDICES>
+static constexpr std::array<SW_COMBINEFUNC, sizeof...(INDICES)> MakeColorTable(std::integer_sequence<UINT, INDICES...>)
+{
+	return {{ &ComposedColor<INDICES>... }};
+}
+
+template<UINT... INDICES>
+static constexpr std::array<SW_COMBINEFUNC, sizeof...(INDICES)> MakeAlphaTable(std::integer_sequence<UINT, INDICES...>)
+{
+	return {{ &ComposedAlpha<INDICES>... }};
+}
+
+static const std::array<SW_COMBINEFUNC, SW_COMBINER_NUM_OPS * 16> s_ColorFuncs =
+	MakeColorTable(std::make_integer_sequence<UINT, SW_COMBINER_NUM_OPS * 16>());
+static const std::array<SW_COMBINEFUNC, SW_COMBINER_NUM_OPS * 16> s_AlphaFuncs =
+	MakeAlphaTable(std::make_integer_sequence<UINT, SW_COMBINER_NUM_OPS * 16>());
+
+static DWORD ShadeComposed(const SW_DRAWSTATE* pState, const float* pDiffuse, const float (*pTexCoords)[2],
+	const float (*pTexDerivs)[4])
+{
+	const SW_COMBINER& combiner = pState->Combiner;
+	float current[4] = { pDiffuse[0], pDiffuse[1], pDiffuse[2], pDiffuse[3] };
+	float factor[4];
+	SwUnpackColor(pState->dwTextureFactor, factor);
+
+	float tex[4], result[4];
+	const SW_COMBINEARGS args = { pDiffuse, current, tex, factor };
+	for (UINT s = 0; s < pState->nNumStages; ++s)
+	{
+		if (combiner.dwSampleMask & (1 << s))
+			SampleStage(pState, s, pTexCoords, pTexDerivs, tex);
+		else
+			tex[0] = tex[1] = tex[2] = tex[3] = 1.0f;
+
+		combiner.pfnColor[s](args, result);
+		combiner.pfnAlpha[s](args, result);
+		for (int i = 0; i < 4; ++i)
+			current[i] = result[i];
+	}
+	return SwPackColor(current);
+}
+
+//-----------------------------------------------------------------------------
+// 특수화: 연결 전체를 하나의 함수로 인스턴스화한다.
+//-----------------------------------------------------------------------------
+template<DWORD DESC>
+static inline VOID RunStage(const SW_DRAWSTATE* pState, UINT nStage, const float* pDiffuse, const float* pFactor,
+	const float (*pTexCoords)[2], const float (*pTexDerivs)[4], float* pCurrent)
+{
+	float tex[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	if constexpr ((DESC & SW_DESC_SAMPLE) != 0)
+		SampleStage(pState, nStage, pTexCoords, pTexDerivs, tex);
+
+	const SW_COMBINEARGS args = { pDiffuse, pCurrent, tex, pFactor };
+	float result[4];
+	CombineColor<SW_DESC_COLOROP(DESC), SW_DESC_COLORARG1(DESC), SW_DESC_COLORARG2(DESC)>(args, result);
+	if constexpr (SW_DESC_ALPHAOP(DESC) == D3DTOP_DISABLE)
+		CombineAlphaDisabled(args, result);
+	else
+		CombineAlpha<SW_DESC_ALPHAOP(DESC), SW_DESC_ALPHAARG1(DESC), SW_DESC_ALPHAARG2(DESC)>(args, result);
+
+	for (int i = 0; i < 4; ++i)
+		pCurrent[i] = result[i];
+}
+
+template<DWORD... DESCS>
+static DWORD ShadeSpecialized(const SW_DRAWSTATE* pState, const float* pDiffuse, const float (*pTexCoords)[2],
+	const float (*pTexDerivs)[4])
+{
+	float current[4] = { pDiffuse[0], pDiffuse[1], pDiffuse[2], pDiffuse[3] };
+	float factor[4] = {};
+	if constexpr ((false || ... || UsesFactor(DESCS)))
+		SwUnpackColor(pState->dwTextureFactor, factor);
+
+	UINT nStage = 0;
+	(RunStage<DESCS>(pState, nStage++, pDiffuse, factor, pTexCoords, pTexDerivs, current), ...);
+	(void)nStage;
+	(void)pTexCoords;
+	(void)pTexDerivs;
+	return SwPackColor(current);
+}
+
+// 예제들이 쓰는 연결
+static constexpr DWORD SW_DESC_DEFAULT = PackStage(D3DTOP_MODULATE, D3DTA_TEXTURE, D3DTA_CURRENT,
+	D3DTOP_SELECTARG1, D3DTA_TEXTURE, D3DTA_CURRENT, true);				// 기본 상태(Tut06)
+static constexpr DWORD SW_DESC_DEFAULT_NOTEX = PackStage(D3DTOP_MODULATE, D3DTA_TEXTURE, D3DTA_CURRENT,
+	D3DTOP_SELECTARG1, D3DTA_TEXTURE, D3DTA_CURRENT, false);			// 텍스처 없는 기본 상태(Tut01-04, Tut07)
+static constexpr DWORD SW_DESC_MODULATE_DIFFUSE = PackStage(D3DTOP_MODULATE, D3DTA_TEXTURE, D3DTA_DIFFUSE,
+	D3DTOP_DISABLE, 0, 0, true);										// Tut05
+static constexpr DWORD SW_DESC_MODULATE_BOTH = PackStage(D3DTOP_MODULATE, D3DTA_TEXTURE, D3DTA_DIFFUSE,
+	D3DTOP_MODULATE, D3DTA_TEXTURE, D3DTA_DIFFUSE, true);
+static constexpr DWORD SW_DESC_SELECT_TEXTURE = PackStage(D3DTOP_SELECTARG1, D3DTA_TEXTURE, 0,
+	D3DTOP_SELECTARG1, D3DTA_TEXTURE, 0, true);							// Tut08 스테이지 0
+static constexpr DWORD SW_DESC_MODULATE_CURRENT = PackStage(D3DTOP_MODULATE, D3DTA_TEXTURE, D3DTA_CURRENT,
+	D3DTOP_DISABLE, 0, 0, true);										// Tut08 스테이지 1(라이트맵)
+static constexpr DWORD SW_DESC_SELECT_DIFFUSE = PackStage(D3DTOP_SELECTARG1, D3DTA_DIFFUSE, 0,
+	D3DTOP_SELECTARG1, D3DTA_DIFFUSE, 0, false);
+
+struct SW_SPECIALIZATION
+{
+	UINT			nNumStages;
+	DWORD			Desc[2];
+	SW_SHADEFUNC	pfnShade;
+};
+
+static const SW_SPECIALIZATION s_Specializations[] =
+{
+	{ 0, {}, &ShadeSpecialized<> },
+	{ 1, { SW_DESC_DEFAULT_NOTEX }, &ShadeSpecialized<SW_DESC_DEFAULT_NOTEX> },
+	{ 1, { SW_DESC_DEFAULT }, &ShadeSpecialized<SW_DESC_DEFAULT> },
+	{ 1, { SW_DESC_MODULATE_DIFFUSE }, &ShadeSpecialized<SW_DESC_MODULATE_DIFFUSE> },
+	{ 1, { SW_DESC_MODULATE_BOTH }, &ShadeSpecialized<SW_DESC_MODULATE_BOTH> },
+	{ 1, { SW_DESC_SELECT_TEXTURE }, &ShadeSpecialized<SW_DESC_SELECT_TEXTURE> },
+	{ 1, { SW_DESC_SELECT_DIFFUSE }, &ShadeSpecialized<SW_DESC_SELECT_DIFFUSE> },
+	{ 2, { SW_DESC_SELECT_TEXTURE, SW_DESC_MODULATE_CURRENT },
+		&ShadeSpecialized<SW_DESC_SELECT_TEXTURE, SW_DESC_MODULATE_CURRENT> },
+	{ 2, { SW_DESC_DEFAULT, SW_DESC_MODULATE_CURRENT }, &ShadeSpecialized<SW_DESC_DEFAULT, SW_DESC_MODULATE_CURRENT> },
+};
+
+//-----------------------------------------------------------------------------
+// 캐시
+//-----------------------------------------------------------------------------
+namespace
+{
+	struct COMBINERKEY
+	{
+		UINT	nNumStages;
+		DWORD	Desc[SW_MAX_TEXTURE_STAGES];	// nNumStages 이후는 0
+
+		bool operator==(const COMBINERKEY& other) const
+		{
+			return memcmp(this, &other, sizeof(COMBINERKEY)) == 0;
+		}
+	};
+
+	struct COMBINERENTRY
+	{
+		COMBINERKEY		Key;
+		SW_COMBINER		Combiner;
+		SW_COMBINERKIND	eKind;
+	};
+
+	// 마지막으로 찾은 항목. 연속된 드로우는 대개 상태가 같으므로 해시와 잠금 없이 끝난다.
+	struct LASTCOMBINER
+	{
+		bool			bValid;
+		COMBINERENTRY	Entry;
+	};
+}
+
+static std::mutex								s_CacheMutex;
+static std::unordered_map<UINT64, COMBINERENTRY>	s_Cache;
+static UINT										s_nEntries[3];
+static std::atomic<UINT64>						s_nLookups(0);
+static std::atomic<UINT64>						s_nHits(0);
+static thread_local LASTCOMBINER				s_Last;
+
+static SW_COMBINERKIND BuildCombiner(const COMBINERKEY& key, SW_COMBINER* pCombiner)
+{
+	memset(pCombiner, 0, sizeof(SW_COMBINER));
+	for (UINT s = 0; s < key.nNumStages; ++s)
+	{
+		if (key.Desc[s] & SW_DESC_SAMPLE)
+			pCombiner->dwSampleMask |= 1 << s;
+	}
+
+	for (UINT s = 0; s < key.nNumStages; ++s)
+	{
+		if (HasModifiers(key.Desc[s]))
+		{
+			pCombiner->pfnShade = &SwShadePixel;
+			return SW_COMBINER_INTERPRETED;
+		}
+	}
+
+	for (const SW_SPECIALIZATION& spec : s_Specializations)
+	{
+		if (spec.nNumStages == key.nNumStages &&
+			memcmp(spec.Desc, key.Desc, key.nNumStages * sizeof(DWORD)) == 0)
+		{
+			pCombiner->pfnShade = spec.pfnShade;
+			return SW_COMBINER_SPECIALIZED;
+		}
+	}
+
+	for (UINT s = 0; s < key.nNumStages; ++s)
+	{
+		const DWORD d = key.Desc[s];
+		pCombiner->pfnColor[s] = s_ColorFuncs[((SW_DESC_COLOROP(d) - D3DTOP_SELECTARG1) * 4 +
+			SW_DESC_COLORARG1(d)) * 4 + SW_DESC_COLORARG2(d)];
+		pCombiner->pfnAlpha[s] = (SW_DESC_ALPHAOP(d) == D3DTOP_DISABLE) ? &CombineAlphaDisabled :
+			s_AlphaFuncs[((SW_DESC_ALPHAOP(d) - D3DTOP_SELECTARG1) * 4 + SW_DESC_ALPHAARG1(d)) * 4 + SW_DESC_ALPHAARG2(d)];
+	}
+	pCombiner->pfnShade = &ShadeComposed;
+	return SW_COMBINER_COMPOSED;
+}
+
+SW_COMBINERKIND SwSelectCombiner(SW_DRAWSTATE* pState)
+{
+	COMBINERKEY key;
+	memset(&key, 0, sizeof(key));
+	key.nNumStages = pState->nNumStages;
+	for (UINT s = 0; s < pState->nNumStages; ++s)
+	{
+		const SW_STAGESTATE& stage = pState->Stages[s];
+		key.Desc[s] = PackStage(stage.dwColorOp, stage.dwColorArg1, stage.dwColorArg2,
+			stage.dwAlphaOp, stage.dwAlphaArg1, stage.dwAlphaArg2, stage.pTexture != NULL);
+	}
+
+	s_nLookups.fetch_add(1, std::memory_order_relaxed);
+	if (s_Last.bValid && s_Last.Entry.Key == key)
+	{
+		s_nHits.fetch_add(1, std::memory_order_relaxed);
+		pState->Combiner = s_Last.Entry.Combiner;
+		return s_Last.Entry.eKind;
+	}
+
+	const UINT64 nHash = SwHash64(&key, sizeof(key));
+	{
+		std::lock_guard<std::mutex> lock(s_CacheMutex);
+		auto it = s_Cache.find(nHash);
+		if (it != s_Cache.end() && it->second.Key == key)
+		{
+			s_nHits.fetch_add(1, std::memory_order_relaxed);
+			s_Last.Entry = it->second;
+		}
+		else
+		{
+			s_Last.Entry.Key = key;
+			s_Last.Entry.eKind = BuildCombiner(key, &s_Last.Entry.Combiner);
+			// 해시가 겹친 다른 연결은 캐시하지 않고 매번 새로 고른다.
+			if (it == s_Cache.end())
+			{
+				s_Cache.emplace(nHash, s_Last.Entry);
+				++s_nEntries[s_Last.Entry.eKind];
+			}
+		}
+	}
+	s_Last.bValid = true;
+
+	pState->Combiner = s_Last.Entry.Combiner;
+	return s_Last.Entry.eKind;
+}
+
+VOID SwGetCombinerStats(SW_COMBINERSTATS* pStats)
+{
+	std::lock_guard<std::mutex> lock(s_CacheMutex);
+	pStats->nLookups = s_nLookups.load(std::memory_order_relaxed);
+	pStats->nHits = s_nHits.load(std::memory_order_relaxed);
+	for (int i = 0; i < 3; ++i)
+		pStats->nEntries[i] = s_nEntries[i];
+}
+
+VOID SwResetCombinerStats()
+{
+	s_nLookups.store(0, std::memory_order_relaxed);
+	s_nHits.store(0, std::memory_order_relaxed);
+}
+
+const char* SwGetCombinerKindName(SW_COMBINERKIND eKind)
+{
+	switch (eKind)
+	{
+	case SW_COMBINER_SPECIALIZED:	return "specialized";
+	case SW_COMBINER_COMPOSED:		return "composed";
+	default:						return "interpreted";
+	}
+}
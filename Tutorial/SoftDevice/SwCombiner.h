@@ -0,0 +1,41 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwCombiner.h
+//
+// 설명:	텍스처 스테이지 조합기.
+//		드로우 상태의 스테이지 연결(연산, 인수, 샘플링 여부)을 스테이지마다 32비트 서술자로 줄이고
+//		그 배열의 해시를 키로 픽셀 셰이딩 함수를 고른다. 함수는 세 가지 중 하나다.
+//		- 특수화: 예제들이 쓰는 연결 전체를 템플릿으로 미리 인스턴스화한 함수
+//		- 조합: 스테이지마다 (연산, 인수 1, 인수 2)로 인스턴스화한 색, 알파 함수를 이어 붙인 것
+//		- 해석: 인수에 COMPLEMENT, ALPHAREPLICATE가 붙은 경우의 SwShadePixel()
+//		어느 경우에도 픽셀마다 D3DTOP_* 값으로 분기하지 않고, 결과는 SwShadePixel()과 비트 단위로 같다.
+//		고른 결과는 키별로 캐시하므로 같은 상태의 드로우는 해시 한 번으로 끝난다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwPipeline.h"
+
+enum SW_COMBINERKIND
+{
+	SW_COMBINER_SPECIALIZED = 0,
+	SW_COMBINER_COMPOSED,
+	SW_COMBINER_INTERPRETED,
+};
+
+//-----------------------------------------------------------------------------
+// 캐시 통계(프로세스 전체)
+//-----------------------------------------------------------------------------
+struct SW_COMBINERSTATS
+{
+	UINT64	nLookups;		// SwSelectCombiner() 호출 수
+	UINT64	nHits;			// 캐시에서 찾은 수
+	UINT	nEntries[3];	// 캐시에 든 연결 수(SW_COMBINERKIND별)
+};
+
+// pState->nNumStages까지의 스테이지로 pState->Combiner를 채운다. SwPrepareDrawState()가 부른다.
+// 고른 함수의 종류를 돌려준다.
+SW_COMBINERKIND	SwSelectCombiner(SW_DRAWSTATE* pState);
+
+VOID			SwGetCombinerStats(SW_COMBINERSTATS* pStats);
+// 조회 수만 0으로 되돌린다. 캐시는 그대로 둔다.
+VOID			SwResetCombinerStats();
+const char*		SwGetCombinerKindName(SW_COMBINERKIND eKind);
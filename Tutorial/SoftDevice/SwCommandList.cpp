@@ -0,0 +1,230 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwCommandList.cpp
+//
+// 설명:	명령 목록의 기록. 실행은 CSwDevice::ExecuteCommandList()에 있다.
+//		검사 조건은 CSwDevice의 같은 이름의 메서드와 같다.
+//-----------------------------------------------------------------------------
+#include "SwCommandList.h"
+#include "SwStateBlock.h"
+
+#include <cstring>
+
+CSwCommandList::CSwCommandList()
+	: m_nNumCommands(0)
+	, m_nNumDraws(0)
+	, m_bClosed(FALSE)
+{
+}
+
+CSwCommandList::~CSwCommandList()
+{
+	Reset();
+}
+
+HRESULT CSwCommandList::Append(SW_COMMAND eCommand, const VOID* pArgs, UINT nArgSize)
+{
+	if (m_bClosed)
+		return D3DERR_INVALIDCALL;
+
+	const UINT nSize = (sizeof(SW_CMDHEADER) + nArgSize + 3) & ~3u;
+	const size_t nOffset = m_Data.size();
+	m_Data.resize(nOffset + nSize, 0);
+
+	SW_CMDHEADER header = { (WORD)eCommand, (WORD)nSize };
+	memcpy(&m_Data[nOffset], &header, sizeof(header));
+	memcpy(&m_Data[nOffset + sizeof(header)], pArgs, nArgSize);
+	++m_nNumCommands;
+	return S_OK;
+}
+
+VOID CSwCommandList::Hold(CSwResource* pResource)
+{
+	if (pResource)
+	{
+		pResource->AddRef();
+		m_Resources.push_back(pResource);
+	}
+}
+
+HRESULT CSwCommandList::Close()
+{
+	if (m_bClosed)
+		return D3DERR_INVALIDCALL;
+
+	m_bClosed = TRUE;
+	return S_OK;
+}
+
+VOID CSwCommandList::Reset()
+{
+	for (CSwResource* pResource : m_Resources)
+		pResource->Release();
+	m_Resources.clear();
+	m_Data.clear();
+	m_nNumCommands = 0;
+	m_nNumDraws = 0;
+	m_bClosed = FALSE;
+}
+
+//-----------------------------------------------------------------------------
+// 상태
+//-----------------------------------------------------------------------------
+HRESULT CSwCommandList::SetTransform(D3DTRANSFORMSTATETYPE State, const D3DMATRIX* pMatrix)
+{
+	if (pMatrix == NULL || (DWORD)State > 0xffff)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_TRANSFORM args = { (DWORD)State, *pMatrix };
+	return Append(SW_CMD_SETTRANSFORM, args);
+}
+
+HRESULT CSwCommandList::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
+{
+	if ((DWORD)State >= SW_NUM_RENDERSTATES)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_STATE args = { 0, (DWORD)State, Value };
+	return Append(SW_CMD_SETRENDERSTATE, args);
+}
+
+HRESULT CSwCommandList::SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value)
+{
+	if (Stage >= SW_MAX_TEXTURE_STAGES || (DWORD)Type >= SW_NUM_STAGESTATES)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_STATE args = { Stage, (DWORD)Type, Value };
+	return Append(SW_CMD_SETTEXTURESTAGESTATE, args);
+}
+
+HRESULT CSwCommandList::SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value)
+{
+	if (Sampler >= SW_MAX_TEXTURE_STAGES || (DWORD)Type >= SW_NUM_SAMPLERSTATES)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_STATE args = { Sampler, (DWORD)Type, Value };
+	return Append(SW_CMD_SETSAMPLERSTATE, args);
+}
+
+HRESULT CSwCommandList::SetTexture(DWORD Stage, CSwTexture* pTexture)
+{
+	if (Stage >= SW_MAX_TEXTURE_STAGES)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_TEXTURE args = { Stage, pTexture };
+	HRESULT hr = Append(SW_CMD_SETTEXTURE, args);
+	if (SUCCEEDED(hr))
+		Hold(pTexture);
+	return hr;
+}
+
+HRESULT CSwCommandList::SetMaterial(const D3DMATERIAL9* pMaterial)
+{
+	if (pMaterial == NULL)
+		return D3DERR_INVALIDCALL;
+
+	return Append(SW_CMD_SETMATERIAL, *pMaterial);
+}
+
+HRESULT CSwCommandList::SetLight(DWORD Index, const D3DLIGHT9* pLight)
+{
+	if (Index >= SW_MAX_LIGHTS || pLight == NULL)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_LIGHT args = { Index, *pLight };
+	return Append(SW_CMD_SETLIGHT, args);
+}
+
+HRESULT CSwCommandList::LightEnable(DWORD Index, BOOL Enable)
+{
+	if (Index >= SW_MAX_LIGHTS)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_LIGHTENABLE args = { Index, Enable };
+	return Append(SW_CMD_LIGHTENABLE, args);
+}
+
+HRESULT CSwCommandList::ApplyStateBlock(CSwStateBlock* pStateBlock)
+{
+	if (pStateBlock == NULL)
+		return D3DERR_INVALIDCALL;
+
+	HRESULT hr = Append(SW_CMD_APPLYSTATEBLOCK, pStateBlock);
+	if (SUCCEEDED(hr))
+		Hold(pStateBlock);
+	return hr;
+}
+
+//-----------------------------------------------------------------------------
+// 입력
+//-----------------------------------------------------------------------------
+HRESULT CSwCommandList::SetStreamSource(UINT StreamNumber, CSwVertexBuffer* pStreamData, UINT OffsetInBytes,
+	UINT Stride)
+{
+	if (StreamNumber != 0)
+		return D3DERR_INVALIDCALL;
+
+	SW_CMDARGS_STREAMSOURCE args = { pStreamData, OffsetInBytes, Stride };
+	HRESULT hr = Append(SW_CMD_SETSTREAMSOURCE, args);
+	if (SUCCEEDED(hr))
+		Hold(pStreamData);
+	return hr;
+}
+
+HRESULT CSwCommandList::SetFVF(DWORD FVF)
+{
+	return Append(SW_CMD_SETFVF, FVF);
+}
+
+HRESULT CSwCommandList::SetVertexQuant(const SW_VERTEXQUANT* pQuant)
+{
+	SW_CMDARGS_VERTEXQUANT args;
+	ZeroMemory(&args, sizeof(args));
+	args.bEnable = (pQuant != NULL);
+	if (pQuant)
+		args.Quant = *pQuant;
+	return Append(SW_CMD_SETVERTEXQUANT, args);
+}
+
+HRESULT CSwCommandList::SetIndices(CSwIndexBuffer* pIndexData)
+{
+	HRESULT hr = Append(SW_CMD_SETINDICES, pIndexData);
+	if (SUCCEEDED(hr))
+		Hold(pIndexData);
+	return hr;
+}
+
+//-----------------------------------------------------------------------------
+// 그리기
+// 정점과 인덱스 범위는 실행할 때의 버퍼로 검사한다. 버퍼 내용은 기록 뒤에도 바뀔 수 있다.
+//-----------------------------------------------------------------------------
+HRESULT CSwCommandList::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount)
+{
+	if (PrimitiveType != D3DPT_TRIANGLELIST && PrimitiveType != D3DPT_TRIANGLESTRIP &&
+		PrimitiveType != D3DPT_TRIANGLEFAN)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	SW_CMDARGS_DRAW args = { (DWORD)PrimitiveType, StartVertex, PrimitiveCount };
+	HRESULT hr = Append(SW_CMD_DRAWPRIMITIVE, args);
+	if (SUCCEEDED(hr))
+		++m_nNumDraws;
+	return hr;
+}
+
+HRESULT CSwCommandList::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex,
+	UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount)
+{
+	if (PrimitiveType != D3DPT_TRIANGLELIST && PrimitiveType != D3DPT_TRIANGLESTRIP &&
+		PrimitiveType != D3DPT_TRIANGLEFAN)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	SW_CMDARGS_DRAWINDEXED args = { (DWORD)PrimitiveType, BaseVertexIndex, MinVertexIndex, NumVertices,
+		startIndex, primCount };
+	HRESULT hr = Append(SW_CMD_DRAWINDEXEDPRIMITIVE, args);
+	if (SUCCEEDED(hr))
+		++m_nNumDraws;
+	return hr;
+}
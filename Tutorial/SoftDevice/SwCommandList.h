@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwCommandList.h
+//
+// 설명:	명령 목록.
+//		디바이스 호출(상태 설정, 입력 설정, 그리기)을 하나의 선형 버퍼에 기록해 두었다가
+//		CSwDevice::ExecuteCommandList()로 몇 번이고 다시 실행한다. 인자 검사는 기록할 때 한 번만 하고
+//		실행할 때는 버퍼를 앞에서부터 읽으며 디바이스의 내부 함수를 바로 부른다.
+//		기록은 디바이스를 건드리지 않으므로 여러 목록을 작업자 스레드에서 동시에 만든 뒤
+//		원하는 순서대로 실행할 수 있다(목록 하나를 여러 스레드가 함께 기록하면 안 된다).
+//		기록된 자원(텍스처, 정점 버퍼, 인덱스 버퍼, 상태 블록)은 목록이 참조를 잡아 둔다.
+//
+//		사용 예:
+//			CSwCommandList* pList;
+//			pDevice->CreateCommandList(&pList);
+//			pList->SetTexture(0, pTexture);
+//			pList->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 2);
+//			pList->Close();
+//			...
+//			pDevice->ExecuteCommandList(pList);	// 매 프레임, BeginScene()과 EndScene() 사이
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwPipeline.h"
+#include "SwResource.h"
+#include "SwVertexStage.h"
+
+#include <vector>
+
+class CSwStateBlock;
+
+enum SW_COMMAND
+{
+	SW_CMD_SETTRANSFORM = 0,
+	SW_CMD_SETRENDERSTATE,
+	SW_CMD_SETTEXTURESTAGESTATE,
+	SW_CMD_SETSAMPLERSTATE,
+	SW_CMD_SETTEXTURE,
+	SW_CMD_SETMATERIAL,
+	SW_CMD_SETLIGHT,
+	SW_CMD_LIGHTENABLE,
+	SW_CMD_APPLYSTATEBLOCK,
+	SW_CMD_SETSTREAMSOURCE,
+	SW_CMD_SETFVF,
+	SW_CMD_SETVERTEXQUANT,
+	SW_CMD_SETINDICES,
+	SW_CMD_DRAWPRIMITIVE,
+	SW_CMD_DRAWINDEXEDPRIMITIVE,
+};
+
+//-----------------------------------------------------------------------------
+// 명령의 머리. 인자는 머리 바로 뒤에 오고 명령 전체의 크기는 4바이트 단위다.
+// 버퍼를 작게 유지하려고 포인터 인자도 4바이트 경계에 두므로 인자는 memcpy로 읽는다.
+//-----------------------------------------------------------------------------
+struct SW_CMDHEADER
+{
+	WORD	wCommand;		// SW_COMMAND
+	WORD	wSize;			// 머리를 포함한 바이트 수
+};
+
+struct SW_CMDARGS_TRANSFORM			{ DWORD dwState; D3DMATRIX Matrix; };
+struct SW_CMDARGS_STATE				{ DWORD dwStage; DWORD dwType; DWORD dwValue; };	// 렌더 상태는 dwStage가 0
+struct SW_CMDARGS_TEXTURE			{ DWORD dwStage; CSwTexture* pTexture; };
+struct SW_CMDARGS_LIGHT				{ DWORD dwIndex; D3DLIGHT9 Light; };
+struct SW_CMDARGS_LIGHTENABLE		{ DWORD dwIndex; BOOL bEnable; };
+struct SW_CMDARGS_STREAMSOURCE		{ CSwVertexBuffer* pVB; UINT nOffset; UINT nStride; };
+struct SW_CMDARGS_VERTEXQUANT		{ BOOL bEnable; SW_VERTEXQUANT Quant; };
+struct SW_CMDARGS_DRAW				{ DWORD dwType; UINT nStartVertex; UINT nPrimitiveCount; };
+struct SW_CMDARGS_DRAWINDEXED		{ DWORD dwType; INT nBaseVertex; UINT nMinVertex; UINT nNumVertices;
+								  UINT nStartIndex; UINT nPrimitiveCount; };
+
+//-----------------------------------------------------------------------------
+// 명령 목록
+// 메서드는 CSwDevice의 같은 이름의 메서드와 인자가 같다. 잘못된 인자는 기록하지 않고
+// D3DERR_INVALIDCALL을 돌려준다. Close() 뒤에는 Reset() 전까지 기록할 수 없다.
+//-----------------------------------------------------------------------------
+class CSwCommandList : public CSwResource
+{
+public:
+	CSwCommandList();
+
+	HRESULT	SetTransform(D3DTRANSFORMSTATETYPE State, const D3DMATRIX* pMatrix);
+	HRESULT	SetRenderState(D3DRENDERSTATETYPE State, DWORD Value);
+	HRESULT	SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value);
+	HRESULT	SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value);
+	HRESULT	SetTexture(DWORD Stage, CSwTexture* pTexture);
+	HRESULT	SetMaterial(const D3DMATERIAL9* pMaterial);
+	HRESULT	SetLight(DWORD Index, const D3DLIGHT9* pLight);
+	HRESULT	LightEnable(DWORD Index, BOOL Enable);
+	HRESULT	ApplyStateBlock(CSwStateBlock* pStateBlock);
+
+	HRESULT	SetStreamSource(UINT StreamNumber, CSwVertexBuffer* pStreamData, UINT OffsetInBytes, UINT Stride);
+	HRESULT	SetFVF(DWORD FVF);
+	HRESULT	SetVertexQuant(const SW_VERTEXQUANT* pQuant);
+	HRESULT	SetIndices(CSwIndexBuffer* pIndexData);
+
+	HRESULT	DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount);
+	HRESULT	DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex,
+				UINT NumVertices, UINT startIndex, UINT primCount);
+
+	// 기록을 마친다. 닫힌 목록만 실행할 수 있다.
+	HRESULT	Close();
+	// 기록된 명령과 자원의 참조를 버리고 다시 기록할 수 있게 한다.
+	VOID	Reset();
+
+	BOOL		IsClosed() const { return m_bClosed; }
+	UINT		GetNumCommands() const { return m_nNumCommands; }
+	UINT		GetNumDraws() const { return m_nNumDraws; }
+	UINT		GetSize() const { return (UINT)m_Data.size(); }
+	const BYTE*	GetData() const { return m_Data.data(); }
+
+private:
+	virtual ~CSwCommandList();
+
+	// 명령 하나를 덧붙인다. 인자는 정렬되지 않은 위치에 복사되므로 읽을 때도 복사해야 한다.
+	HRESULT	Append(SW_COMMAND eCommand, const VOID* pArgs, UINT nArgSize);
+	template<typename ARGS>
+	HRESULT	Append(SW_COMMAND eCommand, const ARGS& args) { return Append(eCommand, &args, sizeof(ARGS)); }
+	VOID	Hold(CSwResource* pResource);
+
+	std::vector<BYTE>			m_Data;
+	std::vector<CSwResource*>	m_Resources;	// 참조를 잡아 둔 자원
+	UINT						m_nNumCommands;
+	UINT						m_nNumDraws;
+	BOOL						m_bClosed;
+};
@@ -0,0 +1,391 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwD3D9Types.h
+//
+// 설명:	소프트웨어 디바이스가 사용하는 D3D9 자료형과 상수.
+//		Windows에서는 DirectX SDK의 d3d9.h를 그대로 사용하고,
+//		그 외의 플랫폼(Linux 렌더 팜 등)에서는 예제들이 사용하는 부분만 같은 이름, 같은 값으로 정의한다.
+//		값이 D3D9와 같기 때문에 예제 코드의 상수를 그대로 넘겨도 된다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#if defined(_WIN32) && !defined(SW_NO_D3D9)
+
+#ifndef NOMINMAX
+#define NOMINMAX		// std::min, std::max와 충돌하지 않도록
+#endif
+#include <Windows.h>
+#include <d3d9.h>
+
+#else
+
+#include <cstdint>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// 기본 자료형
+//-----------------------------------------------------------------------------
+typedef uint8_t			BYTE;
+typedef uint16_t		WORD;
+typedef uint32_t		DWORD;
+typedef int32_t			INT;
+typedef uint32_t		UINT;
+typedef uint64_t		UINT64;
+typedef int32_t			LONG;
+typedef int32_t			BOOL;
+typedef float			FLOAT;
+typedef int32_t			HRESULT;
+typedef DWORD			D3DCOLOR;
+#define VOID			void
+
+#ifndef TRUE
+#define TRUE			1
+#define FALSE			0
+#endif
+
+#ifndef NULL
+#define NULL			0
+#endif
+
+#define S_OK					((HRESULT)0L)
+#define S_FALSE					((HRESULT)1L)
+#define E_FAIL					((HRESULT)0x80004005L)
+#define E_OUTOFMEMORY			((HRESULT)0x8007000EL)
+#define E_INVALIDARG			((HRESULT)0x80070057L)
+#define D3DERR_INVALIDCALL		((HRESULT)0x8876086CL)
+#define D3DERR_NOTAVAILABLE		((HRESULT)0x8876086AL)
+#define D3DERR_NOTFOUND			((HRESULT)0x88760866L)
+
+#define SUCCEEDED(hr)			(((HRESULT)(hr)) >= 0)
+#define FAILED(hr)				(((HRESULT)(hr)) < 0)
+
+#define ZeroMemory(p, n)		memset((p), 0, (n))
+
+#define MAKEFOURCC(ch0, ch1, ch2, ch3) \
+	((DWORD)(BYTE)(ch0) | ((DWORD)(BYTE)(ch1) << 8) | \
+	((DWORD)(BYTE)(ch2) << 16) | ((DWORD)(BYTE)(ch3) << 24))
+
+#define D3DCOLOR_ARGB(a, r, g, b) \
+	((D3DCOLOR)((((a) & 0xff) << 24) | (((r) & 0xff) << 16) | (((g) & 0xff) << 8) | ((b) & 0xff)))
+#define D3DCOLOR_RGBA(r, g, b, a)	D3DCOLOR_ARGB(a, r, g, b)
+#define D3DCOLOR_XRGB(r, g, b)		D3DCOLOR_ARGB(0xff, r, g, b)
+
+//-----------------------------------------------------------------------------
+// 구조체
+//-----------------------------------------------------------------------------
+struct D3DVECTOR
+{
+	float x, y, z;
+};
+
+struct D3DCOLORVALUE
+{
+	float r, g, b, a;
+};
+
+struct D3DRECT
+{
+	LONG x1, y1, x2, y2;
+};
+
+struct D3DMATRIX
+{
+	union
+	{
+		struct
+		{
+			float _11, _12, _13, _14;
+			float _21, _22, _23, _24;
+			float _31, _32, _33, _34;
+			float _41, _42, _43, _44;
+		};
+		float m[4][4];
+	};
+};
+
+struct D3DMATERIAL9
+{
+	D3DCOLORVALUE	Diffuse;
+	D3DCOLORVALUE	Ambient;
+	D3DCOLORVALUE	Specular;
+	D3DCOLORVALUE	Emissive;
+	float			Power;
+};
+
+enum D3DLIGHTTYPE
+{
+	D3DLIGHT_POINT = 1,
+	D3DLIGHT_SPOT = 2,
+	D3DLIGHT_DIRECTIONAL = 3,
+	D3DLIGHT_FORCE_DWORD = 0x7fffffff,
+};
+
+struct D3DLIGHT9
+{
+	D3DLIGHTTYPE	Type;
+	D3DCOLORVALUE	Diffuse;
+	D3DCOLORVALUE	Specular;
+	D3DCOLORVALUE	Ambient;
+	D3DVECTOR		Position;
+	D3DVECTOR		Direction;
+	float			Range;
+	float			Falloff;
+	float			Attenuation0;
+	float			Attenuation1;
+	float			Attenuation2;
+	float			Theta;
+	float			Phi;
+};
+
+struct D3DLOCKED_RECT
+{
+	INT				Pitch;
+	void*			pBits;
+};
+
+//-----------------------------------------------------------------------------
+// 열거형
+//-----------------------------------------------------------------------------
+enum D3DFORMAT
+{
+	D3DFMT_UNKNOWN = 0,
+	D3DFMT_R8G8B8 = 20,
+	D3DFMT_A8R8G8B8 = 21,
+	D3DFMT_X8R8G8B8 = 22,
+	D3DFMT_R5G6B5 = 23,
+	D3DFMT_D24S8 = 75,
+	D3DFMT_D16 = 80,
+	D3DFMT_INDEX16 = 101,
+	D3DFMT_INDEX32 = 102,
+	D3DFMT_DXT1 = MAKEFOURCC('D', 'X', 'T', '1'),
+	D3DFMT_DXT5 = MAKEFOURCC('D', 'X', 'T', '5'),
+	D3DFMT_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DPOOL
+{
+	D3DPOOL_DEFAULT = 0,
+	D3DPOOL_MANAGED = 1,
+	D3DPOOL_SYSTEMMEM = 2,
+	D3DPOOL_SCRATCH = 3,
+	D3DPOOL_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DPRIMITIVETYPE
+{
+	D3DPT_POINTLIST = 1,
+	D3DPT_LINELIST = 2,
+	D3DPT_LINESTRIP = 3,
+	D3DPT_TRIANGLELIST = 4,
+	D3DPT_TRIANGLESTRIP = 5,
+	D3DPT_TRIANGLEFAN = 6,
+	D3DPT_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DTRANSFORMSTATETYPE
+{
+	D3DTS_VIEW = 2,
+	D3DTS_PROJECTION = 3,
+	D3DTS_TEXTURE0 = 16,
+	D3DTS_TEXTURE1 = 17,
+	D3DTS_TEXTURE2 = 18,
+	D3DTS_TEXTURE3 = 19,
+	D3DTS_TEXTURE4 = 20,
+	D3DTS_TEXTURE5 = 21,
+	D3DTS_TEXTURE6 = 22,
+	D3DTS_TEXTURE7 = 23,
+	D3DTS_FORCE_DWORD = 0x7fffffff,
+};
+
+#define D3DTS_WORLDMATRIX(index)	(D3DTRANSFORMSTATETYPE)(index + 256)
+#define D3DTS_WORLD					D3DTS_WORLDMATRIX(0)
+
+enum D3DRENDERSTATETYPE
+{
+	D3DRS_ZENABLE = 7,
+	D3DRS_FILLMODE = 8,
+	D3DRS_SHADEMODE = 9,
+	D3DRS_ZWRITEENABLE = 14,
+	D3DRS_ALPHATESTENABLE = 15,
+	D3DRS_LASTPIXEL = 16,
+	D3DRS_SRCBLEND = 19,
+	D3DRS_DESTBLEND = 20,
+	D3DRS_CULLMODE = 22,
+	D3DRS_ZFUNC = 23,
+	D3DRS_ALPHAREF = 24,
+	D3DRS_ALPHAFUNC = 25,
+	D3DRS_DITHERENABLE = 26,
+	D3DRS_ALPHABLENDENABLE = 27,
+	D3DRS_FOGENABLE = 28,
+	D3DRS_SPECULARENABLE = 29,
+	D3DRS_TEXTUREFACTOR = 60,
+	D3DRS_LIGHTING = 137,
+	D3DRS_AMBIENT = 139,
+	D3DRS_COLORVERTEX = 141,
+	D3DRS_NORMALIZENORMALS = 143,
+	D3DRS_DIFFUSEMATERIALSOURCE = 145,
+	D3DRS_SPECULARMATERIALSOURCE = 146,
+	D3DRS_AMBIENTMATERIALSOURCE = 147,
+	D3DRS_EMISSIVEMATERIALSOURCE = 148,
+	D3DRS_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DZBUFFERTYPE
+{
+	D3DZB_FALSE = 0,
+	D3DZB_TRUE = 1,
+	D3DZB_USEW = 2,
+	D3DZB_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DCULL
+{
+	D3DCULL_NONE = 1,
+	D3DCULL_CW = 2,
+	D3DCULL_CCW = 3,
+	D3DCULL_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DCMPFUNC
+{
+	D3DCMP_NEVER = 1,
+	D3DCMP_LESS = 2,
+	D3DCMP_EQUAL = 3,
+	D3DCMP_LESSEQUAL = 4,
+	D3DCMP_GREATER = 5,
+	D3DCMP_NOTEQUAL = 6,
+	D3DCMP_GREATEREQUAL = 7,
+	D3DCMP_ALWAYS = 8,
+	D3DCMP_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DMATERIALCOLORSOURCE
+{
+	D3DMCS_MATERIAL = 0,
+	D3DMCS_COLOR1 = 1,
+	D3DMCS_COLOR2 = 2,
+	D3DMCS_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DTEXTURESTAGESTATETYPE
+{
+	D3DTSS_COLOROP = 1,
+	D3DTSS_COLORARG1 = 2,
+	D3DTSS_COLORARG2 = 3,
+	D3DTSS_ALPHAOP = 4,
+	D3DTSS_ALPHAARG1 = 5,
+	D3DTSS_ALPHAARG2 = 6,
+	D3DTSS_TEXCOORDINDEX = 11,
+	D3DTSS_TEXTURETRANSFORMFLAGS = 24,
+	D3DTSS_COLORARG0 = 26,
+	D3DTSS_ALPHAARG0 = 27,
+	D3DTSS_RESULTARG = 28,
+	D3DTSS_CONSTANT = 32,
+	D3DTSS_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DTEXTUREOP
+{
+	D3DTOP_DISABLE = 1,
+	D3DTOP_SELECTARG1 = 2,
+	D3DTOP_SELECTARG2 = 3,
+	D3DTOP_MODULATE = 4,
+	D3DTOP_MODULATE2X = 5,
+	D3DTOP_MODULATE4X = 6,
+	D3DTOP_ADD = 7,
+	D3DTOP_ADDSIGNED = 8,
+	D3DTOP_ADDSIGNED2X = 9,
+	D3DTOP_SUBTRACT = 10,
+	D3DTOP_ADDSMOOTH = 11,
+	D3DTOP_BLENDDIFFUSEALPHA = 12,
+	D3DTOP_BLENDTEXTUREALPHA = 13,
+	D3DTOP_FORCE_DWORD = 0x7fffffff,
+};
+
+#define D3DTA_SELECTMASK		0x0000000f
+#define D3DTA_DIFFUSE			0x00000000
+#define D3DTA_CURRENT			0x00000001
+#define D3DTA_TEXTURE			0x00000002
+#define D3DTA_TFACTOR			0x00000003
+#define D3DTA_SPECULAR			0x00000004
+#define D3DTA_TEMP				0x00000005
+#define D3DTA_CONSTANT			0x00000006
+#define D3DTA_COMPLEMENT		0x00000010
+#define D3DTA_ALPHAREPLICATE	0x00000020
+
+enum D3DSAMPLERSTATETYPE
+{
+	D3DSAMP_ADDRESSU = 1,
+	D3DSAMP_ADDRESSV = 2,
+	D3DSAMP_ADDRESSW = 3,
+	D3DSAMP_BORDERCOLOR = 4,
+	D3DSAMP_MAGFILTER = 5,
+	D3DSAMP_MINFILTER = 6,
+	D3DSAMP_MIPFILTER = 7,
+	D3DSAMP_MIPMAPLODBIAS = 8,
+	D3DSAMP_MAXMIPLEVEL = 9,
+	D3DSAMP_MAXANISOTROPY = 10,
+	D3DSAMP_SRGBTEXTURE = 11,
+	D3DSAMP_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DTEXTUREFILTERTYPE
+{
+	D3DTEXF_NONE = 0,
+	D3DTEXF_POINT = 1,
+	D3DTEXF_LINEAR = 2,
+	D3DTEXF_ANISOTROPIC = 3,
+	D3DTEXF_FORCE_DWORD = 0x7fffffff,
+};
+
+enum D3DTEXTUREADDRESS
+{
+	D3DTADDRESS_WRAP = 1,
+	D3DTADDRESS_MIRROR = 2,
+	D3DTADDRESS_CLAMP = 3,
+	D3DTADDRESS_BORDER = 4,
+	D3DTADDRESS_FORCE_DWORD = 0x7fffffff,
+};
+
+//-----------------------------------------------------------------------------
+// Clear() 플래그
+//-----------------------------------------------------------------------------
+#define D3DCLEAR_TARGET			0x00000001L
+#define D3DCLEAR_ZBUFFER		0x00000002L
+#define D3DCLEAR_STENCIL		0x00000004L
+
+//-----------------------------------------------------------------------------
+// FVF(Flexible Vertex Format)
+//-----------------------------------------------------------------------------
+#define D3DFVF_RESERVED0		0x001
+#define D3DFVF_POSITION_MASK	0x400E
+#define D3DFVF_XYZ				0x002
+#define D3DFVF_XYZRHW			0x004
+#define D3DFVF_XYZB1			0x006
+#define D3DFVF_XYZB2			0x008
+#define D3DFVF_XYZB3			0x00a
+#define D3DFVF_XYZB4			0x00c
+#define D3DFVF_XYZB5			0x00e
+#define D3DFVF_XYZW				0x4002
+#define D3DFVF_NORMAL			0x010
+#define D3DFVF_PSIZE			0x020
+#define D3DFVF_DIFFUSE			0x040
+#define D3DFVF_SPECULAR			0x080
+#define D3DFVF_TEXCOUNT_MASK	0xf00
+#define D3DFVF_TEXCOUNT_SHIFT	8
+#define D3DFVF_TEX0				0x000
+#define D3DFVF_TEX1				0x100
+#define D3DFVF_TEX2				0x200
+#define D3DFVF_TEX3				0x300
+#define D3DFVF_TEX4				0x400
+
+#define D3DFVF_TEXTUREFORMAT2	0
+#define D3DFVF_TEXTUREFORMAT1	3
+#define D3DFVF_TEXTUREFORMAT3	1
+#define D3DFVF_TEXTUREFORMAT4	2
+
+#define D3DFVF_TEXCOORDSIZE3(CoordIndex)	(D3DFVF_TEXTUREFORMAT3 << (CoordIndex * 2 + 16))
+#define D3DFVF_TEXCOORDSIZE2(CoordIndex)	(D3DFVF_TEXTUREFORMAT2)
+#define D3DFVF_TEXCOORDSIZE4(CoordIndex)	(D3DFVF_TEXTUREFORMAT4 << (CoordIndex * 2 + 16))
+#define D3DFVF_TEXCOORDSIZE1(CoordIndex)	(D3DFVF_TEXTUREFORMAT1 << (CoordIndex * 2 + 16))
+
+#endif
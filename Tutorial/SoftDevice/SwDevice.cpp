@@ -0,0 +1,1287 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwDevice.cpp
+//
+// 설명:	소프트웨어 디바이스 구현.
+//		드로우 호출은 다음 순서로 처리된다.
+//		1. 정점 단계: 사용되는 정점 범위를 묶음으로 나누어 병렬로 변환, 광원 처리
+//		2. 삼각형 설정: 삼각형을 묶음으로 나누어 병렬로 클리핑, 컬링, 설정하고
+//		   같은 작업 안에서 그 묶음의 삼각형을 화면 타일별로 분류한다.
+//		3. 래스터화(FlushTiles): 타일마다 한 작업자가 자기 타일에 분류된 삼각형을 묶음 순서대로 그린다.
+//		   타일이 겹치지 않으므로 후면 버퍼와 Z 버퍼에 잠금이 필요 없다.
+//		래스터화는 장면 단위로 미루어 두므로 작은 드로우 호출이 많아도 모든 코어가 일한다.
+//-----------------------------------------------------------------------------
+#include "SwDevice.h"
+#include "SwCapture.h"
+#include "SwFVFVertex.h"
+#include "SwHiZ.h"
+#include "SwMath.h"
+#include "SwPixelStage.h"
+#include "SwThreadPool.h"
+#include "SwTrace.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define SW_VERTEX_BATCH		256		// 정점 단계 작업 하나가 처리하는 정점 수
+#define SW_SETUP_BATCH		1024	// 삼각형 설정 작업 하나가 처리하는 삼각형 수
+#define SW_BAND_HEIGHT		32		// Clear() 작업 하나가 맡는 화면 띠의 높이
+
+// 분류해 둔 삼각형이 이보다 많아지면 장면 중간이라도 래스터화한다(SW_TRIANGLE 하나는 약 200바이트).
+#define SW_MAX_BINNED_TRIANGLES		(1 << 18)
+
+//-----------------------------------------------------------------------------
+// 디바이스 생성
+//-----------------------------------------------------------------------------
+HRESULT SwCreateDevice(const SW_PRESENT_PARAMETERS* pPresentationParameters, CSwDevice** ppDevice)
+{
+	if (pPresentationParameters == NULL || ppDevice == NULL)
+		return D3DERR_INVALIDCALL;
+	if (pPresentationParameters->BackBufferWidth == 0 || pPresentationParameters->BackBufferHeight == 0)
+		return D3DERR_INVALIDCALL;
+
+	*ppDevice = new CSwDevice(pPresentationParameters);
+	return S_OK;
+}
+
+CSwDevice::CSwDevice(const SW_PRESENT_PARAMETERS* pPP)
+	: m_nRef(1)
+	, m_nWidth(pPP->BackBufferWidth)
+	, m_nHeight(pPP->BackBufferHeight)
+	, m_bInScene(FALSE)
+	, m_pThreadPool(new CSwThreadPool(pPP->NumThreads))
+	, m_pCapture(NULL)
+	, m_pStreamSource(NULL)
+	, m_nStreamOffset(0)
+	, m_nStreamStride(0)
+	, m_dwFVF(0)
+	, m_bVertexQuant(FALSE)
+	, m_pfnVertexKernel(NULL)
+	, m_pIndices(NULL)
+	, m_nDrawStatesUsed(0)
+	, m_pLastDrawState(NULL)
+	, m_bDrawStateDirty(TRUE)
+	, m_nBinChunksUsed(0)
+	, m_nBinnedTriangles(0)
+{
+	size_t nPixels = (size_t)m_nWidth * m_nHeight;
+	m_BackBuffer.resize(nPixels, 0);
+	m_FrontBuffer.resize(nPixels, 0);
+	if (pPP->EnableAutoDepthStencil)
+	{
+		SW_HIZBLOCK initial = { 1.0f, 1.0f };
+		m_DepthBuffer.resize(nPixels, 1.0f);
+		m_HiZ.resize((size_t)SwGetHiZPitch(m_nWidth) * SwGetHiZRows(m_nHeight), initial);
+	}
+
+	SwInitTileGrid(m_nWidth, m_nHeight, &m_TileGrid);
+
+	ZeroMemory(m_pTextures, sizeof(m_pTextures));
+	ZeroMemory(&m_FrameStats, sizeof(m_FrameStats));
+	ZeroMemory(&m_LastFrameStats, sizeof(m_LastFrameStats));
+	SetDefaultStates();
+}
+
+CSwDevice::~CSwDevice()
+{
+	ReleaseDrawStates();
+	for (UINT i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+	{
+		if (m_pTextures[i])
+			m_pTextures[i]->Release();
+	}
+	if (m_pStreamSource)
+		m_pStreamSource->Release();
+	if (m_pIndices)
+		m_pIndices->Release();
+}
+
+UINT CSwDevice::AddRef()
+{
+	return ++m_nRef;
+}
+
+UINT CSwDevice::Release()
+{
+	UINT nRef = --m_nRef;
+	if (nRef == 0)
+		delete this;
+	return nRef;
+}
+
+UINT CSwDevice::GetNumThreads() const
+{
+	return m_pThreadPool->GetNumThreads();
+}
+
+//-----------------------------------------------------------------------------
+// D3D9 디바이스의 기본 상태
+//-----------------------------------------------------------------------------
+VOID CSwDevice::SetDefaultStates()
+{
+	SwMatrixIdentity(&m_matWorld);
+	SwMatrixIdentity(&m_matView);
+	SwMatrixIdentity(&m_matProj);
+
+	ZeroMemory(m_RenderStates, sizeof(m_RenderStates));
+	m_RenderStates[D3DRS_ZENABLE] = m_DepthBuffer.empty() ? D3DZB_FALSE : D3DZB_TRUE;
+	m_RenderStates[D3DRS_FILLMODE] = 3;			// D3DFILL_SOLID
+	m_RenderStates[D3DRS_SHADEMODE] = 2;		// D3DSHADE_GOURAUD
+	m_RenderStates[D3DRS_ZWRITEENABLE] = TRUE;
+	m_RenderStates[D3DRS_CULLMODE] = D3DCULL_CCW;
+	m_RenderStates[D3DRS_ZFUNC] = D3DCMP_LESSEQUAL;
+	m_RenderStates[D3DRS_TEXTUREFACTOR] = 0xffffffff;
+	m_RenderStates[D3DRS_LIGHTING] = TRUE;
+	m_RenderStates[D3DRS_AMBIENT] = 0;
+	m_RenderStates[D3DRS_COLORVERTEX] = TRUE;
+	m_RenderStates[D3DRS_DIFFUSEMATERIALSOURCE] = D3DMCS_COLOR1;
+	m_RenderStates[D3DRS_SPECULARMATERIALSOURCE] = D3DMCS_COLOR2;
+	m_RenderStates[D3DRS_AMBIENTMATERIALSOURCE] = D3DMCS_MATERIAL;
+	m_RenderStates[D3DRS_EMISSIVEMATERIALSOURCE] = D3DMCS_MATERIAL;
+
+	ZeroMemory(m_StageStates, sizeof(m_StageStates));
+	ZeroMemory(m_SamplerStates, sizeof(m_SamplerStates));
+	for (DWORD i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+	{
+		m_StageStates[i][D3DTSS_COLOROP] = (i == 0) ? D3DTOP_MODULATE : D3DTOP_DISABLE;
+		m_StageStates[i][D3DTSS_COLORARG1] = D3DTA_TEXTURE;
+		m_StageStates[i][D3DTSS_COLORARG2] = D3DTA_CURRENT;
+		m_StageStates[i][D3DTSS_ALPHAOP] = (i == 0) ? D3DTOP_SELECTARG1 : D3DTOP_DISABLE;
+		m_StageStates[i][D3DTSS_ALPHAARG1] = D3DTA_TEXTURE;
+		m_StageStates[i][D3DTSS_ALPHAARG2] = D3DTA_CURRENT;
+		m_StageStates[i][D3DTSS_TEXCOORDINDEX] = i;
+
+		m_SamplerStates[i][D3DSAMP_ADDRESSU] = D3DTADDRESS_WRAP;
+		m_SamplerStates[i][D3DSAMP_ADDRESSV] = D3DTADDRESS_WRAP;
+		m_SamplerStates[i][D3DSAMP_ADDRESSW] = D3DTADDRESS_WRAP;
+		m_SamplerStates[i][D3DSAMP_MAGFILTER] = D3DTEXF_POINT;
+		m_SamplerStates[i][D3DSAMP_MINFILTER] = D3DTEXF_POINT;
+		m_SamplerStates[i][D3DSAMP_MIPFILTER] = D3DTEXF_NONE;
+		m_SamplerStates[i][D3DSAMP_MAXANISOTROPY] = 1;
+	}
+
+	ZeroMemory(&m_Material, sizeof(m_Material));
+	ZeroMemory(m_Lights, sizeof(m_Lights));
+	ZeroMemory(m_bLightEnable, sizeof(m_bLightEnable));
+}
+
+//-----------------------------------------------------------------------------
+// 자원 생성
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::CreateVertexBuffer(UINT Length, DWORD, DWORD FVF, D3DPOOL,
+	CSwVertexBuffer** ppVertexBuffer, void*)
+{
+	if (ppVertexBuffer == NULL || Length == 0)
+		return D3DERR_INVALIDCALL;
+
+	*ppVertexBuffer = new CSwVertexBuffer(Length, FVF);
+	return S_OK;
+}
+
+HRESULT CSwDevice::CreateIndexBuffer(UINT Length, DWORD, D3DFORMAT Format, D3DPOOL,
+	CSwIndexBuffer** ppIndexBuffer, void*)
+{
+	if (ppIndexBuffer == NULL || Length == 0 ||
+		(Format != D3DFMT_INDEX16 && Format != D3DFMT_INDEX32))
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	*ppIndexBuffer = new CSwIndexBuffer(Length, Format);
+	return S_OK;
+}
+
+HRESULT CSwDevice::CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD, D3DFORMAT Format,
+	D3DPOOL, CSwTexture** ppTexture, void*)
+{
+	if (ppTexture == NULL || Width == 0 || Height == 0)
+		return D3DERR_INVALIDCALL;
+	if (Format != D3DFMT_A8R8G8B8 && Format != D3DFMT_X8R8G8B8 &&
+		Format != D3DFMT_DXT1 && Format != D3DFMT_DXT5)
+	{
+		return D3DERR_NOTAVAILABLE;
+	}
+
+	*ppTexture = new CSwTexture(Width, Height, Levels, Format);
+	return S_OK;
+}
+
+HRESULT CSwDevice::CreateCommandList(CSwCommandList** ppCommandList)
+{
+	if (ppCommandList == NULL)
+		return D3DERR_INVALIDCALL;
+
+	*ppCommandList = new CSwCommandList;
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 장면
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::Clear(DWORD Count, const D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil)
+{
+	if (m_pCapture)
+	{
+		SW_CAPARGS_CLEAR args = { pRects ? Count : 0, Flags, Color, Z, Stencil };
+		m_pCapture->Record(SW_CAP_CLEAR, &args, sizeof(args), pRects, args.dwCount * sizeof(D3DRECT));
+	}
+
+	SW_TRACE_SCOPE("SwDevice::Clear");
+
+	// 먼저 그린 삼각형이 지워지는 내용 아래에 있어야 한다.
+	FlushTiles();
+
+	const bool bTarget = (Flags & D3DCLEAR_TARGET) != 0;
+	const bool bDepth = (Flags & D3DCLEAR_ZBUFFER) != 0 && !m_DepthBuffer.empty();
+
+	// 사각형이 없으면 전체 화면을 지운다.
+	D3DRECT full = { 0, 0, (LONG)m_nWidth, (LONG)m_nHeight };
+	if (Count == 0 || pRects == NULL)
+	{
+		Count = 1;
+		pRects = &full;
+	}
+
+	SW_RENDERTARGET rt;
+	GetRenderTarget(&rt);
+
+	// 띠의 높이가 Hi-Z 블록의 배수이므로 블록도 띠 하나에만 속한다.
+	const UINT nBands = (m_nHeight + SW_BAND_HEIGHT - 1) / SW_BAND_HEIGHT;
+	m_pThreadPool->ParallelFor(nBands, [&](UINT nBand, UINT)
+	{
+		LONG nBandTop = (LONG)(nBand * SW_BAND_HEIGHT);
+		LONG nBandBottom = std::min<LONG>(nBandTop + SW_BAND_HEIGHT, (LONG)m_nHeight);
+
+		for (DWORD r = 0; r < Count; ++r)
+		{
+			LONG x1 = std::max<LONG>(pRects[r].x1, 0);
+			LONG x2 = std::min<LONG>(pRects[r].x2, (LONG)m_nWidth);
+			LONG y1 = std::max<LONG>(pRects[r].y1, nBandTop);
+			LONG y2 = std::min<LONG>(pRects[r].y2, nBandBottom);
+			if (x1 >= x2)
+				continue;
+
+			for (LONG y = y1; y < y2; ++y)
+			{
+				size_t nRow = (size_t)y * m_nWidth;
+				if (bTarget)
+					std::fill(m_BackBuffer.begin() + nRow + x1, m_BackBuffer.begin() + nRow + x2, (DWORD)Color);
+				if (bDepth)
+					std::fill(m_DepthBuffer.begin() + nRow + x1, m_DepthBuffer.begin() + nRow + x2, Z);
+			}
+			if (bDepth)
+				SwClearHiZ(&rt, x1, y1, x2, y2, Z);
+		}
+	});
+
+	return S_OK;
+}
+
+HRESULT CSwDevice::BeginScene()
+{
+	if (m_bInScene)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pCapture)
+		m_pCapture->Record(SW_CAP_BEGINSCENE, NULL, 0);
+	m_bInScene = TRUE;
+	return S_OK;
+}
+
+HRESULT CSwDevice::EndScene()
+{
+	if (!m_bInScene)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pCapture)
+		m_pCapture->Record(SW_CAP_ENDSCENE, NULL, 0);
+	FlushTiles();
+	m_bInScene = FALSE;
+	return S_OK;
+}
+
+HRESULT CSwDevice::Present(const void*, const void*, void*, const void*)
+{
+	if (m_pCapture)
+		m_pCapture->Record(SW_CAP_PRESENT, NULL, 0);
+
+	// D3DSWAPEFFECT_DISCARD와 같이 후면 버퍼의 내용은 보존되지 않는다.
+	m_BackBuffer.swap(m_FrontBuffer);
+
+	m_LastFrameStats = m_FrameStats;
+	ZeroMemory(&m_FrameStats, sizeof(m_FrameStats));
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 상태
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::SetTransform(D3DTRANSFORMSTATETYPE State, const D3DMATRIX* pMatrix)
+{
+	if (pMatrix == NULL || (DWORD)State > 0xffff)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordTransform(State, pMatrix);
+	else
+		ChangeTransform(State, pMatrix);
+	return S_OK;
+}
+
+HRESULT CSwDevice::GetTransform(D3DTRANSFORMSTATETYPE State, D3DMATRIX* pMatrix)
+{
+	if (pMatrix == NULL)
+		return D3DERR_INVALIDCALL;
+
+	switch ((DWORD)State)
+	{
+	case D3DTS_WORLD:		*pMatrix = m_matWorld;	break;
+	case D3DTS_VIEW:		*pMatrix = m_matView;	break;
+	case D3DTS_PROJECTION:	*pMatrix = m_matProj;	break;
+	default:				SwMatrixIdentity(pMatrix);	break;
+	}
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
+{
+	if ((DWORD)State >= SW_NUM_RENDERSTATES)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->Record(SW_STATEKEY(SW_STATE_RENDER, 0, State), Value);
+	else
+		ChangeRenderState(State, Value);
+	return S_OK;
+}
+
+HRESULT CSwDevice::GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue)
+{
+	if ((DWORD)State >= SW_NUM_RENDERSTATES || pValue == NULL)
+		return D3DERR_INVALIDCALL;
+
+	*pValue = m_RenderStates[State];
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value)
+{
+	if (Stage >= SW_MAX_TEXTURE_STAGES || (DWORD)Type >= SW_NUM_STAGESTATES)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->Record(SW_STATEKEY(SW_STATE_STAGE, Stage, Type), Value);
+	else
+		ChangeStageState(Stage, Type, Value);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value)
+{
+	if (Sampler >= SW_MAX_TEXTURE_STAGES || (DWORD)Type >= SW_NUM_SAMPLERSTATES)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->Record(SW_STATEKEY(SW_STATE_SAMPLER, Sampler, Type), Value);
+	else
+		ChangeSamplerState(Sampler, Type, Value);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetTexture(DWORD Stage, CSwTexture* pTexture)
+{
+	if (Stage >= SW_MAX_TEXTURE_STAGES)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordTexture(Stage, pTexture);
+	else
+		ChangeTexture(Stage, pTexture);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetMaterial(const D3DMATERIAL9* pMaterial)
+{
+	if (pMaterial == NULL)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordMaterial(pMaterial);
+	else
+		ChangeMaterial(pMaterial);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetLight(DWORD Index, const D3DLIGHT9* pLight)
+{
+	if (Index >= SW_MAX_LIGHTS || pLight == NULL)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->RecordLight(Index, pLight);
+	else
+		ChangeLight(Index, pLight);
+	return S_OK;
+}
+
+HRESULT CSwDevice::LightEnable(DWORD Index, BOOL Enable)
+{
+	if (Index >= SW_MAX_LIGHTS)
+		return D3DERR_INVALIDCALL;
+
+	if (m_pRecorder)
+		m_pRecorder->Record(SW_STATEKEY(SW_STATE_LIGHTENABLE, 0, Index), (DWORD)Enable);
+	else
+		ChangeLightEnable(Index, Enable);
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 그림자 상태
+// 값이 같은 설정은 버린다. 픽셀 처리 상태(SW_DRAWSTATE)에 들어가는 값이 바뀌었을 때만
+// 다음 드로우에서 그 상태를 다시 만든다. 재질은 정점 단계에서만 쓰므로 여기에 해당하지 않는다.
+// 캡처는 버리기 전에 기록한다. 재생에서도 같은 호출이 같은 수만큼 버려져야 통계가 맞는다.
+//-----------------------------------------------------------------------------
+VOID CSwDevice::ChangeRenderState(DWORD dwType, DWORD dwValue)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_STATE args = { 0, dwType, dwValue };
+		m_pCapture->Record(SW_CAP_SETRENDERSTATE, args);
+	}
+	ChangeState(&m_RenderStates[dwType], dwValue);
+}
+
+VOID CSwDevice::ChangeStageState(DWORD dwStage, DWORD dwType, DWORD dwValue)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_STATE args = { dwStage, dwType, dwValue };
+		m_pCapture->Record(SW_CAP_SETTEXTURESTAGESTATE, args);
+	}
+	ChangeState(&m_StageStates[dwStage][dwType], dwValue);
+}
+
+VOID CSwDevice::ChangeSamplerState(DWORD dwStage, DWORD dwType, DWORD dwValue)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_STATE args = { dwStage, dwType, dwValue };
+		m_pCapture->Record(SW_CAP_SETSAMPLERSTATE, args);
+	}
+	ChangeState(&m_SamplerStates[dwStage][dwType], dwValue);
+}
+
+VOID CSwDevice::ChangeState(DWORD* pSlot, DWORD dwValue)
+{
+	++m_FrameStats.nStateCalls;
+	if (*pSlot == dwValue)
+	{
+		++m_FrameStats.nStateCallsFiltered;
+		return;
+	}
+	*pSlot = dwValue;
+	m_bDrawStateDirty = TRUE;
+}
+
+VOID CSwDevice::ChangeTexture(DWORD dwStage, CSwTexture* pTexture)
+{
+	if (m_pCapture)
+	{
+		SW_CAPARGS_BIND args = { dwStage, m_pCapture->GetResourceId(pTexture) };
+		m_pCapture->Record(SW_CAP_SETTEXTURE, args);
+	}
+	++m_FrameStats.nStateCalls;
+	if (m_pTextures[dwStage] == pTexture)
+	{
+		++m_FrameStats.nStateCallsFiltered;
+		return;
+	}
+	if (pTexture)
+		pTexture->AddRef();
+	if (m_pTextures[dwStage])
+		m_pTextures[dwStage]->Release();
+	m_pTextures[dwStage] = pTexture;
+	m_bDrawStateDirty = TRUE;
+}
+
+VOID CSwDevice::ChangeMaterial(const D3DMATERIAL9* pMaterial)
+{
+	if (m_pCapture)
+		m_pCapture->Record(SW_CAP_SETMATERIAL, *pMaterial);
+	++m_FrameStats.nStateCalls;
+	if (memcmp(&m_Material, pMaterial, sizeof(D3DMATERIAL9)) == 0)
+		++m_FrameStats.nStateCallsFiltered;
+	else
+		m_Material = *pMaterial;
+}
+
+VOID CSwDevice::ChangeTransform(DWORD dwState, const D3DMATRIX* pMatrix)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_TRANSFORM args = { dwState, *pMatrix };
+		m_pCapture->Record(SW_CAP_SETTRANSFORM, args);
+	}
+	D3DMATRIX* pSlot;
+	switch (dwState)
+	{
+	case D3DTS_WORLD:		pSlot = &m_matWorld;	break;
+	case D3DTS_VIEW:		pSlot = &m_matView;		break;
+	case D3DTS_PROJECTION:	pSlot = &m_matProj;		break;
+	default:				return;					// 텍스처 행렬은 지원하지 않는다
+	}
+	++m_FrameStats.nStateCalls;
+	if (memcmp(pSlot, pMatrix, sizeof(D3DMATRIX)) == 0)
+		++m_FrameStats.nStateCallsFiltered;
+	else
+		*pSlot = *pMatrix;
+}
+
+VOID CSwDevice::ChangeLight(DWORD dwIndex, const D3DLIGHT9* pLight)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_LIGHT args = { dwIndex, *pLight };
+		m_pCapture->Record(SW_CAP_SETLIGHT, args);
+	}
+	++m_FrameStats.nStateCalls;
+	if (memcmp(&m_Lights[dwIndex], pLight, sizeof(D3DLIGHT9)) == 0)
+		++m_FrameStats.nStateCallsFiltered;
+	else
+		m_Lights[dwIndex] = *pLight;
+}
+
+VOID CSwDevice::ChangeLightEnable(DWORD dwIndex, BOOL bEnable)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_LIGHTENABLE args = { dwIndex, bEnable };
+		m_pCapture->Record(SW_CAP_LIGHTENABLE, args);
+	}
+	++m_FrameStats.nStateCalls;
+	if (m_bLightEnable[dwIndex] == bEnable)
+		++m_FrameStats.nStateCallsFiltered;
+	else
+		m_bLightEnable[dwIndex] = bEnable;
+}
+
+//-----------------------------------------------------------------------------
+// 상태 블록
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::BeginStateBlock()
+{
+	if (m_pRecorder)
+		return D3DERR_INVALIDCALL;
+
+	m_pRecorder.reset(new CSwStateRecorder);
+	return S_OK;
+}
+
+HRESULT CSwDevice::EndStateBlock(CSwStateBlock** ppSB)
+{
+	if (!m_pRecorder || ppSB == NULL)
+		return D3DERR_INVALIDCALL;
+
+	*ppSB = new CSwStateBlock(this, m_pRecorder.get());
+	m_pRecorder.reset();
+	return S_OK;
+}
+
+HRESULT CSwDevice::ApplyStateBlock(const CSwStateBlock* pBlock)
+{
+	// 기록 중에는 블록을 다른 블록에 넣지 않는다.
+	if (m_pRecorder)
+		return D3DERR_INVALIDCALL;
+
+	// 항목은 기록할 때 범위를 검사했다.
+	const SW_STATECHANGE* pChanges = pBlock->GetChanges();
+	for (UINT i = 0; i < pBlock->GetNumChanges(); ++i)
+	{
+		const DWORD dwKey = pChanges[i].dwKey;
+		const DWORD dwStage = SW_STATEKEY_STAGE(dwKey);
+		const DWORD dwType = SW_STATEKEY_TYPE(dwKey);
+		switch (SW_STATEKEY_KIND(dwKey))
+		{
+		case SW_STATE_RENDER:		ChangeRenderState(dwType, pChanges[i].dwValue);						break;
+		case SW_STATE_STAGE:		ChangeStageState(dwStage, dwType, pChanges[i].dwValue);				break;
+		case SW_STATE_SAMPLER:		ChangeSamplerState(dwStage, dwType, pChanges[i].dwValue);			break;
+		case SW_STATE_TEXTURE:		ChangeTexture(dwStage, pBlock->GetTexture(pChanges[i].dwValue));	break;
+		case SW_STATE_MATERIAL:		ChangeMaterial(&pBlock->GetMaterial());								break;
+		case SW_STATE_TRANSFORM:	ChangeTransform(dwType, &pBlock->GetMatrix(pChanges[i].dwValue));	break;
+		case SW_STATE_LIGHT:		ChangeLight(dwType, &pBlock->GetLight(pChanges[i].dwValue));		break;
+		case SW_STATE_LIGHTENABLE:	ChangeLightEnable(dwType, (BOOL)pChanges[i].dwValue);				break;
+		}
+	}
+	++m_FrameStats.nStateBlocksApplied;
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 입력
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::SetStreamSource(UINT StreamNumber, CSwVertexBuffer* pStreamData, UINT OffsetInBytes, UINT Stride)
+{
+	// 예제들은 0번 스트림 하나만 사용한다.
+	if (StreamNumber != 0)
+		return D3DERR_INVALIDCALL;
+
+	ChangeStreamSource(pStreamData, OffsetInBytes, Stride);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetFVF(DWORD FVF)
+{
+	ChangeFVF(FVF);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetVertexQuant(const SW_VERTEXQUANT* pQuant)
+{
+	ChangeVertexQuant(pQuant);
+	return S_OK;
+}
+
+HRESULT CSwDevice::SetIndices(CSwIndexBuffer* pIndexData)
+{
+	ChangeIndices(pIndexData);
+	return S_OK;
+}
+
+VOID CSwDevice::ChangeStreamSource(CSwVertexBuffer* pStreamData, UINT nOffset, UINT nStride)
+{
+	if (m_pCapture)
+	{
+		SW_CAPARGS_STREAMSOURCE args = { m_pCapture->GetResourceId(pStreamData), nOffset, nStride };
+		m_pCapture->Record(SW_CAP_SETSTREAMSOURCE, args);
+	}
+	if (pStreamData)
+		pStreamData->AddRef();
+	if (m_pStreamSource)
+		m_pStreamSource->Release();
+	m_pStreamSource = pStreamData;
+	m_nStreamOffset = nOffset;
+	m_nStreamStride = nStride;
+}
+
+VOID CSwDevice::ChangeFVF(DWORD dwFVF)
+{
+	if (m_pCapture)
+		m_pCapture->Record(SW_CAP_SETFVF, dwFVF);
+	m_dwFVF = dwFVF;
+	m_pfnVertexKernel = SwGetVertexKernel(dwFVF);
+}
+
+VOID CSwDevice::ChangeVertexQuant(const SW_VERTEXQUANT* pQuant)
+{
+	if (m_pCapture)
+	{
+		SW_CMDARGS_VERTEXQUANT args;
+		ZeroMemory(&args, sizeof(args));
+		args.bEnable = (pQuant != NULL);
+		if (pQuant)
+			args.Quant = *pQuant;
+		m_pCapture->Record(SW_CAP_SETVERTEXQUANT, args);
+	}
+	m_bVertexQuant = (pQuant != NULL);
+	if (pQuant)
+		m_VertexQuant = *pQuant;
+}
+
+VOID CSwDevice::ChangeIndices(CSwIndexBuffer* pIndexData)
+{
+	if (m_pCapture)
+	{
+		SW_CAPARGS_BIND args = { 0, m_pCapture->GetResourceId(pIndexData) };
+		m_pCapture->Record(SW_CAP_SETINDICES, args);
+	}
+	if (pIndexData)
+		pIndexData->AddRef();
+	if (m_pIndices)
+		m_pIndices->Release();
+	m_pIndices = pIndexData;
+}
+
+//-----------------------------------------------------------------------------
+// 그리기
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount)
+{
+	return DrawTriangles(PrimitiveType, PrimitiveCount, 0, 0, 0, NULL, 0, StartVertex);
+}
+
+HRESULT CSwDevice::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex,
+	UINT NumVertices, UINT startIndex, UINT primCount)
+{
+	UINT nIndexSize;
+	const BYTE* pIndices = LocateIndices(startIndex, &nIndexSize);
+	if (pIndices == NULL)
+		return D3DERR_INVALIDCALL;
+
+	return DrawTriangles(PrimitiveType, primCount, BaseVertexIndex, MinVertexIndex, NumVertices, pIndices,
+		nIndexSize, 0);
+}
+
+const BYTE* CSwDevice::LocateIndices(UINT nStartIndex, UINT* pIndexSize) const
+{
+	if (m_pIndices == NULL)
+		return NULL;
+
+	*pIndexSize = (m_pIndices->GetFormat() == D3DFMT_INDEX32) ? 4 : 2;
+	if ((size_t)nStartIndex * *pIndexSize > m_pIndices->GetLength())
+		return NULL;
+	return m_pIndices->GetData() + (size_t)nStartIndex * *pIndexSize;
+}
+
+//-----------------------------------------------------------------------------
+// 명령 목록
+//-----------------------------------------------------------------------------
+template<typename ARGS>
+static inline ARGS ReadCommandArgs(const BYTE* pCommand)
+{
+	ARGS args;
+	memcpy(&args, pCommand + sizeof(SW_CMDHEADER), sizeof(ARGS));
+	return args;
+}
+
+HRESULT CSwDevice::ExecuteCommandList(CSwCommandList* pCommandList)
+{
+	if (pCommandList == NULL || !pCommandList->IsClosed() || m_pRecorder)
+		return D3DERR_INVALIDCALL;
+
+	// 인자는 기록할 때 검사했으므로 내부 함수로 상태를 바로 바꾼다.
+	// 그리기는 묶여 있는 자원에 따라 달라지므로 DrawTriangles()가 실행할 때 다시 검사한다.
+	const BYTE* pCommand = pCommandList->GetData();
+	const BYTE* pEnd = pCommand + pCommandList->GetSize();
+	HRESULT hr = S_OK;
+	for (; pCommand < pEnd && SUCCEEDED(hr); pCommand += ((const SW_CMDHEADER*)pCommand)->wSize)
+	{
+		switch (((const SW_CMDHEADER*)pCommand)->wCommand)
+		{
+		case SW_CMD_SETTRANSFORM:
+		{
+			const SW_CMDARGS_TRANSFORM args = ReadCommandArgs<SW_CMDARGS_TRANSFORM>(pCommand);
+			ChangeTransform(args.dwState, &args.Matrix);
+			break;
+		}
+		case SW_CMD_SETRENDERSTATE:
+		{
+			const SW_CMDARGS_STATE args = ReadCommandArgs<SW_CMDARGS_STATE>(pCommand);
+			ChangeRenderState(args.dwType, args.dwValue);
+			break;
+		}
+		case SW_CMD_SETTEXTURESTAGESTATE:
+		{
+			const SW_CMDARGS_STATE args = ReadCommandArgs<SW_CMDARGS_STATE>(pCommand);
+			ChangeStageState(args.dwStage, args.dwType, args.dwValue);
+			break;
+		}
+		case SW_CMD_SETSAMPLERSTATE:
+		{
+			const SW_CMDARGS_STATE args = ReadCommandArgs<SW_CMDARGS_STATE>(pCommand);
+			ChangeSamplerState(args.dwStage, args.dwType, args.dwValue);
+			break;
+		}
+		case SW_CMD_SETTEXTURE:
+		{
+			const SW_CMDARGS_TEXTURE args = ReadCommandArgs<SW_CMDARGS_TEXTURE>(pCommand);
+			ChangeTexture(args.dwStage, args.pTexture);
+			break;
+		}
+		case SW_CMD_SETMATERIAL:
+		{
+			const D3DMATERIAL9 material = ReadCommandArgs<D3DMATERIAL9>(pCommand);
+			ChangeMaterial(&material);
+			break;
+		}
+		case SW_CMD_SETLIGHT:
+		{
+			const SW_CMDARGS_LIGHT args = ReadCommandArgs<SW_CMDARGS_LIGHT>(pCommand);
+			ChangeLight(args.dwIndex, &args.Light);
+			break;
+		}
+		case SW_CMD_LIGHTENABLE:
+		{
+			const SW_CMDARGS_LIGHTENABLE args = ReadCommandArgs<SW_CMDARGS_LIGHTENABLE>(pCommand);
+			ChangeLightEnable(args.dwIndex, args.bEnable);
+			break;
+		}
+		case SW_CMD_APPLYSTATEBLOCK:
+			hr = ApplyStateBlock(ReadCommandArgs<CSwStateBlock*>(pCommand));
+			break;
+		case SW_CMD_SETSTREAMSOURCE:
+		{
+			const SW_CMDARGS_STREAMSOURCE args = ReadCommandArgs<SW_CMDARGS_STREAMSOURCE>(pCommand);
+			ChangeStreamSource(args.pVB, args.nOffset, args.nStride);
+			break;
+		}
+		case SW_CMD_SETFVF:
+		{
+			const DWORD dwFVF = ReadCommandArgs<DWORD>(pCommand);
+			if (dwFVF != m_dwFVF)
+				ChangeFVF(dwFVF);
+			break;
+		}
+		case SW_CMD_SETVERTEXQUANT:
+		{
+			const SW_CMDARGS_VERTEXQUANT args = ReadCommandArgs<SW_CMDARGS_VERTEXQUANT>(pCommand);
+			ChangeVertexQuant(args.bEnable ? &args.Quant : NULL);
+			break;
+		}
+		case SW_CMD_SETINDICES:
+			ChangeIndices(ReadCommandArgs<CSwIndexBuffer*>(pCommand));
+			break;
+		case SW_CMD_DRAWPRIMITIVE:
+		{
+			const SW_CMDARGS_DRAW args = ReadCommandArgs<SW_CMDARGS_DRAW>(pCommand);
+			hr = DrawTriangles((D3DPRIMITIVETYPE)args.dwType, args.nPrimitiveCount, 0, 0, 0, NULL, 0,
+				args.nStartVertex);
+			break;
+		}
+		case SW_CMD_DRAWINDEXEDPRIMITIVE:
+		{
+			const SW_CMDARGS_DRAWINDEXED args = ReadCommandArgs<SW_CMDARGS_DRAWINDEXED>(pCommand);
+			// 색인 버퍼는 실행할 때 묶여 있는 것을 쓰므로 여기서 찾는다.
+			UINT nIndexSize;
+			const BYTE* pIndices = LocateIndices(args.nStartIndex, &nIndexSize);
+			hr = pIndices ? DrawTriangles((D3DPRIMITIVETYPE)args.dwType, args.nPrimitiveCount, args.nBaseVertex,
+				args.nMinVertex, args.nNumVertices, pIndices, nIndexSize, 0) : D3DERR_INVALIDCALL;
+			break;
+		}
+		default:
+			hr = D3DERR_INVALIDCALL;
+			break;
+		}
+	}
+
+	++m_FrameStats.nCommandListsExecuted;
+	return hr;
+}
+
+//-----------------------------------------------------------------------------
+// 캡처
+//-----------------------------------------------------------------------------
+HRESULT CSwDevice::SetCapture(CSwCaptureWriter* pCapture)
+{
+	m_pCapture = pCapture;
+	if (m_pCapture)
+		CaptureDeviceState();
+	return S_OK;
+}
+
+// 재생 디바이스는 기본 상태로 시작하므로 캡처를 붙인 시점의 상태를 모두 기록한다.
+// 그림자 상태를 거치지 않으므로 통계에 세지 않는다.
+VOID CSwDevice::CaptureDeviceState()
+{
+	SW_CAPARGS_DEVICE device = { m_nWidth, m_nHeight, !m_DepthBuffer.empty() };
+	m_pCapture->Record(SW_CAP_DEVICE, device);
+
+	const D3DMATRIX* pMatrices[3] = { &m_matWorld, &m_matView, &m_matProj };
+	const DWORD dwTransforms[3] = { D3DTS_WORLD, D3DTS_VIEW, D3DTS_PROJECTION };
+	for (UINT i = 0; i < 3; ++i)
+	{
+		SW_CMDARGS_TRANSFORM args = { dwTransforms[i], *pMatrices[i] };
+		m_pCapture->Record(SW_CAP_SETTRANSFORM, args);
+	}
+
+	for (DWORD dwType = 0; dwType < SW_NUM_RENDERSTATES; ++dwType)
+	{
+		SW_CMDARGS_STATE args = { 0, dwType, m_RenderStates[dwType] };
+		m_pCapture->Record(SW_CAP_SETRENDERSTATE, args);
+	}
+	for (DWORD dwStage = 0; dwStage < SW_MAX_TEXTURE_STAGES; ++dwStage)
+	{
+		for (DWORD dwType = 0; dwType < SW_NUM_STAGESTATES; ++dwType)
+		{
+			SW_CMDARGS_STATE args = { dwStage, dwType, m_StageStates[dwStage][dwType] };
+			m_pCapture->Record(SW_CAP_SETTEXTURESTAGESTATE, args);
+		}
+		for (DWORD dwType = 0; dwType < SW_NUM_SAMPLERSTATES; ++dwType)
+		{
+			SW_CMDARGS_STATE args = { dwStage, dwType, m_SamplerStates[dwStage][dwType] };
+			m_pCapture->Record(SW_CAP_SETSAMPLERSTATE, args);
+		}
+		SW_CAPARGS_BIND texture = { dwStage, m_pCapture->GetResourceId(m_pTextures[dwStage]) };
+		m_pCapture->Record(SW_CAP_SETTEXTURE, texture);
+	}
+
+	m_pCapture->Record(SW_CAP_SETMATERIAL, m_Material);
+	for (DWORD i = 0; i < SW_MAX_LIGHTS; ++i)
+	{
+		SW_CMDARGS_LIGHT light = { i, m_Lights[i] };
+		m_pCapture->Record(SW_CAP_SETLIGHT, light);
+		SW_CMDARGS_LIGHTENABLE enable = { i, m_bLightEnable[i] };
+		m_pCapture->Record(SW_CAP_LIGHTENABLE, enable);
+	}
+
+	SW_CAPARGS_STREAMSOURCE stream = { m_pCapture->GetResourceId(m_pStreamSource), m_nStreamOffset,
+		m_nStreamStride };
+	m_pCapture->Record(SW_CAP_SETSTREAMSOURCE, stream);
+	m_pCapture->Record(SW_CAP_SETFVF, m_dwFVF);
+	SW_CMDARGS_VERTEXQUANT quant;
+	ZeroMemory(&quant, sizeof(quant));
+	quant.bEnable = m_bVertexQuant;
+	if (m_bVertexQuant)
+		quant.Quant = m_VertexQuant;
+	m_pCapture->Record(SW_CAP_SETVERTEXQUANT, quant);
+	SW_CAPARGS_BIND indices = { 0, m_pCapture->GetResourceId(m_pIndices) };
+	m_pCapture->Record(SW_CAP_SETINDICES, indices);
+
+	if (m_bInScene)
+		m_pCapture->Record(SW_CAP_BEGINSCENE, NULL, 0);
+}
+
+VOID CSwDevice::CaptureBindings(BOOL bIndexed)
+{
+	m_pCapture->SyncResource(m_pStreamSource);
+	if (bIndexed)
+		m_pCapture->SyncResource(m_pIndices);
+	for (UINT i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+		m_pCapture->SyncResource(m_pTextures[i]);
+}
+
+VOID CSwDevice::CaptureDraw(D3DPRIMITIVETYPE PrimitiveType, UINT nPrimitiveCount, INT nBaseVertex,
+	UINT nMinVertex, UINT nNumVertices, const BYTE* pIndices, UINT nIndexSize, UINT nStartVertex)
+{
+	CaptureBindings(pIndices != NULL);
+	if (pIndices)
+	{
+		const UINT nStartIndex = (UINT)((pIndices - m_pIndices->GetData()) / nIndexSize);
+		SW_CMDARGS_DRAWINDEXED args = { (DWORD)PrimitiveType, nBaseVertex, nMinVertex, nNumVertices,
+			nStartIndex, nPrimitiveCount };
+		m_pCapture->Record(SW_CAP_DRAWINDEXEDPRIMITIVE, args);
+	}
+	else
+	{
+		SW_CMDARGS_DRAW args = { (DWORD)PrimitiveType, nStartVertex, nPrimitiveCount };
+		m_pCapture->Record(SW_CAP_DRAWPRIMITIVE, args);
+	}
+}
+
+VOID CSwDevice::BuildVertexState(SW_VERTEXSTATE* pState)
+{
+	D3DMATRIX matWorldView;
+	pState->matWorld = m_matWorld;
+	SwMatrixMultiply(&matWorldView, &m_matWorld, &m_matView);
+	SwMatrixMultiply(&pState->matWorldViewProj, &matWorldView, &m_matProj);
+
+	pState->bLighting = m_RenderStates[D3DRS_LIGHTING];
+	pState->bColorVertex = m_RenderStates[D3DRS_COLORVERTEX];
+	pState->dwDiffuseSource = m_RenderStates[D3DRS_DIFFUSEMATERIALSOURCE];
+	pState->dwAmbientSource = m_RenderStates[D3DRS_AMBIENTMATERIALSOURCE];
+	pState->dwEmissiveSource = m_RenderStates[D3DRS_EMISSIVEMATERIALSOURCE];
+
+	DWORD dwAmbient = m_RenderStates[D3DRS_AMBIENT];
+	pState->Ambient.r = ((dwAmbient >> 16) & 0xff) / 255.0f;
+	pState->Ambient.g = ((dwAmbient >> 8) & 0xff) / 255.0f;
+	pState->Ambient.b = (dwAmbient & 0xff) / 255.0f;
+	pState->Ambient.a = ((dwAmbient >> 24) & 0xff) / 255.0f;
+	pState->Material = m_Material;
+
+	pState->nNumLights = 0;
+	for (UINT i = 0; i < SW_MAX_LIGHTS; ++i)
+	{
+		if (m_bLightEnable[i])
+			pState->Lights[pState->nNumLights++] = m_Lights[i];
+	}
+}
+
+const SW_DRAWSTATE* CSwDevice::CaptureDrawState(UINT nNumTexCoords)
+{
+	if (!m_bDrawStateDirty && m_pLastDrawState && m_pLastDrawState->nNumTexCoords == nNumTexCoords)
+	{
+		++m_FrameStats.nDrawStatesReused;
+		return m_pLastDrawState;
+	}
+
+	if (m_nDrawStatesUsed == m_DrawStates.size())
+		m_DrawStates.emplace_back(new SW_DRAWSTATE);
+	SW_DRAWSTATE* pState = m_DrawStates[m_nDrawStatesUsed++].get();
+
+	pState->bZEnable = (m_RenderStates[D3DRS_ZENABLE] != D3DZB_FALSE);
+	pState->bZWriteEnable = m_RenderStates[D3DRS_ZWRITEENABLE];
+	pState->dwZFunc = m_RenderStates[D3DRS_ZFUNC];
+	pState->dwTextureFactor = m_RenderStates[D3DRS_TEXTUREFACTOR];
+	pState->nNumTexCoords = nNumTexCoords;
+
+	for (UINT i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+	{
+		SW_STAGESTATE& stage = pState->Stages[i];
+		stage.dwColorOp = m_StageStates[i][D3DTSS_COLOROP];
+		stage.dwColorArg1 = m_StageStates[i][D3DTSS_COLORARG1];
+		stage.dwColorArg2 = m_StageStates[i][D3DTSS_COLORARG2];
+		stage.dwAlphaOp = m_StageStates[i][D3DTSS_ALPHAOP];
+		stage.dwAlphaArg1 = m_StageStates[i][D3DTSS_ALPHAARG1];
+		stage.dwAlphaArg2 = m_StageStates[i][D3DTSS_ALPHAARG2];
+		stage.dwTexCoordIndex = m_StageStates[i][D3DTSS_TEXCOORDINDEX];
+		stage.pTexture = m_pTextures[i];
+		if (stage.pTexture)
+			stage.pTexture->AddRef();
+		stage.dwAddressU = m_SamplerStates[i][D3DSAMP_ADDRESSU];
+		stage.dwAddressV = m_SamplerStates[i][D3DSAMP_ADDRESSV];
+		stage.dwMagFilter = m_SamplerStates[i][D3DSAMP_MAGFILTER];
+		stage.dwMinFilter = m_SamplerStates[i][D3DSAMP_MINFILTER];
+		stage.dwMipFilter = m_SamplerStates[i][D3DSAMP_MIPFILTER];
+	}
+
+	SwPrepareDrawState(pState);
+	++m_FrameStats.nDrawStatesBuilt;
+	m_pLastDrawState = pState;
+	m_bDrawStateDirty = FALSE;
+	return pState;
+}
+
+VOID CSwDevice::ReleaseDrawStates()
+{
+	for (UINT n = 0; n < m_nDrawStatesUsed; ++n)
+	{
+		for (UINT i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+		{
+			CSwTexture*& pTexture = m_DrawStates[n]->Stages[i].pTexture;
+			if (pTexture)
+				pTexture->Release();
+			pTexture = NULL;
+		}
+	}
+	m_nDrawStatesUsed = 0;
+	m_pLastDrawState = NULL;
+}
+
+VOID CSwDevice::GetRenderTarget(SW_RENDERTARGET* pRT)
+{
+	pRT->pColor = m_BackBuffer.data();
+	pRT->pDepth = m_DepthBuffer.empty() ? NULL : m_DepthBuffer.data();
+	pRT->pHiZ = m_HiZ.empty() ? NULL : m_HiZ.data();
+	pRT->nWidth = m_nWidth;
+	pRT->nHeight = m_nHeight;
+	pRT->nHiZPitch = SwGetHiZPitch(m_nWidth);
+}
+
+//-----------------------------------------------------------------------------
+// 래스터화
+// 타일마다 하나의 작업. 타일 안에서는 묶음 순서(API 순서)대로 그린다.
+//-----------------------------------------------------------------------------
+VOID CSwDevice::FlushTiles()
+{
+	if (m_nBinChunksUsed == 0)
+		return;
+
+	SW_TRACE_SCOPE("SwDevice::FlushTiles");
+	SW_RENDERTARGET rt;
+	GetRenderTarget(&rt);
+
+	std::vector<SW_RASTERSTATS> threadStats(m_pThreadPool->GetNumThreads());
+	ZeroMemory(threadStats.data(), threadStats.size() * sizeof(SW_RASTERSTATS));
+
+	const UINT nTiles = m_TileGrid.nTilesX * m_TileGrid.nTilesY;
+	m_pThreadPool->ParallelFor(nTiles, [&](UINT nTile, UINT nThread)
+	{
+		// 빈 타일은 구간도 남기지 않는다. 작은 삼각형 몇 개뿐인 프레임에서는 빈 타일이 대부분이다.
+		bool bEmpty = true;
+		for (UINT c = 0; c < m_nBinChunksUsed && bEmpty; ++c)
+			bEmpty = m_BinChunks[c]->TileStart[nTile] == m_BinChunks[c]->TileStart[nTile + 1];
+		if (bEmpty)
+			return;
+
+		SW_TRACE_SCOPE("SwDevice::Tile");
+		INT x0, y0, x1, y1;
+		SwGetTileRect(&m_TileGrid, nTile, &x0, &y0, &x1, &y1);
+		for (UINT c = 0; c < m_nBinChunksUsed; ++c)
+		{
+			const SW_BINCHUNK& chunk = *m_BinChunks[c];
+			for (UINT k = chunk.TileStart[nTile]; k < chunk.TileStart[nTile + 1]; ++k)
+			{
+				SwRasterizeTriangle(&chunk.Triangles[chunk.TileTriangles[k]], &rt, x0, y0, x1, y1,
+					&threadStats[nThread]);
+			}
+		}
+	});
+
+	for (size_t i = 0; i < threadStats.size(); ++i)
+	{
+		m_FrameStats.nPixelsShaded += threadStats[i].nPixelsShaded;
+		m_FrameStats.nHiZTrianglesCulled += threadStats[i].nHiZTrianglesCulled;
+		m_FrameStats.nHiZBlocksCulled += threadStats[i].nHiZBlocksCulled;
+	}
+
+	m_nBinChunksUsed = 0;
+	m_nBinnedTriangles = 0;
+	ReleaseDrawStates();
+}
+
+HRESULT CSwDevice::DrawTriangles(D3DPRIMITIVETYPE PrimitiveType, UINT nPrimitiveCount, INT nBaseVertex,
+	UINT nMinVertex, UINT nNumVertices, const BYTE* pIndices, UINT nIndexSize, UINT nStartVertex)
+{
+	if (!m_bInScene || m_pStreamSource == NULL || m_dwFVF == 0)
+		return D3DERR_INVALIDCALL;
+
+	// 점과 선은 지원하지 않는다.
+	if (PrimitiveType != D3DPT_TRIANGLELIST && PrimitiveType != D3DPT_TRIANGLESTRIP &&
+		PrimitiveType != D3DPT_TRIANGLEFAN)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+	if (nPrimitiveCount == 0)
+		return S_OK;
+
+	UINT nNumIndices = (PrimitiveType == D3DPT_TRIANGLELIST) ? nPrimitiveCount * 3 : nPrimitiveCount + 2;
+
+	SW_FVFLAYOUT layout;
+	SwDecodeFVF(m_dwFVF, &layout, m_bVertexQuant ? &m_VertexQuant : NULL);
+	UINT nStride = m_nStreamStride ? m_nStreamStride : layout.nSize;
+
+	// 정점 단계에서 처리할 정점 범위
+	INT nFirstVertex;
+	UINT nVertexCount;
+	if (pIndices)
+	{
+		nFirstVertex = nBaseVertex + (INT)nMinVertex;
+		nVertexCount = nNumVertices;
+		if ((size_t)(pIndices - m_pIndices->GetData()) + (size_t)nNumIndices * nIndexSize > m_pIndices->GetLength())
+			return D3DERR_INVALIDCALL;
+	}
+	else
+	{
+		nFirstVertex = (INT)nStartVertex;
+		nVertexCount = nNumIndices;
+	}
+
+	const size_t nVBSize = m_pStreamSource->GetLength();
+	if (nFirstVertex < 0 || nVertexCount == 0 ||
+		m_nStreamOffset + (size_t)nFirstVertex * nStride + (size_t)(nVertexCount - 1) * nStride + layout.nSize > nVBSize)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	// 잘못된 호출은 기록하지 않는다. 다시 재생할 때 범위 밖의 정점이나 색인을 읽게 된다.
+	if (m_pCapture)
+		CaptureDraw(PrimitiveType, nPrimitiveCount, nBaseVertex, nMinVertex, nNumVertices, pIndices, nIndexSize,
+			nStartVertex);
+
+	// 1. 정점 단계
+	SW_VERTEXSTATE vs;
+	BuildVertexState(&vs);
+
+	if (m_Vertices.size() < nVertexCount)
+		m_Vertices.resize(nVertexCount);
+	const BYTE* pSrc = m_pStreamSource->GetData() + m_nStreamOffset + (size_t)nFirstVertex * nStride;
+
+	// 정점 버퍼의 SoA 사본이 지금 FVF와 간격 그대로 쓰이면 그쪽에서 읽는다.
+	const SW_VERTEXSTREAMS* pStreams = m_pStreamSource->GetStreams();
+	if (pStreams && (pStreams->dwFVF != m_dwFVF || m_bVertexQuant || nStride != layout.nSize ||
+		m_nStreamOffset % layout.nSize != 0))
+	{
+		pStreams = NULL;
+	}
+	const UINT nStreamFirst = pStreams ? m_nStreamOffset / layout.nSize + (UINT)nFirstVertex : 0;
+
+	// 그렇지 않으면 FVF에 맞게 인스턴스화한 커널, 그것도 없으면 FVF를 실행 중에 해석하는 정점 단계
+	const SW_PROCESSVERTICESFUNC pfnKernel = m_bVertexQuant ? NULL : m_pfnVertexKernel;
+
+	const UINT nVertexBatches = (nVertexCount + SW_VERTEX_BATCH - 1) / SW_VERTEX_BATCH;
+	m_pThreadPool->ParallelFor(nVertexBatches, [&](UINT nBatch, UINT)
+	{
+		UINT nBegin = nBatch * SW_VERTEX_BATCH;
+		UINT nCount = std::min<UINT>(SW_VERTEX_BATCH, nVertexCount - nBegin);
+		if (pStreams)
+			SwProcessVertexStreams(&vs, pStreams, nStreamFirst + nBegin, nCount, &m_Vertices[nBegin]);
+		else if (pfnKernel)
+			pfnKernel(&vs, pSrc + (size_t)nBegin * nStride, nStride, nCount, &m_Vertices[nBegin]);
+		else
+			SwProcessVertices(&vs, &layout, pSrc + (size_t)nBegin * nStride, nStride, nCount, &m_Vertices[nBegin]);
+	});
+
+	// 2. 삼각형 조립: 정점 범위 안에서의 상대 번호로 바꾼다.
+	m_TriIndices.resize((size_t)nPrimitiveCount * 3);
+	for (UINT t = 0; t < nPrimitiveCount; ++t)
+	{
+		UINT n[3];
+		switch (PrimitiveType)
+		{
+		case D3DPT_TRIANGLESTRIP:
+			// 홀수 번째 삼각형은 감는 방향을 유지하기 위해 순서를 바꾼다.
+			n[0] = t;
+			n[1] = (t & 1) ? t + 2 : t + 1;
+			n[2] = (t & 1) ? t + 1 : t + 2;
+			break;
+		case D3DPT_TRIANGLEFAN:
+			n[0] = 0;
+			n[1] = t + 1;
+			n[2] = t + 2;
+			break;
+		default:
+			n[0] = t * 3;
+			n[1] = t * 3 + 1;
+			n[2] = t * 3 + 2;
+			break;
+		}
+
+		UINT* pTri = &m_TriIndices[(size_t)t * 3];
+		BOOL bInRange = TRUE;
+		for (int i = 0; i < 3; ++i)
+		{
+			INT nIndex;
+			if (pIndices)
+			{
+				UINT nRaw = (nIndexSize == 4) ? ((const DWORD*)pIndices)[n[i]] : ((const WORD*)pIndices)[n[i]];
+				nIndex = nBaseVertex + (INT)nRaw - nFirstVertex;
+			}
+			else
+			{
+				nIndex = (INT)n[i];
+			}
+			bInRange &= (nIndex >= 0 && (UINT)nIndex < nVertexCount);
+			pTri[i] = (UINT)nIndex;
+		}
+		// 범위를 벗어난 인덱스가 하나라도 있으면 세 꼭지점을 모두 첫 정점으로 바꾸어
+		// 면적이 0인 퇴화 삼각형으로 만든다. 설정 단계에서 버려진다.
+		if (!bInRange)
+			pTri[0] = pTri[1] = pTri[2] = 0;
+	}
+
+	// 3. 삼각형 설정과 타일 분류: 설정 작업마다 새 묶음 하나
+	const SW_DRAWSTATE* pState = CaptureDrawState(std::min<UINT>(layout.nNumTexCoords, SW_MAX_TEXCOORDS));
+	const DWORD dwCullMode = m_RenderStates[D3DRS_CULLMODE];
+	const BOOL bTransformed = layout.bTransformed;
+	const UINT nSetupBatches = (nPrimitiveCount + SW_SETUP_BATCH - 1) / SW_SETUP_BATCH;
+	const UINT nFirstChunk = m_nBinChunksUsed;
+	while (m_BinChunks.size() < nFirstChunk + nSetupBatches)
+		m_BinChunks.emplace_back(new SW_BINCHUNK);
+
+	m_pThreadPool->ParallelFor(nSetupBatches, [&](UINT nBatch, UINT)
+	{
+		SW_BINCHUNK* pChunk = m_BinChunks[nFirstChunk + nBatch].get();
+		std::vector<SW_TRIANGLE>& out = pChunk->Triangles;
+		out.clear();
+
+		UINT nBegin = nBatch * SW_SETUP_BATCH;
+		UINT nEnd = std::min<UINT>(nBegin + SW_SETUP_BATCH, nPrimitiveCount);
+		SW_TRIANGLE tris[SW_MAX_CLIPPED_TRIANGLES];
+		for (UINT t = nBegin; t < nEnd; ++t)
+		{
+			const UINT* pTri = &m_TriIndices[(size_t)t * 3];
+			UINT nOut = SwSetupTriangle(&m_Vertices[pTri[0]], &m_Vertices[pTri[1]], &m_Vertices[pTri[2]],
+				bTransformed, dwCullMode, m_nWidth, m_nHeight, pState, tris);
+			out.insert(out.end(), tris, tris + nOut);
+		}
+
+		SwBinTriangles(&m_TileGrid, pChunk);
+	});
+	m_nBinChunksUsed += nSetupBatches;
+
+	UINT64 nSetupTriangles = 0;
+	for (UINT i = 0; i < nSetupBatches; ++i)
+		nSetupTriangles += m_BinChunks[nFirstChunk + i]->Triangles.size();
+	m_nBinnedTriangles += (UINT)nSetupTriangles;
+
+	// 통계
+	m_FrameStats.nDrawCalls += 1;
+	m_FrameStats.nVertices += nVertexCount;
+	m_FrameStats.nTriangles += nPrimitiveCount;
+	m_FrameStats.nTrianglesCulled += (nPrimitiveCount > nSetupTriangles) ? nPrimitiveCount - nSetupTriangles : 0;
+
+	// 4. 래스터화는 EndScene()까지 미룬다. 메모리가 너무 늘어나지 않도록 중간에 비울 수도 있다.
+	if (m_nBinnedTriangles >= SW_MAX_BINNED_TRIANGLES)
+		FlushTiles();
+
+	return S_OK;
+}
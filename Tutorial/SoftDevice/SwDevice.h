@@ -0,0 +1,243 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwDevice.h
+//
+// 설명:	창이나 GPU 없이 메모리에 렌더링하는 소프트웨어 디바이스.
+//		예제들이 사용하는 IDirect3DDevice9의 일부(Clear, BeginScene/EndScene,
+//		SetTransform, SetStreamSource/SetFVF/SetIndices, DrawPrimitive/DrawIndexedPrimitive,
+//		SetTexture, SetTextureStageState, SetSamplerState, SetRenderState,
+//		SetMaterial/SetLight/LightEnable, Present)를 같은 이름과 같은 인자로 제공한다.
+//		정점 처리와 삼각형 설정은 드로우 호출마다 바로 수행하고, 설정된 삼각형은
+//		화면 타일별로 분류해 두었다가 EndScene()(또는 Clear(), 분류된 삼각형이 너무 많을 때)에
+//		타일마다 한 작업자가 래스터화한다(sort-middle).
+//		상태 설정은 그림자 상태와 비교하여 값이 같으면 버리고, 픽셀 처리 상태(SW_DRAWSTATE)는
+//		그 상태가 바뀌었을 때만 다시 만든다. 버린 호출 수는 GetFrameStats()로 알 수 있다.
+//		매 프레임 같은 호출 순서는 명령 목록(SwCommandList.h)에 한 번 기록해 두고 다시 실행할 수 있다.
+//		SetCapture()로 호출을 파일에 기록해 두면 나중에 CSwCapturePlayer로 다시 실행할 수 있다(SwCapture.h).
+//		Clear, 타일 비우기, 타일 래스터화는 추적 구간(SwTrace.h)으로 기록되어 SwTraceEnable()로 켜면 볼 수 있다.
+//		구간은 프레임과 패스 단위로만 두고 드로우마다 두지 않는다. 작은 드로우가 많으면 기록 비용이 커진다.
+//
+//		사용 예:
+//			SW_PRESENT_PARAMETERS pp;
+//			ZeroMemory(&pp, sizeof(pp));
+//			pp.BackBufferWidth = 640;
+//			pp.BackBufferHeight = 480;
+//			pp.EnableAutoDepthStencil = TRUE;
+//			pp.AutoDepthStencilFormat = D3DFMT_D16;
+//			CSwDevice* pDevice;
+//			SwCreateDevice(&pp, &pDevice);
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwBinner.h"
+#include "SwCommandList.h"
+#include "SwFVFVertex.h"
+#include "SwPipeline.h"
+#include "SwRasterizer.h"
+#include "SwResource.h"
+#include "SwStateBlock.h"
+#include "SwVertexStage.h"
+
+#include <memory>
+#include <vector>
+
+class CSwCaptureWriter;
+class CSwThreadPool;
+
+//-----------------------------------------------------------------------------
+// 디바이스 생성 인자
+// D3DPRESENT_PARAMETERS에서 창과 관련된 값을 빼고 스레드 수를 더한 것이다.
+//-----------------------------------------------------------------------------
+struct SW_PRESENT_PARAMETERS
+{
+	UINT		BackBufferWidth;
+	UINT		BackBufferHeight;
+	BOOL		EnableAutoDepthStencil;
+	D3DFORMAT	AutoDepthStencilFormat;		// 깊이는 형식과 관계없이 float로 보관한다
+	UINT		NumThreads;					// 0이면 하드웨어 스레드 수
+};
+
+class CSwDevice;
+typedef CSwDevice*			LPSWDEVICE;
+typedef CSwVertexBuffer*	LPSWVERTEXBUFFER;
+typedef CSwIndexBuffer*		LPSWINDEXBUFFER;
+typedef CSwTexture*			LPSWTEXTURE;
+
+HRESULT	SwCreateDevice(const SW_PRESENT_PARAMETERS* pPresentationParameters, CSwDevice** ppDevice);
+
+//-----------------------------------------------------------------------------
+// 소프트웨어 디바이스
+//-----------------------------------------------------------------------------
+class CSwDevice
+{
+public:
+	UINT	AddRef();
+	UINT	Release();
+
+	// 자원 생성
+	HRESULT	CreateVertexBuffer(UINT Length, DWORD Usage, DWORD FVF, D3DPOOL Pool,
+				CSwVertexBuffer** ppVertexBuffer, void* pSharedHandle);
+	HRESULT	CreateIndexBuffer(UINT Length, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool,
+				CSwIndexBuffer** ppIndexBuffer, void* pSharedHandle);
+	HRESULT	CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage, D3DFORMAT Format,
+				D3DPOOL Pool, CSwTexture** ppTexture, void* pSharedHandle);
+	HRESULT	CreateCommandList(CSwCommandList** ppCommandList);
+
+	// 장면
+	HRESULT	Clear(DWORD Count, const D3DRECT* pRects, DWORD Flags, D3DCOLOR Color, float Z, DWORD Stencil);
+	HRESULT	BeginScene();
+	HRESULT	EndScene();
+	HRESULT	Present(const void* pSourceRect, const void* pDestRect, void* hDestWindowOverride,
+				const void* pDirtyRegion);
+
+	// 상태
+	HRESULT	SetTransform(D3DTRANSFORMSTATETYPE State, const D3DMATRIX* pMatrix);
+	HRESULT	GetTransform(D3DTRANSFORMSTATETYPE State, D3DMATRIX* pMatrix);
+	HRESULT	SetRenderState(D3DRENDERSTATETYPE State, DWORD Value);
+	HRESULT	GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue);
+	HRESULT	SetTextureStageState(DWORD Stage, D3DTEXTURESTAGESTATETYPE Type, DWORD Value);
+	HRESULT	SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD Value);
+	HRESULT	SetTexture(DWORD Stage, CSwTexture* pTexture);
+	HRESULT	SetMaterial(const D3DMATERIAL9* pMaterial);
+	HRESULT	SetLight(DWORD Index, const D3DLIGHT9* pLight);
+	HRESULT	LightEnable(DWORD Index, BOOL Enable);
+
+	// 상태 블록: 둘 사이의 SetTransform, SetRenderState, SetTextureStageState, SetSamplerState, SetTexture,
+	// SetMaterial, SetLight, LightEnable은 디바이스에 반영되지 않고 블록에 기록된다.
+	HRESULT	BeginStateBlock();
+	HRESULT	EndStateBlock(CSwStateBlock** ppSB);
+
+	// 입력
+	HRESULT	SetStreamSource(UINT StreamNumber, CSwVertexBuffer* pStreamData, UINT OffsetInBytes, UINT Stride);
+	HRESULT	SetFVF(DWORD FVF);
+	// FVF의 요소들이 양자화된 형식으로 저장되어 있으면 그 형식을 알려 준다. NULL이면 float로 돌아간다.
+	HRESULT	SetVertexQuant(const SW_VERTEXQUANT* pQuant);
+	HRESULT	SetIndices(CSwIndexBuffer* pIndexData);
+
+	// 그리기
+	HRESULT	DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount);
+	HRESULT	DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex,
+				UINT NumVertices, UINT startIndex, UINT primCount);
+
+	// 닫힌 명령 목록의 명령을 기록된 순서대로 실행한다. 실패한 명령이 있으면 거기서 멈추고 그 결과를 돌려준다.
+	HRESULT	ExecuteCommandList(CSwCommandList* pCommandList);
+
+	// 이후의 호출을 pCapture에 기록한다. 붙일 때 현재 상태 전체를 먼저 기록한다. NULL이면 기록을 멈춘다.
+	// 기록기는 SetCapture(NULL) 전까지 살아 있어야 한다.
+	HRESULT	SetCapture(CSwCaptureWriter* pCapture);
+
+	// 헤드리스 전용: Present()된 전면 버퍼(A8R8G8B8, pitch = 폭 * 4)와 통계
+	const DWORD*	GetFrontBuffer() const { return m_FrontBuffer.data(); }
+	UINT			GetWidth() const { return m_nWidth; }
+	UINT			GetHeight() const { return m_nHeight; }
+	UINT			GetNumThreads() const;
+	// 마지막으로 Present()된 프레임의 통계
+	const SW_FRAMESTATS&	GetFrameStats() const { return m_LastFrameStats; }
+
+private:
+	friend HRESULT SwCreateDevice(const SW_PRESENT_PARAMETERS*, CSwDevice**);
+	friend class CSwStateBlock;
+
+	explicit CSwDevice(const SW_PRESENT_PARAMETERS* pPP);
+	~CSwDevice();
+
+	CSwDevice(const CSwDevice&) = delete;
+	CSwDevice& operator=(const CSwDevice&) = delete;
+
+	VOID	SetDefaultStates();
+
+	// 검사가 끝난 상태 설정. 캡처 중이면 기록하고, 값이 같으면 버리고 통계에 센다.
+	VOID	ChangeRenderState(DWORD dwType, DWORD dwValue);
+	VOID	ChangeStageState(DWORD dwStage, DWORD dwType, DWORD dwValue);
+	VOID	ChangeSamplerState(DWORD dwStage, DWORD dwType, DWORD dwValue);
+	VOID	ChangeState(DWORD* pSlot, DWORD dwValue);
+	VOID	ChangeTexture(DWORD dwStage, CSwTexture* pTexture);
+	VOID	ChangeMaterial(const D3DMATERIAL9* pMaterial);
+	VOID	ChangeTransform(DWORD dwState, const D3DMATRIX* pMatrix);
+	VOID	ChangeLight(DWORD dwIndex, const D3DLIGHT9* pLight);
+	VOID	ChangeLightEnable(DWORD dwIndex, BOOL bEnable);
+	// 입력 설정은 걸러 내지 않고 캡처에만 기록한다.
+	VOID	ChangeStreamSource(CSwVertexBuffer* pStreamData, UINT nOffset, UINT nStride);
+	VOID	ChangeFVF(DWORD dwFVF);
+	VOID	ChangeVertexQuant(const SW_VERTEXQUANT* pQuant);
+	VOID	ChangeIndices(CSwIndexBuffer* pIndexData);
+	HRESULT	ApplyStateBlock(const CSwStateBlock* pBlock);
+
+	// 캡처를 붙일 때 현재 상태를 기록한다.
+	VOID	CaptureDeviceState();
+	// 그리기 직전에 묶여 있는 자원 중 내용이 바뀐 것을 기록한다.
+	VOID	CaptureBindings(BOOL bIndexed);
+	// 검사를 통과한 그리기 호출을 원래의 인자로 기록한다. 인자는 DrawTriangles()와 같다.
+	VOID	CaptureDraw(D3DPRIMITIVETYPE PrimitiveType, UINT nPrimitiveCount, INT nBaseVertex,
+				UINT nMinVertex, UINT nNumVertices, const BYTE* pIndices, UINT nIndexSize, UINT nStartVertex);
+
+	VOID	BuildVertexState(SW_VERTEXSTATE* pState);
+	// nNumTexCoords는 정점이 가진 텍스처 좌표 집합의 개수(SW_MAX_TEXCOORDS 이하)
+	const SW_DRAWSTATE*	CaptureDrawState(UINT nNumTexCoords);
+	VOID	ReleaseDrawStates();
+	VOID	GetRenderTarget(SW_RENDERTARGET* pRT);
+
+	// 분류해 둔 삼각형을 모두 래스터화하고 묶음과 드로우 상태를 비운다.
+	VOID	FlushTiles();
+
+	// 묶인 색인 버퍼에서 nStartIndex번째 색인의 위치. 버퍼가 없거나 범위를 벗어나면 NULL.
+	const BYTE*	LocateIndices(UINT nStartIndex, UINT* pIndexSize) const;
+	// 정점 단계 → 삼각형 설정 → 래스터화를 수행한다.
+	// pIndices가 NULL이면 정점 순서대로 그린다. nIndexSize는 2 또는 4.
+	HRESULT	DrawTriangles(D3DPRIMITIVETYPE PrimitiveType, UINT nPrimitiveCount, INT nBaseVertex,
+				UINT nMinVertex, UINT nNumVertices, const BYTE* pIndices, UINT nIndexSize, UINT nStartVertex);
+
+	UINT							m_nRef;
+	UINT							m_nWidth;
+	UINT							m_nHeight;
+	BOOL							m_bInScene;
+	std::unique_ptr<CSwThreadPool>	m_pThreadPool;
+
+	std::vector<DWORD>				m_BackBuffer;
+	std::vector<DWORD>				m_FrontBuffer;
+	std::vector<float>				m_DepthBuffer;
+	std::vector<SW_HIZBLOCK>		m_HiZ;			// Z 버퍼의 8x8 블록별 깊이 범위
+
+	// 디바이스 상태
+	D3DMATRIX						m_matWorld;
+	D3DMATRIX						m_matView;
+	D3DMATRIX						m_matProj;
+	DWORD							m_RenderStates[SW_NUM_RENDERSTATES];
+	DWORD							m_StageStates[SW_MAX_TEXTURE_STAGES][SW_NUM_STAGESTATES];
+	DWORD							m_SamplerStates[SW_MAX_TEXTURE_STAGES][SW_NUM_SAMPLERSTATES];
+	CSwTexture*						m_pTextures[SW_MAX_TEXTURE_STAGES];
+	D3DMATERIAL9					m_Material;
+	D3DLIGHT9						m_Lights[SW_MAX_LIGHTS];
+	BOOL							m_bLightEnable[SW_MAX_LIGHTS];
+	std::unique_ptr<CSwStateRecorder>	m_pRecorder;	// BeginStateBlock() 이후에만 있다
+	CSwCaptureWriter*				m_pCapture;
+
+	CSwVertexBuffer*				m_pStreamSource;
+	UINT							m_nStreamOffset;
+	UINT							m_nStreamStride;
+	DWORD							m_dwFVF;
+	BOOL							m_bVertexQuant;
+	SW_VERTEXQUANT					m_VertexQuant;
+	SW_PROCESSVERTICESFUNC			m_pfnVertexKernel;	// m_dwFVF에 맞게 인스턴스화한 정점 커널
+	CSwIndexBuffer*					m_pIndices;
+
+	// 드로우 호출마다 만들어지는 상태. 래스터화가 끝날 때까지 주소가 바뀌지 않도록 unique_ptr로 보관하고
+	// 상태가 가리키는 텍스처의 참조를 잡아 둔다.
+	std::vector<std::unique_ptr<SW_DRAWSTATE> >	m_DrawStates;
+	UINT							m_nDrawStatesUsed;
+	// 마지막으로 만든 드로우 상태. 그 뒤로 픽셀 처리에 쓰이는 상태가 바뀌지 않았으면 다음 드로우도 그대로 쓴다.
+	const SW_DRAWSTATE*				m_pLastDrawState;
+	BOOL							m_bDrawStateDirty;
+
+	// 드로우 호출 사이에 재사용하는 작업 버퍼
+	std::vector<SW_VERTEX>			m_Vertices;
+	std::vector<UINT>				m_TriIndices;
+
+	// 래스터화를 기다리는 삼각형. 설정 작업 하나가 묶음 하나를 채우며 묶음 순서가 곧 API 순서다.
+	SW_TILEGRID						m_TileGrid;
+	std::vector<std::unique_ptr<SW_BINCHUNK> >	m_BinChunks;
+	UINT							m_nBinChunksUsed;
+	UINT							m_nBinnedTriangles;
+
+	SW_FRAMESTATS					m_FrameStats;
+	SW_FRAMESTATS					m_LastFrameStats;
+};
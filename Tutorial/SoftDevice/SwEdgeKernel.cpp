@@ -0,0 +1,220 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwEdgeKernel.cpp
+//
+// 설명:	변 함수 커널의 스칼라, SSE4.1, AVX2 구현과 실행 중 선택.
+//		SIMD 구현은 함수 단위로 명령어 집합을 지정하므로(GCC/Clang은 target 속성,
+//		MSVC는 별도 옵션 없이 intrinsic 사용 가능) 프로젝트 전체를 AVX2로 빌드할 필요가 없다.
+//		세 구현 모두 FMA를 쓰지 않아야 비트 단위로 같으므로 /fp:fast, -ffp-contract=fast로 빌드하지 않는다.
+//-----------------------------------------------------------------------------
+#include "SwEdgeKernel.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SW_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_SSE41		__attribute__((target("sse4.1")))
+#define SW_TARGET_AVX2		__attribute__((target("avx2")))
+#else
+#define SW_TARGET_SSE41
+#define SW_TARGET_AVX2
+#endif
+
+//-----------------------------------------------------------------------------
+// 스칼라(기준) 구현
+//-----------------------------------------------------------------------------
+static UINT64 EdgeKernelScalar(const SW_TRIANGLE* pTri, INT x, INT y)
+{
+	UINT64 nMask = 0;
+	for (int r = 0; r < SW_BLOCK_SIZE; ++r)
+	{
+		const float py = (float)(y + r);
+		for (int c = 0; c < SW_BLOCK_SIZE; ++c)
+		{
+			const float px = (float)(x + c);
+			bool bInside = true;
+			for (int e = 0; e < 3 && bInside; ++e)
+				bInside = SwIsInsideEdge(pTri, e, SwEvalEdge(pTri, e, px, py));
+			if (bInside)
+				nMask |= (UINT64)1 << (r * SW_BLOCK_SIZE + c);
+		}
+	}
+	return nMask;
+}
+
+#ifdef SW_X86
+
+//-----------------------------------------------------------------------------
+// SSE4.1 구현: 한 행을 4픽셀씩 두 번에 계산한다.
+//-----------------------------------------------------------------------------
+SW_TARGET_SSE41
+static UINT64 EdgeKernelSSE41(const SW_TRIANGLE* pTri, INT x, INT y)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 px0 = _mm_add_ps(_mm_set1_ps((float)x), _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+	const __m128 px1 = _mm_add_ps(_mm_set1_ps((float)x), _mm_setr_ps(4.0f, 5.0f, 6.0f, 7.0f));
+
+	// 행과 관계없는 항 A * (x - X)와 top-left 규칙용 마스크
+	__m128 ax0[3], ax1[3], topLeft[3];
+	for (int e = 0; e < 3; ++e)
+	{
+		const __m128 A = _mm_set1_ps(pTri->fEdgeA[e]);
+		const __m128 X = _mm_set1_ps(pTri->fEdgeX[e]);
+		ax0[e] = _mm_mul_ps(A, _mm_sub_ps(px0, X));
+		ax1[e] = _mm_mul_ps(A, _mm_sub_ps(px1, X));
+		topLeft[e] = _mm_castsi128_ps(_mm_set1_epi32(pTri->bTopLeft[e] ? -1 : 0));
+	}
+
+	UINT64 nMask = 0;
+	for (int r = 0; r < SW_BLOCK_SIZE; ++r)
+	{
+		const float py = (float)(y + r);
+		__m128 in0 = _mm_castsi128_ps(_mm_set1_epi32(-1));
+		__m128 in1 = in0;
+		for (int e = 0; e < 3; ++e)
+		{
+			const __m128 by = _mm_set1_ps(pTri->fEdgeB[e] * (py - pTri->fEdgeY[e]));
+			const __m128 E0 = _mm_add_ps(ax0[e], by);
+			const __m128 E1 = _mm_add_ps(ax1[e], by);
+			in0 = _mm_and_ps(in0, _mm_or_ps(_mm_cmpgt_ps(E0, zero), _mm_and_ps(_mm_cmpeq_ps(E0, zero), topLeft[e])));
+			in1 = _mm_and_ps(in1, _mm_or_ps(_mm_cmpgt_ps(E1, zero), _mm_and_ps(_mm_cmpeq_ps(E1, zero), topLeft[e])));
+		}
+		UINT64 nRow = (UINT64)_mm_movemask_ps(in0) | ((UINT64)_mm_movemask_ps(in1) << 4);
+		nMask |= nRow << (r * SW_BLOCK_SIZE);
+	}
+	return nMask;
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 구현: 한 행(8픽셀)을 한 번에 계산한다.
+//-----------------------------------------------------------------------------
+SW_TARGET_AVX2
+static UINT64 EdgeKernelAVX2(const SW_TRIANGLE* pTri, INT x, INT y)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 px = _mm256_add_ps(_mm256_set1_ps((float)x),
+		_mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f));
+
+	__m256 ax[3], topLeft[3];
+	for (int e = 0; e < 3; ++e)
+	{
+		ax[e] = _mm256_mul_ps(_mm256_set1_ps(pTri->fEdgeA[e]), _mm256_sub_ps(px, _mm256_set1_ps(pTri->fEdgeX[e])));
+		topLeft[e] = _mm256_castsi256_ps(_mm256_set1_epi32(pTri->bTopLeft[e] ? -1 : 0));
+	}
+
+	UINT64 nMask = 0;
+	for (int r = 0; r < SW_BLOCK_SIZE; ++r)
+	{
+		const float py = (float)(y + r);
+		__m256 in = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+		for (int e = 0; e < 3; ++e)
+		{
+			const __m256 E = _mm256_add_ps(ax[e], _mm256_set1_ps(pTri->fEdgeB[e] * (py - pTri->fEdgeY[e])));
+			const __m256 gt = _mm256_cmp_ps(E, zero, _CMP_GT_OQ);
+			const __m256 eq = _mm256_cmp_ps(E, zero, _CMP_EQ_OQ);
+			in = _mm256_and_ps(in, _mm256_or_ps(gt, _mm256_and_ps(eq, topLeft[e])));
+		}
+		nMask |= (UINT64)(UINT)_mm256_movemask_ps(in) << (r * SW_BLOCK_SIZE);
+	}
+	return nMask;
+}
+
+//-----------------------------------------------------------------------------
+// CPU 기능 확인
+//-----------------------------------------------------------------------------
+static bool HasSSE41()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 19)) != 0;
+#else
+	return __builtin_cpu_supports("sse4.1") != 0;
+#endif
+}
+
+static bool HasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// 운영체제가 YMM 레지스터를 저장해 주는가(OSXSAVE와 XCR0)
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+#endif	// SW_X86
+
+//-----------------------------------------------------------------------------
+// 선택
+//-----------------------------------------------------------------------------
+static SW_EDGEKERNEL GetBestEdgeKernel()
+{
+#ifdef SW_X86
+	if (HasAVX2())
+		return SW_EDGEKERNEL_AVX2;
+	if (HasSSE41())
+		return SW_EDGEKERNEL_SSE41;
+#endif
+	return SW_EDGEKERNEL_SCALAR;
+}
+
+static SW_EDGEKERNEL		s_eEdgeKernel = SW_EDGEKERNEL_SCALAR;
+SW_EDGEKERNELFUNC			g_pfnSwEdgeKernel = EdgeKernelScalar;
+
+// 정적 초기화 시점에 한 번 선택해 둔다.
+static const SW_EDGEKERNEL	s_eInitialKernel = SwSetEdgeKernel(SW_EDGEKERNEL_AUTO);
+
+SW_EDGEKERNEL SwSetEdgeKernel(SW_EDGEKERNEL eKernel)
+{
+	const SW_EDGEKERNEL eBest = GetBestEdgeKernel();
+	if (eKernel == SW_EDGEKERNEL_AUTO || eKernel > eBest)
+		eKernel = eBest;
+
+	switch (eKernel)
+	{
+#ifdef SW_X86
+	case SW_EDGEKERNEL_AVX2:	g_pfnSwEdgeKernel = EdgeKernelAVX2;		break;
+	case SW_EDGEKERNEL_SSE41:	g_pfnSwEdgeKernel = EdgeKernelSSE41;	break;
+#endif
+	default:
+		eKernel = SW_EDGEKERNEL_SCALAR;
+		g_pfnSwEdgeKernel = EdgeKernelScalar;
+		break;
+	}
+
+	s_eEdgeKernel = eKernel;
+	return eKernel;
+}
+
+SW_EDGEKERNEL SwGetEdgeKernel()
+{
+	return s_eEdgeKernel;
+}
+
+const char* SwGetEdgeKernelName(SW_EDGEKERNEL eKernel)
+{
+	switch (eKernel)
+	{
+	case SW_EDGEKERNEL_SCALAR:	return "scalar";
+	case SW_EDGEKERNEL_SSE41:	return "sse4.1";
+	case SW_EDGEKERNEL_AVX2:	return "avx2";
+	default:					return "auto";
+	}
+}
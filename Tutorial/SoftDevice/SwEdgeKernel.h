@@ -0,0 +1,72 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwEdgeKernel.h
+//
+// 설명:	8x8 픽셀 블록 하나의 변 함수 포함 여부(coverage)를 계산하는 커널.
+//		AVX2는 한 행(8픽셀)을 명령 하나로, SSE4.1은 4픽셀씩 두 번에 계산하며
+//		실행 중에 CPU를 확인하여 쓸 수 있는 가장 넓은 구현을 고른다.
+//
+//		모든 구현은 픽셀마다 E = A * (x - X) + B * (y - Y)를 같은 순서의 float 곱셈, 덧셈으로
+//		계산하므로(FMA로 합치지 않는다) 스칼라 구현과 결과가 비트 단위로 같다.
+//		스칼라 구현이 기준이며, SwSetEdgeKernel(SW_EDGEKERNEL_SCALAR)로 바꾸어 결과를 비교할 수 있다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwRasterizer.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+enum SW_EDGEKERNEL
+{
+	SW_EDGEKERNEL_AUTO = 0,			// CPU가 지원하는 가장 빠른 구현
+	SW_EDGEKERNEL_SCALAR,
+	SW_EDGEKERNEL_SSE41,
+	SW_EDGEKERNEL_AVX2,
+};
+
+// 블록 [x, x + 8) x [y, y + 8)의 포함 마스크. 비트 (행 * 8 + 열)이 1이면 삼각형 안쪽이다.
+typedef UINT64 (*SW_EDGEKERNELFUNC)(const SW_TRIANGLE* pTri, INT x, INT y);
+
+// 사용할 구현을 고른다. 지원하지 않는 구현을 요청하면 그보다 좁은 구현을 쓴다.
+// 실제로 선택된 구현을 돌려준다. 래스터화 중에는 호출하지 않는다.
+SW_EDGEKERNEL		SwSetEdgeKernel(SW_EDGEKERNEL eKernel);
+SW_EDGEKERNEL		SwGetEdgeKernel();
+const char*			SwGetEdgeKernelName(SW_EDGEKERNEL eKernel);
+
+// 현재 선택된 구현
+extern SW_EDGEKERNELFUNC	g_pfnSwEdgeKernel;
+
+// 변 e의 픽셀 (px, py)에서의 값. 블록 분류와 모든 커널이 이 식과 같은 순서로 계산한다.
+inline float SwEvalEdge(const SW_TRIANGLE* pTri, int e, float px, float py)
+{
+	float t1 = pTri->fEdgeA[e] * (px - pTri->fEdgeX[e]);
+	float t2 = pTri->fEdgeB[e] * (py - pTri->fEdgeY[e]);
+	return t1 + t2;
+}
+
+// 변 함수 값이 변 e의 안쪽인가(top-left 규칙)
+inline bool SwIsInsideEdge(const SW_TRIANGLE* pTri, int e, float E)
+{
+	return (E > 0.0f) || (E == 0.0f && pTri->bTopLeft[e]);
+}
+
+// 가장 낮은 1 비트의 위치. nMask는 0이 아니어야 한다.
+inline UINT SwBitScanForward64(UINT64 nMask)
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	unsigned long nIndex;
+	_BitScanForward64(&nIndex, nMask);
+	return (UINT)nIndex;
+#elif defined(__GNUC__) || defined(__clang__)
+	return (UINT)__builtin_ctzll(nMask);
+#else
+	UINT nIndex = 0;
+	while ((nMask & 1) == 0)
+	{
+		nMask >>= 1;
+		++nIndex;
+	}
+	return nIndex;
+#endif
+}
@@ -0,0 +1,49 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwFVFVertex.cpp
+//
+// 설명:	미리 인스턴스화한 FVF별 정점 커널의 목록.
+//-----------------------------------------------------------------------------
+#include "SwFVFVertex.h"
+
+//-----------------------------------------------------------------------------
+// 구성 확인
+//-----------------------------------------------------------------------------
+static_assert(SW_FVFTRAITS<D3DFVF_XYZRHW | D3DFVF_DIFFUSE>::nDiffuse == 16, "");
+static_assert(SW_FVFTRAITS<D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1>::TexCoordOffset(0) == 24, "");
+static_assert(SW_FVFTRAITS<D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_SPECULAR>::nSpecular == 16, "");
+static_assert(SW_FVFTRAITS<D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX2 | D3DFVF_TEXCOORDSIZE1(0)>::nSize == 28, "");
+
+//-----------------------------------------------------------------------------
+// 커널 목록
+//-----------------------------------------------------------------------------
+struct VERTEXKERNEL
+{
+	DWORD					dwFVF;
+	SW_PROCESSVERTICESFUNC	pfnProcess;
+};
+
+#define SW_VERTEX_KERNEL(fvf)	{ (fvf), SwProcessVerticesT<(fvf)> }
+
+static const VERTEXKERNEL s_Kernels[] =
+{
+	SW_VERTEX_KERNEL(D3DFVF_XYZRHW | D3DFVF_DIFFUSE),					// Tut02
+	SW_VERTEX_KERNEL(D3DFVF_XYZRHW | D3DFVF_DIFFUSE | D3DFVF_TEX1),
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_DIFFUSE),						// Tut03, Tut07
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_NORMAL),						// Tut04
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1),		// Tut05, Tut08
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX2),
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_TEX1),
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_TEX1),		// Tut06(.x 메시)
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_DIFFUSE),
+	SW_VERTEX_KERNEL(D3DFVF_XYZ | D3DFVF_NORMAL | D3DFVF_DIFFUSE | D3DFVF_TEX1),
+};
+
+SW_PROCESSVERTICESFUNC SwGetVertexKernel(DWORD dwFVF)
+{
+	for (const VERTEXKERNEL& k : s_Kernels)
+	{
+		if (k.dwFVF == dwFVF)
+			return k.pfnProcess;
+	}
+	return NULL;
+}
@@ -0,0 +1,251 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwFVFVertex.h
+//
+// 설명:	FVF 상수로부터 컴파일 시간에 만드는 정점 구성과 FVF별 정점 커널.
+//		SwDecodeFVF()는 드로우 호출마다 FVF를 해석하고, SwProcessVertices()는 정점마다
+//		요소가 있는지와 저장 형식을 검사하며 돈다. SW_FVFTRAITS<FVF>는 같은 해석을 constexpr로 하므로
+//		이것으로 인스턴스화한 SwProcessVerticesT<FVF>의 안쪽 루프에는 형식에 따른 분기가 없다.
+//
+//		SW_FVFVERTEX<FVF>는 FVF 구성대로 놓인 정점 구조체이다. 예제처럼 구조체를 손으로 쓸 때는
+//		SW_ASSERT_FVF_VERTEX와 SW_FVFTRAITS의 오프셋으로 FVF와 맞는지 컴파일 시간에 확인할 수 있다.
+//
+//		사용 예:
+//			#define D3DFVF_CUSTOMVERTEX (D3DFVF_XYZ | D3DFVF_DIFFUSE | D3DFVF_TEX1)
+//			typedef SW_FVFVERTEX<D3DFVF_CUSTOMVERTEX> CUSTOMVERTEX;
+//
+//			CUSTOMVERTEX v;
+//			v.SetPosition(0.0f, 1.0f, 0.0f);
+//			v.SetDiffuse(0xffffffff);
+//			v.SetTexCoord<0>(0.5f, 0.5f);
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwMath.h"
+#include "SwVertexStage.h"
+
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// constexpr FVF 해석. SwDecodeFVF()에서 양자화를 뺀 것과 같은 결과를 낸다.
+//-----------------------------------------------------------------------------
+
+// 위치 요소의 크기(혼합 가중치 포함, 바이트)
+constexpr UINT SwFVFPositionSize(DWORD dwFVF)
+{
+	switch (dwFVF & D3DFVF_POSITION_MASK)
+	{
+	case D3DFVF_XYZ:	return 12;
+	case D3DFVF_XYZRHW:	return 16;
+	case D3DFVF_XYZW:	return 16;
+	case D3DFVF_XYZB1:	return 16;
+	case D3DFVF_XYZB2:	return 20;
+	case D3DFVF_XYZB3:	return 24;
+	case D3DFVF_XYZB4:	return 28;
+	case D3DFVF_XYZB5:	return 32;
+	}
+	return 0;
+}
+
+constexpr UINT SwFVFNumTexCoords(DWORD dwFVF)
+{
+	const UINT nNumTex = (dwFVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT;
+	return nNumTex < SW_MAX_FVF_TEXCOORDS ? nNumTex : SW_MAX_FVF_TEXCOORDS;
+}
+
+// 텍스처 좌표 집합 i의 float 개수. D3DFVF_TEXCOORDSIZEn 비트: 0 = 2개, 1 = 3개, 2 = 4개, 3 = 1개
+constexpr UINT SwFVFTexCoordSize(DWORD dwFVF, UINT i)
+{
+	switch ((dwFVF >> (i * 2 + 16)) & 3)
+	{
+	case 1:		return 3;
+	case 2:		return 4;
+	case 3:		return 1;
+	}
+	return 2;
+}
+
+// 텍스처 좌표 집합 i의 오프셋. i가 집합 개수와 같으면 정점 크기다.
+constexpr UINT SwFVFTexCoordOffset(DWORD dwFVF, UINT i)
+{
+	UINT nOffset = SwFVFPositionSize(dwFVF);
+	if (dwFVF & D3DFVF_NORMAL)
+		nOffset += 12;
+	if (dwFVF & D3DFVF_PSIZE)
+		nOffset += 4;
+	if (dwFVF & D3DFVF_DIFFUSE)
+		nOffset += 4;
+	if (dwFVF & D3DFVF_SPECULAR)
+		nOffset += 4;
+	for (UINT t = 0; t < i; ++t)
+		nOffset += SwFVFTexCoordSize(dwFVF, t) * 4;
+	return nOffset;
+}
+
+//-----------------------------------------------------------------------------
+// FVF 하나의 정점 구성(바이트 오프셋, 없으면 -1)
+//-----------------------------------------------------------------------------
+template<DWORD FVF>
+struct SW_FVFTRAITS
+{
+	static constexpr DWORD	dwPosition		= FVF & D3DFVF_POSITION_MASK;
+	static constexpr bool	bTransformed	= (dwPosition == D3DFVF_XYZRHW);
+	static constexpr UINT	nPositionSize	= SwFVFPositionSize(FVF);
+
+	static constexpr INT	nNormal			= (FVF & D3DFVF_NORMAL) ? (INT)nPositionSize : -1;
+	static constexpr INT	nPointSize		= (FVF & D3DFVF_PSIZE) ?
+		(INT)(nPositionSize + ((FVF & D3DFVF_NORMAL) ? 12 : 0)) : -1;
+	static constexpr INT	nDiffuse		= (FVF & D3DFVF_DIFFUSE) ?
+		(INT)(nPositionSize + ((FVF & D3DFVF_NORMAL) ? 12 : 0) + ((FVF & D3DFVF_PSIZE) ? 4 : 0)) : -1;
+	static constexpr INT	nSpecular		= (FVF & D3DFVF_SPECULAR) ?
+		(INT)(SwFVFTexCoordOffset(FVF, 0) - 4) : -1;
+
+	static constexpr UINT	nNumTexCoords	= SwFVFNumTexCoords(FVF);
+	static constexpr UINT	nSize			= SwFVFTexCoordOffset(FVF, nNumTexCoords);
+
+	static constexpr INT	TexCoordOffset(UINT i)	{ return i < nNumTexCoords ? (INT)SwFVFTexCoordOffset(FVF, i) : -1; }
+	static constexpr UINT	TexCoordSize(UINT i)	{ return i < nNumTexCoords ? SwFVFTexCoordSize(FVF, i) : 0; }
+
+	static_assert(nPositionSize > 0, "FVF에 위치 요소가 없다");
+	static_assert(nSize % 4 == 0, "FVF 요소는 모두 4바이트 단위다");
+};
+
+// 손으로 쓴 정점 구조체가 FVF 구성과 같은 크기인지 컴파일 시간에 확인한다.
+#define SW_ASSERT_FVF_VERTEX(type, fvf) \
+	static_assert(sizeof(type) == SW_FVFTRAITS<(fvf)>::nSize, "sizeof(" #type ")가 " #fvf "의 정점 크기와 다르다")
+
+//-----------------------------------------------------------------------------
+// FVF 구성대로 놓인 정점
+// 요소는 접근자로 읽고 쓴다. FVF에 없는 요소의 접근자는 컴파일되지 않는다.
+//-----------------------------------------------------------------------------
+template<DWORD FVF>
+struct SW_FVFVERTEX
+{
+	typedef SW_FVFTRAITS<FVF>	Traits;
+
+	float	Data[Traits::nSize / sizeof(float)];
+
+	float*			Position()			{ return Data; }
+	const float*	Position() const	{ return Data; }
+	VOID			SetPosition(float x, float y, float z) { Data[0] = x; Data[1] = y; Data[2] = z; }
+
+	float*			Normal()			{ static_assert(Traits::nNormal >= 0, "FVF에 법선이 없다"); return Data + Traits::nNormal / 4; }
+	const float*	Normal() const		{ static_assert(Traits::nNormal >= 0, "FVF에 법선이 없다"); return Data + Traits::nNormal / 4; }
+	VOID			SetNormal(float x, float y, float z) { float* p = Normal(); p[0] = x; p[1] = y; p[2] = z; }
+
+	float&			PointSize()			{ static_assert(Traits::nPointSize >= 0, "FVF에 점 크기가 없다"); return Data[Traits::nPointSize / 4]; }
+
+	// 색은 float 배열 안에 있으므로 memcpy로 옮긴다.
+	DWORD			GetDiffuse() const			{ static_assert(Traits::nDiffuse >= 0, "FVF에 확산색이 없다"); DWORD c; memcpy(&c, &Data[Traits::nDiffuse / 4], 4); return c; }
+	VOID			SetDiffuse(DWORD c)			{ static_assert(Traits::nDiffuse >= 0, "FVF에 확산색이 없다"); memcpy(&Data[Traits::nDiffuse / 4], &c, 4); }
+	DWORD			GetSpecular() const			{ static_assert(Traits::nSpecular >= 0, "FVF에 반사색이 없다"); DWORD c; memcpy(&c, &Data[Traits::nSpecular / 4], 4); return c; }
+	VOID			SetSpecular(DWORD c)		{ static_assert(Traits::nSpecular >= 0, "FVF에 반사색이 없다"); memcpy(&Data[Traits::nSpecular / 4], &c, 4); }
+
+	template<UINT i> float*			TexCoord()			{ static_assert(i < Traits::nNumTexCoords, "FVF에 없는 텍스처 좌표 집합"); return Data + Traits::TexCoordOffset(i) / 4; }
+	template<UINT i> const float*	TexCoord() const	{ static_assert(i < Traits::nNumTexCoords, "FVF에 없는 텍스처 좌표 집합"); return Data + Traits::TexCoordOffset(i) / 4; }
+	template<UINT i> VOID			SetTexCoord(float u, float v) { float* p = TexCoord<i>(); p[0] = u; p[1] = v; }
+};
+
+//-----------------------------------------------------------------------------
+// FVF별 정점 커널
+// SwProcessVertices()와 계산 순서가 같으므로 결과도 같다. 양자화한 형식은 다루지 않는다.
+//-----------------------------------------------------------------------------
+typedef VOID (*SW_PROCESSVERTICESFUNC)(const SW_VERTEXSTATE* pState, const BYTE* pSrc, UINT nStride,
+	UINT nCount, SW_VERTEX* pDst);
+
+template<DWORD FVF>
+VOID SwProcessVerticesT(const SW_VERTEXSTATE* pState, const BYTE* pSrc, UINT nStride, UINT nCount, SW_VERTEX* pDst)
+{
+	typedef SW_FVFTRAITS<FVF> T;
+	static_assert(sizeof(SW_FVFVERTEX<FVF>) == T::nSize, "SW_FVFVERTEX의 크기가 FVF와 다르다");
+
+	const D3DMATRIX& W = pState->matWorld;
+	const D3DMATRIX& M = pState->matWorldViewProj;
+	const bool bLighting = !T::bTransformed && pState->bLighting;
+
+	for (UINT n = 0; n < nCount; ++n, pSrc += nStride)
+	{
+		SW_VERTEX& out = pDst[n];
+		const float* pPos = (const float*)pSrc;
+
+		if constexpr (T::bTransformed)
+		{
+			out.x = pPos[0];
+			out.y = pPos[1];
+			out.z = pPos[2];
+			out.w = (pPos[3] != 0.0f) ? 1.0f / pPos[3] : 1.0f;
+		}
+		else
+		{
+			const float x = pPos[0], y = pPos[1], z = pPos[2];
+			out.x = x * M._11 + y * M._21 + z * M._31 + M._41;
+			out.y = x * M._12 + y * M._22 + z * M._32 + M._42;
+			out.z = x * M._13 + y * M._23 + z * M._33 + M._43;
+			out.w = x * M._14 + y * M._24 + z * M._34 + M._44;
+		}
+
+		float diffuse[4], specular[4];
+		const float* pDiffuse = NULL;
+		const float* pSpecular = NULL;
+		if constexpr (T::nDiffuse >= 0)
+		{
+			SwUnpackColor(*(const DWORD*)(pSrc + T::nDiffuse), diffuse);
+			pDiffuse = diffuse;
+		}
+		if constexpr (T::nSpecular >= 0)
+		{
+			SwUnpackColor(*(const DWORD*)(pSrc + T::nSpecular), specular);
+			pSpecular = specular;
+		}
+
+		if (bLighting)
+		{
+			const float x = pPos[0], y = pPos[1], z = pPos[2];
+			D3DVECTOR P;
+			P.x = x * W._11 + y * W._21 + z * W._31 + W._41;
+			P.y = x * W._12 + y * W._22 + z * W._32 + W._42;
+			P.z = x * W._13 + y * W._23 + z * W._33 + W._43;
+
+			D3DVECTOR N;
+			const D3DVECTOR* pN = NULL;
+			if constexpr (T::nNormal >= 0)
+			{
+				const float* pSrcN = (const float*)(pSrc + T::nNormal);
+				N.x = pSrcN[0] * W._11 + pSrcN[1] * W._21 + pSrcN[2] * W._31;
+				N.y = pSrcN[0] * W._12 + pSrcN[1] * W._22 + pSrcN[2] * W._32;
+				N.z = pSrcN[0] * W._13 + pSrcN[1] * W._23 + pSrcN[2] * W._33;
+				SwVec3Normalize(&N, &N);
+				pN = &N;
+			}
+
+			SwLightVertex(pState, &P, pN, pDiffuse, pSpecular, out.color);
+		}
+		else if constexpr (T::nDiffuse >= 0)
+		{
+			out.color[0] = diffuse[0];
+			out.color[1] = diffuse[1];
+			out.color[2] = diffuse[2];
+			out.color[3] = diffuse[3];
+		}
+		else
+		{
+			out.color[0] = out.color[1] = out.color[2] = out.color[3] = 1.0f;
+		}
+
+		for (UINT t = 0; t < SW_MAX_TEXCOORDS; ++t)
+		{
+			if (t < T::nNumTexCoords)
+			{
+				const float* pTex = (const float*)(pSrc + T::TexCoordOffset(t));
+				out.tex[t][0] = pTex[0];
+				out.tex[t][1] = (T::TexCoordSize(t) > 1) ? pTex[1] : 0.0f;
+			}
+			else
+			{
+				out.tex[t][0] = out.tex[t][1] = 0.0f;
+			}
+		}
+	}
+}
+
+// 미리 인스턴스화해 둔 FVF(예제와 .x 메시가 쓰는 것들)의 커널. 없으면 NULL이다.
+SW_PROCESSVERTICESFUNC	SwGetVertexKernel(DWORD dwFVF);
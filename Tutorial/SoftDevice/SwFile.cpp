@@ -0,0 +1,135 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwFile.cpp
+//
+// 설명:	CSwMappedFile 구현(Windows: 파일 매핑 개체, 그 외: mmap).
+//-----------------------------------------------------------------------------
+#include "SwFile.h"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+CSwMappedFile::CSwMappedFile()
+	: m_pData(NULL)
+	, m_nSize(0)
+#if defined(_WIN32)
+	, m_hFile(INVALID_HANDLE_VALUE)
+	, m_hMapping(NULL)
+#else
+	, m_nFile(-1)
+#endif
+{
+}
+
+CSwMappedFile::~CSwMappedFile()
+{
+	Close();
+}
+
+#if defined(_WIN32)
+
+HRESULT CSwMappedFile::Open(const char* pFilename)
+{
+	Close();
+
+	m_hFile = CreateFileA(pFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m_hFile == INVALID_HANDLE_VALUE)
+		return D3DERR_NOTFOUND;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_hFile, &size))
+	{
+		Close();
+		return E_FAIL;
+	}
+	m_nSize = (size_t)size.QuadPart;
+
+	// 크기가 0인 파일은 매핑할 수 없으므로 빈 내용으로 둔다.
+	if (m_nSize == 0)
+		return S_OK;
+
+	m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping == NULL)
+	{
+		Close();
+		return E_FAIL;
+	}
+
+	m_pData = (const BYTE*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (m_pData == NULL)
+	{
+		Close();
+		return E_OUTOFMEMORY;
+	}
+	return S_OK;
+}
+
+VOID CSwMappedFile::Close()
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (m_hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(m_hFile);
+
+	m_pData = NULL;
+	m_nSize = 0;
+	m_hMapping = NULL;
+	m_hFile = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+HRESULT CSwMappedFile::Open(const char* pFilename)
+{
+	Close();
+
+	m_nFile = open(pFilename, O_RDONLY);
+	if (m_nFile < 0)
+		return D3DERR_NOTFOUND;
+
+	struct stat st;
+	if (fstat(m_nFile, &st) != 0)
+	{
+		Close();
+		return E_FAIL;
+	}
+	m_nSize = (size_t)st.st_size;
+
+	if (m_nSize == 0)
+		return S_OK;
+
+	void* pData = mmap(NULL, m_nSize, PROT_READ, MAP_PRIVATE, m_nFile, 0);
+	if (pData == MAP_FAILED)
+	{
+		Close();
+		return E_OUTOFMEMORY;
+	}
+	madvise(pData, m_nSize, MADV_SEQUENTIAL);
+	m_pData = (const BYTE*)pData;
+	return S_OK;
+}
+
+VOID CSwMappedFile::Close()
+{
+	if (m_pData)
+		munmap((void*)m_pData, m_nSize);
+	if (m_nFile >= 0)
+		close(m_nFile);
+
+	m_pData = NULL;
+	m_nSize = 0;
+	m_nFile = -1;
+}
+
+#endif
@@ -0,0 +1,39 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwFile.h
+//
+// 설명:	읽기 전용 메모리 맵 파일.
+//		파일 내용을 복사하지 않고 주소 공간에 그대로 연결하므로
+//		큰 파일도 필요한 부분만 운영체제가 읽어 온다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <cstddef>
+
+class CSwMappedFile
+{
+public:
+	CSwMappedFile();
+	~CSwMappedFile();
+
+	CSwMappedFile(const CSwMappedFile&) = delete;
+	CSwMappedFile& operator=(const CSwMappedFile&) = delete;
+
+	// 파일을 연다. 파일이 없으면 D3DERR_NOTFOUND를 돌려준다.
+	HRESULT		Open(const char* pFilename);
+	VOID		Close();
+
+	const BYTE*	GetData() const { return m_pData; }
+	size_t		GetSize() const { return m_nSize; }
+
+private:
+	const BYTE*	m_pData;
+	size_t		m_nSize;
+#if defined(_WIN32)
+	void*		m_hFile;
+	void*		m_hMapping;
+#else
+	int			m_nFile;
+#endif
+};
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwHash.cpp
+//
+// 설명:	SwHash64() 구현. 상수와 단계는 xxHash64 명세를 그대로 따른다.
+//-----------------------------------------------------------------------------
+#include "SwHash.h"
+
+#include <cstring>
+
+static const UINT64 PRIME1 = 0x9E3779B185EBCA87ull;
+static const UINT64 PRIME2 = 0xC2B2AE3D27D4EB4Full;
+static const UINT64 PRIME3 = 0x165667B19E3779F9ull;
+static const UINT64 PRIME4 = 0x85EBCA77C2B2AE63ull;
+static const UINT64 PRIME5 = 0x27D4EB2F165667C5ull;
+
+static inline UINT64 RotateLeft(UINT64 x, int r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+// 정렬되지 않은 주소에서도 읽을 수 있도록 memcpy를 쓴다. 컴파일러가 mov 하나로 바꾼다.
+static inline UINT64 Read64(const BYTE* p)
+{
+	UINT64 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline UINT Read32(const BYTE* p)
+{
+	UINT v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline UINT64 Round(UINT64 acc, UINT64 input)
+{
+	acc += input * PRIME2;
+	acc = RotateLeft(acc, 31);
+	return acc * PRIME1;
+}
+
+static inline UINT64 MergeRound(UINT64 acc, UINT64 val)
+{
+	acc ^= Round(0, val);
+	return acc * PRIME1 + PRIME4;
+}
+
+UINT64 SwHash64(const void* pData, size_t nSize, UINT64 nSeed)
+{
+	const BYTE* p = (const BYTE*)pData;
+	const BYTE* end = p + nSize;
+	UINT64 h;
+
+	if (nSize >= 32)
+	{
+		UINT64 v1 = nSeed + PRIME1 + PRIME2;
+		UINT64 v2 = nSeed + PRIME2;
+		UINT64 v3 = nSeed;
+		UINT64 v4 = nSeed - PRIME1;
+
+		const BYTE* pLimit = end - 32;
+		do
+		{
+			v1 = Round(v1, Read64(p));
+			v2 = Round(v2, Read64(p + 8));
+			v3 = Round(v3, Read64(p + 16));
+			v4 = Round(v4, Read64(p + 24));
+			p += 32;
+		} while (p <= pLimit);
+
+		h = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		h = MergeRound(h, v1);
+		h = MergeRound(h, v2);
+		h = MergeRound(h, v3);
+		h = MergeRound(h, v4);
+	}
+	else
+	{
+		h = nSeed + PRIME5;
+	}
+
+	h += (UINT64)nSize;
+
+	// 남은 바이트
+	while (p + 8 <= end)
+	{
+		h ^= Round(0, Read64(p));
+		h = RotateLeft(h, 27) * PRIME1 + PRIME4;
+		p += 8;
+	}
+	if (p + 4 <= end)
+	{
+		h ^= (UINT64)Read32(p) * PRIME1;
+		h = RotateLeft(h, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	while (p < end)
+	{
+		h ^= (UINT64)(*p) * PRIME5;
+		h = RotateLeft(h, 11) * PRIME1;
+		++p;
+	}
+
+	// 마지막 섞기
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
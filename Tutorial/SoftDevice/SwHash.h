@@ -0,0 +1,14 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwHash.h
+//
+// 설명:	파일 내용을 식별하는 64비트 해시(xxHash64와 같은 알고리즘).
+//		8바이트씩 4개 줄기로 나누어 섞으므로 메모리 대역폭에 가까운 속도로 계산되어,
+//		캐시를 쓸지 정하려고 원본 파일 전체를 해시해도 파싱에 비하면 비용이 거의 없다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <cstddef>
+
+UINT64	SwHash64(const void* pData, size_t nSize, UINT64 nSeed = 0);
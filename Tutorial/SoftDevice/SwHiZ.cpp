@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwHiZ.cpp
+//
+// 설명:	계층 Z 버퍼 갱신.
+//-----------------------------------------------------------------------------
+#include "SwHiZ.h"
+
+#include <algorithm>
+
+VOID SwUpdateHiZBlock(const SW_RENDERTARGET* pRT, UINT nBlockX, UINT nBlockY)
+{
+	const UINT x0 = nBlockX * SW_BLOCK_SIZE;
+	const UINT y0 = nBlockY * SW_BLOCK_SIZE;
+	const UINT x1 = std::min<UINT>(x0 + SW_BLOCK_SIZE, pRT->nWidth);
+	const UINT y1 = std::min<UINT>(y0 + SW_BLOCK_SIZE, pRT->nHeight);
+
+	float fMin = pRT->pDepth[(size_t)y0 * pRT->nWidth + x0];
+	float fMax = fMin;
+	for (UINT y = y0; y < y1; ++y)
+	{
+		const float* pRow = pRT->pDepth + (size_t)y * pRT->nWidth;
+		for (UINT x = x0; x < x1; ++x)
+		{
+			fMin = std::min(fMin, pRow[x]);
+			fMax = std::max(fMax, pRow[x]);
+		}
+	}
+
+	SW_HIZBLOCK* pBlock = &pRT->pHiZ[(size_t)nBlockY * pRT->nHiZPitch + nBlockX];
+	pBlock->fMin = fMin;
+	pBlock->fMax = fMax;
+}
+
+VOID SwClearHiZ(const SW_RENDERTARGET* pRT, LONG x1, LONG y1, LONG x2, LONG y2, float fZ)
+{
+	if (x1 >= x2 || y1 >= y2)
+		return;
+
+	const UINT bx0 = (UINT)x1 / SW_BLOCK_SIZE;
+	const UINT by0 = (UINT)y1 / SW_BLOCK_SIZE;
+	const UINT bx1 = (UINT)(x2 - 1) / SW_BLOCK_SIZE;
+	const UINT by1 = (UINT)(y2 - 1) / SW_BLOCK_SIZE;
+
+	for (UINT by = by0; by <= by1; ++by)
+	{
+		for (UINT bx = bx0; bx <= bx1; ++bx)
+		{
+			// 블록 전체가 지워졌으면 바로 채우고, 일부만 지워졌으면 다시 계산한다.
+			const LONG nLeft = (LONG)(bx * SW_BLOCK_SIZE);
+			const LONG nTop = (LONG)(by * SW_BLOCK_SIZE);
+			const LONG nRight = std::min<LONG>(nLeft + SW_BLOCK_SIZE, (LONG)pRT->nWidth);
+			const LONG nBottom = std::min<LONG>(nTop + SW_BLOCK_SIZE, (LONG)pRT->nHeight);
+			if (x1 <= nLeft && y1 <= nTop && x2 >= nRight && y2 >= nBottom)
+			{
+				SW_HIZBLOCK* pBlock = &pRT->pHiZ[(size_t)by * pRT->nHiZPitch + bx];
+				pBlock->fMin = fZ;
+				pBlock->fMax = fZ;
+			}
+			else
+			{
+				SwUpdateHiZBlock(pRT, bx, by);
+			}
+		}
+	}
+}
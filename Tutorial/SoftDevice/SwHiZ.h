@@ -0,0 +1,44 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwHiZ.h
+//
+// 설명:	계층 Z 버퍼(Hi-Z).
+//		Z 버퍼의 8x8 블록마다 깊이의 최소, 최대값을 두고, 블록 안의 삼각형 깊이 범위와 비교하여
+//		깊이 테스트를 하나도 통과할 수 없는 삼각형과 블록을 픽셀 처리 전에 버린다.
+//		깊이를 기록한 블록은 그 자리에서 다시 계산하므로(incremental) 항상 정확한 범위를 갖는다.
+//		블록은 타일 경계에 맞추어져 있으므로 타일 작업자끼리 잠금 없이 갱신할 수 있다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwPipeline.h"
+
+// 깊이 범위 [fZMin, fZMax]인 픽셀들이 블록 pBlock에서 깊이 테스트를 하나도 통과할 수 없는가.
+// EQUAL, NOTEQUAL, ALWAYS는 판정하지 않는다.
+inline bool SwHiZRejects(DWORD dwZFunc, float fZMin, float fZMax, const SW_HIZBLOCK* pBlock)
+{
+	switch (dwZFunc)
+	{
+	case D3DCMP_NEVER:			return true;
+	case D3DCMP_LESS:			return fZMin >= pBlock->fMax;
+	case D3DCMP_LESSEQUAL:		return fZMin > pBlock->fMax;
+	case D3DCMP_GREATER:		return fZMax <= pBlock->fMin;
+	case D3DCMP_GREATEREQUAL:	return fZMax < pBlock->fMin;
+	default:					return false;
+	}
+}
+
+// Hi-Z로 판정할 수 있는 비교 함수인가
+inline bool SwHiZSupportsFunc(DWORD dwZFunc)
+{
+	return dwZFunc == D3DCMP_NEVER || dwZFunc == D3DCMP_LESS || dwZFunc == D3DCMP_LESSEQUAL ||
+		dwZFunc == D3DCMP_GREATER || dwZFunc == D3DCMP_GREATEREQUAL;
+}
+
+// Hi-Z 크기(블록 수)
+inline UINT SwGetHiZPitch(UINT nWidth)	{ return (nWidth + SW_BLOCK_SIZE - 1) / SW_BLOCK_SIZE; }
+inline UINT SwGetHiZRows(UINT nHeight)	{ return (nHeight + SW_BLOCK_SIZE - 1) / SW_BLOCK_SIZE; }
+
+// 블록 (nBlockX, nBlockY)의 범위를 Z 버퍼에서 다시 계산한다.
+VOID	SwUpdateHiZBlock(const SW_RENDERTARGET* pRT, UINT nBlockX, UINT nBlockY);
+
+// Z 버퍼의 사각형 [x1, x2) x [y1, y2)를 fZ로 지운 다음 호출하여 겹치는 블록을 갱신한다.
+VOID	SwClearHiZ(const SW_RENDERTARGET* pRT, LONG x1, LONG y1, LONG x2, LONG y2, float fZ);
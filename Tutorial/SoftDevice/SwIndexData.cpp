@@ -0,0 +1,397 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwIndexData.cpp
+//
+// 설명:	인덱스 버퍼 형식 선택, 나누기, 압축 구현.
+//		SIMD 디코더는 SwEdgeKernel.cpp와 같이 함수 단위로 명령어 집합을 지정하고 실행 중에 고른다.
+//-----------------------------------------------------------------------------
+#include "SwIndexData.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SW_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_SSSE3		__attribute__((target("ssse3")))
+#else
+#define SW_TARGET_SSSE3
+#endif
+
+#define SW_INDEX_NONE		0xffffffff
+
+VOID SwWriteIndices(const DWORD* pSrc, UINT nCount, DWORD nBase, D3DFORMAT Format, VOID* pDst)
+{
+	if (Format == D3DFMT_INDEX32)
+	{
+		DWORD* pDst32 = (DWORD*)pDst;
+		for (UINT i = 0; i < nCount; ++i)
+			pDst32[i] = pSrc[i] - nBase;
+	}
+	else
+	{
+		WORD* pDst16 = (WORD*)pDst;
+		for (UINT i = 0; i < nCount; ++i)
+			pDst16[i] = (WORD)(pSrc[i] - nBase);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 나누기
+//-----------------------------------------------------------------------------
+class CIndexSplitter
+{
+public:
+	CIndexSplitter(SW_MESHDATA* pMesh, std::vector<SW_MESHSUBSET>* pRanges, std::vector<DWORD>* pIndices)
+		: m_pMesh(pMesh), m_pRanges(pRanges), m_pIndices(pIndices), m_localOf(pMesh->nNumVertices, SW_INDEX_NONE)
+	{
+	}
+
+	VOID	SplitSubset(const SW_MESHSUBSET& subset);
+
+private:
+	enum MODE { MODE_NONE, MODE_RANGE, MODE_COPY };
+
+	VOID	AddToRange(const DWORD* pFace);
+	VOID	AddToCopy(const DWORD* pFace);
+	VOID	Close();
+
+	SW_MESHDATA*					m_pMesh;
+	std::vector<SW_MESHSUBSET>*		m_pRanges;
+	std::vector<DWORD>*				m_pIndices;		// 범위마다 VertexStart 기준
+
+	// 만드는 중인 조각
+	MODE				m_eMode;
+	DWORD				m_dwAttribId;
+	UINT				m_nFaceStart;
+	std::vector<DWORD>	m_Faces;			// 원래 정점 번호
+	DWORD				m_nMin, m_nMax;		// MODE_RANGE
+	std::vector<DWORD>	m_Locals;			// MODE_COPY: 조각 안 번호 -> 원래 정점 번호
+	std::vector<DWORD>	m_localOf;			// MODE_COPY: 원래 정점 번호 -> 조각 안 번호
+};
+
+VOID CIndexSplitter::SplitSubset(const SW_MESHSUBSET& subset)
+{
+	m_eMode = MODE_NONE;
+	m_dwAttribId = subset.AttribId;
+	m_nFaceStart = (UINT)(m_pIndices->size() / 3);
+
+	const DWORD* pFaces = &m_pMesh->Indices[(size_t)subset.FaceStart * 3];
+	for (UINT f = 0; f < subset.FaceCount; ++f)
+	{
+		const DWORD* pFace = pFaces + f * 3;
+		const DWORD nMin = std::min(pFace[0], std::min(pFace[1], pFace[2]));
+		const DWORD nMax = std::max(pFace[0], std::max(pFace[1], pFace[2]));
+		if (nMax - nMin < SW_INDEX16_MAX_VERTICES)
+			AddToRange(pFace);
+		else
+			AddToCopy(pFace);
+	}
+	Close();
+}
+
+// 정점 범위가 65536을 넘기 직전까지 삼각형을 모은다.
+VOID CIndexSplitter::AddToRange(const DWORD* pFace)
+{
+	const DWORD nMin = std::min(pFace[0], std::min(pFace[1], pFace[2]));
+	const DWORD nMax = std::max(pFace[0], std::max(pFace[1], pFace[2]));
+	if (m_eMode == MODE_RANGE &&
+		std::max(m_nMax, nMax) - std::min(m_nMin, nMin) >= SW_INDEX16_MAX_VERTICES)
+	{
+		Close();
+	}
+	if (m_eMode == MODE_COPY)
+		Close();
+
+	if (m_eMode == MODE_NONE)
+	{
+		m_eMode = MODE_RANGE;
+		m_nMin = nMin;
+		m_nMax = nMax;
+	}
+	else
+	{
+		m_nMin = std::min(m_nMin, nMin);
+		m_nMax = std::max(m_nMax, nMax);
+	}
+	m_Faces.insert(m_Faces.end(), pFace, pFace + 3);
+}
+
+// 한 삼각형이 65536보다 넓게 걸치면 정점을 복사하는 조각에 넣는다.
+VOID CIndexSplitter::AddToCopy(const DWORD* pFace)
+{
+	if (m_eMode == MODE_RANGE || (m_eMode == MODE_COPY && m_Locals.size() + 3 > SW_INDEX16_MAX_VERTICES))
+		Close();
+	m_eMode = MODE_COPY;
+
+	for (UINT c = 0; c < 3; ++c)
+	{
+		DWORD& nLocal = m_localOf[pFace[c]];
+		if (nLocal == SW_INDEX_NONE)
+		{
+			nLocal = (DWORD)m_Locals.size();
+			m_Locals.push_back(pFace[c]);
+		}
+	}
+	m_Faces.insert(m_Faces.end(), pFace, pFace + 3);
+}
+
+VOID CIndexSplitter::Close()
+{
+	if (m_eMode == MODE_NONE)
+		return;
+
+	SW_MESHSUBSET range;
+	range.AttribId = m_dwAttribId;
+	range.FaceStart = m_nFaceStart;
+	range.FaceCount = (DWORD)(m_Faces.size() / 3);
+
+	if (m_eMode == MODE_RANGE)
+	{
+		range.VertexStart = m_nMin;
+		range.VertexCount = m_nMax - m_nMin + 1;
+		for (size_t i = 0; i < m_Faces.size(); ++i)
+			m_pIndices->push_back(m_Faces[i] - m_nMin);
+	}
+	else
+	{
+		// 쓰는 정점을 처음 쓰인 순서대로 정점 배열 끝에 복사한다.
+		const UINT nVertexSize = m_pMesh->nVertexSize;
+		range.VertexStart = m_pMesh->nNumVertices;
+		range.VertexCount = (DWORD)m_Locals.size();
+
+		m_pMesh->Vertices.resize((size_t)(m_pMesh->nNumVertices + m_Locals.size()) * nVertexSize);
+		BYTE* pDst = &m_pMesh->Vertices[(size_t)m_pMesh->nNumVertices * nVertexSize];
+		for (size_t i = 0; i < m_Locals.size(); ++i)
+			memcpy(pDst + i * nVertexSize, &m_pMesh->Vertices[(size_t)m_Locals[i] * nVertexSize], nVertexSize);
+		m_pMesh->nNumVertices += (UINT)m_Locals.size();
+
+		for (size_t i = 0; i < m_Faces.size(); ++i)
+			m_pIndices->push_back(m_localOf[m_Faces[i]]);
+		for (size_t i = 0; i < m_Locals.size(); ++i)
+			m_localOf[m_Locals[i]] = SW_INDEX_NONE;
+		m_Locals.clear();
+	}
+
+	m_pRanges->push_back(range);
+	m_nFaceStart += range.FaceCount;
+	m_Faces.clear();
+	m_eMode = MODE_NONE;
+}
+
+VOID SwBuildIndexData(SW_MESHDATA* pMesh, DWORD dwFlags, SW_INDEXDATA* pOut)
+{
+	pOut->Ranges.clear();
+
+	std::vector<DWORD> indices;
+	indices.reserve(pMesh->Indices.size());
+
+	bool bFits16 = true;
+	for (size_t s = 0; s < pMesh->Subsets.size(); ++s)
+		bFits16 = bFits16 && pMesh->Subsets[s].VertexCount <= SW_INDEX16_MAX_VERTICES;
+
+	if ((dwFlags & SW_INDEX_SPLIT) && !bFits16)
+	{
+		CIndexSplitter splitter(pMesh, &pOut->Ranges, &indices);
+		for (size_t s = 0; s < pMesh->Subsets.size(); ++s)
+		{
+			const SW_MESHSUBSET& subset = pMesh->Subsets[s];
+			if (subset.VertexCount <= SW_INDEX16_MAX_VERTICES)
+			{
+				SW_MESHSUBSET range = subset;
+				range.FaceStart = (DWORD)(indices.size() / 3);
+				for (size_t i = (size_t)subset.FaceStart * 3; i < (size_t)(subset.FaceStart + subset.FaceCount) * 3; ++i)
+					indices.push_back(pMesh->Indices[i] - subset.VertexStart);
+				pOut->Ranges.push_back(range);
+			}
+			else
+			{
+				splitter.SplitSubset(subset);
+			}
+		}
+		bFits16 = true;
+	}
+	else
+	{
+		// 부분 집합 그대로, VertexStart 기준으로 바꾸기만 한다.
+		for (size_t s = 0; s < pMesh->Subsets.size(); ++s)
+		{
+			const SW_MESHSUBSET& subset = pMesh->Subsets[s];
+			SW_MESHSUBSET range = subset;
+			range.FaceStart = (DWORD)(indices.size() / 3);
+			for (size_t i = (size_t)subset.FaceStart * 3; i < (size_t)(subset.FaceStart + subset.FaceCount) * 3; ++i)
+				indices.push_back(pMesh->Indices[i] - subset.VertexStart);
+			pOut->Ranges.push_back(range);
+		}
+	}
+
+	pOut->Format = (bFits16 && !(dwFlags & SW_INDEX_32BIT)) ? D3DFMT_INDEX16 : D3DFMT_INDEX32;
+	pOut->Indices.resize(indices.size() * pOut->GetIndexSize());
+	if (!indices.empty())
+		SwWriteIndices(indices.data(), (UINT)indices.size(), 0, pOut->Format, pOut->Indices.data());
+}
+
+//-----------------------------------------------------------------------------
+// 압축: 스칼라
+//-----------------------------------------------------------------------------
+static inline DWORD ZigZagEncode(DWORD nDelta)
+{
+	return (nDelta << 1) ^ (DWORD)((INT)nDelta >> 31);
+}
+
+static inline DWORD ZigZagDecode(DWORD n)
+{
+	return (n >> 1) ^ (0u - (n & 1));
+}
+
+size_t SwEncodeIndices(const DWORD* pIndices, UINT nCount, BYTE* pOut)
+{
+	BYTE* pControl = pOut;
+	BYTE* pData = pOut + (nCount + 3) / 4;
+	memset(pControl, 0, (nCount + 3) / 4);
+
+	DWORD nPrev = 0;
+	for (UINT i = 0; i < nCount; ++i)
+	{
+		DWORD n = ZigZagEncode(pIndices[i] - nPrev);
+		nPrev = pIndices[i];
+
+		const UINT nBytes = (n < (1u << 8)) ? 1 : (n < (1u << 16)) ? 2 : (n < (1u << 24)) ? 3 : 4;
+		pControl[i / 4] |= (BYTE)((nBytes - 1) << ((i % 4) * 2));
+		for (UINT b = 0; b < nBytes; ++b)
+		{
+			*pData++ = (BYTE)n;
+			n >>= 8;
+		}
+	}
+	return (size_t)(pData - pOut);
+}
+
+// 값 하나씩 푼다. SIMD 구현의 나머지 처리에도 쓴다.
+static bool DecodeIndicesScalar(const BYTE* pControl, const BYTE* pData, const BYTE* pEnd,
+	UINT nBegin, UINT nCount, DWORD nPrev, DWORD* pOut)
+{
+	for (UINT i = nBegin; i < nCount; ++i)
+	{
+		const UINT nBytes = ((pControl[i / 4] >> ((i % 4) * 2)) & 3) + 1;
+		if (pData + nBytes > pEnd)
+			return false;
+
+		DWORD n = 0;
+		for (UINT b = 0; b < nBytes; ++b)
+			n |= (DWORD)pData[b] << (b * 8);
+		pData += nBytes;
+
+		nPrev += ZigZagDecode(n);
+		pOut[i] = nPrev;
+	}
+	return pData == pEnd;
+}
+
+//-----------------------------------------------------------------------------
+// 압축: SSSE3
+// 제어 바이트 하나로 값 4개의 바이트 수가 정해지므로, 제어 바이트 값마다 pshufb 셔플 마스크와
+// 읽을 바이트 수를 표로 만들어 둔다. 지그재그 복원과 누적 합도 4개씩 한다.
+//-----------------------------------------------------------------------------
+#ifdef SW_X86
+
+struct STREAMVBYTE_TABLES
+{
+	alignas(16) BYTE	Shuffle[256][16];
+	BYTE				Length[256];
+
+	STREAMVBYTE_TABLES()
+	{
+		for (UINT c = 0; c < 256; ++c)
+		{
+			UINT nOffset = 0;
+			for (UINT k = 0; k < 4; ++k)
+			{
+				const UINT nBytes = ((c >> (k * 2)) & 3) + 1;
+				for (UINT b = 0; b < 4; ++b)
+					Shuffle[c][k * 4 + b] = (b < nBytes) ? (BYTE)(nOffset + b) : 0x80;
+				nOffset += nBytes;
+			}
+			Length[c] = (BYTE)nOffset;
+		}
+	}
+};
+
+static const STREAMVBYTE_TABLES s_StreamVByte;
+
+SW_TARGET_SSSE3
+static bool DecodeIndicesSSSE3(const BYTE* pData, size_t nSize, UINT nCount, DWORD* pOut)
+{
+	const BYTE* pControl = pData;
+	const BYTE* p = pData + (nCount + 3) / 4;
+	const BYTE* pEnd = pData + nSize;
+
+	const __m128i one = _mm_set1_epi32(1);
+	const __m128i zero = _mm_setzero_si128();
+	__m128i prev = zero;
+
+	// 한 번에 16바이트를 읽으므로 남은 데이터가 16바이트 이상일 때만 SIMD로 푼다.
+	UINT i = 0;
+	for (; i + 4 <= nCount && p + 16 <= pEnd; i += 4)
+	{
+		const BYTE nControl = pControl[i / 4];
+		const __m128i data = _mm_loadu_si128((const __m128i*)p);
+		const __m128i zz = _mm_shuffle_epi8(data, _mm_load_si128((const __m128i*)s_StreamVByte.Shuffle[nControl]));
+		p += s_StreamVByte.Length[nControl];
+
+		// 지그재그 복원: (n >> 1) ^ -(n & 1)
+		__m128i delta = _mm_xor_si128(_mm_srli_epi32(zz, 1), _mm_sub_epi32(zero, _mm_and_si128(zz, one)));
+
+		// 누적 합
+		delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 4));
+		delta = _mm_add_epi32(delta, _mm_slli_si128(delta, 8));
+		prev = _mm_add_epi32(delta, _mm_shuffle_epi32(prev, _MM_SHUFFLE(3, 3, 3, 3)));
+		_mm_storeu_si128((__m128i*)(pOut + i), prev);
+	}
+
+	const DWORD nPrev = (i > 0) ? pOut[i - 1] : 0;
+	return DecodeIndicesScalar(pControl, p, pEnd, i, nCount, nPrev, pOut);
+}
+
+static bool HasSSSE3()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[2] & (1 << 9)) != 0;
+#else
+	return __builtin_cpu_supports("ssse3") != 0;
+#endif
+}
+
+#endif	// SW_X86
+
+static bool DecodeIndicesPortable(const BYTE* pData, size_t nSize, UINT nCount, DWORD* pOut)
+{
+	return DecodeIndicesScalar(pData, pData + (nCount + 3) / 4, pData + nSize, 0, nCount, 0, pOut);
+}
+
+typedef bool (*DECODEINDICESFUNC)(const BYTE* pData, size_t nSize, UINT nCount, DWORD* pOut);
+
+static DECODEINDICESFUNC GetBestIndexDecoder()
+{
+#ifdef SW_X86
+	if (HasSSSE3())
+		return DecodeIndicesSSSE3;
+#endif
+	return DecodeIndicesPortable;
+}
+
+static const DECODEINDICESFUNC s_pfnDecodeIndices = GetBestIndexDecoder();
+
+bool SwDecodeIndices(const BYTE* pData, size_t nSize, UINT nCount, DWORD* pOut)
+{
+	if (nSize < (size_t)(nCount + 3) / 4)
+		return false;
+	return s_pfnDecodeIndices(pData, nSize, nCount, pOut);
+}
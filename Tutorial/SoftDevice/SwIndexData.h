@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwIndexData.h
+//
+// 설명:	인덱스 버퍼 형식 선택, 16비트로 나누기, 압축 저장.
+//
+//		형식 선택: 그리기 범위마다 인덱스를 그 범위의 첫 정점(VertexStart) 기준으로 저장하고
+//		DrawIndexedPrimitive()의 BaseVertexIndex로 VertexStart를 넘긴다. 그러면 메시 전체의 정점이
+//		65536개를 넘어도 부분 집합마다 65536개 이하만 쓰면 16비트 인덱스로 충분하다.
+//
+//		나누기: 정점을 65536개보다 넓게 쓰는 부분 집합은 삼각형 순서대로 16비트로 가리킬 수 있는
+//		조각으로 나눈다. 조각이 쓰는 정점 범위가 65536 이하이면 정점을 그대로 쓰고,
+//		한 삼각형이 그보다 넓게 걸치는 드문 경우에만 그 조각의 정점을 정점 배열 끝에 복사한다.
+//
+//		압축: 인덱스를 바로 앞 인덱스와의 차이(지그재그 부호화)로 바꾸어 Stream VByte 형식으로 저장한다.
+//		값 4개마다 제어 바이트 하나(값마다 2비트, 바이트 수 - 1)와 1 ~ 4바이트의 값들이 따로 모여 있어서
+//		SSSE3의 pshufb 한 번으로 값 4개를 풀 수 있다. 정점 캐시, 읽기 순서 최적화를 거친 메시는
+//		차이가 대부분 1바이트이므로 32비트 인덱스의 3분의 1 정도 크기가 된다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwMesh.h"
+
+#define SW_INDEX16_MAX_VERTICES		65536
+
+// SwBuildIndexData() 플래그
+#define SW_INDEX_SPLIT				0x00000001	// 넓은 부분 집합을 16비트 조각으로 나눈다(정점이 늘 수 있다)
+#define SW_INDEX_32BIT				0x00000002	// 항상 32비트 인덱스를 쓴다
+
+//-----------------------------------------------------------------------------
+// 인덱스 버퍼 하나와 그리기 범위
+// 범위 r은 DrawIndexedPrimitive(D3DPT_TRIANGLELIST, r.VertexStart, 0, r.VertexCount, r.FaceStart * 3, r.FaceCount)로
+// 그린다. 나누어진 부분 집합은 같은 AttribId를 갖는 범위가 여러 개 이어진다.
+//-----------------------------------------------------------------------------
+struct SW_INDEXDATA
+{
+	D3DFORMAT					Format;		// D3DFMT_INDEX16 또는 D3DFMT_INDEX32
+	std::vector<BYTE>			Indices;	// 범위마다 VertexStart 기준
+	std::vector<SW_MESHSUBSET>	Ranges;
+
+	UINT	GetIndexSize() const { return Format == D3DFMT_INDEX32 ? 4 : 2; }
+	UINT	GetNumIndices() const { return (UINT)(Indices.size() / GetIndexSize()); }
+};
+
+// 정점 nNumVertices개를 가리킬 수 있는 가장 작은 인덱스 형식
+inline D3DFORMAT SwChooseIndexFormat(UINT nNumVertices)
+{
+	return nNumVertices <= SW_INDEX16_MAX_VERTICES ? D3DFMT_INDEX16 : D3DFMT_INDEX32;
+}
+
+// 32비트 인덱스 nCount개에서 nBase를 빼어 Format 형식으로 pDst(잠근 인덱스 버퍼 등)에 쓴다.
+VOID	SwWriteIndices(const DWORD* pSrc, UINT nCount, DWORD nBase, D3DFORMAT Format, VOID* pDst);
+
+// 메시의 부분 집합들로 인덱스 버퍼와 그리기 범위를 만든다.
+// SW_INDEX_SPLIT이 없으면 16비트로 가리킬 수 없는 부분 집합이 하나라도 있을 때 32비트를 쓴다.
+// SW_INDEX_SPLIT이 있으면 항상 16비트이고, 복사한 정점은 pMesh->Vertices 끝에 붙는다.
+VOID	SwBuildIndexData(SW_MESHDATA* pMesh, DWORD dwFlags, SW_INDEXDATA* pOut);
+
+//-----------------------------------------------------------------------------
+// 압축 저장
+//-----------------------------------------------------------------------------
+
+// 압축한 크기의 상한(바이트). 인코딩 버퍼를 미리 잡을 때 쓴다.
+inline size_t SwGetMaxEncodedIndexSize(UINT nCount)
+{
+	return (size_t)(nCount + 3) / 4 + (size_t)nCount * 4;
+}
+
+// pIndices nCount개를 압축하여 pOut에 쓰고 실제 크기를 돌려준다. pOut은 SwGetMaxEncodedIndexSize()바이트 이상이어야 한다.
+size_t	SwEncodeIndices(const DWORD* pIndices, UINT nCount, BYTE* pOut);
+
+// 압축된 nSize바이트를 풀어 pOut에 nCount개를 쓴다. 데이터가 잘못되었으면 false.
+// SSSE3를 지원하는 CPU에서는 SIMD로, 그 외에는 스칼라로 푼다(결과는 같다).
+bool	SwDecodeIndices(const BYTE* pData, size_t nSize, UINT nCount, DWORD* pOut);
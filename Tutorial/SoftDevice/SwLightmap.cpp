@@ -0,0 +1,560 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwLightmap.cpp
+//
+// 설명:	라이트맵 굽기 구현.
+//		텍셀 값은 고정 기능 조명과 같은 단위(재질 색 1.0에 대한 Diffuse * N.L * 감쇠)를 쓴다.
+//		면에서 나가는 빛은 (반사율 * 그 면의 라이트맵 값)이므로, 코사인 가중 방향으로 보낸 경로가
+//		닿은 면마다 처리량(throughput)에 반사율을 곱하고 그 면의 직접광을 더하면 간접광이 된다.
+//-----------------------------------------------------------------------------
+#include "SwLightmap.h"
+#include "SwBvh.h"
+#include "SwMath.h"
+#include "SwMipmap.h"
+#include "SwResource.h"
+#include "SwThreadPool.h"
+
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#define SW_BAKE_TILE_SIZE		16			// 스레드 작업 하나가 맡는 텍셀 타일의 변 길이
+#define SW_BAKE_DILATE_PASSES	4			// 빈 텍셀을 이웃 값으로 채우는 횟수(텍셀 단위 거리)
+#define SW_BAKE_BIAS_SCALE		1e-4f		// 광선 시작점을 면에서 띄우는 거리(장면 크기에 대한 비율)
+#define SW_BAKE_NO_TRIANGLE		0xffffffff
+
+static inline double ElapsedMs(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+namespace
+{
+	// 삼각형이 덮은 텍셀의 표면 정보
+	struct BAKETEXEL
+	{
+		D3DVECTOR	Position;
+		D3DVECTOR	Normal;			// 보간한 법선
+		D3DVECTOR	Offset;			// 광선 시작점 이동량(법선 쪽을 향한 면 법선 * 거리)
+		UINT		nTriangle;
+	};
+
+	struct BAKETRIANGLE
+	{
+		D3DVECTOR	FaceNormal;
+		FLOAT		Albedo[3];
+	};
+
+	// 스레드별 광선 수. 스레드끼리 같은 캐시 라인을 쓰지 않게 띄운다.
+	struct alignas(64) RAYCOUNTER
+	{
+		UINT64	nRays;
+	};
+
+	struct BAKECONTEXT
+	{
+		const SW_BAKESCENE*			pScene;
+		const SW_BAKEPARAMS*		pParams;
+		const CSwBvh*				pBvh;
+		const BAKETRIANGLE*			pTriangles;
+		const BAKETEXEL*			pTexels;
+		FLOAT*						pColors;		// 텍셀마다 RGB
+		FLOAT						fBias;
+	};
+
+	inline D3DVECTOR Add(const D3DVECTOR& a, const D3DVECTOR& b) { return SwVec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+	inline D3DVECTOR Sub(const D3DVECTOR& a, const D3DVECTOR& b) { return SwVec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+	inline D3DVECTOR Scale(const D3DVECTOR& a, FLOAT s) { return SwVec3(a.x * s, a.y * s, a.z * s); }
+	inline FLOAT Dot(const D3DVECTOR& a, const D3DVECTOR& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	inline D3DVECTOR Normalize(const D3DVECTOR& a)
+	{
+		const FLOAT fLen = sqrtf(Dot(a, a));
+		return (fLen > 0.0f) ? Scale(a, 1.0f / fLen) : SwVec3(0.0f, 0.0f, 1.0f);
+	}
+
+	// 텍셀 위치로 씨앗을 정하는 xorshift 난수. 실행마다, 스레드 배분과 상관없이 같은 값을 낸다.
+	struct BAKERANDOM
+	{
+		UINT	nState;
+
+		explicit BAKERANDOM(UINT nSeed)
+		{
+			// Wang 해시로 이웃 텍셀의 씨앗이 서로 닮지 않게 한다.
+			nSeed = (nSeed ^ 61) ^ (nSeed >> 16);
+			nSeed *= 9;
+			nSeed ^= nSeed >> 4;
+			nSeed *= 0x27d4eb2d;
+			nSeed ^= nSeed >> 15;
+			nState = nSeed ? nSeed : 0x9e3779b9;
+		}
+
+		FLOAT Next()
+		{
+			nState ^= nState << 13;
+			nState ^= nState >> 17;
+			nState ^= nState << 5;
+			return (FLOAT)(nState >> 8) * (1.0f / 16777216.0f);
+		}
+	};
+
+	// 법선 N 둘레의 코사인 가중 방향
+	D3DVECTOR SampleCosine(const D3DVECTOR& N, FLOAT r1, FLOAT r2)
+	{
+		const FLOAT fPhi = 6.28318531f * r1;
+		const FLOAT fR = sqrtf(r2);
+		const FLOAT x = fR * cosf(fPhi);
+		const FLOAT y = fR * sinf(fPhi);
+		const FLOAT z = sqrtf(1.0f - r2 > 0.0f ? 1.0f - r2 : 0.0f);
+
+		// N에 수직인 두 축(Duff 외, "Building an Orthonormal Basis, Revisited")
+		const FLOAT fSign = (N.z >= 0.0f) ? 1.0f : -1.0f;
+		const FLOAT a = -1.0f / (fSign + N.z);
+		const FLOAT b = N.x * N.y * a;
+		const D3DVECTOR T = SwVec3(1.0f + fSign * N.x * N.x * a, fSign * b, -fSign * N.x);
+		const D3DVECTOR B = SwVec3(b, fSign + N.y * N.y * a, -N.y);
+		return SwVec3(T.x * x + B.x * y + N.x * z, T.y * x + B.y * y + N.y * z, T.z * x + B.z * y + N.z * z);
+	}
+
+	// 점 P(법선 N)가 받는 직접광. 고정 기능 조명의 감쇠, 스폿 원뿔 식에 그림자 광선을 더한 것이다.
+	VOID GatherDirect(const BAKECONTEXT& ctx, const D3DVECTOR& P, const D3DVECTOR& N, const D3DVECTOR& Offset,
+		FLOAT* pOut, UINT64* pRays)
+	{
+		const SW_BAKESCENE* pScene = ctx.pScene;
+		for (UINT i = 0; i < pScene->nNumLights; ++i)
+		{
+			const D3DLIGHT9& light = pScene->pLights[i];
+
+			D3DVECTOR L;
+			FLOAT fAtten = 1.0f;
+			SW_RAY shadow;
+			shadow.Origin = Add(P, Offset);
+			if (light.Type == D3DLIGHT_DIRECTIONAL)
+			{
+				L = Normalize(Scale(light.Direction, -1.0f));
+				shadow.Direction = L;
+				shadow.tMax = FLT_MAX;
+			}
+			else
+			{
+				const D3DVECTOR ToLight = Sub(light.Position, P);
+				const FLOAT fDist = sqrtf(Dot(ToLight, ToLight));
+				if (fDist > light.Range || fDist <= 0.0f)
+					continue;
+				L = Scale(ToLight, 1.0f / fDist);
+
+				const FLOAT fDen = light.Attenuation0 + light.Attenuation1 * fDist + light.Attenuation2 * fDist * fDist;
+				fAtten = (fDen > 0.0f) ? 1.0f / fDen : 1.0f;
+
+				if (light.Type == D3DLIGHT_SPOT)
+				{
+					const D3DVECTOR D = Normalize(light.Direction);
+					const FLOAT rho = -Dot(L, D);
+					const FLOAT fCosPhi = cosf(light.Phi * 0.5f);
+					const FLOAT fCosTheta = cosf(light.Theta * 0.5f);
+					if (rho <= fCosPhi)
+						continue;
+					if (rho < fCosTheta && fCosTheta > fCosPhi)
+						fAtten *= powf((rho - fCosPhi) / (fCosTheta - fCosPhi), light.Falloff);
+				}
+
+				// 방향을 광원까지의 벡터로 두면 t = 1이 광원이다.
+				shadow.Direction = Sub(light.Position, shadow.Origin);
+				shadow.tMax = 1.0f - SW_BAKE_BIAS_SCALE;
+			}
+
+			const FLOAT fNdotL = Dot(N, L);
+			if (fNdotL <= 0.0f)
+				continue;
+
+			++*pRays;
+			if (ctx.pBvh->Occluded(shadow))
+				continue;
+
+			const FLOAT f = fNdotL * fAtten;
+			pOut[0] += light.Diffuse.r * f;
+			pOut[1] += light.Diffuse.g * f;
+			pOut[2] += light.Diffuse.b * f;
+		}
+	}
+
+	// 텍셀 하나의 값(직접광 + 간접광)
+	VOID BakeTexel(const BAKECONTEXT& ctx, const BAKETEXEL& texel, UINT nSeed, FLOAT* pOut, UINT64* pRays)
+	{
+		const SW_BAKESCENE* pScene = ctx.pScene;
+		const SW_BAKEPARAMS* pParams = ctx.pParams;
+
+		FLOAT direct[3] = { 0.0f, 0.0f, 0.0f };
+		GatherDirect(ctx, texel.Position, texel.Normal, texel.Offset, direct, pRays);
+
+		FLOAT indirect[3] = { 0.0f, 0.0f, 0.0f };
+		if (pParams->nBounces > 0 && pParams->nSamples > 0)
+		{
+			BAKERANDOM random(nSeed);
+			for (UINT s = 0; s < pParams->nSamples; ++s)
+			{
+				D3DVECTOR P = texel.Position;
+				D3DVECTOR N = texel.Normal;
+				D3DVECTOR Offset = texel.Offset;
+				FLOAT throughput[3] = { 1.0f, 1.0f, 1.0f };
+
+				for (UINT nBounce = 0; nBounce < pParams->nBounces; ++nBounce)
+				{
+					const FLOAT r1 = random.Next();
+					const FLOAT r2 = random.Next();
+
+					SW_RAY ray;
+					ray.Origin = Add(P, Offset);
+					ray.Direction = SampleCosine(N, r1, r2);
+					ray.tMax = FLT_MAX;
+
+					SW_RAYHIT hit;
+					++*pRays;
+					if (!ctx.pBvh->Intersect(ray, &hit))
+					{
+						indirect[0] += throughput[0] * pScene->Sky.r;
+						indirect[1] += throughput[1] * pScene->Sky.g;
+						indirect[2] += throughput[2] * pScene->Sky.b;
+						break;
+					}
+
+					// 닿은 면의 위치와 법선. 면은 양면으로 보고 광선이 온 쪽을 향하게 뒤집는다.
+					const BAKETRIANGLE& tri = ctx.pTriangles[hit.nTriangle];
+					const DWORD* pIndex = pScene->pIndices + (size_t)hit.nTriangle * 3;
+					const SW_BAKEVERTEX& v0 = pScene->pVertices[pIndex[0]];
+					const SW_BAKEVERTEX& v1 = pScene->pVertices[pIndex[1]];
+					const SW_BAKEVERTEX& v2 = pScene->pVertices[pIndex[2]];
+					const FLOAT w = 1.0f - hit.u - hit.v;
+
+					P = Add(ray.Origin, Scale(ray.Direction, hit.t));
+					N = Normalize(SwVec3(
+						v0.Normal.x * w + v1.Normal.x * hit.u + v2.Normal.x * hit.v,
+						v0.Normal.y * w + v1.Normal.y * hit.u + v2.Normal.y * hit.v,
+						v0.Normal.z * w + v1.Normal.z * hit.u + v2.Normal.z * hit.v));
+					D3DVECTOR Ng = tri.FaceNormal;
+					if (Dot(Ng, ray.Direction) > 0.0f)
+						Ng = Scale(Ng, -1.0f);
+					if (Dot(N, Ng) < 0.0f)
+						N = Scale(N, -1.0f);
+					Offset = Scale(Ng, ctx.fBias);
+
+					throughput[0] *= tri.Albedo[0];
+					throughput[1] *= tri.Albedo[1];
+					throughput[2] *= tri.Albedo[2];
+
+					FLOAT light[3] = { 0.0f, 0.0f, 0.0f };
+					GatherDirect(ctx, P, N, Offset, light, pRays);
+					indirect[0] += throughput[0] * light[0];
+					indirect[1] += throughput[1] * light[1];
+					indirect[2] += throughput[2] * light[2];
+				}
+			}
+
+			const FLOAT fInvSamples = 1.0f / (FLOAT)pParams->nSamples;
+			indirect[0] *= fInvSamples;
+			indirect[1] *= fInvSamples;
+			indirect[2] *= fInvSamples;
+		}
+
+		pOut[0] = direct[0] + indirect[0];
+		pOut[1] = direct[1] + indirect[1];
+		pOut[2] = direct[2] + indirect[2];
+	}
+
+	// 삼각형을 라이트맵 UV 공간에 래스터화한다. 텍셀 중심이 삼각형 안에 있으면 덮은 것으로 보고,
+	// 여러 삼각형이 덮으면 먼저 그린 것을 쓴다.
+	UINT RasterizeTexels(const SW_BAKESCENE* pScene, const BAKETRIANGLE* pTriangles, FLOAT fBias,
+		UINT nWidth, UINT nHeight, BAKETEXEL* pTexels)
+	{
+		UINT nCovered = 0;
+		for (UINT nTri = 0; nTri < pScene->nNumTriangles; ++nTri)
+		{
+			const DWORD* pIndex = pScene->pIndices + (size_t)nTri * 3;
+			const SW_BAKEVERTEX* v[3] = { &pScene->pVertices[pIndex[0]], &pScene->pVertices[pIndex[1]], &pScene->pVertices[pIndex[2]] };
+
+			// 텍셀 좌표(텍셀 중심이 x + 0.5)
+			FLOAT x[3], y[3];
+			for (UINT i = 0; i < 3; ++i)
+			{
+				x[i] = v[i]->u * (FLOAT)nWidth;
+				y[i] = v[i]->v * (FLOAT)nHeight;
+			}
+			const FLOAT fArea = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+			if (fabsf(fArea) < 1e-12f)
+				continue;
+			const FLOAT fInvArea = 1.0f / fArea;
+
+			INT nMinX = (INT)floorf(std::fmin(x[0], std::fmin(x[1], x[2])));
+			INT nMinY = (INT)floorf(std::fmin(y[0], std::fmin(y[1], y[2])));
+			INT nMaxX = (INT)ceilf(std::fmax(x[0], std::fmax(x[1], x[2])));
+			INT nMaxY = (INT)ceilf(std::fmax(y[0], std::fmax(y[1], y[2])));
+			if (nMinX < 0) nMinX = 0;
+			if (nMinY < 0) nMinY = 0;
+			if (nMaxX > (INT)nWidth - 1) nMaxX = (INT)nWidth - 1;
+			if (nMaxY > (INT)nHeight - 1) nMaxY = (INT)nHeight - 1;
+
+			const D3DVECTOR& Ng = pTriangles[nTri].FaceNormal;
+			for (INT ty = nMinY; ty <= nMaxY; ++ty)
+			{
+				const FLOAT py = (FLOAT)ty + 0.5f;
+				for (INT tx = nMinX; tx <= nMaxX; ++tx)
+				{
+					const FLOAT px = (FLOAT)tx + 0.5f;
+					const FLOAT b1 = ((px - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (py - y[0])) * fInvArea;
+					const FLOAT b2 = ((x[1] - x[0]) * (py - y[0]) - (px - x[0]) * (y[1] - y[0])) * fInvArea;
+					const FLOAT b0 = 1.0f - b1 - b2;
+					if (b0 < 0.0f || b1 < 0.0f || b2 < 0.0f)
+						continue;
+
+					BAKETEXEL& texel = pTexels[(size_t)ty * nWidth + tx];
+					if (texel.nTriangle != SW_BAKE_NO_TRIANGLE)
+						continue;
+
+					texel.Position = SwVec3(
+						v[0]->Position.x * b0 + v[1]->Position.x * b1 + v[2]->Position.x * b2,
+						v[0]->Position.y * b0 + v[1]->Position.y * b1 + v[2]->Position.y * b2,
+						v[0]->Position.z * b0 + v[1]->Position.z * b1 + v[2]->Position.z * b2);
+					texel.Normal = Normalize(SwVec3(
+						v[0]->Normal.x * b0 + v[1]->Normal.x * b1 + v[2]->Normal.x * b2,
+						v[0]->Normal.y * b0 + v[1]->Normal.y * b1 + v[2]->Normal.y * b2,
+						v[0]->Normal.z * b0 + v[1]->Normal.z * b1 + v[2]->Normal.z * b2));
+					// 광선은 보간한 법선 쪽으로 나가므로 시작점도 그쪽 면으로 띄운다.
+					texel.Offset = Scale(Ng, (Dot(Ng, texel.Normal) >= 0.0f) ? fBias : -fBias);
+					texel.nTriangle = nTri;
+					++nCovered;
+				}
+			}
+		}
+		return nCovered;
+	}
+
+	// 빈 텍셀을 덮인 이웃 8개의 평균으로 채운다. 한 번에 한 텍셀씩 번진다.
+	VOID DilateTexels(UINT nWidth, UINT nHeight, std::vector<FLOAT>* pColors, std::vector<BYTE>* pCovered)
+	{
+		std::vector<FLOAT> colors;
+		std::vector<BYTE> covered;
+		for (UINT nPass = 0; nPass < SW_BAKE_DILATE_PASSES; ++nPass)
+		{
+			colors = *pColors;
+			covered = *pCovered;
+			bool bChanged = false;
+			for (UINT y = 0; y < nHeight; ++y)
+			{
+				for (UINT x = 0; x < nWidth; ++x)
+				{
+					const size_t i = (size_t)y * nWidth + x;
+					if (covered[i])
+						continue;
+
+					FLOAT sum[3] = { 0.0f, 0.0f, 0.0f };
+					UINT nCount = 0;
+					for (INT dy = -1; dy <= 1; ++dy)
+					{
+						const INT ny = (INT)y + dy;
+						if (ny < 0 || ny >= (INT)nHeight)
+							continue;
+						for (INT dx = -1; dx <= 1; ++dx)
+						{
+							const INT nx = (INT)x + dx;
+							if (nx < 0 || nx >= (INT)nWidth)
+								continue;
+							const size_t j = (size_t)ny * nWidth + nx;
+							if (!covered[j])
+								continue;
+							sum[0] += colors[j * 3 + 0];
+							sum[1] += colors[j * 3 + 1];
+							sum[2] += colors[j * 3 + 2];
+							++nCount;
+						}
+					}
+					if (nCount == 0)
+						continue;
+
+					const FLOAT fInv = 1.0f / (FLOAT)nCount;
+					(*pColors)[i * 3 + 0] = sum[0] * fInv;
+					(*pColors)[i * 3 + 1] = sum[1] * fInv;
+					(*pColors)[i * 3 + 2] = sum[2] * fInv;
+					(*pCovered)[i] = 1;
+					bChanged = true;
+				}
+			}
+			if (!bChanged)
+				break;
+		}
+	}
+
+	inline DWORD ToColorChannel(FLOAT f)
+	{
+		if (!(f > 0.0f))
+			return 0;
+		if (f >= 1.0f)
+			return 255;
+		return (DWORD)(f * 255.0f + 0.5f);
+	}
+
+	inline FLOAT FromColorChannel(D3DCOLOR c, UINT nShift)
+	{
+		return (FLOAT)((c >> nShift) & 0xff) * (1.0f / 255.0f);
+	}
+}
+
+HRESULT SwBakeLightmap(const SW_BAKESCENE* pScene, const SW_BAKEPARAMS* pParams, CSwTexture** ppLightmap,
+	SW_BAKESTATS* pStats, CSwThreadPool* pThreadPool)
+{
+	if (pScene == NULL || pParams == NULL || ppLightmap == NULL)
+		return D3DERR_INVALIDCALL;
+	if (pScene->pVertices == NULL || pScene->pIndices == NULL || pScene->nNumTriangles == 0 ||
+		(pScene->nNumLights > 0 && pScene->pLights == NULL) || pParams->nWidth == 0 || pParams->nHeight == 0)
+	{
+		return D3DERR_INVALIDCALL;
+	}
+	for (size_t i = 0; i < (size_t)pScene->nNumTriangles * 3; ++i)
+	{
+		if (pScene->pIndices[i] >= pScene->nNumVertices)
+			return D3DERR_INVALIDCALL;
+	}
+
+	const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	SW_BAKESTATS stats = {};
+
+	// BVH
+	std::chrono::steady_clock::time_point t0 = tStart;
+	CSwBvh bvh;
+	HRESULT hr = bvh.Build(&pScene->pVertices[0].Position, sizeof(SW_BAKEVERTEX), pScene->nNumVertices,
+		pScene->pIndices, pScene->nNumTriangles);
+	if (FAILED(hr))
+		return hr;
+	stats.fBuildMs = ElapsedMs(t0);
+
+	// 삼각형별 면 법선과 반사율, 광선 시작점을 띄울 거리
+	t0 = std::chrono::steady_clock::now();
+	D3DVECTOR Min = pScene->pVertices[0].Position;
+	D3DVECTOR Max = Min;
+	for (UINT i = 1; i < pScene->nNumVertices; ++i)
+	{
+		const D3DVECTOR& P = pScene->pVertices[i].Position;
+		Min = SwVec3(std::fmin(Min.x, P.x), std::fmin(Min.y, P.y), std::fmin(Min.z, P.z));
+		Max = SwVec3(std::fmax(Max.x, P.x), std::fmax(Max.y, P.y), std::fmax(Max.z, P.z));
+	}
+	const D3DVECTOR Extent = Sub(Max, Min);
+	const FLOAT fBias = sqrtf(Dot(Extent, Extent)) * SW_BAKE_BIAS_SCALE;
+
+	std::vector<BAKETRIANGLE> triangles(pScene->nNumTriangles);
+	for (UINT i = 0; i < pScene->nNumTriangles; ++i)
+	{
+		const DWORD* pIndex = pScene->pIndices + (size_t)i * 3;
+		const D3DVECTOR& P0 = pScene->pVertices[pIndex[0]].Position;
+		const D3DVECTOR E1 = Sub(pScene->pVertices[pIndex[1]].Position, P0);
+		const D3DVECTOR E2 = Sub(pScene->pVertices[pIndex[2]].Position, P0);
+		D3DVECTOR Ng;
+		SwVec3Cross(&Ng, &E1, &E2);
+		triangles[i].FaceNormal = Normalize(Ng);
+
+		const D3DCOLOR Albedo = pScene->pAlbedo ? pScene->pAlbedo[i] : D3DCOLOR_XRGB(128, 128, 128);
+		triangles[i].Albedo[0] = FromColorChannel(Albedo, 16);
+		triangles[i].Albedo[1] = FromColorChannel(Albedo, 8);
+		triangles[i].Albedo[2] = FromColorChannel(Albedo, 0);
+	}
+
+	const UINT nWidth = pParams->nWidth;
+	const UINT nHeight = pParams->nHeight;
+	const size_t nNumTexels = (size_t)nWidth * nHeight;
+	std::vector<BAKETEXEL> texels(nNumTexels);
+	for (BAKETEXEL& texel : texels)
+		texel.nTriangle = SW_BAKE_NO_TRIANGLE;
+	stats.nTexels = RasterizeTexels(pScene, triangles.data(), fBias, nWidth, nHeight, texels.data());
+	stats.fRasterMs = ElapsedMs(t0);
+
+	// 광선 추적. 타일 하나가 작업 하나이고, 빈 타일은 바로 끝나므로 작업 카운터가 부하를 고르게 한다.
+	t0 = std::chrono::steady_clock::now();
+	if (pThreadPool == NULL)
+		pThreadPool = SwGetDefaultThreadPool();
+
+	std::vector<FLOAT> colors(nNumTexels * 3, 0.0f);
+	std::vector<RAYCOUNTER> counters(pThreadPool ? pThreadPool->GetNumThreads() : 1);
+	for (RAYCOUNTER& counter : counters)
+		counter.nRays = 0;
+
+	BAKECONTEXT ctx;
+	ctx.pScene = pScene;
+	ctx.pParams = pParams;
+	ctx.pBvh = &bvh;
+	ctx.pTriangles = triangles.data();
+	ctx.pTexels = texels.data();
+	ctx.pColors = colors.data();
+	ctx.fBias = fBias;
+
+	const UINT nTilesX = (nWidth + SW_BAKE_TILE_SIZE - 1) / SW_BAKE_TILE_SIZE;
+	const UINT nTilesY = (nHeight + SW_BAKE_TILE_SIZE - 1) / SW_BAKE_TILE_SIZE;
+	auto bakeTile = [&](UINT nTile, UINT nThread)
+	{
+		const UINT x0 = (nTile % nTilesX) * SW_BAKE_TILE_SIZE;
+		const UINT y0 = (nTile / nTilesX) * SW_BAKE_TILE_SIZE;
+		const UINT x1 = (x0 + SW_BAKE_TILE_SIZE < nWidth) ? x0 + SW_BAKE_TILE_SIZE : nWidth;
+		const UINT y1 = (y0 + SW_BAKE_TILE_SIZE < nHeight) ? y0 + SW_BAKE_TILE_SIZE : nHeight;
+
+		UINT64 nRays = 0;
+		for (UINT y = y0; y < y1; ++y)
+		{
+			for (UINT x = x0; x < x1; ++x)
+			{
+				const size_t i = (size_t)y * nWidth + x;
+				if (ctx.pTexels[i].nTriangle != SW_BAKE_NO_TRIANGLE)
+					BakeTexel(ctx, ctx.pTexels[i], (UINT)i, &ctx.pColors[i * 3], &nRays);
+			}
+		}
+		counters[nThread].nRays += nRays;
+	};
+
+	if (pThreadPool)
+	{
+		pThreadPool->ParallelFor(nTilesX * nTilesY, bakeTile);
+	}
+	else
+	{
+		for (UINT i = 0; i < nTilesX * nTilesY; ++i)
+			bakeTile(i, 0);
+	}
+
+	for (const RAYCOUNTER& counter : counters)
+		stats.nRays += counter.nRays;
+	stats.fTraceMs = ElapsedMs(t0);
+	stats.fMRaysPerSec = (stats.fTraceMs > 0.0) ? (double)stats.nRays / (stats.fTraceMs * 1000.0) : 0.0;
+
+	// 빈 텍셀 채우기
+	std::vector<BYTE> covered(nNumTexels);
+	for (size_t i = 0; i < nNumTexels; ++i)
+		covered[i] = (texels[i].nTriangle != SW_BAKE_NO_TRIANGLE) ? 1 : 0;
+	DilateTexels(nWidth, nHeight, &colors, &covered);
+
+	// X8R8G8B8로 옮기고 밉을 만든다. 값은 조명 세기(선형)이므로 감마 변환 없이 줄인다.
+	CSwTexture* pTexture = new CSwTexture(nWidth, nHeight, pParams->nLevels, D3DFMT_X8R8G8B8);
+	D3DLOCKED_RECT rect;
+	if (SUCCEEDED(hr = pTexture->LockRect(0, &rect, NULL, 0)))
+	{
+		for (UINT y = 0; y < nHeight; ++y)
+		{
+			DWORD* pRow = (DWORD*)((BYTE*)rect.pBits + (ptrdiff_t)y * rect.Pitch);
+			const FLOAT* pColor = &colors[(size_t)y * nWidth * 3];
+			for (UINT x = 0; x < nWidth; ++x, pColor += 3)
+			{
+				pRow[x] = 0xff000000 | (ToColorChannel(pColor[0]) << 16) |
+					(ToColorChannel(pColor[1]) << 8) | ToColorChannel(pColor[2]);
+			}
+		}
+		pTexture->UnlockRect(0);
+	}
+	if (SUCCEEDED(hr) && pTexture->GetLevelCount() > 1)
+		hr = SwGenerateMipmaps(pTexture, SW_MIPFILTER_BOX, SW_MIPMAP_LINEAR, pThreadPool);
+	if (FAILED(hr))
+	{
+		pTexture->Release();
+		return hr;
+	}
+
+	stats.fTotalMs = ElapsedMs(tStart);
+	if (pStats)
+		*pStats = stats;
+	*ppLightmap = pTexture;
+	return S_OK;
+}
@@ -0,0 +1,66 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwLightmap.h
+//
+// 설명:	광선 추적 라이트맵 굽기.
+//		장면의 삼각형을 라이트맵 UV 공간에 래스터화하여 텍셀마다 표면 위치와 법선을 구하고,
+//		각 텍셀에서 D3DLIGHT9 광원들의 직접광(그림자 광선 포함)과 반구 방향 경로로 N번 튕긴 간접광을 모은다.
+//		광원 감쇠와 스폿 원뿔은 고정 기능 파이프라인과 같은 식을 쓰므로 값 1.0이 정점 조명의 최대 밝기와 같다.
+//		결과는 X8R8G8B8 텍스처로, 두 번째 텍스처 단계의 MODULATE에 그대로 쓸 수 있다.
+//
+//		광선 검사는 CSwBvh(4갈래 BVH, SSE2)로 하고, 텍셀 타일을 스레드 풀의 작업으로 나누어
+//		먼저 끝난 스레드가 남은 타일을 가져가게 한다. 난수는 텍셀 위치로 정하므로
+//		스레드 수나 광선 검사 구현과 상관없이 결과가 같다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+class CSwTexture;
+class CSwThreadPool;
+
+struct SW_BAKEVERTEX
+{
+	D3DVECTOR	Position;
+	D3DVECTOR	Normal;
+	FLOAT		u, v;			// 라이트맵 좌표([0, 1], 삼각형끼리 겹치지 않아야 한다)
+};
+
+struct SW_BAKESCENE
+{
+	const SW_BAKEVERTEX*	pVertices;
+	UINT					nNumVertices;
+	const DWORD*			pIndices;		// 삼각형마다 3개
+	UINT					nNumTriangles;
+	const D3DCOLOR*			pAlbedo;		// 삼각형마다 반사율. NULL이면 모두 50% 회색
+	const D3DLIGHT9*		pLights;
+	UINT					nNumLights;
+	D3DCOLORVALUE			Sky;			// 장면 밖으로 나간 반사광 광선이 받는 빛
+};
+
+struct SW_BAKEPARAMS
+{
+	UINT	nWidth;
+	UINT	nHeight;
+	UINT	nLevels;		// 0이면 전체 밉 체인
+	UINT	nSamples;		// 텍셀마다 반구로 보내는 경로 수
+	UINT	nBounces;		// 경로 하나가 튕기는 최대 횟수. 0이면 직접광만 굽고 Sky도 쓰지 않는다.
+};
+
+//-----------------------------------------------------------------------------
+// 굽기 시간 보고
+//-----------------------------------------------------------------------------
+struct SW_BAKESTATS
+{
+	UINT	nTexels;		// 삼각형이 덮은 텍셀 수
+	UINT64	nRays;			// 추적한 광선 수(반사광 광선과 그림자 광선)
+	double	fBuildMs;		// BVH 생성
+	double	fRasterMs;		// 라이트맵 UV 래스터화
+	double	fTraceMs;		// 광선 추적
+	double	fTotalMs;		// 빈 텍셀 채우기와 밉 생성까지 전체
+	double	fMRaysPerSec;	// nRays / fTraceMs (백만 개/초)
+};
+
+// 라이트맵을 굽는다. pThreadPool이 NULL이면 기본 풀(SwGetDefaultThreadPool())로 모든 코어를 쓴다.
+// 삼각형이 덮지 않은 텍셀은 이웃 텍셀 값으로 채워, 이중 선형 필터가 가장자리에서 검은색을 섞지 않게 한다.
+HRESULT	SwBakeLightmap(const SW_BAKESCENE* pScene, const SW_BAKEPARAMS* pParams, CSwTexture** ppLightmap,
+			SW_BAKESTATS* pStats = NULL, CSwThreadPool* pThreadPool = NULL);
@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwLz.cpp
+//
+// 설명:	LZ77 압축과 풀기.
+//-----------------------------------------------------------------------------
+#include "SwLz.h"
+
+#include <cstring>
+
+#define SW_LZ_MINMATCH		4
+#define SW_LZ_MAXDISTANCE	65535
+#define SW_LZ_HASHBITS		14
+#define SW_LZ_LASTLITERALS	5		// 블록 끝의 이 바이트들은 항상 리터럴로 둔다(일치 검사가 끝을 넘지 않도록)
+
+static inline DWORD ReadU32(const BYTE* p)
+{
+	DWORD v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static inline UINT HashU32(DWORD v)
+{
+	return (v * 2654435761u) >> (32 - SW_LZ_HASHBITS);
+}
+
+// 15 이상인 길이의 나머지를 255 단위로 쓴다.
+static inline VOID WriteLength(std::vector<BYTE>* pOut, size_t nLength)
+{
+	while (nLength >= 255)
+	{
+		pOut->push_back(255);
+		nLength -= 255;
+	}
+	pOut->push_back((BYTE)nLength);
+}
+
+static VOID WriteSequence(std::vector<BYTE>* pOut, const BYTE* pLiterals, size_t nLiterals, UINT nDistance,
+	size_t nMatch)
+{
+	const size_t nMatchCode = nMatch ? nMatch - SW_LZ_MINMATCH : 0;
+	pOut->push_back((BYTE)(((nLiterals < 15 ? nLiterals : 15) << 4) | (nMatchCode < 15 ? nMatchCode : 15)));
+	if (nLiterals >= 15)
+		WriteLength(pOut, nLiterals - 15);
+	pOut->insert(pOut->end(), pLiterals, pLiterals + nLiterals);
+
+	if (nMatch == 0)
+		return;
+	pOut->push_back((BYTE)(nDistance & 0xff));
+	pOut->push_back((BYTE)(nDistance >> 8));
+	if (nMatchCode >= 15)
+		WriteLength(pOut, nMatchCode - 15);
+}
+
+VOID SwLzCompress(const void* pSrc, size_t nSize, std::vector<BYTE>* pOut)
+{
+	const BYTE* pBase = (const BYTE*)pSrc;
+	const BYTE* pAnchor = pBase;
+	const BYTE* pEnd = pBase + nSize;
+
+	if (nSize > SW_LZ_MINMATCH + SW_LZ_LASTLITERALS)
+	{
+		// 해시 칸마다 마지막으로 본 위치(+1, 0은 빈 칸)
+		std::vector<UINT> table((size_t)1 << SW_LZ_HASHBITS, 0);
+		const BYTE* pLimit = pEnd - SW_LZ_LASTLITERALS;
+		const BYTE* p = pBase;
+		while (p + SW_LZ_MINMATCH <= pLimit)
+		{
+			const DWORD v = ReadU32(p);
+			UINT& slot = table[HashU32(v)];
+			const BYTE* pRef = slot ? pBase + slot - 1 : NULL;
+			slot = (UINT)(p - pBase) + 1;
+
+			if (pRef == NULL || p - pRef > SW_LZ_MAXDISTANCE || ReadU32(pRef) != v)
+			{
+				++p;
+				continue;
+			}
+
+			const BYTE* pMatchEnd = p + SW_LZ_MINMATCH;
+			const BYTE* q = pRef + SW_LZ_MINMATCH;
+			while (pMatchEnd < pLimit && *pMatchEnd == *q)
+			{
+				++pMatchEnd;
+				++q;
+			}
+
+			WriteSequence(pOut, pAnchor, p - pAnchor, (UINT)(p - pRef), pMatchEnd - p);
+			p = pAnchor = pMatchEnd;
+		}
+	}
+
+	WriteSequence(pOut, pAnchor, pEnd - pAnchor, 0, 0);
+}
+
+// 15로 시작한 길이의 나머지를 읽는다. 입력을 넘으면 false.
+static inline bool ReadLength(const BYTE** pp, const BYTE* pEnd, size_t* pLength)
+{
+	BYTE b;
+	do
+	{
+		if (*pp >= pEnd)
+			return false;
+		b = *(*pp)++;
+		*pLength += b;
+	} while (b == 255);
+	return true;
+}
+
+HRESULT SwLzDecompress(const void* pSrc, size_t nSrcSize, void* pDst, size_t nDstSize)
+{
+	const BYTE* p = (const BYTE*)pSrc;
+	const BYTE* pEnd = p + nSrcSize;
+	BYTE* pOut = (BYTE*)pDst;
+	BYTE* pOutEnd = pOut + nDstSize;
+
+	while (p < pEnd)
+	{
+		const BYTE token = *p++;
+		size_t nLiterals = token >> 4;
+		if (nLiterals == 15 && !ReadLength(&p, pEnd, &nLiterals))
+			return E_FAIL;
+		if (nLiterals > (size_t)(pEnd - p) || nLiterals > (size_t)(pOutEnd - pOut))
+			return E_FAIL;
+		memcpy(pOut, p, nLiterals);
+		p += nLiterals;
+		pOut += nLiterals;
+
+		if (p == pEnd)
+			break;
+
+		if (pEnd - p < 2)
+			return E_FAIL;
+		const size_t nDistance = p[0] | ((size_t)p[1] << 8);
+		p += 2;
+		size_t nMatch = token & 15;
+		if (nMatch == 15 && !ReadLength(&p, pEnd, &nMatch))
+			return E_FAIL;
+		nMatch += SW_LZ_MINMATCH;
+		if (nDistance == 0 || nDistance > (size_t)(pOut - (BYTE*)pDst) || nMatch > (size_t)(pOutEnd - pOut))
+			return E_FAIL;
+
+		// 겹칠 수 있으므로 한 바이트씩 복사한다.
+		const BYTE* pRef = pOut - nDistance;
+		for (size_t i = 0; i < nMatch; ++i)
+			pOut[i] = pRef[i];
+		pOut += nMatch;
+	}
+
+	return (pOut == pOutEnd) ? S_OK : E_FAIL;
+}
@@ -0,0 +1,21 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwLz.h
+//
+// 설명:	빠른 무손실 압축(LZ77 계열, LZ4의 블록 형식과 같은 구조).
+//		압축된 블록은 (토큰, 리터럴, 거리, 일치 길이)의 나열이다. 토큰의 상위 4비트는 리터럴 길이,
+//		하위 4비트는 일치 길이 - 4이며 15이면 뒤따르는 바이트들(255가 아닐 때까지)을 더한다.
+//		거리는 2바이트(리틀 엔디언)이므로 64KB 안에서만 일치를 찾는다. 마지막 시퀀스는 리터럴만 갖는다.
+//		압축률보다 속도를 우선하므로 캡처처럼 많은 데이터를 실시간으로 쓸 때 알맞다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <cstddef>
+#include <vector>
+
+// pSrc의 nSize바이트를 압축하여 pOut 뒤에 덧붙인다.
+VOID	SwLzCompress(const void* pSrc, size_t nSize, std::vector<BYTE>* pOut);
+
+// 압축을 풀어 pDst에 정확히 nDstSize바이트를 쓴다. 블록이 잘못되었거나 크기가 다르면 E_FAIL.
+HRESULT	SwLzDecompress(const void* pSrc, size_t nSrcSize, void* pDst, size_t nDstSize);
@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMath.cpp
+//
+// 설명:	D3DXMatrix* 함수와 같은 결과를 내는 행렬 함수 구현.
+//-----------------------------------------------------------------------------
+#include "SwMath.h"
+
+#include <cmath>
+
+D3DMATRIX* SwMatrixIdentity(D3DMATRIX* pOut)
+{
+	ZeroMemory(pOut, sizeof(D3DMATRIX));
+	pOut->_11 = pOut->_22 = pOut->_33 = pOut->_44 = 1.0f;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixMultiply(D3DMATRIX* pOut, const D3DMATRIX* pM1, const D3DMATRIX* pM2)
+{
+	// pOut이 pM1, pM2와 같은 행렬일 수 있으므로 임시 행렬에 계산한다.
+	D3DMATRIX mat;
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			mat.m[i][j] =
+				pM1->m[i][0] * pM2->m[0][j] +
+				pM1->m[i][1] * pM2->m[1][j] +
+				pM1->m[i][2] * pM2->m[2][j] +
+				pM1->m[i][3] * pM2->m[3][j];
+		}
+	}
+	*pOut = mat;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixRotationX(D3DMATRIX* pOut, FLOAT fAngle)
+{
+	FLOAT s = sinf(fAngle), c = cosf(fAngle);
+	SwMatrixIdentity(pOut);
+	pOut->_22 = c;	pOut->_23 = s;
+	pOut->_32 = -s;	pOut->_33 = c;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixRotationY(D3DMATRIX* pOut, FLOAT fAngle)
+{
+	FLOAT s = sinf(fAngle), c = cosf(fAngle);
+	SwMatrixIdentity(pOut);
+	pOut->_11 = c;	pOut->_13 = -s;
+	pOut->_31 = s;	pOut->_33 = c;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixRotationZ(D3DMATRIX* pOut, FLOAT fAngle)
+{
+	FLOAT s = sinf(fAngle), c = cosf(fAngle);
+	SwMatrixIdentity(pOut);
+	pOut->_11 = c;	pOut->_12 = s;
+	pOut->_21 = -s;	pOut->_22 = c;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixTranslation(D3DMATRIX* pOut, FLOAT x, FLOAT y, FLOAT z)
+{
+	SwMatrixIdentity(pOut);
+	pOut->_41 = x;
+	pOut->_42 = y;
+	pOut->_43 = z;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixLookAtLH(D3DMATRIX* pOut, const D3DVECTOR* pEye, const D3DVECTOR* pAt, const D3DVECTOR* pUp)
+{
+	// zaxis = normal(At - Eye), xaxis = normal(cross(Up, zaxis)), yaxis = cross(zaxis, xaxis)
+	D3DVECTOR zaxis = SwVec3(pAt->x - pEye->x, pAt->y - pEye->y, pAt->z - pEye->z);
+	SwVec3Normalize(&zaxis, &zaxis);
+	D3DVECTOR xaxis;
+	SwVec3Cross(&xaxis, pUp, &zaxis);
+	SwVec3Normalize(&xaxis, &xaxis);
+	D3DVECTOR yaxis;
+	SwVec3Cross(&yaxis, &zaxis, &xaxis);
+
+	pOut->_11 = xaxis.x;	pOut->_12 = yaxis.x;	pOut->_13 = zaxis.x;	pOut->_14 = 0.0f;
+	pOut->_21 = xaxis.y;	pOut->_22 = yaxis.y;	pOut->_23 = zaxis.y;	pOut->_24 = 0.0f;
+	pOut->_31 = xaxis.z;	pOut->_32 = yaxis.z;	pOut->_33 = zaxis.z;	pOut->_34 = 0.0f;
+	pOut->_41 = -SwVec3Dot(&xaxis, pEye);
+	pOut->_42 = -SwVec3Dot(&yaxis, pEye);
+	pOut->_43 = -SwVec3Dot(&zaxis, pEye);
+	pOut->_44 = 1.0f;
+	return pOut;
+}
+
+D3DMATRIX* SwMatrixPerspectiveFovLH(D3DMATRIX* pOut, FLOAT fFovY, FLOAT fAspect, FLOAT fZn, FLOAT fZf)
+{
+	FLOAT yScale = 1.0f / tanf(fFovY / 2.0f);
+	FLOAT xScale = yScale / fAspect;
+
+	ZeroMemory(pOut, sizeof(D3DMATRIX));
+	pOut->_11 = xScale;
+	pOut->_22 = yScale;
+	pOut->_33 = fZf / (fZf - fZn);
+	pOut->_34 = 1.0f;
+	pOut->_43 = -fZn * fZf / (fZf - fZn);
+	return pOut;
+}
+
+D3DVECTOR* SwVec3Normalize(D3DVECTOR* pOut, const D3DVECTOR* pV)
+{
+	FLOAT fLen = sqrtf(SwVec3Dot(pV, pV));
+	if (fLen > 0.0f)
+	{
+		FLOAT fInv = 1.0f / fLen;
+		*pOut = SwVec3(pV->x * fInv, pV->y * fInv, pV->z * fInv);
+	}
+	else
+	{
+		*pOut = SwVec3(0.0f, 0.0f, 0.0f);
+	}
+	return pOut;
+}
+
+WORD SwFloat32To16(FLOAT f)
+{
+	union { FLOAT f; DWORD n; } u;
+	u.f = f;
+	const WORD nSign = (WORD)((u.n >> 16) & 0x8000);
+	const DWORD nAbs = u.n & 0x7fffffff;
+
+	if (nAbs >= 0x7f800000)
+		return nSign | (WORD)(nAbs > 0x7f800000 ? 0x7e00 : 0x7c00);	// NaN, 무한대
+	if (nAbs >= 0x477ff000)
+		return nSign | 0x7c00;										// 65520 이상은 무한대
+	if (nAbs < 0x38800000)
+	{
+		// 비정규 수: 2^-24 단위로 반올림한다. 정수 변환이 가장 가까운 짝수로 맞추어 준다.
+		return nSign | (WORD)lrintf(fabsf(f) * 16777216.0f);
+	}
+
+	// 지수를 바꾸고 버리는 13비트를 가장 가까운 짝수로 반올림한다.
+	const DWORD n = nAbs - (112 << 23);
+	return nSign | (WORD)((n + 0x0fff + ((n >> 13) & 1)) >> 13);
+}
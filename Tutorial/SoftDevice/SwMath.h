@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMath.h
+//
+// 설명:	소프트웨어 디바이스용 행렬/벡터 함수.
+//		D3DX가 없는 환경에서도 예제의 SetupMatrices()를 그대로 옮길 수 있도록
+//		D3DXMatrix* 함수들과 같은 규약(왼손 좌표계, 행 벡터 * 행렬)을 따른다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#define SW_PI	3.141592654f
+
+D3DMATRIX*	SwMatrixIdentity(D3DMATRIX* pOut);
+D3DMATRIX*	SwMatrixMultiply(D3DMATRIX* pOut, const D3DMATRIX* pM1, const D3DMATRIX* pM2);
+D3DMATRIX*	SwMatrixRotationX(D3DMATRIX* pOut, FLOAT fAngle);
+D3DMATRIX*	SwMatrixRotationY(D3DMATRIX* pOut, FLOAT fAngle);
+D3DMATRIX*	SwMatrixRotationZ(D3DMATRIX* pOut, FLOAT fAngle);
+D3DMATRIX*	SwMatrixTranslation(D3DMATRIX* pOut, FLOAT x, FLOAT y, FLOAT z);
+D3DMATRIX*	SwMatrixLookAtLH(D3DMATRIX* pOut, const D3DVECTOR* pEye, const D3DVECTOR* pAt, const D3DVECTOR* pUp);
+D3DMATRIX*	SwMatrixPerspectiveFovLH(D3DMATRIX* pOut, FLOAT fFovY, FLOAT fAspect, FLOAT fZn, FLOAT fZf);
+
+D3DVECTOR*	SwVec3Normalize(D3DVECTOR* pOut, const D3DVECTOR* pV);
+
+// float를 IEEE 754 half(16비트)로 바꾼다. 가장 가까운 짝수로 반올림한다(D3DXFloat32To16Array와 같다).
+WORD		SwFloat32To16(FLOAT f);
+
+//-----------------------------------------------------------------------------
+// 인라인 벡터 연산
+//-----------------------------------------------------------------------------
+inline D3DVECTOR SwVec3(FLOAT x, FLOAT y, FLOAT z)
+{
+	D3DVECTOR v = { x, y, z };
+	return v;
+}
+
+inline FLOAT SwVec3Dot(const D3DVECTOR* pV1, const D3DVECTOR* pV2)
+{
+	return pV1->x * pV2->x + pV1->y * pV2->y + pV1->z * pV2->z;
+}
+
+inline D3DVECTOR* SwVec3Cross(D3DVECTOR* pOut, const D3DVECTOR* pV1, const D3DVECTOR* pV2)
+{
+	D3DVECTOR v;
+	v.x = pV1->y * pV2->z - pV1->z * pV2->y;
+	v.y = pV1->z * pV2->x - pV1->x * pV2->z;
+	v.z = pV1->x * pV2->y - pV1->y * pV2->x;
+	*pOut = v;
+	return pOut;
+}
+
+// half를 float로 바꾼다. 모든 half 값(비정규 수, 무한대, NaN 포함)을 정확히 표현할 수 있다.
+inline FLOAT SwFloat16To32(WORD h)
+{
+	const DWORD nSign = (DWORD)(h & 0x8000) << 16;
+	const DWORD nExp = (h >> 10) & 0x1f;
+	const DWORD nMant = h & 0x3ff;
+
+	union { DWORD n; FLOAT f; } u;
+	if (nExp == 0x1f)
+	{
+		u.n = nSign | 0x7f800000 | (nMant << 13);
+	}
+	else if (nExp != 0)
+	{
+		u.n = nSign | ((nExp + 112) << 23) | (nMant << 13);
+	}
+	else
+	{
+		// 0과 비정규 수: 가수 * 2^-24
+		u.f = (FLOAT)nMant * (1.0f / 16777216.0f);
+		u.n |= nSign;
+	}
+	return u.f;
+}
@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMesh.h
+//
+// 설명:	장치와 무관한 메시 데이터.
+//		정점은 FVF 순서대로 채운 바이트 배열이므로 그대로 정점 버퍼에 복사할 수 있고,
+//		삼각형은 재질(속성) 순서로 정렬되어 있어 부분 집합(subset)마다 연속된 범위를 차지한다.
+//		SW_MESHSUBSET의 멤버는 D3DXATTRIBUTERANGE와 같은 순서, 같은 이름이다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// 재질(D3DXMATERIAL에 해당)
+//-----------------------------------------------------------------------------
+struct SW_MATERIAL
+{
+	D3DMATERIAL9	MatD3D;
+	std::string		strTextureFilename;		// 없으면 빈 문자열
+};
+
+//-----------------------------------------------------------------------------
+// 부분 집합 하나의 범위(D3DXATTRIBUTERANGE에 해당)
+//-----------------------------------------------------------------------------
+struct SW_MESHSUBSET
+{
+	DWORD	AttribId;
+	DWORD	FaceStart;
+	DWORD	FaceCount;
+	DWORD	VertexStart;
+	DWORD	VertexCount;
+};
+
+//-----------------------------------------------------------------------------
+// 변환 후 정점 캐시 효율(SwMeshOptimize.h)
+//-----------------------------------------------------------------------------
+struct SW_VCACHESTATS
+{
+	float	fACMR;		// 삼각형당 캐시 실패 수(0.5 ~ 3)
+	float	fATVR;		// 쓰인 정점당 변환 횟수(1이 최선)
+};
+
+//-----------------------------------------------------------------------------
+// 정점 읽기 효율(SwMeshOptimize.h)
+//-----------------------------------------------------------------------------
+struct SW_VFETCHSTATS
+{
+	UINT	nNumVertices;
+	float	fOverfetch;	// 캐시 줄 단위로 읽은 바이트 / 정점 배열 크기(1이 최선)
+};
+
+//-----------------------------------------------------------------------------
+// 메시
+//-----------------------------------------------------------------------------
+struct SW_MESHDATA
+{
+	DWORD						dwFVF;
+	UINT						nVertexSize;	// 정점 하나의 바이트 수
+	UINT						nNumVertices;
+	std::vector<BYTE>			Vertices;		// nNumVertices * nVertexSize 바이트
+	std::vector<DWORD>			Indices;		// 삼각형 목록, 삼각형 수 * 3
+	std::vector<SW_MESHSUBSET>	Subsets;		// AttribId 순서
+	std::vector<SW_MATERIAL>	Materials;		// AttribId로 찾는다
+	SW_VCACHESTATS				VCacheBefore;	// 정점 캐시 최적화 전후
+	SW_VCACHESTATS				VCacheAfter;
+	SW_VFETCHSTATS				VFetchBefore;	// 용접, 번호 재배치 전후
+	SW_VFETCHSTATS				VFetchAfter;
+
+	UINT	GetNumFaces() const { return (UINT)(Indices.size() / 3); }
+};
@@ -0,0 +1,312 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMeshCache.cpp
+//
+// 설명:	이진 메시 캐시 구현.
+//-----------------------------------------------------------------------------
+#include "SwMeshCache.h"
+#include "SwHash.h"
+#include "SwIndexData.h"
+#include "SwVertexStage.h"
+#include "SwXFile.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+static_assert(sizeof(SW_MESHCACHEHEADER) % 8 == 0, "SW_MESHCACHEHEADER must stay 8-byte sized");
+static_assert(sizeof(SW_MESHSUBSET) == 20, "SW_MESHSUBSET layout is part of the cache format");
+static_assert(sizeof(SW_MESHCACHEMATERIAL) == 72, "SW_MESHCACHEMATERIAL layout is part of the cache format");
+
+static inline UINT64 AlignUp(UINT64 n)
+{
+	return (n + SW_MESHCACHE_ALIGNMENT - 1) & ~(UINT64)(SW_MESHCACHE_ALIGNMENT - 1);
+}
+
+static inline double ElapsedMs(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+CSwMeshCache::CSwMeshCache()
+	: m_pHeader(NULL)
+	, m_pVertices(NULL)
+	, m_pIndices(NULL)
+	, m_pSubsets(NULL)
+	, m_pMaterials(NULL)
+	, m_pStrings(NULL)
+{
+}
+
+VOID CSwMeshCache::Close()
+{
+	m_File.Close();
+	m_Buffer.clear();
+	m_Buffer.shrink_to_fit();
+	m_Indices.clear();
+	m_Indices.shrink_to_fit();
+
+	m_pHeader = NULL;
+	m_pVertices = NULL;
+	m_pIndices = NULL;
+	m_pSubsets = NULL;
+	m_pMaterials = NULL;
+	m_pStrings = NULL;
+}
+
+HRESULT CSwMeshCache::Open(const char* pFilename, UINT64 nSourceHash)
+{
+	Close();
+
+	HRESULT hr = m_File.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+
+	hr = Attach(m_File.GetData(), m_File.GetSize(), nSourceHash);
+	if (FAILED(hr))
+		Close();
+	return hr;
+}
+
+HRESULT CSwMeshCache::OpenFromMeshData(const SW_MESHDATA& mesh, UINT64 nSourceHash)
+{
+	Close();
+
+	Serialize(mesh, nSourceHash, &m_Buffer);
+	HRESULT hr = Attach(m_Buffer.data(), m_Buffer.size(), nSourceHash);
+	if (FAILED(hr))
+		Close();
+	return hr;
+}
+
+// [nOffset, nOffset + nBytes)가 nFileSize 바이트의 파일 안에 있는가. 더하지 않으므로 넘침이 없다.
+static inline bool IsInFile(UINT64 nOffset, UINT64 nBytes, UINT64 nFileSize)
+{
+	return nOffset <= nFileSize && nBytes <= nFileSize - nOffset;
+}
+
+// 머리를 검사하고 오프셋을 포인터로 바꾼다. 정점 데이터는 읽지 않으므로 페이지는 처음 쓸 때 들어온다.
+HRESULT CSwMeshCache::Attach(const BYTE* pData, size_t nSize, UINT64 nSourceHash)
+{
+	if (nSize < sizeof(SW_MESHCACHEHEADER))
+		return E_FAIL;
+
+	const SW_MESHCACHEHEADER* pHeader = (const SW_MESHCACHEHEADER*)pData;
+	if (memcmp(pHeader->Magic, "SWMC", 4) != 0 || pHeader->nVersion != SW_MESHCACHE_VERSION)
+		return E_FAIL;
+	if (pHeader->nSourceHash != nSourceHash || pHeader->nFileSize != (UINT64)nSize)
+		return E_FAIL;
+
+	// 정점 크기는 FVF가 정하는 크기와 같아야 한다. 다르면 정점을 잘못 읽게 되므로 다시 파싱한다.
+	const UINT nStride = SwGetFVFVertexSize(pHeader->dwFVF);
+	if (nStride == 0 || pHeader->nVertexSize != nStride)
+		return E_FAIL;
+
+	// 구역은 쓸 때 SW_MESHCACHE_ALIGNMENT에 맞춰 두었다. 정렬이 어긋난 파일은 형식대로 읽을 수 없다.
+	if ((size_t)pData % alignof(SW_MESHCACHEHEADER) != 0 ||
+		pHeader->nVertexOffset % SW_MESHCACHE_ALIGNMENT != 0 ||
+		pHeader->nIndexOffset % SW_MESHCACHE_ALIGNMENT != 0 ||
+		pHeader->nSubsetOffset % SW_MESHCACHE_ALIGNMENT != 0 ||
+		pHeader->nMaterialOffset % SW_MESHCACHE_ALIGNMENT != 0 ||
+		pHeader->nStringOffset % SW_MESHCACHE_ALIGNMENT != 0)
+	{
+		return E_FAIL;
+	}
+
+	// 각 구역이 파일 안에 있는지 확인한다. 오프셋과 크기는 파일에서 읽은 값이므로 더해서 비교하지 않는다.
+	const UINT64 nVertexBytes = (UINT64)pHeader->nNumVertices * pHeader->nVertexSize;
+	const UINT64 nSubsetBytes = (UINT64)pHeader->nNumSubsets * sizeof(SW_MESHSUBSET);
+	const UINT64 nMaterialBytes = (UINT64)pHeader->nNumMaterials * sizeof(SW_MESHCACHEMATERIAL);
+	if (!IsInFile(pHeader->nVertexOffset, nVertexBytes, nSize) ||
+		!IsInFile(pHeader->nIndexOffset, pHeader->nIndexSize, nSize) ||
+		!IsInFile(pHeader->nSubsetOffset, nSubsetBytes, nSize) ||
+		!IsInFile(pHeader->nMaterialOffset, nMaterialBytes, nSize) ||
+		!IsInFile(pHeader->nStringOffset, pHeader->nStringSize, nSize))
+	{
+		return E_FAIL;
+	}
+
+	// 문자열 구역은 반드시 NUL로 끝나야 하고 재질의 문자열 위치는 그 안에 있어야 한다.
+	const char* pStrings = (const char*)(pData + pHeader->nStringOffset);
+	if (pHeader->nStringSize == 0 || pStrings[pHeader->nStringSize - 1] != '\0')
+		return E_FAIL;
+	const SW_MESHCACHEMATERIAL* pMaterials = (const SW_MESHCACHEMATERIAL*)(pData + pHeader->nMaterialOffset);
+	for (UINT i = 0; i < pHeader->nNumMaterials; ++i)
+	{
+		if (pMaterials[i].nTextureFilename >= pHeader->nStringSize)
+			return E_FAIL;
+	}
+
+	const SW_MESHSUBSET* pSubsets = (const SW_MESHSUBSET*)(pData + pHeader->nSubsetOffset);
+	for (UINT i = 0; i < pHeader->nNumSubsets; ++i)
+	{
+		if (pSubsets[i].AttribId >= pHeader->nNumMaterials ||
+			(UINT64)pSubsets[i].FaceStart + pSubsets[i].FaceCount > pHeader->nNumFaces ||
+			(UINT64)pSubsets[i].VertexStart + pSubsets[i].VertexCount > pHeader->nNumVertices)
+		{
+			return E_FAIL;
+		}
+	}
+
+	m_Indices.resize((size_t)pHeader->nNumFaces * 3);
+	if (!SwDecodeIndices(pData + pHeader->nIndexOffset, (size_t)pHeader->nIndexSize, (UINT)m_Indices.size(), m_Indices.data()))
+		return E_FAIL;
+	for (size_t i = 0; i < m_Indices.size(); ++i)
+	{
+		if (m_Indices[i] >= pHeader->nNumVertices)
+			return E_FAIL;
+	}
+
+	m_pHeader = pHeader;
+	m_pVertices = pData + pHeader->nVertexOffset;
+	m_pIndices = m_Indices.data();
+	m_pSubsets = pSubsets;
+	m_pMaterials = pMaterials;
+	m_pStrings = pStrings;
+	return S_OK;
+}
+
+VOID CSwMeshCache::Serialize(const SW_MESHDATA& mesh, UINT64 nSourceHash, std::vector<BYTE>* pOut)
+{
+	// 문자열 구역: 0번 위치는 항상 빈 문자열이다.
+	std::string strings(1, '\0');
+	std::vector<SW_MESHCACHEMATERIAL> materials(mesh.Materials.size());
+	for (size_t i = 0; i < mesh.Materials.size(); ++i)
+	{
+		materials[i].MatD3D = mesh.Materials[i].MatD3D;
+		materials[i].nTextureFilename = 0;
+		if (!mesh.Materials[i].strTextureFilename.empty())
+		{
+			materials[i].nTextureFilename = (UINT)strings.size();
+			strings += mesh.Materials[i].strTextureFilename;
+			strings += '\0';
+		}
+	}
+
+	std::vector<BYTE> indices(SwGetMaxEncodedIndexSize((UINT)mesh.Indices.size()));
+	indices.resize(SwEncodeIndices(mesh.Indices.data(), (UINT)mesh.Indices.size(), indices.data()));
+
+	SW_MESHCACHEHEADER header;
+	ZeroMemory(&header, sizeof(header));
+	memcpy(header.Magic, "SWMC", 4);
+	header.nVersion = SW_MESHCACHE_VERSION;
+	header.nSourceHash = nSourceHash;
+	header.dwFVF = mesh.dwFVF;
+	header.nVertexSize = mesh.nVertexSize;
+	header.nNumVertices = mesh.nNumVertices;
+	header.nNumFaces = mesh.GetNumFaces();
+	header.nNumSubsets = (UINT)mesh.Subsets.size();
+	header.nNumMaterials = (UINT)materials.size();
+	header.VCacheBefore = mesh.VCacheBefore;
+	header.VCacheAfter = mesh.VCacheAfter;
+	header.VFetchBefore = mesh.VFetchBefore;
+	header.VFetchAfter = mesh.VFetchAfter;
+
+	header.nVertexOffset = AlignUp(sizeof(header));
+	header.nIndexOffset = AlignUp(header.nVertexOffset + mesh.Vertices.size());
+	header.nIndexSize = indices.size();
+	header.nSubsetOffset = AlignUp(header.nIndexOffset + header.nIndexSize);
+	header.nMaterialOffset = AlignUp(header.nSubsetOffset + mesh.Subsets.size() * sizeof(SW_MESHSUBSET));
+	header.nStringOffset = AlignUp(header.nMaterialOffset + materials.size() * sizeof(SW_MESHCACHEMATERIAL));
+	header.nStringSize = strings.size();
+	header.nFileSize = header.nStringOffset + header.nStringSize;
+
+	// 정렬 때문에 생긴 틈은 0으로 채워 같은 메시는 항상 같은 바이트가 되게 한다.
+	pOut->assign((size_t)header.nFileSize, 0);
+	BYTE* pDst = pOut->data();
+	memcpy(pDst, &header, sizeof(header));
+	if (!mesh.Vertices.empty())
+		memcpy(pDst + header.nVertexOffset, mesh.Vertices.data(), mesh.Vertices.size());
+	if (!indices.empty())
+		memcpy(pDst + header.nIndexOffset, indices.data(), indices.size());
+	if (!mesh.Subsets.empty())
+		memcpy(pDst + header.nSubsetOffset, mesh.Subsets.data(), mesh.Subsets.size() * sizeof(SW_MESHSUBSET));
+	if (!materials.empty())
+		memcpy(pDst + header.nMaterialOffset, materials.data(), materials.size() * sizeof(SW_MESHCACHEMATERIAL));
+	memcpy(pDst + header.nStringOffset, strings.data(), strings.size());
+}
+
+HRESULT CSwMeshCache::Write(const char* pFilename, const SW_MESHDATA& mesh, UINT64 nSourceHash)
+{
+	if (pFilename == NULL)
+		return D3DERR_INVALIDCALL;
+
+	std::vector<BYTE> data;
+	Serialize(mesh, nSourceHash, &data);
+
+	const std::string strTemp = std::string(pFilename) + ".tmp";
+	FILE* fp = fopen(strTemp.c_str(), "wb");
+	if (fp == NULL)
+		return E_FAIL;
+	const bool bWritten = fwrite(data.data(), 1, data.size(), fp) == data.size();
+	if (fclose(fp) != 0 || !bWritten)
+	{
+		remove(strTemp.c_str());
+		return E_FAIL;
+	}
+
+	// Windows의 rename()은 대상이 있으면 실패하므로 먼저 지운다.
+	remove(pFilename);
+	if (rename(strTemp.c_str(), pFilename) != 0)
+	{
+		remove(strTemp.c_str());
+		return E_FAIL;
+	}
+	return S_OK;
+}
+
+HRESULT SwLoadMeshFromXCached(const char* pFilename, CSwMeshCache* pCache,
+	SW_MESHLOADINFO* pInfo, CSwThreadPool* pThreadPool)
+{
+	if (pFilename == NULL || pCache == NULL)
+		return D3DERR_INVALIDCALL;
+
+	SW_MESHLOADINFO info;
+	ZeroMemory(&info, sizeof(info));
+	const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+
+	// 1. 원본을 열어 해시한다. 원본이 없으면 캐시가 있어도 쓰지 않는다.
+	std::chrono::steady_clock::time_point t0 = tStart;
+	CSwMappedFile source;
+	HRESULT hr = source.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+	const UINT64 nSourceHash = SwHash64(source.GetData(), source.GetSize());
+	info.fHashMs = ElapsedMs(t0);
+
+	// 2. 캐시가 맞으면 그대로 쓴다.
+	const std::string strCache = std::string(pFilename) + ".swm";
+	t0 = std::chrono::steady_clock::now();
+	if (SUCCEEDED(pCache->Open(strCache.c_str(), nSourceHash)))
+	{
+		info.bFromCache = true;
+		info.fOpenMs = ElapsedMs(t0);
+	}
+	else
+	{
+		// 3. 원본을 파싱하여 캐시를 새로 쓰고 연다.
+		SW_MESHDATA mesh;
+		t0 = std::chrono::steady_clock::now();
+		hr = SwLoadMeshFromXInMemory(source.GetData(), source.GetSize(), &mesh, pThreadPool);
+		if (FAILED(hr))
+			return hr;
+		info.fParseMs = ElapsedMs(t0);
+
+		t0 = std::chrono::steady_clock::now();
+		const bool bWritten = SUCCEEDED(CSwMeshCache::Write(strCache.c_str(), mesh, nSourceHash));
+		info.fWriteMs = ElapsedMs(t0);
+
+		t0 = std::chrono::steady_clock::now();
+		if (!bWritten || FAILED(pCache->Open(strCache.c_str(), nSourceHash)))
+		{
+			hr = pCache->OpenFromMeshData(mesh, nSourceHash);
+			if (FAILED(hr))
+				return hr;
+		}
+		info.fOpenMs = ElapsedMs(t0);
+	}
+
+	info.fTotalMs = ElapsedMs(tStart);
+	if (pInfo)
+		*pInfo = info;
+	return S_OK;
+}
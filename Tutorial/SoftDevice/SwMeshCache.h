@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMeshCache.h
+//
+// 설명:	미리 변환해 둔 이진 메시 캐시(.swm).
+//		X 파일을 처음 읽을 때 SW_MESHDATA를 그대로 옮긴 이진 파일을 원본 옆에 만들어 두고,
+//		다음 실행부터는 이 파일을 메모리 맵으로 연결한 다음 오프셋을 포인터로 바꾸기만 한다.
+//		인덱스만은 압축(SwEncodeIndices)하여 저장하고 열 때 SIMD로 풀어 둔다.
+//		파일에는 원본 내용의 해시가 들어 있어 원본이 바뀌면 자동으로 다시 만든다.
+//
+//		파일 구성(모든 구역은 64바이트 경계에서 시작한다, 리틀 엔디언):
+//			SW_MESHCACHEHEADER
+//			정점		nNumVertices * nVertexSize 바이트, FVF 순서
+//			인덱스		nNumFaces * 3개의 DWORD를 압축한 nIndexSize 바이트
+//			부분 집합	SW_MESHSUBSET 배열
+//			재질		SW_MESHCACHEMATERIAL 배열
+//			문자열		NUL로 끝나는 텍스처 파일 이름들
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwFile.h"
+#include "SwMesh.h"
+
+class CSwThreadPool;
+
+#define SW_MESHCACHE_VERSION		4
+#define SW_MESHCACHE_ALIGNMENT		64
+
+struct SW_MESHCACHEHEADER
+{
+	char	Magic[4];				// "SWMC"
+	UINT	nVersion;				// SW_MESHCACHE_VERSION
+	UINT64	nSourceHash;			// 원본 파일 내용의 SwHash64()
+	UINT64	nFileSize;				// 캐시 파일 전체 크기
+	DWORD	dwFVF;
+	UINT	nVertexSize;
+	UINT	nNumVertices;
+	UINT	nNumFaces;
+	UINT	nNumSubsets;
+	UINT	nNumMaterials;
+	SW_VCACHESTATS	VCacheBefore;
+	SW_VCACHESTATS	VCacheAfter;
+	SW_VFETCHSTATS	VFetchBefore;
+	SW_VFETCHSTATS	VFetchAfter;
+	UINT64	nVertexOffset;
+	UINT64	nIndexOffset;
+	UINT64	nIndexSize;
+	UINT64	nSubsetOffset;
+	UINT64	nMaterialOffset;
+	UINT64	nStringOffset;
+	UINT64	nStringSize;
+};
+
+struct SW_MESHCACHEMATERIAL
+{
+	D3DMATERIAL9	MatD3D;
+	UINT			nTextureFilename;	// 문자열 구역 안의 위치. 텍스처가 없으면 빈 문자열을 가리킨다.
+};
+
+//-----------------------------------------------------------------------------
+// 읽기 시간 보고
+//-----------------------------------------------------------------------------
+struct SW_MESHLOADINFO
+{
+	bool	bFromCache;		// 캐시가 유효하여 파싱하지 않았으면 true
+	double	fHashMs;		// 원본을 열고 해시하는 데 걸린 시간
+	double	fParseMs;		// X 파일 파싱(캐시를 쓰면 0)
+	double	fWriteMs;		// 캐시 파일 쓰기(캐시를 쓰면 0)
+	double	fOpenMs;		// 캐시를 열고 포인터를 맞추고 인덱스를 푸는 데 걸린 시간
+	double	fTotalMs;
+};
+
+//-----------------------------------------------------------------------------
+// 캐시 파일 하나. 모든 포인터는 매핑된 파일(또는 디스크에 쓰지 못했을 때는 내부 버퍼)을 가리킨다.
+//-----------------------------------------------------------------------------
+class CSwMeshCache
+{
+public:
+	CSwMeshCache();
+
+	CSwMeshCache(const CSwMeshCache&) = delete;
+	CSwMeshCache& operator=(const CSwMeshCache&) = delete;
+
+	// 캐시 파일을 연다. 파일이 없으면 D3DERR_NOTFOUND,
+	// 버전이나 원본 해시가 맞지 않거나 내용이 잘못되었으면 E_FAIL을 돌려준다.
+	HRESULT		Open(const char* pFilename, UINT64 nSourceHash);
+	VOID		Close();
+
+	// 메시 데이터를 캐시 형식으로 바꾸어 파일에 쓴다. 임시 파일에 쓴 다음 이름을 바꾸므로
+	// 쓰는 도중에 멈추어도 깨진 캐시가 남지 않는다.
+	static HRESULT	Write(const char* pFilename, const SW_MESHDATA& mesh, UINT64 nSourceHash);
+
+	// 메시 데이터를 캐시 형식으로 바꾸어 디스크를 거치지 않고 연다.
+	HRESULT		OpenFromMeshData(const SW_MESHDATA& mesh, UINT64 nSourceHash);
+
+	DWORD					GetFVF() const { return m_pHeader->dwFVF; }
+	UINT					GetVertexSize() const { return m_pHeader->nVertexSize; }
+	UINT					GetNumVertices() const { return m_pHeader->nNumVertices; }
+	UINT					GetNumFaces() const { return m_pHeader->nNumFaces; }
+	UINT					GetNumSubsets() const { return m_pHeader->nNumSubsets; }
+	UINT					GetNumMaterials() const { return m_pHeader->nNumMaterials; }
+	const BYTE*				GetVertices() const { return m_pVertices; }
+	const DWORD*			GetIndices() const { return m_pIndices; }
+	const SW_MESHSUBSET*	GetSubsets() const { return m_pSubsets; }
+	const D3DMATERIAL9&		GetMaterial(UINT i) const { return m_pMaterials[i].MatD3D; }
+	const char*				GetTextureFilename(UINT i) const { return m_pStrings + m_pMaterials[i].nTextureFilename; }
+	const SW_VCACHESTATS&	GetVCacheBefore() const { return m_pHeader->VCacheBefore; }
+	const SW_VCACHESTATS&	GetVCacheAfter() const { return m_pHeader->VCacheAfter; }
+	const SW_VFETCHSTATS&	GetVFetchBefore() const { return m_pHeader->VFetchBefore; }
+	const SW_VFETCHSTATS&	GetVFetchAfter() const { return m_pHeader->VFetchAfter; }
+
+private:
+	static VOID	Serialize(const SW_MESHDATA& mesh, UINT64 nSourceHash, std::vector<BYTE>* pOut);
+	HRESULT		Attach(const BYTE* pData, size_t nSize, UINT64 nSourceHash);
+
+	CSwMappedFile					m_File;
+	std::vector<BYTE>				m_Buffer;
+	std::vector<DWORD>				m_Indices;		// 압축을 푼 인덱스
+
+	const SW_MESHCACHEHEADER*		m_pHeader;
+	const BYTE*						m_pVertices;
+	const DWORD*					m_pIndices;
+	const SW_MESHSUBSET*			m_pSubsets;
+	const SW_MESHCACHEMATERIAL*		m_pMaterials;
+	const char*						m_pStrings;
+};
+
+// X 파일을 캐시를 거쳐 읽는다. 캐시 파일 이름은 원본 이름 뒤에 ".swm"을 붙인 것이다.
+// 캐시가 없거나 원본과 맞지 않으면 원본을 파싱하여 캐시를 새로 쓴다.
+// 캐시를 쓸 수 없는 곳(읽기 전용 폴더 등)이면 메모리에서만 열고 S_OK를 돌려준다.
+HRESULT	SwLoadMeshFromXCached(const char* pFilename, CSwMeshCache* pCache,
+			SW_MESHLOADINFO* pInfo = NULL, CSwThreadPool* pThreadPool = NULL);
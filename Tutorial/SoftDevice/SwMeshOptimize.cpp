@@ -0,0 +1,452 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMeshOptimize.cpp
+//
+// 설명:	메시 정리 처리 구현.
+//-----------------------------------------------------------------------------
+#include "SwMeshOptimize.h"
+#include "SwHash.h"
+#include "SwThreadPool.h"
+#include "SwVertexStage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// 측정
+//-----------------------------------------------------------------------------
+
+// FIFO 캐시에서 정점이 들어간 순번을 기억해 두면 캐시 내용을 따로 관리하지 않아도 된다.
+// 그 뒤로 nCacheSize번 이상 실패가 있었으면 이미 밀려난 것이다.
+// stamps는 (들어간 순번 + 1), 0이면 아직 쓰이지 않은 정점이다. pIndices의 값은 nBase를 뺀 위치로 찾는다.
+static UINT CountCacheMisses(const DWORD* pIndices, UINT nNumIndices, DWORD nBase, UINT nCacheSize,
+	std::vector<UINT>& stamps, UINT* pUnique)
+{
+	UINT nMisses = 0, nUnique = 0;
+	for (UINT i = 0; i < nNumIndices; ++i)
+	{
+		UINT& stamp = stamps[pIndices[i] - nBase];
+		if (stamp == 0)
+			++nUnique;
+		if (stamp == 0 || nMisses - (stamp - 1) >= nCacheSize)
+		{
+			stamp = ++nMisses;
+		}
+	}
+	if (pUnique)
+		*pUnique = nUnique;
+	return nMisses;
+}
+
+VOID SwMeasureVertexCache(const DWORD* pIndices, UINT nNumFaces, UINT nCacheSize, SW_VCACHESTATS* pStats)
+{
+	pStats->fACMR = 0.0f;
+	pStats->fATVR = 0.0f;
+	if (nNumFaces == 0)
+		return;
+
+	const UINT nNumIndices = nNumFaces * 3;
+	DWORD nMin = pIndices[0], nMax = pIndices[0];
+	for (UINT i = 1; i < nNumIndices; ++i)
+	{
+		nMin = std::min(nMin, pIndices[i]);
+		nMax = std::max(nMax, pIndices[i]);
+	}
+
+	std::vector<UINT> stamps((size_t)(nMax - nMin) + 1, 0);
+	UINT nUnique;
+	const UINT nMisses = CountCacheMisses(pIndices, nNumIndices, nMin, nCacheSize, stamps, &nUnique);
+	pStats->fACMR = (float)nMisses / nNumFaces;
+	pStats->fATVR = (float)nMisses / nUnique;
+}
+
+// 부분 집합마다 캐시를 비우고 잰다.
+static VOID MeasureSubsets(const SW_MESHDATA* pMesh, SW_VCACHESTATS* pStats)
+{
+	UINT64 nMisses = 0, nUnique = 0, nFaces = 0;
+	std::vector<UINT> stamps;
+	for (size_t s = 0; s < pMesh->Subsets.size(); ++s)
+	{
+		const SW_MESHSUBSET& subset = pMesh->Subsets[s];
+		if (subset.FaceCount == 0)
+			continue;
+
+		stamps.assign(subset.VertexCount, 0);
+		UINT nSubsetUnique;
+		nMisses += CountCacheMisses(&pMesh->Indices[(size_t)subset.FaceStart * 3], subset.FaceCount * 3,
+			subset.VertexStart, SW_VCACHE_FIFO_SIZE, stamps, &nSubsetUnique);
+		nUnique += nSubsetUnique;
+		nFaces += subset.FaceCount;
+	}
+
+	pStats->fACMR = nFaces ? (float)((double)nMisses / nFaces) : 0.0f;
+	pStats->fATVR = nUnique ? (float)((double)nMisses / nUnique) : 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Forsyth 최적화
+// 정점 점수 = 캐시 위치 점수 + 남은 삼각형 수 점수. 삼각형 점수는 세 정점 점수의 합이다.
+// 매번 캐시에 있는 정점들이 쓰는 삼각형 가운데 점수가 가장 높은 것을 내보내고,
+// 그런 삼각형이 없으면 아직 내보내지 않은 다음 삼각형으로 넘어간다.
+//-----------------------------------------------------------------------------
+#define SW_FORSYTH_CACHE_DECAY_POWER	1.5f
+#define SW_FORSYTH_LAST_TRI_SCORE		0.75f
+#define SW_FORSYTH_VALENCE_BOOST_SCALE	2.0f
+#define SW_FORSYTH_VALENCE_BOOST_POWER	0.5f
+#define SW_FORSYTH_MAX_VALENCE			64		// 이보다 많이 쓰인 정점은 같은 점수로 본다
+
+struct FORSYTH_TABLES
+{
+	float	fCache[SW_VCACHE_SIZE];
+	float	fValence[SW_FORSYTH_MAX_VALENCE + 1];
+
+	FORSYTH_TABLES()
+	{
+		for (UINT i = 0; i < SW_VCACHE_SIZE; ++i)
+		{
+			// 바로 전 삼각형의 세 정점은 같은 점수를 주어 특정 방향으로 쏠리지 않게 한다.
+			if (i < 3)
+				fCache[i] = SW_FORSYTH_LAST_TRI_SCORE;
+			else
+				fCache[i] = powf(1.0f - (float)(i - 3) / (SW_VCACHE_SIZE - 3), SW_FORSYTH_CACHE_DECAY_POWER);
+		}
+		fValence[0] = 0.0f;
+		for (UINT i = 1; i <= SW_FORSYTH_MAX_VALENCE; ++i)
+			fValence[i] = SW_FORSYTH_VALENCE_BOOST_SCALE * powf((float)i, -SW_FORSYTH_VALENCE_BOOST_POWER);
+	}
+};
+
+static const FORSYTH_TABLES s_ForsythTables;
+
+static inline float VertexScore(INT nCachePos, UINT nRemaining)
+{
+	if (nRemaining == 0)
+		return -1.0f;
+
+	float fScore = (nCachePos >= 0) ? s_ForsythTables.fCache[nCachePos] : 0.0f;
+	return fScore + s_ForsythTables.fValence[std::min<UINT>(nRemaining, SW_FORSYTH_MAX_VALENCE)];
+}
+
+// pIndices의 삼각형 nNumFaces개를 제자리에서 다시 배열한다. 인덱스는 [nBase, nBase + nNumVertices) 범위다.
+static VOID OptimizeFaces(DWORD* pIndices, UINT nNumFaces, DWORD nBase, UINT nNumVertices)
+{
+	if (nNumFaces <= 1)
+		return;
+
+	// 정점마다 쓰는 삼각형 목록(CSR)
+	std::vector<UINT> adjOffset(nNumVertices + 1, 0);
+	for (UINT i = 0; i < nNumFaces * 3; ++i)
+		++adjOffset[pIndices[i] - nBase + 1];
+	for (UINT v = 0; v < nNumVertices; ++v)
+		adjOffset[v + 1] += adjOffset[v];
+
+	std::vector<UINT> adjFaces(nNumFaces * 3);
+	std::vector<UINT> remaining(nNumVertices, 0);	// 아직 내보내지 않은 삼각형 수
+	for (UINT f = 0; f < nNumFaces; ++f)
+	{
+		for (UINT c = 0; c < 3; ++c)
+		{
+			const UINT v = pIndices[f * 3 + c] - nBase;
+			adjFaces[adjOffset[v] + remaining[v]++] = f;
+		}
+	}
+
+	std::vector<float> vertexScore(nNumVertices);
+	for (UINT v = 0; v < nNumVertices; ++v)
+		vertexScore[v] = VertexScore(-1, remaining[v]);
+
+	auto faceScore = [&](UINT f)
+	{
+		return vertexScore[pIndices[f * 3] - nBase] + vertexScore[pIndices[f * 3 + 1] - nBase] +
+			vertexScore[pIndices[f * 3 + 2] - nBase];
+	};
+
+	std::vector<bool> faceDone(nNumFaces, false);
+	std::vector<DWORD> output(nNumFaces * 3);
+	UINT cache[SW_VCACHE_SIZE + 3];
+	UINT nCacheCount = 0;
+
+	UINT nBestFace = 0;
+	float fBestScore = faceScore(0);
+	for (UINT f = 1; f < nNumFaces; ++f)
+	{
+		const float fScore = faceScore(f);
+		if (fScore > fBestScore)
+		{
+			fBestScore = fScore;
+			nBestFace = f;
+		}
+	}
+
+	UINT nCursor = 0;	// 캐시에서 후보를 찾지 못했을 때 이어서 볼 위치
+	for (UINT nOut = 0; nOut < nNumFaces; ++nOut)
+	{
+		if (nBestFace == UINT(-1))
+		{
+			while (faceDone[nCursor])
+				++nCursor;
+			nBestFace = nCursor;
+		}
+
+		// 1. 삼각형을 내보내고 세 정점의 남은 삼각형 목록에서 뺀다.
+		faceDone[nBestFace] = true;
+		UINT tri[3];
+		for (UINT c = 0; c < 3; ++c)
+		{
+			const UINT v = pIndices[nBestFace * 3 + c] - nBase;
+			tri[c] = v;
+			output[nOut * 3 + c] = pIndices[nBestFace * 3 + c];
+
+			UINT* pBegin = &adjFaces[adjOffset[v]];
+			UINT* pEnd = pBegin + remaining[v];
+			*std::find(pBegin, pEnd, nBestFace) = pEnd[-1];
+			--remaining[v];
+		}
+
+		// 2. 세 정점을 LRU 캐시 앞으로 옮긴다. 밀려난 정점은 캐시 밖이 된다.
+		UINT newCache[SW_VCACHE_SIZE + 3];
+		UINT nNewCount = 0;
+		for (UINT c = 0; c < 3; ++c)
+		{
+			if (std::find(newCache, newCache + nNewCount, tri[c]) == newCache + nNewCount)
+				newCache[nNewCount++] = tri[c];
+		}
+		for (UINT i = 0; i < nCacheCount; ++i)
+		{
+			const UINT v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2])
+				newCache[nNewCount++] = v;
+		}
+		for (UINT i = SW_VCACHE_SIZE; i < nNewCount; ++i)
+			vertexScore[newCache[i]] = VertexScore(-1, remaining[newCache[i]]);
+		nCacheCount = std::min<UINT>(nNewCount, SW_VCACHE_SIZE);
+		std::copy(newCache, newCache + nCacheCount, cache);
+
+		// 3. 캐시 안 정점들의 점수를 갱신하고, 그 정점을 쓰는 삼각형 가운데 가장 좋은 것을 고른다.
+		for (UINT i = 0; i < nCacheCount; ++i)
+			vertexScore[cache[i]] = VertexScore((INT)i, remaining[cache[i]]);
+
+		nBestFace = UINT(-1);
+		fBestScore = -1.0f;
+		for (UINT i = 0; i < nCacheCount; ++i)
+		{
+			const UINT v = cache[i];
+			for (UINT j = adjOffset[v]; j < adjOffset[v] + remaining[v]; ++j)
+			{
+				const UINT f = adjFaces[j];
+				const float fScore = faceScore(f);
+				if (fScore > fBestScore)
+				{
+					fBestScore = fScore;
+					nBestFace = f;
+				}
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+VOID SwOptimizeVertexCache(SW_MESHDATA* pMesh, CSwThreadPool* pThreadPool)
+{
+	MeasureSubsets(pMesh, &pMesh->VCacheBefore);
+
+	auto optimizeSubset = [pMesh](UINT s, UINT)
+	{
+		const SW_MESHSUBSET& subset = pMesh->Subsets[s];
+		OptimizeFaces(&pMesh->Indices[(size_t)subset.FaceStart * 3], subset.FaceCount,
+			subset.VertexStart, subset.VertexCount);
+	};
+	const UINT nNumSubsets = (UINT)pMesh->Subsets.size();
+	if (pThreadPool && nNumSubsets > 1)
+	{
+		pThreadPool->ParallelFor(nNumSubsets, optimizeSubset);
+	}
+	else
+	{
+		for (UINT s = 0; s < nNumSubsets; ++s)
+			optimizeSubset(s, 0);
+	}
+
+	MeasureSubsets(pMesh, &pMesh->VCacheAfter);
+}
+
+//-----------------------------------------------------------------------------
+// 정점 읽기
+//-----------------------------------------------------------------------------
+#define SW_VFETCH_LINE_SIZE		64
+#define SW_WELD_NONE			0xffffffff
+
+float SwMeasureVertexFetch(const DWORD* pIndices, UINT nNumIndices, UINT nNumVertices, UINT nVertexSize)
+{
+	if (nNumIndices == 0 || nNumVertices == 0)
+		return 0.0f;
+
+	// 캐시 줄마다 CountCacheMisses()와 같은 방법으로 FIFO를 흉내 낸다.
+	const size_t nNumLines = ((size_t)nNumVertices * nVertexSize + SW_VFETCH_LINE_SIZE - 1) / SW_VFETCH_LINE_SIZE;
+	std::vector<UINT> stamps(nNumLines, 0);
+	UINT nMisses = 0;
+	for (UINT i = 0; i < nNumIndices; ++i)
+	{
+		const size_t nFirst = (size_t)pIndices[i] * nVertexSize / SW_VFETCH_LINE_SIZE;
+		const size_t nLast = ((size_t)pIndices[i] * nVertexSize + nVertexSize - 1) / SW_VFETCH_LINE_SIZE;
+		for (size_t nLine = nFirst; nLine <= nLast; ++nLine)
+		{
+			UINT& stamp = stamps[nLine];
+			if (stamp == 0 || nMisses - (stamp - 1) >= SW_VFETCH_CACHE_LINES)
+				stamp = ++nMisses;
+		}
+	}
+	return (float)((double)nMisses * SW_VFETCH_LINE_SIZE / ((double)nNumVertices * nVertexSize));
+}
+
+UINT SwWeldVertices(DWORD dwFVF, BYTE* pVertices, UINT nNumVertices, DWORD* pIndices, UINT nNumIndices, float fEpsilon)
+{
+	SW_FVFLAYOUT layout;
+	SwDecodeFVF(dwFVF, &layout);
+	const UINT nVertexSize = layout.nSize;
+	if (nNumVertices == 0 || nVertexSize % 4 != 0)
+		return nNumVertices;
+
+	// 1. 비교할 열쇠를 만든다. 격자에 맞출 때는 색상이 아닌 4바이트 단어를 모두 float로 보고
+	//    격자 번호(정수)로 바꾼다. 비트 비교일 때는 정점 자체가 열쇠다.
+	const BYTE* pKeys = pVertices;
+	std::vector<BYTE> keys;
+	if (fEpsilon > 0.0f)
+	{
+		const UINT nWords = nVertexSize / 4;
+		std::vector<bool> isFloat(nWords, true);
+		if (layout.nDiffuse >= 0)
+			isFloat[layout.nDiffuse / 4] = false;
+		if (layout.nSpecular >= 0)
+			isFloat[layout.nSpecular / 4] = false;
+
+		const float fInvEpsilon = 1.0f / fEpsilon;
+		keys.assign(pVertices, pVertices + (size_t)nNumVertices * nVertexSize);
+		for (UINT v = 0; v < nNumVertices; ++v)
+		{
+			BYTE* pKey = &keys[(size_t)v * nVertexSize];
+			for (UINT w = 0; w < nWords; ++w)
+			{
+				if (!isFloat[w])
+					continue;
+				float f;
+				memcpy(&f, pKey + w * 4, 4);
+				const INT n = (INT)floorf(f * fInvEpsilon + 0.5f);
+				memcpy(pKey + w * 4, &n, 4);
+			}
+		}
+		pKeys = keys.data();
+	}
+
+	// 2. 열린 주소 해시 표로 같은 열쇠를 갖는 첫 정점을 찾는다.
+	UINT nTableSize = 1;
+	while (nTableSize < nNumVertices * 2)
+		nTableSize <<= 1;
+	std::vector<UINT> table(nTableSize, SW_WELD_NONE);
+	std::vector<UINT> remap(nNumVertices);
+	UINT nNumUnique = 0;
+	for (UINT v = 0; v < nNumVertices; ++v)
+	{
+		const BYTE* pKey = pKeys + (size_t)v * nVertexSize;
+		UINT nSlot = (UINT)SwHash64(pKey, nVertexSize) & (nTableSize - 1);
+		for (;;)
+		{
+			const UINT nOther = table[nSlot];
+			if (nOther == SW_WELD_NONE)
+			{
+				table[nSlot] = v;
+				remap[v] = nNumUnique++;
+				break;
+			}
+			if (memcmp(pKeys + (size_t)nOther * nVertexSize, pKey, nVertexSize) == 0)
+			{
+				remap[v] = remap[nOther];
+				break;
+			}
+			nSlot = (nSlot + 1) & (nTableSize - 1);
+		}
+	}
+
+	// 3. 처음 나온 정점들을 앞으로 모은다. 새 위치는 항상 원래 위치보다 앞이므로 아직 옮기지 않은 정점을 덮지 않는다.
+	UINT nNext = 0;
+	for (UINT v = 0; v < nNumVertices; ++v)
+	{
+		if (remap[v] != nNext)
+			continue;
+		if (nNext != v)
+			memcpy(pVertices + (size_t)nNext * nVertexSize, pVertices + (size_t)v * nVertexSize, nVertexSize);
+		++nNext;
+	}
+
+	for (UINT i = 0; i < nNumIndices; ++i)
+		pIndices[i] = remap[pIndices[i]];
+	return nNumUnique;
+}
+
+UINT SwRemapVertexFetch(UINT nVertexSize, BYTE* pVertices, UINT nNumVertices, DWORD* pIndices, UINT nNumIndices)
+{
+	std::vector<UINT> remap(nNumVertices, SW_WELD_NONE);
+	UINT nNext = 0;
+	for (UINT i = 0; i < nNumIndices; ++i)
+	{
+		UINT& n = remap[pIndices[i]];
+		if (n == SW_WELD_NONE)
+			n = nNext++;
+		pIndices[i] = n;
+	}
+
+	std::vector<BYTE> vertices((size_t)nNext * nVertexSize);
+	for (UINT v = 0; v < nNumVertices; ++v)
+	{
+		if (remap[v] != SW_WELD_NONE)
+			memcpy(&vertices[(size_t)remap[v] * nVertexSize], pVertices + (size_t)v * nVertexSize, nVertexSize);
+	}
+	memcpy(pVertices, vertices.data(), vertices.size());
+	return nNext;
+}
+
+// 인덱스가 바뀐 다음 부분 집합마다 쓰는 정점 범위를 다시 구한다.
+static VOID UpdateSubsetVertexRanges(SW_MESHDATA* pMesh)
+{
+	for (size_t s = 0; s < pMesh->Subsets.size(); ++s)
+	{
+		SW_MESHSUBSET& subset = pMesh->Subsets[s];
+		if (subset.FaceCount == 0)
+			continue;
+
+		const DWORD* pIndices = &pMesh->Indices[(size_t)subset.FaceStart * 3];
+		DWORD nMin = pIndices[0], nMax = pIndices[0];
+		for (UINT i = 1; i < subset.FaceCount * 3; ++i)
+		{
+			nMin = std::min(nMin, pIndices[i]);
+			nMax = std::max(nMax, pIndices[i]);
+		}
+		subset.VertexStart = nMin;
+		subset.VertexCount = nMax - nMin + 1;
+	}
+}
+
+VOID SwWeldMeshVertices(SW_MESHDATA* pMesh, float fEpsilon)
+{
+	pMesh->VFetchBefore.nNumVertices = pMesh->nNumVertices;
+	pMesh->VFetchBefore.fOverfetch = SwMeasureVertexFetch(pMesh->Indices.data(), (UINT)pMesh->Indices.size(),
+		pMesh->nNumVertices, pMesh->nVertexSize);
+
+	pMesh->nNumVertices = SwWeldVertices(pMesh->dwFVF, pMesh->Vertices.data(), pMesh->nNumVertices,
+		pMesh->Indices.data(), (UINT)pMesh->Indices.size(), fEpsilon);
+	pMesh->Vertices.resize((size_t)pMesh->nNumVertices * pMesh->nVertexSize);
+	UpdateSubsetVertexRanges(pMesh);
+}
+
+VOID SwOptimizeVertexFetch(SW_MESHDATA* pMesh)
+{
+	pMesh->nNumVertices = SwRemapVertexFetch(pMesh->nVertexSize, pMesh->Vertices.data(), pMesh->nNumVertices,
+		pMesh->Indices.data(), (UINT)pMesh->Indices.size());
+	pMesh->Vertices.resize((size_t)pMesh->nNumVertices * pMesh->nVertexSize);
+	UpdateSubsetVertexRanges(pMesh);
+
+	pMesh->VFetchAfter.nNumVertices = pMesh->nNumVertices;
+	pMesh->VFetchAfter.fOverfetch = SwMeasureVertexFetch(pMesh->Indices.data(), (UINT)pMesh->Indices.size(),
+		pMesh->nNumVertices, pMesh->nVertexSize);
+}
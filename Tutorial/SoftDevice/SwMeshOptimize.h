@@ -0,0 +1,54 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMeshOptimize.h
+//
+// 설명:	읽어들인 메시를 그리기 좋게 정리하는 처리.
+//
+//		정점 캐시 최적화: 부분 집합마다 삼각형 순서를 Tom Forsyth의 "Linear-Speed Vertex Cache
+//		Optimisation" 방법으로 바꾸어, 최근에 변환한 정점을 쓰는 삼각형이 먼저 그려지게 한다.
+//		삼각형은 자기 부분 집합 안에서만 움직이므로 DrawSubset()의 범위와 속성 번호는 그대로다.
+//
+//		결과는 ACMR(삼각형당 캐시 실패 수)과 ATVR(정점당 변환 횟수)로 잰다.
+//		하드웨어의 변환 후 캐시를 흉내 내어 SW_VCACHE_FIFO_SIZE 크기의 FIFO로 세고,
+//		DrawSubset()마다 캐시가 비워진다고 본다.
+//
+//		정점 용접과 읽기 순서: 내용이 같은 정점을 하나로 합치고, 인덱스 목록에서 처음 쓰이는 순서대로
+//		정점 번호를 다시 매겨 정점 배열을 앞에서부터 차례로 읽게 한다. 쓰이지 않는 정점은 버린다.
+//		정점 읽기 효율은 SW_VFETCH_CACHE_LINES개의 64바이트 줄을 갖는 FIFO 캐시로 잰다.
+//		배열과 인덱스만 받는 함수는 SW_MESHDATA가 아닌 정점/인덱스 버퍼에도 그대로 쓸 수 있다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwMesh.h"
+
+class CSwThreadPool;
+
+#define SW_VCACHE_SIZE			32		// 최적화가 가정하는 LRU 캐시 크기
+#define SW_VCACHE_FIFO_SIZE		16		// 측정에 쓰는 FIFO 캐시 크기
+#define SW_VFETCH_CACHE_LINES	128		// 정점 읽기 측정에 쓰는 캐시(8KB)
+
+// 인덱스 목록을 FIFO 캐시로 그렸을 때의 ACMR, ATVR을 잰다.
+VOID	SwMeasureVertexCache(const DWORD* pIndices, UINT nNumFaces, UINT nCacheSize, SW_VCACHESTATS* pStats);
+
+// 모든 부분 집합의 삼각형 순서를 바꾸고 pMesh->VCacheBefore, VCacheAfter를 채운다.
+// pThreadPool이 있으면 부분 집합들을 나누어 처리한다.
+VOID	SwOptimizeVertexCache(SW_MESHDATA* pMesh, CSwThreadPool* pThreadPool = NULL);
+
+// 인덱스 순서대로 정점을 읽을 때 캐시 줄 단위로 읽게 되는 바이트 수 / 정점 배열 크기.
+float	SwMeasureVertexFetch(const DWORD* pIndices, UINT nNumIndices, UINT nNumVertices, UINT nVertexSize);
+
+// 같은 정점을 합치고 남은 정점을 앞으로 모은다. 새 정점 수를 돌려준다.
+// fEpsilon이 0이면 비트가 같은 정점만, 0보다 크면 float 요소(위치, 법선, 텍스처 좌표 등)를
+// fEpsilon 간격의 격자에 맞추었을 때 같은 정점을 합친다. 색상 요소는 항상 비트로 비교한다.
+UINT	SwWeldVertices(DWORD dwFVF, BYTE* pVertices, UINT nNumVertices, DWORD* pIndices, UINT nNumIndices,
+			float fEpsilon = 0.0f);
+
+// 정점을 인덱스 목록에서 처음 쓰이는 순서로 다시 배열하고 인덱스를 고친다.
+// 쓰이지 않는 정점은 버리고 새 정점 수를 돌려준다.
+UINT	SwRemapVertexFetch(UINT nVertexSize, BYTE* pVertices, UINT nNumVertices, DWORD* pIndices, UINT nNumIndices);
+
+// SW_MESHDATA용: 용접하고 부분 집합의 정점 범위를 고친다. pMesh->VFetchBefore를 채운다.
+VOID	SwWeldMeshVertices(SW_MESHDATA* pMesh, float fEpsilon = 0.0f);
+
+// SW_MESHDATA용: 정점 읽기 순서를 정리하고 부분 집합의 정점 범위를 고친다. pMesh->VFetchAfter를 채운다.
+// 삼각형 순서가 정해진 다음(SwOptimizeVertexCache 뒤)에 불러야 한다.
+VOID	SwOptimizeVertexFetch(SW_MESHDATA* pMesh);
@@ -0,0 +1,654 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMipmap.cpp
+//
+// 설명:	밉 체인 생성 구현(스칼라, SSE2, AVX2 구현과 실행 중 선택).
+//		한 레벨은 출력 행 묶음 단위로 나누어 만든다. 작업마다 원본 행을 선형 float로 풀어
+//		가로 필터를 적용한 결과를 세로 탭 수만큼 보관해 두고, 다음 출력 행이 같은 원본 행을 쓰면 다시 계산하지 않는다.
+//-----------------------------------------------------------------------------
+#include "SwMipmap.h"
+#include "SwResource.h"
+#include "SwThreadPool.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(SW_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SW_TARGET_SSE2		__attribute__((target("sse2")))
+#define SW_TARGET_AVX2		__attribute__((target("avx2")))
+#else
+#define SW_TARGET_SSE2
+#define SW_TARGET_AVX2
+#endif
+
+#define SW_MIP_MAX_TAPS				8
+#define SW_MIP_PAD					4				// 가로 필터가 행 밖으로 읽는 최대 텍셀 수
+#define SW_MIP_BAND_ROWS			32				// 작업 하나가 만드는 출력 행 수
+#define SW_MIP_PARALLEL_MIN_TEXELS	(512 * 512)		// 스레드 풀이 없을 때 기본 풀을 쓰는 레벨 0 크기
+#define SW_KAISER_ALPHA				4.0
+
+// 선형 -> sRGB 변환표: [2^-13, 1] 범위의 float를 지수와 가수 위 7비트로 구간을 나눈다.
+// 구간 안에서 sRGB 값은 많아야 1 늘어나므로 구간 시작점의 값에 경계값 비교 한 번을 더하면 정확히 반올림된다.
+#define SW_SRGB_MIN_BITS			0x39000000		// 2^-13. 이보다 작은 값은 모두 0이 된다
+#define SW_SRGB_BUCKET_SHIFT		16
+#define SW_SRGB_NUM_BUCKETS			((0x3f800000 - SW_SRGB_MIN_BITS) >> SW_SRGB_BUCKET_SHIFT)
+
+//-----------------------------------------------------------------------------
+// 변환표와 필터 탭
+//-----------------------------------------------------------------------------
+struct MIPTAPS
+{
+	INT		nOffset;						// 출력 텍셀 x의 첫 번째 탭은 원본 텍셀 (배율 * x + nOffset)
+	UINT	nTaps;
+	float	fWeights[SW_MIP_MAX_TAPS];
+};
+
+static inline float BitsToFloat(UINT n)
+{
+	float f;
+	memcpy(&f, &n, sizeof(f));
+	return f;
+}
+
+static double SrgbToLinear(double s)
+{
+	return (s <= 0.04045) ? s / 12.92 : pow((s + 0.055) / 1.055, 2.4);
+}
+
+// 0차 제1종 변형 베셀 함수(Kaiser 창)
+static double BesselI0(double x)
+{
+	double fSum = 1.0, fTerm = 1.0;
+	for (int k = 1; k < 32; ++k)
+	{
+		const double t = x / (2.0 * k);
+		fTerm *= t * t;
+		fSum += fTerm;
+	}
+	return fSum;
+}
+
+struct MIPTABLES
+{
+	float	ToLinear[512];						// [0, 256): sRGB -> 선형, [256, 512): n / 255
+	float	Threshold[256];						// sRGB 값 k와 k + 1의 경계가 되는 선형 값. [255]는 무한대
+	INT		SrgbBase[SW_SRGB_NUM_BUCKETS + 1];	// 구간 시작점의 sRGB 값
+	MIPTAPS	Box;
+	MIPTAPS	Kaiser;
+	MIPTAPS	Identity;							// 크기가 1인 축
+
+	MIPTABLES()
+	{
+		for (UINT i = 0; i < 256; ++i)
+		{
+			ToLinear[i] = (float)SrgbToLinear(i / 255.0);
+			ToLinear[256 + i] = i / 255.0f;
+			Threshold[i] = (i < 255) ? (float)SrgbToLinear((i + 0.5) / 255.0) : INFINITY;
+		}
+
+		for (UINT b = 0; b <= SW_SRGB_NUM_BUCKETS; ++b)
+		{
+			const float fStart = BitsToFloat(SW_SRGB_MIN_BITS + (b << SW_SRGB_BUCKET_SHIFT));
+			INT s = 0;
+			while (s < 255 && fStart >= Threshold[s])
+				++s;
+			SrgbBase[b] = s;
+		}
+
+		Box.nOffset = 0;
+		Box.nTaps = 2;
+		Box.fWeights[0] = Box.fWeights[1] = 0.5f;
+
+		Identity.nOffset = 0;
+		Identity.nTaps = 1;
+		Identity.fWeights[0] = 1.0f;
+
+		// 출력 텍셀 중심에서 원본 텍셀 중심까지의 거리 d = -3.5 ~ 3.5.
+		// 절반으로 줄이므로 sinc(d / 2)이고, 창의 반지름은 4텍셀이다.
+		const double fPi = 3.14159265358979323846;
+		double fWeights[SW_MIP_MAX_TAPS], fSum = 0.0;
+		for (int i = 0; i < SW_MIP_MAX_TAPS; ++i)
+		{
+			const double d = i - 3.5;
+			const double x = d * 0.5;
+			const double t = d / 4.0;
+			const double fSinc = sin(fPi * x) / (fPi * x);
+			const double fWindow = BesselI0(SW_KAISER_ALPHA * sqrt(1.0 - t * t)) / BesselI0(SW_KAISER_ALPHA);
+			fWeights[i] = fSinc * fWindow;
+			fSum += fWeights[i];
+		}
+		Kaiser.nOffset = -3;
+		Kaiser.nTaps = SW_MIP_MAX_TAPS;
+		for (int i = 0; i < SW_MIP_MAX_TAPS; ++i)
+			Kaiser.fWeights[i] = (float)(fWeights[i] / fSum);
+	}
+};
+
+static const MIPTABLES s_Tables;
+
+//-----------------------------------------------------------------------------
+// 스칼라(기준) 구현
+// 행은 텍셀마다 float 4개(메모리 순서 B, G, R, A)로 다룬다.
+//-----------------------------------------------------------------------------
+static VOID DecodeRowScalar(const BYTE* pSrc, UINT nCount, bool bSrgb, float* pOut)
+{
+	const float* pColor = s_Tables.ToLinear + (bSrgb ? 0 : 256);
+	const float* pAlpha = s_Tables.ToLinear + 256;
+	for (UINT i = 0; i < nCount * 4; i += 4)
+	{
+		pOut[i + 0] = pColor[pSrc[i + 0]];
+		pOut[i + 1] = pColor[pSrc[i + 1]];
+		pOut[i + 2] = pColor[pSrc[i + 2]];
+		pOut[i + 3] = pAlpha[pSrc[i + 3]];
+	}
+}
+
+// f는 [0, 1] 범위여야 한다.
+static inline UINT EncodeSrgb(float f)
+{
+	const float fIndex = (f > BitsToFloat(SW_SRGB_MIN_BITS)) ? f : BitsToFloat(SW_SRGB_MIN_BITS);
+	UINT nBits;
+	memcpy(&nBits, &fIndex, sizeof(nBits));
+	const UINT s = (UINT)s_Tables.SrgbBase[(nBits - SW_SRGB_MIN_BITS) >> SW_SRGB_BUCKET_SHIFT];
+	return s + ((f >= s_Tables.Threshold[s]) ? 1 : 0);
+}
+
+static VOID EncodeRowScalar(const float* pSrc, UINT nCount, bool bSrgb, BYTE* pDst)
+{
+	for (UINT i = 0; i < nCount * 4; ++i)
+	{
+		float f = pSrc[i];
+		f = (f < 0.0f) ? 0.0f : ((f > 1.0f) ? 1.0f : f);
+		pDst[i] = (BYTE)((bSrgb && (i & 3) != 3) ? EncodeSrgb(f) : (UINT)(f * 255.0f + 0.5f));
+	}
+}
+
+// 가로 필터. pSrc는 여백이 붙은 행에서 텍셀 0의 위치다.
+static VOID FilterRowScalar(const float* pSrc, UINT nDstWidth, UINT nScale, const MIPTAPS* pTaps, float* pOut)
+{
+	for (UINT x = 0; x < nDstWidth; ++x)
+	{
+		const float* pTexel = pSrc + ((INT)(nScale * x) + pTaps->nOffset) * 4;
+		for (UINT c = 0; c < 4; ++c)
+		{
+			float fSum = pTaps->fWeights[0] * pTexel[c];
+			for (UINT i = 1; i < pTaps->nTaps; ++i)
+				fSum = fSum + pTaps->fWeights[i] * pTexel[i * 4 + c];
+			pOut[x * 4 + c] = fSum;
+		}
+	}
+}
+
+// 세로 필터. 가로 필터를 거친 행 nRows개를 가중치로 더한다.
+static VOID BlendRowsScalar(const float* const* ppRows, const float* pWeights, UINT nRows, UINT nFloats, float* pOut)
+{
+	for (UINT i = 0; i < nFloats; ++i)
+	{
+		float fSum = pWeights[0] * ppRows[0][i];
+		for (UINT r = 1; r < nRows; ++r)
+			fSum = fSum + pWeights[r] * ppRows[r][i];
+		pOut[i] = fSum;
+	}
+}
+
+#ifdef SW_X86
+
+//-----------------------------------------------------------------------------
+// SSE2 구현: 텍셀 하나(float 4개)를 레지스터 하나로 거른다. 변환은 스칼라 표를 쓴다.
+//-----------------------------------------------------------------------------
+// 탭 수를 컴파일 시간에 정하면 가중치를 레지스터에 올려 두고 탭 루프를 풀 수 있다.
+// 더하는 순서는 스칼라 구현과 같다.
+template<UINT NUM_TAPS>
+SW_TARGET_SSE2
+static VOID FilterRowSSE2T(const float* pSrc, UINT nDstWidth, UINT nScale, const MIPTAPS* pTaps, float* pOut)
+{
+	__m128 weights[NUM_TAPS];
+	for (UINT i = 0; i < NUM_TAPS; ++i)
+		weights[i] = _mm_set1_ps(pTaps->fWeights[i]);
+
+	const float* pTexel = pSrc + pTaps->nOffset * 4;
+	for (UINT x = 0; x < nDstWidth; ++x, pTexel += nScale * 4)
+	{
+		__m128 sum = _mm_mul_ps(weights[0], _mm_loadu_ps(pTexel));
+		for (UINT i = 1; i < NUM_TAPS; ++i)
+			sum = _mm_add_ps(sum, _mm_mul_ps(weights[i], _mm_loadu_ps(pTexel + i * 4)));
+		_mm_storeu_ps(pOut + x * 4, sum);
+	}
+}
+
+static VOID FilterRowSSE2(const float* pSrc, UINT nDstWidth, UINT nScale, const MIPTAPS* pTaps, float* pOut)
+{
+	switch (pTaps->nTaps)
+	{
+	case 1:		FilterRowSSE2T<1>(pSrc, nDstWidth, nScale, pTaps, pOut);	break;
+	case 2:		FilterRowSSE2T<2>(pSrc, nDstWidth, nScale, pTaps, pOut);	break;
+	default:	FilterRowSSE2T<SW_MIP_MAX_TAPS>(pSrc, nDstWidth, nScale, pTaps, pOut);	break;
+	}
+}
+
+template<UINT NUM_ROWS>
+SW_TARGET_SSE2
+static VOID BlendRowsSSE2T(const float* const* ppRows, const float* pWeights, UINT nFloats, float* pOut)
+{
+	__m128 weights[NUM_ROWS];
+	for (UINT r = 0; r < NUM_ROWS; ++r)
+		weights[r] = _mm_set1_ps(pWeights[r]);
+
+	for (UINT i = 0; i < nFloats; i += 4)
+	{
+		__m128 sum = _mm_mul_ps(weights[0], _mm_loadu_ps(ppRows[0] + i));
+		for (UINT r = 1; r < NUM_ROWS; ++r)
+			sum = _mm_add_ps(sum, _mm_mul_ps(weights[r], _mm_loadu_ps(ppRows[r] + i)));
+		_mm_storeu_ps(pOut + i, sum);
+	}
+}
+
+static VOID BlendRowsSSE2(const float* const* ppRows, const float* pWeights, UINT nRows, UINT nFloats, float* pOut)
+{
+	switch (nRows)
+	{
+	case 1:		BlendRowsSSE2T<1>(ppRows, pWeights, nFloats, pOut);					break;
+	case 2:		BlendRowsSSE2T<2>(ppRows, pWeights, nFloats, pOut);					break;
+	default:	BlendRowsSSE2T<SW_MIP_MAX_TAPS>(ppRows, pWeights, nFloats, pOut);	break;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 구현
+// 8비트 -> 선형 변환은 텍셀 2개(바이트 8개)의 표 찾기를 vgatherdps 한 번으로 한다.
+// 알파 채널(과 SW_MIPMAP_LINEAR의 색 채널)은 인덱스에 256을 더해 n / 255 표를 찾는다.
+// 선형 -> sRGB 변환은 float 비트로 구간 번호를 계산해 구간 시작값과 경계값을 차례로 gather한다.
+//-----------------------------------------------------------------------------
+SW_TARGET_AVX2
+static VOID DecodeRowAVX2(const BYTE* pSrc, UINT nCount, bool bSrgb, float* pOut)
+{
+	const __m256i offsets = bSrgb ? _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256) : _mm256_set1_epi32(256);
+
+	UINT i = 0;
+	for (; i + 2 <= nCount; i += 2)
+	{
+		const __m256i index = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pSrc + i * 4))), offsets);
+		_mm256_storeu_ps(pOut + i * 4, _mm256_i32gather_ps(s_Tables.ToLinear, index, 4));
+	}
+	DecodeRowScalar(pSrc + i * 4, nCount - i, bSrgb, pOut + i * 4);
+}
+
+SW_TARGET_AVX2
+static VOID EncodeRowAVX2(const float* pSrc, UINT nCount, bool bSrgb, BYTE* pDst)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 one = _mm256_set1_ps(1.0f);
+	const __m256 minIndex = _mm256_set1_ps(BitsToFloat(SW_SRGB_MIN_BITS));
+	const __m256i minBits = _mm256_set1_epi32(SW_SRGB_MIN_BITS);
+	const __m256 scale = _mm256_set1_ps(255.0f);
+	const __m256 half = _mm256_set1_ps(0.5f);
+	const __m256i srgbLanes = bSrgb ? _mm256_setr_epi32(-1, -1, -1, 0, -1, -1, -1, 0) : _mm256_setzero_si256();
+
+	UINT i = 0;
+	for (; i + 2 <= nCount; i += 2)
+	{
+		const __m256 f = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pSrc + i * 4), zero), one);
+		const __m256i linear = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(f, scale), half));
+
+		const __m256i bits = _mm256_castps_si256(_mm256_max_ps(f, minIndex));
+		const __m256i bucket = _mm256_srli_epi32(_mm256_sub_epi32(bits, minBits), SW_SRGB_BUCKET_SHIFT);
+		const __m256i base = _mm256_i32gather_epi32(s_Tables.SrgbBase, bucket, 4);
+		const __m256 threshold = _mm256_i32gather_ps(s_Tables.Threshold, base, 4);
+		const __m256i srgb = _mm256_sub_epi32(base, _mm256_castps_si256(_mm256_cmp_ps(f, threshold, _CMP_GE_OQ)));
+
+		// 32비트 8개를 바이트 8개로 줄인다.
+		const __m256i v = _mm256_blendv_epi8(linear, srgb, srgbLanes);
+		const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+		_mm_storel_epi64((__m128i*)(pDst + i * 4), _mm_packus_epi16(words, words));
+	}
+	EncodeRowScalar(pSrc + i * 4, nCount - i, bSrgb, pDst + i * 4);
+}
+
+template<UINT NUM_ROWS>
+SW_TARGET_AVX2
+static VOID BlendRowsAVX2T(const float* const* ppRows, const float* pWeights, UINT nFloats, float* pOut)
+{
+	__m256 weights[NUM_ROWS];
+	for (UINT r = 0; r < NUM_ROWS; ++r)
+		weights[r] = _mm256_set1_ps(pWeights[r]);
+
+	UINT i = 0;
+	for (; i + 8 <= nFloats; i += 8)
+	{
+		__m256 sum = _mm256_mul_ps(weights[0], _mm256_loadu_ps(ppRows[0] + i));
+		for (UINT r = 1; r < NUM_ROWS; ++r)
+			sum = _mm256_add_ps(sum, _mm256_mul_ps(weights[r], _mm256_loadu_ps(ppRows[r] + i)));
+		_mm256_storeu_ps(pOut + i, sum);
+	}
+	if (i < nFloats)
+	{
+		const float* pTail[NUM_ROWS];
+		for (UINT r = 0; r < NUM_ROWS; ++r)
+			pTail[r] = ppRows[r] + i;
+		BlendRowsSSE2T<NUM_ROWS>(pTail, pWeights, nFloats - i, pOut + i);
+	}
+}
+
+static VOID BlendRowsAVX2(const float* const* ppRows, const float* pWeights, UINT nRows, UINT nFloats, float* pOut)
+{
+	switch (nRows)
+	{
+	case 1:		BlendRowsAVX2T<1>(ppRows, pWeights, nFloats, pOut);					break;
+	case 2:		BlendRowsAVX2T<2>(ppRows, pWeights, nFloats, pOut);					break;
+	default:	BlendRowsAVX2T<SW_MIP_MAX_TAPS>(ppRows, pWeights, nFloats, pOut);	break;
+	}
+}
+
+static bool HasAVX2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return false;
+
+	// 운영체제가 YMM 레지스터를 저장해 주는가(OSXSAVE와 XCR0)
+	__cpuid(info, 1);
+	if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+		return false;
+	if ((_xgetbv(0) & 0x6) != 0x6)
+		return false;
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+static bool HasSSE2()
+{
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 1);
+	return (info[3] & (1 << 26)) != 0;
+#else
+	return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+#endif	// SW_X86
+
+//-----------------------------------------------------------------------------
+// 선택
+//-----------------------------------------------------------------------------
+struct MIPKERNEL
+{
+	VOID	(*pfnDecodeRow)(const BYTE* pSrc, UINT nCount, bool bSrgb, float* pOut);
+	VOID	(*pfnEncodeRow)(const float* pSrc, UINT nCount, bool bSrgb, BYTE* pDst);
+	VOID	(*pfnFilterRow)(const float* pSrc, UINT nDstWidth, UINT nScale, const MIPTAPS* pTaps, float* pOut);
+	VOID	(*pfnBlendRows)(const float* const* ppRows, const float* pWeights, UINT nRows, UINT nFloats, float* pOut);
+};
+
+static const MIPKERNEL s_ScalarKernel = { DecodeRowScalar, EncodeRowScalar, FilterRowScalar, BlendRowsScalar };
+#ifdef SW_X86
+static const MIPKERNEL s_SSE2Kernel = { DecodeRowScalar, EncodeRowScalar, FilterRowSSE2, BlendRowsSSE2 };
+static const MIPKERNEL s_AVX2Kernel = { DecodeRowAVX2, EncodeRowAVX2, FilterRowSSE2, BlendRowsAVX2 };
+#endif
+
+static SW_MIPKERNEL GetBestMipmapKernel()
+{
+#ifdef SW_X86
+	if (HasAVX2())
+		return SW_MIPKERNEL_AVX2;
+	if (HasSSE2())
+		return SW_MIPKERNEL_SSE2;
+#endif
+	return SW_MIPKERNEL_SCALAR;
+}
+
+static SW_MIPKERNEL			s_eMipKernel = SW_MIPKERNEL_SCALAR;
+static const MIPKERNEL*		s_pMipKernel = &s_ScalarKernel;
+
+// 정적 초기화 시점에 한 번 선택해 둔다.
+static const SW_MIPKERNEL	s_eInitialKernel = SwSetMipmapKernel(SW_MIPKERNEL_AUTO);
+
+SW_MIPKERNEL SwSetMipmapKernel(SW_MIPKERNEL eKernel)
+{
+	const SW_MIPKERNEL eBest = GetBestMipmapKernel();
+	if (eKernel == SW_MIPKERNEL_AUTO || eKernel > eBest)
+		eKernel = eBest;
+
+	switch (eKernel)
+	{
+#ifdef SW_X86
+	case SW_MIPKERNEL_AVX2:	s_pMipKernel = &s_AVX2Kernel;	break;
+	case SW_MIPKERNEL_SSE2:	s_pMipKernel = &s_SSE2Kernel;	break;
+#endif
+	default:
+		eKernel = SW_MIPKERNEL_SCALAR;
+		s_pMipKernel = &s_ScalarKernel;
+		break;
+	}
+
+	s_eMipKernel = eKernel;
+	return eKernel;
+}
+
+SW_MIPKERNEL SwGetMipmapKernel()
+{
+	return s_eMipKernel;
+}
+
+const char* SwGetMipmapKernelName(SW_MIPKERNEL eKernel)
+{
+	switch (eKernel)
+	{
+	case SW_MIPKERNEL_SCALAR:	return "scalar";
+	case SW_MIPKERNEL_SSE2:		return "sse2";
+	case SW_MIPKERNEL_AVX2:		return "avx2";
+	default:					return "auto";
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 레벨 하나 만들기
+//-----------------------------------------------------------------------------
+static inline INT AddressTexel(INT i, INT nSize, bool bWrap)
+{
+	if (bWrap)
+	{
+		i %= nSize;
+		return (i < 0) ? i + nSize : i;
+	}
+	return (i < 0) ? 0 : ((i >= nSize) ? nSize - 1 : i);
+}
+
+// 스레드마다 하나씩 갖는 작업 공간
+struct MIPSCRATCH
+{
+	std::vector<float>	Decoded;					// 여백이 붙은 원본 행 하나
+	std::vector<float>	Rows;						// 가로 필터를 거친 행 SW_MIP_MAX_TAPS개
+	INT					nRowKeys[SW_MIP_MAX_TAPS];	// Rows의 각 행이 어느 원본 행인가(-1이면 비어 있다)
+	std::vector<float>	Out;						// 세로 필터를 거친 출력 행
+};
+
+struct MIPLEVELJOB
+{
+	const SW_MIPSURFACE*	pSrc;
+	const SW_MIPSURFACE*	pDst;
+	const MIPTAPS*			pTapsX;
+	const MIPTAPS*			pTapsY;
+	UINT					nScaleX;
+	UINT					nScaleY;
+	bool					bSrgb;
+	bool					bWrap;
+	const MIPKERNEL*		pKernel;
+};
+
+// 원본 행 y를 풀어 가로 필터를 적용한다.
+static VOID FilterSourceRow(const MIPLEVELJOB& job, INT y, MIPSCRATCH* pScratch, float* pOut)
+{
+	const SW_MIPSURFACE& src = *job.pSrc;
+	const INT nWidth = (INT)src.nWidth;
+	float* pRow = pScratch->Decoded.data() + SW_MIP_PAD * 4;
+
+	job.pKernel->pfnDecodeRow((const BYTE*)src.pBits + (ptrdiff_t)y * src.nPitch, src.nWidth, job.bSrgb, pRow);
+	for (INT p = 1; p <= SW_MIP_PAD; ++p)
+	{
+		memcpy(pRow - p * 4, pRow + AddressTexel(-p, nWidth, job.bWrap) * 4, sizeof(float) * 4);
+		memcpy(pRow + (nWidth - 1 + p) * 4, pRow + AddressTexel(nWidth - 1 + p, nWidth, job.bWrap) * 4, sizeof(float) * 4);
+	}
+
+	job.pKernel->pfnFilterRow(pRow, job.pDst->nWidth, job.nScaleX, job.pTapsX, pOut);
+}
+
+static VOID GenerateBand(const MIPLEVELJOB& job, UINT y0, UINT y1, MIPSCRATCH* pScratch)
+{
+	const SW_MIPSURFACE& dst = *job.pDst;
+	const MIPTAPS& taps = *job.pTapsY;
+	const size_t nRowFloats = (size_t)dst.nWidth * 4;
+
+	for (UINT r = 0; r < SW_MIP_MAX_TAPS; ++r)
+		pScratch->nRowKeys[r] = -1;
+
+	for (UINT y = y0; y < y1; ++y)
+	{
+		INT nNeeded[SW_MIP_MAX_TAPS];
+		for (UINT t = 0; t < taps.nTaps; ++t)
+			nNeeded[t] = AddressTexel((INT)(job.nScaleY * y) + taps.nOffset + (INT)t, (INT)job.pSrc->nHeight, job.bWrap);
+
+		// 보관한 행에 없으면 이번 행에 쓰이지 않는 칸에 새로 계산한다. 칸 수가 탭 수와 같으므로 항상 빈 칸이 있다.
+		const float* pRows[SW_MIP_MAX_TAPS];
+		for (UINT t = 0; t < taps.nTaps; ++t)
+		{
+			UINT nSlot = SW_MIP_MAX_TAPS;
+			for (UINT r = 0; r < taps.nTaps && nSlot == SW_MIP_MAX_TAPS; ++r)
+			{
+				if (pScratch->nRowKeys[r] == nNeeded[t])
+					nSlot = r;
+			}
+
+			if (nSlot == SW_MIP_MAX_TAPS)
+			{
+				for (UINT r = 0; r < taps.nTaps && nSlot == SW_MIP_MAX_TAPS; ++r)
+				{
+					bool bInUse = false;
+					for (UINT k = 0; k < taps.nTaps && !bInUse; ++k)
+						bInUse = (pScratch->nRowKeys[r] == nNeeded[k]);
+					if (!bInUse)
+						nSlot = r;
+				}
+				FilterSourceRow(job, nNeeded[t], pScratch, pScratch->Rows.data() + nSlot * nRowFloats);
+				pScratch->nRowKeys[nSlot] = nNeeded[t];
+			}
+			pRows[t] = pScratch->Rows.data() + nSlot * nRowFloats;
+		}
+
+		job.pKernel->pfnBlendRows(pRows, taps.fWeights, taps.nTaps, (UINT)nRowFloats, pScratch->Out.data());
+		job.pKernel->pfnEncodeRow(pScratch->Out.data(), dst.nWidth, job.bSrgb,
+			(BYTE*)dst.pBits + (ptrdiff_t)y * dst.nPitch);
+	}
+}
+
+static const MIPTAPS* GetTaps(SW_MIPFILTER eFilter, UINT nSrcSize, UINT* pScale)
+{
+	if (nSrcSize == 1)
+	{
+		*pScale = 1;
+		return &s_Tables.Identity;
+	}
+	*pScale = 2;
+	return (eFilter == SW_MIPFILTER_KAISER) ? &s_Tables.Kaiser : &s_Tables.Box;
+}
+
+//-----------------------------------------------------------------------------
+// 밉 체인
+//-----------------------------------------------------------------------------
+HRESULT SwGenerateMipmapChain(const SW_MIPSURFACE* pLevels, UINT nLevels, SW_MIPFILTER eFilter,
+	DWORD dwFlags, CSwThreadPool* pThreadPool)
+{
+	if (pLevels == NULL || nLevels == 0)
+		return D3DERR_INVALIDCALL;
+	for (UINT i = 0; i < nLevels; ++i)
+	{
+		if (pLevels[i].pBits == NULL || pLevels[i].nWidth == 0 || pLevels[i].nHeight == 0)
+			return D3DERR_INVALIDCALL;
+		if (i > 0 && (pLevels[i].nWidth != (pLevels[i - 1].nWidth > 1 ? pLevels[i - 1].nWidth / 2 : 1) ||
+			pLevels[i].nHeight != (pLevels[i - 1].nHeight > 1 ? pLevels[i - 1].nHeight / 2 : 1)))
+		{
+			return D3DERR_INVALIDCALL;
+		}
+	}
+	if (nLevels == 1)
+		return S_OK;
+
+	if (pThreadPool == NULL && (size_t)pLevels[0].nWidth * pLevels[0].nHeight >= SW_MIP_PARALLEL_MIN_TEXELS)
+		pThreadPool = SwGetDefaultThreadPool();
+
+	// 작업 공간은 가장 큰 레벨에 맞추어 한 번만 만든다.
+	const UINT nThreads = pThreadPool ? pThreadPool->GetNumThreads() : 1;
+	std::vector<MIPSCRATCH> scratch(nThreads);
+	for (MIPSCRATCH& s : scratch)
+	{
+		s.Decoded.resize(((size_t)pLevels[0].nWidth + SW_MIP_PAD * 2) * 4);
+		s.Rows.resize((size_t)SW_MIP_MAX_TAPS * pLevels[1].nWidth * 4);
+		s.Out.resize((size_t)pLevels[1].nWidth * 4);
+	}
+
+	MIPLEVELJOB job;
+	job.bSrgb = (dwFlags & SW_MIPMAP_LINEAR) == 0;
+	job.bWrap = (dwFlags & SW_MIPMAP_WRAP) != 0;
+	job.pKernel = s_pMipKernel;
+
+	for (UINT i = 1; i < nLevels; ++i)
+	{
+		job.pSrc = &pLevels[i - 1];
+		job.pDst = &pLevels[i];
+		job.pTapsX = GetTaps(eFilter, job.pSrc->nWidth, &job.nScaleX);
+		job.pTapsY = GetTaps(eFilter, job.pSrc->nHeight, &job.nScaleY);
+
+		const UINT nHeight = job.pDst->nHeight;
+		const UINT nBands = (nHeight + SW_MIP_BAND_ROWS - 1) / SW_MIP_BAND_ROWS;
+		if (pThreadPool == NULL || nBands == 1)
+		{
+			GenerateBand(job, 0, nHeight, &scratch[0]);
+			continue;
+		}
+
+		pThreadPool->ParallelFor(nBands, [&](UINT nBand, UINT nThread)
+		{
+			const UINT y0 = nBand * SW_MIP_BAND_ROWS;
+			const UINT y1 = (y0 + SW_MIP_BAND_ROWS < nHeight) ? y0 + SW_MIP_BAND_ROWS : nHeight;
+			GenerateBand(job, y0, y1, &scratch[nThread]);
+		});
+	}
+	return S_OK;
+}
+
+HRESULT SwGenerateMipmaps(CSwTexture* pTexture, SW_MIPFILTER eFilter, DWORD dwFlags, CSwThreadPool* pThreadPool)
+{
+	if (pTexture == NULL || pTexture->GetBlockSize() != 0)
+		return D3DERR_INVALIDCALL;
+
+	const UINT nLevels = pTexture->GetLevelCount();
+	std::vector<SW_MIPSURFACE> levels(nLevels);
+	for (UINT i = 0; i < nLevels; ++i)
+	{
+		D3DLOCKED_RECT rect;
+		pTexture->LockRect(i, &rect, NULL, 0);
+		levels[i].pBits = rect.pBits;
+		levels[i].nPitch = rect.Pitch;
+		levels[i].nWidth = pTexture->GetWidth(i);
+		levels[i].nHeight = pTexture->GetHeight(i);
+	}
+
+	const HRESULT hr = SwGenerateMipmapChain(levels.data(), nLevels, eFilter, dwFlags, pThreadPool);
+
+	for (UINT i = 0; i < nLevels; ++i)
+		pTexture->UnlockRect(i);
+	return hr;
+}
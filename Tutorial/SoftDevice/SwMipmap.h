@@ -0,0 +1,61 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwMipmap.h
+//
+// 설명:	A8R8G8B8/X8R8G8B8 밉 체인 생성. D3DXFilterTexture()를 대신한다.
+//		색은 sRGB로 보고 선형 공간으로 바꾸어 거른 다음 다시 sRGB로 돌려놓으므로
+//		8비트 값을 그대로 평균할 때처럼 줄인 레벨이 어두워지지 않는다. 알파는 선형 값이다.
+//
+//		필터는 가로, 세로로 나누어(separable) 적용한다. 박스 필터는 2x2 평균이고,
+//		Kaiser 필터는 Kaiser 창을 씌운 sinc(8탭)로 박스보다 흐림과 계단 현상이 적다.
+//		한 레벨을 행 묶음으로 나누어 스레드 풀에서 만들고, 8비트 <-> 선형 변환과 필터는
+//		SSE2/AVX2로 처리한다. 모든 구현은 같은 순서로 계산하므로 결과가 스칼라 구현과 같다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+class CSwTexture;
+class CSwThreadPool;
+
+enum SW_MIPFILTER
+{
+	SW_MIPFILTER_BOX = 0,
+	SW_MIPFILTER_KAISER,
+};
+
+// SwGenerateMipmapChain() 플래그
+#define SW_MIPMAP_WRAP		0x1		// 가장자리 밖의 텍셀을 반대쪽에서 가져온다(기본은 가장자리 텍셀 반복)
+#define SW_MIPMAP_LINEAR	0x2		// 색을 이미 선형 값으로 보고 감마 변환을 하지 않는다
+
+enum SW_MIPKERNEL
+{
+	SW_MIPKERNEL_AUTO = 0,			// CPU가 지원하는 가장 빠른 구현
+	SW_MIPKERNEL_SCALAR,
+	SW_MIPKERNEL_SSE2,
+	SW_MIPKERNEL_AVX2,
+};
+
+// 사용할 구현을 고른다. 지원하지 않는 구현을 요청하면 그보다 좁은 구현을 쓴다.
+// 실제로 선택된 구현을 돌려준다. 밉 생성 중에는 호출하지 않는다.
+SW_MIPKERNEL	SwSetMipmapKernel(SW_MIPKERNEL eKernel);
+SW_MIPKERNEL	SwGetMipmapKernel();
+const char*		SwGetMipmapKernelName(SW_MIPKERNEL eKernel);
+
+// 잠근 레벨 하나(32비트 텍셀)
+struct SW_MIPSURFACE
+{
+	void*	pBits;
+	INT		nPitch;
+	UINT	nWidth;
+	UINT	nHeight;
+};
+
+// pLevels[0]에서 시작해 pLevels[i - 1]을 줄여 pLevels[i]를 차례로 채운다.
+// 각 레벨의 크기는 앞 레벨의 절반(최소 1)이어야 한다. 홀수 크기에서는 마지막 행, 열이 버려진다.
+// pThreadPool이 NULL이면 큰 텍스처에서만 기본 풀(SwGetDefaultThreadPool())을 쓴다.
+HRESULT	SwGenerateMipmapChain(const SW_MIPSURFACE* pLevels, UINT nLevels, SW_MIPFILTER eFilter,
+			DWORD dwFlags, CSwThreadPool* pThreadPool = NULL);
+
+// 텍스처의 레벨 0으로 나머지 레벨을 모두 만든다. 블록 압축 텍스처는 D3DERR_INVALIDCALL.
+HRESULT	SwGenerateMipmaps(CSwTexture* pTexture, SW_MIPFILTER eFilter, DWORD dwFlags,
+			CSwThreadPool* pThreadPool = NULL);
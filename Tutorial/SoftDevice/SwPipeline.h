@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwPipeline.h
+//
+// 설명:	정점 단계, 래스터라이저, 픽셀 단계가 함께 사용하는 자료 구조.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+class CSwTexture;
+
+#define SW_MAX_TEXTURE_STAGES	8		// 텍스처 스테이지 개수(D3D9와 같다)
+#define SW_MAX_TEXCOORDS		2		// 보간하는 텍스처 좌표 집합의 개수
+#define SW_MAX_LIGHTS			8		// 동시에 켤 수 있는 광원 개수
+#define SW_NUM_RENDERSTATES		256
+#define SW_NUM_STAGESTATES		33
+#define SW_NUM_SAMPLERSTATES	14
+#define SW_BLOCK_SIZE			8		// 래스터화와 Hi-Z 블록의 폭과 높이(픽셀)
+
+//-----------------------------------------------------------------------------
+// 정점 단계의 출력
+// 변환된 정점은 클립 공간 좌표(x, y, z, w)를 갖는다.
+// D3DFVF_XYZRHW 정점은 이미 화면 좌표이므로 bTransformed가 설정되고
+// x, y, z는 화면 좌표, w는 1 / rhw 값을 갖는다.
+//-----------------------------------------------------------------------------
+struct SW_VERTEX
+{
+	float	x, y, z, w;
+	float	color[4];						// r, g, b, a (0.0 ~ 1.0)
+	float	tex[SW_MAX_TEXCOORDS][2];		// u, v
+};
+
+//-----------------------------------------------------------------------------
+// 텍스처 스테이지 하나의 상태
+//-----------------------------------------------------------------------------
+struct SW_STAGESTATE
+{
+	DWORD		dwColorOp;
+	DWORD		dwColorArg1;
+	DWORD		dwColorArg2;
+	DWORD		dwAlphaOp;
+	DWORD		dwAlphaArg1;
+	DWORD		dwAlphaArg2;
+	DWORD		dwTexCoordIndex;
+
+	CSwTexture*	pTexture;
+	DWORD		dwAddressU;
+	DWORD		dwAddressV;
+	DWORD		dwMagFilter;
+	DWORD		dwMinFilter;
+	DWORD		dwMipFilter;
+};
+
+//-----------------------------------------------------------------------------
+// 텍스처 스테이지 조합기
+// 스테이지 연결에 맞추어 고른 픽셀 셰이딩 함수(SwCombiner.h). 픽셀마다 D3DTOP_* 값으로 분기하지 않는다.
+//-----------------------------------------------------------------------------
+struct SW_DRAWSTATE;
+
+// 스테이지 하나의 연산 입력(색 4개, r, g, b, a)
+struct SW_COMBINEARGS
+{
+	const float*	pDiffuse;
+	const float*	pCurrent;
+	const float*	pTexture;
+	const float*	pFactor;
+};
+
+// 색 연산은 pResult[0..2], 알파 연산은 pResult[3]을 채운다.
+typedef VOID	(*SW_COMBINEFUNC)(const SW_COMBINEARGS& args, float* pResult);
+// 보간된 정점 색과 텍스처 좌표로 최종 픽셀 색(A8R8G8B8)을 계산한다(SwShadePixel()과 같은 형식).
+typedef DWORD	(*SW_SHADEFUNC)(const SW_DRAWSTATE* pState, const float* pDiffuse,
+					const float (*pTexCoords)[2], const float (*pTexDerivs)[4]);
+
+struct SW_COMBINER
+{
+	SW_SHADEFUNC	pfnShade;
+	SW_COMBINEFUNC	pfnColor[SW_MAX_TEXTURE_STAGES];	// 스테이지별 연산을 이어 붙인 경로에서만 쓴다
+	SW_COMBINEFUNC	pfnAlpha[SW_MAX_TEXTURE_STAGES];
+	DWORD			dwSampleMask;						// 텍스처를 샘플링해야 하는 스테이지 비트
+};
+
+//-----------------------------------------------------------------------------
+// 드로우 호출 시점의 픽셀 처리 상태
+// 드로우 호출마다 하나씩 만들어지며 그 드로우에서 나온 삼각형들이 공유한다.
+//-----------------------------------------------------------------------------
+struct SW_DRAWSTATE
+{
+	BOOL			bZEnable;
+	BOOL			bZWriteEnable;
+	DWORD			dwZFunc;
+	DWORD			dwTextureFactor;
+
+	UINT			nNumStages;				// DISABLE 이전까지의 유효한 스테이지 개수
+	BOOL			bUsesTexCoords;			// 텍스처 좌표 보간이 필요한가
+	BOOL			bUsesLod;				// 텍스처 좌표의 화면 공간 미분으로 밉 레벨을 골라야 하는가
+	UINT			nNumTexCoords;			// 정점이 가진 텍스처 좌표 집합의 개수. 나머지는 0이다.
+	SW_STAGESTATE	Stages[SW_MAX_TEXTURE_STAGES];
+	SW_COMBINER		Combiner;				// SwPrepareDrawState()가 스테이지 연결에 맞추어 고른다
+};
+
+//-----------------------------------------------------------------------------
+// 계층 Z 버퍼(Hi-Z)의 항목 하나. 8x8 픽셀 블록의 깊이 범위를 보수적으로 갖는다.
+//-----------------------------------------------------------------------------
+struct SW_HIZBLOCK
+{
+	float	fMin;
+	float	fMax;
+};
+
+//-----------------------------------------------------------------------------
+// 렌더 타겟(후면 버퍼와 Z 버퍼)
+//-----------------------------------------------------------------------------
+struct SW_RENDERTARGET
+{
+	DWORD*			pColor;
+	float*			pDepth;					// Z 버퍼가 없으면 NULL
+	SW_HIZBLOCK*	pHiZ;					// Z 버퍼가 없으면 NULL
+	UINT			nWidth;
+	UINT			nHeight;
+	UINT			nHiZPitch;				// Hi-Z 한 행의 블록 수
+};
+
+//-----------------------------------------------------------------------------
+// 프레임 통계
+//-----------------------------------------------------------------------------
+struct SW_FRAMESTATS
+{
+	UINT64	nDrawCalls;
+	UINT64	nVertices;						// 정점 단계에서 처리한 정점 수
+	UINT64	nTriangles;						// 드로우 호출로 들어온 삼각형 수
+	UINT64	nTrianglesCulled;				// 컬링, 클리핑으로 버려진 삼각형 수
+	UINT64	nPixelsShaded;					// 깊이 테스트를 통과하여 기록된 픽셀 수
+	UINT64	nHiZTrianglesCulled;			// Hi-Z로 타일 하나에서 통째로 버려진 삼각형 수
+	UINT64	nHiZBlocksCulled;				// Hi-Z로 버려진 8x8 블록 수
+	UINT64	nStateCalls;					// 상태 설정 호출 수(상태 블록이 설정한 항목 포함)
+	UINT64	nStateCallsFiltered;			// 그중 값이 같아 버린 수
+	UINT64	nStateBlocksApplied;			// 적용한 상태 블록 수
+	UINT64	nCommandListsExecuted;			// 실행한 명령 목록 수
+	UINT64	nDrawStatesBuilt;				// 새로 만든 픽셀 처리 상태 수
+	UINT64	nDrawStatesReused;				// 상태가 바뀌지 않아 앞 드로우의 것을 다시 쓴 수
+};
@@ -0,0 +1,309 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwPixelStage.cpp
+//
+// 설명:	텍스처 샘플링과 텍스처 스테이지 연산 구현.
+//-----------------------------------------------------------------------------
+#include "SwPixelStage.h"
+#include "SwBlockCompress.h"
+#include "SwCombiner.h"
+#include "SwResource.h"
+
+#include <cmath>
+#include <cstdint>
+
+//-----------------------------------------------------------------------------
+// 보조 함수
+//-----------------------------------------------------------------------------
+// 텍스처 주소 모드에 따라 정수 텍셀 좌표를 [0, nSize) 범위로 옮긴다.
+static inline INT AddressTexel(INT i, INT nSize, DWORD dwAddress)
+{
+	switch (dwAddress)
+	{
+	case D3DTADDRESS_CLAMP:
+	case D3DTADDRESS_BORDER:
+		return i < 0 ? 0 : (i >= nSize ? nSize - 1 : i);
+
+	case D3DTADDRESS_MIRROR:
+	{
+		INT nPeriod = nSize * 2;
+		i %= nPeriod;
+		if (i < 0)
+			i += nPeriod;
+		return (i < nSize) ? i : nPeriod - 1 - i;
+	}
+
+	default:	// D3DTADDRESS_WRAP
+		i %= nSize;
+		return (i < 0) ? i + nSize : i;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 풀어 둔 블록 캐시
+// 블록 압축 텍스처는 텍셀이 든 4x4 블록을 풀어 스레드마다 가진 작은 직접 사상 캐시에 넣어 두고 읽는다.
+// 이중 선형 필터의 텍셀 4개와 이웃 픽셀은 대부분 같은 블록에 있으므로 블록 하나를 여러 번 풀지 않는다.
+// 키는 블록 주소와 텍스처 내용 식별 값이므로 텍스처를 고치거나 지운 뒤 같은 주소가 쓰여도 틀린 값을 읽지 않는다.
+//-----------------------------------------------------------------------------
+#define SW_BLOCKCACHE_BITS	6
+#define SW_BLOCKCACHE_SIZE	(1 << SW_BLOCKCACHE_BITS)
+
+struct SW_BLOCKCACHEENTRY
+{
+	const BYTE*	pBlock;
+	UINT64		nContentId;
+	DWORD		Texels[16];
+};
+
+static thread_local SW_BLOCKCACHEENTRY s_BlockCache[SW_BLOCKCACHE_SIZE];
+
+// 위아래 블록 행이 같은 칸에 모이지 않도록 블록 주소를 곱셈 해시로 섞는다.
+static inline const DWORD* FetchBlock(const CSwTexture* pTex, const BYTE* pBlock)
+{
+	const UINT nSlot = (UINT)((((UINT64)(uintptr_t)pBlock >> 3) * 0x9e3779b97f4a7c15ull) >> (64 - SW_BLOCKCACHE_BITS));
+	SW_BLOCKCACHEENTRY& entry = s_BlockCache[nSlot];
+	if (entry.pBlock != pBlock || entry.nContentId != pTex->GetContentId())
+	{
+		SwDecodeBlock(pTex->GetFormat(), pBlock, entry.Texels);
+		entry.pBlock = pBlock;
+		entry.nContentId = pTex->GetContentId();
+	}
+	return entry.Texels;
+}
+
+// 레벨 하나의 텍셀 (x, y)를 읽는다. 좌표는 이미 주소 모드를 적용한 값이다.
+// 이중 선형 필터의 텍셀 4개는 대개 같은 블록에 있으므로 마지막 블록은 캐시를 찾지 않고 바로 쓴다.
+struct SW_TEXELFETCH
+{
+	const CSwTexture*	pTex;
+	const BYTE*			pBits;
+	INT					nPitch;
+	UINT				nBlockSize;
+	const BYTE*			pLastBlock;
+	const DWORD*		pLastTexels;
+
+	inline DWORD operator()(INT x, INT y)
+	{
+		if (nBlockSize == 0)
+			return ((const DWORD*)(pBits + (ptrdiff_t)y * nPitch))[x];
+
+		const BYTE* pBlock = pBits + (ptrdiff_t)(y >> 2) * nPitch + (x >> 2) * nBlockSize;
+		if (pBlock != pLastBlock)
+		{
+			pLastBlock = pBlock;
+			pLastTexels = FetchBlock(pTex, pBlock);
+		}
+		return pLastTexels[(y & 3) * 4 + (x & 3)];
+	}
+};
+
+//-----------------------------------------------------------------------------
+// 드로우 상태 준비
+//-----------------------------------------------------------------------------
+VOID SwPrepareDrawState(SW_DRAWSTATE* pState)
+{
+	pState->nNumStages = 0;
+	pState->bUsesTexCoords = FALSE;
+	pState->bUsesLod = FALSE;
+
+	for (UINT i = 0; i < SW_MAX_TEXTURE_STAGES; ++i)
+	{
+		const SW_STAGESTATE& stage = pState->Stages[i];
+		if (stage.dwColorOp == D3DTOP_DISABLE)
+			break;
+
+		++pState->nNumStages;
+		if (stage.pTexture != NULL)
+		{
+			pState->bUsesTexCoords = TRUE;
+
+			// 축소 필터가 확대 필터와 다르거나 밉 레벨을 골라야 할 때만 미분을 계산한다.
+			if (stage.dwMinFilter != stage.dwMagFilter ||
+				(stage.dwMipFilter != D3DTEXF_NONE && stage.pTexture->GetLevelCount() > 1))
+			{
+				pState->bUsesLod = TRUE;
+			}
+		}
+	}
+
+	SwSelectCombiner(pState);
+}
+
+//-----------------------------------------------------------------------------
+// 텍스처 샘플링
+// D3D9 규약에 따라 텍셀 (i, j)의 중심은 ((i + 0.5) / 폭, (j + 0.5) / 높이)이다.
+//-----------------------------------------------------------------------------
+static VOID SampleLevel(const SW_STAGESTATE* pStage, const CSwTexture* pTex, UINT nLevel, DWORD dwFilter,
+	float u, float v, float* pOut)
+{
+	const INT nWidth = (INT)pTex->GetWidth(nLevel);
+	const INT nHeight = (INT)pTex->GetHeight(nLevel);
+	SW_TEXELFETCH fetch = { pTex, (const BYTE*)pTex->GetBits(nLevel), pTex->GetPitch(nLevel), pTex->GetBlockSize(), NULL, NULL };
+
+	if (dwFilter == D3DTEXF_LINEAR || dwFilter == D3DTEXF_ANISOTROPIC)
+	{
+		float fu = u * nWidth - 0.5f;
+		float fv = v * nHeight - 0.5f;
+		float fFloorU = floorf(fu), fFloorV = floorf(fv);
+		float fracU = fu - fFloorU, fracV = fv - fFloorV;
+		INT x0 = (INT)fFloorU, y0 = (INT)fFloorV;
+
+		INT xa = AddressTexel(x0, nWidth, pStage->dwAddressU);
+		INT xb = AddressTexel(x0 + 1, nWidth, pStage->dwAddressU);
+		INT ya = AddressTexel(y0, nHeight, pStage->dwAddressV);
+		INT yb = AddressTexel(y0 + 1, nHeight, pStage->dwAddressV);
+
+		float c00[4], c10[4], c01[4], c11[4];
+		SwUnpackColor(fetch(xa, ya), c00);
+		SwUnpackColor(fetch(xb, ya), c10);
+		SwUnpackColor(fetch(xa, yb), c01);
+		SwUnpackColor(fetch(xb, yb), c11);
+
+		for (int i = 0; i < 4; ++i)
+		{
+			float top = c00[i] + (c10[i] - c00[i]) * fracU;
+			float bottom = c01[i] + (c11[i] - c01[i]) * fracU;
+			pOut[i] = top + (bottom - top) * fracV;
+		}
+	}
+	else
+	{
+		INT x = AddressTexel((INT)floorf(u * nWidth), nWidth, pStage->dwAddressU);
+		INT y = AddressTexel((INT)floorf(v * nHeight), nHeight, pStage->dwAddressV);
+		SwUnpackColor(fetch(x, y), pOut);
+	}
+}
+
+// 레벨 0 텍셀 단위로 잰 화면 한 픽셀의 크기(가로, 세로 중 큰 쪽)의 log2
+static inline float ComputeLod(const CSwTexture* pTex, const float* pDeriv)
+{
+	const float fWidth = (float)pTex->GetWidth();
+	const float fHeight = (float)pTex->GetHeight();
+	const float dudx = pDeriv[0] * fWidth, dvdx = pDeriv[1] * fHeight;
+	const float dudy = pDeriv[2] * fWidth, dvdy = pDeriv[3] * fHeight;
+	const float fRhoX = dudx * dudx + dvdx * dvdx;
+	const float fRhoY = dudy * dudy + dvdy * dvdy;
+	return 0.5f * log2f(fRhoX > fRhoY ? fRhoX : fRhoY);
+}
+
+VOID SwSampleTexture(const SW_STAGESTATE* pStage, float u, float v, const float* pDeriv, float* pOut)
+{
+	const CSwTexture* pTex = pStage->pTexture;
+	if (pTex == NULL)
+	{
+		pOut[0] = pOut[1] = pOut[2] = pOut[3] = 1.0f;
+		return;
+	}
+
+	const float fLod = pDeriv ? ComputeLod(pTex, pDeriv) : 0.0f;
+	const UINT nLastLevel = pTex->GetLevelCount() - 1;
+
+	if (!(fLod > 0.0f))
+	{
+		// 확대(또는 미분이 없음)
+		SampleLevel(pStage, pTex, 0, pStage->dwMagFilter, u, v, pOut);
+	}
+	else if (pStage->dwMipFilter == D3DTEXF_NONE || nLastLevel == 0)
+	{
+		SampleLevel(pStage, pTex, 0, pStage->dwMinFilter, u, v, pOut);
+	}
+	else if (pStage->dwMipFilter == D3DTEXF_POINT)
+	{
+		const float fLevel = floorf(fLod + 0.5f);
+		const UINT nLevel = (fLevel < (float)nLastLevel) ? (UINT)fLevel : nLastLevel;
+		SampleLevel(pStage, pTex, nLevel, pStage->dwMinFilter, u, v, pOut);
+	}
+	else
+	{
+		// 이웃한 두 레벨 사이를 보간한다(삼선형).
+		const float fLevel = floorf(fLod);
+		if (fLevel >= (float)nLastLevel)
+		{
+			SampleLevel(pStage, pTex, nLastLevel, pStage->dwMinFilter, u, v, pOut);
+		}
+		else
+		{
+			const UINT nLevel = (UINT)fLevel;
+			const float fFrac = fLod - fLevel;
+			float c0[4], c1[4];
+			SampleLevel(pStage, pTex, nLevel, pStage->dwMinFilter, u, v, c0);
+			SampleLevel(pStage, pTex, nLevel + 1, pStage->dwMinFilter, u, v, c1);
+			for (int i = 0; i < 4; ++i)
+				pOut[i] = c0[i] + (c1[i] - c0[i]) * fFrac;
+		}
+	}
+
+	if (pTex->GetFormat() == D3DFMT_X8R8G8B8)
+		pOut[3] = 1.0f;
+}
+
+//-----------------------------------------------------------------------------
+// 텍스처 스테이지 연산
+//-----------------------------------------------------------------------------
+static inline VOID SelectArg(DWORD dwArg, const float* pDiffuse, const float* pCurrent,
+	const float* pTexture, const float* pFactor, float* pOut)
+{
+	const float* pSrc;
+	switch (dwArg & D3DTA_SELECTMASK)
+	{
+	case D3DTA_CURRENT:	pSrc = pCurrent;	break;
+	case D3DTA_TEXTURE:	pSrc = pTexture;	break;
+	case D3DTA_TFACTOR:	pSrc = pFactor;		break;
+	default:			pSrc = pDiffuse;	break;
+	}
+
+	for (int i = 0; i < 4; ++i)
+		pOut[i] = pSrc[i];
+
+	if (dwArg & D3DTA_COMPLEMENT)
+	{
+		for (int i = 0; i < 4; ++i)
+			pOut[i] = 1.0f - pOut[i];
+	}
+	if (dwArg & D3DTA_ALPHAREPLICATE)
+		pOut[0] = pOut[1] = pOut[2] = pOut[3];
+}
+
+DWORD SwShadePixel(const SW_DRAWSTATE* pState, const float* pDiffuse, const float (*pTexCoords)[2],
+	const float (*pTexDerivs)[4])
+{
+	float current[4] = { pDiffuse[0], pDiffuse[1], pDiffuse[2], pDiffuse[3] };
+	float factor[4];
+	SwUnpackColor(pState->dwTextureFactor, factor);
+
+	for (UINT s = 0; s < pState->nNumStages; ++s)
+	{
+		const SW_STAGESTATE& stage = pState->Stages[s];
+
+		float tex[4];
+		UINT nCoord = stage.dwTexCoordIndex & 0xffff;
+		if (nCoord >= SW_MAX_TEXCOORDS)
+			nCoord = SW_MAX_TEXCOORDS - 1;
+		SwSampleTexture(&stage, pTexCoords[nCoord][0], pTexCoords[nCoord][1],
+			pState->bUsesLod ? pTexDerivs[nCoord] : NULL, tex);
+
+		float c1[4], c2[4], a1[4], a2[4];
+		SelectArg(stage.dwColorArg1, pDiffuse, current, tex, factor, c1);
+		SelectArg(stage.dwColorArg2, pDiffuse, current, tex, factor, c2);
+
+		float result[4];
+		for (int i = 0; i < 3; ++i)
+			result[i] = SwApplyTextureOp(stage.dwColorOp, c1[i], c2[i], pDiffuse[3], tex[3]);
+
+		// 알파 연산이 꺼져 있으면 이전 단계의 알파를 그대로 넘긴다.
+		if (stage.dwAlphaOp == D3DTOP_DISABLE)
+		{
+			result[3] = current[3];
+		}
+		else
+		{
+			SelectArg(stage.dwAlphaArg1, pDiffuse, current, tex, factor, a1);
+			SelectArg(stage.dwAlphaArg2, pDiffuse, current, tex, factor, a2);
+			result[3] = SwApplyTextureOp(stage.dwAlphaOp, a1[3], a2[3], pDiffuse[3], tex[3]);
+		}
+
+		for (int i = 0; i < 4; ++i)
+			current[i] = result[i];
+	}
+
+	return SwPackColor(current);
+}
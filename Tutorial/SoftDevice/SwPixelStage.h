@@ -0,0 +1,79 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwPixelStage.h
+//
+// 설명:	고정 기능 픽셀 단계(텍스처 샘플링과 텍스처 스테이지 연산).
+//		SetTextureStageState()로 지정한 D3DTOP_* 연산을 스테이지 순서대로 수행한다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwPipeline.h"
+
+inline float SwSaturate(float f)
+{
+	return f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f);
+}
+
+// 유효한 스테이지 개수 등 드로우 상태에서 미리 계산할 수 있는 값을 채우고 조합기(SwCombiner.h)를 고른다.
+VOID	SwPrepareDrawState(SW_DRAWSTATE* pState);
+
+// 스테이지에 연결된 텍스처를 (u, v)에서 샘플링한다. 텍스처가 없으면 흰색이다.
+// pDeriv는 (du/dx, dv/dx, du/dy, dv/dy)이며 이것으로 확대/축소와 밉 레벨을 정한다.
+// NULL이면 레벨 0을 확대 필터로 샘플링한다.
+VOID	SwSampleTexture(const SW_STAGESTATE* pStage, float u, float v, const float* pDeriv, float* pOut);
+
+// 보간된 정점 색과 텍스처 좌표로 최종 픽셀 색(A8R8G8B8)을 계산한다.
+// 스테이지 상태를 픽셀마다 해석하는 기준 구현이다. 래스터라이저는 pState->Combiner.pfnShade를 쓴다.
+// pTexDerivs는 텍스처 좌표 집합마다의 화면 공간 미분이며 bUsesLod가 아니면 NULL이어도 된다.
+DWORD	SwShadePixel(const SW_DRAWSTATE* pState, const float* pDiffuse,
+			const float (*pTexCoords)[2], const float (*pTexDerivs)[4]);
+
+// 텍스처 스테이지 연산(D3DTOP_*) 하나를 채널 하나에 적용한다. 알 수 없는 연산은 SELECTARG1로 본다.
+// 조합기의 특수화 함수는 dwOp가 상수인 채로 인라인하므로 분기가 남지 않는다.
+inline float SwApplyTextureOp(DWORD dwOp, float a1, float a2, float fDiffuseAlpha, float fTextureAlpha)
+{
+	switch (dwOp)
+	{
+	case D3DTOP_SELECTARG1:			return a1;
+	case D3DTOP_SELECTARG2:			return a2;
+	case D3DTOP_MODULATE:			return a1 * a2;
+	case D3DTOP_MODULATE2X:			return SwSaturate(a1 * a2 * 2.0f);
+	case D3DTOP_MODULATE4X:			return SwSaturate(a1 * a2 * 4.0f);
+	case D3DTOP_ADD:				return SwSaturate(a1 + a2);
+	case D3DTOP_ADDSIGNED:			return SwSaturate(a1 + a2 - 0.5f);
+	case D3DTOP_ADDSIGNED2X:		return SwSaturate((a1 + a2 - 0.5f) * 2.0f);
+	case D3DTOP_SUBTRACT:			return SwSaturate(a1 - a2);
+	case D3DTOP_ADDSMOOTH:			return SwSaturate(a1 + a2 - a1 * a2);
+	case D3DTOP_BLENDDIFFUSEALPHA:	return a1 * fDiffuseAlpha + a2 * (1.0f - fDiffuseAlpha);
+	case D3DTOP_BLENDTEXTUREALPHA:	return a1 * fTextureAlpha + a2 * (1.0f - fTextureAlpha);
+	default:						return a1;
+	}
+}
+
+// 깊이 비교 함수(D3DCMP_*)
+inline bool SwDepthTest(DWORD dwFunc, float fZ, float fDepth)
+{
+	switch (dwFunc)
+	{
+	case D3DCMP_NEVER:			return false;
+	case D3DCMP_LESS:			return fZ < fDepth;
+	case D3DCMP_EQUAL:			return fZ == fDepth;
+	case D3DCMP_LESSEQUAL:		return fZ <= fDepth;
+	case D3DCMP_GREATER:		return fZ > fDepth;
+	case D3DCMP_NOTEQUAL:		return fZ != fDepth;
+	case D3DCMP_GREATEREQUAL:	return fZ >= fDepth;
+	default:					return true;
+	}
+}
+
+// 보간 오차로 범위를 조금 벗어난 값도 있으므로 [0, 1]로 자른 다음 8비트로 바꾼다.
+inline DWORD SwPackChannel(float f)
+{
+	f = f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f);
+	return (DWORD)(f * 255.0f + 0.5f);
+}
+
+inline DWORD SwPackColor(const float* pColor)
+{
+	return (SwPackChannel(pColor[3]) << 24) | (SwPackChannel(pColor[0]) << 16) |
+		(SwPackChannel(pColor[1]) << 8) | SwPackChannel(pColor[2]);
+}
@@ -0,0 +1,549 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwRasterizer.cpp
+//
+// 설명:	삼각형 클리핑, 설정, 래스터화 구현.
+//-----------------------------------------------------------------------------
+#include "SwRasterizer.h"
+#include "SwEdgeKernel.h"
+#include "SwHiZ.h"
+#include "SwPixelStage.h"
+
+#include <cmath>
+
+// 가드 밴드: 화면 크기의 이 배수를 넘는 좌표만 실제로 클리핑한다.
+#define SW_GUARDBAND		8.0f
+
+// 정점 좌표의 서브픽셀 정밀도(1/16 픽셀)
+#define SW_SUBPIXEL_SCALE	16.0f
+
+//-----------------------------------------------------------------------------
+// 클리핑
+// 클립 공간의 평면 dot(P, (x, y, z, w)) >= 0 에 대해 Sutherland-Hodgman 방식으로 자른다.
+//-----------------------------------------------------------------------------
+struct CLIPPLANE
+{
+	float a, b, c, d;
+};
+
+static const CLIPPLANE s_GuardPlanes[6] =
+{
+	{  0.0f,  0.0f,  1.0f, 0.0f },				// near: z >= 0
+	{  0.0f,  0.0f, -1.0f, 1.0f },				// far:  z <= w
+	{  1.0f,  0.0f,  0.0f, SW_GUARDBAND },		// left
+	{ -1.0f,  0.0f,  0.0f, SW_GUARDBAND },		// right
+	{  0.0f,  1.0f,  0.0f, SW_GUARDBAND },		// bottom
+	{  0.0f, -1.0f,  0.0f, SW_GUARDBAND },		// top
+};
+
+static inline float PlaneDistance(const CLIPPLANE& p, const SW_VERTEX& v)
+{
+	return p.a * v.x + p.b * v.y + p.c * v.z + p.d * v.w;
+}
+
+static inline VOID LerpVertex(const SW_VERTEX& a, const SW_VERTEX& b, float t, SW_VERTEX* pOut)
+{
+	const float* pA = &a.x;
+	const float* pB = &b.x;
+	float* pDst = &pOut->x;
+	const UINT nFloats = sizeof(SW_VERTEX) / sizeof(float);
+	for (UINT i = 0; i < nFloats; ++i)
+		pDst[i] = pA[i] + (pB[i] - pA[i]) * t;
+}
+
+// 시야 절두체의 한 평면 밖에 세 정점이 모두 있으면 보이지 않는다.
+static bool IsTriviallyRejected(const SW_VERTEX* pV[3])
+{
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		int nBelow = 0, nAbove = 0;
+		for (int i = 0; i < 3; ++i)
+		{
+			float c = (&pV[i]->x)[axis];
+			float w = pV[i]->w;
+			if (axis < 2 ? c < -w : c < 0.0f)
+				++nBelow;
+			if (c > w)
+				++nAbove;
+		}
+		if (nBelow == 3 || nAbove == 3)
+			return true;
+	}
+	return false;
+}
+
+// 가드 밴드 안쪽에 있는가
+static bool IsInsideGuardBand(const SW_VERTEX* pV[3])
+{
+	for (int i = 0; i < 3; ++i)
+	{
+		for (int p = 0; p < 6; ++p)
+		{
+			if (PlaneDistance(s_GuardPlanes[p], *pV[i]) < 0.0f)
+				return false;
+		}
+	}
+	return true;
+}
+
+// 다각형을 모든 가드 평면으로 자른다. 결과 정점 수를 돌려준다.
+static UINT ClipPolygon(SW_VERTEX* pPoly, UINT nCount, SW_VERTEX* pTemp)
+{
+	SW_VERTEX* pIn = pPoly;
+	SW_VERTEX* pOut = pTemp;
+
+	for (int p = 0; p < 6 && nCount >= 3; ++p)
+	{
+		const CLIPPLANE& plane = s_GuardPlanes[p];
+		UINT nOut = 0;
+		for (UINT i = 0; i < nCount; ++i)
+		{
+			const SW_VERTEX& a = pIn[i];
+			const SW_VERTEX& b = pIn[(i + 1) % nCount];
+			float da = PlaneDistance(plane, a);
+			float db = PlaneDistance(plane, b);
+
+			if (da >= 0.0f)
+				pOut[nOut++] = a;
+			if ((da >= 0.0f) != (db >= 0.0f))
+				LerpVertex(a, b, da / (da - db), &pOut[nOut++]);
+		}
+
+		SW_VERTEX* pSwap = pIn;
+		pIn = pOut;
+		pOut = pSwap;
+		nCount = nOut;
+	}
+
+	if (pIn != pPoly)
+	{
+		for (UINT i = 0; i < nCount; ++i)
+			pPoly[i] = pIn[i];
+	}
+	return nCount;
+}
+
+//-----------------------------------------------------------------------------
+// 삼각형 설정
+//-----------------------------------------------------------------------------
+struct SCREENVERTEX
+{
+	float	x, y, z, rhw;
+	float	attr[SW_NUM_PLANES - SW_PLANE_COLOR];	// 속성 * rhw
+};
+
+static inline float SnapToSubpixel(float f)
+{
+	return floorf(f * SW_SUBPIXEL_SCALE + 0.5f) * (1.0f / SW_SUBPIXEL_SCALE);
+}
+
+static VOID ToScreen(const SW_VERTEX& v, BOOL bTransformed, float fHalfW, float fHalfH, SCREENVERTEX* pOut)
+{
+	const float rhw = 1.0f / v.w;
+	if (bTransformed)
+	{
+		pOut->x = SnapToSubpixel(v.x);
+		pOut->y = SnapToSubpixel(v.y);
+		pOut->z = v.z;
+	}
+	else
+	{
+		pOut->x = SnapToSubpixel((v.x * rhw + 1.0f) * fHalfW);
+		pOut->y = SnapToSubpixel((1.0f - v.y * rhw) * fHalfH);
+		pOut->z = v.z * rhw;
+	}
+	pOut->rhw = rhw;
+
+	float* pAttr = pOut->attr;
+	for (int i = 0; i < 4; ++i)
+		*pAttr++ = v.color[i] * rhw;
+	for (int t = 0; t < SW_MAX_TEXCOORDS; ++t)
+	{
+		*pAttr++ = v.tex[t][0] * rhw;
+		*pAttr++ = v.tex[t][1] * rhw;
+	}
+}
+
+// 점 a가 b보다 앞서는가(y 우선, 그 다음 x). 공유 변의 기준점을 정하는 데 쓴다.
+static inline bool IsBefore(const SCREENVERTEX& a, const SCREENVERTEX& b)
+{
+	return (a.y < b.y) || (a.y == b.y && a.x < b.x);
+}
+
+static bool SetupScreenTriangle(const SCREENVERTEX* s0, const SCREENVERTEX* s1, const SCREENVERTEX* s2,
+	DWORD dwCullMode, UINT nWidth, UINT nHeight, const SW_DRAWSTATE* pState, SW_TRIANGLE* pTri)
+{
+	float fArea = (s1->x - s0->x) * (s2->y - s0->y) - (s2->x - s0->x) * (s1->y - s0->y);
+	if (!(fArea != 0.0f))
+		return false;
+
+	// 화면 좌표계(y 아래 방향)에서 fArea > 0 이면 시계 방향이다.
+	if (dwCullMode == D3DCULL_CCW && fArea < 0.0f)
+		return false;
+	if (dwCullMode == D3DCULL_CW && fArea > 0.0f)
+		return false;
+
+	// 항상 시계 방향이 되도록 정렬한다.
+	if (fArea < 0.0f)
+	{
+		const SCREENVERTEX* t = s1;
+		s1 = s2;
+		s2 = t;
+		fArea = -fArea;
+	}
+
+	// 경계 사각형(픽셀 중심이 정수 좌표이므로 ceil/floor)
+	float fMinX = fminf(s0->x, fminf(s1->x, s2->x));
+	float fMaxX = fmaxf(s0->x, fmaxf(s1->x, s2->x));
+	float fMinY = fminf(s0->y, fminf(s1->y, s2->y));
+	float fMaxY = fmaxf(s0->y, fmaxf(s1->y, s2->y));
+
+	pTri->nMinX = (INT)fmaxf(ceilf(fMinX), 0.0f);
+	pTri->nMinY = (INT)fmaxf(ceilf(fMinY), 0.0f);
+	pTri->nMaxX = (INT)fminf(floorf(fMaxX) + 1.0f, (float)nWidth);
+	pTri->nMaxY = (INT)fminf(floorf(fMaxY) + 1.0f, (float)nHeight);
+	if (pTri->nMinX >= pTri->nMaxX || pTri->nMinY >= pTri->nMaxY)
+		return false;
+
+	// 변 함수
+	const SCREENVERTEX* v[3] = { s0, s1, s2 };
+	for (int i = 0; i < 3; ++i)
+	{
+		const SCREENVERTEX* a = v[i];
+		const SCREENVERTEX* b = v[(i + 1) % 3];
+		float A = a->y - b->y;
+		float B = b->x - a->x;
+		const SCREENVERTEX* pBase = IsBefore(*a, *b) ? a : b;
+
+		pTri->fEdgeA[i] = A;
+		pTri->fEdgeB[i] = B;
+		pTri->fEdgeX[i] = pBase->x;
+		pTri->fEdgeY[i] = pBase->y;
+		pTri->bTopLeft[i] = (A > 0.0f) || (A == 0.0f && B > 0.0f);
+	}
+
+	// 보간 평면
+	float dx1 = s1->x - s0->x, dy1 = s1->y - s0->y;
+	float dx2 = s2->x - s0->x, dy2 = s2->y - s0->y;
+	float fInvArea = 1.0f / fArea;
+
+	pTri->fX0 = s0->x;
+	pTri->fY0 = s0->y;
+
+	float f0[SW_NUM_PLANES], f1[SW_NUM_PLANES], f2[SW_NUM_PLANES];
+	f0[SW_PLANE_Z] = s0->z;		f1[SW_PLANE_Z] = s1->z;		f2[SW_PLANE_Z] = s2->z;
+	f0[SW_PLANE_RHW] = s0->rhw;	f1[SW_PLANE_RHW] = s1->rhw;	f2[SW_PLANE_RHW] = s2->rhw;
+	for (int i = SW_PLANE_COLOR; i < SW_NUM_PLANES; ++i)
+	{
+		f0[i] = s0->attr[i - SW_PLANE_COLOR];
+		f1[i] = s1->attr[i - SW_PLANE_COLOR];
+		f2[i] = s2->attr[i - SW_PLANE_COLOR];
+	}
+
+	for (int i = 0; i < SW_NUM_PLANES; ++i)
+	{
+		float df1 = f1[i] - f0[i];
+		float df2 = f2[i] - f0[i];
+		pTri->Planes[i][0] = f0[i];
+		pTri->Planes[i][1] = (df1 * dy2 - df2 * dy1) * fInvArea;
+		pTri->Planes[i][2] = (df2 * dx1 - df1 * dx2) * fInvArea;
+	}
+
+	pTri->pState = pState;
+	return true;
+}
+
+UINT SwSetupTriangle(const SW_VERTEX* pV0, const SW_VERTEX* pV1, const SW_VERTEX* pV2,
+	BOOL bTransformed, DWORD dwCullMode, UINT nWidth, UINT nHeight,
+	const SW_DRAWSTATE* pState, SW_TRIANGLE* pOut)
+{
+	const float fHalfW = nWidth * 0.5f;
+	const float fHalfH = nHeight * 0.5f;
+
+	if (bTransformed)
+	{
+		SCREENVERTEX s[3];
+		ToScreen(*pV0, TRUE, fHalfW, fHalfH, &s[0]);
+		ToScreen(*pV1, TRUE, fHalfW, fHalfH, &s[1]);
+		ToScreen(*pV2, TRUE, fHalfW, fHalfH, &s[2]);
+		return SetupScreenTriangle(&s[0], &s[1], &s[2], dwCullMode, nWidth, nHeight, pState, pOut) ? 1 : 0;
+	}
+
+	const SW_VERTEX* pV[3] = { pV0, pV1, pV2 };
+	if (IsTriviallyRejected(pV))
+		return 0;
+
+	if (IsInsideGuardBand(pV))
+	{
+		SCREENVERTEX s[3];
+		for (int i = 0; i < 3; ++i)
+			ToScreen(*pV[i], FALSE, fHalfW, fHalfH, &s[i]);
+		return SetupScreenTriangle(&s[0], &s[1], &s[2], dwCullMode, nWidth, nHeight, pState, pOut) ? 1 : 0;
+	}
+
+	// 평면 하나마다 정점이 최대 1개 늘어난다.
+	SW_VERTEX poly[3 + 6], temp[3 + 6];
+	poly[0] = *pV0;
+	poly[1] = *pV1;
+	poly[2] = *pV2;
+	UINT nCount = ClipPolygon(poly, 3, temp);
+	if (nCount < 3)
+		return 0;
+
+	SCREENVERTEX s[3 + 6];
+	for (UINT i = 0; i < nCount; ++i)
+		ToScreen(poly[i], FALSE, fHalfW, fHalfH, &s[i]);
+
+	// 볼록 다각형을 부채꼴(fan)로 나눈다.
+	UINT nOut = 0;
+	for (UINT i = 1; i + 1 < nCount && nOut < SW_MAX_CLIPPED_TRIANGLES; ++i)
+	{
+		if (SetupScreenTriangle(&s[0], &s[i], &s[i + 1], dwCullMode, nWidth, nHeight, pState, &pOut[nOut]))
+			++nOut;
+	}
+	return nOut;
+}
+
+//-----------------------------------------------------------------------------
+// 래스터화
+// 화면에 정렬된 8x8 블록 단위로 진행한다. 변 함수는 x, y 각각에 대해 단조이므로
+// (float 곱셈, 덧셈의 반올림도 단조다) 블록 네 모서리 픽셀의 값만으로
+// 블록 전체가 안쪽인지(trivial accept), 바깥인지(trivial reject)를 픽셀 단위 판정과 똑같이 알 수 있다.
+// 걸쳐 있는 블록만 변 함수 커널로 픽셀별 마스크를 구한다.
+// 깊이도 같은 이유로 모서리 값의 범위가 픽셀 값의 범위와 같으므로 Hi-Z 판정은 픽셀 단위 깊이 테스트와 어긋나지 않는다.
+//-----------------------------------------------------------------------------
+enum BLOCKCLASS
+{
+	BLOCK_OUTSIDE,
+	BLOCK_INSIDE,
+	BLOCK_PARTIAL,
+};
+
+static BLOCKCLASS ClassifyBlock(const SW_TRIANGLE* pTri, float fX0, float fY0, float fX1, float fY1)
+{
+	bool bAllInside = true;
+	for (int e = 0; e < 3; ++e)
+	{
+		float E00 = SwEvalEdge(pTri, e, fX0, fY0);
+		float E10 = SwEvalEdge(pTri, e, fX1, fY0);
+		float E01 = SwEvalEdge(pTri, e, fX0, fY1);
+		float E11 = SwEvalEdge(pTri, e, fX1, fY1);
+		float fMin = fminf(fminf(E00, E10), fminf(E01, E11));
+		float fMax = fmaxf(fmaxf(E00, E10), fmaxf(E01, E11));
+
+		if (!SwIsInsideEdge(pTri, e, fMax))
+			return BLOCK_OUTSIDE;
+		if (!SwIsInsideEdge(pTri, e, fMin))
+			bAllInside = false;
+	}
+	return bAllInside ? BLOCK_INSIDE : BLOCK_PARTIAL;
+}
+
+// 블록 안의 열 [c0, c1), 행 [r0, r1)에 해당하는 마스크
+static inline UINT64 RectMask(INT c0, INT r0, INT c1, INT r1)
+{
+	UINT64 nRow = ((1u << c1) - 1) & ~((1u << c0) - 1);
+	UINT64 nMask = 0;
+	for (INT r = r0; r < r1; ++r)
+		nMask |= nRow << (r * SW_BLOCK_SIZE);
+	return nMask;
+}
+
+// 픽셀 (x, y)의 깊이. 픽셀 처리와 Hi-Z 판정이 같은 식을 쓴다.
+static inline float EvalDepth(const SW_TRIANGLE* pTri, float px, float py)
+{
+	const float dx = px - pTri->fX0;
+	const float dy = py - pTri->fY0;
+	const float* pPlane = pTri->Planes[SW_PLANE_Z];
+	float z = pPlane[0] + pPlane[1] * dx + pPlane[2] * dy;
+	return z < 0.0f ? 0.0f : (z > 1.0f ? 1.0f : z);
+}
+
+// 사각형 [fX0, fX1] x [fY0, fY1] 안의 픽셀 깊이 범위
+static inline VOID GetDepthRange(const SW_TRIANGLE* pTri, float fX0, float fY0, float fX1, float fY1,
+	float* pMin, float* pMax)
+{
+	float z00 = EvalDepth(pTri, fX0, fY0);
+	float z10 = EvalDepth(pTri, fX1, fY0);
+	float z01 = EvalDepth(pTri, fX0, fY1);
+	float z11 = EvalDepth(pTri, fX1, fY1);
+	*pMin = fminf(fminf(z00, z10), fminf(z01, z11));
+	*pMax = fmaxf(fmaxf(z00, z10), fmaxf(z01, z11));
+}
+
+// 사각형 [nMinX, nMaxX) x [nMinY, nMaxY)와 겹치는 모든 Hi-Z 블록에서 삼각형이 가려지는가
+static bool IsOccludedByHiZ(const SW_TRIANGLE* pTri, const SW_RENDERTARGET* pRT, DWORD dwZFunc,
+	INT nMinX, INT nMinY, INT nMaxX, INT nMaxY)
+{
+	float fZMin, fZMax;
+	GetDepthRange(pTri, (float)nMinX, (float)nMinY, (float)(nMaxX - 1), (float)(nMaxY - 1), &fZMin, &fZMax);
+
+	for (INT by = nMinY / SW_BLOCK_SIZE; by <= (nMaxY - 1) / SW_BLOCK_SIZE; ++by)
+	{
+		const SW_HIZBLOCK* pRow = pRT->pHiZ + (size_t)by * pRT->nHiZPitch;
+		for (INT bx = nMinX / SW_BLOCK_SIZE; bx <= (nMaxX - 1) / SW_BLOCK_SIZE; ++bx)
+		{
+			if (!SwHiZRejects(dwZFunc, fZMin, fZMax, &pRow[bx]))
+				return false;
+		}
+	}
+	return true;
+}
+
+// 포함된 픽셀 하나의 깊이 테스트, 보간, 셰이딩. 텍스처 좌표는 앞의 NUM_TEXCOORDS 집합만 보간한다.
+template<int NUM_TEXCOORDS>
+static inline bool ShadePixel(const SW_TRIANGLE* pTri, const SW_DRAWSTATE* pState,
+	bool bDepth, bool bDepthWrite, INT x, INT y, DWORD* pColor, float* pDepth)
+{
+	const float dx = (float)x - pTri->fX0;
+	const float dy = (float)y - pTri->fY0;
+	const float (*P)[3] = pTri->Planes;
+
+	const float z = EvalDepth(pTri, (float)x, (float)y);
+	if (bDepth)
+	{
+		if (!SwDepthTest(pState->dwZFunc, z, *pDepth))
+			return false;
+		if (bDepthWrite)
+			*pDepth = z;
+	}
+
+	// 원근 보정: 속성 * rhw 를 보간한 뒤 보간된 rhw로 나눈다.
+	float rhw = P[SW_PLANE_RHW][0] + P[SW_PLANE_RHW][1] * dx + P[SW_PLANE_RHW][2] * dy;
+	float w = 1.0f / rhw;
+
+	float color[4];
+	for (int i = 0; i < 4; ++i)
+	{
+		const float* pPlane = P[SW_PLANE_COLOR + i];
+		color[i] = (pPlane[0] + pPlane[1] * dx + pPlane[2] * dy) * w;
+	}
+
+	float tex[SW_MAX_TEXCOORDS][2] = {};
+	for (int i = 0; i < NUM_TEXCOORDS * 2; ++i)
+	{
+		const float* pPlane = P[SW_PLANE_TEX + i];
+		tex[i / 2][i % 2] = (pPlane[0] + pPlane[1] * dx + pPlane[2] * dy) * w;
+	}
+
+	// 밉 레벨 선택용 화면 공간 미분. t = T / rhw 이므로 dt/dx = (dT/dx - t * drhw/dx) / rhw 이다.
+	float deriv[SW_MAX_TEXCOORDS][4];
+	if (pState->bUsesLod)
+	{
+		for (int i = 0; i < NUM_TEXCOORDS * 2; ++i)
+		{
+			const float* pPlane = P[SW_PLANE_TEX + i];
+			const float t = tex[i / 2][i % 2];
+			deriv[i / 2][i % 2] = (pPlane[1] - t * P[SW_PLANE_RHW][1]) * w;
+			deriv[i / 2][2 + i % 2] = (pPlane[2] - t * P[SW_PLANE_RHW][2]) * w;
+		}
+	}
+
+	*pColor = pState->Combiner.pfnShade(pState, color, tex, deriv);
+	return true;
+}
+
+template<int NUM_TEXCOORDS>
+static VOID RasterizeTriangle(const SW_TRIANGLE* pTri, const SW_RENDERTARGET* pRT,
+	INT x0, INT y0, INT x1, INT y1, SW_RASTERSTATS* pStats)
+{
+	INT nMinX = pTri->nMinX > x0 ? pTri->nMinX : x0;
+	INT nMinY = pTri->nMinY > y0 ? pTri->nMinY : y0;
+	INT nMaxX = pTri->nMaxX < x1 ? pTri->nMaxX : x1;
+	INT nMaxY = pTri->nMaxY < y1 ? pTri->nMaxY : y1;
+	if (nMinX >= nMaxX || nMinY >= nMaxY)
+		return;
+
+	const SW_DRAWSTATE* pState = pTri->pState;
+	const bool bDepth = pState->bZEnable && pRT->pDepth != NULL;
+	const bool bDepthWrite = bDepth && pState->bZWriteEnable;
+	const bool bHiZ = bDepth && pRT->pHiZ != NULL && SwHiZSupportsFunc(pState->dwZFunc);
+	const SW_EDGEKERNELFUNC pfnKernel = g_pfnSwEdgeKernel;
+
+	// 이 사각형 안에서 삼각형 전체가 가려졌으면 블록을 나눌 필요도 없다.
+	if (bHiZ && IsOccludedByHiZ(pTri, pRT, pState->dwZFunc, nMinX, nMinY, nMaxX, nMaxY))
+	{
+		pStats->nHiZTrianglesCulled += 1;
+		return;
+	}
+
+	UINT64 nShaded = 0;
+	UINT64 nBlocksCulled = 0;
+	for (INT by = nMinY & ~(SW_BLOCK_SIZE - 1); by < nMaxY; by += SW_BLOCK_SIZE)
+	{
+		const INT r0 = nMinY > by ? nMinY - by : 0;
+		const INT r1 = nMaxY < by + SW_BLOCK_SIZE ? nMaxY - by : SW_BLOCK_SIZE;
+
+		for (INT bx = nMinX & ~(SW_BLOCK_SIZE - 1); bx < nMaxX; bx += SW_BLOCK_SIZE)
+		{
+			const INT c0 = nMinX > bx ? nMinX - bx : 0;
+			const INT c1 = nMaxX < bx + SW_BLOCK_SIZE ? nMaxX - bx : SW_BLOCK_SIZE;
+
+			const float fX0 = (float)(bx + c0), fY0 = (float)(by + r0);
+			const float fX1 = (float)(bx + c1 - 1), fY1 = (float)(by + r1 - 1);
+			const BLOCKCLASS eClass = ClassifyBlock(pTri, fX0, fY0, fX1, fY1);
+			if (eClass == BLOCK_OUTSIDE)
+				continue;
+
+			if (bHiZ)
+			{
+				const SW_HIZBLOCK* pHiZBlock = &pRT->pHiZ[(size_t)(by / SW_BLOCK_SIZE) * pRT->nHiZPitch + bx / SW_BLOCK_SIZE];
+				float fZMin, fZMax;
+				GetDepthRange(pTri, fX0, fY0, fX1, fY1, &fZMin, &fZMax);
+				if (SwHiZRejects(pState->dwZFunc, fZMin, fZMax, pHiZBlock))
+				{
+					++nBlocksCulled;
+					continue;
+				}
+			}
+
+			UINT64 nMask;
+			switch (eClass)
+			{
+			case BLOCK_INSIDE:
+				nMask = RectMask(c0, r0, c1, r1);
+				break;
+			default:
+				nMask = pfnKernel(pTri, bx, by) & RectMask(c0, r0, c1, r1);
+				break;
+			}
+
+			bool bDepthWritten = false;
+			while (nMask)
+			{
+				const UINT nBit = SwBitScanForward64(nMask);
+				nMask &= nMask - 1;
+
+				const INT x = bx + (INT)(nBit % SW_BLOCK_SIZE);
+				const INT y = by + (INT)(nBit / SW_BLOCK_SIZE);
+				const size_t nOffset = (size_t)y * pRT->nWidth + x;
+				if (ShadePixel<NUM_TEXCOORDS>(pTri, pState, bDepth, bDepthWrite, x, y,
+					pRT->pColor + nOffset, bDepth ? pRT->pDepth + nOffset : NULL))
+				{
+					++nShaded;
+					bDepthWritten = bDepthWrite;
+				}
+			}
+
+			// 깊이를 기록한 블록은 바로 범위를 다시 계산한다.
+			if (bDepthWritten && pRT->pHiZ != NULL)
+				SwUpdateHiZBlock(pRT, (UINT)bx / SW_BLOCK_SIZE, (UINT)by / SW_BLOCK_SIZE);
+		}
+	}
+
+	pStats->nPixelsShaded += nShaded;
+	pStats->nHiZBlocksCulled += nBlocksCulled;
+}
+
+VOID SwRasterizeTriangle(const SW_TRIANGLE* pTri, const SW_RENDERTARGET* pRT,
+	INT x0, INT y0, INT x1, INT y1, SW_RASTERSTATS* pStats)
+{
+	// 보간할 텍스처 좌표 집합의 개수(정점 FVF가 정한다)마다 따로 인스턴스화한 루프를 쓴다.
+	static_assert(SW_MAX_TEXCOORDS == 2, "텍스처 좌표 집합 개수별 분기를 고쳐야 한다");
+	const SW_DRAWSTATE* pState = pTri->pState;
+	switch (pState->bUsesTexCoords ? pState->nNumTexCoords : 0)
+	{
+	case 0:		RasterizeTriangle<0>(pTri, pRT, x0, y0, x1, y1, pStats);	break;
+	case 1:		RasterizeTriangle<1>(pTri, pRT, x0, y0, x1, y1, pStats);	break;
+	default:	RasterizeTriangle<2>(pTri, pRT, x0, y0, x1, y1, pStats);	break;
+	}
+}
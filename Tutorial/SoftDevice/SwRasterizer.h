@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwRasterizer.h
+//
+// 설명:	삼각형 클리핑, 설정(setup), 래스터화.
+//		정점 좌표는 1/16 픽셀 단위로 맞춘 다음 변 함수(edge function)로 픽셀 포함 여부를 판정한다.
+//		공유되는 변은 항상 같은 끝점을 기준으로 계산하고 top-left 규칙을 적용하므로
+//		이웃한 삼각형 사이에 빈틈이나 겹쳐 그려지는 픽셀이 없다.
+//		픽셀 중심은 D3D9 규약대로 정수 좌표에 있다.
+//		래스터화는 8x8 블록 단위이며 걸쳐 있는 블록만 SIMD 변 함수 커널(SwEdgeKernel.h)로 계산한다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwPipeline.h"
+
+// 보간 평면의 순서
+#define SW_PLANE_Z			0
+#define SW_PLANE_RHW		1
+#define SW_PLANE_COLOR		2		// 4개(r, g, b, a) * rhw
+#define SW_PLANE_TEX		6		// SW_MAX_TEXCOORDS * 2개(u, v) * rhw
+#define SW_NUM_PLANES		(SW_PLANE_TEX + SW_MAX_TEXCOORDS * 2)
+
+// 클리핑 한 번으로 삼각형 하나가 나뉠 수 있는 최대 개수
+#define SW_MAX_CLIPPED_TRIANGLES	8
+
+//-----------------------------------------------------------------------------
+// 설정이 끝난 삼각형
+// 변 함수 E(x, y) = A * (x - X) + B * (y - Y)가 세 변 모두 0 이상이면 삼각형 안쪽이다.
+// 속성 f(x, y) = f0 + dfdx * (x - x0) + dfdy * (y - y0)
+//-----------------------------------------------------------------------------
+struct SW_TRIANGLE
+{
+	const SW_DRAWSTATE*	pState;
+
+	INT		nMinX, nMinY;				// 화면과 겹치는 경계 사각형 [Min, Max)
+	INT		nMaxX, nMaxY;
+
+	float	fEdgeA[3];
+	float	fEdgeB[3];
+	float	fEdgeX[3];					// 변 함수의 기준점
+	float	fEdgeY[3];
+	BOOL	bTopLeft[3];				// E == 0인 픽셀을 포함하는 변인가
+
+	float	fX0, fY0;					// 보간 평면의 기준점(첫 번째 정점)
+	float	Planes[SW_NUM_PLANES][3];	// f0, dfdx, dfdy
+};
+
+//-----------------------------------------------------------------------------
+// 래스터화 통계
+//-----------------------------------------------------------------------------
+struct SW_RASTERSTATS
+{
+	UINT64	nPixelsShaded;
+	UINT64	nHiZTrianglesCulled;
+	UINT64	nHiZBlocksCulled;
+};
+
+// 정점 단계에서 나온 삼각형 하나를 클리핑, 컬링하고 설정한다.
+// 만들어진 삼각형 수(0 ~ SW_MAX_CLIPPED_TRIANGLES)를 돌려준다.
+UINT	SwSetupTriangle(const SW_VERTEX* pV0, const SW_VERTEX* pV1, const SW_VERTEX* pV2,
+			BOOL bTransformed, DWORD dwCullMode, UINT nWidth, UINT nHeight,
+			const SW_DRAWSTATE* pState, SW_TRIANGLE* pOut);
+
+// 삼각형 중 사각형 [x0, x1) x [y0, y1)에 속한 픽셀만 그린다.
+VOID	SwRasterizeTriangle(const SW_TRIANGLE* pTri, const SW_RENDERTARGET* pRT,
+			INT x0, INT y0, INT x1, INT y1, SW_RASTERSTATS* pStats);
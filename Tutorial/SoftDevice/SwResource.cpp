@@ -0,0 +1,168 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwResource.cpp
+//
+// 설명:	정점 버퍼, 인덱스 버퍼, 텍스처 구현.
+//-----------------------------------------------------------------------------
+#include "SwResource.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// CSwResource
+//-----------------------------------------------------------------------------
+// 내용 식별 값. 0은 쓰지 않는다.
+static std::atomic<UINT64> s_nNextContentId(1);
+
+CSwResource::CSwResource()
+	: m_nRef(1)
+	, m_nContentId(s_nNextContentId++)
+{
+}
+
+VOID CSwResource::Touch()
+{
+	m_nContentId = s_nNextContentId++;
+}
+
+UINT CSwResource::AddRef()
+{
+	return ++m_nRef;
+}
+
+UINT CSwResource::Release()
+{
+	UINT nRef = --m_nRef;
+	if (nRef == 0)
+		delete this;
+	return nRef;
+}
+
+//-----------------------------------------------------------------------------
+// CSwVertexBuffer
+//-----------------------------------------------------------------------------
+CSwVertexBuffer::CSwVertexBuffer(UINT Length, DWORD FVF)
+	: m_Data(Length)
+	, m_dwFVF(FVF)
+	, m_nDirtyBegin(Length)
+	, m_nDirtyEnd(0)
+{
+	if (FVF != 0)
+		m_Streams.Create(FVF, Length / SwGetFVFVertexSize(FVF));
+}
+
+HRESULT CSwVertexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD)
+{
+	if (ppbData == NULL || OffsetToLock > m_Data.size() ||
+		(SizeToLock != 0 && OffsetToLock + SizeToLock > m_Data.size()))
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	*ppbData = m_Data.data() + OffsetToLock;
+	m_nDirtyBegin = std::min(m_nDirtyBegin, OffsetToLock);
+	m_nDirtyEnd = std::max(m_nDirtyEnd, SizeToLock ? OffsetToLock + SizeToLock : (UINT)m_Data.size());
+	return S_OK;
+}
+
+HRESULT CSwVertexBuffer::Unlock()
+{
+	if (m_nDirtyBegin < m_nDirtyEnd && m_Streams.Get())
+	{
+		const UINT nStride = SwGetFVFVertexSize(m_dwFVF);
+		const UINT nFirst = m_nDirtyBegin / nStride;
+		const UINT nLast = (m_nDirtyEnd + nStride - 1) / nStride;
+		m_Streams.Update(m_Data.data(), nFirst, nLast - nFirst);
+	}
+	m_nDirtyBegin = (UINT)m_Data.size();
+	m_nDirtyEnd = 0;
+	Touch();
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// CSwIndexBuffer
+//-----------------------------------------------------------------------------
+CSwIndexBuffer::CSwIndexBuffer(UINT Length, D3DFORMAT Format)
+	: m_Data(Length)
+	, m_Format(Format)
+{
+}
+
+HRESULT CSwIndexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD)
+{
+	if (ppbData == NULL || OffsetToLock > m_Data.size() ||
+		(SizeToLock != 0 && OffsetToLock + SizeToLock > m_Data.size()))
+	{
+		return D3DERR_INVALIDCALL;
+	}
+
+	*ppbData = m_Data.data() + OffsetToLock;
+	return S_OK;
+}
+
+HRESULT CSwIndexBuffer::Unlock()
+{
+	Touch();
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// CSwTexture
+//-----------------------------------------------------------------------------
+CSwTexture::CSwTexture(UINT Width, UINT Height, UINT Levels, D3DFORMAT Format)
+	: m_Format(Format)
+{
+	switch (Format)
+	{
+	case D3DFMT_DXT1:	m_nBlockSize = 8;	break;
+	case D3DFMT_DXT5:	m_nBlockSize = 16;	break;
+	default:			m_nBlockSize = 0;	break;
+	}
+
+	size_t nOffset = 0;
+	UINT w = Width, h = Height;
+	for (;;)
+	{
+		LEVEL level;
+		level.nWidth = w;
+		level.nHeight = h;
+		level.nOffset = nOffset;
+		if (m_nBlockSize != 0)
+		{
+			level.nPitch = (INT)(((w + 3) / 4) * m_nBlockSize);
+			nOffset += (size_t)level.nPitch * ((h + 3) / 4) / sizeof(DWORD);
+		}
+		else
+		{
+			level.nPitch = (INT)(w * sizeof(DWORD));
+			nOffset += (size_t)w * h;
+		}
+		m_Levels.push_back(level);
+
+		if ((Levels != 0 && m_Levels.size() == Levels) || (w == 1 && h == 1))
+			break;
+		w = (w > 1) ? w / 2 : 1;
+		h = (h > 1) ? h / 2 : 1;
+	}
+
+	m_Texels.resize(nOffset);
+}
+
+HRESULT CSwTexture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const void*, DWORD)
+{
+	if (pLockedRect == NULL || Level >= m_Levels.size())
+		return D3DERR_INVALIDCALL;
+
+	pLockedRect->Pitch = m_Levels[Level].nPitch;
+	pLockedRect->pBits = m_Texels.data() + m_Levels[Level].nOffset;
+	return S_OK;
+}
+
+HRESULT CSwTexture::UnlockRect(UINT Level)
+{
+	if (Level >= m_Levels.size())
+		return D3DERR_INVALIDCALL;
+
+	Touch();
+	return S_OK;
+}
@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwResource.h
+//
+// 설명:	소프트웨어 디바이스의 자원(정점 버퍼, 인덱스 버퍼, 텍스처).
+//		IDirect3DVertexBuffer9 등과 같은 이름의 메서드(Lock, Unlock, Release)를 제공하므로
+//		예제의 InitVB(), InitIB() 코드를 거의 그대로 사용할 수 있다.
+//		모든 자원은 시스템 메모리에 만들어지며 D3DPOOL 값은 무시된다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+#include "SwVertexStream.h"
+
+#include <atomic>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// 참조 카운트를 갖는 자원의 기반 클래스
+//-----------------------------------------------------------------------------
+class CSwResource
+{
+public:
+	UINT	AddRef();
+	UINT	Release();
+
+	// 내용을 식별하는 값. 자원을 만들 때와 Unlock() 때마다 모든 자원에서 유일한 새 값이 된다.
+	// 풀어 둔 블록의 캐시나 캡처가 내용이 바뀌었는지 알아볼 때 쓴다.
+	UINT64	GetContentId() const { return m_nContentId; }
+
+protected:
+	CSwResource();
+	virtual ~CSwResource() {}
+
+	// 내용이 바뀌었음을 알린다.
+	VOID	Touch();
+
+private:
+	std::atomic<UINT>	m_nRef;
+	UINT64				m_nContentId;
+};
+
+//-----------------------------------------------------------------------------
+// 정점 버퍼
+// FVF를 주고 만든 버퍼는 SoA 사본(CSwVertexStreams)을 함께 갖는다. Lock()한 범위를 기억해 두었다가
+// Unlock()할 때 그 범위의 정점만 다시 옮긴다.
+//-----------------------------------------------------------------------------
+class CSwVertexBuffer : public CSwResource
+{
+public:
+	CSwVertexBuffer(UINT Length, DWORD FVF);
+
+	// SizeToLock이 0이면 OffsetToLock부터 버퍼 끝까지 잠근다.
+	HRESULT	Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags);
+	HRESULT	Unlock();
+
+	UINT			GetLength() const { return (UINT)m_Data.size(); }
+	DWORD			GetFVF() const { return m_dwFVF; }
+	const BYTE*		GetData() const { return m_Data.data(); }
+
+	// SoA 사본. FVF가 없거나 지원하지 않는 FVF면 NULL이다.
+	const SW_VERTEXSTREAMS*	GetStreams() const { return m_Streams.Get(); }
+
+private:
+	std::vector<BYTE>	m_Data;
+	DWORD				m_dwFVF;
+	CSwVertexStreams	m_Streams;
+	UINT				m_nDirtyBegin;		// Unlock() 때 다시 옮길 바이트 범위
+	UINT				m_nDirtyEnd;
+};
+
+//-----------------------------------------------------------------------------
+// 인덱스 버퍼
+//-----------------------------------------------------------------------------
+class CSwIndexBuffer : public CSwResource
+{
+public:
+	CSwIndexBuffer(UINT Length, D3DFORMAT Format);
+
+	HRESULT	Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags);
+	HRESULT	Unlock();
+
+	UINT			GetLength() const { return (UINT)m_Data.size(); }
+	D3DFORMAT		GetFormat() const { return m_Format; }
+	const BYTE*		GetData() const { return m_Data.data(); }
+
+private:
+	std::vector<BYTE>	m_Data;
+	D3DFORMAT			m_Format;
+};
+
+//-----------------------------------------------------------------------------
+// 텍스처
+// A8R8G8B8, X8R8G8B8과 블록 압축 형식 DXT1(BC1), DXT5(BC3)를 지원한다.
+// 모든 밉 레벨이 하나의 메모리 블록에 연속으로 놓인다. 블록 압축 형식의 레벨은 4x4 텍셀 블록의 행들이며
+// 4보다 작은 레벨도 블록 하나를 차지한다. 피치는 블록 한 행의 바이트 수다.
+//-----------------------------------------------------------------------------
+class CSwTexture : public CSwResource
+{
+public:
+	// Levels가 0이면 1x1까지의 전체 밉 체인을 만든다.
+	CSwTexture(UINT Width, UINT Height, UINT Levels, D3DFORMAT Format);
+
+	HRESULT	LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const void* pRect, DWORD Flags);
+	HRESULT	UnlockRect(UINT Level);
+
+	UINT			GetLevelCount() const { return (UINT)m_Levels.size(); }
+	D3DFORMAT		GetFormat() const { return m_Format; }
+	UINT			GetWidth(UINT Level = 0) const { return m_Levels[Level].nWidth; }
+	UINT			GetHeight(UINT Level = 0) const { return m_Levels[Level].nHeight; }
+	INT				GetPitch(UINT Level = 0) const { return m_Levels[Level].nPitch; }
+	const DWORD*	GetBits(UINT Level = 0) const { return m_Texels.data() + m_Levels[Level].nOffset; }
+
+	// 블록 하나의 바이트 수. 블록 압축 형식이 아니면 0이다.
+	UINT			GetBlockSize() const { return m_nBlockSize; }
+	// 모든 레벨을 합한 텍셀 메모리 크기
+	size_t			GetSizeInBytes() const { return m_Texels.size() * sizeof(DWORD); }
+
+private:
+	struct LEVEL
+	{
+		UINT	nWidth;
+		UINT	nHeight;
+		INT		nPitch;
+		size_t	nOffset;	// m_Texels 안에서의 시작 위치(DWORD 단위)
+	};
+
+	std::vector<LEVEL>	m_Levels;
+	std::vector<DWORD>	m_Texels;
+	D3DFORMAT			m_Format;
+	UINT				m_nBlockSize;
+};
@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwStateBlock.cpp
+//
+// 설명:	상태 블록의 기록과 정리.
+//-----------------------------------------------------------------------------
+#include "SwStateBlock.h"
+#include "SwDevice.h"
+
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// 기록
+//-----------------------------------------------------------------------------
+CSwStateRecorder::CSwStateRecorder()
+{
+	ZeroMemory(&m_Material, sizeof(m_Material));
+}
+
+CSwStateRecorder::~CSwStateRecorder()
+{
+	for (CSwTexture* pTexture : m_Textures)
+	{
+		if (pTexture)
+			pTexture->Release();
+	}
+}
+
+VOID CSwStateRecorder::Record(DWORD dwKey, DWORD dwValue)
+{
+	SW_STATECHANGE change = { dwKey, dwValue };
+	m_Changes.push_back(change);
+}
+
+VOID CSwStateRecorder::RecordTexture(DWORD dwStage, CSwTexture* pTexture)
+{
+	if (pTexture)
+		pTexture->AddRef();
+	Record(SW_STATEKEY(SW_STATE_TEXTURE, dwStage, 0), (DWORD)m_Textures.size());
+	m_Textures.push_back(pTexture);
+}
+
+VOID CSwStateRecorder::RecordMaterial(const D3DMATERIAL9* pMaterial)
+{
+	m_Material = *pMaterial;
+	Record(SW_STATEKEY(SW_STATE_MATERIAL, 0, 0), 0);
+}
+
+VOID CSwStateRecorder::RecordTransform(DWORD dwState, const D3DMATRIX* pMatrix)
+{
+	Record(SW_STATEKEY(SW_STATE_TRANSFORM, 0, dwState), (DWORD)m_Matrices.size());
+	m_Matrices.push_back(*pMatrix);
+}
+
+VOID CSwStateRecorder::RecordLight(DWORD dwIndex, const D3DLIGHT9* pLight)
+{
+	Record(SW_STATEKEY(SW_STATE_LIGHT, 0, dwIndex), (DWORD)m_Lights.size());
+	m_Lights.push_back(*pLight);
+}
+
+//-----------------------------------------------------------------------------
+// 상태 블록
+//-----------------------------------------------------------------------------
+CSwStateBlock::CSwStateBlock(CSwDevice* pDevice, CSwStateRecorder* pRecorder)
+	: m_pDevice(pDevice)
+	, m_Material(pRecorder->m_Material)
+{
+	m_pDevice->AddRef();
+
+	// 같은 상태는 마지막에 기록된 값만 남긴다. 안정 정렬이므로 같은 키 안에서는 호출 순서가 유지된다.
+	std::vector<SW_STATECHANGE>& changes = pRecorder->m_Changes;
+	std::stable_sort(changes.begin(), changes.end(),
+		[](const SW_STATECHANGE& a, const SW_STATECHANGE& b) { return a.dwKey < b.dwKey; });
+
+	for (size_t i = 0; i < changes.size(); ++i)
+	{
+		if (i + 1 < changes.size() && changes[i + 1].dwKey == changes[i].dwKey)
+			continue;
+
+		SW_STATECHANGE change = changes[i];
+		switch (SW_STATEKEY_KIND(change.dwKey))
+		{
+		case SW_STATE_TEXTURE:
+		{
+			// 텍스처의 참조는 기록기에서 블록으로 옮긴다.
+			CSwTexture*& pTexture = pRecorder->m_Textures[change.dwValue];
+			change.dwValue = (DWORD)m_Textures.size();
+			m_Textures.push_back(pTexture);
+			pTexture = NULL;
+			break;
+		}
+		case SW_STATE_TRANSFORM:
+			m_Matrices.push_back(pRecorder->m_Matrices[change.dwValue]);
+			change.dwValue = (DWORD)m_Matrices.size() - 1;
+			break;
+		case SW_STATE_LIGHT:
+			m_Lights.push_back(pRecorder->m_Lights[change.dwValue]);
+			change.dwValue = (DWORD)m_Lights.size() - 1;
+			break;
+		default:
+			break;
+		}
+		m_Changes.push_back(change);
+	}
+
+	changes.clear();
+	pRecorder->m_Matrices.clear();
+	pRecorder->m_Lights.clear();
+}
+
+CSwStateBlock::~CSwStateBlock()
+{
+	for (CSwTexture* pTexture : m_Textures)
+	{
+		if (pTexture)
+			pTexture->Release();
+	}
+	m_pDevice->Release();
+}
+
+HRESULT CSwStateBlock::Apply()
+{
+	return m_pDevice->ApplyStateBlock(this);
+}
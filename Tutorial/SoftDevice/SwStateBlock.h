@@ -0,0 +1,108 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwStateBlock.h
+//
+// 설명:	상태 블록(IDirect3DStateBlock9와 같은 이름의 Apply()를 제공한다).
+//		CSwDevice::BeginStateBlock()과 EndStateBlock() 사이의 Set*(), LightEnable() 호출을 기록해 두었다가
+//		EndStateBlock()에서 한 번만 정리한다. 같은 상태를 여러 번 설정했으면 마지막 값만 남기고
+//		상태 종류, 스테이지, 번호 순으로 정렬한다. 범위 검사는 기록할 때 끝났으므로
+//		Apply()는 검사 없이 디바이스의 그림자 상태와 비교하여 바뀐 값만 반영한다.
+//
+//		사용 예:
+//			pDevice->BeginStateBlock();
+//			pDevice->SetTexture(0, pTexture);
+//			pDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
+//			CSwStateBlock* pBlock;
+//			pDevice->EndStateBlock(&pBlock);
+//			...
+//			pBlock->Apply();	// 매 프레임
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwResource.h"
+
+#include <vector>
+
+class CSwDevice;
+
+enum SW_STATEKIND
+{
+	SW_STATE_RENDER = 0,		// SetRenderState
+	SW_STATE_STAGE,				// SetTextureStageState
+	SW_STATE_SAMPLER,			// SetSamplerState
+	SW_STATE_TEXTURE,			// SetTexture. dwValue는 텍스처 목록의 번호다.
+	SW_STATE_MATERIAL,			// SetMaterial. dwValue는 쓰지 않는다.
+	SW_STATE_TRANSFORM,			// SetTransform. dwValue는 행렬 목록의 번호다.
+	SW_STATE_LIGHT,				// SetLight. 번호는 광원 번호, dwValue는 광원 목록의 번호다.
+	SW_STATE_LIGHTENABLE,		// LightEnable. 번호는 광원 번호다.
+};
+
+// 상태 하나의 위치. 정렬하면 종류, 스테이지, 번호 순이 된다.
+#define SW_STATEKEY(kind, stage, type)	(((DWORD)(kind) << 24) | ((DWORD)(stage) << 16) | (DWORD)(type))
+#define SW_STATEKEY_KIND(key)			((SW_STATEKIND)((key) >> 24))
+#define SW_STATEKEY_STAGE(key)			(((key) >> 16) & 0xff)
+#define SW_STATEKEY_TYPE(key)			((key) & 0xffff)
+
+struct SW_STATECHANGE
+{
+	DWORD	dwKey;
+	DWORD	dwValue;
+};
+
+//-----------------------------------------------------------------------------
+// 기록 중인 상태 변경. BeginStateBlock()부터 EndStateBlock()까지 디바이스가 갖는다.
+//-----------------------------------------------------------------------------
+class CSwStateRecorder
+{
+public:
+	CSwStateRecorder();
+	~CSwStateRecorder();
+
+	VOID	Record(DWORD dwKey, DWORD dwValue);
+	VOID	RecordTexture(DWORD dwStage, CSwTexture* pTexture);
+	VOID	RecordMaterial(const D3DMATERIAL9* pMaterial);
+	VOID	RecordTransform(DWORD dwState, const D3DMATRIX* pMatrix);
+	VOID	RecordLight(DWORD dwIndex, const D3DLIGHT9* pLight);
+
+private:
+	friend class CSwStateBlock;
+
+	CSwStateRecorder(const CSwStateRecorder&) = delete;
+	CSwStateRecorder& operator=(const CSwStateRecorder&) = delete;
+
+	std::vector<SW_STATECHANGE>	m_Changes;		// 호출 순서 그대로
+	std::vector<CSwTexture*>	m_Textures;		// 참조를 잡아 둔다
+	D3DMATERIAL9				m_Material;
+	std::vector<D3DMATRIX>		m_Matrices;
+	std::vector<D3DLIGHT9>		m_Lights;
+};
+
+//-----------------------------------------------------------------------------
+// 상태 블록. 만들어진 뒤에는 바뀌지 않는다.
+//-----------------------------------------------------------------------------
+class CSwStateBlock : public CSwResource
+{
+public:
+	// 기록된 상태를 디바이스에 설정한다. 디바이스의 값과 같은 상태는 건너뛴다.
+	HRESULT	Apply();
+
+	UINT					GetNumChanges() const { return (UINT)m_Changes.size(); }
+	const SW_STATECHANGE*	GetChanges() const { return m_Changes.data(); }
+	CSwTexture*				GetTexture(DWORD dwIndex) const { return m_Textures[dwIndex]; }
+	const D3DMATERIAL9&		GetMaterial() const { return m_Material; }
+	const D3DMATRIX&		GetMatrix(DWORD dwIndex) const { return m_Matrices[dwIndex]; }
+	const D3DLIGHT9&		GetLight(DWORD dwIndex) const { return m_Lights[dwIndex]; }
+
+private:
+	friend class CSwDevice;
+
+	// pRecorder의 내용을 정리하여 가져온다. pRecorder는 비워진다.
+	CSwStateBlock(CSwDevice* pDevice, CSwStateRecorder* pRecorder);
+	virtual ~CSwStateBlock();
+
+	CSwDevice*					m_pDevice;
+	std::vector<SW_STATECHANGE>	m_Changes;		// 상태마다 하나, SW_STATEKEY 순
+	std::vector<CSwTexture*>	m_Textures;		// SW_STATE_TEXTURE 항목이 가리킨다. NULL일 수 있다.
+	D3DMATERIAL9				m_Material;
+	std::vector<D3DMATRIX>		m_Matrices;		// SW_STATE_TRANSFORM 항목이 가리킨다
+	std::vector<D3DLIGHT9>		m_Lights;		// SW_STATE_LIGHT 항목이 가리킨다
+};
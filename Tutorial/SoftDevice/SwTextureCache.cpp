@@ -0,0 +1,228 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwTextureCache.cpp
+//
+// 설명:	블록 압축 텍스처 캐시 구현.
+//-----------------------------------------------------------------------------
+#include "SwTextureCache.h"
+#include "SwBitmap.h"
+#include "SwBlockCompress.h"
+#include "SwFile.h"
+#include "SwHash.h"
+#include "SwMipmap.h"
+#include "SwResource.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static_assert(sizeof(SW_TEXCACHEHEADER) % 8 == 0, "SW_TEXCACHEHEADER must stay 8-byte sized");
+
+static inline UINT64 AlignUp(UINT64 n)
+{
+	return (n + SW_TEXCACHE_ALIGNMENT - 1) & ~(UINT64)(SW_TEXCACHE_ALIGNMENT - 1);
+}
+
+static inline double ElapsedMs(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+HRESULT SwWriteTextureCache(const char* pFilename, const CSwTexture* pTexture, UINT64 nSourceHash)
+{
+	if (pFilename == NULL || pTexture == NULL || pTexture->GetBlockSize() == 0)
+		return D3DERR_INVALIDCALL;
+
+	SW_TEXCACHEHEADER header;
+	ZeroMemory(&header, sizeof(header));
+	memcpy(header.Magic, "SWTC", 4);
+	header.nVersion = SW_TEXCACHE_VERSION;
+	header.nSourceHash = nSourceHash;
+	header.dwFormat = (DWORD)pTexture->GetFormat();
+	header.nWidth = pTexture->GetWidth();
+	header.nHeight = pTexture->GetHeight();
+	header.nLevels = pTexture->GetLevelCount();
+	header.nDataOffset = AlignUp(sizeof(header));
+	header.nDataSize = pTexture->GetSizeInBytes();
+	header.nFileSize = header.nDataOffset + header.nDataSize;
+
+	std::vector<BYTE> data((size_t)header.nFileSize, 0);
+	memcpy(data.data(), &header, sizeof(header));
+	memcpy(data.data() + header.nDataOffset, pTexture->GetBits(), (size_t)header.nDataSize);
+
+	const std::string strTemp = std::string(pFilename) + ".tmp";
+	FILE* fp = fopen(strTemp.c_str(), "wb");
+	if (fp == NULL)
+		return E_FAIL;
+	const bool bWritten = fwrite(data.data(), 1, data.size(), fp) == data.size();
+	if (fclose(fp) != 0 || !bWritten)
+	{
+		remove(strTemp.c_str());
+		return E_FAIL;
+	}
+
+	// Windows의 rename()은 대상이 있으면 실패하므로 먼저 지운다.
+	remove(pFilename);
+	if (rename(strTemp.c_str(), pFilename) != 0)
+	{
+		remove(strTemp.c_str());
+		return E_FAIL;
+	}
+	return S_OK;
+}
+
+HRESULT SwReadTextureCache(const char* pFilename, UINT64 nSourceHash, D3DFORMAT Format, UINT Levels,
+	CSwTexture** ppTexture)
+{
+	if (pFilename == NULL || ppTexture == NULL)
+		return D3DERR_INVALIDCALL;
+
+	CSwMappedFile file;
+	HRESULT hr = file.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+
+	SW_TEXCACHEHEADER header;
+	if (file.GetSize() < sizeof(header))
+		return E_FAIL;
+	memcpy(&header, file.GetData(), sizeof(header));
+
+	if (memcmp(header.Magic, "SWTC", 4) != 0 || header.nVersion != SW_TEXCACHE_VERSION ||
+		header.nSourceHash != nSourceHash || header.nFileSize != file.GetSize() ||
+		header.dwFormat != (DWORD)Format || (Levels != 0 && header.nLevels != Levels) ||
+		header.nWidth == 0 || header.nHeight == 0 || header.nLevels == 0 || header.nLevels > 32)
+	{
+		return E_FAIL;
+	}
+
+	// 머리에 적힌 크기로 만든 텍스처의 메모리 크기가 데이터 크기와 같아야 한다.
+	CSwTexture* pTexture = new CSwTexture(header.nWidth, header.nHeight, header.nLevels, Format);
+	if (pTexture->GetLevelCount() != header.nLevels || pTexture->GetSizeInBytes() != header.nDataSize ||
+		header.nDataOffset > header.nFileSize || header.nDataSize > header.nFileSize - header.nDataOffset)
+	{
+		pTexture->Release();
+		return E_FAIL;
+	}
+
+	D3DLOCKED_RECT rect;
+	pTexture->LockRect(0, &rect, NULL, 0);
+	memcpy(rect.pBits, file.GetData() + header.nDataOffset, (size_t)header.nDataSize);
+	pTexture->UnlockRect(0);
+
+	*ppTexture = pTexture;
+	return S_OK;
+}
+
+HRESULT SwCreateCompressedTextureFromBitmap(const char* pFilename, D3DFORMAT Format, UINT Levels,
+	CSwTexture** ppTexture, SW_TEXLOADINFO* pInfo, CSwThreadPool* pThreadPool)
+{
+	if (pFilename == NULL || ppTexture == NULL || SwGetBlockSize(Format) == 0)
+		return D3DERR_INVALIDCALL;
+
+	SW_TEXLOADINFO info;
+	ZeroMemory(&info, sizeof(info));
+	const std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+
+	// 1. 원본을 열어 해시한다. 원본이 없으면 캐시가 있어도 쓰지 않는다.
+	std::chrono::steady_clock::time_point t0 = tStart;
+	CSwMappedFile source;
+	HRESULT hr = source.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+	const UINT64 nSourceHash = SwHash64(source.GetData(), source.GetSize());
+	info.fHashMs = ElapsedMs(t0);
+
+	// 2. 캐시가 맞으면 그대로 쓴다.
+	const std::string strCache = std::string(pFilename) + ((Format == D3DFMT_DXT5) ? ".bc3.swt" : ".bc1.swt");
+	t0 = std::chrono::steady_clock::now();
+	CSwTexture* pTexture = NULL;
+	if (SUCCEEDED(SwReadTextureCache(strCache.c_str(), nSourceHash, Format, Levels, &pTexture)))
+	{
+		info.bFromCache = true;
+		info.fOpenMs = ElapsedMs(t0);
+	}
+	else
+	{
+		// 3. BMP를 풀고 밉 체인을 만든다.
+		t0 = std::chrono::steady_clock::now();
+		SW_BITMAPINFO bitmap;
+		if (FAILED(hr = SwGetBitmapInfoInMemory(source.GetData(), source.GetSize(), &bitmap)))
+			return hr;
+
+		CSwTexture* pSource = new CSwTexture(bitmap.nWidth, bitmap.nHeight, Levels, D3DFMT_X8R8G8B8);
+		D3DLOCKED_RECT rect;
+		pSource->LockRect(0, &rect, NULL, 0);
+		hr = SwDecodeBitmapInMemory(source.GetData(), source.GetSize(), rect.pBits, rect.Pitch);
+		pSource->UnlockRect(0);
+		if (SUCCEEDED(hr) && pSource->GetLevelCount() > 1)
+			hr = SwGenerateMipmaps(pSource, SW_MIPFILTER_KAISER, SW_MIPMAP_WRAP, pThreadPool);
+		if (FAILED(hr))
+		{
+			pSource->Release();
+			return hr;
+		}
+		info.fDecodeMs = ElapsedMs(t0);
+
+		// 4. 압축하여 캐시를 쓴다. 쓰지 못해도 압축한 텍스처는 그대로 쓴다.
+		t0 = std::chrono::steady_clock::now();
+		hr = SwCompressTexture(pSource, Format, &pTexture, pThreadPool);
+		pSource->Release();
+		if (FAILED(hr))
+			return hr;
+		info.fEncodeMs = ElapsedMs(t0);
+
+		t0 = std::chrono::steady_clock::now();
+		SwWriteTextureCache(strCache.c_str(), pTexture, nSourceHash);
+		info.fWriteMs = ElapsedMs(t0);
+	}
+
+	info.fTotalMs = ElapsedMs(tStart);
+	if (pInfo)
+		*pInfo = info;
+	*ppTexture = pTexture;
+	return S_OK;
+}
+
+#if defined(_WIN32) && !defined(SW_NO_D3D9)
+//-----------------------------------------------------------------------------
+// D3D 텍스처로 복사
+//-----------------------------------------------------------------------------
+HRESULT SwCreateD3DTextureFromCompressed(IDirect3DDevice9* pDevice, const CSwTexture* pCompressed,
+	IDirect3DTexture9** ppTexture)
+{
+	if (!pDevice || !pCompressed || !ppTexture || !pCompressed->GetBlockSize())
+		return D3DERR_INVALIDCALL;
+
+	*ppTexture = NULL;
+	const UINT nLevels = pCompressed->GetLevelCount();
+	IDirect3DTexture9* pTexture;
+	HRESULT hr = pDevice->CreateTexture(pCompressed->GetWidth(), pCompressed->GetHeight(), nLevels, 0,
+		pCompressed->GetFormat(), D3DPOOL_MANAGED, &pTexture, NULL);
+	if (FAILED(hr))
+		return hr;
+
+	// 블록 압축 텍스처의 피치는 블록(4x4 텍셀) 한 행의 바이트 수이므로 블록 행 단위로 복사한다.
+	for (UINT i = 0; i < nLevels && SUCCEEDED(hr); ++i)
+	{
+		D3DLOCKED_RECT rect;
+		if (FAILED(hr = pTexture->LockRect(i, &rect, NULL, 0)))
+			break;
+
+		const BYTE* pSrc = (const BYTE*)pCompressed->GetBits(i);
+		const UINT nRowSize = (UINT)pCompressed->GetPitch(i);
+		const UINT nRows = (pCompressed->GetHeight(i) + 3) / 4;
+		for (UINT y = 0; y < nRows; ++y)
+			memcpy((BYTE*)rect.pBits + y * rect.Pitch, pSrc + y * nRowSize, nRowSize);
+		pTexture->UnlockRect(i);
+	}
+
+	if (FAILED(hr))
+	{
+		pTexture->Release();
+		return hr;
+	}
+	*ppTexture = pTexture;
+	return S_OK;
+}
+#endif
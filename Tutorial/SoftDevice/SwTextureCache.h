@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwTextureCache.h
+//
+// 설명:	미리 압축해 둔 텍스처 캐시(.swt).
+//		BMP를 처음 읽을 때 밉 체인을 만들고 BC1/BC3으로 압축한 결과를 원본 옆에 써 두고,
+//		다음 실행부터는 이 파일을 메모리 맵으로 연결하여 텍스처 메모리로 한 번 복사하기만 한다.
+//		같은 파일을 미리 만들어 배포하면 오프라인 압축이 된다.
+//		파일에는 원본 내용의 해시가 들어 있어 원본이 바뀌면 자동으로 다시 만든다.
+//
+//		파일 구성(리틀 엔디언):
+//			SW_TEXCACHEHEADER
+//			블록		CSwTexture와 같은 배치의 모든 레벨(레벨 0부터, 블록 행 순서), nDataSize 바이트
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+class CSwTexture;
+class CSwThreadPool;
+
+#define SW_TEXCACHE_VERSION			1
+#define SW_TEXCACHE_ALIGNMENT		64
+
+struct SW_TEXCACHEHEADER
+{
+	char	Magic[4];				// "SWTC"
+	UINT	nVersion;				// SW_TEXCACHE_VERSION
+	UINT64	nSourceHash;			// 원본 파일 내용의 SwHash64()
+	UINT64	nFileSize;				// 캐시 파일 전체 크기
+	DWORD	dwFormat;				// D3DFMT_DXT1 또는 D3DFMT_DXT5
+	UINT	nWidth;
+	UINT	nHeight;
+	UINT	nLevels;
+	UINT64	nDataOffset;
+	UINT64	nDataSize;
+};
+
+//-----------------------------------------------------------------------------
+// 읽기 시간 보고
+//-----------------------------------------------------------------------------
+struct SW_TEXLOADINFO
+{
+	bool	bFromCache;		// 캐시가 유효하여 압축하지 않았으면 true
+	double	fHashMs;		// 원본을 열고 해시하는 데 걸린 시간
+	double	fDecodeMs;		// BMP 디코딩과 밉 체인 생성(캐시를 쓰면 0)
+	double	fEncodeMs;		// 블록 압축(캐시를 쓰면 0)
+	double	fWriteMs;		// 캐시 파일 쓰기(캐시를 쓰면 0)
+	double	fOpenMs;		// 캐시를 열어 텍스처로 복사하는 데 걸린 시간
+	double	fTotalMs;
+};
+
+// 압축된 텍스처를 캐시 파일로 쓴다. 임시 파일에 쓴 다음 이름을 바꾸므로
+// 쓰는 도중에 멈추어도 깨진 캐시가 남지 않는다.
+HRESULT	SwWriteTextureCache(const char* pFilename, const CSwTexture* pTexture, UINT64 nSourceHash);
+
+// 캐시 파일을 읽어 텍스처를 만든다. 파일이 없으면 D3DERR_NOTFOUND,
+// 버전이나 원본 해시, 형식, 레벨 수(Levels가 0이 아닐 때)가 맞지 않으면 E_FAIL을 돌려준다.
+HRESULT	SwReadTextureCache(const char* pFilename, UINT64 nSourceHash, D3DFORMAT Format, UINT Levels,
+			CSwTexture** ppTexture);
+
+// BMP 파일을 캐시를 거쳐 블록 압축 텍스처(D3DFMT_DXT1 또는 D3DFMT_DXT5)로 읽는다.
+// 캐시 파일 이름은 원본 이름 뒤에 ".bc1.swt" 또는 ".bc3.swt"를 붙인 것이다.
+// 캐시가 없거나 원본과 맞지 않으면 BMP를 풀어 Kaiser 필터로 밉 체인을 만들고 압축하여 캐시를 새로 쓴다.
+// 캐시를 쓸 수 없는 곳(읽기 전용 폴더 등)이어도 텍스처는 만들고 S_OK를 돌려준다.
+// Levels가 0이면 전체 밉 체인을 만든다.
+HRESULT	SwCreateCompressedTextureFromBitmap(const char* pFilename, D3DFORMAT Format, UINT Levels,
+			CSwTexture** ppTexture, SW_TEXLOADINFO* pInfo = NULL, CSwThreadPool* pThreadPool = NULL);
+
+#if defined(_WIN32) && !defined(SW_NO_D3D9)
+// 블록 압축 텍스처를 같은 형식, 같은 레벨 수의 D3D 텍스처(D3DPOOL_MANAGED)로 복사한다.
+// 렌더 스레드에서 부른다. 실패하면 *ppTexture는 NULL이며, 예제들은 이때 D3DX 함수로 다시 읽는다.
+HRESULT	SwCreateD3DTextureFromCompressed(IDirect3DDevice9* pDevice, const CSwTexture* pCompressed,
+			IDirect3DTexture9** ppTexture);
+#endif
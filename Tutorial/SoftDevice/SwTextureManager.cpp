@@ -0,0 +1,211 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwTextureManager.cpp
+//
+// 설명:	텍스처 관리자 구현.
+//-----------------------------------------------------------------------------
+#include "SwTextureManager.h"
+#include "SwFile.h"
+#include "SwHash.h"
+
+#include <cctype>
+#include <chrono>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <climits>
+#include <cstdlib>
+#endif
+
+static inline double ElapsedMs(std::chrono::steady_clock::time_point t0)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+//-----------------------------------------------------------------------------
+// 파일이 있으면 정규화한 전체 경로를 돌려준다.
+// 예제의 X 파일에는 "..\\" 같은 Windows 구분자가 들어 있으므로 다른 플랫폼에서는 '/'로 바꾼다.
+//-----------------------------------------------------------------------------
+static bool CanonicalizePath(const std::string& strPath, std::string* pCanonical)
+{
+#if defined(_WIN32)
+	char strFull[MAX_PATH];
+	const DWORD nLength = GetFullPathNameA(strPath.c_str(), MAX_PATH, strFull, NULL);
+	if (nLength == 0 || nLength >= MAX_PATH)
+		return false;
+
+	const DWORD dwAttributes = GetFileAttributesA(strFull);
+	if (dwAttributes == INVALID_FILE_ATTRIBUTES || (dwAttributes & FILE_ATTRIBUTE_DIRECTORY))
+		return false;
+
+	// NTFS는 대소문자를 구별하지 않으므로 "Tiger.bmp"와 "tiger.bmp"는 같은 파일이다.
+	pCanonical->assign(strFull, nLength);
+	for (char& c : *pCanonical)
+		c = (c == '/') ? '\\' : (char)tolower((unsigned char)c);
+	return true;
+#else
+	std::string strNative = strPath;
+	for (char& c : strNative)
+	{
+		if (c == '\\')
+			c = '/';
+	}
+
+	char strFull[PATH_MAX];
+	if (realpath(strNative.c_str(), strFull) == NULL)
+		return false;
+	pCanonical->assign(strFull);
+	return true;
+#endif
+}
+
+CSwTextureManager::CSwTextureManager(const LOADFUNC& load, const RELEASEFUNC& release)
+	: m_Load(load)
+	, m_Release(release)
+{
+	ZeroMemory(&m_Stats, sizeof(m_Stats));
+}
+
+CSwTextureManager::~CSwTextureManager()
+{
+	for (auto& it : m_Entries)
+		m_Release(it.second.pTexture);
+}
+
+VOID CSwTextureManager::AddSearchPath(const char* pPrefix)
+{
+	if (pPrefix)
+		m_SearchPaths.push_back(pPrefix);
+}
+
+HRESULT CSwTextureManager::HashFile(const char* pPath, UINT64* pHash) const
+{
+	CSwMappedFile file;
+	HRESULT hr = file.Open(pPath);
+	if (FAILED(hr))
+		return hr;
+	*pHash = SwHash64(file.GetData(), file.GetSize());
+	return S_OK;
+}
+
+HRESULT CSwTextureManager::Resolve(const char* pFilename, NAME* pName) const
+{
+	// 이름 그대로(현재 폴더 기준) 찾은 다음, 검색 경로를 추가한 순서대로 붙여 본다.
+	if (!CanonicalizePath(pFilename, &pName->strPath))
+	{
+		bool bFound = false;
+		for (const std::string& strPrefix : m_SearchPaths)
+		{
+			if (CanonicalizePath(strPrefix + pFilename, &pName->strPath))
+			{
+				bFound = true;
+				break;
+			}
+		}
+		if (!bFound)
+			return D3DERR_NOTFOUND;
+	}
+	return HashFile(pName->strPath.c_str(), &pName->nHash);
+}
+
+VOID CSwTextureManager::AddRef(ENTRY* pEntry, void** ppTexture)
+{
+	++pEntry->nRefCount;
+	*ppTexture = pEntry->pTexture;
+}
+
+HRESULT CSwTextureManager::Acquire(const char* pFilename, void** ppTexture)
+{
+	if (pFilename == NULL || ppTexture == NULL)
+		return D3DERR_INVALIDCALL;
+
+	++m_Stats.nRequests;
+	std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+
+	// 1. 이미 찾아 둔 이름이고 텍스처가 살아 있으면 바로 돌려준다.
+	NAME name;
+	HRESULT hr;
+	auto itName = m_Names.find(pFilename);
+	if (itName != m_Names.end())
+	{
+		auto itEntry = m_Entries.find(itName->second.nHash);
+		if (itEntry != m_Entries.end())
+		{
+			++m_Stats.nNameHits;
+			AddRef(&itEntry->second, ppTexture);
+			m_Stats.fResolveMs += ElapsedMs(t0);
+			return S_OK;
+		}
+
+		// 텍스처를 모두 놓은 다음이면 그 사이에 파일이 바뀌었을 수 있으므로 다시 해시한다.
+		name.strPath = itName->second.strPath;
+		hr = HashFile(name.strPath.c_str(), &name.nHash);
+	}
+	else
+	{
+		hr = Resolve(pFilename, &name);
+	}
+	m_Stats.fResolveMs += ElapsedMs(t0);
+
+	if (FAILED(hr))
+	{
+		++m_Stats.nFailures;
+		m_Names.erase(pFilename);
+		return hr;
+	}
+
+	// 2. 경로는 달라도 내용이 같은 텍스처가 있으면 나누어 쓴다.
+	auto itEntry = m_Entries.find(name.nHash);
+	if (itEntry != m_Entries.end())
+	{
+		++m_Stats.nContentHits;
+		m_Names[pFilename] = name;
+		AddRef(&itEntry->second, ppTexture);
+		return S_OK;
+	}
+
+	// 3. 처음 보는 내용이면 텍스처를 만든다.
+	t0 = std::chrono::steady_clock::now();
+	void* pTexture = NULL;
+	hr = m_Load(name.strPath.c_str(), &pTexture);
+	m_Stats.fLoadMs += ElapsedMs(t0);
+	if (FAILED(hr))
+	{
+		++m_Stats.nFailures;
+		m_Names.erase(pFilename);
+		return hr;
+	}
+
+	++m_Stats.nMisses;
+	m_Names[pFilename] = name;
+	m_Textures[pTexture] = name.nHash;
+
+	ENTRY& entry = m_Entries[name.nHash];
+	entry.pTexture = pTexture;
+	entry.nHash = name.nHash;
+	entry.nRefCount = 0;
+	entry.strPath = name.strPath;
+	m_Stats.nEntries = (UINT)m_Entries.size();
+
+	AddRef(&entry, ppTexture);
+	return S_OK;
+}
+
+VOID CSwTextureManager::Release(const void* pTexture)
+{
+	auto itTexture = m_Textures.find(pTexture);
+	if (itTexture == m_Textures.end())
+		return;
+
+	auto itEntry = m_Entries.find(itTexture->second);
+	if (--itEntry->second.nRefCount == 0)
+	{
+		m_Release(itEntry->second.pTexture);
+		m_Entries.erase(itEntry);
+		m_Textures.erase(itTexture);
+		m_Stats.nEntries = (UINT)m_Entries.size();
+	}
+}
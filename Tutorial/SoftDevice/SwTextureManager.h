@@ -0,0 +1,96 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwTextureManager.h
+//
+// 설명:	파일 내용으로 식별하는 텍스처 관리자.
+//		메시의 재질 수백 개가 텍스처 몇 장을 나누어 쓰는 경우, 재질마다 텍스처를 만들지 않고
+//		한 번 만든 텍스처를 참조 수를 세어 돌려준다.
+//
+//		요청한 이름은 처음 한 번만 검색 경로에서 찾아 정규화(전체 경로, Windows에서는 소문자)하고
+//		그 결과를 이름별로 기억한다. 같은 이름을 다시 요청하면 파일 시스템을 거치지 않는다.
+//		처음 보는 이름은 파일을 열어 SwHash64()로 해시하므로, 경로가 달라도 내용이 같은 파일은
+//		같은 텍스처를 나누어 쓴다. 실제로 텍스처를 만드는 일은 생성할 때 넘긴 함수가 한다.
+//
+//		한 스레드에서만 사용한다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// 요청 통계
+//-----------------------------------------------------------------------------
+struct SW_TEXMANAGERSTATS
+{
+	UINT	nRequests;		// Acquire() 호출 수
+	UINT	nNameHits;		// 이름으로 바로 찾은 요청(파일 시스템을 거치지 않음)
+	UINT	nContentHits;	// 이름은 처음이지만 내용이 같은 텍스처가 있던 요청
+	UINT	nMisses;		// 텍스처를 새로 만든 요청
+	UINT	nFailures;		// 파일을 찾지 못했거나 만들지 못한 요청
+	UINT	nEntries;		// 현재 살아 있는 텍스처 수
+	double	fResolveMs;		// 경로 검색, 정규화, 해시에 걸린 시간
+	double	fLoadMs;		// 텍스처 생성 함수에 걸린 시간
+};
+
+class CSwTextureManager
+{
+public:
+	// (정규화한 경로, 만든 텍스처) 텍스처를 만들어 참조 하나를 넘긴다.
+	typedef std::function<HRESULT(const char*, void**)> LOADFUNC;
+	// 관리자가 가진 참조를 놓는다.
+	typedef std::function<void(void*)> RELEASEFUNC;
+
+	CSwTextureManager(const LOADFUNC& load, const RELEASEFUNC& release);
+	~CSwTextureManager();
+
+	CSwTextureManager(const CSwTextureManager&) = delete;
+	CSwTextureManager& operator=(const CSwTextureManager&) = delete;
+
+	// 이름을 찾지 못했을 때 앞에 붙여 볼 폴더를 추가한다(예: "..\\"). 추가한 순서대로 찾는다.
+	VOID		AddSearchPath(const char* pPrefix);
+
+	// 텍스처를 얻고 참조 수를 늘린다. 파일이 어디에도 없으면 D3DERR_NOTFOUND,
+	// 생성 함수가 실패하면 그 결과를 돌려준다. 실패한 이름은 기억하지 않는다.
+	HRESULT		Acquire(const char* pFilename, void** ppTexture);
+
+	template<class T>
+	HRESULT		Acquire(const char* pFilename, T** ppTexture) { return Acquire(pFilename, (void**)ppTexture); }
+
+	// Acquire()로 얻은 참조를 돌려준다. 참조 수가 0이 되면 텍스처를 놓는다.
+	VOID		Release(const void* pTexture);
+
+	const SW_TEXMANAGERSTATS&	GetStats() const { return m_Stats; }
+
+private:
+	struct ENTRY
+	{
+		void*		pTexture;
+		UINT64		nHash;
+		UINT		nRefCount;
+		std::string	strPath;		// 처음 만들 때 쓴 정규화한 경로
+	};
+
+	struct NAME
+	{
+		std::string	strPath;		// 정규화한 경로
+		UINT64		nHash;			// 마지막으로 해시한 내용
+	};
+
+	HRESULT		Resolve(const char* pFilename, NAME* pName) const;
+	HRESULT		HashFile(const char* pPath, UINT64* pHash) const;
+	VOID		AddRef(ENTRY* pEntry, void** ppTexture);
+
+	LOADFUNC								m_Load;
+	RELEASEFUNC								m_Release;
+	std::vector<std::string>				m_SearchPaths;
+
+	std::unordered_map<std::string, NAME>	m_Names;		// 요청한 이름 -> 정규화한 경로와 해시
+	std::unordered_map<UINT64, ENTRY>		m_Entries;		// 내용 해시 -> 텍스처
+	std::unordered_map<const void*, UINT64>	m_Textures;		// 텍스처 -> 내용 해시
+
+	SW_TEXMANAGERSTATS						m_Stats;
+};
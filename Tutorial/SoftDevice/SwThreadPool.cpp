@@ -0,0 +1,133 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwThreadPool.cpp
+//
+// 설명:	CSwThreadPool 구현.
+//-----------------------------------------------------------------------------
+#include "SwThreadPool.h"
+
+// 현재 스레드가 작업자로 들어간 깊이
+static thread_local UINT s_nWorkerDepth = 0;
+
+CSwWorkerThreadScope::CSwWorkerThreadScope()
+{
+	++s_nWorkerDepth;
+}
+
+CSwWorkerThreadScope::~CSwWorkerThreadScope()
+{
+	--s_nWorkerDepth;
+}
+
+bool SwIsWorkerThread()
+{
+	return s_nWorkerDepth != 0;
+}
+
+CSwThreadPool* SwGetDefaultThreadPool()
+{
+	if (SwIsWorkerThread())
+		return NULL;
+
+	static CSwThreadPool s_DefaultPool;
+	return &s_DefaultPool;
+}
+
+CSwThreadPool::CSwThreadPool(UINT nThreads)
+	: m_nThreads(nThreads)
+	, m_nGeneration(0)
+	, m_nActive(0)
+	, m_bQuit(false)
+	, m_pFunc(NULL)
+	, m_nCount(0)
+	, m_nNext(0)
+{
+	if (m_nThreads == 0)
+		m_nThreads = std::thread::hardware_concurrency();
+	if (m_nThreads == 0)
+		m_nThreads = 1;
+
+	// 0번 작업자는 ParallelFor()를 호출한 스레드다.
+	for (UINT i = 1; i < m_nThreads; ++i)
+		m_Workers.emplace_back(&CSwThreadPool::WorkerMain, this, i);
+}
+
+CSwThreadPool::~CSwThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bQuit = true;
+	}
+	m_WakeCond.notify_all();
+
+	for (size_t i = 0; i < m_Workers.size(); ++i)
+		m_Workers[i].join();
+}
+
+VOID CSwThreadPool::ParallelFor(UINT nCount, const TASKFUNC& func)
+{
+	if (nCount == 0)
+		return;
+
+	CSwWorkerThreadScope worker;
+
+	// 작업이 하나뿐이거나 스레드가 하나뿐이면 깨우는 비용을 아낀다.
+	if (nCount == 1 || m_Workers.empty())
+	{
+		for (UINT i = 0; i < nCount; ++i)
+			func(i, 0);
+		return;
+	}
+
+	std::lock_guard<std::mutex> call(m_CallMutex);
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_pFunc = &func;
+		m_nCount = nCount;
+		m_nNext.store(0, std::memory_order_relaxed);
+		m_nActive = (UINT)m_Workers.size();
+		++m_nGeneration;
+	}
+	m_WakeCond.notify_all();
+
+	RunTasks(0);
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_DoneCond.wait(lock, [this] { return m_nActive == 0; });
+	m_pFunc = NULL;
+}
+
+VOID CSwThreadPool::WorkerMain(UINT nThread)
+{
+	CSwWorkerThreadScope worker;
+	UINT nSeen = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeCond.wait(lock, [&] { return m_bQuit || m_nGeneration != nSeen; });
+			if (m_bQuit)
+				return;
+			nSeen = m_nGeneration;
+		}
+
+		RunTasks(nThread);
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (--m_nActive == 0)
+				m_DoneCond.notify_one();
+		}
+	}
+}
+
+VOID CSwThreadPool::RunTasks(UINT nThread)
+{
+	const TASKFUNC& func = *m_pFunc;
+	for (;;)
+	{
+		UINT i = m_nNext.fetch_add(1, std::memory_order_relaxed);
+		if (i >= m_nCount)
+			break;
+		func(i, nThread);
+	}
+}
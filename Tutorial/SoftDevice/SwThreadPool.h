@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwThreadPool.h
+//
+// 설명:	소프트웨어 디바이스가 작업을 모든 코어에 나누어 주는 스레드 풀.
+//		ParallelFor()를 호출한 스레드도 0번 작업자로 참여하므로
+//		작업자 수는 (NumThreads - 1)개의 스레드 + 호출 스레드다.
+//
+//		풀을 받지 않은 함수(밉 생성, 블록 압축, .x 읽기, 라이트맵 굽기)는 SwGetDefaultThreadPool()의
+//		공유 풀을 쓴다. ParallelFor()는 재진입할 수 없으므로 이미 풀이나 로더의 작업자인 스레드에서는
+//		기본 풀을 주지 않고 직렬로 실행하게 한다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class CSwThreadPool
+{
+public:
+	// (작업 번호, 작업을 수행하는 스레드 번호)
+	typedef std::function<void(UINT, UINT)> TASKFUNC;
+
+	// nThreads가 0이면 하드웨어 스레드 수만큼 생성한다.
+	explicit CSwThreadPool(UINT nThreads = 0);
+	~CSwThreadPool();
+
+	CSwThreadPool(const CSwThreadPool&) = delete;
+	CSwThreadPool& operator=(const CSwThreadPool&) = delete;
+
+	UINT	GetNumThreads() const { return m_nThreads; }
+
+	// [0, nCount) 범위의 작업을 모든 스레드에 나누어 실행하고 끝날 때까지 기다린다.
+	// 작업 번호는 원자적 카운터로 하나씩 나누어 주므로 먼저 끝난 스레드가 남은 작업을 가져간다.
+	// 여러 스레드에서 동시에 부르면 차례로 실행한다. 작업 함수 안에서 다시 부르면 안 된다.
+	VOID	ParallelFor(UINT nCount, const TASKFUNC& func);
+
+private:
+	VOID	WorkerMain(UINT nThread);
+	VOID	RunTasks(UINT nThread);
+
+	UINT						m_nThreads;
+	std::vector<std::thread>	m_Workers;
+
+	std::mutex					m_CallMutex;		// 동시에 부른 ParallelFor()를 차례로 실행한다
+	std::mutex					m_Mutex;
+	std::condition_variable		m_WakeCond;			// 작업자를 깨운다
+	std::condition_variable		m_DoneCond;			// 호출 스레드에게 완료를 알린다
+	UINT						m_nGeneration;		// ParallelFor() 호출마다 증가
+	UINT						m_nActive;			// 아직 작업 중인 작업자 수
+	bool						m_bQuit;
+
+	const TASKFUNC*				m_pFunc;
+	UINT						m_nCount;
+	std::atomic<UINT>			m_nNext;			// 다음에 가져갈 작업 번호
+};
+
+//-----------------------------------------------------------------------------
+// 작업자 스레드 표시
+// 이 객체가 살아 있는 동안 현재 스레드를 풀이나 로더의 작업자로 취급한다.
+//-----------------------------------------------------------------------------
+class CSwWorkerThreadScope
+{
+public:
+	CSwWorkerThreadScope();
+	~CSwWorkerThreadScope();
+
+	CSwWorkerThreadScope(const CSwWorkerThreadScope&) = delete;
+	CSwWorkerThreadScope& operator=(const CSwWorkerThreadScope&) = delete;
+};
+
+// 현재 스레드가 풀의 작업자(ParallelFor()를 실행 중인 호출 스레드 포함)이거나 로더의 작업자이면 true
+bool			SwIsWorkerThread();
+
+// 풀을 받지 않은 함수가 쓸 공유 풀. 처음 부를 때 하드웨어 스레드 수만큼 만들어 프로세스가 끝날 때까지 쓴다.
+// 현재 스레드가 이미 작업자이면 NULL을 돌려주므로 호출한 쪽은 직렬로 실행한다.
+CSwThreadPool*	SwGetDefaultThreadPool();
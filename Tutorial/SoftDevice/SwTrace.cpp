@@ -0,0 +1,246 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwTrace.cpp
+//
+// 설명:	구간 시간 추적 구현.
+//		스레드 버퍼는 처음 기록할 때 등록하고 프로그램이 끝날 때까지 해제하지 않는다.
+//		스레드가 먼저 끝나도 그 스레드의 이벤트를 내보낼 수 있어야 하기 때문이다.
+//-----------------------------------------------------------------------------
+#include "SwTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool>	g_bSwTraceEnabled(false);
+
+namespace
+{
+	struct TRACEREGISTRY
+	{
+		std::mutex										Mutex;
+		std::vector<std::unique_ptr<SW_TRACEBUFFER> >	Buffers;
+	};
+
+	// 정적 객체의 소멸 순서와 관계없이 끝까지 쓸 수 있도록 해제하지 않는다.
+	TRACEREGISTRY& GetRegistry()
+	{
+		static TRACEREGISTRY* s_pRegistry = new TRACEREGISTRY;
+		return *s_pRegistry;
+	}
+}
+
+SW_TRACEBUFFER* SwTraceRegisterThread()
+{
+	TRACEREGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	std::unique_ptr<SW_TRACEBUFFER> pBuffer(new SW_TRACEBUFFER);
+	pBuffer->nHead.store(0, std::memory_order_relaxed);
+	pBuffer->nThread = (UINT)registry.Buffers.size();
+	SW_TRACEBUFFER* pResult = pBuffer.get();
+	registry.Buffers.push_back(std::move(pBuffer));
+	return pResult;
+}
+
+VOID SwTraceEnable(BOOL bEnable)
+{
+	g_bSwTraceEnabled.store(bEnable != FALSE, std::memory_order_relaxed);
+}
+
+VOID SwTraceReset()
+{
+	TRACEREGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	for (const std::unique_ptr<SW_TRACEBUFFER>& pBuffer : registry.Buffers)
+		pBuffer->nHead.store(0, std::memory_order_relaxed);
+}
+
+UINT64 SwTraceClockNs()
+{
+	using namespace std::chrono;
+	return (UINT64)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+double SwTraceTickNs()
+{
+#if defined(SW_TRACE_RDTSC)
+	// 10ms 동안 두 시계가 간 거리를 비교한다. 요즘 CPU의 TSC는 클럭 변화와 관계없이 일정하게 간다.
+	static const double s_fTickNs = []()
+	{
+		const UINT64 nClock0 = SwTraceClockNs(), nTick0 = SwTraceNow();
+		UINT64 nClock1;
+		while ((nClock1 = SwTraceClockNs()) - nClock0 < 10000000)
+			;
+		const UINT64 nTick1 = SwTraceNow();
+		return (nTick1 > nTick0) ? (double)(nClock1 - nClock0) / (double)(nTick1 - nTick0) : 1.0;
+	}();
+	return s_fTickNs;
+#else
+	return 1.0;
+#endif
+}
+
+VOID SwTraceCollect(std::vector<SW_TRACEEVENT>* pEvents, std::vector<UINT>* pThreads)
+{
+	pEvents->clear();
+	if (pThreads)
+		pThreads->clear();
+
+	TRACEREGISTRY& registry = GetRegistry();
+	std::lock_guard<std::mutex> lock(registry.Mutex);
+	std::vector<SW_TRACEEVENT> copy;
+	for (const std::unique_ptr<SW_TRACEBUFFER>& pBuffer : registry.Buffers)
+	{
+		const UINT64 nHead = pBuffer->nHead.load(std::memory_order_acquire);
+		const UINT64 nFirst = (nHead > SW_TRACE_CAPACITY) ? nHead - SW_TRACE_CAPACITY : 0;
+		copy.resize((size_t)(nHead - nFirst));
+		for (UINT64 i = nFirst; i < nHead; ++i)
+		{
+			const SW_TRACESLOT& slot = pBuffer->Slots[i & (SW_TRACE_CAPACITY - 1)];
+			SW_TRACEEVENT& event = copy[(size_t)(i - nFirst)];
+			event.pName = slot.pName.load(std::memory_order_relaxed);
+			event.nBegin = slot.nBegin.load(std::memory_order_relaxed);
+			event.nEnd = slot.nEnd.load(std::memory_order_relaxed);
+		}
+
+		// 복사하는 동안 기록 스레드가 앞질렀으면 덮어썼을 수 있는 칸은 버린다.
+		// 다음에 쓰일 칸(nHeadAfter)이 담고 있던 이벤트까지 포함한다.
+		// 울타리가 위의 읽기를 nHeadAfter를 읽기 전으로 묶는다. 덮어쓴 값을 읽었다면 SwTraceWrite()의
+		// 울타리 덕분에 그 전에 늘어난 nHead가 보인다.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		const UINT64 nHeadAfter = pBuffer->nHead.load(std::memory_order_relaxed);
+		const UINT64 nValid = (nHeadAfter >= SW_TRACE_CAPACITY) ? nHeadAfter - SW_TRACE_CAPACITY + 1 : 0;
+		for (UINT64 i = std::max(nFirst, nValid); i < nHead; ++i)
+		{
+			pEvents->push_back(copy[(size_t)(i - nFirst)]);
+			if (pThreads)
+				pThreads->push_back(pBuffer->nThread);
+		}
+	}
+}
+
+// JSON 문자열 안에 넣을 수 있도록 따옴표, 역슬래시, 제어 문자를 바꾼다.
+static VOID WriteJsonString(FILE* pFile, const char* p)
+{
+	fputc('"', pFile);
+	for (; *p; ++p)
+	{
+		if (*p == '"' || *p == '\\')
+			fprintf(pFile, "\\%c", *p);
+		else if ((BYTE)*p < 0x20)
+			fprintf(pFile, "\\u%04x", (BYTE)*p);
+		else
+			fputc(*p, pFile);
+	}
+	fputc('"', pFile);
+}
+
+HRESULT SwTraceWriteJson(const char* pFilename)
+{
+	if (pFilename == NULL)
+		return D3DERR_INVALIDCALL;
+
+	std::vector<SW_TRACEEVENT> events;
+	std::vector<UINT> threads;
+	SwTraceCollect(&events, &threads);
+
+	FILE* pFile = fopen(pFilename, "w");
+	if (pFile == NULL)
+		return E_FAIL;
+
+	// 시각은 첫 이벤트를 0으로 한 us 단위다.
+	const double fTickUs = SwTraceTickNs() / 1000.0;
+	UINT64 nOrigin = ~0ull;
+	UINT nNumThreads = 0;
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		nOrigin = std::min(nOrigin, events[i].nBegin);
+		nNumThreads = std::max(nNumThreads, threads[i] + 1);
+	}
+
+	fprintf(pFile, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	for (UINT t = 0; t < nNumThreads; ++t)
+	{
+		fprintf(pFile, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+			"\"args\":{\"name\":\"Thread %u\"}},\n", t, t);
+	}
+	for (size_t i = 0; i < events.size(); ++i)
+	{
+		fprintf(pFile, "{\"name\":");
+		WriteJsonString(pFile, events[i].pName);
+		fprintf(pFile, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}%s\n", threads[i],
+			(events[i].nBegin - nOrigin) * fTickUs, (events[i].nEnd - events[i].nBegin) * fTickUs,
+			(i + 1 < events.size()) ? "," : "");
+	}
+	fprintf(pFile, "]}\n");
+
+	const bool bFailed = ferror(pFile) != 0;
+	if (fclose(pFile) != 0 || bFailed)
+		return E_FAIL;
+	return S_OK;
+}
+
+// 정렬된 값에서 가장 가까운 순위의 백분위 값
+static double Percentile(const std::vector<double>& sorted, double fPercent)
+{
+	size_t nRank = (size_t)std::ceil(fPercent / 100.0 * sorted.size());
+	return sorted[(nRank > 0 ? nRank : 1) - 1];
+}
+
+VOID SwTraceSummarize(std::vector<SW_TRACESTATS>* pStats)
+{
+	std::vector<SW_TRACEEVENT> events;
+	SwTraceCollect(&events, NULL);
+
+	// 같은 문자열이 여러 주소에 있을 수 있으므로 내용으로 묶는다.
+	const double fTickUs = SwTraceTickNs() / 1000.0;
+	std::map<std::string, std::vector<double> > durations;
+	for (const SW_TRACEEVENT& event : events)
+		durations[event.pName].push_back((event.nEnd - event.nBegin) * fTickUs);
+
+	pStats->clear();
+	for (auto& entry : durations)
+	{
+		std::vector<double>& times = entry.second;
+		std::sort(times.begin(), times.end());
+
+		SW_TRACESTATS stats;
+		stats.strName = entry.first;
+		stats.nCount = (UINT)times.size();
+		stats.fTotal = 0.0;
+		for (double fTime : times)
+			stats.fTotal += fTime;
+		stats.fP50 = Percentile(times, 50.0);
+		stats.fP95 = Percentile(times, 95.0);
+		stats.fP99 = Percentile(times, 99.0);
+		stats.fMax = times.back();
+		pStats->push_back(stats);
+	}
+
+	std::sort(pStats->begin(), pStats->end(), [](const SW_TRACESTATS& a, const SW_TRACESTATS& b)
+	{
+		return a.fTotal > b.fTotal;
+	});
+}
+
+std::string SwTraceFormatSummary()
+{
+	std::vector<SW_TRACESTATS> stats;
+	SwTraceSummarize(&stats);
+
+	std::string strSummary;
+	char strLine[256];
+	snprintf(strLine, sizeof(strLine), "%-24s %8s %10s %9s %9s %9s %9s (us)\n", "name", "count", "total", "p50",
+		"p95", "p99", "max");
+	strSummary += strLine;
+	for (const SW_TRACESTATS& s : stats)
+	{
+		snprintf(strLine, sizeof(strLine), "%-24s %8u %10.1f %9.2f %9.2f %9.2f %9.2f\n", s.strName.c_str(),
+			s.nCount, s.fTotal, s.fP50, s.fP95, s.fP99, s.fMax);
+		strSummary += strLine;
+	}
+	return strSummary;
+}
@@ -0,0 +1,181 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwTrace.h
+//
+// 설명:	구간 시간 추적.
+//		SW_TRACE_SCOPE("이름")을 둔 블록의 시작과 끝 시각을 스레드마다 하나인 고정 크기 링 버퍼에
+//		기록한다. 버퍼는 그 스레드만 쓰므로 잠금이 없고, 가득 차면 가장 오래된 이벤트부터 덮어쓴다.
+//		모은 이벤트는 chrome://tracing이나 Perfetto가 읽는 JSON으로 내보내거나 이름별 호출 수와
+//		백분위 시간으로 요약한다.
+//		시각은 x86에서는 RDTSC 틱, 그 밖에서는 steady_clock의 ns로 재고, 내보낼 때 us로 바꾼다.
+//		추적은 SwTraceEnable()로 켜기 전에는 기록하지 않으며 구간마다 플래그 하나를 읽는 비용만 든다.
+//		SW_TRACE를 0으로 정의하고 빌드하면 매크로가 모두 사라진다.
+//
+//		사용 예:
+//			SwTraceEnable(TRUE);
+//			{
+//				SW_TRACE_SCOPE("Render");
+//				...
+//			}
+//			SwTraceWriteJson("frame.json");
+//			OutputDebugStringA(SwTraceFormatSummary().c_str());
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwD3D9Types.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_TRACE_RDTSC
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+#ifndef SW_TRACE
+#define SW_TRACE	1
+#endif
+
+#define SW_TRACE_CAPACITY	(1 << 16)	// 스레드마다 보관하는 이벤트 수
+
+struct SW_TRACEEVENT
+{
+	const char*	pName;		// 문자열 상수여야 한다(주소만 보관한다)
+	UINT64		nBegin;		// SwTraceNow()의 틱
+	UINT64		nEnd;
+};
+
+// 이름별 요약. 시간은 us.
+struct SW_TRACESTATS
+{
+	std::string	strName;
+	UINT		nCount;
+	double		fTotal;
+	double		fP50;
+	double		fP95;
+	double		fP99;
+	double		fMax;
+};
+
+extern std::atomic<bool>	g_bSwTraceEnabled;
+
+inline BOOL	SwTraceIsEnabled() { return g_bSwTraceEnabled.load(std::memory_order_relaxed); }
+VOID		SwTraceEnable(BOOL bEnable);
+// 모든 스레드의 이벤트를 버린다. 기록 중인 스레드가 없을 때 부른다.
+VOID		SwTraceReset();
+
+// steady_clock의 ns
+UINT64		SwTraceClockNs();
+// 틱 하나의 길이(ns). 처음 부를 때 steady_clock과 비교하여 잰다.
+double		SwTraceTickNs();
+
+inline UINT64	SwTraceNow()
+{
+#if defined(SW_TRACE_RDTSC)
+	return __rdtsc();
+#else
+	return SwTraceClockNs();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// 스레드마다 하나인 링 버퍼
+// 그 스레드만 기록하고 SwTraceCollect()가 기록과 동시에 읽을 수 있으므로 칸의 값은 relaxed 원자 변수로 둔다.
+// x86에서는 보통의 저장과 같은 명령이 된다.
+//-----------------------------------------------------------------------------
+struct SW_TRACESLOT
+{
+	std::atomic<const char*>	pName;
+	std::atomic<UINT64>			nBegin;
+	std::atomic<UINT64>			nEnd;
+};
+
+struct SW_TRACEBUFFER
+{
+	SW_TRACESLOT			Slots[SW_TRACE_CAPACITY];
+	std::atomic<UINT64>		nHead;		// 지금까지 기록한 이벤트 수
+	UINT					nThread;	// 처음 기록한 순서
+};
+
+// 이 스레드의 버퍼를 만들어 등록한다. 버퍼는 프로그램이 끝날 때까지 해제하지 않는다.
+SW_TRACEBUFFER*	SwTraceRegisterThread();
+
+inline SW_TRACEBUFFER*	SwTraceGetThreadBuffer()
+{
+	static thread_local SW_TRACEBUFFER* s_pBuffer = NULL;
+	if (s_pBuffer == NULL)
+		s_pBuffer = SwTraceRegisterThread();
+	return s_pBuffer;
+}
+
+// 이 스레드의 버퍼에 이벤트 하나를 쓴다. 가득 찼으면 가장 오래된 이벤트를 덮어쓴다.
+inline VOID	SwTraceWrite(SW_TRACEBUFFER* pBuffer, const char* pName, UINT64 nBegin, UINT64 nEnd)
+{
+	const UINT64 nHead = pBuffer->nHead.load(std::memory_order_relaxed);
+	// 앞에서 저장한 nHead가 이 칸을 덮어쓰는 것보다 먼저 보이게 한다. SwTraceCollect()는 덮어쓴 값을 읽었으면
+	// 늘어난 nHead도 보게 되어 그 칸을 버린다.
+	std::atomic_thread_fence(std::memory_order_release);
+	SW_TRACESLOT& slot = pBuffer->Slots[nHead & (SW_TRACE_CAPACITY - 1)];
+	slot.pName.store(pName, std::memory_order_relaxed);
+	slot.nBegin.store(nBegin, std::memory_order_relaxed);
+	slot.nEnd.store(nEnd, std::memory_order_relaxed);
+	pBuffer->nHead.store(nHead + 1, std::memory_order_release);
+}
+
+inline VOID	SwTraceRecord(const char* pName, UINT64 nBegin, UINT64 nEnd)
+{
+	SwTraceWrite(SwTraceGetThreadBuffer(), pName, nBegin, nEnd);
+}
+
+// 남아 있는 이벤트를 모은다. 다른 스레드가 기록하는 중이어도 되지만 그동안 덮어쓴 이벤트는 빠진다.
+// pThreads에는 이벤트마다 기록한 스레드 번호(처음 기록한 순서)가 들어간다.
+VOID		SwTraceCollect(std::vector<SW_TRACEEVENT>* pEvents, std::vector<UINT>* pThreads);
+// Trace Event 형식(완료 이벤트 "ph":"X")의 JSON 파일로 쓴다.
+HRESULT		SwTraceWriteJson(const char* pFilename);
+// 이름별 요약. 전체 시간이 긴 순서로 정렬한다.
+VOID		SwTraceSummarize(std::vector<SW_TRACESTATS>* pStats);
+std::string	SwTraceFormatSummary();
+
+//-----------------------------------------------------------------------------
+// 구간 하나. 만들 때 추적이 꺼져 있으면 아무것도 기록하지 않는다.
+// 스레드 버퍼는 만들 때 한 번 찾아 두어 끝날 때는 칸에 쓰기만 한다.
+//-----------------------------------------------------------------------------
+class CSwTraceScope
+{
+public:
+	explicit CSwTraceScope(const char* pName)
+		: m_pBuffer(SwTraceIsEnabled() ? SwTraceGetThreadBuffer() : NULL)
+		, m_pName(pName)
+		, m_nBegin(m_pBuffer ? SwTraceNow() : 0)
+	{
+	}
+	~CSwTraceScope()
+	{
+		if (m_pBuffer)
+			SwTraceWrite(m_pBuffer, m_pName, m_nBegin, SwTraceNow());
+	}
+
+	CSwTraceScope(const CSwTraceScope&) = delete;
+	CSwTraceScope& operator=(const CSwTraceScope&) = delete;
+
+private:
+	SW_TRACEBUFFER*	m_pBuffer;
+	const char*		m_pName;
+	UINT64			m_nBegin;
+};
+
+#define SW_TRACE_CONCAT2(a, b)	a##b
+#define SW_TRACE_CONCAT(a, b)	SW_TRACE_CONCAT2(a, b)
+
+// SW_TRACE_CALL("이름", 문장)은 문장 하나만 구간으로 잰다.
+#if SW_TRACE
+#define SW_TRACE_SCOPE(name)	CSwTraceScope SW_TRACE_CONCAT(swTraceScope, __LINE__)(name)
+#define SW_TRACE_CALL(name, ...)	do { SW_TRACE_SCOPE(name); __VA_ARGS__; } while (0)
+#else
+#define SW_TRACE_SCOPE(name)	((void)0)
+#define SW_TRACE_CALL(name, ...)	do { __VA_ARGS__; } while (0)
+#endif
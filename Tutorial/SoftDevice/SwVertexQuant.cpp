@@ -0,0 +1,260 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwVertexQuant.cpp
+//
+// 설명:	정점 양자화 구현.
+//-----------------------------------------------------------------------------
+#include "SwVertexQuant.h"
+
+#include <cfloat>
+#include <cstring>
+
+//-----------------------------------------------------------------------------
+// 보조 함수
+//-----------------------------------------------------------------------------
+
+// 값 하나를 [fBias, fBias + fScale * 65535] 범위의 16비트로 바꾼다.
+static inline WORD QuantizeUnorm16(float f, float fScale, float fBias)
+{
+	if (fScale <= 0.0f)
+		return 0;
+	const float q = (f - fBias) / fScale + 0.5f;
+	return (WORD)(q <= 0.0f ? 0 : (q >= 65535.0f ? 65535 : (UINT)q));
+}
+
+static inline VOID ComputeUnorm16Range(float fMin, float fMax, float* pScale, float* pBias)
+{
+	*pBias = fMin;
+	*pScale = (fMax > fMin) ? (fMax - fMin) / 65535.0f : 0.0f;
+}
+
+// 팔면체 사상으로 부호화한다. 가장 가까운 값으로 반올림하면 각도 오차가 커지는 경우가 있으므로
+// 내림, 올림 네 조합을 복원해 보고 원래 방향에 가장 가까운 것을 고른다.
+static VOID OctahedralEncode(const float* pNormal, short* pOut)
+{
+	const float fL1 = fabsf(pNormal[0]) + fabsf(pNormal[1]) + fabsf(pNormal[2]);
+	if (fL1 <= 0.0f)
+	{
+		pOut[0] = pOut[1] = 0;
+		return;
+	}
+
+	float x = pNormal[0] / fL1;
+	float y = pNormal[1] / fL1;
+	if (pNormal[2] < 0.0f)
+	{
+		const float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		const float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = fx;
+		y = fy;
+	}
+
+	const INT nx = (INT)floorf(x * 32767.0f);
+	const INT ny = (INT)floorf(y * 32767.0f);
+	float fBestDot = -FLT_MAX;
+	for (UINT i = 0; i < 4; ++i)
+	{
+		const short sx = (short)std::max(-32767, std::min(32767, nx + (INT)(i & 1)));
+		const short sy = (short)std::max(-32767, std::min(32767, ny + (INT)(i >> 1)));
+		float n[3];
+		SwOctahedralDecode(sx / 32767.0f, sy / 32767.0f, n);
+		const float fDot = (n[0] * pNormal[0] + n[1] * pNormal[1] + n[2] * pNormal[2]) /
+			sqrtf(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (fDot > fBestDot)
+		{
+			fBestDot = fDot;
+			pOut[0] = sx;
+			pOut[1] = sy;
+		}
+	}
+}
+
+// D3DFVF_PSIZE의 오프셋. 법선 바로 뒤에 온다.
+static inline INT GetPointSizeOffset(const SW_FVFLAYOUT& layout, UINT nPositionSize)
+{
+	if (!(layout.dwFVF & D3DFVF_PSIZE))
+		return -1;
+	if (layout.nNormal < 0)
+		return (INT)nPositionSize;
+	return layout.nNormal + (layout.dwNormalFormat == SW_VQ_OCT16 ? 4 : 12);
+}
+
+//-----------------------------------------------------------------------------
+// 범위 계산
+//-----------------------------------------------------------------------------
+VOID SwComputeVertexQuant(DWORD dwFVF, const BYTE* pVertices, UINT nNumVertices, SW_VERTEXQUANT* pQuant)
+{
+	SW_FVFLAYOUT layout;
+	SwDecodeFVF(dwFVF, &layout);
+
+	float posMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+	float posMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+	float texMin[SW_MAX_FVF_TEXCOORDS][2], texMax[SW_MAX_FVF_TEXCOORDS][2];
+	for (UINT t = 0; t < SW_MAX_FVF_TEXCOORDS; ++t)
+	{
+		texMin[t][0] = texMin[t][1] = FLT_MAX;
+		texMax[t][0] = texMax[t][1] = -FLT_MAX;
+	}
+
+	for (UINT i = 0; i < nNumVertices; ++i)
+	{
+		const BYTE* pVertex = pVertices + (size_t)i * layout.nSize;
+		const float* pPos = (const float*)pVertex;
+		for (UINT c = 0; c < 3; ++c)
+		{
+			posMin[c] = std::min(posMin[c], pPos[c]);
+			posMax[c] = std::max(posMax[c], pPos[c]);
+		}
+		for (UINT t = 0; t < layout.nNumTexCoords; ++t)
+		{
+			const float* pTex = (const float*)(pVertex + layout.nTexCoord[t]);
+			for (UINT c = 0; c < std::min<UINT>(layout.nTexCoordSize[t], 2); ++c)
+			{
+				texMin[t][c] = std::min(texMin[t][c], pTex[c]);
+				texMax[t][c] = std::max(texMax[t][c], pTex[c]);
+			}
+		}
+	}
+
+	for (UINT c = 0; c < 3; ++c)
+	{
+		if (nNumVertices > 0)
+			ComputeUnorm16Range(posMin[c], posMax[c], &pQuant->PositionScale[c], &pQuant->PositionBias[c]);
+		else
+			pQuant->PositionScale[c] = pQuant->PositionBias[c] = 0.0f;
+	}
+	for (UINT t = 0; t < SW_MAX_FVF_TEXCOORDS; ++t)
+	{
+		for (UINT c = 0; c < 2; ++c)
+		{
+			if (t < layout.nNumTexCoords && texMin[t][c] <= texMax[t][c])
+				ComputeUnorm16Range(texMin[t][c], texMax[t][c], &pQuant->TexCoordScale[t][c], &pQuant->TexCoordBias[t][c]);
+			else
+				pQuant->TexCoordScale[t][c] = pQuant->TexCoordBias[t][c] = 0.0f;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 양자화
+//-----------------------------------------------------------------------------
+VOID SwQuantizeVertices(DWORD dwFVF, const SW_VERTEXQUANT* pQuant, const BYTE* pSrc, UINT nNumVertices,
+	BYTE* pDst, SW_QUANTSTATS* pStats)
+{
+	SW_FVFLAYOUT src, dst;
+	SwDecodeFVF(dwFVF, &src);
+	SwDecodeFVF(dwFVF, &dst, pQuant);
+
+	// 위치 요소의 크기(D3DFVF_XYZB*의 혼합 가중치 포함)
+	const UINT nSrcPositionSize = SwGetFVFVertexSize(dwFVF & D3DFVF_POSITION_MASK);
+	const UINT nDstPositionSize = SwGetFVFVertexSize(dwFVF & D3DFVF_POSITION_MASK, pQuant);
+	const INT nSrcPointSize = GetPointSizeOffset(src, nSrcPositionSize);
+	const INT nDstPointSize = GetPointSizeOffset(dst, nDstPositionSize);
+	const SW_VERTEXQUANT& q = dst.Quant;
+
+	float fPositionError = 0.0f;
+	float fNormalError = 0.0f;
+	float fTexCoordError = 0.0f;
+
+	for (UINT i = 0; i < nNumVertices; ++i)
+	{
+		const BYTE* pIn = pSrc + (size_t)i * src.nSize;
+		BYTE* pOut = pDst + (size_t)i * dst.nSize;
+
+		// 위치
+		const float* pPos = (const float*)pIn;
+		if (dst.dwPositionFormat == SW_VQ_HALF)
+		{
+			WORD* p = (WORD*)pOut;
+			for (UINT c = 0; c < 3; ++c)
+				p[c] = SwFloat32To16(pPos[c]);
+			p[3] = 0;
+		}
+		else if (dst.dwPositionFormat == SW_VQ_UNORM16)
+		{
+			WORD* p = (WORD*)pOut;
+			for (UINT c = 0; c < 3; ++c)
+				p[c] = QuantizeUnorm16(pPos[c], q.PositionScale[c], q.PositionBias[c]);
+			p[3] = 0;
+		}
+		else
+		{
+			memcpy(pOut, pIn, nSrcPositionSize);
+		}
+
+		// 법선
+		if (src.nNormal >= 0)
+		{
+			const float* pNormal = (const float*)(pIn + src.nNormal);
+			if (dst.dwNormalFormat == SW_VQ_OCT16)
+				OctahedralEncode(pNormal, (short*)(pOut + dst.nNormal));
+			else
+				memcpy(pOut + dst.nNormal, pNormal, 12);
+		}
+
+		// 점 크기, 색상은 그대로
+		if (nSrcPointSize >= 0)
+			memcpy(pOut + nDstPointSize, pIn + nSrcPointSize, 4);
+		if (src.nDiffuse >= 0)
+			memcpy(pOut + dst.nDiffuse, pIn + src.nDiffuse, 4);
+		if (src.nSpecular >= 0)
+			memcpy(pOut + dst.nSpecular, pIn + src.nSpecular, 4);
+
+		// 텍스처 좌표
+		for (UINT t = 0; t < src.nNumTexCoords; ++t)
+		{
+			const float* pTex = (const float*)(pIn + src.nTexCoord[t]);
+			if (dst.dwTexCoordFormat[t] == SW_VQ_UNORM16)
+			{
+				WORD* p = (WORD*)(pOut + dst.nTexCoord[t]);
+				p[0] = QuantizeUnorm16(pTex[0], q.TexCoordScale[t][0], q.TexCoordBias[t][0]);
+				p[1] = QuantizeUnorm16(pTex[1], q.TexCoordScale[t][1], q.TexCoordBias[t][1]);
+			}
+			else
+			{
+				memcpy(pOut + dst.nTexCoord[t], pTex, src.nTexCoordSize[t] * 4);
+			}
+		}
+
+		if (!pStats)
+			continue;
+
+		// 정점 단계와 같은 방법으로 복원하여 오차를 잰다.
+		float v[3];
+		if (!src.bTransformed)
+		{
+			SwFetchPosition(&dst, pOut, v);
+			for (UINT c = 0; c < 3; ++c)
+				fPositionError = std::max(fPositionError, fabsf(v[c] - pPos[c]));
+		}
+		if (src.nNormal >= 0)
+		{
+			const float* pNormal = (const float*)(pIn + src.nNormal);
+			SwFetchNormal(&dst, pOut, v);
+			if (pNormal[0] != 0.0f || pNormal[1] != 0.0f || pNormal[2] != 0.0f)
+			{
+				// 작은 각도도 정확하도록 atan2(|a x b|, a . b)로 잰다.
+				D3DVECTOR a = SwVec3(pNormal[0], pNormal[1], pNormal[2]);
+				D3DVECTOR b = SwVec3(v[0], v[1], v[2]);
+				D3DVECTOR c;
+				SwVec3Cross(&c, &a, &b);
+				fNormalError = std::max(fNormalError, atan2f(sqrtf(SwVec3Dot(&c, &c)), SwVec3Dot(&a, &b)));
+			}
+		}
+		for (UINT t = 0; t < src.nNumTexCoords; ++t)
+		{
+			float uv[2], uvOut[2];
+			SwFetchTexCoord(&src, pIn, t, uv);
+			SwFetchTexCoord(&dst, pOut, t, uvOut);
+			fTexCoordError = std::max(fTexCoordError, std::max(fabsf(uv[0] - uvOut[0]), fabsf(uv[1] - uvOut[1])));
+		}
+	}
+
+	if (pStats)
+	{
+		pStats->nSrcVertexSize = src.nSize;
+		pStats->nDstVertexSize = dst.nSize;
+		pStats->fPositionError = fPositionError;
+		pStats->fNormalError = fNormalError * (180.0f / SW_PI);
+		pStats->fTexCoordError = fTexCoordError;
+	}
+}
@@ -0,0 +1,144 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwVertexQuant.h
+//
+// 설명:	정점 양자화.
+//		읽어들인 float 정점을 작은 형식으로 바꾸어 정점 단계가 읽는 바이트 수를 줄인다.
+//			위치		half(SW_VQ_HALF) 또는 경계 상자 기준 16비트(SW_VQ_UNORM16), 12 -> 8바이트
+//			법선		팔면체 사상 snorm16 2개(SW_VQ_OCT16), 12 -> 4바이트
+//			텍스처 좌표	좌표 범위 기준 16비트(SW_VQ_UNORM16), 8 -> 4바이트
+//		색상과 점 크기는 그대로 둔다. 위치, 법선, 텍스처 좌표 하나를 갖는 32바이트 정점은 16바이트가 된다.
+//
+//		사용 예:
+//			SW_VERTEXQUANT quant;
+//			ZeroMemory(&quant, sizeof(quant));
+//			quant.dwPosition = SW_VQ_UNORM16;
+//			quant.dwNormal = SW_VQ_OCT16;
+//			quant.dwTexCoord = SW_VQ_UNORM16;
+//			SwComputeVertexQuant(dwFVF, pVertices, nNumVertices, &quant);
+//			... SwGetFVFVertexSize(dwFVF, &quant) * nNumVertices 크기의 정점 버퍼를 만들고 잠근다 ...
+//			SwQuantizeVertices(dwFVF, &quant, pVertices, nNumVertices, pLocked, &stats);
+//			pDevice->SetFVF(dwFVF);
+//			pDevice->SetVertexQuant(&quant);
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwMath.h"
+#include "SwVertexStage.h"
+
+#include <algorithm>
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// 양자화 결과. 오차는 모든 정점에서 복원한 값과 원래 값의 차이 중 가장 큰 것이다.
+//-----------------------------------------------------------------------------
+struct SW_QUANTSTATS
+{
+	UINT	nSrcVertexSize;
+	UINT	nDstVertexSize;
+	float	fPositionError;		// 좌표 성분 하나의 최대 절대 오차(모델 공간 단위)
+	float	fNormalError;		// 법선 방향의 최대 각도 오차(도)
+	float	fTexCoordError;		// 텍스처 좌표 성분 하나의 최대 절대 오차
+};
+
+// pQuant의 형식(dwPosition, dwNormal, dwTexCoord)에 맞추어 정점들의 범위로 복원 상수를 채운다.
+VOID	SwComputeVertexQuant(DWORD dwFVF, const BYTE* pVertices, UINT nNumVertices, SW_VERTEXQUANT* pQuant);
+
+// FVF 순서의 float 정점 nNumVertices개를 양자화하여 pDst에 쓴다.
+// pDst는 SwGetFVFVertexSize(dwFVF, pQuant) * nNumVertices바이트 이상이어야 한다.
+VOID	SwQuantizeVertices(DWORD dwFVF, const SW_VERTEXQUANT* pQuant, const BYTE* pSrc, UINT nNumVertices,
+			BYTE* pDst, SW_QUANTSTATS* pStats = NULL);
+
+//-----------------------------------------------------------------------------
+// 팔면체 사상
+// 단위 벡터를 |x| + |y| + |z| = 1인 팔면체에 투영하고 아래쪽 반을 접어 [-1, 1]^2 정사각형에 펼친다.
+// 복원한 벡터는 팔면체 위의 점이므로 길이가 1이 아니다. 정점 단계는 월드 변환 뒤에 어차피 정규화하므로
+// 여기서는 정규화하지 않는다.
+//-----------------------------------------------------------------------------
+inline VOID SwOctahedralDecode(float x, float y, float* pOut)
+{
+	const float z = 1.0f - fabsf(x) - fabsf(y);
+	if (z < 0.0f)
+	{
+		const float fx = (1.0f - fabsf(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		const float fy = (1.0f - fabsf(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+		x = fx;
+		y = fy;
+	}
+	pOut[0] = x;
+	pOut[1] = y;
+	pOut[2] = z;
+}
+
+//-----------------------------------------------------------------------------
+// 정점 요소 읽기. 정점 단계와 양자화 오차 측정이 함께 쓴다.
+//-----------------------------------------------------------------------------
+inline VOID SwFetchPosition(const SW_FVFLAYOUT* pLayout, const BYTE* pVertex, float* pOut)
+{
+	switch (pLayout->dwPositionFormat)
+	{
+	case SW_VQ_HALF:
+	{
+		const WORD* p = (const WORD*)pVertex;
+		pOut[0] = SwFloat16To32(p[0]);
+		pOut[1] = SwFloat16To32(p[1]);
+		pOut[2] = SwFloat16To32(p[2]);
+		break;
+	}
+	case SW_VQ_UNORM16:
+	{
+		const WORD* p = (const WORD*)pVertex;
+		const SW_VERTEXQUANT& q = pLayout->Quant;
+		pOut[0] = p[0] * q.PositionScale[0] + q.PositionBias[0];
+		pOut[1] = p[1] * q.PositionScale[1] + q.PositionBias[1];
+		pOut[2] = p[2] * q.PositionScale[2] + q.PositionBias[2];
+		break;
+	}
+	default:
+	{
+		const float* p = (const float*)pVertex;
+		pOut[0] = p[0];
+		pOut[1] = p[1];
+		pOut[2] = p[2];
+		break;
+	}
+	}
+}
+
+// 법선이 없으면 false. 양자화한 법선은 길이가 1이 아닐 수 있다.
+inline bool SwFetchNormal(const SW_FVFLAYOUT* pLayout, const BYTE* pVertex, float* pOut)
+{
+	if (pLayout->nNormal < 0)
+		return false;
+
+	if (pLayout->dwNormalFormat == SW_VQ_OCT16)
+	{
+		const short* p = (const short*)(pVertex + pLayout->nNormal);
+		SwOctahedralDecode(std::max(p[0] * (1.0f / 32767.0f), -1.0f), std::max(p[1] * (1.0f / 32767.0f), -1.0f), pOut);
+	}
+	else
+	{
+		const float* p = (const float*)(pVertex + pLayout->nNormal);
+		pOut[0] = p[0];
+		pOut[1] = p[1];
+		pOut[2] = p[2];
+	}
+	return true;
+}
+
+// 텍스처 좌표 집합 t의 u, v. 1차원 좌표면 v는 0이다.
+inline VOID SwFetchTexCoord(const SW_FVFLAYOUT* pLayout, const BYTE* pVertex, UINT t, float* pOut)
+{
+	if (pLayout->dwTexCoordFormat[t] == SW_VQ_UNORM16)
+	{
+		const WORD* p = (const WORD*)(pVertex + pLayout->nTexCoord[t]);
+		const SW_VERTEXQUANT& q = pLayout->Quant;
+		pOut[0] = p[0] * q.TexCoordScale[t][0] + q.TexCoordBias[t][0];
+		pOut[1] = p[1] * q.TexCoordScale[t][1] + q.TexCoordBias[t][1];
+	}
+	else
+	{
+		const float* p = (const float*)(pVertex + pLayout->nTexCoord[t]);
+		pOut[0] = p[0];
+		pOut[1] = (pLayout->nTexCoordSize[t] > 1) ? p[1] : 0.0f;
+	}
+}
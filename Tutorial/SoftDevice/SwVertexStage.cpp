@@ -0,0 +1,322 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwVertexStage.cpp
+//
+// 설명:	고정 기능 정점 단계 구현.
+//-----------------------------------------------------------------------------
+#include "SwVertexStage.h"
+#include "SwMath.h"
+#include "SwVertexQuant.h"
+
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// FVF 해석
+//-----------------------------------------------------------------------------
+VOID SwDecodeFVF(DWORD dwFVF, SW_FVFLAYOUT* pLayout, const SW_VERTEXQUANT* pQuant)
+{
+	ZeroMemory(pLayout, sizeof(SW_FVFLAYOUT));
+	pLayout->dwFVF = dwFVF;
+	pLayout->nNormal = pLayout->nDiffuse = pLayout->nSpecular = -1;
+	if (pQuant)
+		pLayout->Quant = *pQuant;
+
+	UINT nOffset = 0;
+	switch (dwFVF & D3DFVF_POSITION_MASK)
+	{
+	case D3DFVF_XYZ:
+		// 양자화한 위치는 4번째 성분을 채워 8바이트로 맞춘다.
+		if (pQuant && (pQuant->dwPosition == SW_VQ_HALF || pQuant->dwPosition == SW_VQ_UNORM16))
+			pLayout->dwPositionFormat = pQuant->dwPosition;
+		nOffset = (pLayout->dwPositionFormat != SW_VQ_FLOAT) ? 8 : 12;
+		break;
+	case D3DFVF_XYZRHW:	nOffset = 16;	pLayout->bTransformed = TRUE;	break;
+	case D3DFVF_XYZW:	nOffset = 16;	break;
+	case D3DFVF_XYZB1:	nOffset = 16;	break;
+	case D3DFVF_XYZB2:	nOffset = 20;	break;
+	case D3DFVF_XYZB3:	nOffset = 24;	break;
+	case D3DFVF_XYZB4:	nOffset = 28;	break;
+	case D3DFVF_XYZB5:	nOffset = 32;	break;
+	}
+
+	if (dwFVF & D3DFVF_NORMAL)
+	{
+		pLayout->nNormal = (INT)nOffset;
+		if (pQuant && pQuant->dwNormal == SW_VQ_OCT16)
+			pLayout->dwNormalFormat = SW_VQ_OCT16;
+		nOffset += (pLayout->dwNormalFormat == SW_VQ_OCT16) ? 4 : 12;
+	}
+	if (dwFVF & D3DFVF_PSIZE)
+		nOffset += 4;
+	if (dwFVF & D3DFVF_DIFFUSE)
+	{
+		pLayout->nDiffuse = (INT)nOffset;
+		nOffset += 4;
+	}
+	if (dwFVF & D3DFVF_SPECULAR)
+	{
+		pLayout->nSpecular = (INT)nOffset;
+		nOffset += 4;
+	}
+
+	// D3DFVF_TEXCOORDSIZEn 비트: 0 = 2개, 1 = 3개, 2 = 4개, 3 = 1개
+	static const UINT s_TexFormatSize[4] = { 2, 3, 4, 1 };
+	UINT nNumTex = (dwFVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT;
+	if (nNumTex > SW_MAX_FVF_TEXCOORDS)
+		nNumTex = SW_MAX_FVF_TEXCOORDS;
+	pLayout->nNumTexCoords = nNumTex;
+	for (UINT i = 0; i < nNumTex; ++i)
+	{
+		UINT nSize = s_TexFormatSize[(dwFVF >> (i * 2 + 16)) & 3];
+		pLayout->nTexCoord[i] = (INT)nOffset;
+		pLayout->nTexCoordSize[i] = nSize;
+		if (pQuant && pQuant->dwTexCoord == SW_VQ_UNORM16 && nSize == 2)
+		{
+			pLayout->dwTexCoordFormat[i] = SW_VQ_UNORM16;
+			nOffset += 4;
+		}
+		else
+		{
+			nOffset += nSize * 4;
+		}
+	}
+
+	pLayout->nSize = nOffset;
+}
+
+UINT SwGetFVFVertexSize(DWORD dwFVF, const SW_VERTEXQUANT* pQuant)
+{
+	SW_FVFLAYOUT layout;
+	SwDecodeFVF(dwFVF, &layout, pQuant);
+	return layout.nSize;
+}
+
+//-----------------------------------------------------------------------------
+// 보조 함수
+//-----------------------------------------------------------------------------
+static inline float Saturate(float f)
+{
+	return f < 0.0f ? 0.0f : (f > 1.0f ? 1.0f : f);
+}
+
+// 재질 색 원천(D3DMCS_*)에 따라 재질 색이나 정점 색을 고른다.
+static inline const float* SelectSource(DWORD dwSource, const D3DCOLORVALUE& mtrl,
+	const float* pDiffuse, const float* pSpecular)
+{
+	if (dwSource == D3DMCS_COLOR1 && pDiffuse)
+		return pDiffuse;
+	if (dwSource == D3DMCS_COLOR2 && pSpecular)
+		return pSpecular;
+	return &mtrl.r;
+}
+
+//-----------------------------------------------------------------------------
+// 광원 계산
+// pPos, pNormal은 월드 공간 좌표다. pNormal이 NULL이면 확산광 항은 0이 된다.
+//-----------------------------------------------------------------------------
+static VOID ComputeLighting(const SW_VERTEXSTATE* pState, const D3DVECTOR* pPos,
+	const D3DVECTOR* pNormal, const float* pMtrlDiffuse, const float* pMtrlAmbient,
+	const float* pMtrlEmissive, float* pOut)
+{
+	float r = pMtrlEmissive[0] + pState->Ambient.r * pMtrlAmbient[0];
+	float g = pMtrlEmissive[1] + pState->Ambient.g * pMtrlAmbient[1];
+	float b = pMtrlEmissive[2] + pState->Ambient.b * pMtrlAmbient[2];
+
+	for (UINT i = 0; i < pState->nNumLights; ++i)
+	{
+		const D3DLIGHT9& light = pState->Lights[i];
+
+		D3DVECTOR L;
+		float fAtten = 1.0f;
+		if (light.Type == D3DLIGHT_DIRECTIONAL)
+		{
+			L = SwVec3(-light.Direction.x, -light.Direction.y, -light.Direction.z);
+			SwVec3Normalize(&L, &L);
+		}
+		else
+		{
+			L = SwVec3(light.Position.x - pPos->x, light.Position.y - pPos->y, light.Position.z - pPos->z);
+			float fDist = sqrtf(SwVec3Dot(&L, &L));
+			if (fDist > light.Range)
+				continue;
+			if (fDist > 0.0f)
+				L = SwVec3(L.x / fDist, L.y / fDist, L.z / fDist);
+
+			float fDen = light.Attenuation0 + light.Attenuation1 * fDist + light.Attenuation2 * fDist * fDist;
+			fAtten = (fDen > 0.0f) ? 1.0f / fDen : 1.0f;
+
+			if (light.Type == D3DLIGHT_SPOT)
+			{
+				D3DVECTOR D;
+				SwVec3Normalize(&D, &light.Direction);
+				float rho = -SwVec3Dot(&L, &D);
+				float fCosPhi = cosf(light.Phi * 0.5f);
+				float fCosTheta = cosf(light.Theta * 0.5f);
+				if (rho <= fCosPhi)
+					continue;
+				if (rho < fCosTheta && fCosTheta > fCosPhi)
+					fAtten *= powf((rho - fCosPhi) / (fCosTheta - fCosPhi), light.Falloff);
+			}
+		}
+
+		r += light.Ambient.r * pMtrlAmbient[0] * fAtten;
+		g += light.Ambient.g * pMtrlAmbient[1] * fAtten;
+		b += light.Ambient.b * pMtrlAmbient[2] * fAtten;
+
+		if (pNormal)
+		{
+			float fNdotL = SwVec3Dot(pNormal, &L);
+			if (fNdotL > 0.0f)
+			{
+				float f = fNdotL * fAtten;
+				r += light.Diffuse.r * pMtrlDiffuse[0] * f;
+				g += light.Diffuse.g * pMtrlDiffuse[1] * f;
+				b += light.Diffuse.b * pMtrlDiffuse[2] * f;
+			}
+		}
+	}
+
+	pOut[0] = Saturate(r);
+	pOut[1] = Saturate(g);
+	pOut[2] = Saturate(b);
+	pOut[3] = Saturate(pMtrlDiffuse[3]);
+}
+
+VOID SwLightVertex(const SW_VERTEXSTATE* pState, const D3DVECTOR* pPos, const D3DVECTOR* pNormal,
+	const float* pDiffuse, const float* pSpecular, float* pOut)
+{
+	// D3DRS_COLORVERTEX가 꺼져 있으면 정점 색을 재질 색으로 쓰지 않는다.
+	const float* pVtxDiffuse = pState->bColorVertex ? pDiffuse : NULL;
+	const float* pVtxSpecular = pState->bColorVertex ? pSpecular : NULL;
+	const D3DMATERIAL9& mtrl = pState->Material;
+
+	ComputeLighting(pState, pPos, pNormal,
+		SelectSource(pState->dwDiffuseSource, mtrl.Diffuse, pVtxDiffuse, pVtxSpecular),
+		SelectSource(pState->dwAmbientSource, mtrl.Ambient, pVtxDiffuse, pVtxSpecular),
+		SelectSource(pState->dwEmissiveSource, mtrl.Emissive, pVtxDiffuse, pVtxSpecular),
+		pOut);
+}
+
+//-----------------------------------------------------------------------------
+// 정점 처리
+//-----------------------------------------------------------------------------
+VOID SwProcessVertices(const SW_VERTEXSTATE* pState, const SW_FVFLAYOUT* pLayout,
+	const BYTE* pSrc, UINT nStride, UINT nCount, SW_VERTEX* pDst)
+{
+	const D3DMATRIX& W = pState->matWorld;
+	const BOOL bLighting = pState->bLighting && !pLayout->bTransformed;
+
+	// 16비트 위치의 복원(q * Scale + Bias)은 아핀 변환이므로 위치에 쓰는 행렬에 미리 곱해 두고
+	// 정점마다 정수를 float로 바꾸기만 한다. 법선은 원래 월드 행렬로 변환한다.
+	D3DMATRIX PW = W;
+	D3DMATRIX M = pState->matWorldViewProj;
+	const BOOL bUnorm16Position = (pLayout->dwPositionFormat == SW_VQ_UNORM16);
+	if (bUnorm16Position)
+	{
+		const SW_VERTEXQUANT& q = pLayout->Quant;
+		D3DMATRIX Q;
+		SwMatrixIdentity(&Q);
+		Q._11 = q.PositionScale[0];
+		Q._22 = q.PositionScale[1];
+		Q._33 = q.PositionScale[2];
+		Q._41 = q.PositionBias[0];
+		Q._42 = q.PositionBias[1];
+		Q._43 = q.PositionBias[2];
+		SwMatrixMultiply(&PW, &Q, &W);
+		SwMatrixMultiply(&M, &Q, &pState->matWorldViewProj);
+	}
+
+	for (UINT n = 0; n < nCount; ++n, pSrc += nStride)
+	{
+		SW_VERTEX& out = pDst[n];
+		float pos[3] = { 0.0f, 0.0f, 0.0f };
+
+		if (pLayout->bTransformed)
+		{
+			// 변환이 끝난 정점: 화면 좌표와 rhw를 그대로 사용한다.
+			const float* pRHW = (const float*)pSrc;
+			out.x = pRHW[0];
+			out.y = pRHW[1];
+			out.z = pRHW[2];
+			out.w = (pRHW[3] != 0.0f) ? 1.0f / pRHW[3] : 1.0f;
+		}
+		else
+		{
+			if (bUnorm16Position)
+			{
+				const WORD* p = (const WORD*)pSrc;
+				pos[0] = p[0];
+				pos[1] = p[1];
+				pos[2] = p[2];
+			}
+			else
+			{
+				SwFetchPosition(pLayout, pSrc, pos);
+			}
+			float x = pos[0], y = pos[1], z = pos[2];
+			out.x = x * M._11 + y * M._21 + z * M._31 + M._41;
+			out.y = x * M._12 + y * M._22 + z * M._32 + M._42;
+			out.z = x * M._13 + y * M._23 + z * M._33 + M._43;
+			out.w = x * M._14 + y * M._24 + z * M._34 + M._44;
+		}
+
+		float diffuse[4], specular[4];
+		const float* pDiffuse = NULL;
+		const float* pSpecular = NULL;
+		if (pLayout->nDiffuse >= 0)
+		{
+			SwUnpackColor(*(const DWORD*)(pSrc + pLayout->nDiffuse), diffuse);
+			pDiffuse = diffuse;
+		}
+		if (pLayout->nSpecular >= 0)
+		{
+			SwUnpackColor(*(const DWORD*)(pSrc + pLayout->nSpecular), specular);
+			pSpecular = specular;
+		}
+
+		if (bLighting)
+		{
+			D3DVECTOR P;
+			P.x = pos[0] * PW._11 + pos[1] * PW._21 + pos[2] * PW._31 + PW._41;
+			P.y = pos[0] * PW._12 + pos[1] * PW._22 + pos[2] * PW._32 + PW._42;
+			P.z = pos[0] * PW._13 + pos[1] * PW._23 + pos[2] * PW._33 + PW._43;
+
+			D3DVECTOR N;
+			const D3DVECTOR* pN = NULL;
+			float srcN[3];
+			if (SwFetchNormal(pLayout, pSrc, srcN))
+			{
+				N.x = srcN[0] * W._11 + srcN[1] * W._21 + srcN[2] * W._31;
+				N.y = srcN[0] * W._12 + srcN[1] * W._22 + srcN[2] * W._32;
+				N.z = srcN[0] * W._13 + srcN[1] * W._23 + srcN[2] * W._33;
+				SwVec3Normalize(&N, &N);
+				pN = &N;
+			}
+
+			SwLightVertex(pState, &P, pN, pDiffuse, pSpecular, out.color);
+		}
+		else if (pDiffuse)
+		{
+			out.color[0] = diffuse[0];
+			out.color[1] = diffuse[1];
+			out.color[2] = diffuse[2];
+			out.color[3] = diffuse[3];
+		}
+		else
+		{
+			// 정점 색이 없으면 흰색
+			out.color[0] = out.color[1] = out.color[2] = out.color[3] = 1.0f;
+		}
+
+		for (UINT t = 0; t < SW_MAX_TEXCOORDS; ++t)
+		{
+			if (t < pLayout->nNumTexCoords)
+			{
+				SwFetchTexCoord(pLayout, pSrc, t, out.tex[t]);
+			}
+			else
+			{
+				out.tex[t][0] = out.tex[t][1] = 0.0f;
+			}
+		}
+	}
+}
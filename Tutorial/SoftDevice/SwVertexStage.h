@@ -0,0 +1,102 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwVertexStage.h
+//
+// 설명:	고정 기능 정점 단계(변환과 광원 처리).
+//		FVF 값으로 정점의 구성을 해석하고 월드, 뷰, 프로젝션 변환과
+//		방향성/점/점적 광원 계산을 수행하여 SW_VERTEX로 출력한다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwPipeline.h"
+
+#define SW_MAX_FVF_TEXCOORDS	8
+
+//-----------------------------------------------------------------------------
+// 양자화한 정점 요소의 저장 형식
+// FVF는 어떤 요소가 있는지만 정하고, 요소를 어떤 형식으로 저장했는지는 SW_VERTEXQUANT가 정한다.
+// 요소의 순서는 FVF와 같고 크기만 달라진다.
+//-----------------------------------------------------------------------------
+#define SW_VQ_FLOAT		0	// FVF 그대로(float)
+#define SW_VQ_HALF		1	// 위치: half x, y, z, 0 (8바이트)
+#define SW_VQ_UNORM16	2	// 위치: 경계 상자 기준 16비트 x, y, z, 0 (8바이트)
+							// 텍스처 좌표: 좌표 범위 기준 16비트 u, v (4바이트)
+#define SW_VQ_OCT16		3	// 법선: 팔면체 사상한 snorm16 2개 (4바이트)
+
+// 요소가 값 q(0 ~ 65535)로 저장되어 있으면 원래 값은 q * Scale + Bias다.
+struct SW_VERTEXQUANT
+{
+	DWORD	dwPosition;							// SW_VQ_FLOAT, SW_VQ_HALF, SW_VQ_UNORM16. D3DFVF_XYZ에만 쓴다.
+	DWORD	dwNormal;							// SW_VQ_FLOAT, SW_VQ_OCT16
+	DWORD	dwTexCoord;							// SW_VQ_FLOAT, SW_VQ_UNORM16. 2차원 좌표 집합에만 쓴다.
+	float	PositionScale[3];
+	float	PositionBias[3];
+	float	TexCoordScale[SW_MAX_FVF_TEXCOORDS][2];
+	float	TexCoordBias[SW_MAX_FVF_TEXCOORDS][2];
+};
+
+//-----------------------------------------------------------------------------
+// FVF 값을 해석한 정점 구성(각 요소의 바이트 오프셋, 없으면 -1)
+//-----------------------------------------------------------------------------
+struct SW_FVFLAYOUT
+{
+	DWORD	dwFVF;
+	UINT	nSize;								// 정점 하나의 크기
+	BOOL	bTransformed;						// D3DFVF_XYZRHW
+	INT		nNormal;
+	INT		nDiffuse;
+	INT		nSpecular;
+	UINT	nNumTexCoords;
+	INT		nTexCoord[SW_MAX_FVF_TEXCOORDS];
+	UINT	nTexCoordSize[SW_MAX_FVF_TEXCOORDS];	// 좌표 집합의 float 개수(1 ~ 4)
+
+	// 요소마다 실제로 쓰는 저장 형식(SW_VQ_*)과 복원 상수. 양자화하지 않았으면 모두 SW_VQ_FLOAT다.
+	DWORD			dwPositionFormat;
+	DWORD			dwNormalFormat;
+	DWORD			dwTexCoordFormat[SW_MAX_FVF_TEXCOORDS];
+	SW_VERTEXQUANT	Quant;
+};
+
+// pQuant가 있으면 그 형식으로 저장된 정점의 구성을 만든다.
+// 형식을 쓸 수 없는 요소(변환된 위치, 2차원이 아닌 텍스처 좌표 등)는 float로 남는다.
+VOID	SwDecodeFVF(DWORD dwFVF, SW_FVFLAYOUT* pLayout, const SW_VERTEXQUANT* pQuant = NULL);
+UINT	SwGetFVFVertexSize(DWORD dwFVF, const SW_VERTEXQUANT* pQuant = NULL);
+
+//-----------------------------------------------------------------------------
+// 정점 단계에 필요한 디바이스 상태
+// 광원은 월드 공간에서 계산하므로 디바이스가 켜진 광원만 모아서 넘겨준다.
+//-----------------------------------------------------------------------------
+struct SW_VERTEXSTATE
+{
+	D3DMATRIX		matWorld;
+	D3DMATRIX		matWorldViewProj;
+
+	BOOL			bLighting;
+	BOOL			bColorVertex;
+	DWORD			dwDiffuseSource;			// D3DMCS_*
+	DWORD			dwAmbientSource;
+	DWORD			dwEmissiveSource;
+	D3DCOLORVALUE	Ambient;					// D3DRS_AMBIENT
+	D3DMATERIAL9	Material;
+
+	UINT			nNumLights;
+	D3DLIGHT9		Lights[SW_MAX_LIGHTS];
+};
+
+// D3DCOLOR(ARGB)를 r, g, b, a(0.0 ~ 1.0)로 푼다.
+inline VOID SwUnpackColor(DWORD c, float* pOut)
+{
+	const float fInv = 1.0f / 255.0f;
+	pOut[0] = ((c >> 16) & 0xff) * fInv;
+	pOut[1] = ((c >> 8) & 0xff) * fInv;
+	pOut[2] = (c & 0xff) * fInv;
+	pOut[3] = ((c >> 24) & 0xff) * fInv;
+}
+
+// 월드 공간의 위치 pPos, 단위 법선 pNormal(없으면 NULL)인 정점의 색을 계산한다.
+// pDiffuse, pSpecular는 정점 색(없으면 NULL)이다.
+VOID	SwLightVertex(const SW_VERTEXSTATE* pState, const D3DVECTOR* pPos, const D3DVECTOR* pNormal,
+			const float* pDiffuse, const float* pSpecular, float* pOut);
+
+// pSrc에서 nCount개의 정점을 읽어 pDst에 변환된 정점을 쓴다.
+VOID	SwProcessVertices(const SW_VERTEXSTATE* pState, const SW_FVFLAYOUT* pLayout,
+			const BYTE* pSrc, UINT nStride, UINT nCount, SW_VERTEX* pDst);
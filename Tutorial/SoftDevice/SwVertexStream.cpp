@@ -0,0 +1,507 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwVertexStream.cpp
+//
+// 설명:	SoA 정점 배열 변환과 SoA 정점 단계 구현.
+//		정점 단계는 SW_VERTEXSTREAM_WIDTH(4)개 정점을 레인 하나씩 맡아 처리한다.
+//		x86에서는 기본 명령어 집합인 SSE2로, 그 외에는 같은 코드를 float 4개짜리 구조체로 실행한다.
+//-----------------------------------------------------------------------------
+#include "SwVertexStream.h"
+#include "SwMath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define SW_X86
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// 4레인 float 연산
+// 비교 결과(마스크)는 참인 레인의 모든 비트가 1인 값이다.
+//-----------------------------------------------------------------------------
+#ifdef SW_X86
+
+typedef __m128 VFLOAT;
+
+static inline VFLOAT VSet(float f)						{ return _mm_set1_ps(f); }
+static inline VFLOAT VLoad(const float* p)				{ return _mm_loadu_ps(p); }
+static inline VOID VStore(float* p, VFLOAT a)			{ _mm_storeu_ps(p, a); }
+static inline VFLOAT VAdd(VFLOAT a, VFLOAT b)			{ return _mm_add_ps(a, b); }
+static inline VFLOAT VSub(VFLOAT a, VFLOAT b)			{ return _mm_sub_ps(a, b); }
+static inline VFLOAT VMul(VFLOAT a, VFLOAT b)			{ return _mm_mul_ps(a, b); }
+static inline VFLOAT VDiv(VFLOAT a, VFLOAT b)			{ return _mm_div_ps(a, b); }
+static inline VFLOAT VSqrt(VFLOAT a)					{ return _mm_sqrt_ps(a); }
+static inline VFLOAT VMin(VFLOAT a, VFLOAT b)			{ return _mm_min_ps(a, b); }
+static inline VFLOAT VMax(VFLOAT a, VFLOAT b)			{ return _mm_max_ps(a, b); }
+static inline VFLOAT VGreater(VFLOAT a, VFLOAT b)		{ return _mm_cmpgt_ps(a, b); }
+static inline VFLOAT VLessEqual(VFLOAT a, VFLOAT b)		{ return _mm_cmple_ps(a, b); }
+static inline VFLOAT VNotEqual(VFLOAT a, VFLOAT b)		{ return _mm_cmpneq_ps(a, b); }
+static inline VFLOAT VAnd(VFLOAT a, VFLOAT b)			{ return _mm_and_ps(a, b); }
+static inline bool VAny(VFLOAT mask)					{ return _mm_movemask_ps(mask) != 0; }
+
+// mask ? a : b
+static inline VFLOAT VSelect(VFLOAT mask, VFLOAT a, VFLOAT b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+// A8R8G8B8 색 4개를 r, g, b, a 배열로 푼다.
+static inline VOID VUnpackColor(const DWORD* p, VFLOAT* pOut)
+{
+	const __m128i c = _mm_loadu_si128((const __m128i*)p);
+	const __m128i mask = _mm_set1_epi32(0xff);
+	const __m128 fInv = _mm_set1_ps(1.0f / 255.0f);
+	pOut[0] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(c, 16), mask)), fInv);
+	pOut[1] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(c, 8), mask)), fInv);
+	pOut[2] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(c, mask)), fInv);
+	pOut[3] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(c, 24)), fInv);
+}
+
+// 레인 i의 (a, b, c, d)를 ppDst[i]에 쓴다.
+static inline VOID VStoreTransposed(float* const* ppDst, VFLOAT a, VFLOAT b, VFLOAT c, VFLOAT d)
+{
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+	_mm_storeu_ps(ppDst[0], a);
+	_mm_storeu_ps(ppDst[1], b);
+	_mm_storeu_ps(ppDst[2], c);
+	_mm_storeu_ps(ppDst[3], d);
+}
+
+#else
+
+struct VFLOAT
+{
+	float f[4];
+};
+
+#define SW_VFLOAT_OP(expr)	VFLOAT r; for (int i = 0; i < 4; ++i) r.f[i] = (expr); return r
+
+static inline float MaskOf(bool b)
+{
+	union { DWORD n; float f; } u;
+	u.n = b ? 0xffffffff : 0;
+	return u.f;
+}
+
+static inline bool IsSet(float f)
+{
+	union { float f; DWORD n; } u;
+	u.f = f;
+	return u.n != 0;
+}
+
+static inline VFLOAT VSet(float f)						{ SW_VFLOAT_OP(f); }
+static inline VFLOAT VLoad(const float* p)				{ SW_VFLOAT_OP(p[i]); }
+static inline VOID VStore(float* p, VFLOAT a)			{ memcpy(p, a.f, sizeof(a.f)); }
+static inline VFLOAT VAdd(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(a.f[i] + b.f[i]); }
+static inline VFLOAT VSub(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(a.f[i] - b.f[i]); }
+static inline VFLOAT VMul(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(a.f[i] * b.f[i]); }
+static inline VFLOAT VDiv(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(a.f[i] / b.f[i]); }
+static inline VFLOAT VSqrt(VFLOAT a)					{ SW_VFLOAT_OP(sqrtf(a.f[i])); }
+static inline VFLOAT VMin(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(a.f[i] < b.f[i] ? a.f[i] : b.f[i]); }
+static inline VFLOAT VMax(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(a.f[i] > b.f[i] ? a.f[i] : b.f[i]); }
+static inline VFLOAT VGreater(VFLOAT a, VFLOAT b)		{ SW_VFLOAT_OP(MaskOf(a.f[i] > b.f[i])); }
+static inline VFLOAT VLessEqual(VFLOAT a, VFLOAT b)		{ SW_VFLOAT_OP(MaskOf(a.f[i] <= b.f[i])); }
+static inline VFLOAT VNotEqual(VFLOAT a, VFLOAT b)		{ SW_VFLOAT_OP(MaskOf(a.f[i] != b.f[i])); }
+static inline VFLOAT VAnd(VFLOAT a, VFLOAT b)			{ SW_VFLOAT_OP(MaskOf(IsSet(a.f[i]) && IsSet(b.f[i]))); }
+static inline VFLOAT VSelect(VFLOAT mask, VFLOAT a, VFLOAT b)	{ SW_VFLOAT_OP(IsSet(mask.f[i]) ? a.f[i] : b.f[i]); }
+
+static inline bool VAny(VFLOAT mask)
+{
+	return IsSet(mask.f[0]) || IsSet(mask.f[1]) || IsSet(mask.f[2]) || IsSet(mask.f[3]);
+}
+
+static inline VOID VUnpackColor(const DWORD* p, VFLOAT* pOut)
+{
+	const float fInv = 1.0f / 255.0f;
+	for (int i = 0; i < 4; ++i)
+	{
+		pOut[0].f[i] = ((p[i] >> 16) & 0xff) * fInv;
+		pOut[1].f[i] = ((p[i] >> 8) & 0xff) * fInv;
+		pOut[2].f[i] = (p[i] & 0xff) * fInv;
+		pOut[3].f[i] = ((p[i] >> 24) & 0xff) * fInv;
+	}
+}
+
+static inline VOID VStoreTransposed(float* const* ppDst, VFLOAT a, VFLOAT b, VFLOAT c, VFLOAT d)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		ppDst[i][0] = a.f[i];
+		ppDst[i][1] = b.f[i];
+		ppDst[i][2] = c.f[i];
+		ppDst[i][3] = d.f[i];
+	}
+}
+
+#undef SW_VFLOAT_OP
+
+#endif	// SW_X86
+
+// 레인마다 powf. 점적 광원의 Falloff가 1이 아닐 때만 쓴다.
+static inline VFLOAT VPow(VFLOAT a, float fExp)
+{
+	float f[SW_VERTEXSTREAM_WIDTH];
+	VStore(f, a);
+	for (int i = 0; i < SW_VERTEXSTREAM_WIDTH; ++i)
+		f[i] = powf(f[i], fExp);
+	return VLoad(f);
+}
+
+static inline VFLOAT VSaturate(VFLOAT a)
+{
+	return VMin(VMax(a, VSet(0.0f)), VSet(1.0f));
+}
+
+//-----------------------------------------------------------------------------
+// CSwVertexStreams
+//-----------------------------------------------------------------------------
+CSwVertexStreams::CSwVertexStreams()
+{
+	ZeroMemory(&m_Layout, sizeof(m_Layout));
+	ZeroMemory(&m_Streams, sizeof(m_Streams));
+}
+
+HRESULT CSwVertexStreams::Create(DWORD dwFVF, UINT nNumVertices)
+{
+	m_Storage.reset();
+	ZeroMemory(&m_Streams, sizeof(m_Streams));
+
+	const DWORD dwPosition = dwFVF & D3DFVF_POSITION_MASK;
+	if (dwPosition != D3DFVF_XYZ && dwPosition != D3DFVF_XYZRHW && dwPosition != D3DFVF_XYZW)
+		return E_FAIL;
+	SwDecodeFVF(dwFVF, &m_Layout);
+
+	// 배열 하나의 크기: 처리 폭만큼 여유를 두어 어느 정점에서 시작한 묶음도 배열 안에서 읽게 하고
+	// 정렬 단위로 맞춘다.
+	const size_t nLanes = (size_t)nNumVertices + SW_VERTEXSTREAM_WIDTH;
+	const size_t nArraySize = (nLanes * 4 + SW_VERTEXSTREAM_ALIGNMENT - 1) / SW_VERTEXSTREAM_ALIGNMENT * SW_VERTEXSTREAM_ALIGNMENT;
+
+	UINT nNumArrays = 3;
+	if (dwPosition != D3DFVF_XYZ)
+		nNumArrays += 1;
+	if (m_Layout.nNormal >= 0)
+		nNumArrays += 3;
+	if (m_Layout.nDiffuse >= 0)
+		nNumArrays += 1;
+	if (m_Layout.nSpecular >= 0)
+		nNumArrays += 1;
+	const UINT nNumTexCoords = std::min<UINT>(m_Layout.nNumTexCoords, SW_MAX_TEXCOORDS);
+	nNumArrays += nNumTexCoords * 2;
+
+	// 0으로 채워 두면 처리 폭에 모자라는 마지막 레인들도 유한한 값을 읽는다.
+	m_Storage.reset(new BYTE[nArraySize * nNumArrays + SW_VERTEXSTREAM_ALIGNMENT]());
+	BYTE* p = m_Storage.get();
+	p += (SW_VERTEXSTREAM_ALIGNMENT - (size_t)p % SW_VERTEXSTREAM_ALIGNMENT) % SW_VERTEXSTREAM_ALIGNMENT;
+	auto NextArray = [&]() { BYTE* pArray = p; p += nArraySize; return pArray; };
+
+	m_Streams.dwFVF = dwFVF;
+	m_Streams.nNumVertices = nNumVertices;
+	m_Streams.x = (float*)NextArray();
+	m_Streams.y = (float*)NextArray();
+	m_Streams.z = (float*)NextArray();
+	if (dwPosition != D3DFVF_XYZ)
+		m_Streams.w = (float*)NextArray();
+	if (m_Layout.nNormal >= 0)
+	{
+		m_Streams.nx = (float*)NextArray();
+		m_Streams.ny = (float*)NextArray();
+		m_Streams.nz = (float*)NextArray();
+	}
+	if (m_Layout.nDiffuse >= 0)
+		m_Streams.diffuse = (DWORD*)NextArray();
+	if (m_Layout.nSpecular >= 0)
+		m_Streams.specular = (DWORD*)NextArray();
+	for (UINT t = 0; t < nNumTexCoords; ++t)
+	{
+		m_Streams.u[t] = (float*)NextArray();
+		m_Streams.v[t] = (float*)NextArray();
+	}
+	return S_OK;
+}
+
+VOID CSwVertexStreams::Update(const BYTE* pVertices, UINT nFirst, UINT nCount)
+{
+	if (!m_Storage || nFirst >= m_Streams.nNumVertices)
+		return;
+	nCount = std::min(nCount, m_Streams.nNumVertices - nFirst);
+
+	const UINT nStride = m_Layout.nSize;
+	const UINT nNumTexCoords = std::min<UINT>(m_Layout.nNumTexCoords, SW_MAX_TEXCOORDS);
+	const BYTE* pSrc = pVertices + (size_t)nFirst * nStride;
+	for (UINT i = nFirst; i < nFirst + nCount; ++i, pSrc += nStride)
+	{
+		const float* pPos = (const float*)pSrc;
+		m_Streams.x[i] = pPos[0];
+		m_Streams.y[i] = pPos[1];
+		m_Streams.z[i] = pPos[2];
+		if (m_Streams.w)
+			m_Streams.w[i] = pPos[3];
+		if (m_Streams.nx)
+		{
+			const float* pNormal = (const float*)(pSrc + m_Layout.nNormal);
+			m_Streams.nx[i] = pNormal[0];
+			m_Streams.ny[i] = pNormal[1];
+			m_Streams.nz[i] = pNormal[2];
+		}
+		if (m_Streams.diffuse)
+			m_Streams.diffuse[i] = *(const DWORD*)(pSrc + m_Layout.nDiffuse);
+		if (m_Streams.specular)
+			m_Streams.specular[i] = *(const DWORD*)(pSrc + m_Layout.nSpecular);
+		for (UINT t = 0; t < nNumTexCoords; ++t)
+		{
+			const float* pTex = (const float*)(pSrc + m_Layout.nTexCoord[t]);
+			m_Streams.u[t][i] = pTex[0];
+			m_Streams.v[t][i] = (m_Layout.nTexCoordSize[t] > 1) ? pTex[1] : 0.0f;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// SoA 정점 단계
+//-----------------------------------------------------------------------------
+
+// 재질 색 원천(D3DMCS_*)에 따라 레인별 색을 고른다. SwVertexStage.cpp의 SelectSource()와 같다.
+static inline const VFLOAT* SelectSource(DWORD dwSource, const VFLOAT* pMtrl,
+	const VFLOAT* pDiffuse, const VFLOAT* pSpecular)
+{
+	if (dwSource == D3DMCS_COLOR1 && pDiffuse)
+		return pDiffuse;
+	if (dwSource == D3DMCS_COLOR2 && pSpecular)
+		return pSpecular;
+	return pMtrl;
+}
+
+static inline VOID SetColor(const D3DCOLORVALUE& c, VFLOAT* pOut)
+{
+	pOut[0] = VSet(c.r);
+	pOut[1] = VSet(c.g);
+	pOut[2] = VSet(c.b);
+	pOut[3] = VSet(c.a);
+}
+
+// 광원 계산. SwVertexStage.cpp의 ComputeLighting()을 레인별로 한 것이다.
+static VOID ComputeLighting(const SW_VERTEXSTATE* pState, const VFLOAT* P, const VFLOAT* N,
+	const VFLOAT* pMtrlDiffuse, const VFLOAT* pMtrlAmbient, const VFLOAT* pMtrlEmissive, VFLOAT* pOut)
+{
+	const VFLOAT zero = VSet(0.0f);
+	const VFLOAT one = VSet(1.0f);
+	VFLOAT r = VAdd(pMtrlEmissive[0], VMul(VSet(pState->Ambient.r), pMtrlAmbient[0]));
+	VFLOAT g = VAdd(pMtrlEmissive[1], VMul(VSet(pState->Ambient.g), pMtrlAmbient[1]));
+	VFLOAT b = VAdd(pMtrlEmissive[2], VMul(VSet(pState->Ambient.b), pMtrlAmbient[2]));
+
+	for (UINT i = 0; i < pState->nNumLights; ++i)
+	{
+		const D3DLIGHT9& light = pState->Lights[i];
+
+		VFLOAT L[3];
+		VFLOAT fAtten = one;
+		if (light.Type == D3DLIGHT_DIRECTIONAL)
+		{
+			D3DVECTOR dir = SwVec3(-light.Direction.x, -light.Direction.y, -light.Direction.z);
+			SwVec3Normalize(&dir, &dir);
+			L[0] = VSet(dir.x);
+			L[1] = VSet(dir.y);
+			L[2] = VSet(dir.z);
+		}
+		else
+		{
+			L[0] = VSub(VSet(light.Position.x), P[0]);
+			L[1] = VSub(VSet(light.Position.y), P[1]);
+			L[2] = VSub(VSet(light.Position.z), P[2]);
+			const VFLOAT fDist = VSqrt(VAdd(VAdd(VMul(L[0], L[0]), VMul(L[1], L[1])), VMul(L[2], L[2])));
+
+			// 범위 밖의 레인은 감쇠를 0으로 만든다.
+			VFLOAT inRange = VLessEqual(fDist, VSet(light.Range));
+			if (!VAny(inRange))
+				continue;
+
+			const VFLOAT positive = VGreater(fDist, zero);
+			L[0] = VSelect(positive, VDiv(L[0], fDist), L[0]);
+			L[1] = VSelect(positive, VDiv(L[1], fDist), L[1]);
+			L[2] = VSelect(positive, VDiv(L[2], fDist), L[2]);
+
+			const VFLOAT fDen = VAdd(VAdd(VSet(light.Attenuation0), VMul(VSet(light.Attenuation1), fDist)),
+				VMul(VSet(light.Attenuation2), VMul(fDist, fDist)));
+			fAtten = VSelect(VGreater(fDen, zero), VDiv(one, fDen), one);
+
+			if (light.Type == D3DLIGHT_SPOT)
+			{
+				D3DVECTOR D;
+				SwVec3Normalize(&D, &light.Direction);
+				const VFLOAT rho = VSub(zero, VAdd(VAdd(VMul(L[0], VSet(D.x)), VMul(L[1], VSet(D.y))), VMul(L[2], VSet(D.z))));
+				const float fCosPhi = cosf(light.Phi * 0.5f);
+				const float fCosTheta = cosf(light.Theta * 0.5f);
+				inRange = VAnd(inRange, VGreater(rho, VSet(fCosPhi)));
+				if (!VAny(inRange))
+					continue;
+				if (fCosTheta > fCosPhi)
+				{
+					// 본영역(theta) 안은 1, 반영역은 ((rho - cos(phi/2)) / (cos(theta/2) - cos(phi/2)))^Falloff
+					VFLOAT fSpot = VDiv(VSub(rho, VSet(fCosPhi)), VSet(fCosTheta - fCosPhi));
+					if (light.Falloff != 1.0f)
+						fSpot = VPow(VMax(fSpot, zero), light.Falloff);
+					fAtten = VMul(fAtten, VSelect(VGreater(VSet(fCosTheta), rho), fSpot, one));
+				}
+			}
+			fAtten = VSelect(inRange, fAtten, zero);
+		}
+
+		r = VAdd(r, VMul(VMul(VSet(light.Ambient.r), pMtrlAmbient[0]), fAtten));
+		g = VAdd(g, VMul(VMul(VSet(light.Ambient.g), pMtrlAmbient[1]), fAtten));
+		b = VAdd(b, VMul(VMul(VSet(light.Ambient.b), pMtrlAmbient[2]), fAtten));
+
+		if (N)
+		{
+			const VFLOAT fNdotL = VAdd(VAdd(VMul(N[0], L[0]), VMul(N[1], L[1])), VMul(N[2], L[2]));
+			const VFLOAT f = VMul(VMax(fNdotL, zero), fAtten);
+			r = VAdd(r, VMul(VMul(VSet(light.Diffuse.r), pMtrlDiffuse[0]), f));
+			g = VAdd(g, VMul(VMul(VSet(light.Diffuse.g), pMtrlDiffuse[1]), f));
+			b = VAdd(b, VMul(VMul(VSet(light.Diffuse.b), pMtrlDiffuse[2]), f));
+		}
+	}
+
+	pOut[0] = VSaturate(r);
+	pOut[1] = VSaturate(g);
+	pOut[2] = VSaturate(b);
+	pOut[3] = VSaturate(pMtrlDiffuse[3]);
+}
+
+VOID SwProcessVertexStreams(const SW_VERTEXSTATE* pState, const SW_VERTEXSTREAMS* pStreams,
+	UINT nFirst, UINT nCount, SW_VERTEX* pDst)
+{
+	const D3DMATRIX& W = pState->matWorld;
+	const D3DMATRIX& M = pState->matWorldViewProj;
+	const BOOL bTransformed = (pStreams->dwFVF & D3DFVF_POSITION_MASK) == D3DFVF_XYZRHW;
+	const BOOL bLighting = pState->bLighting && !bTransformed;
+	const UINT nNumTexCoords = std::min<UINT>((pStreams->dwFVF & D3DFVF_TEXCOUNT_MASK) >> D3DFVF_TEXCOUNT_SHIFT, SW_MAX_TEXCOORDS);
+
+	VFLOAT mtrlDiffuse[4], mtrlAmbient[4], mtrlEmissive[4];
+	SetColor(pState->Material.Diffuse, mtrlDiffuse);
+	SetColor(pState->Material.Ambient, mtrlAmbient);
+	SetColor(pState->Material.Emissive, mtrlEmissive);
+
+	const VFLOAT zero = VSet(0.0f);
+	const VFLOAT one = VSet(1.0f);
+
+	SW_VERTEX tail[SW_VERTEXSTREAM_WIDTH];
+	for (UINT n = 0; n < nCount; n += SW_VERTEXSTREAM_WIDTH)
+	{
+		const UINT i = nFirst + n;
+		const UINT nLanes = std::min<UINT>(SW_VERTEXSTREAM_WIDTH, nCount - n);
+		SW_VERTEX* pOut = (nLanes == SW_VERTEXSTREAM_WIDTH) ? pDst + n : tail;
+
+		// 위치
+		const VFLOAT x = VLoad(pStreams->x + i);
+		const VFLOAT y = VLoad(pStreams->y + i);
+		const VFLOAT z = VLoad(pStreams->z + i);
+		VFLOAT clip[4];
+		if (bTransformed)
+		{
+			// 변환이 끝난 정점: 화면 좌표와 rhw를 그대로 사용한다.
+			const VFLOAT rhw = VLoad(pStreams->w + i);
+			clip[0] = x;
+			clip[1] = y;
+			clip[2] = z;
+			clip[3] = VSelect(VNotEqual(rhw, zero), VDiv(one, rhw), one);
+		}
+		else
+		{
+			clip[0] = VAdd(VAdd(VAdd(VMul(x, VSet(M._11)), VMul(y, VSet(M._21))), VMul(z, VSet(M._31))), VSet(M._41));
+			clip[1] = VAdd(VAdd(VAdd(VMul(x, VSet(M._12)), VMul(y, VSet(M._22))), VMul(z, VSet(M._32))), VSet(M._42));
+			clip[2] = VAdd(VAdd(VAdd(VMul(x, VSet(M._13)), VMul(y, VSet(M._23))), VMul(z, VSet(M._33))), VSet(M._43));
+			clip[3] = VAdd(VAdd(VAdd(VMul(x, VSet(M._14)), VMul(y, VSet(M._24))), VMul(z, VSet(M._34))), VSet(M._44));
+		}
+
+		// 정점 색
+		VFLOAT diffuse[4], specular[4];
+		const VFLOAT* pDiffuse = NULL;
+		const VFLOAT* pSpecular = NULL;
+		if (pStreams->diffuse)
+		{
+			VUnpackColor(pStreams->diffuse + i, diffuse);
+			pDiffuse = diffuse;
+		}
+		if (pStreams->specular)
+		{
+			VUnpackColor(pStreams->specular + i, specular);
+			pSpecular = specular;
+		}
+
+		VFLOAT color[4];
+		if (bLighting)
+		{
+			// D3DRS_COLORVERTEX가 꺼져 있으면 정점 색을 재질 색으로 쓰지 않는다.
+			const VFLOAT* pVtxDiffuse = pState->bColorVertex ? pDiffuse : NULL;
+			const VFLOAT* pVtxSpecular = pState->bColorVertex ? pSpecular : NULL;
+
+			VFLOAT P[3];
+			P[0] = VAdd(VAdd(VAdd(VMul(x, VSet(W._11)), VMul(y, VSet(W._21))), VMul(z, VSet(W._31))), VSet(W._41));
+			P[1] = VAdd(VAdd(VAdd(VMul(x, VSet(W._12)), VMul(y, VSet(W._22))), VMul(z, VSet(W._32))), VSet(W._42));
+			P[2] = VAdd(VAdd(VAdd(VMul(x, VSet(W._13)), VMul(y, VSet(W._23))), VMul(z, VSet(W._33))), VSet(W._43));
+
+			VFLOAT N[3];
+			const VFLOAT* pN = NULL;
+			if (pStreams->nx)
+			{
+				const VFLOAT nx = VLoad(pStreams->nx + i);
+				const VFLOAT ny = VLoad(pStreams->ny + i);
+				const VFLOAT nz = VLoad(pStreams->nz + i);
+				N[0] = VAdd(VAdd(VMul(nx, VSet(W._11)), VMul(ny, VSet(W._21))), VMul(nz, VSet(W._31)));
+				N[1] = VAdd(VAdd(VMul(nx, VSet(W._12)), VMul(ny, VSet(W._22))), VMul(nz, VSet(W._32)));
+				N[2] = VAdd(VAdd(VMul(nx, VSet(W._13)), VMul(ny, VSet(W._23))), VMul(nz, VSet(W._33)));
+
+				// 길이가 0인 법선은 0 벡터로 둔다(SwVec3Normalize와 같다).
+				const VFLOAT fLen = VSqrt(VAdd(VAdd(VMul(N[0], N[0]), VMul(N[1], N[1])), VMul(N[2], N[2])));
+				const VFLOAT fInv = VSelect(VGreater(fLen, zero), VDiv(one, fLen), zero);
+				N[0] = VMul(N[0], fInv);
+				N[1] = VMul(N[1], fInv);
+				N[2] = VMul(N[2], fInv);
+				pN = N;
+			}
+
+			ComputeLighting(pState, P, pN,
+				SelectSource(pState->dwDiffuseSource, mtrlDiffuse, pVtxDiffuse, pVtxSpecular),
+				SelectSource(pState->dwAmbientSource, mtrlAmbient, pVtxDiffuse, pVtxSpecular),
+				SelectSource(pState->dwEmissiveSource, mtrlEmissive, pVtxDiffuse, pVtxSpecular),
+				color);
+		}
+		else if (pDiffuse)
+		{
+			color[0] = diffuse[0];
+			color[1] = diffuse[1];
+			color[2] = diffuse[2];
+			color[3] = diffuse[3];
+		}
+		else
+		{
+			// 정점 색이 없으면 흰색
+			color[0] = color[1] = color[2] = color[3] = one;
+		}
+
+		// SW_VERTEX로 옮긴다. 위치와 색은 4x4 전치로 한 번에 쓴다.
+		float* ppPos[SW_VERTEXSTREAM_WIDTH];
+		float* ppColor[SW_VERTEXSTREAM_WIDTH];
+		for (UINT k = 0; k < SW_VERTEXSTREAM_WIDTH; ++k)
+		{
+			ppPos[k] = &pOut[k].x;
+			ppColor[k] = pOut[k].color;
+		}
+		VStoreTransposed(ppPos, clip[0], clip[1], clip[2], clip[3]);
+		VStoreTransposed(ppColor, color[0], color[1], color[2], color[3]);
+
+		for (UINT t = 0; t < SW_MAX_TEXCOORDS; ++t)
+		{
+			for (UINT k = 0; k < SW_VERTEXSTREAM_WIDTH; ++k)
+			{
+				pOut[k].tex[t][0] = (t < nNumTexCoords) ? pStreams->u[t][i + k] : 0.0f;
+				pOut[k].tex[t][1] = (t < nNumTexCoords) ? pStreams->v[t][i + k] : 0.0f;
+			}
+		}
+
+		if (pOut == tail)
+			memcpy(pDst + n, tail, nLanes * sizeof(SW_VERTEX));
+	}
+}
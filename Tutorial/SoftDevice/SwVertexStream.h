@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwVertexStream.h
+//
+// 설명:	FVF 정점 버퍼의 SoA(structure of arrays) 사본과 SoA 정점 단계.
+//		예제의 CUSTOMVERTEX는 요소들이 한 정점 안에 섞여 있는(AoS) 구조라서 정점 단계가
+//		정점마다 간격(stride)을 두고 요소를 하나씩 읽어야 한다. 정점 버퍼를 Unlock()할 때
+//		x[], y[], z[], color[], u[], v[]처럼 요소별로 따로 모은 배열을 만들어 두면
+//		변환과 광원 계산을 SIMD 레지스터 폭만큼 한 번에 처리할 수 있다.
+//
+//		배열은 모두 SW_VERTEXSTREAM_ALIGNMENT 경계에서 시작하고, 끝에 SW_VERTEXSTREAM_WIDTH개의 여유가 있어
+//		어느 정점에서 시작한 묶음도 배열 끝을 넘지 않고 한 번에 읽을 수 있다.
+//		2차원이 아닌 텍스처 좌표 집합, 혼합 가중치, 점 크기처럼 정점 단계가 쓰지 않는 요소는 옮기지 않는다.
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwVertexStage.h"
+
+#include <memory>
+
+#define SW_VERTEXSTREAM_ALIGNMENT	64		// 배열 시작 주소의 정렬(바이트)
+#define SW_VERTEXSTREAM_WIDTH		4		// SoA 정점 단계가 한 번에 처리하는 정점 수
+
+//-----------------------------------------------------------------------------
+// 요소별 배열. 없는 요소는 NULL이다.
+//-----------------------------------------------------------------------------
+struct SW_VERTEXSTREAMS
+{
+	DWORD		dwFVF;
+	UINT		nNumVertices;
+	float*		x;
+	float*		y;
+	float*		z;
+	float*		w;								// D3DFVF_XYZRHW의 rhw, D3DFVF_XYZW의 w
+	float*		nx;
+	float*		ny;
+	float*		nz;
+	DWORD*		diffuse;
+	DWORD*		specular;
+	float*		u[SW_MAX_TEXCOORDS];
+	float*		v[SW_MAX_TEXCOORDS];			// 1차원 좌표 집합이면 0으로 채운다
+};
+
+//-----------------------------------------------------------------------------
+// 정점 버퍼 하나의 SoA 사본
+//-----------------------------------------------------------------------------
+class CSwVertexStreams
+{
+public:
+	CSwVertexStreams();
+
+	// nNumVertices개의 정점을 담을 배열을 만든다. 양자화 없는 float FVF만 지원하며
+	// 위치가 D3DFVF_XYZ, D3DFVF_XYZRHW, D3DFVF_XYZW가 아니면 E_FAIL을 돌려준다.
+	HRESULT		Create(DWORD dwFVF, UINT nNumVertices);
+
+	// AoS 정점 pVertices(FVF 크기 간격)의 [nFirst, nFirst + nCount) 범위를 배열로 옮긴다.
+	VOID		Update(const BYTE* pVertices, UINT nFirst, UINT nCount);
+
+	const SW_VERTEXSTREAMS*	Get() const { return m_Storage ? &m_Streams : NULL; }
+
+private:
+	SW_FVFLAYOUT				m_Layout;
+	SW_VERTEXSTREAMS			m_Streams;
+	std::unique_ptr<BYTE[]>		m_Storage;
+};
+
+// 정점 [nFirst, nFirst + nCount)를 SoA 배열에서 읽어 pDst에 변환된 정점을 쓴다.
+// SwProcessVertices()와 같은 결과를 낸다(계산 순서가 같아 오차는 float 반올림 정도다).
+VOID	SwProcessVertexStreams(const SW_VERTEXSTATE* pState, const SW_VERTEXSTREAMS* pStreams,
+			UINT nFirst, UINT nCount, SW_VERTEX* pDst);
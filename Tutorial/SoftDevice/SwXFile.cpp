@@ -0,0 +1,1050 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwXFile.cpp
+//
+// 설명:	텍스트 X 파일 로더 구현.
+//		읽는 과정은 두 단계다.
+//		1. 파싱: 파일 내용을 앞에서부터 읽어 메시마다 위치, 법선, 텍스처 좌표, 면, 재질을 모은다.
+//		   긴 배열은 원소 경계(구조체는 ";,", 스칼라는 ",")로 구간을 나누어 병렬로 읽는다.
+//		2. 조립: 모든 메시의 꼭지점을 정점으로 바꾸고, 삼각형을 재질 순서로 정렬하여 SW_MESHDATA를 만든다.
+//-----------------------------------------------------------------------------
+#include "SwXFile.h"
+#include "SwFile.h"
+#include "SwMath.h"
+#include "SwMeshOptimize.h"
+#include "SwThreadPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#define SW_X_PARALLEL_MIN_ELEMENTS	65536			// 이보다 긴 배열만 나누어 읽는다
+#define SW_X_PARALLEL_MIN_FILESIZE	(16 << 20)		// 스레드 풀이 없을 때 기본 풀을 쓰는 파일 크기
+#define SW_X_CHUNKS_PER_THREAD		4
+#define SW_X_NONE					0xffffffff
+
+//-----------------------------------------------------------------------------
+// 읽는 중인 메시
+//-----------------------------------------------------------------------------
+struct XMESH
+{
+	D3DMATRIX					matTransform;	// 부모 프레임들의 변환을 모두 곱한 행렬
+	std::vector<float>			Positions;		// x, y, z
+	std::vector<float>			Normals;		// x, y, z
+	std::vector<float>			TexCoords;		// u, v (위치와 같은 개수)
+	std::vector<DWORD>			Faces;			// (꼭지점 수, 위치 번호...)의 반복
+	UINT						nNumFaces;
+	std::vector<DWORD>			NormalFaces;	// (꼭지점 수, 법선 번호...)의 반복
+	UINT						nNumNormalFaces;
+	std::vector<DWORD>			FaceMaterials;	// 면마다 재질 번호
+	std::vector<SW_MATERIAL>	Materials;
+};
+
+//-----------------------------------------------------------------------------
+// 어휘 분석
+// 모든 함수는 읽은 만큼 p를 옮긴다.
+//-----------------------------------------------------------------------------
+static inline bool IsSpace(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool IsIdentStart(char c)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline bool IsIdentChar(char c)
+{
+	return IsIdentStart(c) || (c >= '0' && c <= '9') || c == '-' || c == '.';
+}
+
+// 공백과 주석(#, //)을 건너뛴다.
+static inline VOID SkipSpace(const char*& p, const char* end)
+{
+	while (p < end)
+	{
+		if (IsSpace(*p))
+		{
+			++p;
+		}
+		else if (*p == '#' || (*p == '/' && p + 1 < end && p[1] == '/'))
+		{
+			while (p < end && *p != '\n')
+				++p;
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+// 데이터 사이의 구분자(, ;)도 함께 건너뛴다. 배열 길이가 항상 앞에 있으므로 구분자의 개수는 볼 필요가 없다.
+static inline VOID SkipSeparators(const char*& p, const char* end)
+{
+	for (;;)
+	{
+		SkipSpace(p, end);
+		if (p < end && (*p == ',' || *p == ';'))
+			++p;
+		else
+			break;
+	}
+}
+
+// 내보내기 도구가 쓰는 "-12.345678" 꼴의 짧은 소수는 정수 가수와 10의 거듭제곱으로 바로 계산한다.
+// 가수가 2^24 이하이고 소수 자리가 10 이하이면 두 값 모두 float로 정확히 표현되므로
+// 나눗셈 한 번의 반올림 결과가 from_chars와 같다(Clinger의 빠른 경로). 나머지는 from_chars로 넘긴다.
+static inline bool ParseFloatFast(const char*& p, const char* end, float* pOut)
+{
+	static const float s_fPow10[11] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+	const char* q = p;
+	const bool bNegative = (q < end && *q == '-');
+	if (bNegative)
+		++q;
+
+	UINT nMantissa = 0;
+	int nDigits = 0, nFraction = 0;
+	while (q < end && *q >= '0' && *q <= '9' && nDigits < 9)
+	{
+		nMantissa = nMantissa * 10 + (UINT)(*q++ - '0');
+		++nDigits;
+	}
+	if (q < end && *q == '.')
+	{
+		++q;
+		while (q < end && *q >= '0' && *q <= '9' && nDigits < 9)
+		{
+			nMantissa = nMantissa * 10 + (UINT)(*q++ - '0');
+			++nDigits;
+			++nFraction;
+		}
+	}
+
+	// 자릿수가 더 남았거나 지수가 있으면 빠른 경로를 쓸 수 없다.
+	if (nDigits == 0 || nMantissa > (1u << 24) || nFraction > 10)
+		return false;
+	if (q < end && ((*q >= '0' && *q <= '9') || *q == '.' || *q == 'e' || *q == 'E'))
+		return false;
+
+	float f = (float)nMantissa / s_fPow10[nFraction];
+	*pOut = bNegative ? -f : f;
+	p = q;
+	return true;
+}
+
+static inline bool ParseFloat(const char*& p, const char* end, float* pOut)
+{
+	SkipSeparators(p, end);
+	if (p < end && *p == '+')
+		++p;
+	if (ParseFloatFast(p, end, pOut))
+		return true;
+
+	std::from_chars_result r = std::from_chars(p, end, *pOut);
+	if (r.ec != std::errc())
+		return false;
+	p = r.ptr;
+	return true;
+}
+
+static inline bool ParseUInt(const char*& p, const char* end, DWORD* pOut)
+{
+	SkipSeparators(p, end);
+	if (p >= end || *p < '0' || *p > '9')
+		return false;
+
+	DWORD n = 0;
+	while (p < end && *p >= '0' && *p <= '9')
+		n = n * 10 + (DWORD)(*p++ - '0');
+	*pOut = n;
+	return true;
+}
+
+static inline bool ParseIdent(const char*& p, const char* end, std::string_view* pOut)
+{
+	SkipSpace(p, end);
+	if (p >= end || !IsIdentStart(*p))
+		return false;
+
+	const char* pBegin = p;
+	while (p < end && IsIdentChar(*p))
+		++p;
+	*pOut = std::string_view(pBegin, (size_t)(p - pBegin));
+	return true;
+}
+
+static inline bool ParseChar(const char*& p, const char* end, char c)
+{
+	SkipSpace(p, end);
+	if (p >= end || *p != c)
+		return false;
+	++p;
+	return true;
+}
+
+static bool ParseString(const char*& p, const char* end, std::string* pOut)
+{
+	SkipSeparators(p, end);
+	if (p >= end || *p != '"')
+		return false;
+
+	const char* pBegin = ++p;
+	while (p < end && *p != '"')
+		++p;
+	if (p >= end)
+		return false;
+
+	pOut->assign(pBegin, (size_t)(p - pBegin));
+	++p;
+	return true;
+}
+
+// '{' 다음부터 짝이 맞는 '}' 다음까지 건너뛴다.
+static bool SkipBlock(const char*& p, const char* end)
+{
+	int nDepth = 1;
+	while (p < end)
+	{
+		char c = *p++;
+		if (c == '{')
+		{
+			++nDepth;
+		}
+		else if (c == '}')
+		{
+			if (--nDepth == 0)
+				return true;
+		}
+		else if (c == '"')
+		{
+			while (p < end && *p != '"')
+				++p;
+			++p;
+		}
+		else if (c == '#' || (c == '/' && p < end && *p == '/'))
+		{
+			while (p < end && *p != '\n')
+				++p;
+		}
+	}
+	return false;
+}
+
+// 데이터 개체의 머리 "[이름] { [<GUID>]"를 읽는다. 형식 이름은 이미 읽은 상태다.
+static bool ParseObjectHeader(const char*& p, const char* end, std::string_view* pName)
+{
+	*pName = std::string_view();
+	SkipSpace(p, end);
+	if (p < end && *p != '{')
+	{
+		if (!ParseIdent(p, end, pName))
+			return false;
+	}
+	if (!ParseChar(p, end, '{'))
+		return false;
+
+	SkipSpace(p, end);
+	if (p < end && *p == '<')
+	{
+		while (p < end && *p != '>')
+			++p;
+		if (p >= end)
+			return false;
+		++p;
+	}
+	return true;
+}
+
+static bool EqualsNoCase(std::string_view a, const char* b)
+{
+	size_t n = strlen(b);
+	if (a.size() != n)
+		return false;
+	for (size_t i = 0; i < n; ++i)
+	{
+		char ca = a[i], cb = b[i];
+		if (ca >= 'A' && ca <= 'Z')
+			ca = (char)(ca - 'A' + 'a');
+		if (cb >= 'A' && cb <= 'Z')
+			cb = (char)(cb - 'A' + 'a');
+		if (ca != cb)
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// 파서
+//-----------------------------------------------------------------------------
+class CXFileParser
+{
+public:
+	CXFileParser(const char* pBegin, const char* pEnd, CSwThreadPool* pThreadPool)
+		: m_p(pBegin), m_pEnd(pEnd), m_pThreadPool(pThreadPool)
+	{
+	}
+
+	bool	ParseFile();
+
+	std::vector<XMESH>		m_Meshes;
+
+private:
+	bool	ParseFrame(const D3DMATRIX* pParent);
+	bool	ParseMesh(const D3DMATRIX* pTransform);
+	bool	ParseMeshNormals(XMESH* pMesh);
+	bool	ParseMeshTextureCoords(XMESH* pMesh);
+	bool	ParseMeshMaterialList(XMESH* pMesh);
+	bool	ParseMaterial(SW_MATERIAL* pMaterial);
+	bool	ParseFaces(UINT nNumFaces, std::vector<DWORD>* pFaces);
+	bool	ParseFloats(UINT nCount, UINT nComponents, std::vector<float>* pOut);
+
+	UINT	GetMaxChunks() const
+	{
+		return m_pThreadPool ? m_pThreadPool->GetNumThreads() * SW_X_CHUNKS_PER_THREAD : 1;
+	}
+
+	template <typename ELEMFUNC>
+	bool	ParseArray(UINT nCount, bool bStruct, const ELEMFUNC& func);
+
+	const char*			m_p;
+	const char*			m_pEnd;
+	CSwThreadPool*		m_pThreadPool;
+
+	std::unordered_map<std::string_view, SW_MATERIAL>	m_NamedMaterials;	// 최상위에 정의된 재질
+};
+
+//-----------------------------------------------------------------------------
+// 배열 읽기
+// func(p, end, 원소 번호, 구간 번호)가 원소 하나를 읽는다.
+// 구조체 원소는 ';'로 끝나고 원소 사이는 ','이므로 경계가 ";,"이고 배열은 ";;"로 끝난다.
+// 스칼라 원소는 경계가 ","이고 배열은 ";"로 끝난다.
+//-----------------------------------------------------------------------------
+static const char* FindArrayEnd(const char* p, const char* end, bool bStruct)
+{
+	while (p < end)
+	{
+		const char* pSemi = (const char*)memchr(p, ';', (size_t)(end - p));
+		if (pSemi == NULL)
+			return end;
+		if (!bStruct)
+			return pSemi;
+
+		const char* q = pSemi + 1;
+		while (q < end && IsSpace(*q))
+			++q;
+		if (q < end && *q == ';')
+			return pSemi + 1;
+		p = q;
+	}
+	return end;
+}
+
+// p 이후 첫 원소 경계의 바로 다음 위치. 없으면 NULL.
+static const char* FindNextBoundary(const char* p, const char* end, bool bStruct)
+{
+	while (p < end)
+	{
+		const char* pComma = (const char*)memchr(p, ',', (size_t)(end - p));
+		if (pComma == NULL)
+			return NULL;
+		if (!bStruct)
+			return pComma + 1;
+
+		const char* q = pComma;
+		while (q > p && IsSpace(q[-1]))
+			--q;
+		if (q > p && q[-1] == ';')
+			return pComma + 1;
+		p = pComma + 1;
+	}
+	return NULL;
+}
+
+static UINT CountBoundaries(const char* p, const char* end, bool bStruct)
+{
+	UINT nCount = 0;
+	while ((p = FindNextBoundary(p, end, bStruct)) != NULL)
+		++nCount;
+	return nCount;
+}
+
+template <typename ELEMFUNC>
+bool CXFileParser::ParseArray(UINT nCount, bool bStruct, const ELEMFUNC& func)
+{
+	if (nCount == 0)
+		return true;
+
+	const UINT nMaxChunks = GetMaxChunks();
+	if (nMaxChunks <= 1 || nCount < SW_X_PARALLEL_MIN_ELEMENTS)
+	{
+		for (UINT i = 0; i < nCount; ++i)
+		{
+			if (!func(m_p, m_pEnd, i, 0))
+				return false;
+		}
+		return true;
+	}
+
+	// 1. 배열이 차지하는 범위를 찾아 대략 같은 크기의 구간으로 나누고, 구간 시작을 원소 경계에 맞춘다.
+	//    배열 길이 다음의 ';'는 배열 끝으로 보이지 않도록 먼저 건너뛴다.
+	SkipSeparators(m_p, m_pEnd);
+	const char* pArray = m_p;
+	const char* pArrayEnd = FindArrayEnd(pArray, m_pEnd, bStruct);
+	const size_t nBytes = (size_t)(pArrayEnd - pArray);
+
+	std::vector<const char*> starts(nMaxChunks + 1);
+	starts[0] = pArray;
+	for (UINT k = 1; k < nMaxChunks; ++k)
+	{
+		const char* pSplit = pArray + nBytes / nMaxChunks * k;
+		if (pSplit < starts[k - 1])
+			pSplit = starts[k - 1];
+		const char* pBoundary = FindNextBoundary(pSplit, pArrayEnd, bStruct);
+		starts[k] = pBoundary ? pBoundary : pArrayEnd;
+	}
+	starts[nMaxChunks] = pArrayEnd;
+
+	// 2. 구간마다 시작하는 원소 수를 센다. 마지막 원소는 경계 없이 배열 끝에서 끝난다.
+	std::vector<UINT> counts(nMaxChunks, 0);
+	m_pThreadPool->ParallelFor(nMaxChunks, [&](UINT k, UINT)
+	{
+		if (starts[k] < starts[k + 1])
+			counts[k] = CountBoundaries(starts[k], starts[k + 1], bStruct);
+	});
+	for (UINT k = nMaxChunks; k > 0; --k)
+	{
+		if (starts[k - 1] < starts[k])
+		{
+			counts[k - 1] += 1;
+			break;
+		}
+	}
+
+	std::vector<UINT> firsts(nMaxChunks + 1, 0);
+	for (UINT k = 0; k < nMaxChunks; ++k)
+		firsts[k + 1] = firsts[k] + counts[k];
+	if (firsts[nMaxChunks] != nCount)
+		return false;
+
+	// 3. 구간별로 읽는다.
+	std::atomic<bool> bOK(true);
+	m_pThreadPool->ParallelFor(nMaxChunks, [&](UINT k, UINT)
+	{
+		const char* p = starts[k];
+		for (UINT i = firsts[k]; i < firsts[k + 1]; ++i)
+		{
+			if (!func(p, pArrayEnd, i, k))
+			{
+				bOK = false;
+				return;
+			}
+		}
+	});
+
+	m_p = pArrayEnd;
+	return bOK;
+}
+
+bool CXFileParser::ParseFloats(UINT nCount, UINT nComponents, std::vector<float>* pOut)
+{
+	pOut->resize((size_t)nCount * nComponents);
+	float* pDst = pOut->data();
+	return ParseArray(nCount, true, [=](const char*& p, const char* end, UINT i, UINT)
+	{
+		for (UINT c = 0; c < nComponents; ++c)
+		{
+			if (!ParseFloat(p, end, &pDst[(size_t)i * nComponents + c]))
+				return false;
+		}
+		return true;
+	});
+}
+
+// 면의 꼭지점 수가 제각각이므로 구간별로 따로 모은 다음 순서대로 잇는다.
+bool CXFileParser::ParseFaces(UINT nNumFaces, std::vector<DWORD>* pFaces)
+{
+	// 대부분 삼각형, 사각형이므로 면마다 4개 정도를 미리 잡아 둔다.
+	std::vector<std::vector<DWORD> > chunks(GetMaxChunks());
+	for (size_t k = 0; k < chunks.size(); ++k)
+		chunks[k].reserve((size_t)nNumFaces * 4 / chunks.size() + 16);
+	bool bOK = ParseArray(nNumFaces, true, [&](const char*& p, const char* end, UINT, UINT k)
+	{
+		DWORD nCorners;
+		if (!ParseUInt(p, end, &nCorners) || nCorners < 3)
+			return false;
+
+		std::vector<DWORD>& out = chunks[k];
+		out.push_back(nCorners);
+		for (DWORD c = 0; c < nCorners; ++c)
+		{
+			DWORD nIndex;
+			if (!ParseUInt(p, end, &nIndex))
+				return false;
+			out.push_back(nIndex);
+		}
+		return true;
+	});
+	if (!bOK)
+		return false;
+
+	size_t nTotal = 0;
+	for (size_t k = 0; k < chunks.size(); ++k)
+		nTotal += chunks[k].size();
+	pFaces->clear();
+	pFaces->reserve(nTotal);
+	for (size_t k = 0; k < chunks.size(); ++k)
+		pFaces->insert(pFaces->end(), chunks[k].begin(), chunks[k].end());
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// 개체별 읽기
+//-----------------------------------------------------------------------------
+bool CXFileParser::ParseFile()
+{
+	D3DMATRIX matIdentity;
+	SwMatrixIdentity(&matIdentity);
+
+	for (;;)
+	{
+		SkipSpace(m_p, m_pEnd);
+		if (m_p >= m_pEnd)
+			return true;
+
+		std::string_view type, name;
+		if (!ParseIdent(m_p, m_pEnd, &type))
+			return false;
+
+		if (type == "template")
+		{
+			if (!ParseIdent(m_p, m_pEnd, &name) || !ParseChar(m_p, m_pEnd, '{') || !SkipBlock(m_p, m_pEnd))
+				return false;
+			continue;
+		}
+
+		if (!ParseObjectHeader(m_p, m_pEnd, &name))
+			return false;
+
+		bool bOK;
+		if (type == "Frame")
+		{
+			bOK = ParseFrame(&matIdentity);
+		}
+		else if (type == "Mesh")
+		{
+			bOK = ParseMesh(&matIdentity);
+		}
+		else if (type == "Material")
+		{
+			SW_MATERIAL material;
+			bOK = ParseMaterial(&material);
+			if (bOK && !name.empty())
+				m_NamedMaterials[name] = material;
+		}
+		else
+		{
+			bOK = SkipBlock(m_p, m_pEnd);
+		}
+		if (!bOK)
+			return false;
+	}
+}
+
+bool CXFileParser::ParseFrame(const D3DMATRIX* pParent)
+{
+	D3DMATRIX matWorld = *pParent;
+
+	for (;;)
+	{
+		if (ParseChar(m_p, m_pEnd, '}'))
+			return true;
+
+		// 다른 개체에 대한 참조 { 이름 }
+		if (ParseChar(m_p, m_pEnd, '{'))
+		{
+			if (!SkipBlock(m_p, m_pEnd))
+				return false;
+			continue;
+		}
+
+		std::string_view type, name;
+		if (!ParseIdent(m_p, m_pEnd, &type) || !ParseObjectHeader(m_p, m_pEnd, &name))
+			return false;
+
+		bool bOK;
+		if (type == "FrameTransformMatrix")
+		{
+			// 자식 메시와 프레임은 모두 이 행렬 다음에 온다.
+			D3DMATRIX matLocal;
+			bOK = true;
+			for (int i = 0; i < 16 && bOK; ++i)
+				bOK = ParseFloat(m_p, m_pEnd, &matLocal.m[i / 4][i % 4]);
+			SkipSeparators(m_p, m_pEnd);
+			bOK = bOK && ParseChar(m_p, m_pEnd, '}');
+			SwMatrixMultiply(&matWorld, &matLocal, pParent);
+		}
+		else if (type == "Frame")
+		{
+			bOK = ParseFrame(&matWorld);
+		}
+		else if (type == "Mesh")
+		{
+			bOK = ParseMesh(&matWorld);
+		}
+		else
+		{
+			bOK = SkipBlock(m_p, m_pEnd);
+		}
+		if (!bOK)
+			return false;
+	}
+}
+
+bool CXFileParser::ParseMesh(const D3DMATRIX* pTransform)
+{
+	m_Meshes.emplace_back();
+	XMESH* pMesh = &m_Meshes.back();
+	pMesh->matTransform = *pTransform;
+	pMesh->nNumFaces = 0;
+	pMesh->nNumNormalFaces = 0;
+
+	DWORD nNumVertices, nNumFaces;
+	if (!ParseUInt(m_p, m_pEnd, &nNumVertices) || !ParseFloats(nNumVertices, 3, &pMesh->Positions))
+		return false;
+	if (!ParseUInt(m_p, m_pEnd, &nNumFaces) || !ParseFaces(nNumFaces, &pMesh->Faces))
+		return false;
+	pMesh->nNumFaces = nNumFaces;
+
+	for (;;)
+	{
+		SkipSeparators(m_p, m_pEnd);
+		if (ParseChar(m_p, m_pEnd, '}'))
+			return true;
+
+		std::string_view type, name;
+		if (!ParseIdent(m_p, m_pEnd, &type) || !ParseObjectHeader(m_p, m_pEnd, &name))
+			return false;
+
+		bool bOK;
+		if (type == "MeshNormals")
+			bOK = ParseMeshNormals(pMesh);
+		else if (type == "MeshTextureCoords")
+			bOK = ParseMeshTextureCoords(pMesh);
+		else if (type == "MeshMaterialList")
+			bOK = ParseMeshMaterialList(pMesh);
+		else
+			bOK = SkipBlock(m_p, m_pEnd);
+		if (!bOK)
+			return false;
+	}
+}
+
+bool CXFileParser::ParseMeshNormals(XMESH* pMesh)
+{
+	DWORD nNumNormals, nNumFaces;
+	if (!ParseUInt(m_p, m_pEnd, &nNumNormals) || !ParseFloats(nNumNormals, 3, &pMesh->Normals))
+		return false;
+	if (!ParseUInt(m_p, m_pEnd, &nNumFaces) || !ParseFaces(nNumFaces, &pMesh->NormalFaces))
+		return false;
+	pMesh->nNumNormalFaces = nNumFaces;
+
+	SkipSeparators(m_p, m_pEnd);
+	return ParseChar(m_p, m_pEnd, '}');
+}
+
+bool CXFileParser::ParseMeshTextureCoords(XMESH* pMesh)
+{
+	DWORD nNumCoords;
+	if (!ParseUInt(m_p, m_pEnd, &nNumCoords) || !ParseFloats(nNumCoords, 2, &pMesh->TexCoords))
+		return false;
+
+	SkipSeparators(m_p, m_pEnd);
+	return ParseChar(m_p, m_pEnd, '}');
+}
+
+bool CXFileParser::ParseMeshMaterialList(XMESH* pMesh)
+{
+	DWORD nNumMaterials, nNumFaceIndexes;
+	if (!ParseUInt(m_p, m_pEnd, &nNumMaterials) || !ParseUInt(m_p, m_pEnd, &nNumFaceIndexes))
+		return false;
+
+	pMesh->FaceMaterials.resize(nNumFaceIndexes);
+	DWORD* pDst = pMesh->FaceMaterials.data();
+	bool bOK = ParseArray(nNumFaceIndexes, false, [=](const char*& p, const char* end, UINT i, UINT)
+	{
+		return ParseUInt(p, end, &pDst[i]);
+	});
+	if (!bOK)
+		return false;
+
+	for (;;)
+	{
+		SkipSeparators(m_p, m_pEnd);
+		if (ParseChar(m_p, m_pEnd, '}'))
+			break;
+
+		// 최상위 재질에 대한 참조 { 이름 }
+		if (ParseChar(m_p, m_pEnd, '{'))
+		{
+			std::string_view name;
+			if (!ParseIdent(m_p, m_pEnd, &name) || !ParseChar(m_p, m_pEnd, '}'))
+				return false;
+			std::unordered_map<std::string_view, SW_MATERIAL>::const_iterator it = m_NamedMaterials.find(name);
+			if (it == m_NamedMaterials.end())
+				return false;
+			pMesh->Materials.push_back(it->second);
+			continue;
+		}
+
+		std::string_view type, name;
+		if (!ParseIdent(m_p, m_pEnd, &type) || !ParseObjectHeader(m_p, m_pEnd, &name))
+			return false;
+
+		if (type == "Material")
+		{
+			pMesh->Materials.emplace_back();
+			if (!ParseMaterial(&pMesh->Materials.back()))
+				return false;
+		}
+		else if (!SkipBlock(m_p, m_pEnd))
+		{
+			return false;
+		}
+	}
+
+	return pMesh->Materials.size() == nNumMaterials;
+}
+
+bool CXFileParser::ParseMaterial(SW_MATERIAL* pMaterial)
+{
+	D3DMATERIAL9& mtrl = pMaterial->MatD3D;
+	ZeroMemory(&mtrl, sizeof(mtrl));
+	pMaterial->strTextureFilename.clear();
+
+	// faceColor(RGBA), power, specularColor(RGB), emissiveColor(RGB)
+	bool bOK = ParseFloat(m_p, m_pEnd, &mtrl.Diffuse.r) && ParseFloat(m_p, m_pEnd, &mtrl.Diffuse.g) &&
+		ParseFloat(m_p, m_pEnd, &mtrl.Diffuse.b) && ParseFloat(m_p, m_pEnd, &mtrl.Diffuse.a) &&
+		ParseFloat(m_p, m_pEnd, &mtrl.Power) &&
+		ParseFloat(m_p, m_pEnd, &mtrl.Specular.r) && ParseFloat(m_p, m_pEnd, &mtrl.Specular.g) &&
+		ParseFloat(m_p, m_pEnd, &mtrl.Specular.b) &&
+		ParseFloat(m_p, m_pEnd, &mtrl.Emissive.r) && ParseFloat(m_p, m_pEnd, &mtrl.Emissive.g) &&
+		ParseFloat(m_p, m_pEnd, &mtrl.Emissive.b);
+	if (!bOK)
+		return false;
+	mtrl.Specular.a = 1.0f;
+	mtrl.Emissive.a = 1.0f;
+
+	for (;;)
+	{
+		SkipSeparators(m_p, m_pEnd);
+		if (ParseChar(m_p, m_pEnd, '}'))
+			return true;
+
+		std::string_view type, name;
+		if (!ParseIdent(m_p, m_pEnd, &type) || !ParseObjectHeader(m_p, m_pEnd, &name))
+			return false;
+
+		// 내보내기 도구에 따라 TextureFileName으로 쓰기도 한다.
+		if (EqualsNoCase(type, "TextureFilename"))
+		{
+			if (!ParseString(m_p, m_pEnd, &pMaterial->strTextureFilename))
+				return false;
+			SkipSeparators(m_p, m_pEnd);
+			if (!ParseChar(m_p, m_pEnd, '}'))
+				return false;
+		}
+		else if (!SkipBlock(m_p, m_pEnd))
+		{
+			return false;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// 조립
+//-----------------------------------------------------------------------------
+struct XVERTEX
+{
+	UINT	nMesh;
+	DWORD	nPosition;
+	DWORD	nNormal;		// 법선이 없으면 SW_X_NONE
+};
+
+static VOID SetDefaultMaterial(SW_MATERIAL* pMaterial)
+{
+	ZeroMemory(&pMaterial->MatD3D, sizeof(pMaterial->MatD3D));
+	pMaterial->MatD3D.Diffuse.r = pMaterial->MatD3D.Diffuse.g = pMaterial->MatD3D.Diffuse.b = 1.0f;
+	pMaterial->MatD3D.Diffuse.a = 1.0f;
+	pMaterial->strTextureFilename.clear();
+}
+
+static bool BuildMeshData(std::vector<XMESH>& meshes, SW_MESHDATA* pOut, CSwThreadPool* pThreadPool)
+{
+	std::vector<XVERTEX> vertices;
+	std::vector<DWORD> triVertices;		// 삼각형마다 정점 3개
+	std::vector<DWORD> triAttributes;	// 삼각형마다 재질 번호
+	bool bNormals = false, bTexCoords = false;
+
+	pOut->Materials.clear();
+	for (UINT m = 0; m < (UINT)meshes.size(); ++m)
+	{
+		XMESH& mesh = meshes[m];
+		const DWORD nNumPositions = (DWORD)(mesh.Positions.size() / 3);
+		const DWORD nNumNormals = (DWORD)(mesh.Normals.size() / 3);
+		const bool bMeshNormals = nNumNormals > 0 && mesh.nNumNormalFaces == mesh.nNumFaces;
+		if (!mesh.TexCoords.empty() && mesh.TexCoords.size() / 2 != nNumPositions)
+			return false;
+		bNormals = bNormals || bMeshNormals;
+		bTexCoords = bTexCoords || !mesh.TexCoords.empty();
+
+		// 재질 목록이 없으면 기본 재질 하나를 쓴다.
+		const DWORD nFirstMaterial = (DWORD)pOut->Materials.size();
+		if (mesh.Materials.empty())
+		{
+			pOut->Materials.emplace_back();
+			SetDefaultMaterial(&pOut->Materials.back());
+		}
+		else
+		{
+			pOut->Materials.insert(pOut->Materials.end(), mesh.Materials.begin(), mesh.Materials.end());
+		}
+		const DWORD nNumMeshMaterials = (DWORD)pOut->Materials.size() - nFirstMaterial;
+
+		// 위치마다 정점 하나를 먼저 만들고, 같은 위치에 다른 법선이 쓰이면 정점을 더 만들어 잇는다.
+		const DWORD nFirstVertex = (DWORD)vertices.size();
+		std::vector<DWORD> nextVertex(nNumPositions, SW_X_NONE);
+		for (DWORD i = 0; i < nNumPositions; ++i)
+		{
+			XVERTEX v = { m, i, SW_X_NONE };
+			vertices.push_back(v);
+		}
+
+		size_t nFace = 0, nNormalFace = 0;
+		for (UINT f = 0; f < mesh.nNumFaces; ++f)
+		{
+			const DWORD nCorners = mesh.Faces[nFace];
+			const DWORD* pPositions = &mesh.Faces[nFace + 1];
+			nFace += 1 + nCorners;
+
+			const DWORD* pNormals = NULL;
+			if (bMeshNormals)
+			{
+				if (mesh.NormalFaces[nNormalFace] == nCorners)
+					pNormals = &mesh.NormalFaces[nNormalFace + 1];
+				nNormalFace += 1 + mesh.NormalFaces[nNormalFace];
+			}
+
+			// 면 재질 번호가 면 수보다 적으면 마지막 값을 이어서 쓴다(D3DX와 같다).
+			DWORD nAttribute = 0;
+			if (!mesh.FaceMaterials.empty())
+				nAttribute = mesh.FaceMaterials[f < mesh.FaceMaterials.size() ? f : mesh.FaceMaterials.size() - 1];
+			if (nAttribute >= nNumMeshMaterials)
+				return false;
+
+			DWORD corners[3] = { 0, 0, 0 };
+			for (DWORD c = 0; c < nCorners; ++c)
+			{
+				const DWORD nPosition = pPositions[c];
+				if (nPosition >= nNumPositions)
+					return false;
+
+				DWORD nVertex = nPosition;
+				if (pNormals)
+				{
+					const DWORD nNormal = pNormals[c];
+					if (nNormal >= nNumNormals)
+						return false;
+
+					XVERTEX* pV = &vertices[nFirstVertex + nVertex];
+					if (pV->nNormal == SW_X_NONE)
+						pV->nNormal = nNormal;
+					while (vertices[nFirstVertex + nVertex].nNormal != nNormal)
+					{
+						if (nextVertex[nVertex] == SW_X_NONE)
+						{
+							XVERTEX v = { m, nPosition, nNormal };
+							nextVertex[nVertex] = (DWORD)(vertices.size() - nFirstVertex);
+							nextVertex.push_back(SW_X_NONE);
+							vertices.push_back(v);
+						}
+						nVertex = nextVertex[nVertex];
+					}
+				}
+
+				// 부채꼴 삼각형화: (0, c - 1, c)
+				const DWORD nGlobal = nFirstVertex + nVertex;
+				if (c == 0)
+				{
+					corners[0] = nGlobal;
+				}
+				else if (c == 1)
+				{
+					corners[1] = nGlobal;
+				}
+				else
+				{
+					corners[2] = nGlobal;
+					triVertices.insert(triVertices.end(), corners, corners + 3);
+					triAttributes.push_back(nFirstMaterial + nAttribute);
+					corners[1] = nGlobal;
+				}
+			}
+		}
+	}
+
+	// 정점 배열: 프레임 변환을 적용하여 FVF 순서로 채운다.
+	pOut->dwFVF = D3DFVF_XYZ | (bNormals ? D3DFVF_NORMAL : 0) | (bTexCoords ? D3DFVF_TEX1 : 0);
+	pOut->nVertexSize = 12 + (bNormals ? 12 : 0) + (bTexCoords ? 8 : 0);
+	pOut->nNumVertices = (UINT)vertices.size();
+	pOut->Vertices.resize((size_t)pOut->nNumVertices * pOut->nVertexSize);
+
+	const UINT nVertexSize = pOut->nVertexSize;
+	const UINT nBatch = 4096;
+	const UINT nBatches = (pOut->nNumVertices + nBatch - 1) / nBatch;
+	auto packBatch = [&](UINT b, UINT)
+	{
+		const UINT nEnd = std::min<UINT>((b + 1) * nBatch, pOut->nNumVertices);
+		for (UINT i = b * nBatch; i < nEnd; ++i)
+		{
+			const XVERTEX& v = vertices[i];
+			const XMESH& mesh = meshes[v.nMesh];
+			const D3DMATRIX& M = mesh.matTransform;
+			float* pDst = (float*)&pOut->Vertices[(size_t)i * nVertexSize];
+
+			const float* P = &mesh.Positions[(size_t)v.nPosition * 3];
+			pDst[0] = P[0] * M._11 + P[1] * M._21 + P[2] * M._31 + M._41;
+			pDst[1] = P[0] * M._12 + P[1] * M._22 + P[2] * M._32 + M._42;
+			pDst[2] = P[0] * M._13 + P[1] * M._23 + P[2] * M._33 + M._43;
+			pDst += 3;
+
+			if (bNormals)
+			{
+				D3DVECTOR n = { 0.0f, 0.0f, 0.0f };
+				if (v.nNormal != SW_X_NONE)
+				{
+					// 비균등 크기 변환은 없다고 보고 3x3 부분만 적용한 다음 정규화한다.
+					const float* N = &mesh.Normals[(size_t)v.nNormal * 3];
+					D3DVECTOR t;
+					t.x = N[0] * M._11 + N[1] * M._21 + N[2] * M._31;
+					t.y = N[0] * M._12 + N[1] * M._22 + N[2] * M._32;
+					t.z = N[0] * M._13 + N[1] * M._23 + N[2] * M._33;
+					SwVec3Normalize(&n, &t);
+				}
+				pDst[0] = n.x;
+				pDst[1] = n.y;
+				pDst[2] = n.z;
+				pDst += 3;
+			}
+
+			if (bTexCoords)
+			{
+				if (!mesh.TexCoords.empty())
+				{
+					pDst[0] = mesh.TexCoords[(size_t)v.nPosition * 2];
+					pDst[1] = mesh.TexCoords[(size_t)v.nPosition * 2 + 1];
+				}
+				else
+				{
+					pDst[0] = pDst[1] = 0.0f;
+				}
+			}
+		}
+	};
+	if (pThreadPool)
+	{
+		pThreadPool->ParallelFor(nBatches, packBatch);
+	}
+	else
+	{
+		for (UINT b = 0; b < nBatches; ++b)
+			packBatch(b, 0);
+	}
+
+	// 삼각형을 재질 순서로 안정 정렬(계수 정렬)하고 부분 집합 범위를 만든다.
+	const UINT nNumMaterials = (UINT)pOut->Materials.size();
+	const UINT nNumFaces = (UINT)triAttributes.size();
+	std::vector<UINT> first(nNumMaterials + 1, 0);
+	for (UINT f = 0; f < nNumFaces; ++f)
+		++first[triAttributes[f] + 1];
+	for (UINT a = 0; a < nNumMaterials; ++a)
+		first[a + 1] += first[a];
+
+	pOut->Indices.resize((size_t)nNumFaces * 3);
+	std::vector<UINT> next(first.begin(), first.end() - 1);
+	for (UINT f = 0; f < nNumFaces; ++f)
+	{
+		UINT nDst = next[triAttributes[f]]++;
+		memcpy(&pOut->Indices[(size_t)nDst * 3], &triVertices[(size_t)f * 3], 3 * sizeof(DWORD));
+	}
+
+	pOut->Subsets.clear();
+	for (UINT a = 0; a < nNumMaterials; ++a)
+	{
+		if (first[a] == first[a + 1])
+			continue;
+
+		SW_MESHSUBSET subset;
+		subset.AttribId = a;
+		subset.FaceStart = first[a];
+		subset.FaceCount = first[a + 1] - first[a];
+
+		DWORD nMin = SW_X_NONE, nMax = 0;
+		for (size_t i = (size_t)first[a] * 3; i < (size_t)first[a + 1] * 3; ++i)
+		{
+			nMin = std::min(nMin, pOut->Indices[i]);
+			nMax = std::max(nMax, pOut->Indices[i]);
+		}
+		subset.VertexStart = nMin;
+		subset.VertexCount = nMax - nMin + 1;
+		pOut->Subsets.push_back(subset);
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// 진입점
+//-----------------------------------------------------------------------------
+HRESULT SwLoadMeshFromXInMemory(const void* pData, size_t nSize, SW_MESHDATA* pMesh, CSwThreadPool* pThreadPool)
+{
+	if (pData == NULL || pMesh == NULL)
+		return D3DERR_INVALIDCALL;
+
+	// 머리: "xof 0302txt 0032" (형식 4바이트, 버전 4바이트, 종류 4바이트, 실수 크기 4바이트)
+	const char* p = (const char*)pData;
+	if (nSize < 16 || memcmp(p, "xof ", 4) != 0)
+		return E_FAIL;
+	if (memcmp(p + 8, "txt ", 4) != 0)
+		return D3DERR_NOTAVAILABLE;
+
+	if (pThreadPool == NULL && nSize >= SW_X_PARALLEL_MIN_FILESIZE)
+		pThreadPool = SwGetDefaultThreadPool();
+
+	CXFileParser parser(p + 16, p + nSize, pThreadPool);
+	if (!parser.ParseFile() || parser.m_Meshes.empty())
+		return E_FAIL;
+	if (!BuildMeshData(parser.m_Meshes, pMesh, pThreadPool))
+		return E_FAIL;
+
+	SwWeldMeshVertices(pMesh);
+	SwOptimizeVertexCache(pMesh, pThreadPool);
+	SwOptimizeVertexFetch(pMesh);
+	return S_OK;
+}
+
+HRESULT SwLoadMeshFromX(const char* pFilename, SW_MESHDATA* pMesh, CSwThreadPool* pThreadPool)
+{
+	if (pFilename == NULL || pMesh == NULL)
+		return D3DERR_INVALIDCALL;
+
+	CSwMappedFile file;
+	HRESULT hr = file.Open(pFilename);
+	if (FAILED(hr))
+		return hr;
+
+	return SwLoadMeshFromXInMemory(file.GetData(), file.GetSize(), pMesh, pThreadPool);
+}
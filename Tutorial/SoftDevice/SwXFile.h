@@ -0,0 +1,27 @@
+//-----------------------------------------------------------------------------
+// 파일:	SwXFile.h
+//
+// 설명:	텍스트 형식 X 파일('xof 0302txt') 로더. D3DXLoadMeshFromX()를 대신한다.
+//		파일을 메모리 맵으로 연결한 다음 그 자리에서 토큰을 읽으므로 토큰마다 문자열을 만들지 않고,
+//		실수는 std::from_chars로 변환한다. 정점, 면 배열이 길면 스레드 풀로 나누어 읽는다.
+//
+//		지원하는 템플릿: Frame, FrameTransformMatrix, Mesh, MeshNormals, MeshTextureCoords,
+//		MeshMaterialList, Material, TextureFilename. 그 밖의 데이터 개체는 건너뛴다.
+//		D3DX와 같이 모든 메시를 프레임 변환을 적용하여 하나로 합치고,
+//		다각형은 부채꼴로 삼각형화하며, 법선이 다른 꼭지점은 정점을 나눈다.
+//		마지막으로 같은 정점을 합치고(SwWeldMeshVertices), 부분 집합마다 정점 캐시 최적화(SwOptimizeVertexCache)를
+//		거친 다음, 정점을 처음 쓰이는 순서로 다시 배열한다(SwOptimizeVertexFetch).
+//-----------------------------------------------------------------------------
+#pragma once
+
+#include "SwMesh.h"
+
+class CSwThreadPool;
+
+// 파일을 읽어 pMesh를 채운다. pThreadPool이 NULL이면 큰 파일에서만 기본 풀(SwGetDefaultThreadPool())을 쓴다.
+// 파일이 없으면 D3DERR_NOTFOUND, 이진 형식이면 D3DERR_NOTAVAILABLE, 내용이 잘못되었으면 E_FAIL.
+HRESULT	SwLoadMeshFromX(const char* pFilename, SW_MESHDATA* pMesh, CSwThreadPool* pThreadPool = NULL);
+
+// 메모리에 있는 X 파일 내용을 읽는다.
+HRESULT	SwLoadMeshFromXInMemory(const void* pData, size_t nSize, SW_MESHDATA* pMesh,
+			CSwThreadPool* pThreadPool = NULL);
@@ -14,6 +14,10 @@
 // Direct3D9를 사용하기 위한 헤더
 #include <d3d9.h>
 
+#include "SwTrace.h"
+
+#include <string.h>
+
 #pragma warning(disable: 28251)	// WinMain 주석 오류 경고
 
 //-----------------------------------------------------------------------------
@@ -117,6 +121,13 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut02_Vertices.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -124,26 +135,30 @@ VOID Cleanup()
 //-----------------------------------------------------------------------------
 VOID Render()
 {
+	SW_TRACE_SCOPE("Frame");
+
 	// 후면 버퍼를 파란색(0, 0, 255)으로 지운다.
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
 
 	// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
+		SW_TRACE_SCOPE("Scene");
+
 		// 정점 버퍼의 삼각형을 그린다.
 		// 1. 정점 정보가 담겨 있는 정점 버퍼를 출력 스트림으로 할당한다.
 		g_pd3dDevice->SetStreamSource(0, g_pVB, 0, sizeof(CUSTOMVERTEX));
 		// 2. D3D에게 정점 셰이더 정보를 지정한다. 대부분의 경우에는 FVF만 지정한다.
 		g_pd3dDevice->SetFVF(D3DFVF_CUSTOMVERTEX);
 		// 3. 기하 정보를 출력하기 위한 DrawPrimitive() 함수 호출
-		g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+		SW_TRACE_CALL("Draw", g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1));
 
 		// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	// 후면 버퍼를 전면 버퍼와 전환
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
 }
 
 //-----------------------------------------------------------------------------
@@ -165,8 +180,11 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 //-----------------------------------------------------------------------------
 // 이 프로그램의 시작점
 //-----------------------------------------------------------------------------
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+
 	// 윈도우 클래스 등록
 	WNDCLASSEX wc =
 	{
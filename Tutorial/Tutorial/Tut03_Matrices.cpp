@@ -17,12 +17,15 @@
 //-----------------------------------------------------------------------------
 #pragma comment(lib, "d3d9.lib")
 #pragma comment(lib, "d3dx9.lib")
-#pragma comment(lib, "winmm.lib")
 
 #include <Windows.h>
-#include <mmsystem.h>			// timeGetTime() 함수를 사용하기 위해서 포함하는 헤더
 #include <d3dx9.h>
 
+#include "SwClock.h"
+#include "SwTrace.h"
+
+#include <string.h>
+
 #pragma warning(disable: 28251)	// WinMain 주석 오류 경고
 
 //-----------------------------------------------------------------------------
@@ -31,6 +34,7 @@
 LPDIRECT3D9				g_pD3D = NULL;			// D3D 디바이스를 생성할 D3D 객체 변수
 LPDIRECT3DDEVICE9		g_pd3dDevice = NULL;	// 렌더링에 사용될 D3D 디바이스
 LPDIRECT3DVERTEXBUFFER9 g_pVB = NULL;			// 정점을 보관할 정점 버퍼
+CSwClock				g_Clock;				// 애니메이션 시각(SwClock.h)
 
 // 사용자 정점을 정의할 구조체
 struct CUSTOMVERTEX
@@ -125,10 +129,12 @@ HRESULT InitGeometry()
 //-----------------------------------------------------------------------------
 VOID SetupMatrices()
 {
+	SW_TRACE_SCOPE("SetupMatrices");
+
 	// 월드 행렬
 	D3DXMATRIXA16 matWorld;
 
-	UINT iTime = timeGetTime() % 1000;							// float 연산의 정밀도를 위해서 1000으로 나머지 연산한다.
+	UINT iTime = g_Clock.GetTimeMs() % 1000;					// float 연산의 정밀도를 위해서 1000으로 나머지 연산한다.
 	FLOAT fAngle = iTime * (2.0f * D3DX_PI) / 1000.0f;			// 1000밀리초마다 한 바퀴씩(2 * pi) 회전 애니메이션 행렬을 만든다.
 	D3DXMatrixRotationY(&matWorld, fAngle);						// Y축을 회전축으로 회전 행렬을 생성한다.
 	g_pd3dDevice->SetTransform(D3DTS_WORLD, &matWorld);			// 생성한 회전 행렬을 월드 행렬로 디바이스에 설정한다.
@@ -165,6 +171,16 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	// -record로 모은 시각표를 파일로 쓴다.
+	g_Clock.StopRecording();
+
+	// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut03_Matrices.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -172,8 +188,13 @@ VOID Cleanup()
 //-----------------------------------------------------------------------------
 VOID Render()
 {
+	SW_TRACE_SCOPE("Frame");
+
+	// 이 프레임의 애니메이션 시각을 정한다.
+	g_Clock.Tick();
+
 	// 후면 버퍼를 검은색(0, 0, 0)으로 지운다.
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 0), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET, D3DCOLOR_XRGB(0, 0, 0), 1.0f, 0));
 
 	// 월드, 뷰, 프로젝션 행렬을 설정한다.
 	SetupMatrices();
@@ -181,20 +202,22 @@ VOID Render()
 	// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
+		SW_TRACE_SCOPE("Scene");
+
 		// 정점 버퍼의 삼각형을 그린다.
 		// 1. 정점 정보가 담겨 있는 정점 버퍼를 출력 스트림으로 할당한다.
 		g_pd3dDevice->SetStreamSource(0, g_pVB, 0, sizeof(CUSTOMVERTEX));
 		// 2. D3D에게 정점 셰이더 정보를 지정한다. 대부분의 경우에는 FVF만 지정한다.
 		g_pd3dDevice->SetFVF(D3DFVF_CUSTOMVERTEX);
 		// 3. 기하 정보를 출력하기 위한 DrawPrimitive() 함수 호출
-		g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1);
+		SW_TRACE_CALL("Draw", g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLELIST, 0, 1));
 
 		// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	// 후면 버퍼를 전면 버퍼와 전환
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
 }
 
 //-----------------------------------------------------------------------------
@@ -216,8 +239,13 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 //-----------------------------------------------------------------------------
 // 이 프로그램의 시작점
 //-----------------------------------------------------------------------------
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+	// -fixed[:간격ms]이면 고정 간격, -replay:<파일>이면 기록한 시각표로 움직인다. -record:<파일>은 시각표를 남긴다.
+	SwConfigureClock(&g_Clock, lpCmdLine);
+
 	// 윈도우 클래스 등록
 	WNDCLASSEX wc =
 	{
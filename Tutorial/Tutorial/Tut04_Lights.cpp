@@ -10,12 +10,15 @@
 //-----------------------------------------------------------------------------
 #pragma comment(lib, "d3d9.lib")
 #pragma comment(lib, "d3dx9.lib")
-#pragma comment(lib, "winmm.lib")
 
 #include <Windows.h>
-#include <mmsystem.h>
 #include <d3dx9.h>
 
+#include "SwClock.h"
+#include "SwTrace.h"
+
+#include <string.h>
+
 #pragma warning(disable: 28251)	// WinMain 주석 오류 경고
 
 //-----------------------------------------------------------------------------
@@ -24,6 +27,7 @@
 LPDIRECT3D9				g_pD3D = NULL;			// D3D 디바이스를 생성할 D3D 객체 변수
 LPDIRECT3DDEVICE9		g_pd3dDevice = NULL;	// 렌더링에 사용될 D3D 디바이스
 LPDIRECT3DVERTEXBUFFER9 g_pVB = NULL;			// 정점을 보관할 정점 버퍼
+CSwClock				g_Clock;				// 애니메이션 시각(SwClock.h)
 
 // 사용자 정점을 정의할 구조체
 // 광원을 사용하기 때문에 법선 벡터가 있어야 한다는 사실을 명심하자.
@@ -121,10 +125,12 @@ HRESULT InitGeometry()
 //-----------------------------------------------------------------------------
 VOID SetupMatrices()
 {
+	SW_TRACE_SCOPE("SetupMatrices");
+
 	// 월드 행렬
 	D3DXMATRIXA16 matWorld;
 	D3DXMatrixIdentity(&matWorld);								// 월드 행렬을 단위 행렬로 생성
-	D3DXMatrixRotationX(&matWorld, timeGetTime() / 500.0f);		// X축을 중심으로 회전 행렬 생성
+	D3DXMatrixRotationX(&matWorld, g_Clock.GetTimeMs() / 500.0f);	// X축을 중심으로 회전 행렬 생성
 	g_pd3dDevice->SetTransform(D3DTS_WORLD, &matWorld);			// 디바이스에 월드 행렬 설정
 
 	// 뷰 행렬을 정의하기 위해서는 3가지 값이 필요하다.
@@ -151,6 +157,8 @@ VOID SetupMatrices()
 //-----------------------------------------------------------------------------
 VOID SetupLights()
 {
+	SW_TRACE_SCOPE("SetupLights");
+
 	// 재질(material) 설정
 	// 재질은 디바이스에 단 하나만 설정될 수 있다.
 	D3DMATERIAL9 mtrl;
@@ -171,7 +179,7 @@ VOID SetupLights()
 	light.Diffuse.g = 1.0f;
 	light.Diffuse.b = 1.0f;
 	// 광원의 방향
-	vecDir = D3DXVECTOR3(cosf(timeGetTime() / 350.0f), 1.0f, sinf(timeGetTime() / 350.0f));
+	vecDir = D3DXVECTOR3(cosf(g_Clock.GetTimeMs() / 350.0f), 1.0f, sinf(g_Clock.GetTimeMs() / 350.0f));
 
 	D3DXVec3Normalize((D3DXVECTOR3*)&light.Direction, &vecDir);		// 광원의 방향을 단위 벡터로 만든다.
 	light.Range = 1000.0f;											// 광원이 다다를 수 있는 최대 거리
@@ -196,6 +204,16 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	// -record로 모은 시각표를 파일로 쓴다.
+	g_Clock.StopRecording();
+
+	// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut04_Lights.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -203,8 +221,14 @@ VOID Cleanup()
 //-----------------------------------------------------------------------------
 VOID Render()
 {
+	SW_TRACE_SCOPE("Frame");
+
+	// 이 프레임의 애니메이션 시각을 정한다.
+	g_Clock.Tick();
+
 	// 후면 버퍼와 Z 버퍼를 지운다
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
+		D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
 
 	// 광원과 재질 설정
 	SetupLights();
@@ -215,20 +239,22 @@ VOID Render()
 	// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
+		SW_TRACE_SCOPE("Scene");
+
 		// 정점 버퍼의 삼각형을 그린다.
 		// 1. 정점 정보가 담겨 있는 정점 버퍼를 출력 스트림으로 할당한다.
 		g_pd3dDevice->SetStreamSource(0, g_pVB, 0, sizeof(CUSTOMVERTEX));
 		// 2. D3D에게 정점 셰이더 정보를 지정한다. 대부분의 경우에는 FVF만 지정한다.
 		g_pd3dDevice->SetFVF(D3DFVF_CUSTOMVERTEX);
 		// 3. 기하 정보를 출력하기 위한 DrawPrimitive() 함수 호출
-		g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2 * 50 - 2);
+		SW_TRACE_CALL("Draw", g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2 * 50 - 2));
 
 		// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	// 후면 버퍼를 전면 버퍼와 전환
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
 }
 
 //-----------------------------------------------------------------------------
@@ -250,8 +276,13 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 //-----------------------------------------------------------------------------
 // 이 프로그램의 시작점
 //-----------------------------------------------------------------------------
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+	// -fixed[:간격ms]이면 고정 간격, -replay:<파일>이면 기록한 시각표로 움직인다. -record:<파일>은 시각표를 남긴다.
+	SwConfigureClock(&g_Clock, lpCmdLine);
+
 	// 윈도우 클래스 등록
 	WNDCLASSEX wc =
 	{
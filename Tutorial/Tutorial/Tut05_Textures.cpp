@@ -14,12 +14,17 @@
 //-----------------------------------------------------------------------------
 #pragma comment(lib, "d3d9.lib")
 #pragma comment(lib, "d3dx9.lib")
-#pragma comment(lib, "winmm.lib")
 
 #include <Windows.h>
-#include <mmsystem.h>
 #include <d3dx9.h>
 
+#include "SwClock.h"
+#include "SwResource.h"
+#include "SwTextureCache.h"
+#include "SwTrace.h"
+
+#include <string.h>
+
 #pragma warning(disable: 28251)	// WinMain 주석 오류 경고
 
 // SHOW_HOW_TO_USE_TCI가 선언된 것과 선언되지 않은 것의 컴파일 결과를 반드시 비교해 보자.
@@ -32,6 +37,7 @@ LPDIRECT3D9				g_pD3D = NULL;			// D3D 디바이스를 생성할 D3D 객체 변
 LPDIRECT3DDEVICE9		g_pd3dDevice = NULL;	// 렌더링에 사용될 D3D 디바이스
 LPDIRECT3DVERTEXBUFFER9 g_pVB = NULL;			// 정점을 보관할 정점 버퍼
 LPDIRECT3DTEXTURE9		g_pTexture = NULL;		// 텍스처 정보
+CSwClock				g_Clock;				// 애니메이션 시각(SwClock.h)
 
 // 사용자 정점을 정의할 구조체
 // 텍스처 좌표가 추가되었다는 것을 알 수 있다.
@@ -91,6 +97,28 @@ HRESULT InitD3D(HWND hWnd)
 	return S_OK;
 }
 
+//-----------------------------------------------------------------------------
+// 파일로부터 텍스처 생성
+// BMP 파일은 SwCreateCompressedTextureFromBitmap()으로 Kaiser 필터 밉 체인까지 만들어 BC1(DXT1)로 압축한다.
+// 압축 결과는 원본 옆의 .bc1.swt 캐시 파일로 남으므로 다음 실행부터는 캐시를 복사하기만 한다.
+// 텍스처 메모리는 32비트 텍스처의 1/8이다. BMP가 아니거나 지원하지 않는 형식이면 D3DX 함수로 읽는다.
+//-----------------------------------------------------------------------------
+HRESULT CreateTextureFromFile(const char* pFilename, LPDIRECT3DTEXTURE9* ppTexture)
+{
+	CSwTexture* pCompressed;
+	HRESULT hr = SwCreateCompressedTextureFromBitmap(pFilename, D3DFMT_DXT1, 0, &pCompressed);
+	if (hr == D3DERR_NOTFOUND)
+		return hr;
+	if (SUCCEEDED(hr))
+	{
+		hr = SwCreateD3DTextureFromCompressed(g_pd3dDevice, pCompressed, ppTexture);
+		pCompressed->Release();
+	}
+	if (FAILED(hr))
+		hr = D3DXCreateTextureFromFileA(g_pd3dDevice, pFilename, ppTexture);
+	return hr;
+}
+
 //-----------------------------------------------------------------------------
 // 기하 정보 초기화
 // 정점 버퍼와 텍스처 생성
@@ -104,11 +132,11 @@ HRESULT InitD3D(HWND hWnd)
 //-----------------------------------------------------------------------------
 HRESULT InitGeometry()
 {
-	// D3DX 계열 함수를 사용하여 파일로부터 텍스처 생성(banana.bmp)
-	if (FAILED(D3DXCreateTextureFromFile(g_pd3dDevice, "banana.bmp", &g_pTexture)))
+	// 파일로부터 텍스처 생성(banana.bmp)
+	if (FAILED(CreateTextureFromFile("banana.bmp", &g_pTexture)))
 	{
 		// 현재 폴더에 파일이 없으면 상위 폴더 검색
-		if (FAILED(D3DXCreateTextureFromFile(g_pd3dDevice, "..\\banana.bmp", &g_pTexture)))
+		if (FAILED(CreateTextureFromFile("..\\banana.bmp", &g_pTexture)))
 		{
 			// 텍스처 생성 실패
 			MessageBox(NULL, "Could not find banana.bmp", "Textures.exe", MB_OK);
@@ -164,10 +192,12 @@ HRESULT InitGeometry()
 //-----------------------------------------------------------------------------
 VOID SetupMatrices()
 {
+	SW_TRACE_SCOPE("SetupMatrices");
+
 	// 월드 행렬
 	D3DXMATRIXA16 matWorld;
 	D3DXMatrixIdentity(&matWorld);								// 월드 행렬을 단위 행렬로 생성
-	D3DXMatrixRotationX(&matWorld, timeGetTime() / 1000.0f);	// X축을 중심으로 회전 행렬 생성
+	D3DXMatrixRotationX(&matWorld, g_Clock.GetTimeMs() / 1000.0f);	// X축을 중심으로 회전 행렬 생성
 	g_pd3dDevice->SetTransform(D3DTS_WORLD, &matWorld);			// 디바이스에 월드 행렬 설정
 
 	// 뷰 행렬을 정의하기 위해서는 3가지 값이 필요하다.
@@ -205,6 +235,16 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	// -record로 모은 시각표를 파일로 쓴다.
+	g_Clock.StopRecording();
+
+	// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut05_Textures.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -212,8 +252,14 @@ VOID Cleanup()
 //-----------------------------------------------------------------------------
 VOID Render()
 {
+	SW_TRACE_SCOPE("Frame");
+
+	// 이 프레임의 애니메이션 시각을 정한다.
+	g_Clock.Tick();
+
 	// 후면 버퍼와 Z 버퍼를 지운다
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
+		D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
 
 	// 월드, 뷰, 프로젝션 행렬을 설정한다.
 	SetupMatrices();
@@ -221,10 +267,15 @@ VOID Render()
 	// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
+		SW_TRACE_SCOPE("Scene");
+
 		// 생성한 텍스처를 0번 텍스처 스테이지에 올린다.
 		// 텍스처 스테이지는 여러 장의 텍스처와 색깔 정보를 섞어서 출력할 때 사용된다.
 		// 여기서는 텍스처의 색깔과 정점의 색깔 정보를 modulate 연산으로 섞어서 출력한다.
 		g_pd3dDevice->SetTexture(0, g_pTexture);								// 0번 텍스처 스테이지에 텍스처 고정
+		g_pd3dDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);	// 확대 필터
+		g_pd3dDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);	// 축소 필터
+		g_pd3dDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);	// 밉 레벨 사이도 보간(삼선형)
 		g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_MODULATE);	// MODULATE 연산으로 색깔을 섞음
 		g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);	// 첫 번째 섞을 색은 텍스처 색
 		g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLORARG2, D3DTA_DIFFUSE);	// 두 번째 섞을 색은 정점 색
@@ -259,14 +310,14 @@ VOID Render()
 		// 2. D3D에게 정점 셰이더 정보를 지정한다. 대부분의 경우에는 FVF만 지정한다.
 		g_pd3dDevice->SetFVF(D3DFVF_CUSTOMVERTEX);
 		// 3. 기하 정보를 출력하기 위한 DrawPrimitive() 함수 호출
-		g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2 * 50 - 2);
+		SW_TRACE_CALL("Draw", g_pd3dDevice->DrawPrimitive(D3DPT_TRIANGLESTRIP, 0, 2 * 50 - 2));
 
 		// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	// 후면 버퍼를 전면 버퍼와 전환
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
 }
 
 //-----------------------------------------------------------------------------
@@ -288,8 +339,13 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 //-----------------------------------------------------------------------------
 // 이 프로그램의 시작점
 //-----------------------------------------------------------------------------
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+	// -fixed[:간격ms]이면 고정 간격, -replay:<파일>이면 기록한 시각표로 움직인다. -record:<파일>은 시각표를 남긴다.
+	SwConfigureClock(&g_Clock, lpCmdLine);
+
 	// 윈도우 클래스 등록
 	WNDCLASSEX wc =
 	{
@@ -5,6 +5,9 @@
 //		읽어들이는 것이 일반적이다. 다행스럽게도 D3DX에는 강력한 X파일 처리 기능이 있어서
 //		정점 버퍼, 인덱스 버퍼 생성 등의 많은 부분을 대신해준다. 이 예제에서는 D3DMESH를
 //		사용하여 파일을 읽어서 이 파일과 연관된 재질과 텍스처를 함께 사용하는 것을 알아보자.
+//		파일 읽기는 SoftDevice의 SwLoadMeshFromXCached()로 하고(이진 캐시 사용), 읽은 데이터로 D3DXMESH를 만든다.
+//		메시 파싱과 텍스처 디코딩, 밉 생성, 압축은 CSwAsyncLoader의 작업 스레드에서 하므로
+//		첫 프레임은 메시가 준비되는 대로 대체 텍스처로 그리고, 텍스처는 도착하는 대로 바꾼다.
 //
 //		이번에 소개되지는 않지만 나중에 사용하게 될 강력한 기능 중에 하나가 FVF를 지정하여
 //		새로운 메시를 복제(clone)하는 것이다. 이 기능을 사용하여 텍스처 좌표나 법선 벡터 등을
@@ -15,12 +18,25 @@
 //-----------------------------------------------------------------------------
 #pragma comment(lib, "d3d9.lib")
 #pragma comment(lib, "d3dx9.lib")
-#pragma comment(lib, "winmm.lib")
 
 #include <Windows.h>
-#include <mmsystem.h>
 #include <d3dx9.h>
 
+#include "SwAsyncLoader.h"
+#include "SwClock.h"
+#include "SwIndexData.h"
+#include "SwMeshCache.h"
+#include "SwResource.h"
+#include "SwTextureCache.h"
+#include "SwTextureManager.h"
+#include "SwTrace.h"
+
+#include <chrono>
+#include <memory>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
 #pragma warning(disable: 28251)	// WinMain 주석 오류 경고
 #pragma warning(disable: 6031)	// 반환값 무시 오류 경고
 
@@ -29,12 +45,30 @@
 //-----------------------------------------------------------------------------
 LPDIRECT3D9				g_pD3D = NULL;				// D3D 디바이스를 생성할 D3D 객체 변수
 LPDIRECT3DDEVICE9		g_pd3dDevice = NULL;		// 렌더링에 사용될 D3D 디바이스
+CSwClock				g_Clock;					// 애니메이션 시각(SwClock.h)
 
 LPD3DXMESH				g_pMesh = NULL;				// 메시 객체
 D3DMATERIAL9*			g_pMeshMaterials = NULL;	// 메시에서 사용할 재질
-LPDIRECT3DTEXTURE9*		g_pMeshTextures = NULL;		// 메시에서 사용할 텍스처
 DWORD					g_dwNumMaterials = 0L;		// 메시에서 사용중인 재질의 개수
 
+//-----------------------------------------------------------------------------
+// 텍스처 자리. 재질은 이것을 가리킨다. 읽는 동안에는 대체 텍스처가 들어 있다가
+// 작업 스레드가 압축을 마치면 렌더 스레드에서 진짜 텍스처로 바뀐다.
+//-----------------------------------------------------------------------------
+struct TEXTURESLOT
+{
+	LPDIRECT3DTEXTURE9	pTexture;
+};
+
+TEXTURESLOT**			g_ppMeshTextures = NULL;	// 메시에서 사용할 텍스처
+CSwTextureManager*		g_pTextureManager = NULL;	// 재질들이 같은 텍스처를 나누어 쓰도록 관리
+CSwAsyncLoader*			g_pLoader = NULL;			// 메시와 텍스처를 작업 스레드에서 읽는다
+LPDIRECT3DTEXTURE9		g_pPlaceholder = NULL;		// 텍스처를 읽는 동안 대신 쓰는 흰색 텍스처
+
+std::chrono::steady_clock::time_point	g_tLoadStart;			// InitGeometry()를 부른 시각
+bool					g_bFirstFrameReported = false;
+bool					g_bFullyLoadedReported = false;
+
 //-----------------------------------------------------------------------------
 // Direct3D 초기화
 //-----------------------------------------------------------------------------
@@ -73,90 +107,275 @@ HRESULT InitD3D(HWND hWnd)
 }
 
 //-----------------------------------------------------------------------------
-// 기하 정보 초기화
-// 메시 읽기, 재질과 텍스처 배열 생성
-//-----------------------------------------------------------------------------
-// 정점 버퍼를 생성하고 정점값을 채워넣는다.
-// 정점 버퍼란 기본적으로 정점 정보를 갖고 있는 메모리 블록이다.
-// 정점 버퍼를 생성한 다음에는 반드시 Lock()과 Unlock()으로 포인터를 얻어내서 정점 정보를 정점 버퍼에 써넣어야 한다.
-// 또한 D3D는 인덱스 버퍼도 사용 가능하다는 것을 명심하자.
-// 정점 버퍼나 인덱스 버퍼는 기본 시스템 메모리 외에 디바이스 메모리(비디오카드 메모리)에 생성될 수 있는데,
-// 대부분의 비디오카드에서는 이렇게 할 경우 엄청난 속도의 향상을 얻을 수 있다.
+// 텍스처 읽기 시작
+// 대체 텍스처를 넣은 자리를 바로 돌려주고, 디코딩과 압축은 작업 스레드에 맡긴다.
+// 작업 스레드는 SwCreateCompressedTextureFromBitmap()으로 Kaiser 필터 밉 체인까지 만들어 BC1(DXT1)로 압축하고,
+// 작업이 끝나면 렌더 스레드의 Poll()에서 SwCreateD3DTextureFromCompressed()로 D3D 텍스처를 만들어 자리를 바꾼다.
+// 압축 결과는 원본 옆의 .bc1.swt 캐시 파일로 남으므로 다음 실행부터는 캐시를 복사하기만 한다.
+// BMP가 아니거나 DXT1 텍스처를 만들 수 없으면 그때 D3DX 함수로 읽는다.
 //-----------------------------------------------------------------------------
-HRESULT InitGeometry()
+struct TEXTURELOAD
 {
-	// 재질을 임시로 보관할 버퍼 선언
-	LPD3DXBUFFER pD3DMtrlBuffer;
+	std::string		strPath;
+	CSwTexture*		pCompressed;
 
-	// Tiger.x 파일을 메시로 읽어들인다. 이 때 재질 정보도 함께 읽는다.
-	if (FAILED(D3DXLoadMeshFromX("Tiger.x", D3DXMESH_SYSTEMMEM,
-		g_pd3dDevice, NULL, &pD3DMtrlBuffer, NULL,
-		&g_dwNumMaterials, &g_pMesh)))
+	~TEXTURELOAD()
 	{
-		// 현재 폴더에 파일이 없으면 상위 폴더 검색
-		if (FAILED(D3DXLoadMeshFromX("..\\Tiger.x", D3DXMESH_SYSTEMMEM,
-			g_pd3dDevice, NULL, &pD3DMtrlBuffer, NULL,
-			&g_dwNumMaterials, &g_pMesh)))
+		if (pCompressed)
+			pCompressed->Release();
+	}
+};
+
+HRESULT LoadTextureAsync(const char* pPath, TEXTURESLOT** ppSlot)
+{
+	TEXTURESLOT* pSlot = new TEXTURESLOT;
+	pSlot->pTexture = g_pPlaceholder;
+	g_pPlaceholder->AddRef();
+
+	std::shared_ptr<TEXTURELOAD> pLoad(new TEXTURELOAD);
+	pLoad->strPath = pPath;
+	pLoad->pCompressed = NULL;
+
+	g_pLoader->Submit(
+		[pLoad]()
+		{
+			return SwCreateCompressedTextureFromBitmap(pLoad->strPath.c_str(), D3DFMT_DXT1, 0, &pLoad->pCompressed);
+		},
+		[pLoad, pSlot](HRESULT hr)
 		{
-			MessageBox(NULL, "Could not find tiger.x", "Meshes.exe", MB_OK);
+			LPDIRECT3DTEXTURE9 pTexture = NULL;
+			if (SUCCEEDED(hr))
+				hr = SwCreateD3DTextureFromCompressed(g_pd3dDevice, pLoad->pCompressed, &pTexture);
+			if (FAILED(hr))
+				hr = D3DXCreateTextureFromFileA(g_pd3dDevice, pLoad->strPath.c_str(), &pTexture);
 
-			return E_FAIL;
-		}
+			if (SUCCEEDED(hr))
+			{
+				pSlot->pTexture->Release();
+				pSlot->pTexture = pTexture;
+			}
+		});
+
+	*ppSlot = pSlot;
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 읽은 메시 캐시로 D3DXMESH와 재질 생성. 렌더 스레드에서 부른다.
+//-----------------------------------------------------------------------------
+HRESULT CreateMeshFromCache(const CSwMeshCache& meshCache, const SW_MESHLOADINFO& loadInfo)
+{
+	// 읽는 데 걸린 시간을 디버그 출력 창에 남긴다.
+	char strLoadInfo[256];
+	sprintf_s(strLoadInfo, "Tiger.x: %s, %.2f ms (hash %.2f, parse %.2f, write %.2f, open %.2f)\n",
+		loadInfo.bFromCache ? "warm start" : "cold start", loadInfo.fTotalMs,
+		loadInfo.fHashMs, loadInfo.fParseMs, loadInfo.fWriteMs, loadInfo.fOpenMs);
+	OutputDebugStringA(strLoadInfo);
+
+	// 정점 캐시 최적화로 삼각형당 캐시 실패 수(ACMR)와 정점당 변환 횟수(ATVR)가 얼마나 줄었는지 남긴다.
+	const SW_VCACHESTATS& before = meshCache.GetVCacheBefore();
+	const SW_VCACHESTATS& after = meshCache.GetVCacheAfter();
+	sprintf_s(strLoadInfo, "Tiger.x: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+		before.fACMR, after.fACMR, before.fATVR, after.fATVR);
+	OutputDebugStringA(strLoadInfo);
+
+	// 같은 정점을 합치고 처음 쓰이는 순서로 정점을 다시 배열한 결과(정점 수, 캐시 줄 단위 초과 읽기 비율)
+	const SW_VFETCHSTATS& fetchBefore = meshCache.GetVFetchBefore();
+	const SW_VFETCHSTATS& fetchAfter = meshCache.GetVFetchAfter();
+	sprintf_s(strLoadInfo, "Tiger.x: vertices %u -> %u, overfetch %.3f -> %.3f\n",
+		fetchBefore.nNumVertices, fetchAfter.nNumVertices, fetchBefore.fOverfetch, fetchAfter.fOverfetch);
+	OutputDebugStringA(strLoadInfo);
+
+	// 읽은 데이터로 메시를 만든다. 16비트로 모든 정점을 가리킬 수 없을 때만 32비트 인덱스를 쓴다.
+	const DWORD dwNumFaces = meshCache.GetNumFaces();
+	const DWORD dwNumIndices = dwNumFaces * 3;
+	const D3DFORMAT IndexFormat = SwChooseIndexFormat(meshCache.GetNumVertices());
+	if (FAILED(D3DXCreateMeshFVF(dwNumFaces, meshCache.GetNumVertices(),
+		D3DXMESH_SYSTEMMEM | (IndexFormat == D3DFMT_INDEX32 ? D3DXMESH_32BIT : 0),
+		meshCache.GetFVF(), g_pd3dDevice, &g_pMesh)))
+	{
+		return E_FAIL;
 	}
 
+	// 정점 버퍼는 FVF 순서로 채워져 있으므로 그대로 복사한다.
+	VOID* pVertices;
+	if (FAILED(g_pMesh->LockVertexBuffer(0, &pVertices)))
+		return E_FAIL;
+	memcpy(pVertices, meshCache.GetVertices(), meshCache.GetNumVertices() * meshCache.GetVertexSize());
+	g_pMesh->UnlockVertexBuffer();
+
+	VOID* pIndices;
+	if (FAILED(g_pMesh->LockIndexBuffer(0, &pIndices)))
+		return E_FAIL;
+	SwWriteIndices(meshCache.GetIndices(), dwNumIndices, 0, IndexFormat, pIndices);
+	g_pMesh->UnlockIndexBuffer();
+
+	// 삼각형은 재질 순서로 정렬되어 있으므로 부분 집합마다 속성 번호를 채우고 속성 테이블을 설정한다.
+	DWORD* pAttributes;
+	if (FAILED(g_pMesh->LockAttributeBuffer(0, &pAttributes)))
+		return E_FAIL;
+	const SW_MESHSUBSET* pSubsets = meshCache.GetSubsets();
+	for (UINT i = 0; i < meshCache.GetNumSubsets(); ++i)
+	{
+		const SW_MESHSUBSET& subset = pSubsets[i];
+		for (DWORD f = 0; f < subset.FaceCount; ++f)
+			pAttributes[subset.FaceStart + f] = subset.AttribId;
+	}
+	g_pMesh->UnlockAttributeBuffer();
+	g_pMesh->SetAttributeTable((const D3DXATTRIBUTERANGE*)pSubsets, meshCache.GetNumSubsets());
+
 	// 재질 정보와 텍스처 정보를 따로 뽑아낸다.
-	D3DXMATERIAL* d3dxMaterials = (D3DXMATERIAL*)pD3DMtrlBuffer->GetBufferPointer();
+	g_dwNumMaterials = meshCache.GetNumMaterials();
 	g_pMeshMaterials = new D3DMATERIAL9[g_dwNumMaterials];		// 재질 개수만큼 재질 구조체 배열 생성
-	g_pMeshTextures = new LPDIRECT3DTEXTURE9[g_dwNumMaterials];	// 재질 개수만큼 텍스처 배열 생성
+	g_ppMeshTextures = new TEXTURESLOT*[g_dwNumMaterials];		// 재질 개수만큼 텍스처 배열 생성
 
 	for (DWORD i = 0; i < g_dwNumMaterials; ++i)
 	{
 		// 재질 정보 복사
-		g_pMeshMaterials[i] = d3dxMaterials[i].MatD3D;
+		g_pMeshMaterials[i] = meshCache.GetMaterial(i);
 
 		// 주변 광원 정보를 Diffuse 정보로
 		g_pMeshMaterials[i].Ambient = g_pMeshMaterials[i].Diffuse;
 
-		g_pMeshTextures[i] = NULL;
-		if (d3dxMaterials[i].pTextureFilename != NULL &&
-			lstrlen(d3dxMaterials[i].pTextureFilename) > 0)
+		// 텍스처 읽기를 시작한다. 같은 파일을 쓰는 재질은 관리자가 이미 만든 자리를 나누어 준다.
+		// 현재 폴더에 없는 파일은 관리자가 상위 폴더도 검색한다.
+		g_ppMeshTextures[i] = NULL;
+		const char* pTextureFilename = meshCache.GetTextureFilename(i);
+		if (pTextureFilename[0] != '\0')
 		{
-			// 텍스처를 파일에서 로드한다.
-			if (FAILED(D3DXCreateTextureFromFile(g_pd3dDevice,
-				d3dxMaterials[i].pTextureFilename, &g_pMeshTextures[i])))
+			if (FAILED(g_pTextureManager->Acquire(pTextureFilename, &g_ppMeshTextures[i])))
 			{
-				// 텍스처가 현재 폴더에 없으면 상위 폴더 검색
-				const TCHAR* strPrefix = TEXT("..\\");
-				const int  lenPrefix = lstrlen(strPrefix);
-				TCHAR strTexture[MAX_PATH];
-				lstrcpyn(strTexture, strPrefix, MAX_PATH);
-				lstrcpyn(strTexture + lenPrefix,
-					d3dxMaterials[i].pTextureFilename, MAX_PATH - lenPrefix);
-				if (FAILED(D3DXCreateTextureFromFile(g_pd3dDevice,
-					strTexture, &g_pMeshTextures[i])))
-				{
-					MessageBox(NULL, "Could not find texture map", "Meshes.exe", MB_OK);
-				}
+				MessageBox(NULL, "Could not find texture map", "Meshes.exe", MB_OK);
 			}
 		}
 	}
 
-	// 임시로 생성한 재질 버퍼 소거
-	pD3DMtrlBuffer->Release();
+	// 텍스처 요청이 얼마나 공유되었는지 남긴다.
+	const SW_TEXMANAGERSTATS& texStats = g_pTextureManager->GetStats();
+	sprintf_s(strLoadInfo, "Textures: %u requests, %u name hits, %u content hits, %u loads, %u failed, "
+		"%u live (resolve %.2f ms)\n",
+		texStats.nRequests, texStats.nNameHits, texStats.nContentHits, texStats.nMisses, texStats.nFailures,
+		texStats.nEntries, texStats.fResolveMs);
+	OutputDebugStringA(strLoadInfo);
+
+	return S_OK;
+}
+
+//-----------------------------------------------------------------------------
+// 기하 정보 초기화
+// 메시 읽기를 작업 스레드에 맡기고 바로 돌아온다. 메시가 준비되기 전의 프레임은 배경만 그리고,
+// 메시가 준비된 다음에는 텍스처가 올 때까지 대체 텍스처로 그린다.
+//-----------------------------------------------------------------------------
+// 정점 버퍼를 생성하고 정점값을 채워넣는다.
+// 정점 버퍼란 기본적으로 정점 정보를 갖고 있는 메모리 블록이다.
+// 정점 버퍼를 생성한 다음에는 반드시 Lock()과 Unlock()으로 포인터를 얻어내서 정점 정보를 정점 버퍼에 써넣어야 한다.
+// 또한 D3D는 인덱스 버퍼도 사용 가능하다는 것을 명심하자.
+// 정점 버퍼나 인덱스 버퍼는 기본 시스템 메모리 외에 디바이스 메모리(비디오카드 메모리)에 생성될 수 있는데,
+// 대부분의 비디오카드에서는 이렇게 할 경우 엄청난 속도의 향상을 얻을 수 있다.
+//-----------------------------------------------------------------------------
+HRESULT InitGeometry()
+{
+	g_tLoadStart = std::chrono::steady_clock::now();
+
+	// 텍스처가 올 때까지 쓸 흰색 1x1 텍스처. 재질 색이 그대로 보인다.
+	if (FAILED(g_pd3dDevice->CreateTexture(1, 1, 1, 0, D3DFMT_X8R8G8B8, D3DPOOL_MANAGED, &g_pPlaceholder, NULL)))
+		return E_FAIL;
+	D3DLOCKED_RECT rect;
+	if (FAILED(g_pPlaceholder->LockRect(0, &rect, NULL, 0)))
+		return E_FAIL;
+	*(DWORD*)rect.pBits = 0xffffffff;
+	g_pPlaceholder->UnlockRect(0);
+
+	g_pLoader = new CSwAsyncLoader();
+	g_pTextureManager = new CSwTextureManager(
+		[](const char* pPath, void** ppSlot)
+		{
+			return LoadTextureAsync(pPath, (TEXTURESLOT**)ppSlot);
+		},
+		[](void* pSlot)
+		{
+			((TEXTURESLOT*)pSlot)->pTexture->Release();
+			delete (TEXTURESLOT*)pSlot;
+		});
+	g_pTextureManager->AddSearchPath("..\\");
+
+	// Tiger.x 파일을 메시 데이터로 읽어들인다. 이 때 재질 정보도 함께 읽는다.
+	// SwLoadMeshFromXCached()는 처음 읽을 때 Tiger.x.swm 이진 캐시를 만들어 두고,
+	// 다음 실행부터는 파싱 없이 캐시를 메모리 맵으로 열기만 한다.
+	struct MESHLOAD
+	{
+		CSwMeshCache	meshCache;
+		SW_MESHLOADINFO	loadInfo;
+	};
+	std::shared_ptr<MESHLOAD> pLoad(new MESHLOAD);
+
+	g_pLoader->Submit(
+		[pLoad]()
+		{
+			HRESULT hr = SwLoadMeshFromXCached("Tiger.x", &pLoad->meshCache, &pLoad->loadInfo);
+			if (FAILED(hr))
+			{
+				// 현재 폴더에 파일이 없으면 상위 폴더 검색
+				hr = SwLoadMeshFromXCached("..\\Tiger.x", &pLoad->meshCache, &pLoad->loadInfo);
+			}
+			return hr;
+		},
+		[pLoad](HRESULT hr)
+		{
+			if (FAILED(hr))
+			{
+				MessageBox(NULL, "Could not find tiger.x", "Meshes.exe", MB_OK);
+				PostQuitMessage(0);
+			}
+			else if (FAILED(CreateMeshFromCache(pLoad->meshCache, pLoad->loadInfo)))
+			{
+				PostQuitMessage(0);
+			}
+		});
 
 	return S_OK;
 }
 
+//-----------------------------------------------------------------------------
+// 읽기 시간 보고
+// 메시를 처음 그린 프레임(대체 텍스처 포함)과 모든 텍스처가 바뀐 시각을 디버그 출력 창에 남긴다.
+//-----------------------------------------------------------------------------
+VOID ReportLoadTimes()
+{
+	if (g_pMesh == NULL)
+		return;
+
+	const double fElapsedMs = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - g_tLoadStart).count();
+
+	char strLoadInfo[128];
+	if (!g_bFirstFrameReported)
+	{
+		g_bFirstFrameReported = true;
+		sprintf_s(strLoadInfo, "Time to first frame: %.1f ms (%u textures pending)\n",
+			fElapsedMs, g_pLoader->GetPendingCount());
+		OutputDebugStringA(strLoadInfo);
+	}
+	if (!g_bFullyLoadedReported && g_pLoader->GetPendingCount() == 0)
+	{
+		g_bFullyLoadedReported = true;
+		sprintf_s(strLoadInfo, "Time to fully loaded: %.1f ms\n", fElapsedMs);
+		OutputDebugStringA(strLoadInfo);
+	}
+}
+
 //-----------------------------------------------------------------------------
 // 행렬 설정
 // 행렬에는 3가지가 있으며, 각각 월드, 뷰, 프로젝션 행렬이다.
 //-----------------------------------------------------------------------------
 VOID SetupMatrices()
 {
+	SW_TRACE_SCOPE("SetupMatrices");
+
 	// 월드 행렬
 	D3DXMATRIXA16 matWorld;
 	D3DXMatrixIdentity(&matWorld);								// 월드 행렬을 단위 행렬로 생성
-	D3DXMatrixRotationY(&matWorld, timeGetTime() / 1000.0f);	// Y축을 중심으로 회전 행렬 생성
+	D3DXMatrixRotationY(&matWorld, g_Clock.GetTimeMs() / 1000.0f);	// Y축을 중심으로 회전 행렬 생성
 	g_pd3dDevice->SetTransform(D3DTS_WORLD, &matWorld);			// 디바이스에 월드 행렬 설정
 
 	// 뷰 행렬을 정의하기 위해서는 3가지 값이 필요하다.
@@ -186,16 +405,26 @@ VOID Cleanup()
 	if (g_pMeshMaterials != NULL)
 		delete[] g_pMeshMaterials;
 
-	if (g_pMeshTextures)
+	// 읽는 중인 작업은 버린다. 마무리하지 않은 텍스처 자리에는 대체 텍스처가 그대로 있다.
+	if (g_pLoader != NULL)
+		delete g_pLoader;
+
+	if (g_ppMeshTextures)
 	{
 		for (DWORD i = 0; i < g_dwNumMaterials; ++i)
 		{
-			if (g_pMeshTextures[i])
-				g_pMeshTextures[i]->Release();
+			if (g_ppMeshTextures[i])
+				g_pTextureManager->Release(g_ppMeshTextures[i]);
 		}
-		delete[] g_pMeshTextures;
+		delete[] g_ppMeshTextures;
 	}
 
+	if (g_pTextureManager != NULL)
+		delete g_pTextureManager;
+
+	if (g_pPlaceholder != NULL)
+		g_pPlaceholder->Release();
+
 	if (g_pMesh != NULL)
 		g_pMesh->Release();
 
@@ -204,6 +433,16 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	// -record로 모은 시각표를 파일로 쓴다.
+	g_Clock.StopRecording();
+
+	// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut06_Meshes.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -211,8 +450,17 @@ VOID Cleanup()
 //-----------------------------------------------------------------------------
 VOID Render()
 {
+	SW_TRACE_SCOPE("Frame");
+
+	// 이 프레임의 애니메이션 시각을 정한다.
+	g_Clock.Tick();
+
+	// 끝난 읽기 작업을 마무리한다(메시 생성, 텍스처 교체).
+	SW_TRACE_CALL("Poll", g_pLoader->Poll());
+
 	// 후면 버퍼와 Z 버퍼를 지운다
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
+		D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
 
 	// 월드, 뷰, 프로젝션 행렬을 설정한다.
 	SetupMatrices();
@@ -220,23 +468,27 @@ VOID Render()
 	// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
+		SW_TRACE_SCOPE("Scene");
+
 		// 메시는 재질이 다른 메시별로 부분 집합을 이루고 있다.
 		// 이들을 루프를 수행해서 모두 그려준다.
 		for (DWORD i = 0; i < g_dwNumMaterials; ++i)
 		{
 			// 부분 집합 메시의 재질과 텍스처 생성
 			g_pd3dDevice->SetMaterial(&g_pMeshMaterials[i]);
-			g_pd3dDevice->SetTexture(0, g_pMeshTextures[i]);
+			g_pd3dDevice->SetTexture(0, g_ppMeshTextures[i] ? g_ppMeshTextures[i]->pTexture : NULL);
 
 			// 부분 집합 메시 출력
-			g_pMesh->DrawSubset(i);
+			SW_TRACE_CALL("Draw", g_pMesh->DrawSubset(i));
 		}
 		// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	// 후면 버퍼를 전면 버퍼와 전환
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
+
+	ReportLoadTimes();
 }
 
 //-----------------------------------------------------------------------------
@@ -258,8 +510,13 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 //-----------------------------------------------------------------------------
 // 이 프로그램의 시작점
 //-----------------------------------------------------------------------------
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+	// -fixed[:간격ms]이면 고정 간격, -replay:<파일>이면 기록한 시각표로 움직인다. -record:<파일>은 시각표를 남긴다.
+	SwConfigureClock(&g_Clock, lpCmdLine);
+
 	// 윈도우 클래스 등록
 	WNDCLASSEX wc =
 	{
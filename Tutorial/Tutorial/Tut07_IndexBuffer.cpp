@@ -9,12 +9,17 @@
 //-----------------------------------------------------------------------------
 #pragma comment(lib, "d3d9.lib")
 #pragma comment(lib, "d3dx9.lib")
-#pragma comment(lib, "winmm.lib")
 
 #include <Windows.h>
 #include <d3d9.h>
 #include <d3dx9.h>
 
+#include "SwClock.h"
+#include "SwIndexData.h"
+#include "SwTrace.h"
+
+#include <string.h>
+
 #pragma warning(disable: 28251)	// WinMain 주석 오류 경고
 #pragma warning(disable: 6031)	// 반환값 무시 오류 경고
 
@@ -25,6 +30,7 @@ LPDIRECT3D9				g_pD3D = NULL;				// D3D 디바이스를 생성할 D3D 객체 변
 LPDIRECT3DDEVICE9		g_pd3dDevice = NULL;		// 렌더링에 사용될 D3D 디바이스
 LPDIRECT3DVERTEXBUFFER9	g_pVB = NULL;				// 정점을 보관할 정점 버퍼
 LPDIRECT3DINDEXBUFFER9	g_pIB = NULL;				// 인덱스를 보관할 인덱스 버퍼
+CSwClock				g_Clock;					// 애니메이션 시각(SwClock.h)
 
 // 사용자 정점을 정의할 구조체
 struct CUSTOMVERTEX
@@ -36,12 +42,6 @@ struct CUSTOMVERTEX
 // 사용자 정점 구조체에 관한 정보를 나타내는 FVF 값
 #define D3DFVF_CUSTOMVERTEX (D3DFVF_XYZ | D3DFVF_DIFFUSE)
 
-struct MYINDEX
-{
-	WORD _0, _1, _2;		// 일반적으로 인덱스는 16비트의 크기를 갖는다.
-							// 32비트의 크기도 가능하지만 구형 그래픽카드(TNT급, 지금은 해당X)에서는 지원되지 않는다.
-};
-
 //-----------------------------------------------------------------------------
 // Direct3D 초기화
 //-----------------------------------------------------------------------------
@@ -129,21 +129,26 @@ HRESULT InitVB()
 HRESULT InitIB()
 {
 	// 상자(Cube)를 렌더링하기 위한 12개의 면 선언
-	MYINDEX indices[] =
+	// 인덱스는 32비트로 적어 두고 버퍼에 넣을 때 형식에 맞게 바꾼다.
+	const DWORD indices[] =
 	{
-		{ 0, 1, 2 }, { 0, 2, 3 },		// 윗면
-		{ 4, 6, 5 }, { 4, 7, 6 },		// 아랫면
-		{ 0, 3, 7 }, { 0, 7, 4 },		// 왼면
-		{ 1, 5, 6 }, { 1, 6, 2 },		// 오른면
-		{ 3, 2, 6 }, { 3, 6, 7 },		// 앞면
-		{ 0, 4, 5 }, { 0, 5, 1 },		// 뒷면
+		0, 1, 2,  0, 2, 3,		// 윗면
+		4, 6, 5,  4, 7, 6,		// 아랫면
+		0, 3, 7,  0, 7, 4,		// 왼면
+		1, 5, 6,  1, 6, 2,		// 오른면
+		3, 2, 6,  3, 6, 7,		// 앞면
+		0, 4, 5,  0, 5, 1,		// 뒷면
 	};
+	const UINT nNumIndices = sizeof(indices) / sizeof(indices[0]);
 
 	// 인덱스 버퍼 생성
-	// D3DFMT_INDEX16은 인덱스의 단위가 16비트라는 것이다.
-	// 우리는 MYINDEX 구조체에서 WORD형으로 선언했으므로 D3DFMT_INDEX16을 사용한다.
-	if (FAILED(g_pd3dDevice->CreateIndexBuffer(12 * sizeof(MYINDEX),
-		0, D3DFMT_INDEX16, D3DPOOL_DEFAULT, &g_pIB, NULL)))
+	// 인덱스는 16비트(D3DFMT_INDEX16)나 32비트(D3DFMT_INDEX32) 크기를 갖는다.
+	// 32비트는 구형 그래픽카드(TNT급, 지금은 해당X)에서는 지원되지 않고 메모리도 두 배로 들기 때문에
+	// 정점이 65536개를 넘지 않으면 16비트를 쓴다. 상자는 정점이 8개이므로 16비트가 된다.
+	const D3DFORMAT IndexFormat = SwChooseIndexFormat(8);
+	const UINT nIndexSize = (IndexFormat == D3DFMT_INDEX32) ? sizeof(DWORD) : sizeof(WORD);
+	if (FAILED(g_pd3dDevice->CreateIndexBuffer(nNumIndices * nIndexSize,
+		0, IndexFormat, D3DPOOL_DEFAULT, &g_pIB, NULL)))
 	{
 		return E_FAIL;
 	}
@@ -151,9 +156,9 @@ HRESULT InitIB()
 	// 인덱스 버퍼를 값으로 채운다.
 	// 인덱스 버퍼의 Lock() 함수를 호출하여 포인터를 얻어온다.
 	VOID* pIndices;
-	if (FAILED(g_pIB->Lock(0, sizeof(indices), (void**)&pIndices, 0)))
+	if (FAILED(g_pIB->Lock(0, nNumIndices * nIndexSize, (void**)&pIndices, 0)))
 		return E_FAIL;
-	memcpy(pIndices, indices, sizeof(indices));
+	SwWriteIndices(indices, nNumIndices, 0, IndexFormat, pIndices);
 	g_pIB->Unlock();
 
 	return S_OK;
@@ -165,10 +170,12 @@ HRESULT InitIB()
 //-----------------------------------------------------------------------------
 VOID SetupMatrices()
 {
+	SW_TRACE_SCOPE("SetupMatrices");
+
 	// 월드 행렬
 	D3DXMATRIXA16 matWorld;
 	D3DXMatrixIdentity(&matWorld);								// 월드 행렬을 단위 행렬로 생성
-	D3DXMatrixRotationY(&matWorld, timeGetTime() / 500.0f);		// Y축을 중심으로 회전 행렬 생성
+	D3DXMatrixRotationY(&matWorld, g_Clock.GetTimeMs() / 500.0f);	// Y축을 중심으로 회전 행렬 생성
 	g_pd3dDevice->SetTransform(D3DTS_WORLD, &matWorld);			// 디바이스에 월드 행렬 설정
 
 	// 뷰 행렬을 정의하기 위해서는 3가지 값이 필요하다.
@@ -206,6 +213,16 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	// -record로 모은 시각표를 파일로 쓴다.
+	g_Clock.StopRecording();
+
+	// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut07_IndexBuffer.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 //-----------------------------------------------------------------------------
@@ -213,8 +230,14 @@ VOID Cleanup()
 //-----------------------------------------------------------------------------
 VOID Render()
 {
+	SW_TRACE_SCOPE("Frame");
+
+	// 이 프레임의 애니메이션 시각을 정한다.
+	g_Clock.Tick();
+
 	// 후면 버퍼와 Z 버퍼를 지운다
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
+		D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
 
 	// 월드, 뷰, 프로젝션 행렬을 설정한다.
 	SetupMatrices();
@@ -222,6 +245,8 @@ VOID Render()
 	// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
+		SW_TRACE_SCOPE("Scene");
+
 		// 정점 버퍼의 삼각형을 그린다.
 		// 1. 정점 정보가 담겨 있는 정점 버퍼를 출력 스트림으로 할당한다.
 		g_pd3dDevice->SetStreamSource(0, g_pVB, 0, sizeof(CUSTOMVERTEX));
@@ -230,14 +255,14 @@ VOID Render()
 		// 3. 인덱스 버퍼를 지정한다.
 		g_pd3dDevice->SetIndices(g_pIB);
 		// 4. DrawIndexedPrimitive()를 호출한다.
-		g_pd3dDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 8, 0, 12);
+		SW_TRACE_CALL("Draw", g_pd3dDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0, 0, 8, 0, 12));
 
 		// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	// 후면 버퍼를 전면 버퍼와 전환
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
 }
 
 //-----------------------------------------------------------------------------
@@ -259,8 +284,13 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
 //-----------------------------------------------------------------------------
 // 이 프로그램의 시작점
 //-----------------------------------------------------------------------------
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+	// -fixed[:간격ms]이면 고정 간격, -replay:<파일>이면 기록한 시각표로 움직인다. -record:<파일>은 시각표를 남긴다.
+	SwConfigureClock(&g_Clock, lpCmdLine);
+
 	// 윈도우 클래스 등록
 	WNDCLASSEX wc =
 	{
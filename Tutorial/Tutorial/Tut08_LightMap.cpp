@@ -4,13 +4,24 @@
  * 설명: 라이트맵핑이란 Quake류의 게임에서 벽면등에 실제 광원을 사용하지 않고
  *       마치 광원이 있는것 같은 효과를 내는 기법을 말한다.
  *       실제 게임에서는 벽면을 BSP트리로 분할하면서 광원들과의 연산을 통해서
- *       라이트맵을 생성하지만 여기서는 만들어진 라이트맵을 사용하였다.
+ *       라이트맵을 생성하지만 여기서는 시작할 때 SwBakeLightmap()으로 벽면의 라이트맵을 굽는다.
+ *       벽면 앞의 스폿라이트가 비추는 직접광(그림자 광선 포함)과 하늘에서 들어오는 간접광을
+ *       텍셀마다 광선 추적으로 모으고, 결과는 두 번째 텍스처 단계의 MODULATE에 그대로 쓴다.
  *
  *------------------------------------------------------------------------------
  */
 
 #include <d3d9.h>
 #include <d3dx9.h>
+#include <cstddef>
+#include <stdio.h>
+#include <string.h>
+
+#include "SwFVFVertex.h"
+#include "SwLightmap.h"
+#include "SwResource.h"
+#include "SwTextureCache.h"
+#include "SwTrace.h"
 
 
 
@@ -23,6 +34,7 @@ LPDIRECT3DDEVICE9       g_pd3dDevice = NULL; /// 렌더링에 사용될 D3D디
 LPDIRECT3DVERTEXBUFFER9 g_pVB = NULL; /// 정점을 보관할 정점버퍼
 LPDIRECT3DTEXTURE9		g_pTex0 = NULL; /// Texture 0(벽면)
 LPDIRECT3DTEXTURE9		g_pTex1 = NULL; /// Texture 1(라이트맵)
+LPDIRECT3DSTATEBLOCK9	g_pStateBlock = NULL; /// 매 프레임 같은 텍스처, 스테이지, 샘플러 상태를 한 번에 설정할 상태 블록
 
 D3DXMATRIXA16			g_matAni;
 
@@ -37,6 +49,23 @@ struct CUSTOMVERTEX
 /// 사용자 정점 구조체에 관한 정보를 나타내는 FVF값
 #define D3DFVF_CUSTOMVERTEX (D3DFVF_XYZ|D3DFVF_DIFFUSE|D3DFVF_TEX1|D3DFVF_TEXCOORDSIZE2(0))
 
+/// 구조체와 FVF값이 어긋나면 컴파일되지 않도록 크기와 오프셋을 확인한다.
+SW_ASSERT_FVF_VERTEX(CUSTOMVERTEX, D3DFVF_CUSTOMVERTEX);
+static_assert(offsetof(CUSTOMVERTEX, color) == SW_FVFTRAITS<D3DFVF_CUSTOMVERTEX>::nDiffuse, "color의 오프셋이 FVF와 다르다");
+static_assert(offsetof(CUSTOMVERTEX, u) == SW_FVFTRAITS<D3DFVF_CUSTOMVERTEX>::TexCoordOffset(0), "u의 오프셋이 FVF와 다르다");
+
+/// 벽면 사각형. 라이트맵도 0번 텍스처 좌표를 그대로 쓴다.
+static const CUSTOMVERTEX g_Vertices[] =
+{
+	{ -1,  1, 0 , 0xffffffff, 0, 0 },		/// v0
+	{  1,  1, 0 , 0xffffffff, 1, 0 },		/// v1
+	{ -1, -1, 0 , 0xffffffff, 0, 1 },		/// v2
+	{  1, -1, 0 , 0xffffffff, 1, 1 },		/// v3
+};
+
+#define LIGHTMAP_SIZE		128		/// 라이트맵 한 변의 텍셀 수
+#define LIGHTMAP_SAMPLES	64		/// 텍셀마다 반구로 보내는 광선 수
+
 
 /**-----------------------------------------------------------------------------
  * Direct3D 초기화
@@ -87,15 +116,6 @@ HRESULT InitD3D(HWND hWnd)
  */
 HRESULT InitVB()
 {
-	/// 상자(cube)를 렌더링하기위해 8개의 정점을 선언
-	CUSTOMVERTEX vertices[] =
-	{
-		{ -1,  1, 0 , 0xffffffff, 0, 0 },		/// v0
-		{  1,  1, 0 , 0xffffffff, 1, 0 },		/// v1
-		{ -1, -1, 0 , 0xffffffff, 0, 1 },		/// v2
-		{  1, -1, 0 , 0xffffffff, 1, 1 },		/// v3
-	};
-
 	/// 정점버퍼 생성
 	/// 8개의 사용자정점을 보관할 메모리를 할당한다.
 	/// FVF를 지정하여 보관할 데이터의 형식을 지정한다.
@@ -109,25 +129,179 @@ HRESULT InitVB()
 	/// 정점버퍼를 값으로 채운다. 
 	/// 정점버퍼의 Lock()함수를 호출하여 포인터를 얻어온다.
 	VOID* pVertices;
-	if (FAILED(g_pVB->Lock(0, sizeof(vertices), (void**)&pVertices, 0)))
+	if (FAILED(g_pVB->Lock(0, sizeof(g_Vertices), (void**)&pVertices, 0)))
 		return E_FAIL;
-	memcpy(pVertices, vertices, sizeof(vertices));
+	memcpy(pVertices, g_Vertices, sizeof(g_Vertices));
 	g_pVB->Unlock();
 
 	return S_OK;
 }
 
+/**-----------------------------------------------------------------------------
+ * 파일로부터 텍스처 생성
+ * BMP 파일은 SwCreateCompressedTextureFromBitmap()으로 Kaiser 필터 밉 체인까지 만들어 BC1(DXT1)로 압축한다.
+ * 압축 결과는 원본 옆의 .bc1.swt 캐시 파일로 남으므로 다음 실행부터는 캐시를 복사하기만 한다.
+ * 텍스처 메모리는 32비트 텍스처의 1/8이다. BMP가 아니거나 지원하지 않는 형식이면 D3DX 함수로 읽는다.
+ *------------------------------------------------------------------------------
+ */
+HRESULT CreateTextureFromFile(const char* pFilename, LPDIRECT3DTEXTURE9* ppTexture)
+{
+	CSwTexture* pCompressed;
+	HRESULT hr = SwCreateCompressedTextureFromBitmap(pFilename, D3DFMT_DXT1, 0, &pCompressed);
+	if (hr == D3DERR_NOTFOUND)
+		return hr;
+	if (SUCCEEDED(hr))
+	{
+		hr = SwCreateD3DTextureFromCompressed(g_pd3dDevice, pCompressed, ppTexture);
+		pCompressed->Release();
+	}
+	if (FAILED(hr))
+		hr = D3DXCreateTextureFromFileA(g_pd3dDevice, pFilename, ppTexture);
+	return hr;
+}
+
+/**-----------------------------------------------------------------------------
+ * 벽면 라이트맵 굽기
+ * 벽면은 카메라 쪽(-z)을 향하고, 그 앞 1.5 거리의 스폿라이트가 벽 가운데를 비춘다.
+ * 감쇠는 가운데에서 밝기가 1.0이 되도록 맞추었다. 구운 X8R8G8B8 밉 체인을 그대로 D3D 텍스처로 옮긴다.
+ *------------------------------------------------------------------------------
+ */
+HRESULT BakeLightmap(LPDIRECT3DTEXTURE9* ppTexture)
+{
+	SW_BAKEVERTEX vertices[4];
+	for (UINT i = 0; i < 4; ++i)
+	{
+		vertices[i].Position.x = g_Vertices[i].x;
+		vertices[i].Position.y = g_Vertices[i].y;
+		vertices[i].Position.z = g_Vertices[i].z;
+		vertices[i].Normal.x = 0.0f;
+		vertices[i].Normal.y = 0.0f;
+		vertices[i].Normal.z = -1.0f;
+		vertices[i].u = g_Vertices[i].u;
+		vertices[i].v = g_Vertices[i].v;
+	}
+	/// 삼각형 띠(v0, v1, v2, v3)를 삼각형 목록으로
+	static const DWORD indices[] = { 0, 1, 2, 2, 1, 3 };
+
+	D3DLIGHT9 light;
+	ZeroMemory(&light, sizeof(light));
+	light.Type = D3DLIGHT_SPOT;
+	light.Diffuse.r = light.Diffuse.g = light.Diffuse.b = 1.0f;
+	light.Position.z = -1.5f;
+	light.Direction.z = 1.0f;
+	light.Range = 100.0f;
+	light.Attenuation0 = 0.2f;
+	light.Attenuation2 = 0.35f;
+	light.Theta = 0.6f;
+	light.Phi = 1.4f;
+	light.Falloff = 1.0f;
+
+	SW_BAKESCENE scene;
+	ZeroMemory(&scene, sizeof(scene));
+	scene.pVertices = vertices;
+	scene.nNumVertices = 4;
+	scene.pIndices = indices;
+	scene.nNumTriangles = 2;
+	scene.pLights = &light;
+	scene.nNumLights = 1;
+	scene.Sky.r = scene.Sky.g = 0.15f;
+	scene.Sky.b = 0.2f;
+
+	SW_BAKEPARAMS params;
+	params.nWidth = params.nHeight = LIGHTMAP_SIZE;
+	params.nLevels = 0;
+	params.nSamples = LIGHTMAP_SAMPLES;
+	params.nBounces = 1;
+
+	CSwTexture* pLightmap;
+	SW_BAKESTATS stats;
+	HRESULT hr = SwBakeLightmap(&scene, &params, &pLightmap, &stats);
+	if (FAILED(hr))
+		return hr;
+
+	char strBakeInfo[160];
+	sprintf_s(strBakeInfo, "Lightmap %ux%u: %.1f ms (trace %.1f ms, %llu rays, %.2f Mrays/s)\n",
+		params.nWidth, params.nHeight, stats.fTotalMs, stats.fTraceMs, (unsigned long long)stats.nRays,
+		stats.fMRaysPerSec);
+	OutputDebugStringA(strBakeInfo);
+
+	const UINT nLevels = pLightmap->GetLevelCount();
+	if (FAILED(hr = g_pd3dDevice->CreateTexture(pLightmap->GetWidth(), pLightmap->GetHeight(), nLevels, 0,
+		D3DFMT_X8R8G8B8, D3DPOOL_MANAGED, ppTexture, NULL)))
+	{
+		pLightmap->Release();
+		return hr;
+	}
+
+	for (UINT i = 0; i < nLevels && SUCCEEDED(hr); ++i)
+	{
+		D3DLOCKED_RECT rect;
+		if (FAILED(hr = (*ppTexture)->LockRect(i, &rect, NULL, 0)))
+			break;
+
+		const BYTE* pSrc = (const BYTE*)pLightmap->GetBits(i);
+		const UINT nRowSize = pLightmap->GetWidth(i) * sizeof(DWORD);
+		for (UINT y = 0; y < pLightmap->GetHeight(i); ++y)
+			memcpy((BYTE*)rect.pBits + y * rect.Pitch, pSrc + y * pLightmap->GetPitch(i), nRowSize);
+		(*ppTexture)->UnlockRect(i);
+	}
+
+	pLightmap->Release();
+	if (FAILED(hr))
+	{
+		(*ppTexture)->Release();
+		*ppTexture = NULL;
+	}
+	return hr;
+}
+
 HRESULT InitTexture()
 {
-	if (FAILED(D3DXCreateTextureFromFile(g_pd3dDevice, "env2.bmp", &g_pTex0)))
+	if (FAILED(CreateTextureFromFile("env2.bmp", &g_pTex0)))
 		return E_FAIL;
 
-	if (FAILED(D3DXCreateTextureFromFile(g_pd3dDevice, "spotlite.bmp", &g_pTex1)))
+	if (FAILED(BakeLightmap(&g_pTex1)))
 		return E_FAIL;
 
 	return S_OK;
 }
 
+/**-----------------------------------------------------------------------------
+ * 상태 블록 초기화
+ * Render()에서 매번 설정하던 상태들을 한 번만 기록해 두고 프레임마다 Apply()한다.
+ *------------------------------------------------------------------------------
+ */
+HRESULT InitStateBlock()
+{
+	g_pd3dDevice->BeginStateBlock();
+
+	g_pd3dDevice->SetTexture(0, g_pTex0);		/// 0번 텍스쳐 스테이지에 텍스쳐 고정(벽면)
+	g_pd3dDevice->SetTexture(1, g_pTex1);		/// 1번 텍스쳐 스테이지에 텍스쳐 고정(라이트맵)
+
+	g_pd3dDevice->SetTextureStageState(0, D3DTSS_TEXCOORDINDEX, 0);	/// 0번 텍스처 : 0번 텍스처 인덱스 사용
+	g_pd3dDevice->SetTextureStageState(1, D3DTSS_TEXCOORDINDEX, 0);	/// 1번 텍스처 : 0번 텍스처 인덱스 사용
+	g_pd3dDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);	/// 0번 텍스처 스테이지의 확대 필터
+	g_pd3dDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);	/// 1번 텍스처 스테이지의 확대 필터
+	g_pd3dDevice->SetSamplerState(0, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);	/// 축소 필터
+	g_pd3dDevice->SetSamplerState(1, D3DSAMP_MINFILTER, D3DTEXF_LINEAR);
+	g_pd3dDevice->SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);	/// 밉 레벨 사이도 보간(삼선형)
+	g_pd3dDevice->SetSamplerState(1, D3DSAMP_MIPFILTER, D3DTEXF_LINEAR);
+	g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
+	g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	g_pd3dDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
+	g_pd3dDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
+
+	g_pd3dDevice->SetTextureStageState(1, D3DTSS_COLOROP, D3DTOP_MODULATE);	/// MODULATE연산으로 색깔을 섞음
+	g_pd3dDevice->SetTextureStageState(1, D3DTSS_COLORARG1, D3DTA_TEXTURE);
+	g_pd3dDevice->SetTextureStageState(1, D3DTSS_COLORARG2, D3DTA_CURRENT);
+	g_pd3dDevice->SetTextureStageState(1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+
+	g_pd3dDevice->SetTextureStageState(2, D3DTSS_COLOROP, D3DTOP_DISABLE);
+	g_pd3dDevice->SetTextureStageState(2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
+
+	return g_pd3dDevice->EndStateBlock(&g_pStateBlock);
+}
+
 /**-----------------------------------------------------------------------------
  * 기하정보 초기화
  *------------------------------------------------------------------------------
@@ -136,6 +310,7 @@ HRESULT InitGeometry()
 {
 	if (FAILED(InitVB())) return E_FAIL;
 	if (FAILED(InitTexture())) return E_FAIL;
+	if (FAILED(InitStateBlock())) return E_FAIL;
 
 	return S_OK;
 }
@@ -184,6 +359,9 @@ VOID Animate()
  */
 VOID Cleanup()
 {
+	if (g_pStateBlock != NULL)
+		g_pStateBlock->Release();
+
 	if (g_pVB != NULL)
 		g_pVB->Release();
 
@@ -192,6 +370,13 @@ VOID Cleanup()
 
 	if (g_pD3D != NULL)
 		g_pD3D->Release();
+
+	/// 기록한 구간을 chrome://tracing에서 열 수 있는 파일로 쓰고 요약을 디버그 출력에 보인다.
+	if (SwTraceIsEnabled())
+	{
+		SwTraceWriteJson("Tut08_LightMap.trace.json");
+		OutputDebugStringA(SwTraceFormatSummary().c_str());
+	}
 }
 
 
@@ -215,41 +400,28 @@ VOID Render()
 {
 	D3DXMATRIXA16	matWorld;
 
+	SW_TRACE_SCOPE("Frame");
+
 	/// 후면버퍼와 Z버퍼 초기화
-	g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER, D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0);
+	SW_TRACE_CALL("Clear", g_pd3dDevice->Clear(0, NULL, D3DCLEAR_TARGET | D3DCLEAR_ZBUFFER,
+		D3DCOLOR_XRGB(0, 0, 255), 1.0f, 0));
 
 	/// 애니메이션 행렬설정
-	Animate();
+	SW_TRACE_CALL("Animate", Animate());
 	/// 렌더링 시작
 	if (SUCCEEDED(g_pd3dDevice->BeginScene()))
 	{
-		g_pd3dDevice->SetTexture(0, g_pTex0);		/// 0번 텍스쳐 스테이지에 텍스쳐 고정(벽면)
-		g_pd3dDevice->SetTexture(1, g_pTex1);		/// 1번 텍스쳐 스테이지에 텍스쳐 고정(라이트맵)
-
-		g_pd3dDevice->SetTextureStageState(0, D3DTSS_TEXCOORDINDEX, 0);	/// 0번 텍스처 : 0번 텍스처 인덱스 사용
-		g_pd3dDevice->SetTextureStageState(1, D3DTSS_TEXCOORDINDEX, 0);	/// 1번 텍스처 : 0번 텍스처 인덱스 사용
-		g_pd3dDevice->SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);	/// 0번 텍스처 스테이지의 확대 필터
-		g_pd3dDevice->SetSamplerState(1, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);	/// 1번 텍스처 스테이지의 확대 필터
-		g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLOROP, D3DTOP_SELECTARG1);
-		g_pd3dDevice->SetTextureStageState(0, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-		g_pd3dDevice->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
-		g_pd3dDevice->SetTextureStageState(0, D3DTSS_ALPHAARG1, D3DTA_TEXTURE);
-
-		g_pd3dDevice->SetTextureStageState(1, D3DTSS_COLOROP, D3DTOP_MODULATE);	/// MODULATE연산으로 색깔을 섞음
-		g_pd3dDevice->SetTextureStageState(1, D3DTSS_COLORARG1, D3DTA_TEXTURE);
-		g_pd3dDevice->SetTextureStageState(1, D3DTSS_COLORARG2, D3DTA_CURRENT);
-		g_pd3dDevice->SetTextureStageState(1, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
-
-		g_pd3dDevice->SetTextureStageState(2, D3DTSS_COLOROP, D3DTOP_DISABLE);
-		g_pd3dDevice->SetTextureStageState(2, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
-
-		DrawMesh(&g_matAni);
+		SW_TRACE_SCOPE("Scene");
+
+		g_pStateBlock->Apply();	/// 기록해 둔 텍스처, 스테이지, 샘플러 상태를 한 번에 설정
+
+		SW_TRACE_CALL("Draw", DrawMesh(&g_matAni));
 		/// 렌더링 종료
-		g_pd3dDevice->EndScene();
+		SW_TRACE_CALL("EndScene", g_pd3dDevice->EndScene());
 	}
 
 	/// 후면버퍼를 보이는 화면으로!
-	g_pd3dDevice->Present(NULL, NULL, NULL, NULL);
+	SW_TRACE_CALL("Present", g_pd3dDevice->Present(NULL, NULL, NULL, NULL));
 }
 
 
@@ -279,8 +451,11 @@ LRESULT WINAPI MsgProc(HWND hWnd, UINT msg, WPARAM wParam, LPARAM lParam)
  * 프로그램 시작점
  *------------------------------------------------------------------------------
  */
-INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, INT)
+INT WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR lpCmdLine, INT)
 {
+	/// -trace로 실행하면 프레임 단계별 시간을 기록한다(SwTrace.h).
+	SwTraceEnable(strstr(lpCmdLine, "-trace") != NULL);
+
 	/// 윈도우 클래스 등록
 	WNDCLASSEX wc = { sizeof(WNDCLASSEX), CS_CLASSDC, MsgProc, 0L, 0L,
 					  GetModuleHandle(NULL), NULL, NULL, NULL, NULL,